@@ -17410,7 +17410,7 @@ typedef struct
 
 //=============================================================================
 typedef volatile unsigned char  vu8;
-typedef volatile unsigned long  vu32;
+typedef volatile uint32_t       vu32;
 typedef volatile unsigned short vu16;
 #define M8(adr)  (*((vu8  *) (adr)))
 #define M16(adr) (*((vu16 *) (adr)))
@@ -17508,6 +17508,7 @@ typedef volatile unsigned short vu16;
 #include "rtc.h"
 #include "uart.h"
 #include "hdiv.h"
+#include "fmem.h"
 #include "acmp.h"
 #include "crc.h"
 #include "usbd.h"
@@ -17518,4 +17519,5 @@ typedef volatile unsigned short vu16;
 #include "usci_spi.h"
 #include "usci_uart.h"
 #include "usci_i2c.h"
+#include "trace.h"
 #endif
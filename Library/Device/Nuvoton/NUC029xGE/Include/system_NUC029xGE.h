@@ -68,6 +68,51 @@ void AssertError(uint8_t* file, uint32_t line);
 
 #define assert_param(expr)  ASSERT_PARAM(expr)
 
+/**
+ * @details    Tag a function with RAMFUNC to execute it from SRAM. The function is copied from flash together
+ *             with the initialized data before main(), so it runs without flash wait states and keeps running
+ *             while the flash is being programmed. Interrupt handlers can be tagged too, the vector table
+ *             then holds their SRAM address. Functions called from a RAMFUNC still execute in flash.
+ *             GCC:  gcc_arm.ld places ".ramfunc" at the start of .data.
+ *             Keil: link with a scatter file having ".ramfunc" in an SRAM execution region, such as
+ *                   Source/ARM/NUC029xGE_ramfunc.sct; without it the function stays in flash.
+ *             IAR:  __ramfunc code is copied by "initialize by copy { readwrite }" of the linker file.
+ */
+#if defined(__ICCARM__)
+#define RAMFUNC     __ramfunc
+#elif defined(__CC_ARM) || defined(__ARMCC_VERSION)
+#define RAMFUNC     __attribute__((section(".ramfunc"), noinline))
+#elif defined(__GNUC__) && defined(__arm__)
+#define RAMFUNC     __attribute__((section(".ramfunc"), noinline, long_call))
+#else
+#define RAMFUNC     /*!< Host builds execute in place */
+#endif
+
+/**
+ * @details    Define DEBUG_ENABLE_LOG to let DEBUG_LOG() queue the format string pointer and up to
+ *             DEBUG_LOG_MAX_ARGS 32-bit arguments instead of printing them. retarget.c formats and
+ *             sends the queued records later from DEBUG_LogIRQHandler(), which must be called by the
+ *             interrupt handler of DEBUG_PORT. Only integer, character and pointer arguments are
+ *             supported, and %s arguments must point to strings which stay valid until they are sent.
+ *             A DEBUG_LOG() with more arguments does not compile (negative array size), up to 16 arguments
+ *             are caught. Without DEBUG_ENABLE_LOG, DEBUG_LOG() is printf().
+ */
+#define DEBUG_LOG_MAX_ARGS  6           /*!< Maximum number of arguments of DEBUG_LOG() */
+
+#if defined(DEBUG_ENABLE_LOG)
+#define DEBUG_LOG_NARG_(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, n, ...)     n
+#define DEBUG_LOG_NARG(...)  DEBUG_LOG_NARG_(__VA_ARGS__, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 6, 5, 4, 3, 2, 1, 0, 0)
+#define DEBUG_LOG_ARGC(n)    ((uint32_t)sizeof(char[((n) <= DEBUG_LOG_MAX_ARGS) ? ((n) + 1) : -1]) - 1)
+#define DEBUG_LOG(...)       DEBUG_LogWrite(DEBUG_LOG_ARGC(DEBUG_LOG_NARG(__VA_ARGS__)), __VA_ARGS__)
+#else
+#define DEBUG_LOG(...)       printf(__VA_ARGS__)
+#endif
+
+int32_t DEBUG_LogWrite(uint32_t u32Argc, const char *pcFmt, ...);
+void DEBUG_LogIRQHandler(void);
+void DEBUG_LogFlush(void);
+uint32_t DEBUG_LogGetDropCount(void);
+
 
 /**
  * @brief    System Initialization
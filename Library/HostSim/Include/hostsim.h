@@ -0,0 +1,229 @@
+/**************************************************************************//**
+ * @file     hostsim.h
+ * @version  V1.00
+ * @brief    NUC029xGE series host-side register model simulator header file
+ *
+ * @note
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __HOSTSIM_H__
+#define __HOSTSIM_H__
+
+#include <stdint.h>
+#include "NUC029xGE.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/** @addtogroup HOSTSIM_EXPORTED_CONSTANTS HostSim Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Bus timing constant definitions (HCLK cycles charged per register access)                             */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SIM_CYCLES_AHB_ACCESS   2       /*!< Cycles charged for one AHB peripheral register access */
+#define SIM_CYCLES_APB_ACCESS   4       /*!< Cycles charged for one APB peripheral register access */
+#define SIM_CYCLES_ISR_ENTRY    16      /*!< Cortex-M0 exception entry latency in cycles */
+#define SIM_CYCLES_ISR_EXIT     16      /*!< Cortex-M0 exception return latency in cycles */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Simulated memory constant definitions                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SIM_SRAM_SIZE           0x10000 /*!< Size of the plain SRAM window mapped at SRAM_BASE */
+#define SIM_APROM_SIZE          0x20000 /*!< Simulated APROM size (128 KB) */
+#define SIM_DATAFLASH_BASE      0x1F000 /*!< Simulated data flash base address reported by FMC->DFBA */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  USBD host transaction result constant definitions                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SIM_USBD_NAK            (-1)    /*!< Endpoint not ready, host gets NAK */
+#define SIM_USBD_STALL          (-2)    /*!< Endpoint stalled, host gets STALL */
+#define SIM_USBD_NO_EP          (-3)    /*!< No hardware endpoint configured for the address */
+#define SIM_USBD_BUSY           (-4)    /*!< Bulk transfer still running, or host pipe already in use */
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup HOSTSIM_EXPORTED_STRUCTS HostSim Exported Structs
+  @{
+*/
+
+/**
+  * @brief  Register access counters of one peripheral
+  */
+typedef struct
+{
+    uint64_t u64Reads;          /*!< CPU read accesses */
+    uint64_t u64Writes;         /*!< CPU write accesses */
+    uint64_t u64DmaAccesses;    /*!< PDMA accesses */
+} SIM_ACCESS_T;
+
+/**
+  * @brief  Interrupt statistics of one IRQ line
+  */
+typedef struct
+{
+    uint32_t u32Count;          /*!< Number of times the handler was entered */
+    uint32_t u32LatencyMax;     /*!< Worst pend-to-entry latency in cycles */
+    uint64_t u64LatencySum;     /*!< Sum of pend-to-entry latency in cycles */
+    uint64_t u64CyclesInIsr;    /*!< Cycles spent inside the handler, exit overhead included */
+} SIM_IRQ_STAT_T;
+
+/**
+  * @brief  SPI slave device model attached to a simulated SPI controller
+  */
+typedef struct
+{
+    /** Exchange one data unit. Receives the MOSI word and returns the MISO word. */
+    uint32_t (*pfnTransfer)(void *pvCtx, uint32_t u32Tx, uint32_t u32Bits);
+    /** Slave select changed. u32Active is 1 when the device is selected. May be NULL. */
+    void (*pfnSelect)(void *pvCtx, uint32_t u32Active);
+    void *pvCtx;                /*!< User context handed to the callbacks */
+} SIM_SPI_DEV_T;
+
+/**
+  * @brief  I2C slave device model attached to a simulated I2C bus
+  */
+typedef struct
+{
+    uint8_t u8Addr;             /*!< 7-bit slave address */
+    /** START or repeated START addressed to this device. u32Read is 1 for SLA+R. May be NULL. */
+    void (*pfnStart)(void *pvCtx, uint32_t u32Read);
+    /** Byte written by the master. Returns 1 to ACK, 0 to NACK. */
+    uint32_t (*pfnWrite)(void *pvCtx, uint8_t u8Data);
+    /** Byte read by the master. */
+    uint8_t (*pfnRead)(void *pvCtx);
+    /** STOP condition. May be NULL. */
+    void (*pfnStop)(void *pvCtx);
+    void *pvCtx;                /*!< User context handed to the callbacks */
+} SIM_I2C_DEV_T;
+
+/**
+  * @brief  Register-file I2C device (EEPROM / sensor style) for SIM_I2C_AttachMemory() and SIM_UI2C_AttachMemory()
+  */
+typedef struct
+{
+    SIM_I2C_DEV_T sDev;         /*!< Device callbacks, filled by the attach function */
+    uint8_t *pu8Mem;            /*!< Backing storage */
+    uint32_t u32Size;           /*!< Backing storage size in bytes */
+    uint32_t u32AddrBytes;      /*!< Register address length, 1 or 2 bytes */
+    uint32_t u32Ptr;            /*!< Current register pointer */
+    uint32_t u32Phase;          /*!< Bytes received since START */
+} SIM_I2C_MEM_T;
+
+/**
+  * @brief  Transfer from a simulated external master to an I2C controller in slave mode, see SIM_I2C_HostXfer()
+  *         and SIM_UI2C_HostXfer()
+  */
+typedef struct
+{
+    uint8_t u8Addr;                 /*!< 7-bit slave address */
+    const uint8_t *pu8Wr;           /*!< Bytes written after SLA+W */
+    uint32_t u32WrLen;              /*!< Bytes to write, 0 for a read only transfer */
+    uint8_t *pu8Rd;                 /*!< Bytes read after SLA+R */
+    uint32_t u32RdLen;              /*!< Bytes to read, 0 for a write only transfer */
+    uint32_t u32BusHz;              /*!< SCL frequency */
+    volatile uint32_t u32Done;      /*!< Set to 1 after the STOP, for SIM_RunUntil() */
+    volatile int32_t i32Status;     /*!< 0, or -1 when the address or a data byte was not acknowledged */
+    uint64_t u64Start;              /*!< Cycle the START went out */
+    uint64_t u64End;                /*!< Cycle the STOP ended */
+} SIM_I2C_HOST_XFER_T;
+
+/**
+  * @brief  Bulk transfer run by the simulated host controller, see SIM_USBD_Submit()
+  */
+typedef struct
+{
+    uint8_t u8EpAddr;               /*!< Endpoint address, bit 7 set for IN */
+    uint8_t *pu8Buf;                /*!< Data buffer */
+    uint32_t u32Len;                /*!< Transfer length in bytes */
+    uint32_t u32MaxPkt;             /*!< wMaxPacketSize of the endpoint */
+    volatile uint32_t u32Actual;    /*!< Bytes moved so far */
+    volatile int32_t i32Status;     /*!< SIM_USBD_BUSY while running, then 0 or SIM_USBD_STALL */
+    uint32_t u32Nak;                /*!< Tokens answered with NAK */
+    uint64_t u64Start;              /*!< Cycle the first token went out */
+    uint64_t u64End;                /*!< Cycle the last transaction ended */
+} SIM_USBD_XFER_T;
+
+/**
+  * @brief  Analog input of the simulated ADC, returns the 12-bit sample of channel u32Ch
+  */
+typedef uint32_t (*SIM_ADC_INPUT_T)(uint32_t u32Ch);
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_STRUCTS */
+
+
+/** @addtogroup HOSTSIM_EXPORTED_FUNCTIONS HostSim Exported Functions
+  @{
+*/
+
+/* Simulator core */
+void SIM_Init(void);
+void SIM_Reset(void);
+uint64_t SIM_GetCycles(void);
+void SIM_AdvanceCycles(uint32_t u32Cycles);
+void SIM_WaitForInterrupt(void);
+void SIM_HoldIdle(uint32_t u32Hold);
+uint32_t SIM_RunUntil(volatile uint32_t *pu32Flag, uint64_t u64MaxCycles);
+
+/* Statistics */
+void SIM_ResetStats(void);
+void SIM_GetAccess(const void *pvPeriph, SIM_ACCESS_T *psAccess);
+uint64_t SIM_GetTotalAccess(void);
+void SIM_GetIrqStat(IRQn_Type IRQn, SIM_IRQ_STAT_T *psStat);
+void SIM_PrintStats(void);
+
+/* UART model */
+void SIM_UART_Inject(UART_T *uart, const uint8_t *pu8Buf, uint32_t u32Len);
+uint32_t SIM_UART_Capture(UART_T *uart, uint8_t *pu8Buf, uint32_t u32MaxLen);
+void SIM_UART_SetLoopback(UART_T *uart, uint32_t u32Enable);
+
+/* SPI model */
+void SIM_SPI_AttachDevice(SPI_T *spi, const SIM_SPI_DEV_T *psDev);
+
+/* I2C model */
+int32_t SIM_I2C_AttachDevice(I2C_T *i2c, SIM_I2C_DEV_T *psDev);
+int32_t SIM_I2C_AttachMemory(I2C_T *i2c, SIM_I2C_MEM_T *psMem, uint8_t u8Addr, uint8_t *pu8Mem, uint32_t u32Size, uint32_t u32AddrBytes);
+int32_t SIM_I2C_HostXfer(I2C_T *i2c, SIM_I2C_HOST_XFER_T *psXfer);
+
+/* USCI model */
+int32_t SIM_UI2C_AttachDevice(UI2C_T *ui2c, SIM_I2C_DEV_T *psDev);
+int32_t SIM_UI2C_AttachMemory(UI2C_T *ui2c, SIM_I2C_MEM_T *psMem, uint8_t u8Addr, uint8_t *pu8Mem, uint32_t u32Size, uint32_t u32AddrBytes);
+int32_t SIM_UI2C_HostXfer(UI2C_T *ui2c, SIM_I2C_HOST_XFER_T *psXfer);
+
+/* FMC model */
+uint8_t *SIM_FMC_GetFlash(uint32_t u32Addr);
+uint32_t SIM_FMC_GetEraseCount(uint32_t u32Addr);
+
+/* USBD model */
+void SIM_USBD_Attach(void);
+void SIM_USBD_Detach(void);
+void SIM_USBD_BusReset(void);
+void SIM_USBD_Setup(const uint8_t *pu8Setup);
+int32_t SIM_USBD_In(uint8_t u8EpNum, uint8_t *pu8Buf, uint32_t u32MaxLen);
+int32_t SIM_USBD_Out(uint8_t u8EpNum, const uint8_t *pu8Buf, uint32_t u32Len);
+int32_t SIM_USBD_Submit(SIM_USBD_XFER_T *psXfer);
+
+/* ADC model */
+void SIM_ADC_SetInput(SIM_ADC_INPUT_T pfnInput);
+
+/*@}*/ /* end of group HOSTSIM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HostSim */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__HOSTSIM_H__
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,149 @@
+/**************************************************************************//**
+ * @file     hostsim_cmsis.h
+ * @version  V1.00
+ * @brief    CMSIS core intrinsics for the NUC029xGE host simulator
+ *
+ * @note     This file is force-included (-include) ahead of every source of a host build.
+ *           It claims the cmsis_gcc.h include guard so the ARM inline assembly is never
+ *           seen by the host compiler, and routes PRIMASK and WFI to the simulator core.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __HOSTSIM_CMSIS_H__
+#define __HOSTSIM_CMSIS_H__
+
+#include <stdint.h>
+
+/* Keep CMSIS from pulling in the ARM GCC intrinsics */
+#define __CMSIS_GCC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void SIM_SetPrimask(uint32_t u32PriMask);
+uint32_t SIM_GetPrimask(void);
+uint32_t SIM_GetIpsr(void);
+void SIM_WaitForInterrupt(void);
+
+static inline void __enable_irq(void)
+{
+    SIM_SetPrimask(0);
+}
+
+static inline void __disable_irq(void)
+{
+    SIM_SetPrimask(1);
+}
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return SIM_GetPrimask();
+}
+
+static inline void __set_PRIMASK(uint32_t priMask)
+{
+    SIM_SetPrimask(priMask);
+}
+
+static inline uint32_t __get_IPSR(void)
+{
+    return SIM_GetIpsr();
+}
+
+static inline uint32_t __get_CONTROL(void)
+{
+    return 0;
+}
+
+static inline void __set_CONTROL(uint32_t control)
+{
+    (void)control;
+}
+
+static inline uint32_t __get_MSP(void)
+{
+    return 0;
+}
+
+static inline void __set_MSP(uint32_t topOfMainStack)
+{
+    (void)topOfMainStack;
+}
+
+static inline uint32_t __get_PSP(void)
+{
+    return 0;
+}
+
+static inline void __set_PSP(uint32_t topOfProcStack)
+{
+    (void)topOfProcStack;
+}
+
+static inline void __NOP(void)
+{
+    __asm volatile("" ::: "memory");
+}
+
+static inline void __WFI(void)
+{
+    SIM_WaitForInterrupt();
+}
+
+static inline void __WFE(void)
+{
+    SIM_WaitForInterrupt();
+}
+
+static inline void __SEV(void)
+{
+}
+
+static inline void __ISB(void)
+{
+    __asm volatile("" ::: "memory");
+}
+
+static inline void __DSB(void)
+{
+    __sync_synchronize();
+}
+
+static inline void __DMB(void)
+{
+    __sync_synchronize();
+}
+
+static inline uint32_t __REV(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+static inline uint32_t __REV16(uint32_t value)
+{
+    return ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);
+}
+
+static inline int32_t __REVSH(int32_t value)
+{
+    return (int32_t)(int16_t)__builtin_bswap16((uint16_t)value);
+}
+
+static inline uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+    op2 &= 31U;
+    return (op2 == 0U) ? op1 : ((op1 >> op2) | (op1 << (32U - op2)));
+}
+
+#define __BKPT(value)   __builtin_trap()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__HOSTSIM_CMSIS_H__
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
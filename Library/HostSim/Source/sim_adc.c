@@ -0,0 +1,243 @@
+/**************************************************************************//**
+ * @file     sim_adc.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator ADC model
+ *
+ * @note     Single, burst (on channel 0 result register), single-cycle scan and continuous
+ *           scan modes. A conversion takes the sampling time selected by SMPTSEL plus 12 ADC
+ *           clocks. Conversions start by ADST or, with TRGEN set, by a TIMER time-out whose
+ *           TRGADC bit is set. STADC pin and PWM triggers never fire in the simulator.
+ *           Each result is also latched to ADPDMA and raises the PDMA_ADC_RX request while
+ *           PTEN is set, the request drops when the PDMA reads ADPDMA.
+ *           Input voltages come from SIM_ADC_SetInput(), the default is mid scale.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+#define SIM_ADC_CH_MSK      0xE00FFFFFUL    /* Channel 0~19 and 29~31 */
+
+typedef struct
+{
+    uint32_t u32Busy;           /* Conversion in progress */
+    uint32_t u32Ch;             /* Channel being converted */
+    uint32_t u32ScanLeft;       /* Channels of the current scan not converted yet */
+    uint64_t u64Done;           /* Cycle the conversion of u32Ch finishes */
+    uint32_t u32PdmaReq;        /* ADPDMA holds a result the PDMA did not read */
+    SIM_ADC_INPUT_T pfnInput;
+} SIM_ADC_STATE_T;
+
+static SIM_ADC_STATE_T s_sAdc;
+
+static uint32_t SIM_ADC_LowestCh(uint32_t u32Mask)
+{
+    uint32_t u32Ch = 0;
+
+    while(!(u32Mask & (1UL << u32Ch)))
+        u32Ch++;
+    return u32Ch;
+}
+
+static void SIM_ADC_Convert(SIM_PERIPH_T *psPeriph, uint64_t u64Start)
+{
+    ADC_T *psAdc = SIM_REGS(ADC_T, psPeriph->u32Base);
+    uint32_t u32Clocks = 4 + ((psAdc->ADCR & ADC_ADCR_SMPTSEL_Msk) >> ADC_ADCR_SMPTSEL_Pos) + 12;
+
+    s_sAdc.u32Ch = SIM_ADC_LowestCh(s_sAdc.u32ScanLeft);
+    s_sAdc.u32ScanLeft &= ~(1UL << s_sAdc.u32Ch);
+    s_sAdc.u64Done = u64Start + SIM_ClkToCycles(u32Clocks, SIM_ClkGetADC());
+    s_sAdc.u32Busy = 1;
+}
+
+/* Start a scan of the enabled channels, burst and single mode use the lowest one only */
+static void SIM_ADC_Start(SIM_PERIPH_T *psPeriph, uint64_t u64Start)
+{
+    ADC_T *psAdc = SIM_REGS(ADC_T, psPeriph->u32Base);
+    uint32_t u32Mask = psAdc->ADCHER & SIM_ADC_CH_MSK;
+    uint32_t u32Mode = psAdc->ADCR & ADC_ADCR_ADMD_Msk;
+
+    if(!(psAdc->ADCR & ADC_ADCR_ADEN_Msk) || (u32Mask == 0))
+    {
+        psAdc->ADCR &= ~ADC_ADCR_ADST_Msk;
+        s_sAdc.u32Busy = 0;
+        return;
+    }
+    if((u32Mode == ADC_ADCR_ADMD_SINGLE) || (u32Mode == ADC_ADCR_ADMD_BURST))
+        u32Mask = 1UL << SIM_ADC_LowestCh(u32Mask);
+    s_sAdc.u32ScanLeft = u32Mask;
+    SIM_ADC_Convert(psPeriph, u64Start);
+}
+
+static void SIM_ADC_Update(SIM_PERIPH_T *psPeriph)
+{
+    ADC_T *psAdc = SIM_REGS(ADC_T, psPeriph->u32Base);
+    uint32_t u32Sts = psAdc->ADSR0 & ~(ADC_ADSR0_BUSY_Msk | ADC_ADSR0_VALIDF_Msk | ADC_ADSR0_OVERRUNF_Msk | ADC_ADSR0_CHANNEL_Msk);
+
+    if(s_sAdc.u32Busy)
+        u32Sts |= ADC_ADSR0_BUSY_Msk;
+    if(psAdc->ADSR1)
+        u32Sts |= ADC_ADSR0_VALIDF_Msk;
+    if(psAdc->ADSR2)
+        u32Sts |= ADC_ADSR0_OVERRUNF_Msk;
+    u32Sts |= s_sAdc.u32Ch << ADC_ADSR0_CHANNEL_Pos;
+    psAdc->ADSR0 = u32Sts;
+
+    psPeriph->u32IrqLine = ((psAdc->ADCR & ADC_ADCR_ADIE_Msk) && (u32Sts & ADC_ADSR0_ADF_Msk)) ? 1 : 0;
+}
+
+static void SIM_ADC_Tick(SIM_PERIPH_T *psPeriph)
+{
+    ADC_T *psAdc = SIM_REGS(ADC_T, psPeriph->u32Base);
+    uint32_t u32Data, u32Reg, u32Mode;
+
+    while(s_sAdc.u32Busy && (s_sAdc.u64Done <= g_u64SimCycles))
+    {
+        u32Data = s_sAdc.pfnInput ? (s_sAdc.pfnInput(s_sAdc.u32Ch) & 0xFFF) : 0x800;
+        if(psAdc->ADCR & ADC_ADCR_DMOF_Msk)
+            u32Data = (u32Data ^ 0x800) | ((u32Data & 0x800) ? 0 : 0xF000);
+        u32Mode = psAdc->ADCR & ADC_ADCR_ADMD_Msk;
+        u32Reg = (u32Mode == ADC_ADCR_ADMD_BURST) ? 0 : s_sAdc.u32Ch;
+
+        if(psAdc->ADSR1 & (1UL << u32Reg))
+            SIM_SET_RO(psAdc->ADSR2, psAdc->ADSR2 | (1UL << u32Reg));
+        SIM_SET_RO(psAdc->ADSR1, psAdc->ADSR1 | (1UL << u32Reg));
+        SIM_SET_RO(psAdc->ADDR[u32Reg], u32Data | ADC_ADDR_VALID_Msk |
+                   ((psAdc->ADSR2 & (1UL << u32Reg)) ? ADC_ADDR_OVERRUN_Msk : 0));
+
+        if(psAdc->ADCR & ADC_ADCR_PTEN_Msk)
+        {
+            SIM_SET_RO(psAdc->ADPDMA, u32Data);
+            s_sAdc.u32PdmaReq = 1;
+        }
+
+        if(s_sAdc.u32ScanLeft)
+        {
+            SIM_ADC_Convert(psPeriph, s_sAdc.u64Done);
+            continue;
+        }
+
+        /* End of scan */
+        psAdc->ADSR0 |= ADC_ADSR0_ADF_Msk;
+        if((u32Mode == ADC_ADCR_ADMD_BURST) || (u32Mode == ADC_ADCR_ADMD_CONTINUOUS))
+            SIM_ADC_Start(psPeriph, s_sAdc.u64Done);
+        else
+        {
+            s_sAdc.u32Busy = 0;
+            psAdc->ADCR &= ~ADC_ADCR_ADST_Msk;
+        }
+    }
+    SIM_ADC_Update(psPeriph);
+}
+
+static void SIM_ADC_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    ADC_T *psAdc = SIM_REGS(ADC_T, psPeriph->u32Base);
+
+    (void)u32IsWrite;
+    SIM_ADC_Tick(psPeriph);
+
+    /* Reading a data register clears its ADSR1/ADSR2 flags */
+    if(u32Offset < 0x80)
+    {
+        SIM_SET_RO(psAdc->ADSR1, psAdc->ADSR1 & ~(1UL << (u32Offset >> 2)));
+        SIM_SET_RO(psAdc->ADSR2, psAdc->ADSR2 & ~(1UL << (u32Offset >> 2)));
+        SIM_ADC_Update(psPeriph);
+    }
+    else if(u32Offset == 0x100)
+        s_sAdc.u32PdmaReq = 0;
+}
+
+static void SIM_ADC_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    ADC_T *psAdc = SIM_REGS(ADC_T, psPeriph->u32Base);
+
+    switch(u32Offset)
+    {
+        case 0x80:                      /* ADCR */
+            if(!(u32New & ADC_ADCR_ADEN_Msk) || ((u32Old & ADC_ADCR_ADST_Msk) && !(u32New & ADC_ADCR_ADST_Msk)))
+            {
+                /* Clearing ADST or ADEN abandons the conversion in progress */
+                psAdc->ADCR &= ~ADC_ADCR_ADST_Msk;
+                s_sAdc.u32Busy = 0;
+                s_sAdc.u32ScanLeft = 0;
+            }
+            else if(!(u32Old & ADC_ADCR_ADST_Msk) && (u32New & ADC_ADCR_ADST_Msk) && !s_sAdc.u32Busy)
+                SIM_ADC_Start(psPeriph, g_u64SimCycles);
+            if(!(u32New & ADC_ADCR_PTEN_Msk))
+                s_sAdc.u32PdmaReq = 0;
+            break;
+        case 0x90:                      /* ADSR0: write 1 to clear ADF/CMPF0/CMPF1 */
+            psAdc->ADSR0 = u32Old & ~(u32New & (ADC_ADSR0_ADF_Msk | ADC_ADSR0_CMPF0_Msk | ADC_ADSR0_CMPF1_Msk));
+            break;
+        case 0x94:                      /* ADSR1, ADSR2, ADPDMA: read only */
+        case 0x98:
+        case 0x100:
+            *(volatile uint32_t *)((uint8_t *)psAdc + u32Offset) = u32Old;
+            break;
+        default:
+            if(u32Offset < 0x80)
+                *(volatile uint32_t *)((uint8_t *)psAdc + u32Offset) = u32Old;
+            break;
+    }
+    SIM_ADC_Update(psPeriph);
+}
+
+static uint32_t SIM_ADC_RxReq(void)
+{
+    return s_sAdc.u32PdmaReq;
+}
+
+static void SIM_ADC_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_ADC_INPUT_T pfnInput = s_sAdc.pfnInput;
+
+    memset(SIM_Alias(psPeriph->u32Base), 0, psPeriph->u32Size);
+    memset(&s_sAdc, 0, sizeof(s_sAdc));
+    s_sAdc.pfnInput = pfnInput;
+    SIM_PDMA_SetRequest(PDMA_ADC_RX, SIM_ADC_RxReq);
+}
+
+/**
+  * @brief      Hardware trigger input of the ADC
+  * @param[in]  u32Source   Trigger source, ADC_ADCR_TRGS_TIMER or ADC_ADCR_TRGS_PWM
+  * @details    Called by the trigger source model. Starts a scan when TRGEN is set with the
+  *             matching TRGS and no conversion is in progress.
+  */
+void SIM_ADC_Trigger(uint32_t u32Source)
+{
+    ADC_T *psAdc = SIM_REGS(ADC_T, g_sSimAdc.u32Base);
+
+    SIM_ADC_Tick(&g_sSimAdc);
+    if(!(psAdc->ADCR & ADC_ADCR_TRGEN_Msk) || ((psAdc->ADCR & ADC_ADCR_TRGS_Msk) != u32Source) || s_sAdc.u32Busy)
+        return;
+    psAdc->ADCR |= ADC_ADCR_ADST_Msk;
+    SIM_ADC_Start(&g_sSimAdc, g_u64SimCycles);
+    SIM_ADC_Update(&g_sSimAdc);
+}
+
+/**
+  * @brief      Set the analog input of the ADC model
+  * @param[in]  pfnInput    Returns the 12-bit sample of a channel, called once per conversion.
+  *                         NULL converts every channel to 0x800.
+  * @return     None
+  */
+void SIM_ADC_SetInput(SIM_ADC_INPUT_T pfnInput)
+{
+    s_sAdc.pfnInput = pfnInput;
+}
+
+SIM_PERIPH_T g_sSimAdc =
+{
+    "ADC", ADC_BASE, 0x1000, ADC_IRQn, &s_sAdc,
+    SIM_ADC_Reset, SIM_ADC_Read, SIM_ADC_Write, SIM_ADC_Tick
+};
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,1034 @@
+/**************************************************************************//**
+ * @file     sim_core.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator core: MMIO trapping, virtual time, NVIC and SysTick
+ *
+ * @note     The peripheral address space is mapped at its real addresses with no access rights.
+ *           Every register access from driver code faults; the fault handler refreshes the
+ *           model, opens the page and single-steps the faulting instruction, after which the
+ *           trap handler closes the page again, hands written values to the model, charges bus
+ *           cycles and dispatches pending interrupts. Models see the same registers through a
+ *           second, always-writable mapping of the same memory.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include "sim_core.h"
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "HostSim needs x86-64 Linux (single-step trap flag)"
+#endif
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Local constants                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SIM_PAGE_SIZE           0x1000
+#define SIM_EFLAGS_TF           0x100
+#define SIM_PF_WRITE            0x2
+#define SIM_EXC_NUM             48          /* 16 system exceptions + 32 IRQs */
+#define SIM_THREAD_PRIO         0x100       /* Priority of thread mode, lower than any exception */
+#define SIM_IDLE_STEP           16          /* Cycles advanced per idle iteration */
+#define SIM_WFI_MAX_CYCLES      (72000000ULL)
+#define SIM_ALARM_US            1000        /* Idle check period, host process CPU time */
+#define SIM_SPIN_READS          8           /* Same value read this many times in a row is a poll loop */
+#define SIM_SPIN_MAX_CYCLES     (1000000ULL)
+
+typedef struct
+{
+    uint32_t u32Base;
+    uint32_t u32Size;
+    uint32_t u32Trap;       /* 1: accesses are trapped, 0: plain memory */
+    uint8_t *pu8Alias;
+} SIM_REGION_T;
+
+typedef struct
+{
+    uint32_t u32Active;
+    uint32_t u32Addr;
+    uint32_t u32IsWrite;
+    uint32_t u32Old;
+    void *pvPage;
+    SIM_PERIPH_T *psPeriph;
+} SIM_TRAP_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Vector table (weak defaults in sim_vector.c)                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+void SysTick_Handler(void);
+void BOD_IRQHandler(void);
+void WDT_IRQHandler(void);
+void EINT024_IRQHandler(void);
+void EINT135_IRQHandler(void);
+void GPAB_IRQHandler(void);
+void GPCDEF_IRQHandler(void);
+void PWM0_IRQHandler(void);
+void PWM1_IRQHandler(void);
+void TMR0_IRQHandler(void);
+void TMR1_IRQHandler(void);
+void TMR2_IRQHandler(void);
+void TMR3_IRQHandler(void);
+void UART02_IRQHandler(void);
+void UART1_IRQHandler(void);
+void SPI0_IRQHandler(void);
+void SPI1_IRQHandler(void);
+void I2C0_IRQHandler(void);
+void I2C1_IRQHandler(void);
+void USCI_IRQHandler(void);
+void USBD_IRQHandler(void);
+void SC01_IRQHandler(void);
+void ACMP01_IRQHandler(void);
+void PDMA_IRQHandler(void);
+void PWRWU_IRQHandler(void);
+void ADC_IRQHandler(void);
+void CLKDIRC_IRQHandler(void);
+void RTC_IRQHandler(void);
+
+static void (*const s_apfnVector[SIM_EXC_NUM])(void) =
+{
+    [15] = SysTick_Handler,
+    [16 + BOD_IRQn] = BOD_IRQHandler,
+    [16 + WDT_IRQn] = WDT_IRQHandler,
+    [16 + EINT024_IRQn] = EINT024_IRQHandler,
+    [16 + EINT135_IRQn] = EINT135_IRQHandler,
+    [16 + GPAB_IRQn] = GPAB_IRQHandler,
+    [16 + GPCDEF_IRQn] = GPCDEF_IRQHandler,
+    [16 + PWM0_IRQn] = PWM0_IRQHandler,
+    [16 + PWM1_IRQn] = PWM1_IRQHandler,
+    [16 + TMR0_IRQn] = TMR0_IRQHandler,
+    [16 + TMR1_IRQn] = TMR1_IRQHandler,
+    [16 + TMR2_IRQn] = TMR2_IRQHandler,
+    [16 + TMR3_IRQn] = TMR3_IRQHandler,
+    [16 + UART02_IRQn] = UART02_IRQHandler,
+    [16 + UART1_IRQn] = UART1_IRQHandler,
+    [16 + SPI0_IRQn] = SPI0_IRQHandler,
+    [16 + SPI1_IRQn] = SPI1_IRQHandler,
+    [16 + I2C0_IRQn] = I2C0_IRQHandler,
+    [16 + I2C1_IRQn] = I2C1_IRQHandler,
+    [16 + USCI_IRQn] = USCI_IRQHandler,
+    [16 + USBD_IRQn] = USBD_IRQHandler,
+    [16 + SC01_IRQn] = SC01_IRQHandler,
+    [16 + ACMP01_IRQn] = ACMP01_IRQHandler,
+    [16 + PDMA_IRQn] = PDMA_IRQHandler,
+    [16 + PWRWU_IRQn] = PWRWU_IRQHandler,
+    [16 + ADC_IRQn] = ADC_IRQHandler,
+    [16 + CLKDIRC_IRQn] = CLKDIRC_IRQHandler,
+    [16 + RTC_IRQn] = RTC_IRQHandler,
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Global / local variables                                                                               */
+/*---------------------------------------------------------------------------------------------------------*/
+uint64_t g_u64SimCycles = 0;
+
+static SIM_REGION_T s_asRegion[] =
+{
+    { APB1_BASE, 0x200000, 1, NULL },
+    { AHB_BASE, 0x20000, 1, NULL },
+    { SCS_BASE, 0x1000, 1, NULL },
+    { SRAM_BASE, SIM_SRAM_SIZE, 0, NULL },
+};
+
+static SIM_PERIPH_T *const s_apsPeriph[] =
+{
+    &g_sSimSys, &g_sSimClk, &g_sSimScs,
+    &g_sSimTimer0, &g_sSimTimer1, &g_sSimTimer2, &g_sSimTimer3,
+    &g_sSimUart0, &g_sSimUart1, &g_sSimUart2,
+    &g_sSimSpi0, &g_sSimSpi1,
+    &g_sSimUsci0, &g_sSimUsci1, &g_sSimUsci2,
+    &g_sSimI2c0, &g_sSimI2c1,
+    &g_sSimCrc, &g_sSimHdiv, &g_sSimFmc, &g_sSimUsbd, &g_sSimAdc,
+    &g_sSimPdma,        /* Last: sees the request lines the others updated in this tick */
+};
+
+#define SIM_PERIPH_NUM  (sizeof(s_apsPeriph) / sizeof(s_apsPeriph[0]))
+
+static volatile SIM_TRAP_T s_sTrap;
+static SIM_ACCESS_T s_sOtherAccess;
+static SIM_IRQ_STAT_T s_asIrqStat[SIM_EXC_NUM];
+static uint64_t s_au64PendTime[SIM_EXC_NUM];
+static uint64_t s_u64Pending;       /* Bit (16 + IRQn) */
+static uint64_t s_u64Active;
+static uint32_t s_u32Line;          /* IRQ lines from models, bit IRQn */
+static uint32_t s_u32Enabled;       /* NVIC ISER */
+static uint32_t s_u32Primask;
+static uint32_t s_u32ActivePrio = SIM_THREAD_PRIO;
+static uint32_t s_u32Ipsr;
+static uint32_t s_u32Dispatched;
+static volatile uint32_t s_u32InSim;
+static uint64_t s_u64AlarmCycles;
+static uint32_t s_u32IdleHold;
+static uint32_t s_u32Inited;
+
+/* Poll loop detection */
+static uint32_t s_u32SpinAddr;
+static uint32_t s_u32SpinData;
+static uint32_t s_u32SpinCount;
+
+/* SysTick */
+static uint32_t s_u32StCountFlag;
+static uint64_t s_u64StLast;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Address helpers                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+static SIM_REGION_T *SIM_FindRegion(uintptr_t uAddr)
+{
+    uint32_t i;
+
+    for(i = 0; i < sizeof(s_asRegion) / sizeof(s_asRegion[0]); i++)
+    {
+        if((uAddr >= s_asRegion[i].u32Base) && (uAddr < (uintptr_t)s_asRegion[i].u32Base + s_asRegion[i].u32Size))
+            return &s_asRegion[i];
+    }
+    return NULL;
+}
+
+static SIM_PERIPH_T *SIM_FindPeriph(uint32_t u32Addr)
+{
+    uint32_t i;
+
+    for(i = 0; i < SIM_PERIPH_NUM; i++)
+    {
+        if((u32Addr >= s_apsPeriph[i]->u32Base) && (u32Addr < s_apsPeriph[i]->u32Base + s_apsPeriph[i]->u32Size))
+            return s_apsPeriph[i];
+    }
+    return NULL;
+}
+
+void *SIM_Alias(uint32_t u32Addr)
+{
+    SIM_REGION_T *psRegion = SIM_FindRegion(u32Addr);
+
+    if(psRegion == NULL)
+        return NULL;
+    return psRegion->pu8Alias + (u32Addr - psRegion->u32Base);
+}
+
+static uint32_t SIM_AccessCycles(uint32_t u32Addr)
+{
+    return (u32Addr >= AHB_BASE) ? SIM_CYCLES_AHB_ACCESS : SIM_CYCLES_APB_ACCESS;
+}
+
+void SIM_Enter(void)
+{
+    s_u32InSim++;
+}
+
+void SIM_Leave(void)
+{
+    s_u32InSim--;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Interrupt controller                                                                                   */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t SIM_GetPriority(uint32_t u32Exc)
+{
+    volatile uint32_t *pu32Scs = SIM_Alias(SCS_BASE);
+
+    if(u32Exc == 15)
+        return (pu32Scs[0xD20 / 4] >> 30) & 0x3;
+    return (pu32Scs[(0x400 + ((u32Exc - 16) & ~3U)) / 4] >> ((((u32Exc - 16) & 3) * 8) + 6)) & 0x3;
+}
+
+static void SIM_Pend(uint32_t u32Exc)
+{
+    uint64_t u64Bit = 1ULL << u32Exc;
+
+    if((s_u64Pending & u64Bit) == 0)
+    {
+        s_u64Pending |= u64Bit;
+        s_au64PendTime[u32Exc] = g_u64SimCycles;
+    }
+}
+
+/**
+  * @brief      Re-evaluate IRQ lines of all models and latch pending state
+  * @param      None
+  * @return     None
+  * @details    Level-sensitive like the NVIC: an asserted line sets pending unless the
+  *             interrupt is already active; it is re-sampled when the handler returns.
+  */
+void SIM_UpdateIrq(void)
+{
+    uint32_t i, u32Line = 0;
+
+    for(i = 0; i < SIM_PERIPH_NUM; i++)
+    {
+        if((s_apsPeriph[i]->i32Irq >= 0) && s_apsPeriph[i]->u32IrqLine)
+            u32Line |= 1UL << s_apsPeriph[i]->i32Irq;
+    }
+    s_u32Line = u32Line;
+
+    for(i = 0; i < 32; i++)
+    {
+        if((u32Line & (1UL << i)) && !(s_u64Active & (1ULL << (16 + i))))
+            SIM_Pend(16 + i);
+    }
+}
+
+static void SIM_DispatchIrq(void)
+{
+    uint32_t u32Exc, u32Best, u32BestPrio, u32Prio, u32SavedPrio, u32SavedIpsr;
+    uint64_t u64Start, u64Latency, u64Ready;
+    SIM_IRQ_STAT_T *psStat;
+
+    for(;;)
+    {
+        if(s_u32Primask)
+            return;
+
+        u64Ready = s_u64Pending & (((uint64_t)s_u32Enabled << 16) | (1ULL << 15));
+        u32Best = 0;
+        u32BestPrio = s_u32ActivePrio;
+        for(u32Exc = 15; u32Exc < SIM_EXC_NUM; u32Exc++)
+        {
+            if(u64Ready & (1ULL << u32Exc))
+            {
+                u32Prio = SIM_GetPriority(u32Exc);
+                if(u32Prio < u32BestPrio)
+                {
+                    u32Best = u32Exc;
+                    u32BestPrio = u32Prio;
+                }
+            }
+        }
+        if(u32Best == 0)
+            return;
+
+        /* Exception entry */
+        s_u64Pending &= ~(1ULL << u32Best);
+        s_u64Active |= (1ULL << u32Best);
+        u32SavedPrio = s_u32ActivePrio;
+        u32SavedIpsr = s_u32Ipsr;
+        s_u32ActivePrio = u32BestPrio;
+        s_u32Ipsr = u32Best;
+        g_u64SimCycles += SIM_CYCLES_ISR_ENTRY;
+
+        psStat = &s_asIrqStat[u32Best];
+        u64Latency = g_u64SimCycles - s_au64PendTime[u32Best];
+        psStat->u32Count++;
+        psStat->u64LatencySum += u64Latency;
+        if(u64Latency > psStat->u32LatencyMax)
+            psStat->u32LatencyMax = (uint32_t)u64Latency;
+        s_u32Dispatched++;
+
+        u64Start = g_u64SimCycles;
+        if(s_apfnVector[u32Best] != NULL)
+            s_apfnVector[u32Best]();
+        g_u64SimCycles += SIM_CYCLES_ISR_EXIT;
+        psStat->u64CyclesInIsr += g_u64SimCycles - u64Start;
+
+        /* Exception return */
+        s_u64Active &= ~(1ULL << u32Best);
+        s_u32ActivePrio = u32SavedPrio;
+        s_u32Ipsr = u32SavedIpsr;
+        if((u32Best >= 16) && (s_u32Line & (1UL << (u32Best - 16))))
+            SIM_Pend(u32Best);
+    }
+}
+
+/**
+  * @brief      Advance all models to the current cycle and take pending interrupts
+  * @param      None
+  * @return     None
+  */
+void SIM_Service(void)
+{
+    uint32_t i;
+
+    /* Keep the idle alarm out while models advance, handlers may spin and need it */
+    s_u32InSim++;
+    for(i = 0; i < SIM_PERIPH_NUM; i++)
+    {
+        if(s_apsPeriph[i]->pfnTick)
+            s_apsPeriph[i]->pfnTick(s_apsPeriph[i]);
+    }
+    SIM_UpdateIrq();
+    s_u32InSim--;
+    SIM_DispatchIrq();
+}
+
+void SIM_SetPrimask(uint32_t u32PriMask)
+{
+    s_u32Primask = u32PriMask & 1;
+    if(s_u32Primask == 0)
+        SIM_DispatchIrq();
+}
+
+uint32_t SIM_GetPrimask(void)
+{
+    return s_u32Primask;
+}
+
+uint32_t SIM_GetIpsr(void)
+{
+    return s_u32Ipsr;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  System control space model: SysTick, NVIC, SCB                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t SIM_SysTickDivider(void)
+{
+    volatile uint32_t *pu32Scs = SIM_Alias(SCS_BASE);
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    uint32_t u32Hclk = SIM_ClkGetHCLK(), u32Ref;
+
+    if(pu32Scs[0x10 / 4] & SysTick_CTRL_CLKSOURCE_Msk)
+        return 1;
+
+    switch((psClk->CLKSEL0 & CLK_CLKSEL0_STCLKSEL_Msk) >> CLK_CLKSEL0_STCLKSEL_Pos)
+    {
+        case 0:
+            u32Ref = __HXT;
+            break;
+        case 1:
+            u32Ref = __LXT;
+            break;
+        case 2:
+            u32Ref = __HXT / 2;
+            break;
+        case 7:
+            u32Ref = __HIRC / 2;
+            break;
+        default:
+            u32Ref = u32Hclk / 2;
+            break;
+    }
+    if((u32Ref == 0) || (u32Ref >= u32Hclk))
+        return 1;
+    return u32Hclk / u32Ref;
+}
+
+static void SIM_ScsTick(SIM_PERIPH_T *psPeriph)
+{
+    volatile uint32_t *pu32Scs = SIM_Alias(SCS_BASE);
+    uint64_t u64Ticks;
+    uint32_t u32Div, u32Val, u32Load;
+
+    (void)psPeriph;
+    if((pu32Scs[0x10 / 4] & SysTick_CTRL_ENABLE_Msk) == 0)
+    {
+        s_u64StLast = g_u64SimCycles;
+        return;
+    }
+
+    u32Div = SIM_SysTickDivider();
+    u64Ticks = (g_u64SimCycles - s_u64StLast) / u32Div;
+    if(u64Ticks == 0)
+        return;
+    s_u64StLast += u64Ticks * u32Div;
+
+    u32Val = pu32Scs[0x18 / 4] & 0xFFFFFF;
+    u32Load = pu32Scs[0x14 / 4] & 0xFFFFFF;
+    if(u64Ticks < u32Val)
+    {
+        pu32Scs[0x18 / 4] = u32Val - (uint32_t)u64Ticks;
+        return;
+    }
+
+    /* Counter reached zero at least once */
+    u64Ticks -= u32Val;
+    pu32Scs[0x18 / 4] = (u32Load == 0) ? 0 : (u32Load - (uint32_t)(u64Ticks % (u32Load + 1)));
+    if((u32Val != 0) || (u64Ticks > 0))
+    {
+        s_u32StCountFlag = 1;
+        if(pu32Scs[0x10 / 4] & SysTick_CTRL_TICKINT_Msk)
+            SIM_Pend(15);
+    }
+}
+
+static void SIM_ScsRead(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    volatile uint32_t *pu32Scs = SIM_Alias(SCS_BASE);
+
+    SIM_ScsTick(psPeriph);
+    switch(u32Offset)
+    {
+        case 0x10:
+            if(s_u32StCountFlag)
+                pu32Scs[0x10 / 4] |= SysTick_CTRL_COUNTFLAG_Msk;
+            else
+                pu32Scs[0x10 / 4] &= ~SysTick_CTRL_COUNTFLAG_Msk;
+            if(!u32IsWrite)
+                s_u32StCountFlag = 0;       /* COUNTFLAG clears on read */
+            break;
+        case 0x100:
+        case 0x180:
+            pu32Scs[u32Offset / 4] = s_u32Enabled;
+            break;
+        case 0x200:
+        case 0x280:
+            pu32Scs[u32Offset / 4] = (uint32_t)(s_u64Pending >> 16);
+            break;
+        case 0xD04:
+            pu32Scs[u32Offset / 4] = s_u32Ipsr | ((s_u64Pending & (1ULL << 15)) ? SCB_ICSR_PENDSTSET_Msk : 0);
+            break;
+        default:
+            break;
+    }
+}
+
+static void SIM_ScsWrite(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    volatile uint32_t *pu32Scs = SIM_Alias(SCS_BASE);
+    uint32_t i;
+
+    (void)psPeriph;
+    switch(u32Offset)
+    {
+        case 0x10:
+            pu32Scs[0x10 / 4] = u32New & ~SysTick_CTRL_COUNTFLAG_Msk;
+            if(!(u32Old & SysTick_CTRL_ENABLE_Msk) && (u32New & SysTick_CTRL_ENABLE_Msk))
+                s_u64StLast = g_u64SimCycles;
+            break;
+        case 0x18:                          /* Any write clears VAL and COUNTFLAG */
+            pu32Scs[0x18 / 4] = 0;
+            s_u32StCountFlag = 0;
+            break;
+        case 0x100:
+            s_u32Enabled |= u32New;
+            pu32Scs[0x100 / 4] = s_u32Enabled;
+            break;
+        case 0x180:
+            s_u32Enabled &= ~u32New;
+            pu32Scs[0x180 / 4] = s_u32Enabled;
+            break;
+        case 0x200:
+            for(i = 0; i < 32; i++)
+                if(u32New & (1UL << i))
+                    SIM_Pend(16 + i);
+            break;
+        case 0x280:
+            s_u64Pending &= ~((uint64_t)u32New << 16);
+            break;
+        case 0xD04:
+            if(u32New & SCB_ICSR_PENDSTSET_Msk)
+                SIM_Pend(15);
+            if(u32New & SCB_ICSR_PENDSTCLR_Msk)
+                s_u64Pending &= ~(1ULL << 15);
+            break;
+        case 0xD0C:
+            if(((u32New >> 16) == 0x05FA) && (u32New & SCB_AIRCR_SYSRESETREQ_Msk))
+            {
+                printf("[HostSim] NVIC_SystemReset() at cycle %llu\n", (unsigned long long)g_u64SimCycles);
+                exit(0);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void SIM_ScsReset(SIM_PERIPH_T *psPeriph)
+{
+    volatile uint32_t *pu32Scs = SIM_Alias(SCS_BASE);
+
+    (void)psPeriph;
+    memset((void *)pu32Scs, 0, 0x1000);
+    pu32Scs[0xD00 / 4] = 0x410CC200;        /* CPUID: Cortex-M0 r0p0 */
+    s_u32StCountFlag = 0;
+    s_u64StLast = g_u64SimCycles;
+}
+
+SIM_PERIPH_T g_sSimScs =
+{
+    "SCS", SCS_BASE, 0x1000, -16, NULL,
+    SIM_ScsReset, SIM_ScsRead, SIM_ScsWrite, SIM_ScsTick
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Bus access from models (PDMA)                                                                          */
+/*---------------------------------------------------------------------------------------------------------*/
+uint32_t SIM_BusRead(uint32_t u32Addr, uint32_t u32Width)
+{
+    SIM_REGION_T *psRegion = SIM_FindRegion(u32Addr);
+    SIM_PERIPH_T *psPeriph;
+    void *pvMem;
+
+    if((psRegion != NULL) && psRegion->u32Trap)
+    {
+        psPeriph = SIM_FindPeriph(u32Addr & ~3U);
+        if(psPeriph != NULL)
+        {
+            psPeriph->sAccess.u64DmaAccesses++;
+            if(psPeriph->pfnRead)
+                psPeriph->pfnRead(psPeriph, (u32Addr & ~3U) - psPeriph->u32Base, 0);
+        }
+        else
+            s_sOtherAccess.u64DmaAccesses++;
+        pvMem = SIM_Alias(u32Addr);
+    }
+    else
+        pvMem = (void *)(uintptr_t)u32Addr;
+
+    if(u32Width == 4)
+        return *(volatile uint32_t *)pvMem;
+    if(u32Width == 2)
+        return *(volatile uint16_t *)pvMem;
+    return *(volatile uint8_t *)pvMem;
+}
+
+void SIM_BusWrite(uint32_t u32Addr, uint32_t u32Data, uint32_t u32Width)
+{
+    SIM_REGION_T *psRegion = SIM_FindRegion(u32Addr);
+    SIM_PERIPH_T *psPeriph = NULL;
+    uint32_t u32Old = 0;
+    void *pvMem;
+
+    if((psRegion != NULL) && psRegion->u32Trap)
+    {
+        psPeriph = SIM_FindPeriph(u32Addr & ~3U);
+        if(psPeriph != NULL)
+        {
+            psPeriph->sAccess.u64DmaAccesses++;
+            if(psPeriph->pfnRead)
+                psPeriph->pfnRead(psPeriph, (u32Addr & ~3U) - psPeriph->u32Base, 1);
+        }
+        else
+            s_sOtherAccess.u64DmaAccesses++;
+        pvMem = SIM_Alias(u32Addr);
+        u32Old = *(volatile uint32_t *)SIM_Alias(u32Addr & ~3U);
+    }
+    else
+        pvMem = (void *)(uintptr_t)u32Addr;
+
+    if(u32Width == 4)
+        *(volatile uint32_t *)pvMem = u32Data;
+    else if(u32Width == 2)
+        *(volatile uint16_t *)pvMem = (uint16_t)u32Data;
+    else
+        *(volatile uint8_t *)pvMem = (uint8_t)u32Data;
+
+    if((psPeriph != NULL) && psPeriph->pfnWrite)
+        psPeriph->pfnWrite(psPeriph, (u32Addr & ~3U) - psPeriph->u32Base, u32Old, *(volatile uint32_t *)SIM_Alias(u32Addr & ~3U));
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  MMIO trap engine                                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+/*
+ * Firmware keeps reading one register that does not change: it waits on a status bit. Let virtual
+ * time pass in idle steps, re-reading the register each step as the loop would, until the value
+ * changes or an interrupt is taken. Saves a trap per loop iteration on long waits.
+ */
+static void SIM_Spin(SIM_PERIPH_T *psPeriph, uint32_t u32Word)
+{
+    uint32_t u32Start = s_u32Dispatched;
+    uint64_t u64End = g_u64SimCycles + SIM_SPIN_MAX_CYCLES;
+
+    s_u32SpinCount = 0;
+    while(g_u64SimCycles < u64End)
+    {
+        g_u64SimCycles += SIM_IDLE_STEP;
+        SIM_Service();
+        if(s_u32Dispatched != u32Start)
+            break;
+        if(psPeriph != NULL)
+        {
+            psPeriph->sAccess.u64Reads++;
+            if(psPeriph->pfnRead)
+                psPeriph->pfnRead(psPeriph, u32Word - psPeriph->u32Base, 0);
+        }
+        if(*(volatile uint32_t *)SIM_Alias(u32Word) != s_u32SpinData)
+            break;
+    }
+}
+
+static void SIM_SegvHandler(int i32Sig, siginfo_t *psInfo, void *pvCtx)
+{
+    ucontext_t *psUc = (ucontext_t *)pvCtx;
+    uintptr_t uAddr = (uintptr_t)psInfo->si_addr;
+    SIM_REGION_T *psRegion = SIM_FindRegion(uAddr);
+    SIM_PERIPH_T *psPeriph;
+    uint32_t u32Word, u32IsWrite;
+
+    if((psRegion == NULL) || !psRegion->u32Trap || s_sTrap.u32Active)
+    {
+        /* Not an MMIO access: let the default action produce a core dump */
+        signal(i32Sig, SIG_DFL);
+        return;
+    }
+
+    u32Word = (uint32_t)uAddr & ~3U;
+    psPeriph = SIM_FindPeriph(u32Word);
+    u32IsWrite = (psUc->uc_mcontext.gregs[REG_ERR] & SIM_PF_WRITE) ? 1 : 0;
+
+    if(!u32IsWrite && (u32Word == s_u32SpinAddr) && (s_u32SpinCount >= SIM_SPIN_READS))
+        SIM_Spin(psPeriph, u32Word);
+
+    s_sTrap.u32Addr = u32Word;
+    s_sTrap.u32IsWrite = u32IsWrite;
+    s_sTrap.pvPage = (void *)(uAddr & ~(uintptr_t)(SIM_PAGE_SIZE - 1));
+    s_sTrap.psPeriph = psPeriph;
+
+    if(psPeriph != NULL)
+    {
+        if(s_sTrap.u32IsWrite)
+            psPeriph->sAccess.u64Writes++;
+        else
+            psPeriph->sAccess.u64Reads++;
+        if(psPeriph->pfnRead)
+            psPeriph->pfnRead(psPeriph, u32Word - psPeriph->u32Base, s_sTrap.u32IsWrite);
+    }
+    else if(s_sTrap.u32IsWrite)
+        s_sOtherAccess.u64Writes++;
+    else
+        s_sOtherAccess.u64Reads++;
+
+    s_sTrap.u32Old = *(volatile uint32_t *)SIM_Alias(u32Word);
+    s_sTrap.u32Active = 1;
+
+    if(!u32IsWrite && (u32Word == s_u32SpinAddr) && (s_sTrap.u32Old == s_u32SpinData))
+        s_u32SpinCount++;
+    else
+    {
+        s_u32SpinAddr = u32IsWrite ? 0 : u32Word;
+        s_u32SpinData = s_sTrap.u32Old;
+        s_u32SpinCount = 0;
+    }
+
+    mprotect(s_sTrap.pvPage, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    psUc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+static void SIM_TrapHandler(int i32Sig, siginfo_t *psInfo, void *pvCtx)
+{
+    ucontext_t *psUc = (ucontext_t *)pvCtx;
+    SIM_PERIPH_T *psPeriph;
+    uint32_t u32Addr, u32IsWrite, u32Old;
+
+    (void)i32Sig;
+    (void)psInfo;
+    if(!s_sTrap.u32Active)
+        return;
+
+    psUc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+    mprotect(s_sTrap.pvPage, SIM_PAGE_SIZE, PROT_NONE);
+
+    psPeriph = s_sTrap.psPeriph;
+    u32Addr = s_sTrap.u32Addr;
+    u32IsWrite = s_sTrap.u32IsWrite;
+    u32Old = s_sTrap.u32Old;
+    s_sTrap.u32Active = 0;
+
+    if(u32IsWrite && (psPeriph != NULL) && psPeriph->pfnWrite)
+        psPeriph->pfnWrite(psPeriph, u32Addr - psPeriph->u32Base, u32Old, *(volatile uint32_t *)SIM_Alias(u32Addr));
+
+    g_u64SimCycles += SIM_AccessCycles(u32Addr);
+    SIM_Service();
+}
+
+static void SIM_AlarmHandler(int i32Sig)
+{
+    (void)i32Sig;
+    if(s_sTrap.u32Active || s_u32InSim || s_u32IdleHold)
+        return;
+
+    /*
+     * Virtual time stood still for a whole tick: no register traffic and no wait in progress, the
+     * firmware spins on RAM. Let time pass. Register accesses and waits, including the one run
+     * from here, all advance time, so a tick that expired meanwhile does not stack another wait.
+     */
+    if(g_u64SimCycles == s_u64AlarmCycles)
+        SIM_WaitForInterrupt();
+    s_u64AlarmCycles = g_u64SimCycles;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Public API                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+
+/**
+  * @brief      Map the simulated address space and install the MMIO trap handlers
+  * @param      None
+  * @return     None
+  * @details    Must be called before any driver function. Peripheral registers are mapped at their
+  *             real addresses, so the program has to be linked non-PIE and keep DMA buffers in
+  *             static storage or in the SRAM window so that their addresses fit in 32 bits.
+  */
+void SIM_Init(void)
+{
+    struct sigaction sAct;
+    struct itimerval sTimer;
+    uint32_t i;
+    int i32Fd;
+    void *pvMap;
+
+    if(s_u32Inited)
+    {
+        SIM_Reset();
+        return;
+    }
+
+    for(i = 0; i < sizeof(s_asRegion) / sizeof(s_asRegion[0]); i++)
+    {
+        if(s_asRegion[i].u32Trap)
+        {
+            i32Fd = memfd_create("nuc029xge_mmio", 0);
+            if((i32Fd < 0) || (ftruncate(i32Fd, s_asRegion[i].u32Size) != 0))
+            {
+                perror("[HostSim] memfd");
+                exit(1);
+            }
+            pvMap = mmap((void *)(uintptr_t)s_asRegion[i].u32Base, s_asRegion[i].u32Size, PROT_NONE,
+                         MAP_SHARED | MAP_FIXED_NOREPLACE, i32Fd, 0);
+            s_asRegion[i].pu8Alias = mmap(NULL, s_asRegion[i].u32Size, PROT_READ | PROT_WRITE, MAP_SHARED, i32Fd, 0);
+            close(i32Fd);
+        }
+        else
+        {
+            pvMap = mmap((void *)(uintptr_t)s_asRegion[i].u32Base, s_asRegion[i].u32Size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+            s_asRegion[i].pu8Alias = pvMap;
+        }
+
+        if((pvMap != (void *)(uintptr_t)s_asRegion[i].u32Base) || (s_asRegion[i].pu8Alias == MAP_FAILED))
+        {
+            fprintf(stderr, "[HostSim] cannot map 0x%08x (link with -no-pie)\n", s_asRegion[i].u32Base);
+            exit(1);
+        }
+    }
+
+    memset(&sAct, 0, sizeof(sAct));
+    sAct.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sAct.sa_mask);
+    sigaddset(&sAct.sa_mask, SIGVTALRM);
+    sAct.sa_sigaction = SIM_SegvHandler;
+    sigaction(SIGSEGV, &sAct, NULL);
+    sAct.sa_sigaction = SIM_TrapHandler;
+    sigaction(SIGTRAP, &sAct, NULL);
+
+    memset(&sAct, 0, sizeof(sAct));
+    sAct.sa_handler = SIM_AlarmHandler;
+    sAct.sa_flags = SA_RESTART;
+    sigemptyset(&sAct.sa_mask);
+    sigaction(SIGVTALRM, &sAct, NULL);
+
+    s_u32Inited = 1;
+    SIM_Reset();
+
+    sTimer.it_interval.tv_sec = 0;
+    sTimer.it_interval.tv_usec = SIM_ALARM_US;
+    sTimer.it_value = sTimer.it_interval;
+    setitimer(ITIMER_VIRTUAL, &sTimer, NULL);
+}
+
+/**
+  * @brief      Reset all peripheral models, interrupt state, virtual time and statistics
+  * @param      None
+  * @return     None
+  */
+void SIM_Reset(void)
+{
+    uint32_t i;
+
+    SIM_Enter();
+    g_u64SimCycles = 0;
+    s_u64Pending = 0;
+    s_u64Active = 0;
+    s_u32Line = 0;
+    s_u32Enabled = 0;
+    s_u32Primask = 0;
+    s_u32ActivePrio = SIM_THREAD_PRIO;
+    s_u32Ipsr = 0;
+
+    for(i = 0; i < sizeof(s_asRegion) / sizeof(s_asRegion[0]); i++)
+        if(s_asRegion[i].u32Trap)
+            memset(s_asRegion[i].pu8Alias, 0, s_asRegion[i].u32Size);
+
+    for(i = 0; i < SIM_PERIPH_NUM; i++)
+    {
+        s_apsPeriph[i]->u32IrqLine = 0;
+        if(s_apsPeriph[i]->pfnReset)
+            s_apsPeriph[i]->pfnReset(s_apsPeriph[i]);
+    }
+    SIM_ResetStats();
+    SIM_Leave();
+}
+
+/**
+  * @brief      Get the current virtual time
+  * @param      None
+  * @return     Elapsed HCLK cycles since SIM_Reset()
+  */
+uint64_t SIM_GetCycles(void)
+{
+    return g_u64SimCycles;
+}
+
+/**
+  * @brief      Charge CPU cycles that are not register accesses
+  * @param[in]  u32Cycles   Number of HCLK cycles to advance
+  * @return     None
+  * @details    Models advance and pending interrupts are taken before returning.
+  */
+void SIM_AdvanceCycles(uint32_t u32Cycles)
+{
+    g_u64SimCycles += u32Cycles;
+    SIM_Service();
+}
+
+/**
+  * @brief      Stop or resume letting time pass while the firmware spins on RAM
+  * @param[in]  u32Hold     1 to stop, 0 to resume
+  * @return     None
+  * @details    Wrap host-timed pure CPU work with it. Otherwise every host millisecond without
+  *             register traffic runs an idle wait, which costs far more host time than the work.
+  */
+void SIM_HoldIdle(uint32_t u32Hold)
+{
+    s_u32IdleHold = u32Hold;
+}
+
+/**
+  * @brief      Sleep until an interrupt has been taken
+  * @param      None
+  * @return     None
+  * @details    Backs __WFI(). Virtual time jumps forward in small steps until a handler runs,
+  *             or, with PRIMASK set, until an enabled interrupt is pending. Gives up after
+  *             about one second of virtual time.
+  */
+void SIM_WaitForInterrupt(void)
+{
+    uint32_t u32Start = s_u32Dispatched;
+    uint64_t u64End = g_u64SimCycles + SIM_WFI_MAX_CYCLES;
+
+    while(g_u64SimCycles < u64End)
+    {
+        g_u64SimCycles += SIM_IDLE_STEP;
+        SIM_Service();
+        if(s_u32Dispatched != u32Start)
+            break;
+        if(s_u32Primask && (s_u64Pending & (((uint64_t)s_u32Enabled << 16) | (1ULL << 15))))
+            break;
+    }
+}
+
+/**
+  * @brief      Let virtual time pass until a flag becomes non-zero
+  * @param[in]  pu32Flag        Flag written by an interrupt handler
+  * @param[in]  u64MaxCycles    Give up after this many cycles
+  * @retval     1   Flag was set
+  * @retval     0   Timed out
+  */
+uint32_t SIM_RunUntil(volatile uint32_t *pu32Flag, uint64_t u64MaxCycles)
+{
+    uint64_t u64End = g_u64SimCycles + u64MaxCycles;
+
+    while(*pu32Flag == 0)
+    {
+        if(g_u64SimCycles >= u64End)
+            return 0;
+        g_u64SimCycles += SIM_IDLE_STEP;
+        SIM_Service();
+    }
+    return 1;
+}
+
+/**
+  * @brief      Clear access counters and interrupt statistics
+  * @param      None
+  * @return     None
+  */
+void SIM_ResetStats(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < SIM_PERIPH_NUM; i++)
+        memset(&s_apsPeriph[i]->sAccess, 0, sizeof(SIM_ACCESS_T));
+    memset(&s_sOtherAccess, 0, sizeof(s_sOtherAccess));
+    memset(s_asIrqStat, 0, sizeof(s_asIrqStat));
+}
+
+/**
+  * @brief      Get access counters of one peripheral
+  * @param[in]  pvPeriph    Peripheral register base, e.g. UART0 or PDMA
+  * @param[out] psAccess    Counters
+  * @return     None
+  */
+void SIM_GetAccess(const void *pvPeriph, SIM_ACCESS_T *psAccess)
+{
+    SIM_PERIPH_T *psPeriph = SIM_FindPeriph((uint32_t)(uintptr_t)pvPeriph);
+
+    if(psPeriph != NULL)
+        *psAccess = psPeriph->sAccess;
+    else
+        memset(psAccess, 0, sizeof(SIM_ACCESS_T));
+}
+
+/**
+  * @brief      Get the number of CPU register accesses to all peripherals
+  * @param      None
+  * @return     Total CPU reads plus writes
+  */
+uint64_t SIM_GetTotalAccess(void)
+{
+    uint64_t u64Total = s_sOtherAccess.u64Reads + s_sOtherAccess.u64Writes;
+    uint32_t i;
+
+    for(i = 0; i < SIM_PERIPH_NUM; i++)
+        u64Total += s_apsPeriph[i]->sAccess.u64Reads + s_apsPeriph[i]->sAccess.u64Writes;
+    return u64Total;
+}
+
+/**
+  * @brief      Get interrupt statistics
+  * @param[in]  IRQn    Interrupt number, SysTick_IRQn or a device IRQ
+  * @param[out] psStat  Statistics
+  * @return     None
+  */
+void SIM_GetIrqStat(IRQn_Type IRQn, SIM_IRQ_STAT_T *psStat)
+{
+    *psStat = s_asIrqStat[16 + (int32_t)IRQn];
+}
+
+/**
+  * @brief      Print access counters and interrupt statistics to stdout
+  * @param      None
+  * @return     None
+  */
+void SIM_PrintStats(void)
+{
+    uint32_t i;
+
+    printf("[HostSim] %llu cycles\n", (unsigned long long)g_u64SimCycles);
+    printf("  %-8s %12s %12s %12s\n", "periph", "reads", "writes", "dma");
+    for(i = 0; i < SIM_PERIPH_NUM; i++)
+    {
+        SIM_ACCESS_T *psA = &s_apsPeriph[i]->sAccess;
+
+        if(psA->u64Reads || psA->u64Writes || psA->u64DmaAccesses)
+            printf("  %-8s %12llu %12llu %12llu\n", s_apsPeriph[i]->pcName, (unsigned long long)psA->u64Reads,
+                   (unsigned long long)psA->u64Writes, (unsigned long long)psA->u64DmaAccesses);
+    }
+    printf("  %-8s %12llu %12llu %12llu\n", "other", (unsigned long long)s_sOtherAccess.u64Reads,
+           (unsigned long long)s_sOtherAccess.u64Writes, (unsigned long long)s_sOtherAccess.u64DmaAccesses);
+
+    for(i = 15; i < SIM_EXC_NUM; i++)
+    {
+        if(s_asIrqStat[i].u32Count)
+            printf("  IRQ %-3d count %8u  latency avg %6llu max %6u  cycles/ISR %6llu\n", (int)i - 16,
+                   s_asIrqStat[i].u32Count,
+                   (unsigned long long)(s_asIrqStat[i].u64LatencySum / s_asIrqStat[i].u32Count),
+                   s_asIrqStat[i].u32LatencyMax,
+                   (unsigned long long)(s_asIrqStat[i].u64CyclesInIsr / s_asIrqStat[i].u32Count));
+    }
+}
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,104 @@
+/**************************************************************************//**
+ * @file     sim_core.h
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator internal model interface
+ *
+ * @note
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __SIM_CORE_H__
+#define __SIM_CORE_H__
+
+#include <stdint.h>
+#include "NUC029xGE.h"
+#include "hostsim.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Peripheral model descriptor                                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct sim_periph SIM_PERIPH_T;
+
+struct sim_periph
+{
+    const char *pcName;         /* Name printed by SIM_PrintStats() */
+    uint32_t u32Base;           /* Register base address */
+    uint32_t u32Size;           /* Register window size in bytes */
+    int32_t i32Irq;             /* IRQ line driven by the model, -16 if none */
+    void *pvState;              /* Model private state */
+
+    /* Restore reset values of registers and model state */
+    void (*pfnReset)(SIM_PERIPH_T *psPeriph);
+    /* Called before the CPU/PDMA accesses u32Offset so that status registers can be refreshed.
+       u32IsWrite is set for write and read-modify-write instructions. */
+    void (*pfnRead)(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite);
+    /* Called after a write to u32Offset. u32Old is the register value before the write. */
+    void (*pfnWrite)(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New);
+    /* Advance the model up to g_u64SimCycles */
+    void (*pfnTick)(SIM_PERIPH_T *psPeriph);
+
+    uint32_t u32IrqLine;        /* Level of the interrupt request output */
+    SIM_ACCESS_T sAccess;       /* Access counters */
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Core services used by the models                                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+extern uint64_t g_u64SimCycles;
+
+void *SIM_Alias(uint32_t u32Addr);
+#define SIM_REGS(type, base)    ((type *)SIM_Alias((uint32_t)(base)))
+
+/* Models update registers that are declared __I (read-only) for the CPU */
+#define SIM_SET_RO(reg, val)    (*(volatile uint32_t *)&(reg) = (uint32_t)(val))
+
+void SIM_UpdateIrq(void);
+void SIM_Service(void);
+
+uint32_t SIM_BusRead(uint32_t u32Addr, uint32_t u32Width);
+void SIM_BusWrite(uint32_t u32Addr, uint32_t u32Data, uint32_t u32Width);
+
+void SIM_Enter(void);
+void SIM_Leave(void);
+
+/* Clock tree (sim_sys.c) */
+uint32_t SIM_ClkGetHCLK(void);
+uint32_t SIM_ClkGetPCLK0(void);
+uint32_t SIM_ClkGetPCLK1(void);
+uint32_t SIM_ClkGetUART(void);
+uint32_t SIM_ClkGetSPI(uint32_t u32Index);
+uint32_t SIM_ClkGetTMR(uint32_t u32Index);
+uint32_t SIM_ClkGetADC(void);
+uint64_t SIM_ClkToCycles(uint64_t u64Ticks, uint32_t u32Freq);
+
+/* Register-file I2C device shared by the I2C and USCI buses (sim_i2c.c) */
+void SIM_I2C_InitMemory(SIM_I2C_MEM_T *psMem, uint8_t u8Addr, uint8_t *pu8Mem, uint32_t u32Size, uint32_t u32AddrBytes);
+
+/* PDMA request lines (sim_pdma.c) */
+typedef uint32_t (*SIM_PDMA_REQ_T)(void);
+void SIM_PDMA_SetRequest(uint32_t u32Src, SIM_PDMA_REQ_T pfnReady);
+
+/* ADC hardware trigger input (sim_adc.c) */
+void SIM_ADC_Trigger(uint32_t u32Source);
+
+/* Model instances */
+extern SIM_PERIPH_T g_sSimSys, g_sSimClk, g_sSimScs;
+extern SIM_PERIPH_T g_sSimTimer0, g_sSimTimer1, g_sSimTimer2, g_sSimTimer3;
+extern SIM_PERIPH_T g_sSimUart0, g_sSimUart1, g_sSimUart2;
+extern SIM_PERIPH_T g_sSimSpi0, g_sSimSpi1;
+extern SIM_PERIPH_T g_sSimUsci0, g_sSimUsci1, g_sSimUsci2;
+extern SIM_PERIPH_T g_sSimI2c0, g_sSimI2c1;
+extern SIM_PERIPH_T g_sSimCrc, g_sSimHdiv, g_sSimFmc, g_sSimUsbd, g_sSimAdc, g_sSimPdma;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SIM_CORE_H__
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
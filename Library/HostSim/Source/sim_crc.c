@@ -0,0 +1,180 @@
+/**************************************************************************//**
+ * @file     sim_crc.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator CRC and HDIV models
+ *
+ * @note     CRC: CCITT/CRC-8/CRC-16/CRC-32 polynomials, 8/16/32-bit CPU write length,
+ *           write data and checksum bit reverse/complement, seed reload by CHKSINIT. Data
+ *           written as 16 or 32 bits is processed least significant byte first.
+ *           HDIV: signed 32/16 divide, result ready when the divisor is written.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+typedef struct
+{
+    uint32_t u32Poly;
+    uint32_t u32Width;
+} SIM_CRC_MODE_T;
+
+static const SIM_CRC_MODE_T s_asCrcMode[4] =
+{
+    { 0x1021, 16 },                     /* CCITT */
+    { 0x07, 8 },                        /* CRC-8 */
+    { 0x8005, 16 },                     /* CRC-16 */
+    { 0x04C11DB7, 32 },                 /* CRC-32 */
+};
+
+static uint32_t s_u32CrcState;          /* Shift register, not reversed or complemented */
+
+static uint32_t SIM_CRC_Reverse(uint32_t u32Data, uint32_t u32Bits)
+{
+    uint32_t i, u32Out = 0;
+
+    for(i = 0; i < u32Bits; i++)
+        if(u32Data & (1UL << i))
+            u32Out |= 1UL << (u32Bits - 1 - i);
+    return u32Out;
+}
+
+static uint32_t SIM_CRC_Mask(uint32_t u32Width)
+{
+    return (u32Width == 32) ? 0xFFFFFFFFUL : ((1UL << u32Width) - 1);
+}
+
+static void SIM_CRC_Update(SIM_PERIPH_T *psPeriph)
+{
+    CRC_T *psCrc = SIM_REGS(CRC_T, psPeriph->u32Base);
+    uint32_t u32Ctl = psCrc->CTL;
+    uint32_t u32Width = s_asCrcMode[(u32Ctl & CRC_CTL_CRCMODE_Msk) >> CRC_CTL_CRCMODE_Pos].u32Width;
+    uint32_t u32Sum = s_u32CrcState;
+
+    if(u32Ctl & CRC_CTL_CHKSREV_Msk)
+        u32Sum = SIM_CRC_Reverse(u32Sum, u32Width);
+    if(u32Ctl & CRC_CTL_CHKSFMT_Msk)
+        u32Sum = ~u32Sum;
+    *(volatile uint32_t *)&psCrc->CHECKSUM = u32Sum & SIM_CRC_Mask(u32Width);
+}
+
+static void SIM_CRC_Byte(uint32_t u32Ctl, uint8_t u8Data)
+{
+    const SIM_CRC_MODE_T *psMode = &s_asCrcMode[(u32Ctl & CRC_CTL_CRCMODE_Msk) >> CRC_CTL_CRCMODE_Pos];
+    uint32_t i, u32Top = 1UL << (psMode->u32Width - 1);
+
+    if(u32Ctl & CRC_CTL_DATFMT_Msk)
+        u8Data = (uint8_t)~u8Data;
+    if(u32Ctl & CRC_CTL_DATREV_Msk)
+        u8Data = (uint8_t)SIM_CRC_Reverse(u8Data, 8);
+
+    s_u32CrcState ^= (uint32_t)u8Data << (psMode->u32Width - 8);
+    for(i = 0; i < 8; i++)
+        s_u32CrcState = (s_u32CrcState & u32Top) ? ((s_u32CrcState << 1) ^ psMode->u32Poly) : (s_u32CrcState << 1);
+    s_u32CrcState &= SIM_CRC_Mask(psMode->u32Width);
+}
+
+static void SIM_CRC_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    CRC_T *psCrc = SIM_REGS(CRC_T, psPeriph->u32Base);
+    uint32_t u32Ctl = psCrc->CTL, u32Bytes, i;
+
+    switch(u32Offset)
+    {
+        case 0x00:                      /* CTL: CHKSINIT reloads the seed and self-clears */
+            if(u32New & CRC_CTL_CHKSINIT_Msk)
+            {
+                s_u32CrcState = psCrc->SEED &
+                                SIM_CRC_Mask(s_asCrcMode[(u32New & CRC_CTL_CRCMODE_Msk) >> CRC_CTL_CRCMODE_Pos].u32Width);
+                psCrc->CTL = u32New & ~CRC_CTL_CHKSINIT_Msk;
+            }
+            break;
+        case 0x04:                      /* DAT */
+            if(!(u32Ctl & CRC_CTL_CRCEN_Msk))
+                break;
+            u32Bytes = 1UL << ((u32Ctl & CRC_CTL_DATLEN_Msk) >> CRC_CTL_DATLEN_Pos);
+            if(u32Bytes > 4)
+                u32Bytes = 4;
+            for(i = 0; i < u32Bytes; i++)
+                SIM_CRC_Byte(u32Ctl, (uint8_t)(u32New >> (i * 8)));
+            break;
+        case 0x0C:                      /* CHECKSUM: read only */
+            *(volatile uint32_t *)&psCrc->CHECKSUM = u32Old;
+            break;
+        default:
+            break;
+    }
+    SIM_CRC_Update(psPeriph);
+}
+
+static void SIM_CRC_Reset(SIM_PERIPH_T *psPeriph)
+{
+    CRC_T *psCrc = SIM_REGS(CRC_T, psPeriph->u32Base);
+
+    memset(psCrc, 0, psPeriph->u32Size);
+    psCrc->CTL = 0x20000000;
+    psCrc->SEED = 0xFFFFFFFF;
+    s_u32CrcState = 0xFFFF;
+    SIM_CRC_Update(psPeriph);
+}
+
+SIM_PERIPH_T g_sSimCrc =
+{
+    "CRC", CRC_BASE, 0x1000, -16, NULL,
+    SIM_CRC_Reset, NULL, SIM_CRC_Write, NULL
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Hardware divider                                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+static void SIM_HDIV_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    HDIV_T *psHdiv = SIM_REGS(HDIV_T, psPeriph->u32Base);
+    int32_t i32Dividend = (int32_t)psHdiv->DIVIDEND;
+    int32_t i32Divisor = (int16_t)(psHdiv->DIVISOR & 0xFFFF);
+
+    switch(u32Offset)
+    {
+        case 0x04:                      /* DIVISOR: starts the division */
+            if(i32Divisor == 0)
+                *(volatile uint32_t *)&psHdiv->DIVSTS = HDIV_DIVSTS_FINISH_Msk | HDIV_DIVSTS_DIV0_Msk;
+            else
+            {
+                if((i32Dividend == (int32_t)0x80000000) && (i32Divisor == -1))
+                    psHdiv->DIVQUO = 0x80000000;
+                else
+                    psHdiv->DIVQUO = (uint32_t)(i32Dividend / i32Divisor);
+                psHdiv->DIVREM = (uint32_t)((i32Divisor == -1) ? 0 : (i32Dividend % i32Divisor));
+                *(volatile uint32_t *)&psHdiv->DIVSTS = HDIV_DIVSTS_FINISH_Msk;
+            }
+            break;
+        case 0x10:                      /* DIVSTS: read only */
+            *(volatile uint32_t *)&psHdiv->DIVSTS = u32Old;
+            break;
+        default:
+            break;
+    }
+}
+
+static void SIM_HDIV_Reset(SIM_PERIPH_T *psPeriph)
+{
+    HDIV_T *psHdiv = SIM_REGS(HDIV_T, psPeriph->u32Base);
+
+    memset(psHdiv, 0, psPeriph->u32Size);
+    *(volatile uint32_t *)&psHdiv->DIVSTS = HDIV_DIVSTS_FINISH_Msk;
+}
+
+SIM_PERIPH_T g_sSimHdiv =
+{
+    "HDIV", HDIV_BASE, 0x1000, -16, NULL,
+    SIM_HDIV_Reset, NULL, SIM_HDIV_Write, NULL
+};
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
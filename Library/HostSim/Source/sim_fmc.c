@@ -0,0 +1,391 @@
+/**************************************************************************//**
+ * @file     sim_fmc.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator FMC model
+ *
+ * @note     Simulated APROM (data flash at SIM_DATAFLASH_BASE), LDROM, SPROM and CONFIG
+ *           arrays driven by the ISP command interface. Programming can only clear bits,
+ *           commands take datasheet-order time and page erases are counted for wear
+ *           statistics. Flash is not mapped for direct CPU reads; use FMC_Read().
+ *           Polling ISPTRG during a command stalls the CPU until the command finishes.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/* Command durations in microseconds */
+#define SIM_FMC_READ_US         1
+#define SIM_FMC_PROGRAM_US      20
+#define SIM_FMC_WRITE8_US       25
+#define SIM_FMC_MPWORD_US       8
+#define SIM_FMC_ERASE_US        20000
+#define SIM_FMC_CHKSUM_US_PER_KB    16
+
+#define SIM_FMC_PAGE_SIZE       FMC_FLASH_PAGE_SIZE
+
+typedef struct
+{
+    uint32_t u32Base;
+    uint32_t u32Size;
+    uint32_t u32UpdateEn;       /* ISPCTL bit needed for update, 0 if always allowed */
+    uint8_t *pu8Mem;
+    uint32_t *pu32Erase;        /* Erase counter per page */
+} SIM_FMC_AREA_T;
+
+static uint8_t s_au8Aprom[SIM_APROM_SIZE];
+static uint8_t s_au8Ldrom[FMC_LDROM_SIZE];
+static uint8_t s_au8Sprom[SIM_FMC_PAGE_SIZE];
+static uint8_t s_au8Config[SIM_FMC_PAGE_SIZE];
+static uint32_t s_au32ApromErase[SIM_APROM_SIZE / SIM_FMC_PAGE_SIZE];
+static uint32_t s_au32LdromErase[FMC_LDROM_SIZE / SIM_FMC_PAGE_SIZE];
+static uint32_t s_au32SpromErase[1];
+static uint32_t s_au32ConfigErase[1];
+
+static SIM_FMC_AREA_T s_asArea[] =
+{
+    { FMC_APROM_BASE, SIM_APROM_SIZE, FMC_ISPCTL_APUEN_Msk, s_au8Aprom, s_au32ApromErase },
+    { FMC_LDROM_BASE, FMC_LDROM_SIZE, FMC_ISPCTL_LDUEN_Msk, s_au8Ldrom, s_au32LdromErase },
+    { FMC_SPROM_BASE, SIM_FMC_PAGE_SIZE, FMC_ISPCTL_SPUEN_Msk, s_au8Sprom, s_au32SpromErase },
+    { FMC_CONFIG_BASE, SIM_FMC_PAGE_SIZE, FMC_ISPCTL_CFGUEN_Msk, s_au8Config, s_au32ConfigErase },
+};
+
+typedef struct
+{
+    uint32_t u32Busy;
+    uint32_t u32Cmd;
+    uint64_t u64Done;
+    uint32_t u32MpAddr;         /* Multi-word program: next word address */
+    uint32_t u32MpIdx;          /* Multi-word program: next MPDAT index */
+    uint32_t u32MpFull;         /* Multi-word program: MPDAT0~3 loaded flags */
+    uint32_t u32Checksum;
+    uint32_t u32Inited;
+} SIM_FMC_STATE_T;
+
+static SIM_FMC_STATE_T s_sFmc;
+
+static SIM_FMC_AREA_T *SIM_FMC_Area(uint32_t u32Addr)
+{
+    uint32_t i;
+
+    for(i = 0; i < sizeof(s_asArea) / sizeof(s_asArea[0]); i++)
+        if((u32Addr >= s_asArea[i].u32Base) && (u32Addr < s_asArea[i].u32Base + s_asArea[i].u32Size))
+            return &s_asArea[i];
+    return NULL;
+}
+
+static uint32_t SIM_FMC_UsToCycles(uint32_t u32Us)
+{
+    return (uint32_t)SIM_ClkToCycles(u32Us, 1000000);
+}
+
+/* Check access rights; data flash is writable without APUEN */
+static uint32_t SIM_FMC_CanUpdate(FMC_T *psFmc, SIM_FMC_AREA_T *psArea, uint32_t u32Addr)
+{
+    if(psArea == NULL)
+        return 0;
+    if((psArea->u32Base == FMC_APROM_BASE) && (u32Addr >= SIM_DATAFLASH_BASE))
+        return 1;
+    return (psFmc->ISPCTL & psArea->u32UpdateEn) ? 1 : 0;
+}
+
+static void SIM_FMC_ProgramWord(SIM_FMC_AREA_T *psArea, uint32_t u32Addr, uint32_t u32Data)
+{
+    uint32_t u32Old;
+    uint8_t *pu8 = psArea->pu8Mem + ((u32Addr - psArea->u32Base) & ~3U);
+
+    memcpy(&u32Old, pu8, 4);
+    u32Old &= u32Data;          /* Programming only clears bits */
+    memcpy(pu8, &u32Old, 4);
+}
+
+static uint32_t SIM_FMC_Crc32(const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t u32Crc = 0xFFFFFFFF, i, j;
+
+    for(i = 0; i < u32Len; i++)
+    {
+        u32Crc ^= pu8Buf[i];
+        for(j = 0; j < 8; j++)
+            u32Crc = (u32Crc >> 1) ^ (0xEDB88320 & (0 - (u32Crc & 1)));
+    }
+    return ~u32Crc;
+}
+
+static void SIM_FMC_Fail(FMC_T *psFmc)
+{
+    psFmc->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+    psFmc->ISPSTS |= FMC_ISPSTS_ISPFF_Msk;
+    s_sFmc.u32Busy = 0;
+}
+
+static void SIM_FMC_Update(SIM_PERIPH_T *psPeriph)
+{
+    FMC_T *psFmc = SIM_REGS(FMC_T, psPeriph->u32Base);
+    uint32_t u32MpSts = 0;
+
+    psFmc->ISPTRG = s_sFmc.u32Busy ? FMC_ISPTRG_ISPGO_Msk : 0;
+    if(s_sFmc.u32Busy)
+        psFmc->ISPSTS |= FMC_ISPSTS_ISPBUSY_Msk;
+    else
+        psFmc->ISPSTS &= ~FMC_ISPSTS_ISPBUSY_Msk;
+
+    if(s_sFmc.u32Busy && (s_sFmc.u32Cmd == FMC_ISPCMD_MULTI_PROG))
+        u32MpSts = FMC_MPSTS_MPBUSY_Msk | FMC_MPSTS_PPGO_Msk;
+    u32MpSts |= (s_sFmc.u32MpFull & 0xF) << FMC_MPSTS_D0_Pos;
+    if(psFmc->ISPCTL & FMC_ISPCTL_ISPFF_Msk)
+        u32MpSts |= FMC_MPSTS_ISPFF_Msk;
+    *(volatile uint32_t *)&psFmc->MPSTS = u32MpSts;
+    *(volatile uint32_t *)&psFmc->MPADDR = s_sFmc.u32MpAddr;
+}
+
+static void SIM_FMC_Complete(FMC_T *psFmc)
+{
+    uint32_t u32Addr = psFmc->ISPADDR, u32Data = psFmc->ISPDAT, u32Size;
+    SIM_FMC_AREA_T *psArea = SIM_FMC_Area(u32Addr);
+    uint32_t u32Page;
+
+    switch(s_sFmc.u32Cmd)
+    {
+        case FMC_ISPCMD_READ:
+            memcpy(&u32Data, psArea->pu8Mem + ((u32Addr - psArea->u32Base) & ~3U), 4);
+            psFmc->ISPDAT = u32Data;
+            break;
+        case FMC_ISPCMD_PROGRAM:
+            SIM_FMC_ProgramWord(psArea, u32Addr, u32Data);
+            break;
+        case FMC_ISPCMD_WRITE_8:
+            SIM_FMC_ProgramWord(psArea, u32Addr, psFmc->MPDAT0);
+            SIM_FMC_ProgramWord(psArea, u32Addr + 4, psFmc->MPDAT1);
+            break;
+        case FMC_ISPCMD_PAGE_ERASE:
+            u32Page = (u32Addr - psArea->u32Base) / SIM_FMC_PAGE_SIZE;
+            memset(psArea->pu8Mem + u32Page * SIM_FMC_PAGE_SIZE, 0xFF, SIM_FMC_PAGE_SIZE);
+            psArea->pu32Erase[u32Page]++;
+            break;
+        case FMC_ISPCMD_CAL_CHECKSUM:
+            u32Size = u32Data;
+            if(u32Addr - psArea->u32Base + u32Size > psArea->u32Size)
+                u32Size = psArea->u32Size - (u32Addr - psArea->u32Base);
+            s_sFmc.u32Checksum = SIM_FMC_Crc32(psArea->pu8Mem + (u32Addr - psArea->u32Base), u32Size);
+            break;
+        case FMC_ISPCMD_CHECKSUM:
+            psFmc->ISPDAT = s_sFmc.u32Checksum;
+            break;
+        case FMC_ISPCMD_READ_CID:
+            psFmc->ISPDAT = 0xDA;
+            break;
+        case FMC_ISPCMD_READ_DID:
+            psFmc->ISPDAT = 0x00C29A00;
+            break;
+        case FMC_ISPCMD_READ_UID:
+            psFmc->ISPDAT = 0x51AE0000 | (u32Addr & 0xFF);
+            break;
+        default:
+            break;
+    }
+    s_sFmc.u32Busy = 0;
+}
+
+/* Multi-word program: one word completes; stop when the next data register is empty */
+static void SIM_FMC_MpStep(FMC_T *psFmc)
+{
+    volatile uint32_t *pu32MpDat = &psFmc->MPDAT0;
+    SIM_FMC_AREA_T *psArea = SIM_FMC_Area(s_sFmc.u32MpAddr);
+
+    if(!SIM_FMC_CanUpdate(psFmc, psArea, s_sFmc.u32MpAddr))
+    {
+        SIM_FMC_Fail(psFmc);
+        return;
+    }
+    SIM_FMC_ProgramWord(psArea, s_sFmc.u32MpAddr, pu32MpDat[s_sFmc.u32MpIdx]);
+    s_sFmc.u32MpFull &= ~(1UL << s_sFmc.u32MpIdx);
+    s_sFmc.u32MpAddr += 4;
+    s_sFmc.u32MpIdx = (s_sFmc.u32MpIdx + 1) & 3;
+
+    if(!(s_sFmc.u32MpFull & (1UL << s_sFmc.u32MpIdx)))
+        s_sFmc.u32Busy = 0;
+    else
+        s_sFmc.u64Done += SIM_FMC_UsToCycles(SIM_FMC_MPWORD_US);
+}
+
+static void SIM_FMC_Tick(SIM_PERIPH_T *psPeriph)
+{
+    FMC_T *psFmc = SIM_REGS(FMC_T, psPeriph->u32Base);
+
+    while(s_sFmc.u32Busy && (s_sFmc.u64Done <= g_u64SimCycles))
+    {
+        if(s_sFmc.u32Cmd == FMC_ISPCMD_MULTI_PROG)
+            SIM_FMC_MpStep(psFmc);
+        else
+            SIM_FMC_Complete(psFmc);
+    }
+    SIM_FMC_Update(psPeriph);
+}
+
+static void SIM_FMC_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    (void)u32IsWrite;
+
+    /* Firmware runs from flash, so instruction fetch stalls until an erase/program finishes.
+       Skip the poll loop instead of trapping every ISPTRG read. Multi-word programming is
+       fed from SRAM code and keeps running. */
+    if((u32Offset == 0x10) && s_sFmc.u32Busy && (s_sFmc.u32Cmd != FMC_ISPCMD_MULTI_PROG) &&
+            (s_sFmc.u64Done > g_u64SimCycles))
+        g_u64SimCycles = s_sFmc.u64Done;
+    SIM_FMC_Tick(psPeriph);
+}
+
+static void SIM_FMC_Start(FMC_T *psFmc)
+{
+    uint32_t u32Cmd = psFmc->ISPCMD & 0x7F, u32Addr = psFmc->ISPADDR, u32Us;
+    SIM_FMC_AREA_T *psArea = SIM_FMC_Area(u32Addr);
+    uint32_t u32Write;
+
+    s_sFmc.u32Cmd = u32Cmd;
+    u32Write = (u32Cmd == FMC_ISPCMD_PROGRAM) || (u32Cmd == FMC_ISPCMD_WRITE_8) ||
+               (u32Cmd == FMC_ISPCMD_PAGE_ERASE) || (u32Cmd == FMC_ISPCMD_MULTI_PROG);
+
+    if(!(psFmc->ISPCTL & FMC_ISPCTL_ISPEN_Msk))
+    {
+        SIM_FMC_Fail(psFmc);
+        return;
+    }
+    if((u32Cmd == FMC_ISPCMD_READ) || (u32Cmd == FMC_ISPCMD_CAL_CHECKSUM) || u32Write)
+    {
+        if((psArea == NULL) || (u32Addr & 3) || (u32Write && !SIM_FMC_CanUpdate(psFmc, psArea, u32Addr)) ||
+                ((u32Cmd == FMC_ISPCMD_PAGE_ERASE) && (u32Addr & (SIM_FMC_PAGE_SIZE - 1))))
+        {
+            SIM_FMC_Fail(psFmc);
+            return;
+        }
+    }
+
+    switch(u32Cmd)
+    {
+        case FMC_ISPCMD_PROGRAM:
+            u32Us = SIM_FMC_PROGRAM_US;
+            break;
+        case FMC_ISPCMD_WRITE_8:
+            u32Us = SIM_FMC_WRITE8_US;
+            break;
+        case FMC_ISPCMD_PAGE_ERASE:
+            u32Us = SIM_FMC_ERASE_US;
+            break;
+        case FMC_ISPCMD_CAL_CHECKSUM:
+            u32Us = (psFmc->ISPDAT / 1024 + 1) * SIM_FMC_CHKSUM_US_PER_KB;
+            break;
+        case FMC_ISPCMD_MULTI_PROG:
+            s_sFmc.u32MpAddr = u32Addr;
+            s_sFmc.u32MpIdx = 0;
+            s_sFmc.u32MpFull = 0xF;
+            u32Us = SIM_FMC_MPWORD_US;
+            break;
+        default:
+            u32Us = SIM_FMC_READ_US;
+            break;
+    }
+    s_sFmc.u32Busy = 1;
+    s_sFmc.u64Done = g_u64SimCycles + SIM_FMC_UsToCycles(u32Us);
+}
+
+static void SIM_FMC_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    FMC_T *psFmc = SIM_REGS(FMC_T, psPeriph->u32Base);
+
+    switch(u32Offset)
+    {
+        case 0x00:                      /* ISPCTL: ISPFF is write 1 to clear */
+            if(u32New & FMC_ISPCTL_ISPFF_Msk)
+            {
+                psFmc->ISPCTL = u32New & ~FMC_ISPCTL_ISPFF_Msk;
+                psFmc->ISPSTS &= ~FMC_ISPSTS_ISPFF_Msk;
+            }
+            break;
+        case 0x10:
+            if((u32New & FMC_ISPTRG_ISPGO_Msk) && !s_sFmc.u32Busy)
+                SIM_FMC_Start(psFmc);
+            break;
+        case 0x14:
+            SIM_SET_RO(psFmc->DFBA, u32Old);   /* Read-only */
+            break;
+        case 0x40:
+            if(u32New & FMC_ISPSTS_ISPFF_Msk)
+            {
+                psFmc->ISPSTS = u32Old & ~FMC_ISPSTS_ISPFF_Msk;
+                psFmc->ISPCTL &= ~FMC_ISPCTL_ISPFF_Msk;
+            }
+            else
+                psFmc->ISPSTS = u32Old;
+            break;
+        case 0x80:
+        case 0x84:
+        case 0x88:
+        case 0x8C:
+            s_sFmc.u32MpFull |= 1UL << ((u32Offset - 0x80) / 4);
+            break;
+        default:
+            break;
+    }
+    SIM_FMC_Update(psPeriph);
+}
+
+static void SIM_FMC_Reset(SIM_PERIPH_T *psPeriph)
+{
+    FMC_T *psFmc = SIM_REGS(FMC_T, psPeriph->u32Base);
+    uint32_t u32Config[2] = {0xFFFFFFFE, SIM_DATAFLASH_BASE};    /* DFEN=0: data flash enabled */
+    uint32_t i;
+
+    /* Flash content survives a chip reset; only the first reset blanks it */
+    if(!s_sFmc.u32Inited)
+    {
+        for(i = 0; i < sizeof(s_asArea) / sizeof(s_asArea[0]); i++)
+            memset(s_asArea[i].pu8Mem, 0xFF, s_asArea[i].u32Size);
+        memcpy(s_au8Config, u32Config, sizeof(u32Config));
+    }
+    memset(&s_sFmc, 0, sizeof(s_sFmc));
+    s_sFmc.u32Inited = 1;
+
+    memset(psFmc, 0, psPeriph->u32Size);
+    SIM_SET_RO(psFmc->DFBA, SIM_DATAFLASH_BASE);
+    SIM_FMC_Update(psPeriph);
+}
+
+SIM_PERIPH_T g_sSimFmc =
+{
+    "FMC", FMC_BASE, 0x1000, -16, NULL,
+    SIM_FMC_Reset, SIM_FMC_Read, SIM_FMC_Write, SIM_FMC_Tick
+};
+
+/**
+  * @brief      Access simulated flash content
+  * @param[in]  u32Addr     Flash address (APROM, LDROM, SPROM or CONFIG)
+  * @return     Host pointer to the byte at u32Addr, NULL if not simulated
+  */
+uint8_t *SIM_FMC_GetFlash(uint32_t u32Addr)
+{
+    SIM_FMC_AREA_T *psArea = SIM_FMC_Area(u32Addr);
+
+    return (psArea != NULL) ? (psArea->pu8Mem + (u32Addr - psArea->u32Base)) : NULL;
+}
+
+/**
+  * @brief      Get the number of times a flash page was erased
+  * @param[in]  u32Addr     Any address inside the page
+  * @return     Erase count since program start
+  */
+uint32_t SIM_FMC_GetEraseCount(uint32_t u32Addr)
+{
+    SIM_FMC_AREA_T *psArea = SIM_FMC_Area(u32Addr);
+
+    return (psArea != NULL) ? psArea->pu32Erase[(u32Addr - psArea->u32Base) / SIM_FMC_PAGE_SIZE] : 0;
+}
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,588 @@
+/**************************************************************************//**
+ * @file     sim_i2c.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator I2C model
+ *
+ * @note     Byte-level master state machine driven by I2C_CTL. Every START, STOP and byte
+ *           takes the bus time given by I2C_CLKDIV; SI is raised with the standard status
+ *           code when the step completes. Slaves are device models attached to the bus.
+ *           Slave mode: SIM_I2C_HostXfer() runs a transfer from an external master. The
+ *           address is matched against I2C_ADDR0~3 and their masks, and SCL is stretched
+ *           while SI is set. With I2C_CTL1 RXPDMAEN or TXPDMAEN, data bytes of a slave
+ *           transfer are PDMA requests instead of SI, the bus goes on once PDMA accessed DAT.
+ *           Master mode: with TXPDMAEN, an acknowledged byte is a PDMA request and the PDMA write
+ *           of DAT sends the next one; with RXPDMAEN, a byte received with ACK is a PDMA request
+ *           and the PDMA read of DAT receives the next one. Clearing the enable with a request
+ *           pending raises SI instead.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+#define SIM_I2C_MAX_DEV         8
+
+/* Pending bus operations */
+#define SIM_I2C_OP_NONE         0
+#define SIM_I2C_OP_START        1
+#define SIM_I2C_OP_STOP         2
+#define SIM_I2C_OP_STOP_START   3
+#define SIM_I2C_OP_BYTE         4
+#define SIM_I2C_OP_HOST         5       /* Step of an external master transfer */
+
+/* External master transfer phases, the bus step that completes next */
+#define SIM_I2C_HOST_ADDR_W     0
+#define SIM_I2C_HOST_ADDR_R     1
+#define SIM_I2C_HOST_WRITE      2
+#define SIM_I2C_HOST_READ       3
+#define SIM_I2C_HOST_STOP_RX    4       /* STOP or repeated START seen by the addressed slave receiver */
+#define SIM_I2C_HOST_END        5
+
+typedef struct
+{
+    uint32_t u32Index;
+    SIM_I2C_DEV_T *apsDev[SIM_I2C_MAX_DEV];
+    SIM_I2C_DEV_T *psTarget;            /* Device addressed in the current transfer */
+    uint32_t u32Read;                   /* Current transfer direction */
+    uint32_t u32Owned;                  /* Bus owned since the last START */
+    uint32_t u32Op;
+    uint64_t u64Done;
+    SIM_I2C_HOST_XFER_T *psHost;        /* External master transfer, slave mode */
+    uint32_t u32HostPhase;
+    uint32_t u32HostNext;               /* Phase after SIM_I2C_HOST_STOP_RX */
+    uint32_t u32HostIdx;
+    uint32_t u32HostAck;                /* AA when SI was cleared */
+    uint8_t u8HostTx;                   /* DAT when SI was cleared */
+    uint32_t u32DmaReq;                 /* Data byte waits for PDMA instead of SI */
+} SIM_I2C_STATE_T;
+
+static SIM_I2C_STATE_T s_asI2c[2] = { {0}, {1} };
+
+static uint64_t SIM_I2C_BitCycles(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+    uint32_t u32Pclk = (psState->u32Index == 0) ? SIM_ClkGetPCLK0() : SIM_ClkGetPCLK1();
+
+    return SIM_ClkToCycles(4ULL * ((psI2c->CLKDIV & I2C_CLKDIV_DIVIDER_Msk) + 1), u32Pclk);
+}
+
+static void SIM_I2C_Update(SIM_PERIPH_T *psPeriph)
+{
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+
+    psPeriph->u32IrqLine = ((psI2c->CTL & (I2C_CTL_SI_Msk | I2C_CTL_INTEN_Msk)) == (I2C_CTL_SI_Msk | I2C_CTL_INTEN_Msk));
+}
+
+static void SIM_I2C_Schedule(SIM_PERIPH_T *psPeriph, uint32_t u32Op, uint32_t u32Bits)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+
+    psState->u32Op = u32Op;
+    psState->u64Done = g_u64SimCycles + u32Bits * SIM_I2C_BitCycles(psPeriph);
+}
+
+static void SIM_I2C_HostSchedule(SIM_PERIPH_T *psPeriph, uint32_t u32Phase, uint32_t u32Bits)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+
+    psState->u32HostPhase = u32Phase;
+    psState->u32Op = SIM_I2C_OP_HOST;
+    psState->u64Done = g_u64SimCycles + SIM_ClkToCycles(u32Bits, psState->psHost->u32BusHz);
+}
+
+static uint32_t SIM_I2C_AddrMatch(I2C_T *psI2c, uint32_t u32Addr)
+{
+    const uint32_t au32Addr[4] = { psI2c->ADDR0, psI2c->ADDR1, psI2c->ADDR2, psI2c->ADDR3 };
+    const uint32_t au32Msk[4] = { psI2c->ADDRMSK0, psI2c->ADDRMSK1, psI2c->ADDRMSK2, psI2c->ADDRMSK3 };
+    uint32_t i;
+
+    for(i = 0; i < 4; i++)
+        if((((au32Addr[i] >> 1) ^ u32Addr) & ~(au32Msk[i] >> 1) & 0x7F) == 0)
+            return 1;
+    return 0;
+}
+
+/* A bus step of the external master is done */
+static void SIM_I2C_HostStep(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+    SIM_I2C_HOST_XFER_T *psHost = psState->psHost;
+    uint32_t u32Read;
+
+    switch(psState->u32HostPhase)
+    {
+        case SIM_I2C_HOST_ADDR_W:
+        case SIM_I2C_HOST_ADDR_R:
+            u32Read = (psState->u32HostPhase == SIM_I2C_HOST_ADDR_R);
+            if(((psI2c->CTL & (I2C_CTL_I2CEN_Msk | I2C_CTL_AA_Msk)) != (I2C_CTL_I2CEN_Msk | I2C_CTL_AA_Msk)) ||
+                    !SIM_I2C_AddrMatch(psI2c, psHost->u8Addr))
+            {
+                psHost->i32Status = -1;
+                SIM_I2C_HostSchedule(psPeriph, SIM_I2C_HOST_END, 1);
+                return;
+            }
+            psI2c->DAT = (psHost->u8Addr << 1) | u32Read;
+            SIM_SET_RO(psI2c->STATUS, u32Read ? 0xA8 : 0x60);
+            psState->u32HostIdx = 0;
+            break;
+        case SIM_I2C_HOST_WRITE:
+            psI2c->DAT = psHost->pu8Wr[psState->u32HostIdx++];
+            SIM_SET_RO(psI2c->STATUS, psState->u32HostAck ? 0x80 : 0x88);
+            if(psState->u32HostAck && (psI2c->CTL1 & I2C_CTL1_RXPDMAEN_Msk))
+            {
+                psState->u32DmaReq = 1;
+                return;
+            }
+            break;
+        case SIM_I2C_HOST_READ:
+            psHost->pu8Rd[psState->u32HostIdx++] = psState->u8HostTx;
+            SIM_SET_RO(psI2c->STATUS, (psState->u32HostIdx < psHost->u32RdLen) ? 0xB8 : 0xC0);
+            if((psState->u32HostIdx < psHost->u32RdLen) && (psI2c->CTL1 & I2C_CTL1_TXPDMAEN_Msk))
+            {
+                psState->u32DmaReq = 1;
+                return;
+            }
+            break;
+        case SIM_I2C_HOST_STOP_RX:
+            SIM_SET_RO(psI2c->STATUS, 0xA0);
+            break;
+        default:
+            SIM_SET_RO(psI2c->STATUS, 0xF8);
+            psHost->u64End = g_u64SimCycles;
+            psState->psHost = NULL;
+            psHost->u32Done = 1;
+            return;
+    }
+    psI2c->CTL |= I2C_CTL_SI_Msk;
+}
+
+/* Firmware cleared SI in slave mode, the external master goes on */
+static void SIM_I2C_HostRelease(SIM_PERIPH_T *psPeriph, uint32_t u32Status, uint32_t u32Ctl)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+    SIM_I2C_HOST_XFER_T *psHost = psState->psHost;
+
+    psState->u32HostAck = (u32Ctl & I2C_CTL_AA_Msk) ? 1 : 0;
+    switch(u32Status)
+    {
+        case 0x60:
+        case 0x80:
+            if(psState->u32HostIdx < psHost->u32WrLen)
+                SIM_I2C_HostSchedule(psPeriph, SIM_I2C_HOST_WRITE, 9);
+            else
+            {
+                psState->u32HostNext = psHost->u32RdLen ? SIM_I2C_HOST_ADDR_R : SIM_I2C_HOST_END;
+                SIM_I2C_HostSchedule(psPeriph, SIM_I2C_HOST_STOP_RX, 1);
+            }
+            break;
+        case 0x88:                      /* NACK ends the transfer, the slave is no longer addressed */
+            psHost->i32Status = -1;
+            SIM_I2C_HostSchedule(psPeriph, SIM_I2C_HOST_END, 1);
+            break;
+        case 0xA0:
+            SIM_I2C_HostSchedule(psPeriph, psState->u32HostNext, (psState->u32HostNext == SIM_I2C_HOST_END) ? 0 : 9);
+            break;
+        case 0xA8:
+        case 0xB8:
+            psState->u8HostTx = (uint8_t)psI2c->DAT;
+            SIM_I2C_HostSchedule(psPeriph, SIM_I2C_HOST_READ, 9);
+            break;
+        case 0xC0:
+            SIM_I2C_HostSchedule(psPeriph, SIM_I2C_HOST_END, 1);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Finish the pending operation and raise SI with the resulting status */
+static void SIM_I2C_Complete(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+    uint32_t u32Status = psI2c->STATUS & 0xFF, u32Dat = psI2c->DAT & 0xFF, u32Ack, i;
+    uint32_t u32Op = psState->u32Op;
+
+    psState->u32Op = SIM_I2C_OP_NONE;
+
+    if(u32Op == SIM_I2C_OP_HOST)
+    {
+        SIM_I2C_HostStep(psPeriph);
+        return;
+    }
+
+    if((u32Op == SIM_I2C_OP_STOP) || (u32Op == SIM_I2C_OP_STOP_START))
+    {
+        if((psState->psTarget != NULL) && (psState->psTarget->pfnStop != NULL))
+            psState->psTarget->pfnStop(psState->psTarget->pvCtx);
+        psState->psTarget = NULL;
+        psState->u32Owned = 0;
+        psI2c->CTL &= ~I2C_CTL_STO_Msk;
+        SIM_SET_RO(psI2c->STATUS, 0xF8);
+        if(u32Op == SIM_I2C_OP_STOP)
+        {
+            /* START requested while the STOP was on the bus goes out once the bus is free */
+            if(psI2c->CTL & I2C_CTL_STA_Msk)
+                SIM_I2C_Schedule(psPeriph, SIM_I2C_OP_START, 1);
+            return;
+        }
+    }
+
+    if((u32Op == SIM_I2C_OP_START) || (u32Op == SIM_I2C_OP_STOP_START))
+    {
+        SIM_SET_RO(psI2c->STATUS, psState->u32Owned ? 0x10 : 0x08);
+        psState->u32Owned = 1;
+        psI2c->CTL |= I2C_CTL_SI_Msk;
+        return;
+    }
+
+    switch(u32Status)
+    {
+        case 0x08:                      /* SLA+R/W sent */
+        case 0x10:
+            psState->u32Read = u32Dat & 1;
+            psState->psTarget = NULL;
+            for(i = 0; i < SIM_I2C_MAX_DEV; i++)
+            {
+                if((psState->apsDev[i] != NULL) && (psState->apsDev[i]->u8Addr == (u32Dat >> 1)))
+                {
+                    psState->psTarget = psState->apsDev[i];
+                    break;
+                }
+            }
+            if(psState->psTarget != NULL)
+            {
+                if(psState->psTarget->pfnStart != NULL)
+                    psState->psTarget->pfnStart(psState->psTarget->pvCtx, psState->u32Read);
+                SIM_SET_RO(psI2c->STATUS, psState->u32Read ? 0x40 : 0x18);
+            }
+            else
+                SIM_SET_RO(psI2c->STATUS, psState->u32Read ? 0x48 : 0x20);
+            break;
+        case 0x18:                      /* Data byte sent */
+        case 0x28:
+            u32Ack = (psState->psTarget != NULL) ? psState->psTarget->pfnWrite(psState->psTarget->pvCtx, (uint8_t)u32Dat) : 0;
+            SIM_SET_RO(psI2c->STATUS, u32Ack ? 0x28 : 0x30);
+            if(u32Ack && (psI2c->CTL1 & I2C_CTL1_TXPDMAEN_Msk))
+            {
+                psState->u32DmaReq = 1;
+                return;
+            }
+            break;
+        case 0x40:                      /* Data byte received */
+        case 0x50:
+            psI2c->DAT = (psState->psTarget != NULL) ? psState->psTarget->pfnRead(psState->psTarget->pvCtx) : 0xFF;
+            SIM_SET_RO(psI2c->STATUS, (psI2c->CTL & I2C_CTL_AA_Msk) ? 0x50 : 0x58);
+            if((psI2c->CTL & I2C_CTL_AA_Msk) && (psI2c->CTL1 & I2C_CTL1_RXPDMAEN_Msk))
+            {
+                psState->u32DmaReq = 1;
+                return;
+            }
+            break;
+        default:
+            SIM_SET_RO(psI2c->STATUS, 0xF8);
+            return;
+    }
+    psI2c->CTL |= I2C_CTL_SI_Msk;
+}
+
+static void SIM_I2C_Tick(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+
+    if((psState->u32Op != SIM_I2C_OP_NONE) && (psState->u64Done <= g_u64SimCycles))
+        SIM_I2C_Complete(psPeriph);
+    SIM_I2C_Update(psPeriph);
+}
+
+static void SIM_I2C_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+
+    SIM_I2C_Tick(psPeriph);
+    /* PDMA reads the received byte, DAT keeps it until the next byte completes */
+    if((u32Offset == 0x08) && !u32IsWrite && psState->u32DmaReq && (psI2c->CTL1 & I2C_CTL1_RXPDMAEN_Msk))
+    {
+        psState->u32DmaReq = 0;
+        if(psState->psHost != NULL)
+            SIM_I2C_HostRelease(psPeriph, 0x80, psI2c->CTL);
+        else
+            SIM_I2C_Schedule(psPeriph, SIM_I2C_OP_BYTE, 9);
+    }
+}
+
+static void SIM_I2C_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+    uint32_t u32SiWas, u32Status;
+
+    if(u32Offset == 0x0C)
+    {
+        SIM_SET_RO(psI2c->STATUS, u32Old);     /* Read-only */
+        return;
+    }
+    if((u32Offset == 0x08) && psState->u32DmaReq && (psI2c->CTL1 & I2C_CTL1_TXPDMAEN_Msk))
+    {
+        psState->u32DmaReq = 0;
+        if(psState->psHost != NULL)
+            SIM_I2C_HostRelease(psPeriph, 0xB8, psI2c->CTL);
+        else
+            SIM_I2C_Schedule(psPeriph, SIM_I2C_OP_BYTE, 9);
+        return;
+    }
+    if(u32Offset == 0x44)
+    {
+        /* PDMA disabled with a byte waiting: the byte interrupts instead */
+        if(psState->u32DmaReq && !(u32New & (I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk)))
+        {
+            psState->u32DmaReq = 0;
+            psI2c->CTL |= I2C_CTL_SI_Msk;
+            SIM_I2C_Update(psPeriph);
+        }
+        return;
+    }
+    if(u32Offset != 0x00)
+        return;
+
+    u32SiWas = u32Old & I2C_CTL_SI_Msk;
+    if(!(u32New & I2C_CTL_I2CEN_Msk))
+    {
+        psI2c->CTL = u32New & ~(I2C_CTL_SI_Msk | I2C_CTL_STO_Msk);
+        SIM_SET_RO(psI2c->STATUS, 0xF8);
+        psState->u32Op = SIM_I2C_OP_NONE;
+        psState->u32Owned = 0;
+        SIM_I2C_Update(psPeriph);
+        return;
+    }
+
+    if(u32SiWas && !(u32New & I2C_CTL_SI_Msk))
+    {
+        /* SI is only cleared by writing 1 */
+        psI2c->CTL = u32New | I2C_CTL_SI_Msk;
+        SIM_I2C_Update(psPeriph);
+        return;
+    }
+    psI2c->CTL = u32New & ~I2C_CTL_SI_Msk;
+
+    if(psState->u32Op != SIM_I2C_OP_NONE)
+    {
+        SIM_I2C_Update(psPeriph);
+        return;
+    }
+
+    u32Status = psI2c->STATUS & 0xFF;
+    if((u32New & I2C_CTL_STO_Msk) && psState->u32Owned)
+        SIM_I2C_Schedule(psPeriph, (u32New & I2C_CTL_STA_Msk) ? SIM_I2C_OP_STOP_START : SIM_I2C_OP_STOP, 1);
+    else if(u32New & I2C_CTL_STA_Msk)
+        SIM_I2C_Schedule(psPeriph, SIM_I2C_OP_START, 1);
+    else if(u32New & I2C_CTL_STO_Msk)
+        psI2c->CTL &= ~I2C_CTL_STO_Msk;     /* STOP on an idle bus */
+    else if(u32SiWas && (psState->psHost != NULL))
+        SIM_I2C_HostRelease(psPeriph, u32Status, u32New);
+    else if(u32SiWas && ((u32Status == 0x18) || (u32Status == 0x28)) && (psI2c->CTL1 & I2C_CTL1_TXPDMAEN_Msk))
+        psState->u32DmaReq = 1;             /* PDMA writes the next data byte */
+    else if(u32SiWas && ((u32Status == 0x08) || (u32Status == 0x10) || (u32Status == 0x18) || (u32Status == 0x28) ||
+                         (u32Status == 0x40) || (u32Status == 0x50)))
+        SIM_I2C_Schedule(psPeriph, SIM_I2C_OP_BYTE, 9);
+
+    SIM_I2C_Update(psPeriph);
+}
+
+static void SIM_I2C_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+    I2C_T *psI2c = SIM_REGS(I2C_T, psPeriph->u32Base);
+
+    psState->psTarget = NULL;
+    psState->psHost = NULL;
+    psState->u32Owned = 0;
+    psState->u32Op = SIM_I2C_OP_NONE;
+    psState->u32DmaReq = 0;
+    memset(psI2c, 0, psPeriph->u32Size);
+    SIM_SET_RO(psI2c->STATUS, 0xF8);
+    psI2c->CTL1 = 0;
+}
+
+static uint32_t SIM_I2C_TxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+
+    return psState->u32DmaReq && (SIM_REGS(I2C_T, psPeriph->u32Base)->CTL1 & I2C_CTL1_TXPDMAEN_Msk);
+}
+
+static uint32_t SIM_I2C_RxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+
+    return psState->u32DmaReq && (SIM_REGS(I2C_T, psPeriph->u32Base)->CTL1 & I2C_CTL1_RXPDMAEN_Msk);
+}
+
+static uint32_t SIM_I2C0_TxReq(void)
+{
+    return SIM_I2C_TxReq(&g_sSimI2c0);
+}
+static uint32_t SIM_I2C0_RxReq(void)
+{
+    return SIM_I2C_RxReq(&g_sSimI2c0);
+}
+static uint32_t SIM_I2C1_TxReq(void)
+{
+    return SIM_I2C_TxReq(&g_sSimI2c1);
+}
+static uint32_t SIM_I2C1_RxReq(void)
+{
+    return SIM_I2C_RxReq(&g_sSimI2c1);
+}
+
+static void SIM_I2C0_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_I2C0_TX, SIM_I2C0_TxReq);
+    SIM_PDMA_SetRequest(PDMA_I2C0_RX, SIM_I2C0_RxReq);
+}
+
+static void SIM_I2C1_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_I2C_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_I2C1_TX, SIM_I2C1_TxReq);
+    SIM_PDMA_SetRequest(PDMA_I2C1_RX, SIM_I2C1_RxReq);
+}
+
+SIM_PERIPH_T g_sSimI2c0 =
+{
+    "I2C0", I2C0_BASE, 0x1000, I2C0_IRQn, &s_asI2c[0],
+    SIM_I2C0_Reset, SIM_I2C_Read, SIM_I2C_Write, SIM_I2C_Tick
+};
+
+SIM_PERIPH_T g_sSimI2c1 =
+{
+    "I2C1", I2C1_BASE, 0x1000, I2C1_IRQn, &s_asI2c[1],
+    SIM_I2C1_Reset, SIM_I2C_Read, SIM_I2C_Write, SIM_I2C_Tick
+};
+
+/**
+  * @brief      Attach a slave device model to an I2C bus
+  * @param[in]  i2c     The pointer of the specified I2C module
+  * @param[in]  psDev   Device, must stay valid while attached
+  * @retval     0       Success
+  * @retval     -1      Bus already has the maximum number of devices
+  */
+int32_t SIM_I2C_AttachDevice(I2C_T *i2c, SIM_I2C_DEV_T *psDev)
+{
+    SIM_I2C_STATE_T *psState = (i2c == I2C0) ? &s_asI2c[0] : &s_asI2c[1];
+    uint32_t i;
+
+    for(i = 0; i < SIM_I2C_MAX_DEV; i++)
+    {
+        if((psState->apsDev[i] == NULL) || (psState->apsDev[i] == psDev))
+        {
+            psState->apsDev[i] = psDev;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Register-file device: first bytes after SLA+W set the register pointer, the rest are data */
+static void SIM_I2C_MemStart(void *pvCtx, uint32_t u32Read)
+{
+    SIM_I2C_MEM_T *psMem = pvCtx;
+
+    if(!u32Read)
+        psMem->u32Phase = 0;
+}
+
+static uint32_t SIM_I2C_MemWrite(void *pvCtx, uint8_t u8Data)
+{
+    SIM_I2C_MEM_T *psMem = pvCtx;
+
+    if(psMem->u32Phase < psMem->u32AddrBytes)
+    {
+        psMem->u32Ptr = (psMem->u32Phase == 0) ? u8Data : ((psMem->u32Ptr << 8) | u8Data);
+        psMem->u32Phase++;
+    }
+    else
+    {
+        psMem->pu8Mem[psMem->u32Ptr % psMem->u32Size] = u8Data;
+        psMem->u32Ptr++;
+    }
+    return 1;
+}
+
+static uint8_t SIM_I2C_MemRead(void *pvCtx)
+{
+    SIM_I2C_MEM_T *psMem = pvCtx;
+
+    return psMem->pu8Mem[psMem->u32Ptr++ % psMem->u32Size];
+}
+
+/* Fill in the device callbacks of a register file, the USCI model attaches it too */
+void SIM_I2C_InitMemory(SIM_I2C_MEM_T *psMem, uint8_t u8Addr, uint8_t *pu8Mem, uint32_t u32Size, uint32_t u32AddrBytes)
+{
+    memset(psMem, 0, sizeof(SIM_I2C_MEM_T));
+    psMem->sDev.u8Addr = u8Addr;
+    psMem->sDev.pfnStart = SIM_I2C_MemStart;
+    psMem->sDev.pfnWrite = SIM_I2C_MemWrite;
+    psMem->sDev.pfnRead = SIM_I2C_MemRead;
+    psMem->sDev.pvCtx = psMem;
+    psMem->pu8Mem = pu8Mem;
+    psMem->u32Size = u32Size;
+    psMem->u32AddrBytes = u32AddrBytes;
+}
+
+/**
+  * @brief      Attach an EEPROM-style register file to an I2C bus
+  * @param[in]  i2c             The pointer of the specified I2C module
+  * @param[out] psMem           Device instance to initialize, must stay valid while attached
+  * @param[in]  u8Addr          7-bit slave address
+  * @param[in]  pu8Mem          Backing storage
+  * @param[in]  u32Size         Backing storage size in bytes
+  * @param[in]  u32AddrBytes    Register address length, 1 or 2
+  * @retval     0       Success
+  * @retval     -1      Bus already has the maximum number of devices
+  */
+int32_t SIM_I2C_AttachMemory(I2C_T *i2c, SIM_I2C_MEM_T *psMem, uint8_t u8Addr, uint8_t *pu8Mem, uint32_t u32Size, uint32_t u32AddrBytes)
+{
+    SIM_I2C_InitMemory(psMem, u8Addr, pu8Mem, u32Size, u32AddrBytes);
+    return SIM_I2C_AttachDevice(i2c, &psMem->sDev);
+}
+
+/**
+  * @brief      Run a transfer from an external master to the I2C controller in slave mode
+  * @param[in]  i2c     The pointer of the specified I2C module
+  * @param[in]  psXfer  Transfer, must stay valid until u32Done is set
+  * @retval     0       Transfer started: START, SLA+W and u32WrLen bytes, then when u32RdLen is not
+  *                     zero a repeated START, SLA+R and u32RdLen bytes with NACK on the last, then STOP
+  * @retval     -1      The bus is busy
+  * @details    Steps advance with simulated time at u32BusHz while the controller does not hold SCL
+  *             low, i.e. while SI is clear. An address or data NACK ends the transfer with a STOP.
+  */
+int32_t SIM_I2C_HostXfer(I2C_T *i2c, SIM_I2C_HOST_XFER_T *psXfer)
+{
+    SIM_PERIPH_T *psPeriph = (i2c == I2C0) ? &g_sSimI2c0 : &g_sSimI2c1;
+    SIM_I2C_STATE_T *psState = psPeriph->pvState;
+
+    if((psState->psHost != NULL) || psState->u32Owned || (psState->u32Op != SIM_I2C_OP_NONE))
+        return -1;
+
+    psXfer->u32Done = 0;
+    psXfer->i32Status = 0;
+    psXfer->u64Start = g_u64SimCycles;
+    psState->psHost = psXfer;
+    SIM_I2C_HostSchedule(psPeriph, psXfer->u32WrLen ? SIM_I2C_HOST_ADDR_W : SIM_I2C_HOST_ADDR_R, 10);
+    return 0;
+}
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,335 @@
+/**************************************************************************//**
+ * @file     sim_pdma.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator PDMA model
+ *
+ * @note     Five channels sharing one transfer engine that moves one data unit every
+ *           SIM_PDMA_UNIT_CYCLES cycles, round-robin between channels with work.
+ *           Memory channels run a whole table per software request; peripheral channels
+ *           move one unit whenever the selected request line is high. Scatter-gather
+ *           descriptors are fetched from SCATBA + offset and written back with OPMODE 0.
+ *           Channel 0/1 request time-out counts HCLK/2^(8+TOUTPSC) from the last unit moved
+ *           (or from TOUTEN/flag clear) and sets REQTOFn once TOCn periods pass without one.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+#define SIM_PDMA_CH_NUM         5
+#define SIM_PDMA_REQ_NUM        64
+#define SIM_PDMA_UNIT_CYCLES    4       /* One read plus one write on AHB */
+
+typedef struct
+{
+    uint32_t u32Run;            /* Table loaded and not finished */
+    uint32_t u32Scatter;        /* Channel runs a descriptor chain */
+    uint32_t u32Remain;         /* Units left in the current table */
+    uint32_t u32SA;
+    uint32_t u32DA;
+    uint32_t u32SwReq;          /* Software request latched */
+} SIM_PDMA_CH_T;
+
+typedef struct
+{
+    SIM_PDMA_CH_T asCh[SIM_PDMA_CH_NUM];
+    uint32_t u32NextCh;         /* Round-robin pointer */
+    uint64_t u64Time;           /* Engine time */
+    uint64_t au64ToutRef[2];    /* Start of the current request time-out period, channel 0/1 */
+} SIM_PDMA_STATE_T;
+
+static SIM_PDMA_STATE_T s_sPdma;
+static SIM_PDMA_REQ_T s_apfnReq[SIM_PDMA_REQ_NUM];
+
+void SIM_PDMA_SetRequest(uint32_t u32Src, SIM_PDMA_REQ_T pfnReady)
+{
+    if(u32Src < SIM_PDMA_REQ_NUM)
+        s_apfnReq[u32Src] = pfnReady;
+}
+
+static uint32_t SIM_PDMA_ReqSrc(PDMA_T *psPdma, uint32_t u32Ch)
+{
+    if(u32Ch < 4)
+        return (psPdma->REQSEL0_3 >> (u32Ch * 8)) & 0x3F;
+    return psPdma->REQSEL4 & 0x3F;
+}
+
+static void SIM_PDMA_Update(SIM_PERIPH_T *psPeriph)
+{
+    PDMA_T *psPdma = SIM_REGS(PDMA_T, psPeriph->u32Base);
+    uint32_t u32Sts = 0, u32Trg = 0, u32Act = 0, i;
+
+    for(i = 0; i < SIM_PDMA_CH_NUM; i++)
+    {
+        if(s_sPdma.asCh[i].u32Run || s_sPdma.asCh[i].u32SwReq)
+            u32Trg |= 1UL << i;
+        if(s_sPdma.asCh[i].u32Run)
+            u32Act |= 1UL << i;
+    }
+    *(volatile uint32_t *)&psPdma->TRGSTS = u32Trg;
+    *(volatile uint32_t *)&psPdma->TACTSTS = u32Act;
+
+    if(psPdma->ABTSTS)
+        u32Sts |= PDMA_INTSTS_ABTIF_Msk;
+    if(psPdma->TDSTS)
+        u32Sts |= PDMA_INTSTS_TDIF_Msk;
+    if(psPdma->SCATSTS)
+        u32Sts |= PDMA_INTSTS_TEIF_Msk;
+    psPdma->INTSTS = (psPdma->INTSTS & (PDMA_INTSTS_REQTOF0_Msk | PDMA_INTSTS_REQTOF1_Msk)) | u32Sts;
+
+    psPeriph->u32IrqLine = (((psPdma->TDSTS | psPdma->ABTSTS | psPdma->SCATSTS) & psPdma->INTEN) ||
+                            ((psPdma->INTSTS >> PDMA_INTSTS_REQTOF0_Pos) & psPdma->TOUTIEN & 0x3)) ? 1 : 0;
+}
+
+/* Make the table in DSCT[u32Ch] current. Returns 0 if the channel has nothing to do. */
+static uint32_t SIM_PDMA_Load(PDMA_T *psPdma, uint32_t u32Ch)
+{
+    SIM_PDMA_CH_T *psCh = &s_sPdma.asCh[u32Ch];
+    uint32_t u32Ctl = psPdma->DSCT[u32Ch].CTL, u32Desc;
+
+    if((u32Ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_SCATTER)
+    {
+        /* Fetch the next descriptor into the channel registers */
+        u32Desc = (psPdma->SCATBA & PDMA_SCATBA_SCATBA_Msk) + (psPdma->DSCT[u32Ch].NEXT & 0xFFFC);
+        psPdma->DSCT[u32Ch].CTL = u32Ctl = SIM_BusRead(u32Desc + 0x0, 4);
+        psPdma->DSCT[u32Ch].SA = SIM_BusRead(u32Desc + 0x4, 4);
+        psPdma->DSCT[u32Ch].DA = SIM_BusRead(u32Desc + 0x8, 4);
+        psPdma->DSCT[u32Ch].NEXT = SIM_BusRead(u32Desc + 0xC, 4);
+        *(volatile uint32_t *)&psPdma->CURSCAT[u32Ch] = u32Desc;
+        psCh->u32Scatter = 1;
+    }
+
+    if((u32Ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_STOP)
+    {
+        psPdma->SCATSTS |= 1UL << u32Ch;
+        psCh->u32Run = 0;
+        psCh->u32Scatter = 0;
+        return 0;
+    }
+
+    psCh->u32Remain = ((u32Ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1;
+    psCh->u32SA = psPdma->DSCT[u32Ch].SA;
+    psCh->u32DA = psPdma->DSCT[u32Ch].DA;
+    psCh->u32Run = 1;
+    return 1;
+}
+
+static void SIM_PDMA_TableDone(PDMA_T *psPdma, uint32_t u32Ch)
+{
+    SIM_PDMA_CH_T *psCh = &s_sPdma.asCh[u32Ch];
+    uint32_t u32Ctl = psPdma->DSCT[u32Ch].CTL;
+
+    psPdma->DSCT[u32Ch].CTL = u32Ctl & ~(PDMA_DSCT_CTL_OPMODE_Msk | PDMA_DSCT_CTL_TXCNT_Msk);
+    if(psCh->u32Scatter)
+        SIM_BusWrite(psPdma->CURSCAT[u32Ch], psPdma->DSCT[u32Ch].CTL, 4);   /* Table in SRAM goes idle too */
+
+    if((u32Ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_SCATTER)
+    {
+        /* More tables follow: report this one unless the table interrupt is disabled */
+        if(!(u32Ctl & PDMA_DSCT_CTL_TBINTDIS_Msk))
+            psPdma->TDSTS |= 1UL << u32Ch;
+        psPdma->DSCT[u32Ch].CTL |= PDMA_OP_SCATTER;
+        if(SIM_PDMA_Load(psPdma, u32Ch))
+            return;
+    }
+    else
+        psPdma->TDSTS |= 1UL << u32Ch;
+
+    psCh->u32Run = 0;
+    psCh->u32Scatter = 0;
+    psCh->u32SwReq = 0;
+}
+
+/* Channel has a unit ready to move now */
+static uint32_t SIM_PDMA_Ready(PDMA_T *psPdma, uint32_t u32Ch)
+{
+    SIM_PDMA_CH_T *psCh = &s_sPdma.asCh[u32Ch];
+    uint32_t u32Src;
+
+    if(!(psPdma->CHCTL & (1UL << u32Ch)))
+        return 0;
+
+    u32Src = SIM_PDMA_ReqSrc(psPdma, u32Ch);
+    if(u32Src == PDMA_MEM)
+    {
+        if(!psCh->u32SwReq)
+            return 0;
+        if(!psCh->u32Run && !SIM_PDMA_Load(psPdma, u32Ch))
+        {
+            psCh->u32SwReq = 0;
+            return 0;
+        }
+        return 1;
+    }
+
+    if((s_apfnReq[u32Src] == NULL) || !s_apfnReq[u32Src]())
+        return 0;
+    if(!psCh->u32Run)
+    {
+        /* Peripheral request on an idle channel only starts a table that is set up */
+        if((psPdma->DSCT[u32Ch].CTL & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_STOP)
+            return 0;
+        return SIM_PDMA_Load(psPdma, u32Ch);
+    }
+    return 1;
+}
+
+static void SIM_PDMA_Unit(PDMA_T *psPdma, uint32_t u32Ch)
+{
+    SIM_PDMA_CH_T *psCh = &s_sPdma.asCh[u32Ch];
+    uint32_t u32Ctl = psPdma->DSCT[u32Ch].CTL;
+    uint32_t u32Width = 1UL << ((u32Ctl & PDMA_DSCT_CTL_TXWIDTH_Msk) >> PDMA_DSCT_CTL_TXWIDTH_Pos);
+    uint32_t u32Data;
+
+    u32Data = SIM_BusRead(psCh->u32SA, u32Width);
+    SIM_BusWrite(psCh->u32DA, u32Data, u32Width);
+
+    if((u32Ctl & PDMA_DSCT_CTL_SAINC_Msk) != PDMA_SAR_FIX)
+        psCh->u32SA += u32Width;
+    if((u32Ctl & PDMA_DSCT_CTL_DAINC_Msk) != PDMA_DAR_FIX)
+        psCh->u32DA += u32Width;
+
+    psCh->u32Remain--;
+    if(u32Ch < 2)
+        s_sPdma.au64ToutRef[u32Ch] = s_sPdma.u64Time;
+    if(psCh->u32Remain)
+        psPdma->DSCT[u32Ch].CTL = (u32Ctl & ~PDMA_DSCT_CTL_TXCNT_Msk) | ((psCh->u32Remain - 1) << PDMA_DSCT_CTL_TXCNT_Pos);
+    else
+        SIM_PDMA_TableDone(psPdma, u32Ch);
+}
+
+static void SIM_PDMA_Timeout(PDMA_T *psPdma)
+{
+    uint32_t u32Ch, u32Toc, u32Psc;
+
+    for(u32Ch = 0; u32Ch < 2; u32Ch++)
+    {
+        if(!(psPdma->TOUTEN & psPdma->CHCTL & (1UL << u32Ch)) || (psPdma->INTSTS & (PDMA_INTSTS_REQTOF0_Msk << u32Ch)))
+            continue;
+        u32Toc = (psPdma->TOC0_1 >> (u32Ch * 16)) & 0xFFFF;
+        u32Psc = (psPdma->TOUTPSC >> (u32Ch * 4)) & 0x7;
+        if(u32Toc && (g_u64SimCycles - s_sPdma.au64ToutRef[u32Ch] >= ((uint64_t)u32Toc << (8 + u32Psc))))
+            psPdma->INTSTS |= PDMA_INTSTS_REQTOF0_Msk << u32Ch;
+    }
+}
+
+static void SIM_PDMA_Tick(SIM_PERIPH_T *psPeriph)
+{
+    PDMA_T *psPdma = SIM_REGS(PDMA_T, psPeriph->u32Base);
+    uint32_t i, u32Ch, u32Moved;
+
+    while(s_sPdma.u64Time + SIM_PDMA_UNIT_CYCLES <= g_u64SimCycles)
+    {
+        u32Moved = 0;
+        for(i = 0; i < SIM_PDMA_CH_NUM; i++)
+        {
+            u32Ch = (s_sPdma.u32NextCh + i) % SIM_PDMA_CH_NUM;
+            if(SIM_PDMA_Ready(psPdma, u32Ch))
+            {
+                SIM_PDMA_Unit(psPdma, u32Ch);
+                s_sPdma.u32NextCh = (u32Ch + 1) % SIM_PDMA_CH_NUM;
+                u32Moved = 1;
+                break;
+            }
+        }
+        if(!u32Moved)
+        {
+            s_sPdma.u64Time = g_u64SimCycles;
+            break;
+        }
+        s_sPdma.u64Time += SIM_PDMA_UNIT_CYCLES;
+    }
+    SIM_PDMA_Timeout(psPdma);
+    SIM_PDMA_Update(psPeriph);
+}
+
+static void SIM_PDMA_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    (void)u32Offset;
+    (void)u32IsWrite;
+    SIM_PDMA_Update(psPeriph);
+}
+
+static void SIM_PDMA_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    PDMA_T *psPdma = SIM_REGS(PDMA_T, psPeriph->u32Base);
+    uint32_t i;
+
+    switch(u32Offset)
+    {
+        case 0x400:                     /* CHCTL: disabling a channel drops its table */
+            for(i = 0; i < SIM_PDMA_CH_NUM; i++)
+            {
+                if(!(u32New & (1UL << i)))
+                {
+                    s_sPdma.asCh[i].u32Run = 0;
+                    s_sPdma.asCh[i].u32SwReq = 0;
+                }
+            }
+            break;
+        case 0x404:                     /* PAUSE */
+            for(i = 0; i < SIM_PDMA_CH_NUM; i++)
+                if(u32New & (1UL << i))
+                    s_sPdma.asCh[i].u32Run = 0;
+            psPdma->PAUSE = 0;
+            break;
+        case 0x408:                     /* SWREQ */
+            for(i = 0; i < SIM_PDMA_CH_NUM; i++)
+                if(u32New & (1UL << i) & psPdma->CHCTL)
+                    s_sPdma.asCh[i].u32SwReq = 1;
+            psPdma->SWREQ = 0;
+            break;
+        case 0x40C:
+        case 0x42C:
+            *(volatile uint32_t *)SIM_Alias(psPeriph->u32Base + u32Offset) = u32Old;
+            break;
+        case 0x41C:                     /* INTSTS: only time-out flags are write 1 to clear */
+            psPdma->INTSTS = u32Old & ~(u32New & (PDMA_INTSTS_REQTOF0_Msk | PDMA_INTSTS_REQTOF1_Msk));
+            for(i = 0; i < 2; i++)
+                if(u32New & (PDMA_INTSTS_REQTOF0_Msk << i))
+                    s_sPdma.au64ToutRef[i] = g_u64SimCycles;
+            break;
+        case 0x434:                     /* TOUTEN: time-out period starts when enabled */
+            for(i = 0; i < 2; i++)
+                if((u32New & ~u32Old) & (1UL << i))
+                    s_sPdma.au64ToutRef[i] = g_u64SimCycles;
+            break;
+        case 0x420:
+        case 0x424:
+        case 0x428:                     /* ABTSTS / TDSTS / SCATSTS: write 1 to clear */
+            *(volatile uint32_t *)SIM_Alias(psPeriph->u32Base + u32Offset) = u32Old & ~u32New;
+            break;
+        case 0x460:                     /* RESET: drop the table and clear the channel enable */
+            for(i = 0; i < SIM_PDMA_CH_NUM; i++)
+                if(u32New & (1UL << i))
+                    memset(&s_sPdma.asCh[i], 0, sizeof(SIM_PDMA_CH_T));
+            psPdma->CHCTL &= ~u32New;
+            psPdma->RESET = 0;
+            break;
+        default:
+            break;
+    }
+    SIM_PDMA_Update(psPeriph);
+}
+
+static void SIM_PDMA_Reset(SIM_PERIPH_T *psPeriph)
+{
+    memset(&s_sPdma, 0, sizeof(s_sPdma));
+    s_sPdma.u64Time = g_u64SimCycles;
+    memset(SIM_Alias(psPeriph->u32Base), 0, psPeriph->u32Size);
+}
+
+SIM_PERIPH_T g_sSimPdma =
+{
+    "PDMA", PDMA_BASE, 0x1000, PDMA_IRQn, NULL,
+    SIM_PDMA_Reset, SIM_PDMA_Read, SIM_PDMA_Write, SIM_PDMA_Tick
+};
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,306 @@
+/**************************************************************************//**
+ * @file     sim_spi.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator SPI model (master mode)
+ *
+ * @note     4-level TX/RX FIFOs, bus clock from SPI_CLKDIV, manual and automatic slave
+ *           select, FIFO threshold/unit interrupts and PDMA requests. MISO data comes from
+ *           an attached device model; without one MOSI is looped back to MISO.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+#define SIM_SPI_FIFO_DEPTH      4
+
+typedef struct
+{
+    uint32_t u32Index;
+    const SIM_SPI_DEV_T *psDev;
+
+    uint32_t au32TxFifo[SIM_SPI_FIFO_DEPTH];
+    uint32_t u32TxHead, u32TxCnt;
+    uint32_t au32RxFifo[SIM_SPI_FIFO_DEPTH];
+    uint32_t u32RxHead, u32RxCnt;
+
+    uint32_t u32Shift;                  /* 1 while a data unit is on the bus */
+    uint32_t u32ShiftData;
+    uint64_t u64ShiftDone;
+    uint32_t u32Selected;               /* Current slave select state seen by the device */
+} SIM_SPI_STATE_T;
+
+static SIM_SPI_STATE_T s_asSpi[2] = { {0}, {1} };
+
+static uint32_t SIM_SPI_Width(SPI_T *psSpi)
+{
+    uint32_t u32Width = (psSpi->CTL & SPI_CTL_DWIDTH_Msk) >> SPI_CTL_DWIDTH_Pos;
+
+    return (u32Width == 0) ? 32 : u32Width;
+}
+
+static void SIM_SPI_Select(SIM_SPI_STATE_T *psState, uint32_t u32Active)
+{
+    if(psState->u32Selected == u32Active)
+        return;
+    psState->u32Selected = u32Active;
+    if((psState->psDev != NULL) && (psState->psDev->pfnSelect != NULL))
+        psState->psDev->pfnSelect(psState->psDev->pvCtx, u32Active);
+}
+
+static void SIM_SPI_Update(SIM_PERIPH_T *psPeriph)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+    SPI_T *psSpi = SIM_REGS(SPI_T, psPeriph->u32Base);
+    uint32_t u32Sts, u32Fifo = psSpi->FIFOCTL, u32Irq = 0;
+
+    u32Sts = psSpi->STATUS & (SPI_STATUS_UNITIF_Msk | SPI_STATUS_RXOVIF_Msk);
+    if(psState->u32Shift || psState->u32TxCnt)
+        u32Sts |= SPI_STATUS_BUSY_Msk;
+    if(psState->u32RxCnt == 0)
+        u32Sts |= SPI_STATUS_RXEMPTY_Msk;
+    if(psState->u32RxCnt == SIM_SPI_FIFO_DEPTH)
+        u32Sts |= SPI_STATUS_RXFULL_Msk;
+    if(psState->u32TxCnt == 0)
+        u32Sts |= SPI_STATUS_TXEMPTY_Msk;
+    if(psState->u32TxCnt == SIM_SPI_FIFO_DEPTH)
+        u32Sts |= SPI_STATUS_TXFULL_Msk;
+    if(psState->u32RxCnt > ((u32Fifo & SPI_FIFOCTL_RXTH_Msk) >> SPI_FIFOCTL_RXTH_Pos))
+        u32Sts |= SPI_STATUS_RXTHIF_Msk;
+    if(psState->u32TxCnt <= ((u32Fifo & SPI_FIFOCTL_TXTH_Msk) >> SPI_FIFOCTL_TXTH_Pos))
+        u32Sts |= SPI_STATUS_TXTHIF_Msk;
+    if(psSpi->CTL & SPI_CTL_SPIEN_Msk)
+        u32Sts |= SPI_STATUS_SPIENSTS_Msk;
+    u32Sts |= (psState->u32RxCnt & 0xF) << SPI_STATUS_RXCNT_Pos;
+    u32Sts |= (psState->u32TxCnt & 0xF) << SPI_STATUS_TXCNT_Pos;
+    psSpi->STATUS = u32Sts;
+
+    if((u32Sts & SPI_STATUS_UNITIF_Msk) && (psSpi->CTL & SPI_CTL_UNITIEN_Msk))
+        u32Irq = 1;
+    if((u32Sts & SPI_STATUS_RXTHIF_Msk) && (u32Fifo & SPI_FIFOCTL_RXTHIEN_Msk))
+        u32Irq = 1;
+    if((u32Sts & SPI_STATUS_TXTHIF_Msk) && (u32Fifo & SPI_FIFOCTL_TXTHIEN_Msk))
+        u32Irq = 1;
+    if((u32Sts & SPI_STATUS_RXOVIF_Msk) && (u32Fifo & SPI_FIFOCTL_RXOVIEN_Msk))
+        u32Irq = 1;
+    psPeriph->u32IrqLine = u32Irq;
+}
+
+static void SIM_SPI_Start(SIM_PERIPH_T *psPeriph, uint64_t u64Start)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+    SPI_T *psSpi = SIM_REGS(SPI_T, psPeriph->u32Base);
+    uint32_t u32Div = ((psSpi->CLKDIV & SPI_CLKDIV_DIVIDER_Msk) >> SPI_CLKDIV_DIVIDER_Pos) + 1;
+    uint32_t u32Clocks = SIM_SPI_Width(psSpi) + ((psSpi->CTL & SPI_CTL_SUSPITV_Msk) >> SPI_CTL_SUSPITV_Pos);
+
+    if((psSpi->CTL & SPI_CTL_SPIEN_Msk) == 0)
+        return;
+
+    psState->u32ShiftData = psState->au32TxFifo[psState->u32TxHead];
+    psState->u32TxHead = (psState->u32TxHead + 1) % SIM_SPI_FIFO_DEPTH;
+    psState->u32TxCnt--;
+    psState->u32Shift = 1;
+    psState->u64ShiftDone = u64Start + SIM_ClkToCycles((uint64_t)u32Clocks * u32Div, SIM_ClkGetSPI(psState->u32Index));
+
+    if(psSpi->SSCTL & SPI_SSCTL_AUTOSS_Msk)
+        SIM_SPI_Select(psState, 1);
+}
+
+static void SIM_SPI_Tick(SIM_PERIPH_T *psPeriph)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+    SPI_T *psSpi = SIM_REGS(SPI_T, psPeriph->u32Base);
+    uint32_t u32Width, u32Rx;
+
+    while(psState->u32Shift && (psState->u64ShiftDone <= g_u64SimCycles))
+    {
+        u32Width = SIM_SPI_Width(psSpi);
+        if(psState->psDev != NULL)
+            u32Rx = psState->psDev->pfnTransfer(psState->psDev->pvCtx, psState->u32ShiftData, u32Width);
+        else
+            u32Rx = psState->u32ShiftData;
+        if(u32Width < 32)
+            u32Rx &= (1UL << u32Width) - 1;
+
+        if(psState->u32RxCnt >= SIM_SPI_FIFO_DEPTH)
+            psSpi->STATUS |= SPI_STATUS_RXOVIF_Msk;
+        else
+        {
+            psState->au32RxFifo[(psState->u32RxHead + psState->u32RxCnt) % SIM_SPI_FIFO_DEPTH] = u32Rx;
+            psState->u32RxCnt++;
+        }
+        psSpi->STATUS |= SPI_STATUS_UNITIF_Msk;
+        psState->u32Shift = 0;
+
+        if(psState->u32TxCnt)
+            SIM_SPI_Start(psPeriph, psState->u64ShiftDone);
+        else if(psSpi->SSCTL & SPI_SSCTL_AUTOSS_Msk)
+            SIM_SPI_Select(psState, 0);
+    }
+    SIM_SPI_Update(psPeriph);
+}
+
+static void SIM_SPI_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+    SPI_T *psSpi = SIM_REGS(SPI_T, psPeriph->u32Base);
+
+    SIM_SPI_Tick(psPeriph);
+    if((u32Offset == 0x30) && !u32IsWrite && psState->u32RxCnt)
+    {
+        *(volatile uint32_t *)&psSpi->RX = psState->au32RxFifo[psState->u32RxHead];
+        psState->u32RxHead = (psState->u32RxHead + 1) % SIM_SPI_FIFO_DEPTH;
+        psState->u32RxCnt--;
+        SIM_SPI_Update(psPeriph);
+    }
+}
+
+static void SIM_SPI_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+    SPI_T *psSpi = SIM_REGS(SPI_T, psPeriph->u32Base);
+    uint32_t u32Clr;
+
+    switch(u32Offset)
+    {
+        case 0x00:                      /* CTL: enabling starts pending data */
+            if(!psState->u32Shift && psState->u32TxCnt)
+                SIM_SPI_Start(psPeriph, g_u64SimCycles);
+            break;
+        case 0x08:                      /* SSCTL: manual slave select */
+            if(!(u32New & SPI_SSCTL_AUTOSS_Msk))
+                SIM_SPI_Select(psState, (u32New & SPI_SSCTL_SS_Msk) ? 1 : 0);
+            break;
+        case 0x0C:
+            psSpi->PDMACTL = u32New & ~SPI_PDMACTL_PDMARST_Msk;
+            break;
+        case 0x10:                      /* FIFOCTL: reset bits self-clear */
+            if(u32New & (SPI_FIFOCTL_RXRST_Msk | SPI_FIFOCTL_RXFBCLR_Msk))
+            {
+                psState->u32RxCnt = 0;
+                psState->u32RxHead = 0;
+            }
+            if(u32New & (SPI_FIFOCTL_TXRST_Msk | SPI_FIFOCTL_TXFBCLR_Msk))
+            {
+                psState->u32TxCnt = 0;
+                psState->u32TxHead = 0;
+            }
+            if(u32New & SPI_FIFOCTL_RXRST_Msk)
+                psSpi->STATUS &= ~SPI_STATUS_RXOVIF_Msk;
+            psSpi->FIFOCTL = u32New & ~(SPI_FIFOCTL_RXRST_Msk | SPI_FIFOCTL_TXRST_Msk | SPI_FIFOCTL_RXFBCLR_Msk | SPI_FIFOCTL_TXFBCLR_Msk);
+            break;
+        case 0x14:                      /* STATUS: write 1 to clear */
+            u32Clr = u32New & (SPI_STATUS_UNITIF_Msk | SPI_STATUS_RXOVIF_Msk | SPI_STATUS_SSACTIF_Msk | SPI_STATUS_SSINAIF_Msk |
+                               SPI_STATUS_RXTOIF_Msk | SPI_STATUS_TXUFIF_Msk);
+            psSpi->STATUS = u32Old & ~u32Clr;
+            break;
+        case 0x20:                      /* TX */
+            if(psState->u32TxCnt < SIM_SPI_FIFO_DEPTH)
+            {
+                psState->au32TxFifo[(psState->u32TxHead + psState->u32TxCnt) % SIM_SPI_FIFO_DEPTH] = u32New;
+                psState->u32TxCnt++;
+                if(!psState->u32Shift)
+                    SIM_SPI_Start(psPeriph, g_u64SimCycles);
+            }
+            break;
+        default:
+            break;
+    }
+    SIM_SPI_Update(psPeriph);
+}
+
+static void SIM_SPI_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+    SPI_T *psSpi = SIM_REGS(SPI_T, psPeriph->u32Base);
+    const SIM_SPI_DEV_T *psDev = psState->psDev;
+    uint32_t u32Index = psState->u32Index;
+
+    memset(psState, 0, sizeof(SIM_SPI_STATE_T));
+    psState->u32Index = u32Index;
+    psState->psDev = psDev;
+    memset(psSpi, 0, psPeriph->u32Size);
+    psSpi->CTL = 0x00000034;
+    psSpi->FIFOCTL = 0x22000000;
+    SIM_SPI_Update(psPeriph);
+}
+
+static uint32_t SIM_SPI_TxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+
+    return (SIM_REGS(SPI_T, psPeriph->u32Base)->PDMACTL & SPI_PDMACTL_TXPDMAEN_Msk) && (psState->u32TxCnt < SIM_SPI_FIFO_DEPTH);
+}
+
+static uint32_t SIM_SPI_RxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_SPI_STATE_T *psState = psPeriph->pvState;
+
+    return (SIM_REGS(SPI_T, psPeriph->u32Base)->PDMACTL & SPI_PDMACTL_RXPDMAEN_Msk) && (psState->u32RxCnt != 0);
+}
+
+static uint32_t SIM_SPI0_TxReq(void)
+{
+    return SIM_SPI_TxReq(&g_sSimSpi0);
+}
+static uint32_t SIM_SPI0_RxReq(void)
+{
+    return SIM_SPI_RxReq(&g_sSimSpi0);
+}
+static uint32_t SIM_SPI1_TxReq(void)
+{
+    return SIM_SPI_TxReq(&g_sSimSpi1);
+}
+static uint32_t SIM_SPI1_RxReq(void)
+{
+    return SIM_SPI_RxReq(&g_sSimSpi1);
+}
+
+static void SIM_SPI0_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_SPI_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_SPI0_TX, SIM_SPI0_TxReq);
+    SIM_PDMA_SetRequest(PDMA_SPI0_RX, SIM_SPI0_RxReq);
+}
+
+static void SIM_SPI1_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_SPI_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_SPI1_TX, SIM_SPI1_TxReq);
+    SIM_PDMA_SetRequest(PDMA_SPI1_RX, SIM_SPI1_RxReq);
+}
+
+SIM_PERIPH_T g_sSimSpi0 =
+{
+    "SPI0", SPI0_BASE, 0x1000, SPI0_IRQn, &s_asSpi[0],
+    SIM_SPI0_Reset, SIM_SPI_Read, SIM_SPI_Write, SIM_SPI_Tick
+};
+
+SIM_PERIPH_T g_sSimSpi1 =
+{
+    "SPI1", SPI1_BASE, 0x1000, SPI1_IRQn, &s_asSpi[1],
+    SIM_SPI1_Reset, SIM_SPI_Read, SIM_SPI_Write, SIM_SPI_Tick
+};
+
+/**
+  * @brief      Attach a slave device model to an SPI controller
+  * @param[in]  spi     The pointer of the specified SPI module
+  * @param[in]  psDev   Device callbacks, must stay valid while attached. NULL restores loopback.
+  * @return     None
+  */
+void SIM_SPI_AttachDevice(SPI_T *spi, const SIM_SPI_DEV_T *psDev)
+{
+    SIM_SPI_STATE_T *psState = (spi == SPI0) ? &s_asSpi[0] : &s_asSpi[1];
+
+    psState->psDev = psDev;
+    psState->u32Selected = 0;
+}
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
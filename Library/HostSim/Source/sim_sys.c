@@ -0,0 +1,461 @@
+/**************************************************************************//**
+ * @file     sim_sys.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator SYS, CLK and TIMER models
+ *
+ * @note
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Clock tree                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t SIM_ClkGetPLL(void)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    uint32_t u32PllReg = psClk->PLLCTL;
+    uint32_t u32FIN, u32NF, u32NR, u32NO;
+    const uint8_t au8NoTbl[4] = {1, 2, 2, 4};
+
+    if(u32PllReg & (CLK_PLLCTL_PD_Msk | CLK_PLLCTL_OE_Msk))
+        return 0;
+
+    u32FIN = (u32PllReg & CLK_PLLCTL_PLLSRC_HIRC) ? __HIRC : __HXT;
+    if(u32PllReg & CLK_PLLCTL_BP_Msk)
+        return u32FIN;
+
+    u32NO = au8NoTbl[(u32PllReg & CLK_PLLCTL_OUTDIV_Msk) >> CLK_PLLCTL_OUTDIV_Pos];
+    u32NF = ((u32PllReg & CLK_PLLCTL_FBDIV_Msk) >> CLK_PLLCTL_FBDIV_Pos) + 2;
+    u32NR = ((u32PllReg & CLK_PLLCTL_INDIV_Msk) >> CLK_PLLCTL_INDIV_Pos) + 2;
+
+    return (((u32FIN >> 2) * u32NF) / (u32NR * u32NO) << 2);
+}
+
+uint32_t SIM_ClkGetHCLK(void)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    const uint32_t au32Src[8] = {__HXT, __LXT, 0, __LIRC, __HIRC48, 0, 0, __HIRC};
+    uint32_t u32Sel = psClk->CLKSEL0 & CLK_CLKSEL0_HCLKSEL_Msk;
+    uint32_t u32Freq = (u32Sel == 2) ? SIM_ClkGetPLL() : au32Src[u32Sel];
+
+    u32Freq /= (psClk->CLKDIV0 & CLK_CLKDIV0_HCLKDIV_Msk) + 1;
+    return (u32Freq != 0) ? u32Freq : __HIRC;
+}
+
+uint32_t SIM_ClkGetPCLK0(void)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+
+    return (psClk->CLKSEL0 & CLK_CLKSEL0_PCLK0SEL_Msk) ? (SIM_ClkGetHCLK() >> 1) : SIM_ClkGetHCLK();
+}
+
+uint32_t SIM_ClkGetPCLK1(void)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+
+    return (psClk->CLKSEL0 & CLK_CLKSEL0_PCLK1SEL_Msk) ? (SIM_ClkGetHCLK() >> 1) : SIM_ClkGetHCLK();
+}
+
+uint32_t SIM_ClkGetUART(void)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    uint32_t u32Freq;
+
+    switch((psClk->CLKSEL1 & CLK_CLKSEL1_UARTSEL_Msk) >> CLK_CLKSEL1_UARTSEL_Pos)
+    {
+        case 0:
+            u32Freq = __HXT;
+            break;
+        case 1:
+            u32Freq = SIM_ClkGetPLL();
+            break;
+        case 2:
+            u32Freq = __LXT;
+            break;
+        default:
+            u32Freq = __HIRC;
+            break;
+    }
+    return u32Freq / (((psClk->CLKDIV0 & CLK_CLKDIV0_UARTDIV_Msk) >> CLK_CLKDIV0_UARTDIV_Pos) + 1);
+}
+
+uint32_t SIM_ClkGetSPI(uint32_t u32Index)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    uint32_t u32Pos = (u32Index == 0) ? CLK_CLKSEL2_SPI0SEL_Pos : CLK_CLKSEL2_SPI1SEL_Pos;
+
+    switch((psClk->CLKSEL2 >> u32Pos) & 0x3)
+    {
+        case 0:
+            return __HXT;
+        case 1:
+            return SIM_ClkGetPLL();
+        case 2:
+            return SIM_ClkGetPCLK0();
+        default:
+            return __HIRC48;
+    }
+}
+
+uint32_t SIM_ClkGetTMR(uint32_t u32Index)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    const uint32_t au32Pos[4] = {CLK_CLKSEL1_TMR0SEL_Pos, CLK_CLKSEL1_TMR1SEL_Pos, CLK_CLKSEL1_TMR2SEL_Pos, CLK_CLKSEL1_TMR3SEL_Pos};
+
+    switch((psClk->CLKSEL1 >> au32Pos[u32Index]) & 0x7)
+    {
+        case 0:
+            return __HXT;
+        case 1:
+            return __LXT;
+        case 2:
+            return (u32Index < 2) ? SIM_ClkGetPCLK0() : SIM_ClkGetPCLK1();
+        case 5:
+            return __LIRC;
+        case 7:
+            return __HIRC;
+        default:
+            return 0;           /* External pin, never toggles in the simulator */
+    }
+}
+
+uint32_t SIM_ClkGetADC(void)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    uint32_t u32Freq;
+
+    switch((psClk->CLKSEL1 & CLK_CLKSEL1_ADCSEL_Msk) >> CLK_CLKSEL1_ADCSEL_Pos)
+    {
+        case 0:
+            u32Freq = __HXT;
+            break;
+        case 1:
+            u32Freq = SIM_ClkGetPLL();
+            break;
+        case 2:
+            u32Freq = SIM_ClkGetPCLK0();
+            break;
+        default:
+            u32Freq = __HIRC;
+            break;
+    }
+    return u32Freq / (((psClk->CLKDIV0 & CLK_CLKDIV0_ADCDIV_Msk) >> CLK_CLKDIV0_ADCDIV_Pos) + 1);
+}
+
+/**
+  * @brief      Convert a number of peripheral clock ticks to HCLK cycles, rounded up
+  */
+uint64_t SIM_ClkToCycles(uint64_t u64Ticks, uint32_t u32Freq)
+{
+    uint64_t u64Hclk = SIM_ClkGetHCLK();
+
+    if(u32Freq == 0)
+        return u64Ticks;
+    return (u64Ticks * u64Hclk + u32Freq - 1) / u32Freq;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  SYS model: register lock and module reset                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Reg;            /* Offset of IPRSTx */
+    uint32_t u32Bit;
+    SIM_PERIPH_T *psPeriph;
+} SIM_RST_MAP_T;
+
+static const SIM_RST_MAP_T s_asRstMap[] =
+{
+    { 0x08, SYS_IPRST0_PDMARST_Msk, &g_sSimPdma },
+    { 0x08, SYS_IPRST0_HDIVRST_Msk, &g_sSimHdiv },
+    { 0x08, SYS_IPRST0_CRCRST_Msk, &g_sSimCrc },
+    { 0x0C, SYS_IPRST1_TMR0RST_Msk, &g_sSimTimer0 },
+    { 0x0C, SYS_IPRST1_TMR1RST_Msk, &g_sSimTimer1 },
+    { 0x0C, SYS_IPRST1_TMR2RST_Msk, &g_sSimTimer2 },
+    { 0x0C, SYS_IPRST1_TMR3RST_Msk, &g_sSimTimer3 },
+    { 0x0C, SYS_IPRST1_I2C0RST_Msk, &g_sSimI2c0 },
+    { 0x0C, SYS_IPRST1_I2C1RST_Msk, &g_sSimI2c1 },
+    { 0x0C, SYS_IPRST1_SPI0RST_Msk, &g_sSimSpi0 },
+    { 0x0C, SYS_IPRST1_SPI1RST_Msk, &g_sSimSpi1 },
+    { 0x0C, SYS_IPRST1_UART0RST_Msk, &g_sSimUart0 },
+    { 0x0C, SYS_IPRST1_UART1RST_Msk, &g_sSimUart1 },
+    { 0x0C, SYS_IPRST1_UART2RST_Msk, &g_sSimUart2 },
+    { 0x0C, SYS_IPRST1_USBDRST_Msk, &g_sSimUsbd },
+    { 0x10, SYS_IPRST2_USCI0RST_Msk, &g_sSimUsci0 },
+    { 0x10, SYS_IPRST2_USCI1RST_Msk, &g_sSimUsci1 },
+    { 0x10, SYS_IPRST2_USCI2RST_Msk, &g_sSimUsci2 },
+};
+
+static uint32_t s_u32RegLockState;
+
+static void SIM_SysReset(SIM_PERIPH_T *psPeriph)
+{
+    SYS_T *psSys = SIM_REGS(SYS_T, SYS_BASE);
+
+    (void)psPeriph;
+    SIM_SET_RO(psSys->PDID, 0x00C29A00);
+    psSys->RSTSTS = SYS_RSTSTS_PORF_Msk;
+    psSys->REGLCTL = 0;
+    s_u32RegLockState = 0;
+}
+
+static void SIM_SysWrite(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SYS_T *psSys = SIM_REGS(SYS_T, SYS_BASE);
+    uint32_t i;
+
+    (void)psPeriph;
+    switch(u32Offset)
+    {
+        case 0x04:                      /* RSTSTS: write 1 to clear */
+            psSys->RSTSTS = u32Old & ~u32New;
+            break;
+        case 0x08:
+        case 0x0C:
+        case 0x10:
+            if((u32Offset == 0x08) && (u32New & SYS_IPRST0_CHIPRST_Msk))
+            {
+                SIM_Reset();
+                return;
+            }
+            for(i = 0; i < sizeof(s_asRstMap) / sizeof(s_asRstMap[0]); i++)
+            {
+                if((s_asRstMap[i].u32Reg == u32Offset) && (u32New & ~u32Old & s_asRstMap[i].u32Bit))
+                {
+                    s_asRstMap[i].psPeriph->u32IrqLine = 0;
+                    s_asRstMap[i].psPeriph->pfnReset(s_asRstMap[i].psPeriph);
+                }
+            }
+            break;
+        case 0x100:                     /* REGLCTL unlock sequence 59h, 16h, 88h */
+            if((u32New == 0x59) && (s_u32RegLockState == 0))
+                s_u32RegLockState = 1;
+            else if((u32New == 0x16) && (s_u32RegLockState == 1))
+                s_u32RegLockState = 2;
+            else if((u32New == 0x88) && (s_u32RegLockState == 2))
+                s_u32RegLockState = 3;
+            else
+                s_u32RegLockState = 0;
+            psSys->REGLCTL = (s_u32RegLockState == 3) ? 1 : 0;
+            break;
+        default:
+            break;
+    }
+}
+
+SIM_PERIPH_T g_sSimSys =
+{
+    "SYS", SYS_BASE, 0x200, -16, NULL,
+    SIM_SysReset, NULL, SIM_SysWrite, NULL
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  CLK model: every enabled clock is stable immediately                                                   */
+/*---------------------------------------------------------------------------------------------------------*/
+static void SIM_ClkReset(SIM_PERIPH_T *psPeriph)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+
+    (void)psPeriph;
+    psClk->PWRCTL = CLK_PWRCTL_HIRCEN_Msk | CLK_PWRCTL_LIRCEN_Msk;
+    psClk->CLKSEL0 = CLK_CLKSEL0_HCLKSEL_Msk | CLK_CLKSEL0_STCLKSEL_Msk;
+    psClk->CLKSEL1 = 0x3377770F;
+    psClk->CLKSEL2 = 0x0000002B;
+    psClk->PLLCTL = 0x0005C25E;
+}
+
+static void SIM_ClkRead(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    CLK_T *psClk = SIM_REGS(CLK_T, CLK_BASE);
+    uint32_t u32Pwr = psClk->PWRCTL;
+    uint32_t u32Sts = 0;
+
+    (void)psPeriph;
+    (void)u32IsWrite;
+    if(u32Offset != 0x0C)
+        return;
+
+    if(u32Pwr & CLK_PWRCTL_HXTEN_Msk)
+        u32Sts |= CLK_STATUS_HXTSTB_Msk;
+    if(u32Pwr & CLK_PWRCTL_LXTEN_Msk)
+        u32Sts |= CLK_STATUS_LXTSTB_Msk;
+    if(u32Pwr & CLK_PWRCTL_HIRCEN_Msk)
+        u32Sts |= CLK_STATUS_HIRCSTB_Msk;
+    if(u32Pwr & CLK_PWRCTL_LIRCEN_Msk)
+        u32Sts |= CLK_STATUS_LIRCSTB_Msk;
+    if(u32Pwr & CLK_PWRCTL_HIRC48EN_Msk)
+        u32Sts |= CLK_STATUS_HIRC48STB_Msk;
+    if((psClk->PLLCTL & CLK_PLLCTL_PD_Msk) == 0)
+        u32Sts |= CLK_STATUS_PLLSTB_Msk;
+    SIM_SET_RO(psClk->STATUS, u32Sts);
+}
+
+SIM_PERIPH_T g_sSimClk =
+{
+    "CLK", CLK_BASE, 0x100, -16, NULL,
+    SIM_ClkReset, SIM_ClkRead, NULL, NULL
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  TIMER model                                                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Index;
+    uint64_t u64Last;           /* Cycle the model was last advanced to */
+    uint64_t u64Frac;           /* Remainder of cycles x timer clock, in HCLK units */
+    uint32_t u32PscCnt;         /* Prescaler counter */
+} SIM_TIMER_STATE_T;
+
+static SIM_TIMER_STATE_T s_asTimer[4] = { {0}, {1}, {2}, {3} };
+
+static void SIM_TimerTick(SIM_PERIPH_T *psPeriph)
+{
+    SIM_TIMER_STATE_T *psState = psPeriph->pvState;
+    TIMER_T *psTmr = SIM_REGS(TIMER_T, psPeriph->u32Base);
+    uint64_t u64Ticks, u64Counts, u64Left;
+    uint32_t u32Hclk, u32Freq, u32Psc, u32Cmp, u32Cnt, u32Mode;
+
+    u64Ticks = g_u64SimCycles - psState->u64Last;
+    psState->u64Last = g_u64SimCycles;
+    if(((psTmr->CTL & TIMER_CTL_CNTEN_Msk) == 0) || (u64Ticks == 0))
+    {
+        psState->u64Frac = 0;
+        return;
+    }
+
+    /* HCLK cycles -> timer clock ticks */
+    u32Hclk = SIM_ClkGetHCLK();
+    u32Freq = SIM_ClkGetTMR(psState->u32Index);
+    psState->u64Frac += u64Ticks * u32Freq;
+    u64Ticks = psState->u64Frac / u32Hclk;
+    psState->u64Frac %= u32Hclk;
+
+    /* Timer clock ticks -> counter increments */
+    u32Psc = (psTmr->CTL & TIMER_CTL_PSC_Msk) + 1;
+    u64Ticks += psState->u32PscCnt;
+    u64Counts = u64Ticks / u32Psc;
+    psState->u32PscCnt = (uint32_t)(u64Ticks % u32Psc);
+
+    u32Cmp = psTmr->CMP & 0xFFFFFF;
+    if(u32Cmp < 2)
+        u32Cmp = 2;
+    u32Cnt = psTmr->CNT & 0xFFFFFF;
+    u32Mode = psTmr->CTL & TIMER_CTL_OPMODE_Msk;
+
+    while(u64Counts)
+    {
+        /* Counts left until CNT matches CMP */
+        u64Left = (u32Cnt < u32Cmp) ? (u32Cmp - u32Cnt) : (0x1000000 - u32Cnt + u32Cmp);
+        if(u64Counts < u64Left)
+        {
+            u32Cnt = (u32Cnt + (uint32_t)u64Counts) & 0xFFFFFF;
+            break;
+        }
+        u64Counts -= u64Left;
+        psTmr->INTSTS |= TIMER_INTSTS_TIF_Msk;
+        if((psTmr->TRGCTL & TIMER_TRGCTL_TRGADC_Msk) && !(psTmr->TRGCTL & TIMER_TRGCTL_TRGSSEL_Msk))
+            SIM_ADC_Trigger(ADC_ADCR_TRGS_TIMER);
+
+        if(u32Mode == TIMER_ONESHOT_MODE)
+        {
+            u32Cnt = 0;
+            psTmr->CTL &= ~(TIMER_CTL_CNTEN_Msk | TIMER_CTL_ACTSTS_Msk);
+            break;
+        }
+        else if(u32Mode == TIMER_CONTINUOUS_MODE)
+            u32Cnt = u32Cmp;
+        else
+        {
+            u32Cnt = 0;
+            /* Skip whole periods at once */
+            u64Counts %= u32Cmp;
+        }
+    }
+    psTmr->CNT = u32Cnt;
+
+    psPeriph->u32IrqLine = ((psTmr->CTL & TIMER_CTL_INTEN_Msk) && (psTmr->INTSTS & TIMER_INTSTS_TIF_Msk)) ? 1 : 0;
+}
+
+static void SIM_TimerRead(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    (void)u32Offset;
+    (void)u32IsWrite;
+    SIM_TimerTick(psPeriph);
+}
+
+static void SIM_TimerWrite(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SIM_TIMER_STATE_T *psState = psPeriph->pvState;
+    TIMER_T *psTmr = SIM_REGS(TIMER_T, psPeriph->u32Base);
+
+    switch(u32Offset)
+    {
+        case 0x00:
+            if(u32New & TIMER_CTL_CNTEN_Msk)
+                psTmr->CTL |= TIMER_CTL_ACTSTS_Msk;
+            else
+                psTmr->CTL &= ~TIMER_CTL_ACTSTS_Msk;
+            if(!(u32Old & TIMER_CTL_CNTEN_Msk) && (u32New & TIMER_CTL_CNTEN_Msk))
+            {
+                psState->u64Frac = 0;
+                psState->u32PscCnt = 0;
+            }
+            break;
+        case 0x08:                      /* INTSTS: write 1 to clear */
+            psTmr->INTSTS = u32Old & ~u32New;
+            break;
+        case 0x0C:                      /* Any write resets the counter */
+            psTmr->CNT = 0;
+            psState->u32PscCnt = 0;
+            break;
+        default:
+            break;
+    }
+    psPeriph->u32IrqLine = ((psTmr->CTL & TIMER_CTL_INTEN_Msk) && (psTmr->INTSTS & TIMER_INTSTS_TIF_Msk)) ? 1 : 0;
+}
+
+static void SIM_TimerReset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_TIMER_STATE_T *psState = psPeriph->pvState;
+
+    memset(SIM_Alias(psPeriph->u32Base), 0, psPeriph->u32Size);
+    psState->u64Last = g_u64SimCycles;
+    psState->u64Frac = 0;
+    psState->u32PscCnt = 0;
+}
+
+SIM_PERIPH_T g_sSimTimer0 =
+{
+    "TIMER0", TIMER0_BASE, 0x100, TMR0_IRQn, &s_asTimer[0],
+    SIM_TimerReset, SIM_TimerRead, SIM_TimerWrite, SIM_TimerTick
+};
+
+SIM_PERIPH_T g_sSimTimer1 =
+{
+    "TIMER1", TIMER1_BASE, 0x100, TMR1_IRQn, &s_asTimer[1],
+    SIM_TimerReset, SIM_TimerRead, SIM_TimerWrite, SIM_TimerTick
+};
+
+SIM_PERIPH_T g_sSimTimer2 =
+{
+    "TIMER2", TIMER2_BASE, 0x100, TMR2_IRQn, &s_asTimer[2],
+    SIM_TimerReset, SIM_TimerRead, SIM_TimerWrite, SIM_TimerTick
+};
+
+SIM_PERIPH_T g_sSimTimer3 =
+{
+    "TIMER3", TIMER3_BASE, 0x100, TMR3_IRQn, &s_asTimer[3],
+    SIM_TimerReset, SIM_TimerRead, SIM_TimerWrite, SIM_TimerTick
+};
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,442 @@
+/**************************************************************************//**
+ * @file     sim_uart.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator UART model
+ *
+ * @note     16-byte TX/RX FIFOs, character timing from UART_BAUD and UART_LINE, RX time-out,
+ *           FIFO status/interrupt flags and PDMA requests. Transmitted bytes are captured for
+ *           the test bench; received bytes are injected by the test bench or looped back.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+#define SIM_UART_FIFO_DEPTH     16
+#define SIM_UART_QUEUE_SIZE     4096    /* Power of 2 */
+
+typedef struct
+{
+    uint32_t u32Index;
+
+    uint8_t au8TxFifo[SIM_UART_FIFO_DEPTH];
+    uint32_t u32TxHead, u32TxCnt;
+    uint32_t u32TxShift;                /* 1 while a character is on the wire */
+    uint8_t u8TxShiftData;
+    uint64_t u64TxDone;                 /* Cycle the shifted character is complete */
+
+    uint8_t au8RxFifo[SIM_UART_FIFO_DEPTH];
+    uint32_t u32RxHead, u32RxCnt;
+    uint64_t u64RxLast;                 /* Cycle of last RX FIFO activity, for time-out */
+
+    uint8_t au8Inject[SIM_UART_QUEUE_SIZE];
+    uint32_t u32InjHead, u32InjCnt;
+    uint64_t u64InjNext;                /* Arrival cycle of the next injected character */
+
+    uint8_t au8Capture[SIM_UART_QUEUE_SIZE];
+    uint32_t u32CapHead, u32CapCnt;
+
+    uint32_t u32Loopback;
+    uint32_t u32RxOvf, u32TxOvf;
+} SIM_UART_STATE_T;
+
+static SIM_UART_STATE_T s_asUart[3] = { {0}, {1}, {2} };
+
+static const uint8_t s_au8RxTrigger[4] = {1, 4, 8, 14};
+
+static SIM_PERIPH_T *SIM_UART_Periph(UART_T *uart)
+{
+    if(uart == UART0)
+        return &g_sSimUart0;
+    if(uart == UART1)
+        return &g_sSimUart1;
+    return &g_sSimUart2;
+}
+
+/* Baud rate clock divider in UART clock ticks per bit */
+static uint32_t SIM_UART_BitTicks(UART_T *psUart)
+{
+    uint32_t u32Baud = psUart->BAUD;
+    uint32_t u32Brd = (u32Baud & UART_BAUD_BRD_Msk) + 2;
+
+    if((u32Baud & (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk)) == (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk))
+        return u32Brd;
+    if(u32Baud & UART_BAUD_BAUDM1_Msk)
+        return u32Brd * (((u32Baud & UART_BAUD_EDIVM1_Msk) >> UART_BAUD_EDIVM1_Pos) + 1);
+    return u32Brd * 16;
+}
+
+static uint64_t SIM_UART_BitCycles(UART_T *psUart)
+{
+    return SIM_ClkToCycles(SIM_UART_BitTicks(psUart), SIM_ClkGetUART());
+}
+
+static uint64_t SIM_UART_CharCycles(UART_T *psUart)
+{
+    uint32_t u32Line = psUart->LINE;
+    uint32_t u32Bits = 1 + 5 + (u32Line & UART_LINE_WLS_Msk) + 1;
+
+    if(u32Line & UART_LINE_PBE_Msk)
+        u32Bits++;
+    if(u32Line & UART_LINE_NSB_Msk)
+        u32Bits++;
+    return SIM_ClkToCycles((uint64_t)u32Bits * SIM_UART_BitTicks(psUart), SIM_ClkGetUART());
+}
+
+static void SIM_UART_RxPush(SIM_UART_STATE_T *psState, uint8_t u8Data, uint64_t u64When)
+{
+    if(psState->u32RxCnt >= SIM_UART_FIFO_DEPTH)
+        psState->u32RxOvf = 1;
+    else
+    {
+        psState->au8RxFifo[(psState->u32RxHead + psState->u32RxCnt) % SIM_UART_FIFO_DEPTH] = u8Data;
+        psState->u32RxCnt++;
+    }
+    psState->u64RxLast = u64When;
+}
+
+static void SIM_UART_Update(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+    UART_T *psUart = SIM_REGS(UART_T, psPeriph->u32Base);
+    uint32_t u32Sts, u32If, u32Int, u32Ien = psUart->INTEN;
+    uint32_t u32Level = s_au8RxTrigger[(psUart->FIFO & UART_FIFO_RFITL_Msk) >> UART_FIFO_RFITL_Pos];
+    uint64_t u64Timeout;
+
+    /* FIFO status */
+    u32Sts = psUart->FIFOSTS & (UART_FIFOSTS_PEF_Msk | UART_FIFOSTS_FEF_Msk | UART_FIFOSTS_BIF_Msk);
+    u32Sts |= (psState->u32RxCnt % SIM_UART_FIFO_DEPTH) << UART_FIFOSTS_RXPTR_Pos;
+    u32Sts |= (psState->u32TxCnt % SIM_UART_FIFO_DEPTH) << UART_FIFOSTS_TXPTR_Pos;
+    if(psState->u32RxCnt == 0)
+        u32Sts |= UART_FIFOSTS_RXEMPTY_Msk;
+    if(psState->u32RxCnt == SIM_UART_FIFO_DEPTH)
+        u32Sts |= UART_FIFOSTS_RXFULL_Msk;
+    if(psState->u32TxCnt == 0)
+        u32Sts |= UART_FIFOSTS_TXEMPTY_Msk;
+    if(psState->u32TxCnt == SIM_UART_FIFO_DEPTH)
+        u32Sts |= UART_FIFOSTS_TXFULL_Msk;
+    if((psState->u32TxCnt == 0) && !psState->u32TxShift)
+        u32Sts |= UART_FIFOSTS_TXEMPTYF_Msk;
+    if(psState->u32InjCnt == 0)
+        u32Sts |= UART_FIFOSTS_RXIDLE_Msk;
+    if(psState->u32RxOvf)
+        u32Sts |= UART_FIFOSTS_RXOVIF_Msk;
+    if(psState->u32TxOvf)
+        u32Sts |= UART_FIFOSTS_TXOVIF_Msk;
+    psUart->FIFOSTS = u32Sts;
+
+    /* Interrupt flags */
+    u32If = psUart->INTSTS & UART_INTSTS_RXTOIF_Msk;
+    if(psState->u32RxCnt >= u32Level)
+        u32If |= UART_INTSTS_RDAIF_Msk;
+    if(psState->u32TxCnt == 0)
+        u32If |= UART_INTSTS_THREIF_Msk;
+    if(u32Sts & UART_FIFOSTS_TXEMPTYF_Msk)
+        u32If |= UART_INTSTS_TXENDIF_Msk;
+    if(psState->u32RxOvf || psState->u32TxOvf)
+        u32If |= UART_INTSTS_BUFERRIF_Msk;
+
+    if(psState->u32RxCnt == 0)
+        u32If &= ~UART_INTSTS_RXTOIF_Msk;
+    else if(u32Ien & UART_INTEN_TOCNTEN_Msk)
+    {
+        u64Timeout = (uint64_t)((psUart->TOUT & UART_TOUT_TOIC_Msk) >> UART_TOUT_TOIC_Pos) * SIM_UART_BitCycles(psUart);
+        if(g_u64SimCycles - psState->u64RxLast >= u64Timeout)
+            u32If |= UART_INTSTS_RXTOIF_Msk;
+    }
+
+    u32Int = 0;
+    if((u32If & UART_INTSTS_RDAIF_Msk) && (u32Ien & UART_INTEN_RDAIEN_Msk))
+        u32Int |= UART_INTSTS_RDAINT_Msk;
+    if((u32If & UART_INTSTS_THREIF_Msk) && (u32Ien & UART_INTEN_THREIEN_Msk))
+        u32Int |= UART_INTSTS_THREINT_Msk;
+    if((u32If & UART_INTSTS_RXTOIF_Msk) && (u32Ien & UART_INTEN_RXTOIEN_Msk))
+        u32Int |= UART_INTSTS_RXTOINT_Msk;
+    if((u32If & UART_INTSTS_BUFERRIF_Msk) && (u32Ien & UART_INTEN_BUFERRIEN_Msk))
+        u32Int |= UART_INTSTS_BUFERRINT_Msk;
+    if((u32If & UART_INTSTS_TXENDIF_Msk) && (u32Ien & UART_INTEN_TXENDIEN_Msk))
+        u32Int |= UART_INTSTS_TXENDINT_Msk;
+    psUart->INTSTS = u32If | u32Int;
+
+    psPeriph->u32IrqLine = (u32Int != 0);
+}
+
+static void SIM_UART_TxStart(SIM_UART_STATE_T *psState, UART_T *psUart, uint64_t u64Start)
+{
+    psState->u8TxShiftData = psState->au8TxFifo[psState->u32TxHead];
+    psState->u32TxHead = (psState->u32TxHead + 1) % SIM_UART_FIFO_DEPTH;
+    psState->u32TxCnt--;
+    psState->u32TxShift = 1;
+    psState->u64TxDone = u64Start + SIM_UART_CharCycles(psUart);
+}
+
+static void SIM_UART_Tick(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+    UART_T *psUart = SIM_REGS(UART_T, psPeriph->u32Base);
+    uint64_t u64Char;
+
+    /* Transmitter */
+    while(psState->u32TxShift && (psState->u64TxDone <= g_u64SimCycles))
+    {
+        if(psState->u32Loopback)
+            SIM_UART_RxPush(psState, psState->u8TxShiftData, psState->u64TxDone);
+        if(psState->u32CapCnt < SIM_UART_QUEUE_SIZE)
+        {
+            psState->au8Capture[(psState->u32CapHead + psState->u32CapCnt) & (SIM_UART_QUEUE_SIZE - 1)] = psState->u8TxShiftData;
+            psState->u32CapCnt++;
+        }
+        psState->u32TxShift = 0;
+        if(psState->u32TxCnt)
+            SIM_UART_TxStart(psState, psUart, psState->u64TxDone);
+    }
+
+    /* Receiver */
+    if(psState->u32InjCnt)
+    {
+        u64Char = SIM_UART_CharCycles(psUart);
+        while(psState->u32InjCnt && (psState->u64InjNext <= g_u64SimCycles))
+        {
+            SIM_UART_RxPush(psState, psState->au8Inject[psState->u32InjHead], psState->u64InjNext);
+            psState->u32InjHead = (psState->u32InjHead + 1) & (SIM_UART_QUEUE_SIZE - 1);
+            psState->u32InjCnt--;
+            if(psState->u32InjCnt)
+                psState->u64InjNext += u64Char;
+        }
+    }
+
+    SIM_UART_Update(psPeriph);
+}
+
+static void SIM_UART_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+    UART_T *psUart = SIM_REGS(UART_T, psPeriph->u32Base);
+
+    SIM_UART_Tick(psPeriph);
+    if((u32Offset == 0x00) && !u32IsWrite)
+    {
+        /* Reading DAT pops the RX FIFO */
+        if(psState->u32RxCnt)
+        {
+            psUart->DAT = psState->au8RxFifo[psState->u32RxHead];
+            psState->u32RxHead = (psState->u32RxHead + 1) % SIM_UART_FIFO_DEPTH;
+            psState->u32RxCnt--;
+        }
+        psState->u64RxLast = g_u64SimCycles;
+        psUart->INTSTS &= ~UART_INTSTS_RXTOIF_Msk;
+        SIM_UART_Update(psPeriph);
+    }
+}
+
+static void SIM_UART_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+    UART_T *psUart = SIM_REGS(UART_T, psPeriph->u32Base);
+
+    switch(u32Offset)
+    {
+        case 0x00:                      /* DAT: push TX FIFO */
+            if(psState->u32TxCnt >= SIM_UART_FIFO_DEPTH)
+                psState->u32TxOvf = 1;
+            else
+            {
+                psState->au8TxFifo[(psState->u32TxHead + psState->u32TxCnt) % SIM_UART_FIFO_DEPTH] = (uint8_t)u32New;
+                psState->u32TxCnt++;
+                if(!psState->u32TxShift)
+                    SIM_UART_TxStart(psState, psUart, g_u64SimCycles);
+            }
+            break;
+        case 0x08:                      /* FIFO: RXRST/TXRST self-clear */
+            if(u32New & UART_FIFO_RXRST_Msk)
+            {
+                psState->u32RxCnt = 0;
+                psState->u32RxHead = 0;
+            }
+            if(u32New & UART_FIFO_TXRST_Msk)
+            {
+                psState->u32TxCnt = 0;
+                psState->u32TxHead = 0;
+            }
+            psUart->FIFO = u32New & ~(UART_FIFO_RXRST_Msk | UART_FIFO_TXRST_Msk);
+            break;
+        case 0x18:                      /* FIFOSTS: write 1 to clear */
+            if(u32New & UART_FIFOSTS_RXOVIF_Msk)
+                psState->u32RxOvf = 0;
+            if(u32New & UART_FIFOSTS_TXOVIF_Msk)
+                psState->u32TxOvf = 0;
+            psUart->FIFOSTS = u32Old & ~(u32New & (UART_FIFOSTS_PEF_Msk | UART_FIFOSTS_FEF_Msk | UART_FIFOSTS_BIF_Msk));
+            break;
+        case 0x1C:                      /* INTSTS: write 1 to clear */
+            psUart->INTSTS = u32Old & ~u32New;
+            break;
+        default:
+            break;
+    }
+    SIM_UART_Update(psPeriph);
+}
+
+static void SIM_UART_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+    UART_T *psUart = SIM_REGS(UART_T, psPeriph->u32Base);
+    uint32_t u32Index = psState->u32Index;
+
+    memset(psState, 0, sizeof(SIM_UART_STATE_T));
+    psState->u32Index = u32Index;
+    memset(psUart, 0, psPeriph->u32Size);
+    psUart->FIFOSTS = UART_FIFOSTS_RXEMPTY_Msk | UART_FIFOSTS_TXEMPTY_Msk | UART_FIFOSTS_TXEMPTYF_Msk | UART_FIFOSTS_RXIDLE_Msk;
+    psUart->INTSTS = UART_INTSTS_THREIF_Msk | UART_INTSTS_TXENDIF_Msk;
+}
+
+/* PDMA request lines */
+static uint32_t SIM_UART_TxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+
+    return (SIM_REGS(UART_T, psPeriph->u32Base)->INTEN & UART_INTEN_TXPDMAEN_Msk) && (psState->u32TxCnt < SIM_UART_FIFO_DEPTH);
+}
+
+static uint32_t SIM_UART_RxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+
+    return (SIM_REGS(UART_T, psPeriph->u32Base)->INTEN & UART_INTEN_RXPDMAEN_Msk) && (psState->u32RxCnt != 0);
+}
+
+static uint32_t SIM_UART0_TxReq(void)
+{
+    return SIM_UART_TxReq(&g_sSimUart0);
+}
+static uint32_t SIM_UART0_RxReq(void)
+{
+    return SIM_UART_RxReq(&g_sSimUart0);
+}
+static uint32_t SIM_UART1_TxReq(void)
+{
+    return SIM_UART_TxReq(&g_sSimUart1);
+}
+static uint32_t SIM_UART1_RxReq(void)
+{
+    return SIM_UART_RxReq(&g_sSimUart1);
+}
+static uint32_t SIM_UART2_TxReq(void)
+{
+    return SIM_UART_TxReq(&g_sSimUart2);
+}
+static uint32_t SIM_UART2_RxReq(void)
+{
+    return SIM_UART_RxReq(&g_sSimUart2);
+}
+
+static void SIM_UART0_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_UART0_TX, SIM_UART0_TxReq);
+    SIM_PDMA_SetRequest(PDMA_UART0_RX, SIM_UART0_RxReq);
+}
+
+static void SIM_UART1_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_UART1_TX, SIM_UART1_TxReq);
+    SIM_PDMA_SetRequest(PDMA_UART1_RX, SIM_UART1_RxReq);
+}
+
+static void SIM_UART2_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_UART_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_UART2_TX, SIM_UART2_TxReq);
+    SIM_PDMA_SetRequest(PDMA_UART2_RX, SIM_UART2_RxReq);
+}
+
+SIM_PERIPH_T g_sSimUart0 =
+{
+    "UART0", UART0_BASE, 0x1000, UART02_IRQn, &s_asUart[0],
+    SIM_UART0_Reset, SIM_UART_Read, SIM_UART_Write, SIM_UART_Tick
+};
+
+SIM_PERIPH_T g_sSimUart1 =
+{
+    "UART1", UART1_BASE, 0x1000, UART1_IRQn, &s_asUart[1],
+    SIM_UART1_Reset, SIM_UART_Read, SIM_UART_Write, SIM_UART_Tick
+};
+
+SIM_PERIPH_T g_sSimUart2 =
+{
+    "UART2", UART2_BASE, 0x1000, UART02_IRQn, &s_asUart[2],
+    SIM_UART2_Reset, SIM_UART_Read, SIM_UART_Write, SIM_UART_Tick
+};
+
+/**
+  * @brief      Queue bytes on the RX line of a UART
+  * @param[in]  uart        The pointer of the specified UART module
+  * @param[in]  pu8Buf      Bytes to send to the UART
+  * @param[in]  u32Len      Number of bytes
+  * @return     None
+  * @details    Bytes arrive back-to-back at the configured baud rate, starting one character
+  *             time after the call or after the previously injected byte.
+  */
+void SIM_UART_Inject(UART_T *uart, const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    SIM_PERIPH_T *psPeriph = SIM_UART_Periph(uart);
+    SIM_UART_STATE_T *psState = psPeriph->pvState;
+    uint32_t i;
+
+    SIM_Enter();
+    if(psState->u32InjCnt == 0)
+        psState->u64InjNext = g_u64SimCycles + SIM_UART_CharCycles(SIM_REGS(UART_T, psPeriph->u32Base));
+    for(i = 0; (i < u32Len) && (psState->u32InjCnt < SIM_UART_QUEUE_SIZE); i++)
+    {
+        psState->au8Inject[(psState->u32InjHead + psState->u32InjCnt) & (SIM_UART_QUEUE_SIZE - 1)] = pu8Buf[i];
+        psState->u32InjCnt++;
+    }
+    SIM_Leave();
+}
+
+/**
+  * @brief      Take bytes transmitted by a UART
+  * @param[in]  uart        The pointer of the specified UART module
+  * @param[out] pu8Buf      Buffer for the captured bytes, NULL to discard
+  * @param[in]  u32MaxLen   Buffer size
+  * @return     Number of bytes copied
+  */
+uint32_t SIM_UART_Capture(UART_T *uart, uint8_t *pu8Buf, uint32_t u32MaxLen)
+{
+    SIM_UART_STATE_T *psState = SIM_UART_Periph(uart)->pvState;
+    uint32_t u32Cnt = 0;
+
+    SIM_Enter();
+    while((u32Cnt < u32MaxLen) && psState->u32CapCnt)
+    {
+        if(pu8Buf != NULL)
+            pu8Buf[u32Cnt] = psState->au8Capture[psState->u32CapHead];
+        psState->u32CapHead = (psState->u32CapHead + 1) & (SIM_UART_QUEUE_SIZE - 1);
+        psState->u32CapCnt--;
+        u32Cnt++;
+    }
+    SIM_Leave();
+    return u32Cnt;
+}
+
+/**
+  * @brief      Connect TX of a UART to its own RX
+  * @param[in]  uart        The pointer of the specified UART module
+  * @param[in]  u32Enable   1 to loop back, 0 to disconnect
+  * @return     None
+  */
+void SIM_UART_SetLoopback(UART_T *uart, uint32_t u32Enable)
+{
+    SIM_UART_STATE_T *psState = SIM_UART_Periph(uart)->pvState;
+
+    psState->u32Loopback = u32Enable;
+}
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,499 @@
+/**************************************************************************//**
+ * @file     sim_usbd.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator USBD model
+ *
+ * @note     Full-speed device controller with 8 hardware endpoints and the 512-byte packet
+ *           buffer. The test bench plays the USB host through SIM_USBD_Setup/In/Out; each
+ *           transaction takes its bus time at 12 Mbit/s, moves data through the endpoint
+ *           buffer, updates EPSTS/DSQSYNC and raises the endpoint event like the hardware.
+ *           SIM_USBD_Submit() hands a whole bulk transfer to the host controller instead: its
+ *           tokens go out back to back as virtual time passes, concurrently with the firmware,
+ *           and NAKed tokens are retried the way a real host polls a busy endpoint.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+#define SIM_USBD_EP_NUM         8
+#define SIM_USBD_BUF_OFFSET     0x100
+#define SIM_USBD_BUF_SIZE       512
+#define SIM_USBD_BIT_RATE       12000000
+#define SIM_USBD_PKT_OVERHEAD   14      /* Token, data PID/CRC16, handshake, SYNC/EOP and gaps in bytes */
+#define SIM_USBD_NAK_BYTES      9       /* Token plus handshake */
+
+/* EPSTS codes */
+#define SIM_USBD_STS_IN_ACK     0
+#define SIM_USBD_STS_OUT0_ACK   2
+#define SIM_USBD_STS_OUT1_ACK   6
+#define SIM_USBD_STS_SETUP_ACK  7
+
+typedef struct
+{
+    uint32_t u32Ready;                  /* Bit n: hardware endpoint n armed by an MXPLD write */
+    uint32_t u32Attached;
+    uint8_t au8HostToggle[16];          /* Host side DATA0/1 for OUT transactions per endpoint address */
+    uint64_t u64Frame;                  /* Cycle of the next SOF, 0 while the bus is idle */
+    uint32_t u32FrameNum;
+    SIM_USBD_XFER_T *psXfer;            /* Bulk transfer owned by the host controller, NULL if none */
+    uint64_t u64Token;                  /* Cycle the next token of psXfer goes out */
+} SIM_USBD_STATE_T;
+
+static SIM_USBD_STATE_T s_sUsbd;
+
+static USBD_T *SIM_USBD_Regs(void)
+{
+    return SIM_REGS(USBD_T, USBD_BASE);
+}
+
+static uint32_t SIM_USBD_Enabled(USBD_T *psUsbd)
+{
+    uint32_t u32Need = USBD_ATTR_USBEN_Msk | USBD_ATTR_PHYEN_Msk;
+
+    return s_sUsbd.u32Attached && ((psUsbd->ATTR & u32Need) == u32Need);
+}
+
+static void SIM_USBD_Update(SIM_PERIPH_T *psPeriph)
+{
+    USBD_T *psUsbd = SIM_REGS(USBD_T, psPeriph->u32Base);
+    uint32_t u32Sts = psUsbd->INTSTS & ~USBD_INTSTS_USBIF_Msk;
+
+    /* USBIF summarizes the endpoint and SETUP events; it clears with them */
+    if(u32Sts & (0xFFUL << USBD_INTSTS_EPEVT0_Pos | USBD_INTSTS_SETUP_Msk))
+        u32Sts |= USBD_INTSTS_USBIF_Msk;
+    psUsbd->INTSTS = u32Sts;
+
+    psPeriph->u32IrqLine = (u32Sts & psUsbd->INTEN & 0x1F) ? 1 : 0;
+}
+
+static void SIM_USBD_SetEpStatus(USBD_T *psUsbd, uint32_t u32HwEp, uint32_t u32Sts)
+{
+    uint32_t u32Pos = USBD_EPSTS_EPSTS0_Pos + u32HwEp * 3;
+    volatile uint32_t *pu32Epsts = (volatile uint32_t *)&psUsbd->EPSTS;
+
+    *pu32Epsts = (*pu32Epsts & ~(0x7UL << u32Pos)) | (u32Sts << u32Pos);
+}
+
+/* Hardware endpoint serving endpoint address u8EpNum in direction u32State, -1 if none */
+static int32_t SIM_USBD_FindEp(USBD_T *psUsbd, uint8_t u8EpNum, uint32_t u32State)
+{
+    uint32_t i, u32Cfg;
+
+    for(i = 0; i < SIM_USBD_EP_NUM; i++)
+    {
+        u32Cfg = psUsbd->EP[i].CFG;
+        if(((u32Cfg & USBD_CFG_EPNUM_Msk) == u8EpNum) && ((u32Cfg & USBD_CFG_STATE_Msk) == u32State))
+            return (int32_t)i;
+    }
+    return -1;
+}
+
+static uint8_t *SIM_USBD_EpBuf(USBD_T *psUsbd, uint32_t u32HwEp, uint32_t *pu32Room)
+{
+    uint32_t u32Seg = psUsbd->EP[u32HwEp].BUFSEG & USBD_BUFSEG_BUFSEG_Msk;
+
+    *pu32Room = SIM_USBD_BUF_SIZE - u32Seg;
+    return (uint8_t *)SIM_Alias(USBD_BASE + SIM_USBD_BUF_OFFSET + u32Seg);
+}
+
+/* Bus time in bytes of a transaction that ended with i32Ret */
+static uint32_t SIM_USBD_BusBytes(int32_t i32Ret)
+{
+    return (i32Ret >= 0) ? (uint32_t)i32Ret + SIM_USBD_PKT_OVERHEAD : SIM_USBD_NAK_BYTES;
+}
+
+static uint64_t SIM_USBD_BusCycles(uint32_t u32Bytes)
+{
+    return SIM_ClkToCycles((uint64_t)u32Bytes * 8, SIM_USBD_BIT_RATE);
+}
+
+/* Let the bus time of one transaction pass and take the resulting interrupt */
+static void SIM_USBD_Transaction(uint32_t u32Bytes)
+{
+    SIM_UpdateIrq();
+    SIM_AdvanceCycles((uint32_t)SIM_USBD_BusCycles(u32Bytes));
+}
+
+/* IN token to endpoint address u8EpNum, register side only */
+static int32_t SIM_USBD_DoIn(USBD_T *psUsbd, uint8_t u8EpNum, uint8_t *pu8Buf, uint32_t u32MaxLen)
+{
+    int32_t i32HwEp;
+    uint32_t u32Len, u32Room;
+    uint8_t *pu8EpBuf;
+
+    i32HwEp = SIM_USBD_FindEp(psUsbd, u8EpNum & 0xF, USBD_CFG_EPMODE_IN);
+    if(!SIM_USBD_Enabled(psUsbd) || (i32HwEp < 0))
+        return SIM_USBD_NO_EP;
+
+    if(psUsbd->EP[i32HwEp].CFGP & USBD_CFGP_SSTALL_Msk)
+        return SIM_USBD_STALL;
+    if(!(s_sUsbd.u32Ready & (1UL << i32HwEp)))
+        return SIM_USBD_NAK;
+
+    u32Len = psUsbd->EP[i32HwEp].MXPLD & USBD_MXPLD_MXPLD_Msk;
+    if(u32Len > u32MaxLen)
+        u32Len = u32MaxLen;
+    pu8EpBuf = SIM_USBD_EpBuf(psUsbd, (uint32_t)i32HwEp, &u32Room);
+    memcpy(pu8Buf, pu8EpBuf, (u32Len < u32Room) ? u32Len : u32Room);
+    s_sUsbd.u32Ready &= ~(1UL << i32HwEp);
+    psUsbd->EP[i32HwEp].CFG ^= USBD_CFG_DSQSYNC_Msk;
+    SIM_USBD_SetEpStatus(psUsbd, (uint32_t)i32HwEp, SIM_USBD_STS_IN_ACK);
+    psUsbd->INTSTS |= 1UL << (USBD_INTSTS_EPEVT0_Pos + i32HwEp);
+    return (int32_t)u32Len;
+}
+
+/* OUT transaction to endpoint address u8EpNum, register side only */
+static int32_t SIM_USBD_DoOut(USBD_T *psUsbd, uint8_t u8EpNum, const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    int32_t i32HwEp;
+    uint32_t u32Room, u32Max;
+    uint8_t *pu8EpBuf;
+    uint8_t *pu8Toggle = &s_sUsbd.au8HostToggle[u8EpNum & 0xF];
+
+    i32HwEp = SIM_USBD_FindEp(psUsbd, u8EpNum & 0xF, USBD_CFG_EPMODE_OUT);
+    if(!SIM_USBD_Enabled(psUsbd) || (i32HwEp < 0))
+        return SIM_USBD_NO_EP;
+
+    if(psUsbd->EP[i32HwEp].CFGP & USBD_CFGP_SSTALL_Msk)
+        return SIM_USBD_STALL;
+    if(!(s_sUsbd.u32Ready & (1UL << i32HwEp)))
+        return SIM_USBD_NAK;
+
+    u32Max = psUsbd->EP[i32HwEp].MXPLD & USBD_MXPLD_MXPLD_Msk;
+    if(u32Len > u32Max)
+        u32Len = u32Max;
+    pu8EpBuf = SIM_USBD_EpBuf(psUsbd, (uint32_t)i32HwEp, &u32Room);
+    memcpy(pu8EpBuf, pu8Buf, (u32Len < u32Room) ? u32Len : u32Room);
+    psUsbd->EP[i32HwEp].MXPLD = u32Len;
+    s_sUsbd.u32Ready &= ~(1UL << i32HwEp);
+    psUsbd->EP[i32HwEp].CFG ^= USBD_CFG_DSQSYNC_Msk;
+    SIM_USBD_SetEpStatus(psUsbd, (uint32_t)i32HwEp, *pu8Toggle ? SIM_USBD_STS_OUT1_ACK : SIM_USBD_STS_OUT0_ACK);
+    *pu8Toggle ^= 1;
+    psUsbd->INTSTS |= 1UL << (USBD_INTSTS_EPEVT0_Pos + i32HwEp);
+    return (int32_t)u32Len;
+}
+
+/* Run the tokens of the submitted bulk transfer that are due by now */
+static void SIM_USBD_XferTick(SIM_PERIPH_T *psPeriph)
+{
+    USBD_T *psUsbd = SIM_REGS(USBD_T, psPeriph->u32Base);
+    SIM_USBD_XFER_T *psXfer;
+    uint32_t u32Len;
+    int32_t i32Ret;
+
+    while(((psXfer = s_sUsbd.psXfer) != NULL) && (s_sUsbd.u64Token <= g_u64SimCycles))
+    {
+        u32Len = psXfer->u32Len - psXfer->u32Actual;
+        if(u32Len > psXfer->u32MaxPkt)
+            u32Len = psXfer->u32MaxPkt;
+
+        if(psXfer->u8EpAddr & 0x80)
+            i32Ret = SIM_USBD_DoIn(psUsbd, psXfer->u8EpAddr, psXfer->pu8Buf + psXfer->u32Actual, u32Len);
+        else
+            i32Ret = SIM_USBD_DoOut(psUsbd, psXfer->u8EpAddr, psXfer->pu8Buf + psXfer->u32Actual, u32Len);
+        s_sUsbd.u64Token += SIM_USBD_BusCycles(SIM_USBD_BusBytes(i32Ret));
+
+        if(i32Ret == SIM_USBD_NAK)
+        {
+            psXfer->u32Nak++;
+            continue;
+        }
+
+        SIM_USBD_Update(psPeriph);
+        if(i32Ret >= 0)
+        {
+            psXfer->u32Actual += (uint32_t)i32Ret;
+            /* A short packet ends the transfer as well */
+            if((psXfer->u32Actual < psXfer->u32Len) && ((uint32_t)i32Ret == psXfer->u32MaxPkt))
+                continue;
+            i32Ret = 0;
+        }
+        psXfer->u64End = s_sUsbd.u64Token;
+        psXfer->i32Status = i32Ret;
+        s_sUsbd.psXfer = NULL;
+    }
+}
+
+static void SIM_USBD_Tick(SIM_PERIPH_T *psPeriph)
+{
+    USBD_T *psUsbd = SIM_REGS(USBD_T, psPeriph->u32Base);
+    uint64_t u64Period;
+
+    if(!SIM_USBD_Enabled(psUsbd))
+    {
+        s_sUsbd.u64Frame = 0;
+        return;
+    }
+
+    SIM_USBD_XferTick(psPeriph);
+
+    /* Start of frame every millisecond */
+    u64Period = SIM_ClkGetHCLK() / 1000;
+    if(s_sUsbd.u64Frame == 0)
+        s_sUsbd.u64Frame = g_u64SimCycles + u64Period;
+    if(s_sUsbd.u64Frame <= g_u64SimCycles)
+    {
+        while(s_sUsbd.u64Frame <= g_u64SimCycles)
+        {
+            s_sUsbd.u64Frame += u64Period;
+            s_sUsbd.u32FrameNum = (s_sUsbd.u32FrameNum + 1) & USBD_FN_FN_Msk;
+        }
+        *(volatile uint32_t *)&psUsbd->FN = s_sUsbd.u32FrameNum;
+        psUsbd->INTSTS |= USBD_INTSTS_SOFIF_Msk;
+        SIM_USBD_Update(psPeriph);
+    }
+}
+
+static void SIM_USBD_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    (void)u32Offset;
+    (void)u32IsWrite;
+    SIM_USBD_Tick(psPeriph);
+}
+
+static void SIM_USBD_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    USBD_T *psUsbd = SIM_REGS(USBD_T, psPeriph->u32Base);
+    uint32_t u32HwEp;
+
+    if((u32Offset >= 0x500) && (u32Offset < 0x500 + SIM_USBD_EP_NUM * 0x10))
+    {
+        u32HwEp = (u32Offset - 0x500) / 0x10;
+        switch(u32Offset & 0xF)
+        {
+            case 0x4:                   /* MXPLD: arms the endpoint */
+                s_sUsbd.u32Ready |= 1UL << u32HwEp;
+                break;
+            case 0xC:                   /* CFGP: CLRRDY self-clears, SSTALL sticks */
+                if(u32New & USBD_CFGP_CLRRDY_Msk)
+                    s_sUsbd.u32Ready &= ~(1UL << u32HwEp);
+                psUsbd->EP[u32HwEp].CFGP = u32New & USBD_CFGP_SSTALL_Msk;
+                break;
+            default:
+                break;
+        }
+        SIM_USBD_Update(psPeriph);
+        return;
+    }
+
+    switch(u32Offset)
+    {
+        case 0x04:                      /* INTSTS: write 1 to clear */
+            psUsbd->INTSTS = u32Old & ~u32New;
+            break;
+        case 0x0C:                      /* EPSTS, VBUSDET, LPMATTR, FN: read only */
+        case 0x14:
+        case 0x88:
+        case 0x8C:
+            *(volatile uint32_t *)SIM_Alias(psPeriph->u32Base + u32Offset) = u32Old;
+            break;
+        case 0x10:                      /* ATTR: bus state bits are read only */
+            psUsbd->ATTR = (u32New & ~0xFUL) | (u32Old & 0xFUL);
+            break;
+        default:
+            break;
+    }
+    SIM_USBD_Update(psPeriph);
+}
+
+static void SIM_USBD_Reset(SIM_PERIPH_T *psPeriph)
+{
+    USBD_T *psUsbd = SIM_REGS(USBD_T, psPeriph->u32Base);
+    uint32_t u32Attached = s_sUsbd.u32Attached;
+
+    memset(&s_sUsbd, 0, sizeof(s_sUsbd));
+    s_sUsbd.u32Attached = u32Attached;
+    memset(psUsbd, 0, psPeriph->u32Size);
+    *(volatile uint32_t *)&psUsbd->VBUSDET = u32Attached;
+}
+
+SIM_PERIPH_T g_sSimUsbd =
+{
+    "USBD", USBD_BASE, 0x1000, USBD_IRQn, &s_sUsbd,
+    SIM_USBD_Reset, SIM_USBD_Read, SIM_USBD_Write, SIM_USBD_Tick
+};
+
+/**
+  * @brief      Plug the device into the simulated host port
+  * @param      None
+  * @return     None
+  * @details    Sets VBUSDET and raises the VBUS detect interrupt.
+  */
+void SIM_USBD_Attach(void)
+{
+    USBD_T *psUsbd = SIM_USBD_Regs();
+
+    SIM_Enter();
+    s_sUsbd.u32Attached = 1;
+    *(volatile uint32_t *)&psUsbd->VBUSDET = USBD_VBUSDET_VBUSDET_Msk;
+    psUsbd->INTSTS |= USBD_INTSTS_VBDETIF_Msk;
+    SIM_USBD_Update(&g_sSimUsbd);
+    SIM_Leave();
+    SIM_USBD_Transaction(0);
+}
+
+/**
+  * @brief      Unplug the device
+  * @param      None
+  * @return     None
+  */
+void SIM_USBD_Detach(void)
+{
+    USBD_T *psUsbd = SIM_USBD_Regs();
+
+    SIM_Enter();
+    s_sUsbd.u32Attached = 0;
+    *(volatile uint32_t *)&psUsbd->VBUSDET = 0;
+    psUsbd->INTSTS |= USBD_INTSTS_VBDETIF_Msk;
+    SIM_USBD_Update(&g_sSimUsbd);
+    SIM_Leave();
+    SIM_USBD_Transaction(0);
+}
+
+/**
+  * @brief      Drive a USB bus reset
+  * @param      None
+  * @return     None
+  * @details    Reports USBRST in ATTR with the bus event interrupt and resets the host data toggles.
+  */
+void SIM_USBD_BusReset(void)
+{
+    USBD_T *psUsbd = SIM_USBD_Regs();
+
+    SIM_Enter();
+    memset(s_sUsbd.au8HostToggle, 0, sizeof(s_sUsbd.au8HostToggle));
+    psUsbd->ATTR = (psUsbd->ATTR & ~0xFUL) | USBD_ATTR_USBRST_Msk;
+    psUsbd->INTSTS |= USBD_INTSTS_BUSIF_Msk;
+    SIM_USBD_Update(&g_sSimUsbd);
+    SIM_Leave();
+    SIM_USBD_Transaction(0);
+}
+
+/**
+  * @brief      Send a SETUP transaction to endpoint 0
+  * @param[in]  pu8Setup    8-byte setup packet
+  * @return     None
+  * @details    The packet is stored at STBUFSEG, control endpoints are unarmed and endpoints
+  *             with CSTALL set leave the STALL state, then the SETUP event is raised.
+  */
+void SIM_USBD_Setup(const uint8_t *pu8Setup)
+{
+    USBD_T *psUsbd = SIM_USBD_Regs();
+    uint32_t i, u32Seg;
+
+    SIM_Enter();
+    if(!SIM_USBD_Enabled(psUsbd))
+    {
+        SIM_Leave();
+        return;
+    }
+
+    u32Seg = psUsbd->STBUFSEG & USBD_STBUFSEG_STBUFSEG_Msk;
+    memcpy(SIM_Alias(USBD_BASE + SIM_USBD_BUF_OFFSET + u32Seg), pu8Setup, 8);
+    for(i = 0; i < SIM_USBD_EP_NUM; i++)
+    {
+        if((psUsbd->EP[i].CFG & USBD_CFG_EPNUM_Msk) != 0)
+            continue;
+        s_sUsbd.u32Ready &= ~(1UL << i);
+        if(psUsbd->EP[i].CFG & USBD_CFG_CSTALL_Msk)
+            psUsbd->EP[i].CFGP &= ~USBD_CFGP_SSTALL_Msk;
+        SIM_USBD_SetEpStatus(psUsbd, i, SIM_USBD_STS_SETUP_ACK);
+    }
+    s_sUsbd.au8HostToggle[0] = 1;        /* Data stage starts with DATA1 */
+    psUsbd->INTSTS |= USBD_INTSTS_SETUP_Msk;
+    SIM_USBD_Update(&g_sSimUsbd);
+    SIM_Leave();
+    SIM_USBD_Transaction(8 + SIM_USBD_PKT_OVERHEAD);
+}
+
+/**
+  * @brief      Send an IN token
+  * @param[in]  u8EpNum     Endpoint address without direction bit
+  * @param[out] pu8Buf      Buffer for the data packet
+  * @param[in]  u32MaxLen   Buffer size
+  * @return     Packet length, or SIM_USBD_NAK, SIM_USBD_STALL, SIM_USBD_NO_EP
+  */
+int32_t SIM_USBD_In(uint8_t u8EpNum, uint8_t *pu8Buf, uint32_t u32MaxLen)
+{
+    int32_t i32Ret;
+
+    SIM_Enter();
+    i32Ret = SIM_USBD_DoIn(SIM_USBD_Regs(), u8EpNum, pu8Buf, u32MaxLen);
+    SIM_USBD_Update(&g_sSimUsbd);
+    SIM_Leave();
+
+    if(i32Ret != SIM_USBD_NO_EP)
+        SIM_USBD_Transaction(SIM_USBD_BusBytes(i32Ret));
+    return i32Ret;
+}
+
+/**
+  * @brief      Send an OUT transaction
+  * @param[in]  u8EpNum     Endpoint address without direction bit
+  * @param[in]  pu8Buf      Data packet
+  * @param[in]  u32Len      Packet length, at most the MXPLD the firmware armed the endpoint with
+  * @return     Packet length, or SIM_USBD_NAK, SIM_USBD_STALL, SIM_USBD_NO_EP
+  * @details    The host data toggle alternates per endpoint address, so a duplicate packet can
+  *             be produced by resending after a NAK only; EPSTS reports DATA0/DATA1.
+  */
+int32_t SIM_USBD_Out(uint8_t u8EpNum, const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    int32_t i32Ret;
+
+    SIM_Enter();
+    i32Ret = SIM_USBD_DoOut(SIM_USBD_Regs(), u8EpNum, pu8Buf, u32Len);
+    SIM_USBD_Update(&g_sSimUsbd);
+    SIM_Leave();
+
+    if(i32Ret != SIM_USBD_NO_EP)
+        SIM_USBD_Transaction(SIM_USBD_BusBytes(i32Ret));
+    return i32Ret;
+}
+
+/**
+  * @brief      Start a bulk transfer on the simulated host controller
+  * @param[in]  psXfer      Transfer with u8EpAddr, pu8Buf, u32Len and u32MaxPkt filled in. It must
+  *                         stay valid until i32Status leaves SIM_USBD_BUSY.
+  * @retval     0               Transfer started
+  * @retval     SIM_USBD_BUSY   Another transfer is still running
+  * @retval     SIM_USBD_NO_EP  Device not attached or not enabled
+  * @details    Returns at once. The tokens go out back to back as virtual time advances, while the
+  *             firmware keeps running: register accesses, SIM_AdvanceCycles() or a wait let the
+  *             bus move on. A NAKed token is retried after its bus time, like a host polling a
+  *             busy endpoint. The transfer ends after u32Len bytes, on a short packet or on STALL.
+  */
+int32_t SIM_USBD_Submit(SIM_USBD_XFER_T *psXfer)
+{
+    SIM_Enter();
+    if(s_sUsbd.psXfer != NULL)
+    {
+        SIM_Leave();
+        return SIM_USBD_BUSY;
+    }
+    if(!SIM_USBD_Enabled(SIM_USBD_Regs()))
+    {
+        SIM_Leave();
+        return SIM_USBD_NO_EP;
+    }
+
+    psXfer->u32Actual = 0;
+    psXfer->u32Nak = 0;
+    psXfer->i32Status = SIM_USBD_BUSY;
+    psXfer->u64Start = g_u64SimCycles;
+    psXfer->u64End = 0;
+    s_sUsbd.psXfer = psXfer;
+    s_sUsbd.u64Token = g_u64SimCycles;
+    SIM_Leave();
+
+    return 0;
+}
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,654 @@
+/**************************************************************************//**
+ * @file     sim_usci.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator USCI model (SPI master, I2C master and slave mode)
+ *
+ * @note     SPI: one-level TX buffer, two-level RX buffer, bus clock from USCI_BRGEN, transmit
+ *           and receive start/end interrupts and PDMA requests. MOSI is looped back to MISO.
+ *           I2C: SIM_UI2C_HostXfer() runs a transfer from an external master. The address is
+ *           matched against DEVADDR0/1 and their masks, every START, address, data byte and
+ *           STOP sets its protocol flag and SCL is stretched until PTRG is written.
+ *           Master mode drives device models attached by SIM_UI2C_AttachDevice(): STA starts,
+ *           then each PTRG sends TXDAT, receives into RXDAT with AA as the ACK, or runs the
+ *           repeated START or STOP requested with it, at the bus rate of USCI_BRGEN.
+ *           Other protocols only see plain registers.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+#define SIM_USCI_RX_DEPTH       2
+#define SIM_USCI_FUNMODE_SPI    1
+#define SIM_USCI_FUNMODE_I2C    4
+
+/* External master transfer phases in I2C mode, the bus step that completes next */
+#define SIM_UI2C_HOST_START     0       /* START or repeated START */
+#define SIM_UI2C_HOST_ADDR      1
+#define SIM_UI2C_HOST_WRITE     2
+#define SIM_UI2C_HOST_READ      3
+#define SIM_UI2C_HOST_STOP      4
+
+/* Master mode bus operations */
+#define SIM_UI2C_OP_NONE        0
+#define SIM_UI2C_OP_START       1
+#define SIM_UI2C_OP_STOP        2
+#define SIM_UI2C_OP_ADDR        3
+#define SIM_UI2C_OP_WRITE       4
+#define SIM_UI2C_OP_READ        5
+
+#define SIM_UI2C_MAX_DEV        8
+
+#define SIM_UI2C_PROT_FLAGS     (UI2C_PROTSTS_TOIF_Msk | UI2C_PROTSTS_STARIF_Msk | UI2C_PROTSTS_STORIF_Msk | \
+                                 UI2C_PROTSTS_NACKIF_Msk | UI2C_PROTSTS_ARBLOIF_Msk | UI2C_PROTSTS_ERRIF_Msk | \
+                                 UI2C_PROTSTS_ACKIF_Msk)
+
+typedef struct
+{
+    uint32_t u32Index;
+
+    uint32_t u32TxFull;                 /* 1 while TXDAT holds a data unit */
+    uint32_t u32TxData;
+    uint32_t au32RxBuf[SIM_USCI_RX_DEPTH];
+    uint32_t u32RxHead, u32RxCnt;
+
+    uint32_t u32Shift;                  /* 1 while a data unit is on the bus */
+    uint32_t u32ShiftData;
+    uint64_t u64ShiftDone;
+
+    SIM_I2C_HOST_XFER_T *psHost;        /* External master transfer, I2C slave mode */
+    uint32_t u32HostPhase;
+    uint32_t u32HostRead;               /* Direction of the address after the current START */
+    uint32_t u32HostIdx;
+    uint32_t u32HostWait;               /* 1 while SCL is held low until PTRG */
+    uint32_t u32HostAck;                /* AA when PTRG was written */
+    uint32_t u32HostNack;               /* Last data byte was not acknowledged */
+    uint64_t u64HostDone;
+
+    SIM_I2C_DEV_T *apsDev[SIM_UI2C_MAX_DEV];   /* Devices on the bus, I2C master mode */
+    SIM_I2C_DEV_T *psTarget;            /* Device addressed in the current transfer */
+    uint32_t u32MstOp;                  /* SIM_UI2C_OP_xxx on the bus */
+    uint32_t u32MstOwned;               /* Bus owned since the last START */
+    uint32_t u32MstAddr;                /* Next byte after PTRG is the address */
+    uint32_t u32MstRead;                /* Direction of the current transfer */
+    uint32_t u32MstAck;                 /* AA when PTRG was written */
+    uint64_t u64MstDone;
+} SIM_USCI_STATE_T;
+
+static SIM_USCI_STATE_T s_asUsci[3] = { {0}, {1}, {2} };
+
+static uint32_t SIM_USCI_IsSpi(USPI_T *psUspi)
+{
+    return (((psUspi->CTL & USPI_CTL_FUNMODE_Msk) >> USPI_CTL_FUNMODE_Pos) == SIM_USCI_FUNMODE_SPI) &&
+           (psUspi->PROTCTL & USPI_PROTCTL_PROTEN_Msk);
+}
+
+static uint32_t SIM_USCI_IsI2c(USPI_T *psUspi)
+{
+    return (((psUspi->CTL & USPI_CTL_FUNMODE_Msk) >> USPI_CTL_FUNMODE_Pos) == SIM_USCI_FUNMODE_I2C) &&
+           (psUspi->PROTCTL & UI2C_PROTCTL_PROTEN_Msk);
+}
+
+static uint32_t SIM_USCI_Width(USPI_T *psUspi)
+{
+    uint32_t u32Width = (psUspi->LINECTL & USPI_LINECTL_DWIDTH_Msk) >> USPI_LINECTL_DWIDTH_Pos;
+
+    return (u32Width == 0) ? 16 : u32Width;
+}
+
+static void SIM_USCI_Update(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    USPI_T *psUspi = SIM_REGS(USPI_T, psPeriph->u32Base);
+    uint32_t u32Buf, u32Prot, u32Ien = psUspi->INTEN, u32Irq = 0;
+
+    if(SIM_USCI_IsI2c(psUspi))
+    {
+        UI2C_T *psUi2c = (UI2C_T *)psUspi;
+
+        /* TOIF pairs with TOIEN, STARIF~ACKIF (bits 8~13) with STARIEN~ACKIEN (bits 1~6) */
+        u32Prot = psUi2c->PROTSTS;
+        u32Irq = ((u32Prot & UI2C_PROTSTS_TOIF_Msk) ? UI2C_PROTIEN_TOIEN_Msk : 0) | ((u32Prot >> 7) & 0x7E);
+        psPeriph->u32IrqLine = (u32Irq & psUi2c->PROTIEN) ? 1 : 0;
+        return;
+    }
+
+    u32Buf = psUspi->BUFSTS & (USPI_BUFSTS_RXOVIF_Msk | USPI_BUFSTS_TXUDRIF_Msk);
+    if(psState->u32RxCnt == 0)
+        u32Buf |= USPI_BUFSTS_RXEMPTY_Msk;
+    if(psState->u32RxCnt == SIM_USCI_RX_DEPTH)
+        u32Buf |= USPI_BUFSTS_RXFULL_Msk;
+    if(psState->u32TxFull)
+        u32Buf |= USPI_BUFSTS_TXFULL_Msk;
+    else
+        u32Buf |= USPI_BUFSTS_TXEMPTY_Msk;
+    psUspi->BUFSTS = u32Buf;
+
+    u32Prot = psUspi->PROTSTS & ~USPI_PROTSTS_BUSY_Msk;
+    if(psState->u32Shift || psState->u32TxFull)
+        u32Prot |= USPI_PROTSTS_BUSY_Msk;
+    psUspi->PROTSTS = u32Prot;
+
+    if((u32Prot & USPI_PROTSTS_TXSTIF_Msk) && (u32Ien & USPI_INTEN_TXSTIEN_Msk))
+        u32Irq = 1;
+    if((u32Prot & USPI_PROTSTS_TXENDIF_Msk) && (u32Ien & USPI_INTEN_TXENDIEN_Msk))
+        u32Irq = 1;
+    if((u32Prot & USPI_PROTSTS_RXSTIF_Msk) && (u32Ien & USPI_INTEN_RXSTIEN_Msk))
+        u32Irq = 1;
+    if((u32Prot & USPI_PROTSTS_RXENDIF_Msk) && (u32Ien & USPI_INTEN_RXENDIEN_Msk))
+        u32Irq = 1;
+    if((u32Buf & USPI_BUFSTS_RXOVIF_Msk) && (psUspi->BUFCTL & USPI_BUFCTL_RXOVIEN_Msk))
+        u32Irq = 1;
+    psPeriph->u32IrqLine = u32Irq;
+}
+
+static void SIM_USCI_Start(SIM_PERIPH_T *psPeriph, uint64_t u64Start)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    USPI_T *psUspi = SIM_REGS(USPI_T, psPeriph->u32Base);
+    uint32_t u32Div = (((psUspi->BRGEN & USPI_BRGEN_CLKDIV_Msk) >> USPI_BRGEN_CLKDIV_Pos) + 1) * 2;
+    uint32_t u32Clocks = SIM_USCI_Width(psUspi) + ((psUspi->PROTCTL & USPI_PROTCTL_SUSPITV_Msk) >> USPI_PROTCTL_SUSPITV_Pos);
+    uint32_t u32Pclk = (psState->u32Index == 1) ? SIM_ClkGetPCLK1() : SIM_ClkGetPCLK0();
+
+    if(!SIM_USCI_IsSpi(psUspi))
+        return;
+
+    psState->u32ShiftData = psState->u32TxData;
+    psState->u32TxFull = 0;
+    psState->u32Shift = 1;
+    psState->u64ShiftDone = u64Start + SIM_ClkToCycles((uint64_t)u32Clocks * u32Div, u32Pclk);
+    psUspi->PROTSTS |= USPI_PROTSTS_TXSTIF_Msk | USPI_PROTSTS_RXSTIF_Msk;
+}
+
+static void SIM_UI2C_HostSchedule(SIM_PERIPH_T *psPeriph, uint32_t u32Phase, uint32_t u32Bits)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+
+    psState->u32HostPhase = u32Phase;
+    psState->u32HostWait = 0;
+    psState->u64HostDone = g_u64SimCycles + SIM_ClkToCycles(u32Bits, psState->psHost->u32BusHz);
+}
+
+static uint32_t SIM_UI2C_AddrMatch(UI2C_T *psUi2c, uint32_t u32Addr)
+{
+    if((((psUi2c->DEVADDR0 ^ u32Addr) & ~psUi2c->ADDRMSK0) & 0x7F) == 0)
+        return 1;
+    return ((((psUi2c->DEVADDR1 ^ u32Addr) & ~psUi2c->ADDRMSK1) & 0x7F) == 0);
+}
+
+/* A bus step of the external master is done, set its flag and hold SCL low */
+static void SIM_UI2C_HostStep(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    UI2C_T *psUi2c = SIM_REGS(UI2C_T, psPeriph->u32Base);
+    SIM_I2C_HOST_XFER_T *psHost = psState->psHost;
+
+    switch(psState->u32HostPhase)
+    {
+        case SIM_UI2C_HOST_START:
+            psUi2c->PROTSTS |= UI2C_PROTSTS_STARIF_Msk;
+            break;
+        case SIM_UI2C_HOST_ADDR:
+            if(!(psUi2c->PROTCTL & UI2C_PROTCTL_AA_Msk) || !SIM_UI2C_AddrMatch(psUi2c, psHost->u8Addr))
+            {
+                /* Not addressed, the controller sees nothing more of this transfer */
+                psHost->i32Status = -1;
+                psHost->u64End = g_u64SimCycles;
+                psState->psHost = NULL;
+                psHost->u32Done = 1;
+                return;
+            }
+            SIM_SET_RO(psUi2c->RXDAT, (psHost->u8Addr << 1) | psState->u32HostRead);
+            psUi2c->PROTSTS = (psUi2c->PROTSTS & ~UI2C_PROTSTS_SLAREAD_Msk) | UI2C_PROTSTS_ACKIF_Msk |
+                              (psState->u32HostRead ? UI2C_PROTSTS_SLAREAD_Msk : 0);
+            psState->u32HostIdx = 0;
+            break;
+        case SIM_UI2C_HOST_WRITE:
+            SIM_SET_RO(psUi2c->RXDAT, psHost->pu8Wr[psState->u32HostIdx++]);
+            psState->u32HostNack = !psState->u32HostAck;
+            psUi2c->PROTSTS |= psState->u32HostAck ? UI2C_PROTSTS_ACKIF_Msk : UI2C_PROTSTS_NACKIF_Msk;
+            break;
+        case SIM_UI2C_HOST_READ:
+            psHost->pu8Rd[psState->u32HostIdx++] = (uint8_t)psUi2c->TXDAT;
+            psUi2c->PROTSTS |= (psState->u32HostIdx < psHost->u32RdLen) ? UI2C_PROTSTS_ACKIF_Msk : UI2C_PROTSTS_NACKIF_Msk;
+            break;
+        default:                        /* STOP frees the bus, nothing to hold */
+            psUi2c->PROTSTS |= UI2C_PROTSTS_STORIF_Msk;
+            psHost->u64End = g_u64SimCycles;
+            psState->psHost = NULL;
+            psHost->u32Done = 1;
+            return;
+    }
+    psState->u32HostWait = 1;
+}
+
+/* Firmware wrote PTRG in slave mode, the external master goes on */
+static void SIM_UI2C_HostRelease(SIM_PERIPH_T *psPeriph, uint32_t u32Ctl)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    SIM_I2C_HOST_XFER_T *psHost = psState->psHost;
+
+    psState->u32HostAck = (u32Ctl & UI2C_PROTCTL_AA_Msk) ? 1 : 0;
+    switch(psState->u32HostPhase)
+    {
+        case SIM_UI2C_HOST_START:
+            SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_ADDR, 9);
+            return;
+        case SIM_UI2C_HOST_ADDR:
+            if(psState->u32HostRead)
+            {
+                SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_READ, 9);
+                return;
+            }
+            break;
+        case SIM_UI2C_HOST_WRITE:
+            if(psState->u32HostNack)
+            {
+                psHost->i32Status = -1;
+                SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_STOP, 1);
+                return;
+            }
+            break;
+        case SIM_UI2C_HOST_READ:
+            if(psState->u32HostIdx < psHost->u32RdLen)
+                SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_READ, 9);
+            else
+                SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_STOP, 1);
+            return;
+        default:
+            return;
+    }
+
+    /* Written bytes go on, then a repeated START for the read, or STOP */
+    if(psState->u32HostIdx < psHost->u32WrLen)
+        SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_WRITE, 9);
+    else if(psHost->u32RdLen)
+    {
+        psState->u32HostRead = 1;
+        SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_START, 1);
+    }
+    else
+        SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_STOP, 1);
+}
+
+static void SIM_UI2C_MstSchedule(SIM_PERIPH_T *psPeriph, uint32_t u32Op, uint32_t u32Bits)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    UI2C_T *psUi2c = SIM_REGS(UI2C_T, psPeriph->u32Base);
+    uint32_t u32Div = (((psUi2c->BRGEN & UI2C_BRGEN_CLKDIV_Msk) >> UI2C_BRGEN_CLKDIV_Pos) + 1) * 2;
+    uint32_t u32Pclk = (psState->u32Index == 1) ? SIM_ClkGetPCLK1() : SIM_ClkGetPCLK0();
+
+    psState->u32MstOp = u32Op;
+    psState->u64MstDone = g_u64SimCycles + SIM_ClkToCycles((uint64_t)u32Bits * u32Div, u32Pclk);
+}
+
+/* A master bus operation is done, set its flag; SCL stays low until the next PTRG */
+static void SIM_UI2C_MstComplete(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    UI2C_T *psUi2c = SIM_REGS(UI2C_T, psPeriph->u32Base);
+    SIM_I2C_DEV_T *psDev = psState->psTarget;
+    uint32_t u32Op = psState->u32MstOp, u32Data = psUi2c->TXDAT & 0xFF, u32Ack, i;
+
+    psState->u32MstOp = SIM_UI2C_OP_NONE;
+    switch(u32Op)
+    {
+        case SIM_UI2C_OP_START:
+            psState->u32MstOwned = 1;
+            psState->u32MstAddr = 1;
+            psUi2c->PROTSTS |= UI2C_PROTSTS_STARIF_Msk;
+            break;
+        case SIM_UI2C_OP_ADDR:
+            psState->u32MstAddr = 0;
+            psState->u32MstRead = u32Data & 1;
+            psState->psTarget = NULL;
+            for(i = 0; i < SIM_UI2C_MAX_DEV; i++)
+            {
+                if((psState->apsDev[i] != NULL) && (psState->apsDev[i]->u8Addr == (u32Data >> 1)))
+                {
+                    psState->psTarget = psState->apsDev[i];
+                    break;
+                }
+            }
+            if((psState->psTarget != NULL) && (psState->psTarget->pfnStart != NULL))
+                psState->psTarget->pfnStart(psState->psTarget->pvCtx, psState->u32MstRead);
+            psUi2c->PROTSTS |= (psState->psTarget != NULL) ? UI2C_PROTSTS_ACKIF_Msk : UI2C_PROTSTS_NACKIF_Msk;
+            break;
+        case SIM_UI2C_OP_WRITE:
+            u32Ack = (psDev != NULL) ? psDev->pfnWrite(psDev->pvCtx, (uint8_t)u32Data) : 0;
+            psUi2c->PROTSTS |= u32Ack ? UI2C_PROTSTS_ACKIF_Msk : UI2C_PROTSTS_NACKIF_Msk;
+            break;
+        case SIM_UI2C_OP_READ:
+            SIM_SET_RO(psUi2c->RXDAT, (psDev != NULL) ? psDev->pfnRead(psDev->pvCtx) : 0xFF);
+            psUi2c->PROTSTS |= psState->u32MstAck ? UI2C_PROTSTS_ACKIF_Msk : UI2C_PROTSTS_NACKIF_Msk;
+            break;
+        case SIM_UI2C_OP_STOP:
+            if((psDev != NULL) && (psDev->pfnStop != NULL))
+                psDev->pfnStop(psDev->pvCtx);
+            psState->psTarget = NULL;
+            psState->u32MstOwned = 0;
+            psUi2c->PROTCTL &= ~UI2C_PROTCTL_STO_Msk;
+            psUi2c->PROTSTS |= UI2C_PROTSTS_STORIF_Msk;
+            /* START requested while the STOP was on the bus goes out once the bus is free */
+            if(psUi2c->PROTCTL & UI2C_PROTCTL_STA_Msk)
+                SIM_UI2C_MstSchedule(psPeriph, SIM_UI2C_OP_START, 1);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Firmware wrote PROTCTL in master mode: STA on a free bus starts, PTRG releases SCL for the next step */
+static void SIM_UI2C_MstControl(SIM_PERIPH_T *psPeriph, uint32_t u32Ctl)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+
+    if(psState->u32MstOp != SIM_UI2C_OP_NONE)
+        return;
+
+    if(!psState->u32MstOwned)
+    {
+        if(u32Ctl & UI2C_PROTCTL_STA_Msk)
+            SIM_UI2C_MstSchedule(psPeriph, SIM_UI2C_OP_START, 1);
+        return;
+    }
+    if(!(u32Ctl & UI2C_PROTCTL_PTRG_Msk))
+        return;
+
+    psState->u32MstAck = (u32Ctl & UI2C_PROTCTL_AA_Msk) ? 1 : 0;
+    if(u32Ctl & UI2C_PROTCTL_STO_Msk)
+        SIM_UI2C_MstSchedule(psPeriph, SIM_UI2C_OP_STOP, 1);
+    else if(u32Ctl & UI2C_PROTCTL_STA_Msk)
+        SIM_UI2C_MstSchedule(psPeriph, SIM_UI2C_OP_START, 1);
+    else if(psState->u32MstAddr)
+        SIM_UI2C_MstSchedule(psPeriph, SIM_UI2C_OP_ADDR, 9);
+    else
+        SIM_UI2C_MstSchedule(psPeriph, psState->u32MstRead ? SIM_UI2C_OP_READ : SIM_UI2C_OP_WRITE, 9);
+}
+
+static void SIM_USCI_Tick(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    USPI_T *psUspi = SIM_REGS(USPI_T, psPeriph->u32Base);
+
+    if((psState->psHost != NULL) && !psState->u32HostWait && (psState->u64HostDone <= g_u64SimCycles))
+        SIM_UI2C_HostStep(psPeriph);
+    if((psState->u32MstOp != SIM_UI2C_OP_NONE) && (psState->u64MstDone <= g_u64SimCycles))
+        SIM_UI2C_MstComplete(psPeriph);
+
+    while(psState->u32Shift && (psState->u64ShiftDone <= g_u64SimCycles))
+    {
+        if(psState->u32RxCnt >= SIM_USCI_RX_DEPTH)
+            psUspi->BUFSTS |= USPI_BUFSTS_RXOVIF_Msk;
+        else
+        {
+            psState->au32RxBuf[(psState->u32RxHead + psState->u32RxCnt) % SIM_USCI_RX_DEPTH] =
+                psState->u32ShiftData & ((1UL << SIM_USCI_Width(psUspi)) - 1);
+            psState->u32RxCnt++;
+        }
+        psUspi->PROTSTS |= USPI_PROTSTS_TXENDIF_Msk | USPI_PROTSTS_RXENDIF_Msk;
+        psState->u32Shift = 0;
+
+        if(psState->u32TxFull)
+            SIM_USCI_Start(psPeriph, psState->u64ShiftDone);
+    }
+    SIM_USCI_Update(psPeriph);
+}
+
+static void SIM_USCI_Read(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32IsWrite)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    USPI_T *psUspi = SIM_REGS(USPI_T, psPeriph->u32Base);
+
+    SIM_USCI_Tick(psPeriph);
+    if((u32Offset == 0x34) && !u32IsWrite && psState->u32RxCnt)
+    {
+        SIM_SET_RO(psUspi->RXDAT, psState->au32RxBuf[psState->u32RxHead]);
+        psState->u32RxHead = (psState->u32RxHead + 1) % SIM_USCI_RX_DEPTH;
+        psState->u32RxCnt--;
+        SIM_USCI_Update(psPeriph);
+    }
+}
+
+static void SIM_USCI_Write(SIM_PERIPH_T *psPeriph, uint32_t u32Offset, uint32_t u32Old, uint32_t u32New)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    USPI_T *psUspi = SIM_REGS(USPI_T, psPeriph->u32Base);
+    uint32_t u32Clr;
+
+    switch(u32Offset)
+    {
+        case 0x30:                      /* TXDAT, I2C mode keeps it for the next byte */
+            if(!psState->u32TxFull && !SIM_USCI_IsI2c(psUspi))
+            {
+                psState->u32TxData = u32New;
+                psState->u32TxFull = 1;
+                if(!psState->u32Shift)
+                    SIM_USCI_Start(psPeriph, g_u64SimCycles);
+            }
+            break;
+        case 0x38:                      /* BUFCTL: clear and reset bits self-clear */
+            if(u32New & (USPI_BUFCTL_RXCLR_Msk | USPI_BUFCTL_RXRST_Msk))
+            {
+                psState->u32RxCnt = 0;
+                psState->u32RxHead = 0;
+            }
+            if(u32New & (USPI_BUFCTL_TXCLR_Msk | USPI_BUFCTL_TXRST_Msk))
+                psState->u32TxFull = 0;
+            psUspi->BUFCTL = u32New & ~(USPI_BUFCTL_RXCLR_Msk | USPI_BUFCTL_TXCLR_Msk | USPI_BUFCTL_RXRST_Msk | USPI_BUFCTL_TXRST_Msk);
+            break;
+        case 0x3C:                      /* BUFSTS: write 1 to clear */
+            u32Clr = u32New & (USPI_BUFSTS_RXOVIF_Msk | USPI_BUFSTS_TXUDRIF_Msk);
+            psUspi->BUFSTS = u32Old & ~u32Clr;
+            break;
+        case 0x40:
+            psUspi->PDMACTL = u32New & ~USPI_PDMACTL_PDMARST_Msk;
+            break;
+        case 0x5C:                      /* PROTCTL: enabling starts pending data, PTRG releases SCL in I2C mode */
+            if(SIM_USCI_IsI2c(psUspi))
+            {
+                psUspi->PROTCTL = u32New & ~UI2C_PROTCTL_PTRG_Msk;
+                if(psState->psHost != NULL)
+                {
+                    if((u32New & UI2C_PROTCTL_PTRG_Msk) && psState->u32HostWait)
+                        SIM_UI2C_HostRelease(psPeriph, u32New);
+                }
+                else
+                    SIM_UI2C_MstControl(psPeriph, u32New);
+            }
+            else if(!psState->u32Shift && psState->u32TxFull)
+                SIM_USCI_Start(psPeriph, g_u64SimCycles);
+            break;
+        case 0x64:                      /* PROTSTS: write 1 to clear */
+            if(SIM_USCI_IsI2c(psUspi))
+            {
+                psUspi->PROTSTS = u32Old & ~(u32New & SIM_UI2C_PROT_FLAGS);
+                break;
+            }
+            u32Clr = u32New & (USPI_PROTSTS_TXSTIF_Msk | USPI_PROTSTS_TXENDIF_Msk | USPI_PROTSTS_RXSTIF_Msk |
+                               USPI_PROTSTS_RXENDIF_Msk | USPI_PROTSTS_SLVTOIF_Msk | USPI_PROTSTS_SLVBEIF_Msk |
+                               USPI_PROTSTS_SSINAIF_Msk | USPI_PROTSTS_SSACTIF_Msk);
+            psUspi->PROTSTS = u32Old & ~u32Clr;
+            break;
+        default:
+            break;
+    }
+    SIM_USCI_Update(psPeriph);
+}
+
+static void SIM_USCI_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    SIM_I2C_DEV_T *apsDev[SIM_UI2C_MAX_DEV];
+    uint32_t u32Index = psState->u32Index;
+
+    /* Devices stay on the bus */
+    memcpy(apsDev, psState->apsDev, sizeof(apsDev));
+    memset(psState, 0, sizeof(SIM_USCI_STATE_T));
+    psState->u32Index = u32Index;
+    memcpy(psState->apsDev, apsDev, sizeof(apsDev));
+    memset(SIM_REGS(USPI_T, psPeriph->u32Base), 0, psPeriph->u32Size);
+    SIM_USCI_Update(psPeriph);
+}
+
+static uint32_t SIM_USCI_TxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    uint32_t u32Ctl = SIM_REGS(USPI_T, psPeriph->u32Base)->PDMACTL;
+
+    return (u32Ctl & USPI_PDMACTL_PDMAEN_Msk) && (u32Ctl & USPI_PDMACTL_TXPDMAEN_Msk) && !psState->u32TxFull;
+}
+
+static uint32_t SIM_USCI_RxReq(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+    uint32_t u32Ctl = SIM_REGS(USPI_T, psPeriph->u32Base)->PDMACTL;
+
+    return (u32Ctl & USPI_PDMACTL_PDMAEN_Msk) && (u32Ctl & USPI_PDMACTL_RXPDMAEN_Msk) && (psState->u32RxCnt != 0);
+}
+
+static uint32_t SIM_USCI0_TxReq(void)
+{
+    return SIM_USCI_TxReq(&g_sSimUsci0);
+}
+static uint32_t SIM_USCI0_RxReq(void)
+{
+    return SIM_USCI_RxReq(&g_sSimUsci0);
+}
+static uint32_t SIM_USCI1_TxReq(void)
+{
+    return SIM_USCI_TxReq(&g_sSimUsci1);
+}
+static uint32_t SIM_USCI1_RxReq(void)
+{
+    return SIM_USCI_RxReq(&g_sSimUsci1);
+}
+static uint32_t SIM_USCI2_TxReq(void)
+{
+    return SIM_USCI_TxReq(&g_sSimUsci2);
+}
+static uint32_t SIM_USCI2_RxReq(void)
+{
+    return SIM_USCI_RxReq(&g_sSimUsci2);
+}
+
+static void SIM_USCI0_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_USCI0_TX, SIM_USCI0_TxReq);
+    SIM_PDMA_SetRequest(PDMA_USCI0_RX, SIM_USCI0_RxReq);
+}
+
+static void SIM_USCI1_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_USCI1_TX, SIM_USCI1_TxReq);
+    SIM_PDMA_SetRequest(PDMA_USCI1_RX, SIM_USCI1_RxReq);
+}
+
+static void SIM_USCI2_Reset(SIM_PERIPH_T *psPeriph)
+{
+    SIM_USCI_Reset(psPeriph);
+    SIM_PDMA_SetRequest(PDMA_USCI2_TX, SIM_USCI2_TxReq);
+    SIM_PDMA_SetRequest(PDMA_USCI2_RX, SIM_USCI2_RxReq);
+}
+
+SIM_PERIPH_T g_sSimUsci0 =
+{
+    "USCI0", USCI0_BASE, 0x1000, USCI_IRQn, &s_asUsci[0],
+    SIM_USCI0_Reset, SIM_USCI_Read, SIM_USCI_Write, SIM_USCI_Tick
+};
+
+SIM_PERIPH_T g_sSimUsci1 =
+{
+    "USCI1", USCI1_BASE, 0x1000, USCI_IRQn, &s_asUsci[1],
+    SIM_USCI1_Reset, SIM_USCI_Read, SIM_USCI_Write, SIM_USCI_Tick
+};
+
+SIM_PERIPH_T g_sSimUsci2 =
+{
+    "USCI2", USCI2_BASE, 0x1000, USCI_IRQn, &s_asUsci[2],
+    SIM_USCI2_Reset, SIM_USCI_Read, SIM_USCI_Write, SIM_USCI_Tick
+};
+
+static SIM_PERIPH_T *SIM_UI2C_Periph(UI2C_T *ui2c)
+{
+    return (ui2c == UI2C0) ? &g_sSimUsci0 : ((ui2c == UI2C1) ? &g_sSimUsci1 : &g_sSimUsci2);
+}
+
+/**
+  * @brief      Attach a slave device model to the bus of a USCI controller in I2C master mode
+  * @param[in]  ui2c    The pointer of the specified USCI_I2C module
+  * @param[in]  psDev   Device, must stay valid while attached
+  * @retval     0       Success
+  * @retval     -1      Bus already has the maximum number of devices
+  */
+int32_t SIM_UI2C_AttachDevice(UI2C_T *ui2c, SIM_I2C_DEV_T *psDev)
+{
+    SIM_USCI_STATE_T *psState = SIM_UI2C_Periph(ui2c)->pvState;
+    uint32_t i;
+
+    for(i = 0; i < SIM_UI2C_MAX_DEV; i++)
+    {
+        if((psState->apsDev[i] == NULL) || (psState->apsDev[i] == psDev))
+        {
+            psState->apsDev[i] = psDev;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+  * @brief      Attach an EEPROM-style register file to the bus of a USCI controller in I2C master mode
+  * @param[in]  ui2c            The pointer of the specified USCI_I2C module
+  * @param[out] psMem           Device instance to initialize, must stay valid while attached
+  * @param[in]  u8Addr          7-bit slave address
+  * @param[in]  pu8Mem          Backing storage
+  * @param[in]  u32Size         Backing storage size in bytes
+  * @param[in]  u32AddrBytes    Register address length, 1 or 2
+  * @retval     0       Success
+  * @retval     -1      Bus already has the maximum number of devices
+  */
+int32_t SIM_UI2C_AttachMemory(UI2C_T *ui2c, SIM_I2C_MEM_T *psMem, uint8_t u8Addr, uint8_t *pu8Mem, uint32_t u32Size, uint32_t u32AddrBytes)
+{
+    SIM_I2C_InitMemory(psMem, u8Addr, pu8Mem, u32Size, u32AddrBytes);
+    return SIM_UI2C_AttachDevice(ui2c, &psMem->sDev);
+}
+
+/**
+  * @brief      Run a transfer from an external master to a USCI controller in I2C slave mode
+  * @param[in]  ui2c    The pointer of the specified USCI_I2C module
+  * @param[in]  psXfer  Transfer, must stay valid until u32Done is set
+  * @retval     0       Transfer started: START, SLA+W and u32WrLen bytes, then when u32RdLen is not
+  *                     zero a repeated START, SLA+R and u32RdLen bytes with NACK on the last, then STOP
+  * @retval     -1      The bus is busy or the controller is not in I2C mode
+  * @details    Steps advance with simulated time at u32BusHz while the controller does not hold SCL
+  *             low, i.e. from each PTRG to the next protocol flag. A data NACK ends the transfer with
+  *             a STOP, an address that does not match ends it without any flag.
+  */
+int32_t SIM_UI2C_HostXfer(UI2C_T *ui2c, SIM_I2C_HOST_XFER_T *psXfer)
+{
+    SIM_PERIPH_T *psPeriph = SIM_UI2C_Periph(ui2c);
+    SIM_USCI_STATE_T *psState = psPeriph->pvState;
+
+    if((psState->psHost != NULL) || psState->u32MstOwned || (psState->u32MstOp != SIM_UI2C_OP_NONE) || !SIM_USCI_IsI2c(SIM_REGS(USPI_T, psPeriph->u32Base)))
+        return -1;
+
+    psXfer->u32Done = 0;
+    psXfer->i32Status = 0;
+    psXfer->u64Start = g_u64SimCycles;
+    psState->psHost = psXfer;
+    psState->u32HostRead = (psXfer->u32WrLen == 0);
+    SIM_UI2C_HostSchedule(psPeriph, SIM_UI2C_HOST_START, 1);
+    return 0;
+}
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
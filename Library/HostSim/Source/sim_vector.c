@@ -0,0 +1,66 @@
+/**************************************************************************//**
+ * @file     sim_vector.c
+ * @version  V1.00
+ * @brief    NUC029xGE host simulator default exception handlers
+ *
+ * @note     Host counterpart of the weak handlers in startup_NUC029xGE.S. Firmware and
+ *           drivers override them by defining a handler with the same name.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim_core.h"
+
+/** @addtogroup HostSim Host Simulator
+  @{
+*/
+
+/**
+  * @brief      Handler of an exception the firmware did not provide
+  * @param      None
+  * @return     None
+  * @details    The real part would spin in Default_Handler forever. The host build stops instead
+  *             so that a missing handler shows up as a failing run rather than a hang.
+  */
+void SIM_DefaultHandler(void)
+{
+    printf("[HostSim] unhandled exception, IPSR %u at cycle %llu\n", SIM_GetIpsr(), (unsigned long long)g_u64SimCycles);
+    exit(1);
+}
+
+#define SIM_WEAK_HANDLER(name)  void name(void) __attribute__((weak, alias("SIM_DefaultHandler")))
+
+SIM_WEAK_HANDLER(SysTick_Handler);
+SIM_WEAK_HANDLER(BOD_IRQHandler);
+SIM_WEAK_HANDLER(WDT_IRQHandler);
+SIM_WEAK_HANDLER(EINT024_IRQHandler);
+SIM_WEAK_HANDLER(EINT135_IRQHandler);
+SIM_WEAK_HANDLER(GPAB_IRQHandler);
+SIM_WEAK_HANDLER(GPCDEF_IRQHandler);
+SIM_WEAK_HANDLER(PWM0_IRQHandler);
+SIM_WEAK_HANDLER(PWM1_IRQHandler);
+SIM_WEAK_HANDLER(TMR0_IRQHandler);
+SIM_WEAK_HANDLER(TMR1_IRQHandler);
+SIM_WEAK_HANDLER(TMR2_IRQHandler);
+SIM_WEAK_HANDLER(TMR3_IRQHandler);
+SIM_WEAK_HANDLER(UART02_IRQHandler);
+SIM_WEAK_HANDLER(UART1_IRQHandler);
+SIM_WEAK_HANDLER(SPI0_IRQHandler);
+SIM_WEAK_HANDLER(SPI1_IRQHandler);
+SIM_WEAK_HANDLER(I2C0_IRQHandler);
+SIM_WEAK_HANDLER(I2C1_IRQHandler);
+SIM_WEAK_HANDLER(USCI_IRQHandler);
+SIM_WEAK_HANDLER(USBD_IRQHandler);
+SIM_WEAK_HANDLER(SC01_IRQHandler);
+SIM_WEAK_HANDLER(ACMP01_IRQHandler);
+SIM_WEAK_HANDLER(PDMA_IRQHandler);
+SIM_WEAK_HANDLER(PWRWU_IRQHandler);
+SIM_WEAK_HANDLER(ADC_IRQHandler);
+SIM_WEAK_HANDLER(CLKDIRC_IRQHandler);
+SIM_WEAK_HANDLER(RTC_IRQHandler);
+
+/*@}*/ /* end of group HostSim */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,32 @@
+#/**************************************************************************//**
+# * @file     hostsim.mk
+# * @version  V1.00
+# * @brief    NUC029xGE host simulator build rules
+# *
+# * @note     Include from a host program Makefile after setting HOSTSIM_DIR to this folder.
+# *           Adds the simulator, system_NUC029xGE.c and the StdDriver sources (retarget.c
+# *           excluded, printf goes to the host stdout) to HOSTSIM_SRC and the matching
+# *           compiler/linker options to HOSTSIM_CFLAGS/HOSTSIM_LDFLAGS.
+# *           Peripheral registers are mapped at their real addresses, so programs are linked
+# *           non-PIE and keep DMA buffers in static storage.
+# *
+# * @copyright SPDX-License-Identifier: Apache-2.0
+# * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+# *****************************************************************************/
+
+LIBRARY_DIR     := $(HOSTSIM_DIR)/..
+
+HOSTSIM_SRC     := $(wildcard $(HOSTSIM_DIR)/Source/*.c) \
+                   $(LIBRARY_DIR)/Device/Nuvoton/NUC029xGE/Source/system_NUC029xGE.c \
+                   $(filter-out %/retarget.c, $(wildcard $(LIBRARY_DIR)/StdDriver/src/*.c))
+
+HOSTSIM_CFLAGS  := -D_GNU_SOURCE -DHOSTSIM \
+                   -include $(HOSTSIM_DIR)/Include/hostsim_cmsis.h \
+                   -I$(HOSTSIM_DIR)/Include \
+                   -I$(LIBRARY_DIR)/Device/Nuvoton/NUC029xGE/Include \
+                   -I$(LIBRARY_DIR)/CMSIS/Include \
+                   -I$(LIBRARY_DIR)/StdDriver/inc \
+                   -fno-pie -fno-strict-aliasing \
+                   -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast
+
+HOSTSIM_LDFLAGS := -no-pie
@@ -103,10 +103,28 @@ extern "C"
 #define ADC_LESS_THAN          0   /*!< ADC compare condition is "less than the compare value"                */
 #define ADC_GREATER_OR_EQUAL   1   /*!< ADC compare condition is "greater than or equal to the compare value" */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* ADC PDMA Stream Constant Definitions                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+#define ADC_STREAM_EVENT_HALF       (0x1UL)         /*!< First half of the stream buffer is filled  */
+#define ADC_STREAM_EVENT_FULL       (0x2UL)         /*!< Second half of the stream buffer is filled */
+#define ADC_STREAM_EVENT_OVERRUN    (0x4UL)         /*!< A half was not released in time, samples were lost and the stream restarted at the first half */
+
+#define ADC_STREAM_CONTINUOUS       (0xFFFFFFFFUL)  /*!< ADC_StartStream trigger source: free running continuous scan at the full conversion rate */
+#define ADC_STREAM_MAX_LEN          (32768)         /*!< Maximum number of samples of an ADC stream buffer */
 
 
 /*@}*/ /* end of group ADC_EXPORTED_CONSTANTS */
 
+
+/** @addtogroup ADC_EXPORTED_STRUCTS ADC Exported Structs
+  @{
+*/
+
+typedef void (*ADC_STREAM_CB)(uint32_t u32Event, uint16_t *pu16Data, uint32_t u32Count);   /*!< Functional pointer type declaration for ADC stream callback */
+
+/*@}*/ /* end of group ADC_EXPORTED_STRUCTS */
+
 /** @addtogroup ADC_EXPORTED_FUNCTIONS ADC Exported Functions
   @{
 */
@@ -336,6 +354,8 @@ void ADC_EnableHWTrigger(ADC_T *adc,
 void ADC_DisableHWTrigger(ADC_T *adc);
 void ADC_EnableInt(ADC_T *adc, uint32_t u32Mask);
 void ADC_DisableInt(ADC_T *adc, uint32_t u32Mask);
+int32_t ADC_StartStream(ADC_T *adc, uint32_t u32ChMask, uint32_t u32Source, uint32_t u32Param, uint16_t *pu16Buf, uint32_t u32Count, ADC_STREAM_CB pfnCallback);
+void ADC_StopStream(ADC_T *adc);
 
 
 
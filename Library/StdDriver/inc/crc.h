@@ -97,6 +97,10 @@ extern "C"
 
 void CRC_Open(uint32_t u32Mode, uint32_t u32Attribute, uint32_t u32Seed, uint32_t u32DataLen);
 uint32_t CRC_GetChecksum(void);
+uint32_t CRC_Calculate(const void *pvBuf, uint32_t u32Len);
+uint32_t CRC_Crc7(uint32_t u32Crc, const void *pvBuf, uint32_t u32Len);
+uint32_t CRC_Crc16(uint32_t u32Crc, const void *pvBuf, uint32_t u32Len);
+uint32_t CRC_Crc32(uint32_t u32Crc, const void *pvBuf, uint32_t u32Len);
 
 /*@}*/ /* end of group CRC_EXPORTED_FUNCTIONS */
 
@@ -52,6 +52,12 @@ extern "C"
 
 #define FMC_FLASH_PAGE_SIZE     0x800           /*!< Flash Page Size (2048 Bytes) */
 #define FMC_LDROM_SIZE          0x1000          /*!< LDROM Size (4 kBytes)       */
+#define FMC_MULTI_WORD_PROG_LEN 256             /*!< Maximum data length of one multi-word program (bytes) */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Placement of the bulk program functions in SRAM, see RAMFUNC in system_NUC029xGE.h                      */
+/*---------------------------------------------------------------------------------------------------------*/
+#define FMC_RAMFUNC             RAMFUNC
 
 /*---------------------------------------------------------------------------------------------------------*/
 /*  ISPCTL constant definitions                                                                            */
@@ -809,6 +815,9 @@ int32_t FMC_GetBootSource(void);
 uint32_t FMC_ReadDataFlashBaseAddr(void);
 void FMC_EnableFreqOptimizeMode(uint32_t u32Mode);
 void FMC_DisableFreqOptimizeMode(void);
+int32_t FMC_ErasePages(uint32_t u32Addr, uint32_t u32Count);
+int32_t FMC_WriteMultiple(uint32_t u32Addr, uint32_t *pu32Buf, uint32_t u32Len);
+int32_t FMC_ProgramPage(uint32_t u32PageAddr, uint32_t *pu32Buf);
 
 /*@}*/ /* end of group FMC_EXPORTED_FUNCTIONS */
 
@@ -0,0 +1,48 @@
+/**************************************************************************//**
+ * @file     fmem.h
+ * @version  V3.00
+ * @brief    NUC029xGE series word-oriented memory copy/fill/compare routines header file
+ *
+ * @note
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __FMEM_H__
+#define __FMEM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Standard_Driver Standard Driver
+  @{
+*/
+
+/** @addtogroup FMEM_Driver FMEM Driver
+  @{
+*/
+
+/** @addtogroup FMEM_EXPORTED_FUNCTIONS FMEM Exported Functions
+  @{
+*/
+
+void *FMEM_Copy(void *pvDst, const void *pvSrc, uint32_t u32Len);
+void *FMEM_Move(void *pvDst, const void *pvSrc, uint32_t u32Len);
+void *FMEM_Set(void *pvDst, uint32_t u32Val, uint32_t u32Len);
+int32_t FMEM_Compare(const void *pvBuf1, const void *pvBuf2, uint32_t u32Len);
+
+/*@}*/ /* end of group FMEM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group FMEM_Driver */
+
+/*@}*/ /* end of group Standard_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__FMEM_H__
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
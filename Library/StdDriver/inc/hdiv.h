@@ -46,9 +46,9 @@ extern "C"
  */
 static __INLINE int32_t HDIV_Div(int32_t x, int16_t y)
 {
-    uint32_t *p32;
+    volatile uint32_t *p32;
 
-    p32 = (uint32_t *)HDIV_BASE;
+    p32 = (volatile uint32_t *)HDIV_BASE;
     *p32++ = x;
     *p32++ = y;
     return *p32;
@@ -67,14 +67,25 @@ static __INLINE int32_t HDIV_Div(int32_t x, int16_t y)
  */
 static __INLINE int16_t HDIV_Mod(int32_t x, int16_t y)
 {
-    uint32_t *p32;
+    volatile uint32_t *p32;
 
-    p32 = (uint32_t *)HDIV_BASE;
+    p32 = (volatile uint32_t *)HDIV_BASE;
     *p32++ = x;
     *p32++ = y;
     return p32[1];
 }
 
+void HDIV_Open(void);
+void HDIV_Close(void);
+
+#if defined(HDIV_ENABLE_AEABI)
+int32_t __aeabi_idiv0(int32_t i32Result);     /* Division by zero handler, from the compiler library or the application */
+int32_t __aeabi_idiv(int32_t i32Dividend, int32_t i32Divisor);
+uint32_t __aeabi_uidiv(uint32_t u32Dividend, uint32_t u32Divisor);
+uint64_t __aeabi_idivmod(int32_t i32Dividend, int32_t i32Divisor);
+uint64_t __aeabi_uidivmod(uint32_t u32Dividend, uint32_t u32Divisor);
+#endif
+
 /*@}*/ /* end of group HDIV_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group HDIV_Driver */
@@ -62,8 +62,89 @@ extern "C"
 #define I2C_ERR_FAIL    (-1L)            /*!< I2C operation failed                                                        */
 #define I2C_ERR_TIMEOUT (-2L)            /*!< I2C operation abort due to timeout error                                    */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* I2C Asynchronous Transfer Constant Definitions                                                          */
+/*---------------------------------------------------------------------------------------------------------*/
+#define I2C_XFER_WRITE  0                /*!< Send SLA+W, register address bytes, then data                               */
+#define I2C_XFER_READ   1                /*!< Send SLA+W and register address bytes if any, repeated START, SLA+R, read data */
+#define I2C_XFER_PENDING (1L)            /*!< Transfer is queued or in progress                                           */
+#define I2C_ASYNC_NUM   2                /*!< Number of I2C modules supporting asynchronous transfer                      */
+
 /*@}*/ /* end of group I2C_EXPORTED_CONSTANTS */
 
+
+/** @addtogroup I2C_EXPORTED_STRUCTS I2C Exported Structs
+  @{
+*/
+
+struct S_I2C_XFER;
+typedef void (*I2C_XFER_CB)(struct S_I2C_XFER *psXfer);   /*!< Functional pointer type declaration for I2C transfer completion callback */
+
+/**
+  * @details    I2C transfer descriptor. Owned by the caller and must stay valid until the transfer is done.
+  */
+typedef struct S_I2C_XFER
+{
+    struct S_I2C_XFER *psNext;      /*!< Next queued transfer, used by the driver */
+    uint8_t u8SlaveAddr;            /*!< 7-bit slave address */
+    uint8_t u8Dir;                  /*!< \ref I2C_XFER_WRITE or \ref I2C_XFER_READ */
+    uint8_t u8RegLen;               /*!< Register address bytes sent before the data, 0 ~ 4 */
+    uint8_t u8RegIdx;               /*!< Register address bytes sent, used by the driver */
+    uint32_t u32RegAddr;            /*!< Register address, sent MSB first */
+    uint8_t *pu8Buf;                /*!< Data buffer */
+    uint32_t u32Len;                /*!< Data bytes, at least 1 for a read */
+    volatile uint32_t u32Count;     /*!< Data bytes transferred */
+    volatile int32_t i32Status;     /*!< \ref I2C_XFER_PENDING while queued, \ref I2C_OK when done, \ref I2C_ERR_FAIL on NACK or bus error, \ref I2C_ERR_TIMEOUT on bus time-out */
+    I2C_XFER_CB pfnCallback;        /*!< Completion callback, called in interrupt context. Can be NULL */
+    void *pvArg;                    /*!< User data for the callback */
+} S_I2C_XFER_T;
+
+/**
+  * @details    I2C asynchronous transfer control block. Queued transfers run back to back from the I2C interrupt,
+  *             a STOP followed by a START separating them. With u32UseDMA, the data bytes of a write and all but
+  *             the last data byte of a read are moved by PDMA, so a transfer costs the same few interrupts
+  *             whatever its length.
+  */
+typedef struct
+{
+    S_I2C_XFER_T *psHead;           /*!< Transfer on the bus */
+    S_I2C_XFER_T *psTail;           /*!< Last queued transfer */
+    uint32_t u32UseDMA;             /*!< 1 to move data bytes by PDMA, I2C_OpenAsync takes one channel */
+    int32_t i32DmaCh;               /*!< PDMA channel, -1 without PDMA, used by the driver */
+    uint32_t u32DmaLen;             /*!< Bytes of the PDMA block in progress, used by the driver */
+} S_I2C_ASYNC_T;
+
+struct S_I2C_SLAVE;
+typedef void (*I2C_SLAVE_READ_CB)(struct S_I2C_SLAVE *psSlave, uint8_t u8Addr, uint32_t u32Reg);   /*!< Functional pointer type declaration for I2C slave read start callback */
+typedef void (*I2C_SLAVE_WRITE_CB)(struct S_I2C_SLAVE *psSlave, uint8_t u8Addr, uint32_t u32Reg, uint32_t u32Len);   /*!< Functional pointer type declaration for I2C slave write done callback */
+
+/**
+  * @details    I2C slave register map. Owned by the caller and must stay valid until I2C_CloseSlave is called.
+  *             After SLA+W the master sends the register pointer, most significant byte first, then data written
+  *             to the registers. After SLA+R the master reads registers from the pointer. The pointer increments
+  *             after every data byte and wraps at the end of the map. With u32UseDMA, the data bytes of a transfer
+  *             are moved by PDMA from the end of the register pointer to STOP, so a bulk block costs two interrupts.
+  */
+typedef struct S_I2C_SLAVE
+{
+    uint8_t *pu8Regs;               /*!< Register file */
+    uint32_t u32Size;               /*!< Register file size in bytes */
+    uint32_t u32PtrLen;             /*!< Register pointer bytes following SLA+W, 1 or 2 */
+    I2C_SLAVE_READ_CB pfnRead;      /*!< Called on SLA+R before the first register is sent, can update the registers. Can be NULL */
+    I2C_SLAVE_WRITE_CB pfnWrite;    /*!< Called once per write with the registers written, on STOP, repeated START or NACK. Can be NULL */
+    void *pvArg;                    /*!< User data for the callbacks */
+    uint32_t u32UseDMA;             /*!< 1 to move data bytes by PDMA, I2C_OpenSlave takes one channel */
+    volatile uint32_t u32Ptr;       /*!< Register pointer */
+    uint32_t u32PtrIdx;             /*!< Register pointer bytes received, used by the driver */
+    uint32_t u32WrReg;              /*!< First register written in the current transfer, used by the driver */
+    uint32_t u32WrLen;              /*!< Registers written in the current transfer, used by the driver */
+    int32_t i32DmaCh;               /*!< PDMA channel, -1 without PDMA, used by the driver */
+    uint32_t u32DmaLen;             /*!< Bytes of the PDMA block in progress, used by the driver */
+    uint8_t u8Addr;                 /*!< 7-bit address the current transfer was sent to */
+} S_I2C_SLAVE_T;
+
+/*@}*/ /* end of group I2C_EXPORTED_STRUCTS */
+
 extern int32_t g_I2C_i32ErrCode;
 
 /** @addtogroup I2C_EXPORTED_FUNCTIONS I2C Exported Functions
@@ -266,6 +347,14 @@ uint8_t I2C_ReadByteOneReg(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t u8DataAddr);
 uint32_t I2C_ReadMultiBytesOneReg(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t u8DataAddr, uint8_t *rdata, uint32_t u32rLen);
 uint8_t I2C_ReadByteTwoRegs(I2C_T *i2c, uint8_t u8SlaveAddr, uint16_t u16DataAddr);
 uint32_t I2C_ReadMultiBytesTwoRegs(I2C_T *i2c, uint8_t u8SlaveAddr, uint16_t u16DataAddr, uint8_t *rdata, uint32_t u32rLen);
+int32_t I2C_OpenAsync(I2C_T *i2c, S_I2C_ASYNC_T *psAsync);
+void I2C_CloseAsync(I2C_T *i2c);
+int32_t I2C_SubmitAsync(I2C_T *i2c, S_I2C_XFER_T *psXfer);
+uint32_t I2C_IsAsyncBusy(I2C_T *i2c);
+void I2C_AsyncIRQHandler(I2C_T *i2c);
+int32_t I2C_OpenSlave(I2C_T *i2c, S_I2C_SLAVE_T *psSlave);
+void I2C_CloseSlave(I2C_T *i2c);
+void I2C_SlaveIRQHandler(I2C_T *i2c);
 /*@}*/ /* end of group I2C_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group I2C_Driver */
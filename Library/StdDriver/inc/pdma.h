@@ -119,9 +119,39 @@ extern "C"
 #define PDMA_INT_TEMPTY     0x00000001UL            /*!<Table Empty Interrupt  \hideinitializer */
 #define PDMA_INT_TIMEOUT    0x00000002UL            /*!<Timeout Interrupt  \hideinitializer */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Channel Manager Constant Definitions                                                                   */
+/*---------------------------------------------------------------------------------------------------------*/
+#ifndef PDMA_DESC_NUM
+#define PDMA_DESC_NUM       16                      /*!<Number of scatter-gather descriptors in the shared pool  \hideinitializer */
+#endif
+
+#ifdef PDMA_ENABLE_RAMFUNC
+#define PDMA_RAMFUNC        RAMFUNC                 /*!<PDMA_ChannelIRQHandler executes in SRAM  \hideinitializer */
+#else
+#define PDMA_RAMFUNC                                /*!<PDMA_ChannelIRQHandler executes in Flash  \hideinitializer */
+#endif
+
+#define PDMA_CH_ANY         ((1UL << PDMA_CH_MAX) - 1) /*!<Any channel can be used  \hideinitializer */
+#define PDMA_CH_TIMEOUT     0x00000003UL            /*!<Channels with request time-out function (channel 0 and 1)  \hideinitializer */
+
+#define PDMA_EVENT_DONE     0x00000001UL            /*!<Transfer done, or a table with interrupt enabled in a scatter-gather chain is done  \hideinitializer */
+#define PDMA_EVENT_ABORT    0x00000002UL            /*!<Target abort  \hideinitializer */
+#define PDMA_EVENT_EMPTY    0x00000004UL            /*!<Scatter-gather chain reached a descriptor in stop mode  \hideinitializer */
+#define PDMA_EVENT_TIMEOUT  0x00000008UL            /*!<Peripheral request time-out  \hideinitializer */
+
 
 /*@}*/ /* end of group PDMA_EXPORTED_CONSTANTS */
 
+
+/** @addtogroup PDMA_EXPORTED_STRUCTS PDMA Exported Structs
+  @{
+*/
+
+typedef void (*PDMA_CB)(uint32_t u32Ch, uint32_t u32Event);   /*!< Functional pointer type declaration for PDMA channel event callback */
+
+/*@}*/ /* end of group PDMA_EXPORTED_STRUCTS */
+
 /** @addtogroup PDMA_EXPORTED_FUNCTIONS PDMA Exported Functions
   @{
 */
@@ -312,6 +342,12 @@ void PDMA_SetTimeOut(uint32_t u32Ch, uint32_t u32OnOff, uint32_t u32TimeOutCnt);
 void PDMA_Trigger(uint32_t u32Ch);
 void PDMA_EnableInt(uint32_t u32Ch, uint32_t u32Mask);
 void PDMA_DisableInt(uint32_t u32Ch, uint32_t u32Mask);
+int32_t PDMA_RequestChannel(uint32_t u32ChMask, PDMA_CB pfnCallback);
+void PDMA_ReleaseChannel(uint32_t u32Ch);
+DSCT_T *PDMA_DescAlloc(void);
+void PDMA_DescFree(DSCT_T *psDesc);
+void PDMA_DescSet(DSCT_T *psDesc, uint32_t u32Config, uint32_t u32TransCount, uint32_t u32SrcAddr, uint32_t u32DstAddr, DSCT_T *psNext);
+void PDMA_ChannelIRQHandler(void);
 
 
 /*@}*/ /* end of group PDMA_EXPORTED_FUNCTIONS */
@@ -113,9 +113,62 @@ extern "C"
 #define SPII2S_RIGHT_ZC_INT_MASK            (0x20)                          /*!< Right channel zero cross interrupt mask */
 #define SPII2S_LEFT_ZC_INT_MASK             (0x40)                          /*!< Left channel zero cross interrupt mask */
 
+/* SPI asynchronous transfer */
+#define SPI_XFER_KEEP_SS    (0x1UL)     /*!< Leave slave select active after the transfer, for a command followed by data */
+#define SPI_XFER_NO_SS      (0x2UL)     /*!< Do not drive slave select, the caller selects the device */
+#define SPI_XFER_DMA        (0x4UL)     /*!< Data moved by PDMA, set by \ref SPI_TransferDMA */
+#define SPI_XFER_PENDING    (1L)        /*!< Transfer is queued or in progress */
+#define SPI_ASYNC_NUM       2           /*!< Number of SPI modules supporting asynchronous transfer */
+#define SPI_DMA_MAX_LEN     16384       /*!< Maximum data units of one PDMA block (14-bit TXCNT), longer transfers are split */
+
 /*@}*/ /* end of group SPI_EXPORTED_CONSTANTS */
 
 
+/** @addtogroup SPI_EXPORTED_STRUCTS SPI Exported Structs
+  @{
+*/
+
+struct S_SPI_XFER;
+typedef void (*SPI_XFER_CB)(struct S_SPI_XFER *psXfer);   /*!< Functional pointer type declaration for SPI transfer completion callback */
+
+/**
+  * @details    SPI full-duplex transfer descriptor. Owned by the caller and must stay valid until the transfer is done.
+  *             Buffers hold one uint8_t, uint16_t or uint32_t per data unit, following the data width.
+  */
+typedef struct S_SPI_XFER
+{
+    struct S_SPI_XFER *psNext;      /*!< Next queued transfer, used by the driver */
+    const void *pvTxBuf;            /*!< Data to send, NULL sends all ones */
+    void *pvRxBuf;                  /*!< Received data, NULL discards it */
+    uint32_t u32Len;                /*!< Number of data units */
+    uint32_t u32Flags;              /*!< \ref SPI_XFER_KEEP_SS, \ref SPI_XFER_NO_SS */
+    volatile uint32_t u32TxCount;   /*!< Data units written to TX FIFO or handed to PDMA, used by the driver */
+    volatile uint32_t u32RxCount;   /*!< Data units received */
+    volatile int32_t i32Status;     /*!< \ref SPI_XFER_PENDING while queued, 0 when done */
+    SPI_XFER_CB pfnCallback;        /*!< Completion callback, called in interrupt context. Can be NULL */
+    void *pvArg;                    /*!< User data for the callback */
+} S_SPI_XFER_T;
+
+/**
+  * @details    SPI asynchronous transfer control block. Queued transfers run back to back, each one by PDMA or
+  *             by the SPI FIFO threshold interrupt.
+  */
+typedef struct
+{
+    S_SPI_XFER_T *psHead;           /*!< Transfer on the bus */
+    S_SPI_XFER_T *psTail;           /*!< Last queued transfer */
+    int32_t i32TxCh;                /*!< PDMA TX channel, -1 without PDMA */
+    int32_t i32RxCh;                /*!< PDMA RX channel, -1 without PDMA */
+    uint32_t u32SSLevel;            /*!< \ref SPI_SS_ACTIVE_LOW or \ref SPI_SS_ACTIVE_HIGH */
+    uint32_t u32Unit;               /*!< Buffer bytes per data unit of the transfer on the bus */
+    uint32_t u32TxFill;             /*!< PDMA source when there is no TX buffer */
+    uint32_t u32RxSink;             /*!< PDMA destination when there is no RX buffer */
+} S_SPI_ASYNC_T;
+
+/*@}*/ /* end of group SPI_EXPORTED_STRUCTS */
+
+
+
 /** @addtogroup SPI_EXPORTED_FUNCTIONS SPI Exported Functions
   @{
 */
@@ -536,6 +589,12 @@ void SPI_DisableInt(SPI_T *spi, uint32_t u32Mask);
 uint32_t SPI_GetIntFlag(SPI_T *spi, uint32_t u32Mask);
 void SPI_ClearIntFlag(SPI_T *spi, uint32_t u32Mask);
 uint32_t SPI_GetStatus(SPI_T *spi, uint32_t u32Mask);
+int32_t SPI_OpenAsync(SPI_T *spi, S_SPI_ASYNC_T *psAsync, uint32_t u32ActiveLevel, uint32_t u32UseDMA);
+void SPI_CloseAsync(SPI_T *spi);
+int32_t SPI_TransferIRQ(SPI_T *spi, S_SPI_XFER_T *psXfer);
+int32_t SPI_TransferDMA(SPI_T *spi, S_SPI_XFER_T *psXfer);
+uint32_t SPI_IsAsyncBusy(SPI_T *spi);
+void SPI_AsyncIRQHandler(SPI_T *spi);
 
 uint32_t SPII2S_Open(SPI_T *i2s, uint32_t u32MasterSlave, uint32_t u32SampleRate, uint32_t u32WordWidth, uint32_t u32Channels, uint32_t u32DataFormat);
 void SPII2S_Close(SPI_T *i2s);
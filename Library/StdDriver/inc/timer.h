@@ -61,9 +61,57 @@ extern "C"
 #define TIMER_ERR_FAIL                          (-1L)                             /*!< TIMER operation failed */
 #define TIMER_ERR_TIMEOUT                       (-2L)                             /*!< TIMER operation abort due to timeout error */
 
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Software Timer Wheel Constant Definitions                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+#define TIMER_WHEEL_BITS                        5                                 /*!< Slot index bits per wheel level */
+#define TIMER_WHEEL_SLOTS                       (1UL << TIMER_WHEEL_BITS)         /*!< Slots per wheel level */
+#define TIMER_WHEEL_LEVELS                      4                                 /*!< Wheel levels, timers beyond 2^20 ticks are re-cascaded from the top level */
+#define TIMER_WHEEL_MAX_TICKS                   0x7FFFFFFFUL                      /*!< Longest software timer delay or period in ticks */
+
 /*@}*/ /* end of group TIMER_EXPORTED_CONSTANTS */
 
 
+/** @addtogroup TIMER_EXPORTED_STRUCTS TIMER Exported Structs
+  @{
+*/
+
+typedef void (*TIMER_SW_CB)(void *pvArg);   /*!< Functional pointer type declaration for software timer expiry callback */
+
+/**
+  * @details    Software timer. Owned by the caller and linked into the wheel while armed.
+  */
+typedef struct S_TIMER_SW
+{
+    struct S_TIMER_SW *psNext;      /*!< Next timer in the same wheel slot */
+    struct S_TIMER_SW **ppsPrev;    /*!< Link pointing at this timer, NULL while the timer is not armed */
+    uint32_t u32Expire;             /*!< Expiry tick */
+    uint32_t u32Period;             /*!< Reload period in ticks, 0 for a one-shot timer */
+    uint32_t u32Slot;               /*!< Wheel slot holding the timer */
+    TIMER_SW_CB pfnCallback;        /*!< Expiry callback, called in interrupt context */
+    void *pvArg;                    /*!< Callback argument */
+} S_TIMER_SW_T;
+
+/**
+  * @details    Software timer service control block. A hierarchical timing wheel of TIMER_WHEEL_LEVELS levels
+  *             of TIMER_WHEEL_SLOTS slots keeps insert and cancel O(1). The hardware timer counts ticks in
+  *             continuous mode and its compare register is moved to the next tick at which a slot has work,
+  *             so there is no periodic interrupt while nothing is due.
+  */
+typedef struct
+{
+    TIMER_T *psTimer;                                               /*!< Hardware timer counting the ticks */
+    uint32_t u32Now;                                                /*!< Next tick the wheel has to process */
+    uint32_t u32HwTick;                                             /*!< Last tick read from the hardware counter, extended to 32 bits */
+    uint32_t u32Deadline;                                           /*!< Tick the compare register is set to */
+    uint32_t au32Map[TIMER_WHEEL_LEVELS];                           /*!< Non-empty slot bitmap per level */
+    S_TIMER_SW_T *psExpired;                                        /*!< Timers of the tick being processed whose callback has not run yet */
+    S_TIMER_SW_T *apsSlot[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];  /*!< Slot list heads */
+} S_TIMER_WHEEL_T;
+
+/*@}*/ /* end of group TIMER_EXPORTED_STRUCTS */
+
+
 /** @addtogroup TIMER_EXPORTED_FUNCTIONS TIMER Exported Functions
   @{
 */
@@ -435,6 +483,18 @@ static __INLINE uint32_t TIMER_GetCounter(TIMER_T *timer)
     return timer->CNT;
 }
 
+/**
+  * @brief      Check if a software timer is armed
+  *
+  * @param[in]  psTimer     The pointer of the software timer.
+  *
+  * @retval     0   Software timer is stopped or has expired
+  * @retval     1   Software timer is armed
+  *
+  * @details    A periodic timer stays armed until \ref TIMER_StopSW is called.
+  */
+#define TIMER_IS_SW_ACTIVE(psTimer)                 (((psTimer)->ppsPrev != NULL) ? 1 : 0)
+
 
 uint32_t TIMER_Open(TIMER_T *timer, uint32_t u32Mode, uint32_t u32Freq);
 void TIMER_Close(TIMER_T *timer);
@@ -449,6 +509,12 @@ void TIMER_DisableFreqCounter(TIMER_T *timer);
 void TIMER_SetTriggerSource(TIMER_T *timer, uint32_t u32Src);
 void TIMER_SetTriggerTarget(TIMER_T *timer, uint32_t u32Mask);
 int32_t TIMER_ResetCounter(TIMER_T *timer);
+uint32_t TIMER_OpenWheel(TIMER_T *timer, S_TIMER_WHEEL_T *psWheel, uint32_t u32TickFreq);
+void TIMER_CloseWheel(TIMER_T *timer);
+uint32_t TIMER_GetWheelTick(S_TIMER_WHEEL_T *psWheel);
+int32_t TIMER_StartSW(S_TIMER_WHEEL_T *psWheel, S_TIMER_SW_T *psTimer, uint32_t u32Ticks, uint32_t u32Period, TIMER_SW_CB pfnCallback, void *pvArg);
+void TIMER_StopSW(S_TIMER_WHEEL_T *psWheel, S_TIMER_SW_T *psTimer);
+void TIMER_WheelIRQHandler(TIMER_T *timer);
 
 /*@}*/ /* end of group TIMER_EXPORTED_FUNCTIONS */
 
@@ -0,0 +1,123 @@
+/**************************************************************************//**
+ * @file     trace.h
+ * @version  V3.00
+ * @brief    NUC029xGE series driver event trace header file
+ *
+ * @note
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Standard_Driver Standard Driver
+  @{
+*/
+
+/** @addtogroup TRACE_Driver TRACE Driver
+  @{
+*/
+
+/** @addtogroup TRACE_EXPORTED_CONSTANTS TRACE Exported Constants
+  @{
+*/
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Event ID Constant Definitions                                                                          */
+/*---------------------------------------------------------------------------------------------------------*/
+#define TRACE_ID_END            0x80UL  /*!< Set in the ID of a record closing a span opened by \ref TRACE_BEGIN */
+#define TRACE_ID_I2C_READ       0x01UL  /*!< I2C_ReadMultiBytes*(), arg is the requested / received length */
+#define TRACE_ID_I2C_WRITE      0x02UL  /*!< I2C_WriteMultiBytes*(), arg is the requested / sent length */
+#define TRACE_ID_USBD_IRQ       0x10UL  /*!< USBD_IRQHandler(), arg is USBD_INTSTS */
+#define TRACE_ID_USBD_SETUP     0x11UL  /*!< USBD_ProcessSetupPacket(), arg is bmRequestType | bRequest << 8 */
+#define TRACE_ID_USER           0x40UL  /*!< First ID free for the application, IDs go up to 0x7F */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Stream Constant Definitions                                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+#define TRACE_MAGIC             0x4352544EUL    /*!< "NTRC", first word of each block from \ref TRACE_Read */
+#define TRACE_HEADER_SIZE       20UL            /*!< Block header size in bytes */
+#define TRACE_RECORD_SIZE       8UL             /*!< Record size in bytes */
+
+/*@}*/ /* end of group TRACE_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup TRACE_EXPORTED_STRUCTS TRACE Exported Structs
+  @{
+*/
+
+/**
+  * @details    One trace record. Bits 31:24 of u32Stamp are the event ID and bits 23:0 the timestamp.
+  */
+typedef struct
+{
+    uint32_t u32Stamp;          /*!< Event ID and timestamp */
+    uint32_t u32Arg;            /*!< Event argument */
+} S_TRACE_REC_T;
+
+/*@}*/ /* end of group TRACE_EXPORTED_STRUCTS */
+
+
+/** @addtogroup TRACE_EXPORTED_FUNCTIONS TRACE Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Record a point event, or the start of a span
+  * @param[in]  id      Event ID, 0x01 ~ 0x7F
+  * @param[in]  arg     32-bit event argument
+  * @return     None
+  * @details    Trace points compile to nothing unless TRACE_ENABLE is defined.
+  */
+#if defined(TRACE_ENABLE)
+#define TRACE_BEGIN(id, arg)    TRACE_Record((id), (uint32_t)(arg))
+#else
+#define TRACE_BEGIN(id, arg)
+#endif
+
+/**
+  * @brief      Record the end of a span
+  * @param[in]  id      Event ID given to \ref TRACE_BEGIN
+  * @param[in]  arg     32-bit event argument
+  * @return     None
+  */
+#if defined(TRACE_ENABLE)
+#define TRACE_END(id, arg)      TRACE_Record((id) | TRACE_ID_END, (uint32_t)(arg))
+#else
+#define TRACE_END(id, arg)
+#endif
+
+/**
+  * @brief      Record a point event
+  * @param[in]  id      Event ID, 0x01 ~ 0x7F
+  * @param[in]  arg     32-bit event argument
+  * @return     None
+  */
+#define TRACE_EVENT(id, arg)    TRACE_BEGIN(id, arg)
+
+int32_t TRACE_Open(S_TRACE_REC_T *psBuf, uint32_t u32Size, TIMER_T *timer);
+void TRACE_Close(void);
+void TRACE_Record(uint32_t u32Id, uint32_t u32Arg);
+uint32_t TRACE_Read(uint8_t *pu8Buf, uint32_t u32Len);
+void TRACE_Flush(UART_T *uart);
+int32_t TRACE_SemihostFlush(const char *pcFile);
+uint32_t TRACE_GetDropCount(void);
+
+/*@}*/ /* end of group TRACE_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group TRACE_Driver */
+
+/*@}*/ /* end of group Standard_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__TRACE_H__
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
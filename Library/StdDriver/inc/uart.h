@@ -111,10 +111,50 @@ extern "C"
 #define UART_BAUD_MODE2     (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk) /*!< Set UART Baudrate Mode is Mode2 */
 
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* UART asynchronous transfer event constants definitions                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+#define UART_ASYNC_EVENT_RX         (0x1UL) /*!< Received bytes were queued in the RX ring  */
+#define UART_ASYNC_EVENT_RX_OVERRUN (0x2UL) /*!< RX ring or RX FIFO was full and bytes were dropped  */
+#define UART_ASYNC_EVENT_TX_DONE    (0x4UL) /*!< TX ring drained, the last byte has been written to the TX FIFO  */
+
+#define UART_ASYNC_NUM              3       /*!< Number of UART modules supporting asynchronous transfer */
+
+#define UART_DMA_MAX_LEN            16384   /*!< Maximum byte count of one UART PDMA transfer */
+
+
 
 /*@}*/ /* end of group UART_EXPORTED_CONSTANTS */
 
 
+/** @addtogroup UART_EXPORTED_STRUCTS UART Exported Structs
+  @{
+*/
+
+typedef void (*UART_ASYNC_CB)(UART_T *uart, uint32_t u32Event);   /*!< Functional pointer type declaration for UART asynchronous event callback */
+
+/**
+  * @details    UART asynchronous transfer control block. TX and RX are single-producer single-consumer
+  *             rings indexed by free running counters, so thread code and the UART interrupt never
+  *             need to lock each other out.
+  */
+typedef struct
+{
+    uint8_t *pu8TxBuf;              /*!< TX ring buffer */
+    uint32_t u32TxMask;             /*!< TX ring size - 1, size is power of 2 */
+    volatile uint32_t u32TxHead;    /*!< TX write counter, updated by UART_WriteAsync */
+    volatile uint32_t u32TxTail;    /*!< TX read counter, updated by interrupt handler */
+    uint8_t *pu8RxBuf;              /*!< RX ring buffer */
+    uint32_t u32RxMask;             /*!< RX ring size - 1, size is power of 2 */
+    volatile uint32_t u32RxHead;    /*!< RX write counter, updated by interrupt handler */
+    volatile uint32_t u32RxTail;    /*!< RX read counter, updated by UART_ReadAsync */
+    volatile uint32_t u32RxDrop;    /*!< Number of received bytes dropped because the RX ring was full */
+    UART_ASYNC_CB pfnCallback;      /*!< Event callback, called in interrupt context. Can be NULL */
+} S_UART_ASYNC_T;
+
+/*@}*/ /* end of group UART_EXPORTED_STRUCTS */
+
+
 /** @addtogroup UART_EXPORTED_FUNCTIONS UART Exported Functions
   @{
 */
@@ -446,6 +486,17 @@ void UART_SelectIrDAMode(UART_T* uart, uint32_t u32Buadrate, uint32_t u32Directi
 void UART_SelectRS485Mode(UART_T* uart, uint32_t u32Mode, uint32_t u32Addr);
 void UART_SelectLINMode(UART_T* uart, uint32_t u32Mode, uint32_t u32BreakLength);
 uint32_t UART_Write(UART_T* uart, uint8_t *pu8TxBuf, uint32_t u32WriteBytes);
+int32_t UART_OpenAsync(UART_T* uart, S_UART_ASYNC_T *psAsync, uint8_t *pu8TxBuf, uint32_t u32TxSize, uint8_t *pu8RxBuf, uint32_t u32RxSize, UART_ASYNC_CB pfnCallback);
+void UART_CloseAsync(UART_T* uart);
+uint32_t UART_WriteAsync(UART_T* uart, const uint8_t *pu8TxBuf, uint32_t u32WriteBytes);
+uint32_t UART_ReadAsync(UART_T* uart, uint8_t *pu8RxBuf, uint32_t u32ReadBytes);
+uint32_t UART_GetAsyncRxCount(UART_T* uart);
+uint32_t UART_GetAsyncTxCount(UART_T* uart);
+void UART_AsyncIRQHandler(UART_T* uart);
+int32_t UART_TransmitDMA(UART_T* uart, uint32_t u32Ch, const uint8_t *pu8TxBuf, uint32_t u32WriteBytes);
+int32_t UART_ReceiveDMA(UART_T* uart, uint32_t u32Ch, uint8_t *pu8RxBuf, uint32_t u32ReadBytes, uint32_t u32IdleBits);
+uint32_t UART_GetReceiveDMACount(UART_T* uart);
+uint32_t UART_StopReceiveDMA(UART_T* uart);
 
 
 /*@}*/ /* end of group UART_EXPORTED_FUNCTIONS */
@@ -29,12 +29,46 @@ typedef struct s_usbd_info
     const uint8_t **gu8StringDesc;        /*!< Pointer for USB String Descriptor pointers */
     const uint8_t **gu8HidReportDesc;     /*!< Pointer for USB HID Report Descriptor      */
     const uint32_t *gu32HidReportSize;    /*!< Pointer for HID Report descriptor Size */
-    const uint32_t *gu32ConfigHidDescIdx; /*!< Pointer for HID Descriptor start index */
-    const uint8_t *gu8BosDesc;
+    const uint32_t *gu32ConfigHidDescIdx; /*!< Pointer for HID Descriptor start index, not used: USBD_Open() finds HID descriptors in gu8ConfigDesc */
+    const uint8_t *gu8BosDesc;            /*!< Pointer for USB BOS Descriptor, can be NULL */
 } S_USBD_INFO_T;
 
 extern const S_USBD_INFO_T gsInfo;
 
+struct s_usbd_func;
+
+typedef void (*USBD_FUNC_CB)(struct s_usbd_func *psFunc);                                   /*!< Class function callback */
+typedef void (*USBD_FUNC_IF_CB)(struct s_usbd_func *psFunc, uint32_t u32If, uint32_t u32Alt); /*!< SET_INTERFACE callback of a class function */
+typedef void (*USBD_EP_CB)(struct s_usbd_func *psFunc, uint32_t u32HwEp);                   /*!< Endpoint event callback of a class function */
+
+/**
+  * @brief  Endpoint of a class function, see USBD_RegisterFunction()
+  */
+typedef struct s_usbd_func_ep
+{
+    uint32_t u32Addr;               /*!< Endpoint address in the configuration descriptor, EP_INPUT set for IN */
+    USBD_EP_CB pfnEvent;            /*!< Called from the endpoint event dispatch after a transaction, can be NULL */
+    uint32_t u32HwEp;               /*!< Hardware endpoint EP2 ~ EP7, assigned by USBD_RegisterFunction() */
+    uint32_t u32MaxPkt;             /*!< Largest wMaxPacketSize of the address in all alternate settings, filled in by USBD_RegisterFunction() */
+    uint32_t u32BufSeg;             /*!< Buffer offset in the USB SRAM, assigned by USBD_RegisterFunction() */
+} S_USBD_FUNC_EP_T;
+
+/**
+  * @brief  Class function of a (composite) device, see USBD_RegisterFunction()
+  */
+typedef struct s_usbd_func
+{
+    uint8_t u8IfFirst;              /*!< First interface number of the function */
+    uint8_t u8IfCount;              /*!< Number of consecutive interfaces of the function */
+    uint8_t u8EpCount;              /*!< Number of entries in psEp */
+    S_USBD_FUNC_EP_T *psEp;         /*!< Endpoint table */
+    USBD_FUNC_CB pfnClassReq;       /*!< Class request to one of the interfaces or endpoints, can be NULL */
+    USBD_FUNC_IF_CB pfnSetInterface;/*!< SET_INTERFACE to one of the interfaces, can be NULL */
+    USBD_FUNC_CB pfnSetConfig;      /*!< SET_CONFIGURATION with a non-zero value, after the endpoints are reset, can be NULL */
+    void *pvUser;                   /*!< Free for the class driver */
+    struct s_usbd_func *psNext;     /*!< Used by the driver */
+} S_USBD_FUNC_T;
+
 /*@}*/ /* end of group USBD_EXPORTED_STRUCTS */
 
 
@@ -44,8 +78,11 @@ extern const S_USBD_INFO_T gsInfo;
   @{
 */
 #define USBD_BUF_BASE   (USBD_BASE+0x100)
+#define USBD_BUF_SIZE   512     /*!< Size of the endpoint buffer SRAM in bytes */
 #define USBD_MAX_EP     8
 
+#define USBD_SETUP_BUF_LEN  8   /*!< SETUP packet buffer at offset 0 of the endpoint buffer SRAM */
+
 #define EP0     0       /*!< Endpoint 0 */
 #define EP1     1       /*!< Endpoint 1 */
 #define EP2     2       /*!< Endpoint 2 */
@@ -516,6 +553,20 @@ extern const S_USBD_INFO_T gsInfo;
   */
 #define USBD_GET_EP_STALL(ep)        (*((__IO uint32_t *) ((uint32_t)&USBD->EP[0].CFGP + (uint32_t)((ep) << 4))) & USBD_CFGP_SSTALL_Msk)
 
+/**
+  * @brief      Get the address of the specified USB endpoint buffer
+  *
+  * @param[in]  ep The USB endpoint ID. Supports 8 hardware endpoint ID. This parameter could be 0 ~ 7.
+  *
+  * @return     Pointer to the endpoint buffer in USB SRAM.
+  *
+  * @details    Class code can build an IN packet in place at this address and then arm the endpoint
+  *             with USBD_SET_PAYLOAD_LEN, or parse a received OUT packet where it landed, without
+  *             going through an intermediate buffer in system SRAM.
+  *
+  */
+#define USBD_GET_EP_BUF_PTR(ep)         ((uint8_t *)((uint32_t)USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(ep)))
+
 /**
   * @brief      To support byte access between USB SRAM and system SRAM
   *
@@ -528,11 +579,93 @@ extern const S_USBD_INFO_T gsInfo;
   * @return     None
   *
   * @details    This function will copy the number of data specified by size and src parameters to the address specified by dest parameter.
+  *             When both pointers are word aligned, the data is moved with 32-bit accesses, 64 bytes (one
+  *             full speed bulk packet) per loop iteration, and only the remaining tail is copied by byte.
   *
   */
 static __INLINE void USBD_MemCopy(uint8_t *dest, uint8_t *src, int32_t size)
 {
-    while(size--) *dest++ = *src++;
+    uint32_t *pu32Dest, *pu32Src;
+
+    if(((((uint32_t)dest) | ((uint32_t)src)) & 0x3) == 0)
+    {
+        pu32Dest = (uint32_t *)dest;
+        pu32Src = (uint32_t *)src;
+
+        while(size >= 64)
+        {
+            pu32Dest[0] = pu32Src[0];
+            pu32Dest[1] = pu32Src[1];
+            pu32Dest[2] = pu32Src[2];
+            pu32Dest[3] = pu32Src[3];
+            pu32Dest[4] = pu32Src[4];
+            pu32Dest[5] = pu32Src[5];
+            pu32Dest[6] = pu32Src[6];
+            pu32Dest[7] = pu32Src[7];
+            pu32Dest[8] = pu32Src[8];
+            pu32Dest[9] = pu32Src[9];
+            pu32Dest[10] = pu32Src[10];
+            pu32Dest[11] = pu32Src[11];
+            pu32Dest[12] = pu32Src[12];
+            pu32Dest[13] = pu32Src[13];
+            pu32Dest[14] = pu32Src[14];
+            pu32Dest[15] = pu32Src[15];
+            pu32Dest += 16;
+            pu32Src += 16;
+            size -= 64;
+        }
+
+        while(size >= 4)
+        {
+            *pu32Dest++ = *pu32Src++;
+            size -= 4;
+        }
+
+        dest = (uint8_t *)pu32Dest;
+        src = (uint8_t *)pu32Src;
+    }
+
+    while(size-- > 0) *dest++ = *src++;
+}
+
+/**
+  * @brief      Copy an IN packet to the specified endpoint buffer and arm the endpoint
+  *
+  * @param[in]  ep   The USB endpoint ID. Supports 8 hardware endpoint ID. This parameter could be 0 ~ 7.
+  *
+  * @param[in]  src  Source pointer.
+  *
+  * @param[in]  size Packet length in bytes.
+  *
+  * @return     None
+  *
+  * @details    Equivalent to USBD_MemCopy to USBD_GET_EP_BUF_PTR(ep) followed by USBD_SET_PAYLOAD_LEN(ep, size).
+  *
+  */
+static __INLINE void USBD_WriteEP(uint32_t ep, uint8_t *src, uint32_t size)
+{
+    USBD_MemCopy(USBD_GET_EP_BUF_PTR(ep), src, (int32_t)size);
+    USBD_SET_PAYLOAD_LEN(ep, size);
+}
+
+/**
+  * @brief      Copy the received OUT packet out of the specified endpoint buffer
+  *
+  * @param[in]  ep   The USB endpoint ID. Supports 8 hardware endpoint ID. This parameter could be 0 ~ 7.
+  *
+  * @param[out] dest Destination pointer, must have room for the endpoint maximum packet size.
+  *
+  * @return     Received packet length in bytes.
+  *
+  * @details    The endpoint is not re-armed, call USBD_SET_PAYLOAD_LEN when ready for the next packet.
+  *
+  */
+static __INLINE uint32_t USBD_ReadEP(uint32_t ep, uint8_t *dest)
+{
+    uint32_t u32Size = USBD_GET_PAYLOAD_LEN(ep);
+
+    USBD_MemCopy(dest, USBD_GET_EP_BUF_PTR(ep), (int32_t)u32Size);
+    return u32Size;
 }
 
 
@@ -639,6 +772,8 @@ typedef void (*VENDOR_REQ)(void);           /*!< Functional pointer type definit
 typedef void (*CLASS_REQ)(void);            /*!< Functional pointer type declaration for USB class request callback handler */
 typedef void (*SET_INTERFACE_REQ)(void);    /*!< Functional pointer type declaration for USB set interface request callback handler */
 typedef void (*SET_CONFIG_CB)(void);       /*!< Functional pointer type declaration for USB set configuration request callback handler */
+typedef void (*USBD_EP_HANDLER)(uint32_t u32HwEp);  /*!< Hardware endpoint event handler of USBD_EventIRQHandler */
+typedef void (*USBD_BUS_HANDLER)(uint32_t u32State);/*!< Bus event handler of USBD_EventIRQHandler, gets USBD_GET_BUS_STATE() */
 
 
 /*--------------------------------------------------------------------*/
@@ -655,6 +790,11 @@ void USBD_SwReset(void);
 void USBD_SetVendorRequest(VENDOR_REQ pfnVendorReq);
 void USBD_SetConfigCallback(SET_CONFIG_CB pfnSetConfigCallback);
 void USBD_LockEpStall(uint32_t u32EpBitmap);
+int32_t USBD_RegisterFunction(S_USBD_FUNC_T *psFunc);
+void USBD_DispatchEpEvents(uint32_t u32IntSts);
+void USBD_SetEpHandler(uint32_t u32HwEp, USBD_EP_HANDLER pfnHandler);
+void USBD_SetBusHandler(USBD_BUS_HANDLER pfnHandler);
+void USBD_EventIRQHandler(void);
 
 /*@}*/ /* end of group USBD_EXPORTED_FUNCTIONS */
 
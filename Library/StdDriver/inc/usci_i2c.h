@@ -99,9 +99,84 @@ enum UI2C_SLAVE_EVENT
 #define UI2C_OK                    ( 0L)            /*!< UI2C operation OK */
 #define UI2C_ERR_FAIL              (-1L)            /*!< UI2C operation failed */
 #define UI2C_ERR_TIMEOUT           (-2L)            /*!< UI2C operation abort due to timeout error */
+#define UI2C_SLAVE_NUM             3                /*!< Number of USCI modules supporting the slave register map */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* USCI_I2C Asynchronous Transfer Constant Definitions                                                     */
+/*---------------------------------------------------------------------------------------------------------*/
+#define UI2C_XFER_WRITE            0                /*!< Send SLA+W, register address bytes, then data */
+#define UI2C_XFER_READ             1                /*!< Send SLA+W and register address bytes if any, repeated START, SLA+R, read data */
+#define UI2C_XFER_PENDING          (1L)             /*!< Transfer is queued or in progress */
+#define UI2C_ASYNC_NUM             3                /*!< Number of USCI modules supporting asynchronous transfer */
 
 /*@}*/ /* end of group USCI_I2C_EXPORTED_CONSTANTS */
 
+/** @addtogroup USCI_I2C_EXPORTED_STRUCTS USCI_I2C Exported Structs
+  @{
+*/
+
+struct S_UI2C_SLAVE;
+typedef void (*UI2C_SLAVE_READ_CB)(struct S_UI2C_SLAVE *psSlave, uint8_t u8Addr, uint32_t u32Reg);   /*!< Functional pointer type declaration for USCI_I2C slave read start callback */
+typedef void (*UI2C_SLAVE_WRITE_CB)(struct S_UI2C_SLAVE *psSlave, uint8_t u8Addr, uint32_t u32Reg, uint32_t u32Len);   /*!< Functional pointer type declaration for USCI_I2C slave write done callback */
+
+/**
+  * @details    USCI_I2C slave register map. Owned by the caller and must stay valid until UI2C_CloseSlave is called.
+  *             Same protocol as the I2C slave register map: after SLA+W the master sends the register pointer, most
+  *             significant byte first, then data written to the registers. After SLA+R the master reads registers
+  *             from the pointer. The pointer increments after every data byte and wraps at the end of the map.
+  */
+typedef struct S_UI2C_SLAVE
+{
+    uint8_t *pu8Regs;               /*!< Register file */
+    uint32_t u32Size;               /*!< Register file size in bytes */
+    uint32_t u32PtrLen;             /*!< Register pointer bytes following SLA+W, 1 or 2 */
+    UI2C_SLAVE_READ_CB pfnRead;     /*!< Called on SLA+R before the first register is sent, can update the registers. Can be NULL */
+    UI2C_SLAVE_WRITE_CB pfnWrite;   /*!< Called once per write with the registers written, on STOP, repeated START or NACK. Can be NULL */
+    void *pvArg;                    /*!< User data for the callbacks */
+    volatile uint32_t u32Ptr;       /*!< Register pointer */
+    uint32_t u32PtrIdx;             /*!< Register pointer bytes received, used by the driver */
+    uint32_t u32WrReg;              /*!< First register written in the current transfer, used by the driver */
+    uint32_t u32WrLen;              /*!< Registers written in the current transfer, used by the driver */
+    uint32_t u32Event;              /*!< \ref UI2C_SLAVE_EVENT step of the current transfer, used by the driver */
+    uint8_t u8Addr;                 /*!< 7-bit address the current transfer was sent to */
+} S_UI2C_SLAVE_T;
+
+struct S_UI2C_XFER;
+typedef void (*UI2C_XFER_CB)(struct S_UI2C_XFER *psXfer);   /*!< Functional pointer type declaration for USCI_I2C transfer completion callback */
+
+/**
+  * @details    USCI_I2C transfer descriptor, same fields as the I2C one. Owned by the caller and must stay valid until
+  *             the transfer is done.
+  */
+typedef struct S_UI2C_XFER
+{
+    struct S_UI2C_XFER *psNext;     /*!< Next queued transfer, used by the driver */
+    uint8_t u8SlaveAddr;            /*!< 7-bit slave address */
+    uint8_t u8Dir;                  /*!< \ref UI2C_XFER_WRITE or \ref UI2C_XFER_READ */
+    uint8_t u8RegLen;               /*!< Register address bytes sent before the data, 0 ~ 4 */
+    uint8_t u8RegIdx;               /*!< Register address bytes sent, used by the driver */
+    uint32_t u32RegAddr;            /*!< Register address, sent MSB first */
+    uint8_t *pu8Buf;                /*!< Data buffer */
+    uint32_t u32Len;                /*!< Data bytes, at least 1 for a read */
+    volatile uint32_t u32Count;     /*!< Data bytes transferred */
+    volatile int32_t i32Status;     /*!< \ref UI2C_XFER_PENDING while queued, \ref UI2C_OK when done, \ref UI2C_ERR_FAIL on NACK, arbitration lost or bus error, \ref UI2C_ERR_TIMEOUT on bus time-out */
+    UI2C_XFER_CB pfnCallback;       /*!< Completion callback, called in interrupt context. Can be NULL */
+    void *pvArg;                    /*!< User data for the callback */
+} S_UI2C_XFER_T;
+
+/**
+  * @details    USCI_I2C asynchronous transfer control block. Queued transfers run back to back from the USCI interrupt,
+  *             a STOP followed by a START separating them.
+  */
+typedef struct
+{
+    S_UI2C_XFER_T *psHead;          /*!< Transfer on the bus */
+    S_UI2C_XFER_T *psTail;          /*!< Last queued transfer */
+    uint32_t u32Event;              /*!< \ref UI2C_MASTER_EVENT step of the transfer on the bus, MASTER_STOP while the STOP is on the bus, used by the driver */
+} S_UI2C_ASYNC_T;
+
+/*@}*/ /* end of group USCI_I2C_EXPORTED_STRUCTS */
+
 extern int32_t g_UI2C_i32ErrCode;
 
 /** @addtogroup USCI_I2C_EXPORTED_FUNCTIONS USCI_I2C Exported Functions
@@ -315,6 +390,14 @@ uint8_t UI2C_ReadByteOneReg(UI2C_T *ui2c, uint8_t u8SlaveAddr, uint8_t u8DataAdd
 uint32_t UI2C_ReadMultiBytesOneReg(UI2C_T *ui2c, uint8_t u8SlaveAddr, uint8_t u8DataAddr, uint8_t *rdata, uint32_t u32rLen);
 uint8_t UI2C_ReadByteTwoRegs(UI2C_T *ui2c, uint8_t u8SlaveAddr, uint16_t u16DataAddr);
 uint32_t UI2C_ReadMultiBytesTwoRegs(UI2C_T *ui2c, uint8_t u8SlaveAddr, uint16_t u16DataAddr, uint8_t *rdata, uint32_t u32rLen);
+int32_t UI2C_OpenSlave(UI2C_T *ui2c, S_UI2C_SLAVE_T *psSlave);
+void UI2C_CloseSlave(UI2C_T *ui2c);
+void UI2C_SlaveIRQHandler(UI2C_T *ui2c);
+void UI2C_OpenAsync(UI2C_T *ui2c, S_UI2C_ASYNC_T *psAsync);
+void UI2C_CloseAsync(UI2C_T *ui2c);
+int32_t UI2C_SubmitAsync(UI2C_T *ui2c, S_UI2C_XFER_T *psXfer);
+uint32_t UI2C_IsAsyncBusy(UI2C_T *ui2c);
+void UI2C_AsyncIRQHandler(UI2C_T *ui2c);
 /*@}*/ /* end of group USCI_I2C_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group USCI_I2C_Driver */
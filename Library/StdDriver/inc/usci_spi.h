@@ -62,9 +62,60 @@ extern "C"
 #define USPI_TX_FULL_MASK            (0x10)                          /*!< TX full status mask */
 #define USPI_SSLINE_STS_MASK         (0x20)                          /*!< USCI_SPI_SS line status mask */
 
+/* USCI_SPI asynchronous transfer */
+#define USPI_XFER_KEEP_SS            (0x1UL)                         /*!< Leave slave select active after the transfer, for a command followed by data */
+#define USPI_XFER_NO_SS              (0x2UL)                         /*!< Do not drive slave select, the caller selects the device */
+#define USPI_XFER_DMA                (0x4UL)                         /*!< Data moved by PDMA, set by \ref USPI_TransferDMA */
+#define USPI_XFER_PENDING            (1L)                            /*!< Transfer is queued or in progress */
+#define USPI_ASYNC_NUM               3                               /*!< Number of USCI modules supporting asynchronous transfer */
+#define USPI_DMA_MAX_LEN             16384                           /*!< Maximum data units of one PDMA block (14-bit TXCNT), longer transfers are split */
+
 /*@}*/ /* end of group USCI_SPI_EXPORTED_CONSTANTS */
 
 
+/** @addtogroup USCI_SPI_EXPORTED_STRUCTS USCI_SPI Exported Structs
+  @{
+*/
+
+struct S_USPI_XFER;
+typedef void (*USPI_XFER_CB)(struct S_USPI_XFER *psXfer);   /*!< Functional pointer type declaration for USCI_SPI transfer completion callback */
+
+/**
+  * @details    USCI_SPI full-duplex transfer descriptor. Owned by the caller and must stay valid until the transfer is done.
+  *             Buffers hold one uint8_t per data unit up to 8-bit data width, one uint16_t above.
+  */
+typedef struct S_USPI_XFER
+{
+    struct S_USPI_XFER *psNext;     /*!< Next queued transfer, used by the driver */
+    const void *pvTxBuf;            /*!< Data to send, NULL sends all ones */
+    void *pvRxBuf;                  /*!< Received data, NULL discards it */
+    uint32_t u32Len;                /*!< Number of data units */
+    uint32_t u32Flags;              /*!< \ref USPI_XFER_KEEP_SS, \ref USPI_XFER_NO_SS */
+    volatile uint32_t u32TxCount;   /*!< Data units written to TXDAT or handed to PDMA, used by the driver */
+    volatile uint32_t u32RxCount;   /*!< Data units received */
+    volatile int32_t i32Status;     /*!< \ref USPI_XFER_PENDING while queued, 0 when done */
+    USPI_XFER_CB pfnCallback;       /*!< Completion callback, called in interrupt context. Can be NULL */
+    void *pvArg;                    /*!< User data for the callback */
+} S_USPI_XFER_T;
+
+/**
+  * @details    USCI_SPI asynchronous transfer control block. Queued transfers run back to back, each one by PDMA or
+  *             by the USCI receive end interrupt.
+  */
+typedef struct
+{
+    S_USPI_XFER_T *psHead;          /*!< Transfer on the bus */
+    S_USPI_XFER_T *psTail;          /*!< Last queued transfer */
+    int32_t i32TxCh;                /*!< PDMA TX channel, -1 without PDMA */
+    int32_t i32RxCh;                /*!< PDMA RX channel, -1 without PDMA */
+    uint32_t u32Unit;               /*!< Buffer bytes per data unit of the transfer on the bus */
+    uint32_t u32TxFill;             /*!< PDMA source when there is no TX buffer */
+    uint32_t u32RxSink;             /*!< PDMA destination when there is no RX buffer */
+} S_USPI_ASYNC_T;
+
+/*@}*/ /* end of group USCI_SPI_EXPORTED_STRUCTS */
+
+
 /** @addtogroup USCI_SPI_EXPORTED_FUNCTIONS USCI_SPI Exported Functions
   @{
 */
@@ -407,6 +458,12 @@ void USPI_ClearIntFlag(USPI_T *uspi, uint32_t u32Mask);
 uint32_t USPI_GetStatus(USPI_T *uspi, uint32_t u32Mask);
 void USPI_EnableWakeup(USPI_T *uspi);
 void USPI_DisableWakeup(USPI_T *uspi);
+int32_t USPI_OpenAsync(USPI_T *uspi, S_USPI_ASYNC_T *psAsync, uint32_t u32ActiveLevel, uint32_t u32UseDMA);
+void USPI_CloseAsync(USPI_T *uspi);
+int32_t USPI_TransferIRQ(USPI_T *uspi, S_USPI_XFER_T *psXfer);
+int32_t USPI_TransferDMA(USPI_T *uspi, S_USPI_XFER_T *psXfer);
+uint32_t USPI_IsAsyncBusy(USPI_T *uspi);
+void USPI_AsyncIRQHandler(USPI_T *uspi);
 
 
 /*@}*/ /* end of group USCI_SPI_EXPORTED_FUNCTIONS */
@@ -164,6 +164,143 @@ void ADC_DisableInt(ADC_T *adc, uint32_t u32Mask)
 }
 
 
+static ADC_STREAM_CB s_pfnAdcStreamCb;
+static DSCT_T *s_apsAdcStreamDesc[2];
+static uint16_t *s_pu16AdcStreamBuf;
+static uint32_t s_u32AdcStreamHalf;
+static uint32_t s_u32AdcStreamNext;         /* Half the PDMA finishes next */
+static int32_t s_i32AdcStreamCh = -1;
+
+#define ADC_STREAM_DSCT_CFG     (PDMA_WIDTH_16 | PDMA_SAR_FIX | PDMA_DAR_INC | PDMA_REQ_SINGLE | PDMA_BURST_1 | PDMA_TBINTDIS_ENABLE)
+
+static void ADC_StreamArm(uint32_t u32Half)
+{
+    PDMA_DescSet(s_apsAdcStreamDesc[u32Half], ADC_STREAM_DSCT_CFG, s_u32AdcStreamHalf, (uint32_t)&ADC->ADPDMA,
+                 (uint32_t)(s_pu16AdcStreamBuf + u32Half * s_u32AdcStreamHalf), s_apsAdcStreamDesc[u32Half ^ 1]);
+}
+
+static void ADC_StreamEvent(uint32_t u32Ch, uint32_t u32Event)
+{
+    uint32_t u32Half = s_u32AdcStreamNext;
+
+    if(u32Event & PDMA_EVENT_EMPTY)
+    {
+        /* Both halves completed before the first one was handed back, the PDMA stopped on a
+           descriptor already written back in stop mode. Restart the ring from the first half. */
+        ADC_StreamArm(0);
+        ADC_StreamArm(1);
+        s_u32AdcStreamNext = 0;
+        PDMA_SetTransferMode(u32Ch, PDMA_ADC_RX, TRUE, (uint32_t)s_apsAdcStreamDesc[0]);
+        if(s_pfnAdcStreamCb != NULL)
+            s_pfnAdcStreamCb(ADC_STREAM_EVENT_OVERRUN, NULL, 0);
+        return;
+    }
+
+    if(u32Event & PDMA_EVENT_DONE)
+    {
+        /* Re-arm the finished half first, the PDMA is filling the other one meanwhile */
+        ADC_StreamArm(u32Half);
+        s_u32AdcStreamNext = u32Half ^ 1;
+        if(s_pfnAdcStreamCb != NULL)
+            s_pfnAdcStreamCb(u32Half ? ADC_STREAM_EVENT_FULL : ADC_STREAM_EVENT_HALF,
+                             s_pu16AdcStreamBuf + u32Half * s_u32AdcStreamHalf, s_u32AdcStreamHalf);
+    }
+}
+
+/**
+  * @brief Start continuous ADC sampling into a ping-pong buffer by PDMA
+  * @param[in] adc The pointer of the specified ADC module
+  * @param[in] u32ChMask Channel enable bit. Each bit corresponds to a input channel. All enabled channels
+  *                      are converted in ascending order on each trigger.
+  * @param[in] u32Source Decides the conversion start. Valid values are:
+  *                       - \ref ADC_ADCR_TRGS_STADC            :One scan per external STADC pin event.
+  *                       - \ref ADC_ADCR_TRGS_TIMER            :One scan per Timer trigger.
+  *                       - \ref ADC_ADCR_TRGS_PWM              :One scan per PWM trigger.
+  *                       - \ref ADC_STREAM_CONTINUOUS          :Free running continuous scan.
+  * @param[in] u32Param Trigger condition or PWM trigger delay, see \ref ADC_EnableHWTrigger. Not used
+  *                     with Timer and continuous scan.
+  * @param[in] pu16Buf Sample buffer. Results are stored in scan order, one 16-bit word per conversion.
+  * @param[in] u32Count Number of samples of pu16Buf, even and up to \ref ADC_STREAM_MAX_LEN. Use a multiple
+  *                     of twice the number of enabled channels to keep each half aligned to whole scans.
+  * @param[in] pfnCallback Called in PDMA interrupt context each time a half of pu16Buf is filled. The half
+  *                        must be consumed before the other half is filled. Can be NULL.
+  * @retval 0 Stream started
+  * @retval -1 Invalid parameter, a stream is already running, or no PDMA channel or descriptor is free
+  * @details Two scatter-gather descriptors, one per buffer half, are linked in a ring so the PDMA never
+  *          stops between halves. The ADC runs in single-cycle scan mode started by the hardware trigger,
+  *          or in continuous scan mode with \ref ADC_STREAM_CONTINUOUS. Trigger timing is left to the
+  *          caller, e.g. \ref TIMER_SetTriggerTarget with \ref TIMER_TRG_TO_ADC.
+  *          The application PDMA_IRQHandler must call \ref PDMA_ChannelIRQHandler.
+  */
+int32_t ADC_StartStream(ADC_T *adc, uint32_t u32ChMask, uint32_t u32Source, uint32_t u32Param, uint16_t *pu16Buf, uint32_t u32Count, ADC_STREAM_CB pfnCallback)
+{
+    int32_t i32Ch;
+
+    if((s_i32AdcStreamCh >= 0) || (pu16Buf == NULL) || (u32ChMask == 0) ||
+            (u32Count < 2) || (u32Count & 1) || (u32Count > ADC_STREAM_MAX_LEN))
+        return -1;
+
+    i32Ch = PDMA_RequestChannel(PDMA_CH_ANY, ADC_StreamEvent);
+    if(i32Ch < 0)
+        return -1;
+    s_apsAdcStreamDesc[0] = PDMA_DescAlloc();
+    s_apsAdcStreamDesc[1] = PDMA_DescAlloc();
+    if((s_apsAdcStreamDesc[0] == NULL) || (s_apsAdcStreamDesc[1] == NULL))
+    {
+        if(s_apsAdcStreamDesc[0] != NULL)
+            PDMA_DescFree(s_apsAdcStreamDesc[0]);
+        if(s_apsAdcStreamDesc[1] != NULL)
+            PDMA_DescFree(s_apsAdcStreamDesc[1]);
+        PDMA_ReleaseChannel((uint32_t)i32Ch);
+        return -1;
+    }
+
+    s_i32AdcStreamCh = i32Ch;
+    s_pfnAdcStreamCb = pfnCallback;
+    s_pu16AdcStreamBuf = pu16Buf;
+    s_u32AdcStreamHalf = u32Count / 2;
+    s_u32AdcStreamNext = 0;
+    ADC_StreamArm(0);
+    ADC_StreamArm(1);
+    PDMA_SetTransferMode((uint32_t)i32Ch, PDMA_ADC_RX, TRUE, (uint32_t)s_apsAdcStreamDesc[0]);
+
+    ADC_STOP_CONV(adc);
+    ADC_DisableHWTrigger(adc);
+    ADC_Open(adc, (adc)->ADCR & ADC_ADCR_DIFFEN_Msk,
+             (u32Source == ADC_STREAM_CONTINUOUS) ? ADC_ADCR_ADMD_CONTINUOUS : ADC_ADCR_ADMD_SINGLE_CYCLE, u32ChMask);
+    ADC_CLR_INT_FLAG(adc, ADC_ADF_INT);
+    ADC_POWER_ON(adc);
+    ADC_ENABLE_PDMA(adc);
+    if(u32Source == ADC_STREAM_CONTINUOUS)
+        ADC_START_CONV(adc);
+    else
+        ADC_EnableHWTrigger(adc, u32Source, u32Param);
+
+    return 0;
+}
+
+/**
+  * @brief Stop the ADC stream started by \ref ADC_StartStream
+  * @param[in] adc The pointer of the specified ADC module
+  * @return None
+  * @details Samples of a partly filled half are discarded. The PDMA channel and descriptors are released.
+  */
+void ADC_StopStream(ADC_T *adc)
+{
+    if(s_i32AdcStreamCh < 0)
+        return;
+
+    ADC_DisableHWTrigger(adc);
+    ADC_STOP_CONV(adc);
+    ADC_DISABLE_PDMA(adc);
+    PDMA_ReleaseChannel((uint32_t)s_i32AdcStreamCh);
+    PDMA_DescFree(s_apsAdcStreamDesc[0]);
+    PDMA_DescFree(s_apsAdcStreamDesc[1]);
+    s_pfnAdcStreamCb = NULL;
+    s_i32AdcStreamCh = -1;
+}
+
+
 
 /*@}*/ /* end of group ADC_EXPORTED_FUNCTIONS */
 
@@ -355,6 +355,310 @@ void FMC_DisableFreqOptimizeMode(void)
 }
 
 
+/**
+ * @brief      Wait for the current ISP command to finish
+ *
+ * @param[in]  u32TimeOutCnt  Poll count before giving up
+ *
+ * @retval      0  Success
+ * @retval     -1  Command failed or time-out
+ *
+ * @details    Runs from SRAM with the callers, so the CPU keeps executing while the flash is busy.
+ */
+static FMC_RAMFUNC int32_t FMC_WaitDone(uint32_t u32TimeOutCnt)
+{
+    while(FMC->ISPTRG)
+    {
+        if(--u32TimeOutCnt == 0)
+            return -1;
+    }
+
+    if(FMC->ISPCTL & FMC_ISPCTL_ISPFF_Msk)
+    {
+        FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Program up to 256 bytes with one multi-word program command
+ *
+ * @param[in]  u32Addr  Flash address, 16 bytes aligned
+ * @param[in]  pu32Buf  Source data
+ * @param[in]  u32Words Word count, a multiple of 4 and not more than FMC_MULTI_WORD_PROG_LEN / 4
+ *
+ * @retval      0  Success
+ * @retval     -1  Program failed or time-out
+ *
+ * @details    Same data feeding as FMC_Write256(), for any length. MPDAT0~3 are refilled in pairs
+ *             while the controller programs, and the command is restarted at MPADDR if it ran
+ *             dry. Interrupts are masked while a group is fed to keep the status check coherent.
+ */
+static FMC_RAMFUNC int32_t FMC_MultiWordProgram(uint32_t u32Addr, uint32_t *pu32Buf, uint32_t u32Words)
+{
+    volatile uint32_t *pu32IspData = &FMC->MPDAT0;
+    uint32_t i, idx, u32TimeOutCnt, u32Primask;
+
+    idx = 0;
+    FMC->ISPCMD = FMC_ISPCMD_MULTI_PROG;
+    FMC->ISPADDR = u32Addr;
+    u32Primask = __get_PRIMASK();
+
+retrigger:
+    pu32IspData[0] = pu32Buf[idx + 0];
+    pu32IspData[1] = pu32Buf[idx + 1];
+    pu32IspData[2] = pu32Buf[idx + 2];
+    pu32IspData[3] = pu32Buf[idx + 3];
+    FMC->ISPTRG = 0x1;
+
+    for(i = idx + 4; i < u32Words; i += 4)
+    {
+        __set_PRIMASK(1); /* Mask interrupt to avoid status check coherence error */
+        u32TimeOutCnt = FMC_TIMEOUT_WRITE;
+        while(FMC->MPSTS & (3 << FMC_MPSTS_D0_Pos))
+        {
+            if((FMC->MPSTS & FMC_MPSTS_MPBUSY_Msk) == 0)
+                break;
+            if(--u32TimeOutCnt == 0)
+            {
+                __set_PRIMASK(u32Primask);
+                return -1;
+            }
+        }
+        if((FMC->MPSTS & FMC_MPSTS_MPBUSY_Msk) == 0)
+            break;
+
+        /* Update new data for D0 */
+        pu32IspData[0] = pu32Buf[i];
+        pu32IspData[1] = pu32Buf[i + 1];
+
+        u32TimeOutCnt = FMC_TIMEOUT_WRITE;
+        while(FMC->MPSTS & (3 << FMC_MPSTS_D2_Pos))
+        {
+            if((FMC->MPSTS & FMC_MPSTS_MPBUSY_Msk) == 0)
+                break;
+            if(--u32TimeOutCnt == 0)
+            {
+                __set_PRIMASK(u32Primask);
+                return -1;
+            }
+        }
+        if((FMC->MPSTS & FMC_MPSTS_MPBUSY_Msk) == 0)
+            break;
+
+        /* Update new data for D2 */
+        pu32IspData[2] = pu32Buf[i + 2];
+        pu32IspData[3] = pu32Buf[i + 3];
+        __set_PRIMASK(u32Primask);
+    }
+
+    if(i < u32Words)
+    {
+        /* The controller stopped before all data was fed, continue from the unfinished group */
+        __set_PRIMASK(u32Primask);
+        if(FMC->ISPCTL & FMC_ISPCTL_ISPFF_Msk)
+        {
+            FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+            return -1;
+        }
+        FMC->ISPADDR = FMC->MPADDR & (~0xful);
+        idx = (FMC->ISPADDR - u32Addr) / 4;
+        goto retrigger;
+    }
+
+    u32TimeOutCnt = FMC_TIMEOUT_WRITE;
+    while(FMC->ISPSTS & FMC_ISPSTS_ISPBUSY_Msk)
+    {
+        if(--u32TimeOutCnt == 0)
+            return -1;
+    }
+
+    if(FMC->ISPCTL & FMC_ISPCTL_ISPFF_Msk)
+    {
+        FMC->ISPCTL |= FMC_ISPCTL_ISPFF_Msk;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Erase consecutive flash pages
+ *
+ * @param[in]  u32Addr  Address of the first page, must be page aligned
+ * @param[in]  u32Count Number of pages to erase
+ *
+ * @retval      0  Success
+ * @retval     -1  Erase failed
+ *
+ * @details    Issues the page erase commands back to back from SRAM. The page size is 2048 bytes.
+ *             SPROM is not supported, use FMC_Erase() for it.
+ *
+ * @note       Global error code g_FMC_i32ErrCode
+ *             -1  Erase failed or erase time-out
+ */
+FMC_RAMFUNC int32_t FMC_ErasePages(uint32_t u32Addr, uint32_t u32Count)
+{
+    g_FMC_i32ErrCode = 0;
+
+    FMC->ISPCMD = FMC_ISPCMD_PAGE_ERASE;
+    while(u32Count--)
+    {
+        FMC->ISPADDR = u32Addr;
+        FMC->ISPTRG = 0x1;
+        if(FMC_WaitDone(FMC_TIMEOUT_ERASE) != 0)
+        {
+            g_FMC_i32ErrCode = -1;
+            return -1;
+        }
+        u32Addr += FMC_FLASH_PAGE_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Program a block of words into flash
+ *
+ * @param[in]  u32Addr  Flash address, word aligned
+ * @param[in]  pu32Buf  Source data
+ * @param[in]  u32Len   Byte count, a multiple of 4
+ *
+ * @retval      0  Success
+ * @retval     -1  Program failed
+ *
+ * @details    16-byte aligned parts go through multi-word program in bursts of up to
+ *             FMC_MULTI_WORD_PROG_LEN bytes that do not cross a 256-byte boundary. An unaligned
+ *             head and a tail shorter than 16 bytes are programmed word by word. The target area
+ *             must be erased and its update enabled.
+ *
+ * @note       Global error code g_FMC_i32ErrCode
+ *             -1  Program failed or time-out
+ */
+FMC_RAMFUNC int32_t FMC_WriteMultiple(uint32_t u32Addr, uint32_t *pu32Buf, uint32_t u32Len)
+{
+    uint32_t u32Size;
+
+    g_FMC_i32ErrCode = 0;
+
+    while(u32Len >= 4)
+    {
+        if((u32Addr & 0xF) || (u32Len < 16))
+        {
+            FMC->ISPCMD = FMC_ISPCMD_PROGRAM;
+            FMC->ISPADDR = u32Addr;
+            FMC->ISPDAT = *pu32Buf;
+            FMC->ISPTRG = 0x1;
+            if(FMC_WaitDone(FMC_TIMEOUT_WRITE) != 0)
+            {
+                g_FMC_i32ErrCode = -1;
+                return -1;
+            }
+            u32Size = 4;
+        }
+        else
+        {
+            u32Size = FMC_MULTI_WORD_PROG_LEN - (u32Addr & (FMC_MULTI_WORD_PROG_LEN - 1));
+            if(u32Size > (u32Len & ~0xFul))
+                u32Size = u32Len & ~0xFul;
+
+            if(FMC_MultiWordProgram(u32Addr, pu32Buf, u32Size / 4) != 0)
+            {
+                g_FMC_i32ErrCode = -1;
+                return -1;
+            }
+        }
+
+        u32Addr += u32Size;
+        pu32Buf += u32Size / 4;
+        u32Len -= u32Size;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Get the CRC-32 checksum of one flash page
+ *
+ * @param[in]  u32PageAddr  Page address, must be page aligned
+ * @param[out] pu32Sum      Checksum computed by the controller
+ *
+ * @retval      0  Success
+ * @retval     -1  Checksum command failed or time-out
+ *
+ * @details    FMC_GetCheckSum() for FMC_ProgramPage(), kept in SRAM with it.
+ */
+static FMC_RAMFUNC int32_t FMC_PageCheckSum(uint32_t u32PageAddr, uint32_t *pu32Sum)
+{
+    FMC->ISPCMD = FMC_ISPCMD_CAL_CHECKSUM;
+    FMC->ISPADDR = u32PageAddr;
+    FMC->ISPDAT = FMC_FLASH_PAGE_SIZE;
+    FMC->ISPTRG = 0x1;
+    if(FMC_WaitDone(FMC_TIMEOUT_CHKSUM) != 0)
+        return -1;
+
+    FMC->ISPCMD = FMC_ISPCMD_CHECKSUM;
+    FMC->ISPTRG = 0x1;
+    if(FMC_WaitDone(FMC_TIMEOUT_CHKSUM) != 0)
+        return -1;
+
+    *pu32Sum = FMC->ISPDAT;
+    return 0;
+}
+
+/**
+ * @brief      Erase, program and verify one flash page
+ *
+ * @param[in]  u32PageAddr  Page address, must be page aligned
+ * @param[in]  pu32Buf      FMC_FLASH_PAGE_SIZE bytes of data
+ *
+ * @retval      0  Success
+ * @retval     -1  Erase, program or verify failed
+ *
+ * @details    The page is checked with the FMC checksum command, which computes the CRC-32 of the
+ *             page inside the controller, against the CRC-32 of pu32Buf. This replaces reading
+ *             the page back through ISP read commands one word at a time.
+ *             All of it, the CRC table included, is in SRAM when FMC_RAMFUNC places code there.
+ *
+ * @note       Global error code g_FMC_i32ErrCode
+ *             -1  Erase, program or checksum failed, or data mismatch
+ */
+FMC_RAMFUNC int32_t FMC_ProgramPage(uint32_t u32PageAddr, uint32_t *pu32Buf)
+{
+    /* CRC-32 (reflected 0x04C11DB7) table, one entry per nibble. Not const, so it is initialized data in SRAM. */
+    static uint32_t au32Crc[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint32_t u32Crc, u32Sum, i, j;
+
+    if(FMC_ErasePages(u32PageAddr, 1) != 0)
+        return -1;
+
+    if(FMC_WriteMultiple(u32PageAddr, pu32Buf, FMC_FLASH_PAGE_SIZE) != 0)
+        return -1;
+
+    u32Crc = 0xFFFFFFFF;
+    for(i = 0; i < FMC_FLASH_PAGE_SIZE / 4; i++)
+    {
+        u32Crc ^= pu32Buf[i];
+        for(j = 0; j < 8; j++)
+            u32Crc = (u32Crc >> 4) ^ au32Crc[u32Crc & 0xF];
+    }
+
+    if((FMC_PageCheckSum(u32PageAddr, &u32Sum) != 0) || (u32Sum != ~u32Crc))
+    {
+        g_FMC_i32ErrCode = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+
 /*@}*/ /* end of group FMC_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group FMC_Driver */
@@ -0,0 +1,342 @@
+/**************************************************************************//**
+ * @file     fmem.c
+ * @version  V3.00
+ * @brief    NUC029xGE series word-oriented memory copy/fill/compare routines source file
+ *
+ * @note     Define FMEM_ENABLE_LIBC to let memcpy, memmove, memset, memcmp and the
+ *           __aeabi_mem* helpers emitted by the compiler use these routines instead of
+ *           the byte-oriented C library versions.
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include <stddef.h>
+#include "NUC029xGE.h"
+
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__ARMCC_VERSION)
+/* Keep GCC from turning the byte loops below back into calls to memcpy/memset */
+#pragma GCC optimize ("no-tree-loop-distribute-patterns")
+#endif
+
+
+/** @addtogroup Standard_Driver Standard Driver
+  @{
+*/
+
+/** @addtogroup FMEM_Driver FMEM Driver
+  @{
+*/
+
+#define FMEM_WORD_MIN       8       /* Shorter buffers are handled byte by byte, aligning costs more */
+
+/** @addtogroup FMEM_EXPORTED_FUNCTIONS FMEM Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Copy memory
+  *
+  * @param[out] pvDst       Destination buffer.
+  * @param[in]  pvSrc       Source buffer. Must not overlap pvDst.
+  * @param[in]  u32Len      Number of bytes to copy.
+  *
+  * @return     pvDst
+  *
+  * @details    The destination is aligned byte by byte first. A source with the same alignment is then
+  *             copied 16 bytes per step through four registers, which the compiler emits as LDM/STM.
+  *             Cortex-M0 has no unaligned access, so any other source is read as aligned words and
+  *             shifted into place. Only words holding at least one source byte are read.
+  */
+void *FMEM_Copy(void *pvDst, const void *pvSrc, uint32_t u32Len)
+{
+    uint8_t *pu8Dst = (uint8_t *)pvDst;
+    const uint8_t *pu8Src = (const uint8_t *)pvSrc;
+    uint32_t *pu32Dst;
+    const uint32_t *pu32Src;
+    uint32_t u32Shift, u32Prev, u32Next, u32A, u32B, u32C, u32D;
+
+    if(u32Len >= FMEM_WORD_MIN)
+    {
+        while(((uint32_t)pu8Dst & 3) != 0)
+        {
+            *pu8Dst++ = *pu8Src++;
+            u32Len--;
+        }
+        pu32Dst = (uint32_t *)pu8Dst;
+        u32Shift = ((uint32_t)pu8Src & 3) * 8;
+
+        if(u32Shift == 0)
+        {
+            pu32Src = (const uint32_t *)pu8Src;
+            for(; u32Len >= 16; u32Len -= 16)
+            {
+                u32A = pu32Src[0];
+                u32B = pu32Src[1];
+                u32C = pu32Src[2];
+                u32D = pu32Src[3];
+                pu32Src += 4;
+                pu32Dst[0] = u32A;
+                pu32Dst[1] = u32B;
+                pu32Dst[2] = u32C;
+                pu32Dst[3] = u32D;
+                pu32Dst += 4;
+            }
+            for(; u32Len >= 4; u32Len -= 4)
+                *pu32Dst++ = *pu32Src++;
+            pu8Src = (const uint8_t *)pu32Src;
+        }
+        else
+        {
+            /* Little-endian: the low bytes of the first word come first */
+            pu32Src = (const uint32_t *)(pu8Src - u32Shift / 8);
+            u32Prev = *pu32Src++;
+            for(; u32Len >= 4; u32Len -= 4)
+            {
+                u32Next = *pu32Src++;
+                *pu32Dst++ = (u32Prev >> u32Shift) | (u32Next << (32 - u32Shift));
+                u32Prev = u32Next;
+            }
+            pu8Src = (const uint8_t *)(pu32Src - 1) + u32Shift / 8;
+        }
+        pu8Dst = (uint8_t *)pu32Dst;
+    }
+
+    while(u32Len--)
+        *pu8Dst++ = *pu8Src++;
+
+    return pvDst;
+}
+
+/**
+  * @brief      Copy memory that may overlap
+  *
+  * @param[out] pvDst       Destination buffer.
+  * @param[in]  pvSrc       Source buffer.
+  * @param[in]  u32Len      Number of bytes to copy.
+  *
+  * @return     pvDst
+  *
+  * @details    Copies forward with \ref FMEM_Copy unless the destination starts inside the source.
+  *             A backward copy moves words when both buffers have the same alignment.
+  */
+void *FMEM_Move(void *pvDst, const void *pvSrc, uint32_t u32Len)
+{
+    uint8_t *pu8Dst = (uint8_t *)pvDst + u32Len;
+    const uint8_t *pu8Src = (const uint8_t *)pvSrc + u32Len;
+    uint32_t *pu32Dst;
+    const uint32_t *pu32Src;
+
+    if(((uint32_t)pvDst - (uint32_t)pvSrc) >= u32Len)
+        return FMEM_Copy(pvDst, pvSrc, u32Len);
+
+    if((u32Len >= FMEM_WORD_MIN) && ((((uint32_t)pu8Dst ^ (uint32_t)pu8Src) & 3) == 0))
+    {
+        while(((uint32_t)pu8Dst & 3) != 0)
+        {
+            *--pu8Dst = *--pu8Src;
+            u32Len--;
+        }
+        pu32Dst = (uint32_t *)pu8Dst;
+        pu32Src = (const uint32_t *)pu8Src;
+        for(; u32Len >= 4; u32Len -= 4)
+            *--pu32Dst = *--pu32Src;
+        pu8Dst = (uint8_t *)pu32Dst;
+        pu8Src = (const uint8_t *)pu32Src;
+    }
+
+    while(u32Len--)
+        *--pu8Dst = *--pu8Src;
+
+    return pvDst;
+}
+
+/**
+  * @brief      Fill memory
+  *
+  * @param[out] pvDst       Destination buffer.
+  * @param[in]  u32Val      Fill value, only the low byte is used.
+  * @param[in]  u32Len      Number of bytes to fill.
+  *
+  * @return     pvDst
+  *
+  * @details    After the destination is aligned, the byte is replicated into a word and stored 16 bytes
+  *             per step.
+  */
+void *FMEM_Set(void *pvDst, uint32_t u32Val, uint32_t u32Len)
+{
+    uint8_t *pu8Dst = (uint8_t *)pvDst;
+    uint32_t *pu32Dst;
+
+    u32Val &= 0xFF;
+    if(u32Len >= FMEM_WORD_MIN)
+    {
+        while(((uint32_t)pu8Dst & 3) != 0)
+        {
+            *pu8Dst++ = (uint8_t)u32Val;
+            u32Len--;
+        }
+        u32Val |= u32Val << 8;
+        u32Val |= u32Val << 16;
+        pu32Dst = (uint32_t *)pu8Dst;
+        for(; u32Len >= 16; u32Len -= 16)
+        {
+            pu32Dst[0] = u32Val;
+            pu32Dst[1] = u32Val;
+            pu32Dst[2] = u32Val;
+            pu32Dst[3] = u32Val;
+            pu32Dst += 4;
+        }
+        for(; u32Len >= 4; u32Len -= 4)
+            *pu32Dst++ = u32Val;
+        pu8Dst = (uint8_t *)pu32Dst;
+    }
+
+    while(u32Len--)
+        *pu8Dst++ = (uint8_t)u32Val;
+
+    return pvDst;
+}
+
+/**
+  * @brief      Compare memory
+  *
+  * @param[in]  pvBuf1      First buffer.
+  * @param[in]  pvBuf2      Second buffer.
+  * @param[in]  u32Len      Number of bytes to compare.
+  *
+  * @return     0 if the buffers are equal, otherwise the difference of the first differing bytes
+  *             taken as unsigned, first buffer minus second.
+  *
+  * @details    Buffers with the same alignment are compared a word at a time until a word differs,
+  *             then the differing word is compared byte by byte.
+  */
+int32_t FMEM_Compare(const void *pvBuf1, const void *pvBuf2, uint32_t u32Len)
+{
+    const uint8_t *pu8Buf1 = (const uint8_t *)pvBuf1;
+    const uint8_t *pu8Buf2 = (const uint8_t *)pvBuf2;
+    const uint32_t *pu32Buf1, *pu32Buf2;
+
+    if((u32Len >= FMEM_WORD_MIN) && ((((uint32_t)pu8Buf1 ^ (uint32_t)pu8Buf2) & 3) == 0))
+    {
+        while(((uint32_t)pu8Buf1 & 3) != 0)
+        {
+            if(*pu8Buf1 != *pu8Buf2)
+                return (int32_t)*pu8Buf1 - (int32_t)*pu8Buf2;
+            pu8Buf1++;
+            pu8Buf2++;
+            u32Len--;
+        }
+        pu32Buf1 = (const uint32_t *)pu8Buf1;
+        pu32Buf2 = (const uint32_t *)pu8Buf2;
+        while((u32Len >= 4) && (*pu32Buf1 == *pu32Buf2))
+        {
+            pu32Buf1++;
+            pu32Buf2++;
+            u32Len -= 4;
+        }
+        pu8Buf1 = (const uint8_t *)pu32Buf1;
+        pu8Buf2 = (const uint8_t *)pu32Buf2;
+    }
+
+    for(; u32Len; u32Len--)
+    {
+        if(*pu8Buf1 != *pu8Buf2)
+            return (int32_t)*pu8Buf1 - (int32_t)*pu8Buf2;
+        pu8Buf1++;
+        pu8Buf2++;
+    }
+
+    return 0;
+}
+
+#if defined(FMEM_ENABLE_LIBC)
+/* C library entry points. The linker takes these before the library members of the same name. */
+void *memcpy(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    return FMEM_Copy(pvDst, pvSrc, u32Len);
+}
+
+void *memmove(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    return FMEM_Move(pvDst, pvSrc, u32Len);
+}
+
+void *memset(void *pvDst, int i32Val, size_t u32Len)
+{
+    return FMEM_Set(pvDst, (uint32_t)i32Val, u32Len);
+}
+
+int memcmp(const void *pvBuf1, const void *pvBuf2, size_t u32Len)
+{
+    return FMEM_Compare(pvBuf1, pvBuf2, u32Len);
+}
+
+/* Run-time ABI helpers the ARM and IAR compilers call for memcpy/memset and structure copies */
+void __aeabi_memcpy(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    FMEM_Copy(pvDst, pvSrc, u32Len);
+}
+
+void __aeabi_memcpy4(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    FMEM_Copy(pvDst, pvSrc, u32Len);
+}
+
+void __aeabi_memcpy8(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    FMEM_Copy(pvDst, pvSrc, u32Len);
+}
+
+void __aeabi_memmove(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    FMEM_Move(pvDst, pvSrc, u32Len);
+}
+
+void __aeabi_memmove4(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    FMEM_Move(pvDst, pvSrc, u32Len);
+}
+
+void __aeabi_memmove8(void *pvDst, const void *pvSrc, size_t u32Len)
+{
+    FMEM_Move(pvDst, pvSrc, u32Len);
+}
+
+/* Note the ABI argument order: length before value */
+void __aeabi_memset(void *pvDst, size_t u32Len, int i32Val)
+{
+    FMEM_Set(pvDst, (uint32_t)i32Val, u32Len);
+}
+
+void __aeabi_memset4(void *pvDst, size_t u32Len, int i32Val)
+{
+    FMEM_Set(pvDst, (uint32_t)i32Val, u32Len);
+}
+
+void __aeabi_memset8(void *pvDst, size_t u32Len, int i32Val)
+{
+    FMEM_Set(pvDst, (uint32_t)i32Val, u32Len);
+}
+
+void __aeabi_memclr(void *pvDst, size_t u32Len)
+{
+    FMEM_Set(pvDst, 0, u32Len);
+}
+
+void __aeabi_memclr4(void *pvDst, size_t u32Len)
+{
+    FMEM_Set(pvDst, 0, u32Len);
+}
+
+void __aeabi_memclr8(void *pvDst, size_t u32Len)
+{
+    FMEM_Set(pvDst, 0, u32Len);
+}
+#endif
+
+/*@}*/ /* end of group FMEM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group FMEM_Driver */
+
+/*@}*/ /* end of group Standard_Driver */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -0,0 +1,236 @@
+/**************************************************************************//**
+ * @file     hdiv.c
+ * @version  V3.00
+ * @brief    NUC029xGE series Hardware Divider(HDIV) driver source file
+ *
+ * @note     Define HDIV_ENABLE_AEABI in the project to route the compiler division helpers
+ *           (__aeabi_idiv, __aeabi_uidiv, __aeabi_idivmod, __aeabi_uidivmod) to the hardware divider.
+ *           Division by zero calls __aeabi_idiv0 as the run-time ABI requires. The 64-bit helpers
+ *           and their __aeabi_ldiv0 stay in the compiler library.
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC029xGE.h"
+
+
+/** @addtogroup Standard_Driver Standard Driver
+  @{
+*/
+
+/** @addtogroup HDIV_Driver HDIV Driver
+  @{
+*/
+
+static volatile uint32_t s_u32HdivOpen = 0;     /* Division helpers use software until HDIV_Open */
+
+/** @addtogroup HDIV_EXPORTED_FUNCTIONS HDIV Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Open Hardware Divider
+  *
+  * @param      None
+  *
+  * @return     None
+  *
+  * @details    Enable the hardware divider clock. With HDIV_ENABLE_AEABI defined, the compiler division helpers
+  *             use the divider from now on. Divisions before this call, such as those in SystemInit and
+  *             CLK_SetCoreClock, are done in software.
+  */
+void HDIV_Open(void)
+{
+    CLK->AHBCLK |= CLK_AHBCLK_HDIVCKEN_Msk;
+    s_u32HdivOpen = 1;
+}
+
+/**
+  * @brief      Close Hardware Divider
+  *
+  * @param      None
+  *
+  * @return     None
+  *
+  * @details    Return the compiler division helpers to software and disable the hardware divider clock.
+  */
+void HDIV_Close(void)
+{
+    s_u32HdivOpen = 0;
+    CLK->AHBCLK &= ~CLK_AHBCLK_HDIVCKEN_Msk;
+}
+
+#if defined(HDIV_ENABLE_AEABI)
+
+/* Shift-subtract division for operands out of the divider range. The divisor is not zero. */
+static uint32_t HDIV_SwDivMod(uint32_t u32Dividend, uint32_t u32Divisor, uint32_t *pu32Rem)
+{
+    uint32_t u32Quo = 0, u32Bit = 1;
+
+    while((u32Divisor < u32Dividend) && !(u32Divisor & 0x80000000UL))
+    {
+        u32Divisor <<= 1;
+        u32Bit <<= 1;
+    }
+    while(u32Bit)
+    {
+        if(u32Dividend >= u32Divisor)
+        {
+            u32Dividend -= u32Divisor;
+            u32Quo |= u32Bit;
+        }
+        u32Divisor >>= 1;
+        u32Bit >>= 1;
+    }
+
+    *pu32Rem = u32Dividend;
+    return u32Quo;
+}
+
+/* The divider holds one operation, so the operands found in it are written back on exit. Writing the
+   divisor restarts the division, so code interrupted between loading the divider and reading the result
+   still reads its own quotient, and interrupt handlers can divide without masking interrupts. */
+static int32_t HDIV_HwDivMod(int32_t i32Dividend, int32_t i32Divisor, int32_t *pi32Rem)
+{
+    uint32_t u32SaveDividend, u32SaveDivisor;
+    int32_t i32Quo;
+
+    u32SaveDividend = HDIV->DIVIDEND;
+    u32SaveDivisor = HDIV->DIVISOR;
+
+    HDIV->DIVIDEND = (uint32_t)i32Dividend;
+    HDIV->DIVISOR = (uint32_t)i32Divisor;
+    i32Quo = (int32_t)HDIV->DIVQUO;
+    *pi32Rem = (int32_t)HDIV->DIVREM;
+
+    HDIV->DIVIDEND = u32SaveDividend;
+    HDIV->DIVISOR = u32SaveDivisor;
+
+    return i32Quo;
+}
+
+static int32_t HDIV_DivMod(int32_t i32Dividend, int32_t i32Divisor, int32_t *pi32Rem)
+{
+    uint32_t u32Quo, u32Rem;
+
+    /* Quotient saturates to the sign of the dividend and goes through the division by zero handler */
+    if(i32Divisor == 0)
+    {
+        *pi32Rem = i32Dividend;
+        return __aeabi_idiv0((i32Dividend > 0) ? INT32_MAX : ((i32Dividend < 0) ? INT32_MIN : 0));
+    }
+
+    /* Divisor register is 16-bit signed */
+    if(s_u32HdivOpen && (i32Divisor >= -32768) && (i32Divisor <= 32767))
+        return HDIV_HwDivMod(i32Dividend, i32Divisor, pi32Rem);
+
+    u32Quo = HDIV_SwDivMod((i32Dividend < 0) ? (0 - (uint32_t)i32Dividend) : (uint32_t)i32Dividend,
+                           (i32Divisor < 0) ? (0 - (uint32_t)i32Divisor) : (uint32_t)i32Divisor, &u32Rem);
+    *pi32Rem = (i32Dividend < 0) ? -(int32_t)u32Rem : (int32_t)u32Rem;
+    return ((i32Dividend < 0) != (i32Divisor < 0)) ? -(int32_t)u32Quo : (int32_t)u32Quo;
+}
+
+static uint32_t HDIV_UDivMod(uint32_t u32Dividend, uint32_t u32Divisor, uint32_t *pu32Rem)
+{
+    int32_t i32Quo, i32Rem;
+
+    if(u32Divisor == 0)
+    {
+        *pu32Rem = u32Dividend;
+        return (uint32_t)__aeabi_idiv0((u32Dividend != 0) ? -1 : 0);
+    }
+
+    /* Signed divider gives the unsigned result while both operands are non-negative in its range */
+    if(s_u32HdivOpen && (u32Dividend <= 0x7FFFFFFFUL) && (u32Divisor <= 32767))
+    {
+        i32Quo = HDIV_HwDivMod((int32_t)u32Dividend, (int32_t)u32Divisor, &i32Rem);
+        *pu32Rem = (uint32_t)i32Rem;
+        return (uint32_t)i32Quo;
+    }
+
+    return HDIV_SwDivMod(u32Dividend, u32Divisor, pu32Rem);
+}
+
+/**
+  * @brief      Signed Division Helper
+  *
+  * @param[in]  i32Dividend The dividend.
+  * @param[in]  i32Divisor  The divisor.
+  *
+  * @return     Quotient rounded toward zero.
+  *
+  * @details    Called by compiled code for '/' on int. The hardware divider is used when HDIV_Open has been
+  *             called and the divisor fits in 16 bits signed, software otherwise. Division by zero returns
+  *             __aeabi_idiv0(INT32_MAX), __aeabi_idiv0(INT32_MIN) or __aeabi_idiv0(0) after the sign of the dividend.
+  */
+int32_t __aeabi_idiv(int32_t i32Dividend, int32_t i32Divisor)
+{
+    int32_t i32Rem;
+
+    return HDIV_DivMod(i32Dividend, i32Divisor, &i32Rem);
+}
+
+/**
+  * @brief      Unsigned Division Helper
+  *
+  * @param[in]  u32Dividend The dividend.
+  * @param[in]  u32Divisor  The divisor.
+  *
+  * @return     Quotient.
+  *
+  * @details    Called by compiled code for '/' on unsigned int. The hardware divider is used when HDIV_Open has
+  *             been called, the dividend is below 0x80000000 and the divisor below 0x8000, software otherwise.
+  *             Division by zero returns __aeabi_idiv0(0xFFFFFFFF), or __aeabi_idiv0(0) for a zero dividend.
+  */
+uint32_t __aeabi_uidiv(uint32_t u32Dividend, uint32_t u32Divisor)
+{
+    uint32_t u32Rem;
+
+    return HDIV_UDivMod(u32Dividend, u32Divisor, &u32Rem);
+}
+
+/**
+  * @brief      Signed Division and Remainder Helper
+  *
+  * @param[in]  i32Dividend The dividend.
+  * @param[in]  i32Divisor  The divisor.
+  *
+  * @return     Quotient in the low word and remainder in the high word.
+  *
+  * @details    Called by compiled code for '%' on int. A 64-bit return value is passed in r0 and r1, which is
+  *             where the ABI expects the quotient and the remainder.
+  */
+uint64_t __aeabi_idivmod(int32_t i32Dividend, int32_t i32Divisor)
+{
+    int32_t i32Quo, i32Rem;
+
+    i32Quo = HDIV_DivMod(i32Dividend, i32Divisor, &i32Rem);
+    return ((uint64_t)(uint32_t)i32Rem << 32) | (uint32_t)i32Quo;
+}
+
+/**
+  * @brief      Unsigned Division and Remainder Helper
+  *
+  * @param[in]  u32Dividend The dividend.
+  * @param[in]  u32Divisor  The divisor.
+  *
+  * @return     Quotient in the low word and remainder in the high word.
+  *
+  * @details    Called by compiled code for '%' on unsigned int.
+  */
+uint64_t __aeabi_uidivmod(uint32_t u32Dividend, uint32_t u32Divisor)
+{
+    uint32_t u32Quo, u32Rem;
+
+    u32Quo = HDIV_UDivMod(u32Dividend, u32Divisor, &u32Rem);
+    return ((uint64_t)u32Rem << 32) | u32Quo;
+}
+
+#endif /* defined(HDIV_ENABLE_AEABI) */
+
+/*@}*/ /* end of group HDIV_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group HDIV_Driver */
+
+/*@}*/ /* end of group Standard_Driver */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
@@ -513,6 +513,7 @@ uint32_t I2C_WriteMultiBytes(I2C_T *i2c, uint8_t u8SlaveAddr, const uint8_t *dat
     uint32_t u32txLen = 0, u32TimeOutCount = 0u;
 
     g_I2C_i32ErrCode = 0;
+    TRACE_BEGIN(TRACE_ID_I2C_WRITE, u32wLen);
 
     I2C_START(i2c);                                              /* Send START */
     while(u8Xfering && (u8Err == 0))
@@ -568,6 +569,7 @@ uint32_t I2C_WriteMultiBytes(I2C_T *i2c, uint8_t u8SlaveAddr, const uint8_t *dat
         }
     }
 
+    TRACE_END(TRACE_ID_I2C_WRITE, u32txLen);
     return u32txLen;                                             /* Return bytes length that have been transmitted */
 }
 
@@ -681,6 +683,7 @@ uint32_t I2C_WriteMultiBytesOneReg(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t u8Da
     uint32_t u32txLen = 0, u32TimeOutCount = 0u;
 
     g_I2C_i32ErrCode = 0;
+    TRACE_BEGIN(TRACE_ID_I2C_WRITE, u32wLen);
 
     I2C_START(i2c);                                              /* Send START */
     while(u8Xfering && (u8Err == 0))
@@ -738,6 +741,7 @@ uint32_t I2C_WriteMultiBytesOneReg(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t u8Da
         }
     }
 
+    TRACE_END(TRACE_ID_I2C_WRITE, u32txLen);
     return u32txLen;                                             /* Return bytes length that have been transmitted */
 }
 
@@ -856,6 +860,7 @@ uint32_t I2C_WriteMultiBytesTwoRegs(I2C_T *i2c, uint8_t u8SlaveAddr, uint16_t u1
     uint32_t u32txLen = 0, u32TimeOutCount = 0u;
 
     g_I2C_i32ErrCode = 0;
+    TRACE_BEGIN(TRACE_ID_I2C_WRITE, u32wLen);
 
     I2C_START(i2c);                                                         /* Send START */
     while(u8Xfering && (u8Err == 0))
@@ -918,6 +923,7 @@ uint32_t I2C_WriteMultiBytesTwoRegs(I2C_T *i2c, uint8_t u8SlaveAddr, uint16_t u1
         }
     }
 
+    TRACE_END(TRACE_ID_I2C_WRITE, u32txLen);
     return u32txLen;                                                        /* Return bytes length that have been transmitted */
 }
 
@@ -1019,6 +1025,7 @@ uint32_t I2C_ReadMultiBytes(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t *rdata, uin
     uint32_t u32rxLen = 0, u32TimeOutCount = 0u;
 
     g_I2C_i32ErrCode = 0;
+    TRACE_BEGIN(TRACE_ID_I2C_READ, u32rLen);
 
     I2C_START(i2c);                                                /* Send START */
     while(u8Xfering && (u8Err == 0))
@@ -1082,6 +1089,7 @@ uint32_t I2C_ReadMultiBytes(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t *rdata, uin
         }
     }
 
+    TRACE_END(TRACE_ID_I2C_READ, u32rxLen);
     return u32rxLen;                                                      /* Return bytes length that have been received */
 }
 
@@ -1200,6 +1208,7 @@ uint32_t I2C_ReadMultiBytesOneReg(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t u8Dat
     uint32_t u32rxLen = 0, u32TimeOutCount = 0u;
 
     g_I2C_i32ErrCode = 0;
+    TRACE_BEGIN(TRACE_ID_I2C_READ, u32rLen);
 
     I2C_START(i2c);                                                /* Send START */
     while(u8Xfering && (u8Err == 0))
@@ -1274,6 +1283,7 @@ uint32_t I2C_ReadMultiBytesOneReg(I2C_T *i2c, uint8_t u8SlaveAddr, uint8_t u8Dat
         }
     }
 
+    TRACE_END(TRACE_ID_I2C_READ, u32rxLen);
     return u32rxLen;                                               /* Return bytes length that have been received */
 }
 
@@ -1397,6 +1407,7 @@ uint32_t I2C_ReadMultiBytesTwoRegs(I2C_T *i2c, uint8_t u8SlaveAddr, uint16_t u16
     uint32_t u32rxLen = 0, u32TimeOutCount = 0u;
 
     g_I2C_i32ErrCode = 0;
+    TRACE_BEGIN(TRACE_ID_I2C_READ, u32rLen);
 
     I2C_START(i2c);                                                         /* Send START */
     while(u8Xfering && (u8Err == 0))
@@ -1477,10 +1488,649 @@ uint32_t I2C_ReadMultiBytesTwoRegs(I2C_T *i2c, uint8_t u8SlaveAddr, uint16_t u16
         }
     }
 
+    TRACE_END(TRACE_ID_I2C_READ, u32rxLen);
     return u32rxLen;                                                        /* Return bytes length that have been received */
 }
 
 
+static S_I2C_ASYNC_T *s_apsI2cAsync[I2C_ASYNC_NUM];
+static S_I2C_SLAVE_T *s_apsI2cSlave[I2C_ASYNC_NUM];
+
+#define I2C_DMA_MAX_LEN         16384       /* Bytes of one PDMA table, TXCNT is 14 bits */
+
+static uint32_t I2C_GetIndex(I2C_T *i2c)
+{
+    return (i2c == I2C0) ? 0 : 1;
+}
+
+/* Move the next data bytes of the transfer on the bus by PDMA, a read leaves its last byte to the interrupt */
+static void I2C_AsyncStartDMA(I2C_T *i2c, S_I2C_ASYNC_T *psAsync, uint32_t u32Rx)
+{
+    S_I2C_XFER_T *psXfer = psAsync->psHead;
+    uint32_t u32Ch = (uint32_t)psAsync->i32DmaCh;
+    uint32_t u32Len = psXfer->u32Len - psXfer->u32Count - u32Rx;
+
+    if(u32Len > I2C_DMA_MAX_LEN)
+        u32Len = I2C_DMA_MAX_LEN;
+    psAsync->u32DmaLen = u32Len;
+
+    PDMA_SetTransferCnt(u32Ch, PDMA_WIDTH_8, u32Len);
+    if(u32Rx)
+    {
+        PDMA_SetTransferAddr(u32Ch, (uint32_t)&i2c->DAT, PDMA_SAR_FIX, (uint32_t)&psXfer->pu8Buf[psXfer->u32Count], PDMA_DAR_INC);
+        PDMA_SetTransferMode(u32Ch, PDMA_I2C0_RX + I2C_GetIndex(i2c) * 2, FALSE, 0);
+    }
+    else
+    {
+        PDMA_SetTransferAddr(u32Ch, (uint32_t)&psXfer->pu8Buf[psXfer->u32Count], PDMA_SAR_INC, (uint32_t)&i2c->DAT, PDMA_DAR_FIX);
+        PDMA_SetTransferMode(u32Ch, PDMA_I2C0_TX + I2C_GetIndex(i2c) * 2, FALSE, 0);
+    }
+    PDMA_SetBurstType(u32Ch, PDMA_REQ_SINGLE, 0);
+    i2c->CTL1 |= u32Rx ? I2C_CTL1_RXPDMAEN_Msk : I2C_CTL1_TXPDMAEN_Msk;
+}
+
+
+/* Stop PDMA when the transfer ends early and count the bytes of the block in progress */
+static void I2C_AsyncStopDMA(I2C_T *i2c, S_I2C_ASYNC_T *psAsync)
+{
+    uint32_t u32Ch = (uint32_t)psAsync->i32DmaCh;
+    uint32_t u32Ctl, u32Primask;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    if(i2c->CTL1 & (I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk))
+    {
+        i2c->CTL1 &= ~(I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk);
+
+        /* Finished table goes back to OPMODE idle, otherwise TXCNT holds the remaining count - 1 */
+        u32Ctl = PDMA->DSCT[u32Ch].CTL;
+        if((u32Ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_STOP)
+            psAsync->psHead->u32Count += psAsync->u32DmaLen;
+        else
+        {
+            psAsync->psHead->u32Count += psAsync->u32DmaLen - (((u32Ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1);
+
+            /* Channel reset drops the rest of the table and clears the channel enable */
+            PDMA->RESET = 1 << u32Ch;
+            while(PDMA->RESET & (1 << u32Ch));
+            PDMA_Open(1 << u32Ch);
+        }
+        /* The block is counted here, the done callback must not count it again */
+        PDMA_CLR_TD_FLAG(1 << u32Ch);
+    }
+    __set_PRIMASK(u32Primask);
+}
+
+
+/* PDMA callback, a block of the transfer on the bus is done: go on with the next one or hand over to the interrupt */
+static void I2C_AsyncDMADone(uint32_t u32Ch, uint32_t u32Event)
+{
+    S_I2C_ASYNC_T *psAsync;
+    S_I2C_XFER_T *psXfer;
+    I2C_T *i2c;
+    uint32_t i, u32Rx, u32Primask;
+
+    for(i = 0; i < I2C_ASYNC_NUM; i++)
+        if((s_apsI2cAsync[i] != NULL) && (s_apsI2cAsync[i]->i32DmaCh == (int32_t)u32Ch))
+            break;
+    if(i == I2C_ASYNC_NUM)
+        return;
+    psAsync = s_apsI2cAsync[i];
+    i2c = (i == 0) ? I2C0 : I2C1;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    u32Rx = i2c->CTL1 & I2C_CTL1_RXPDMAEN_Msk;
+    psXfer = psAsync->psHead;
+    /* Transfer ended by NACK or error before the callback ran: I2C_AsyncStopDMA counted the block */
+    if((psXfer != NULL) && (i2c->CTL1 & (I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk)))
+    {
+        psXfer->u32Count += psAsync->u32DmaLen;
+        if(!(u32Event & PDMA_EVENT_ABORT) && ((psXfer->u32Count + (u32Rx ? 1 : 0)) < psXfer->u32Len))
+            I2C_AsyncStartDMA(i2c, psAsync, u32Rx ? 1 : 0);
+        else
+        {
+            /* The byte in flight completes with SI, on a target abort the remaining bytes fall back to the interrupt */
+            i2c->CTL1 &= ~(I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk);
+            if(u32Rx && ((psXfer->u32Count + 1) >= psXfer->u32Len))
+                I2C_SET_CONTROL_REG(i2c, 0);                            /* NACK the last byte */
+        }
+    }
+    __set_PRIMASK(u32Primask);
+}
+
+
+/* Complete the transfer on the bus, then STOP, or STOP and START the next queued transfer */
+static void I2C_AsyncFinish(I2C_T *i2c, S_I2C_ASYNC_T *psAsync, int32_t i32Status)
+{
+    S_I2C_XFER_T *psXfer = psAsync->psHead;
+
+    if(psAsync->i32DmaCh >= 0)
+        I2C_AsyncStopDMA(i2c, psAsync);
+    psAsync->psHead = psXfer->psNext;
+    if(psAsync->psHead == NULL)
+        psAsync->psTail = NULL;
+    psXfer->i32Status = i32Status;
+
+    /* A transfer queued by the callback on an empty queue sets STA itself, START follows the STOP */
+    I2C_SET_CONTROL_REG(i2c, (psAsync->psHead != NULL) ? I2C_CTL_STA_STO_SI : I2C_CTL_STO_SI);
+    if(psXfer->pfnCallback != NULL)
+        psXfer->pfnCallback(psXfer);
+}
+
+
+/**
+ *    @brief        Start interrupt driven transfers on I2C
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *    @param[in]    psAsync     Control block. It must stay valid until I2C_CloseAsync is called.
+ *
+ *    @retval       0           Transfers can be submitted
+ *    @retval       -1          u32UseDMA is set and no PDMA channel is free
+ *
+ *    @details      I2C must be configured by I2C_Open before. This function enables the I2C interrupt. The application
+ *                  interrupt handler (I2C0_IRQHandler or I2C1_IRQHandler) has to call I2C_AsyncIRQHandler and the
+ *                  NVIC I2C IRQ must be enabled. Enable the bus time-out with I2C_EnableTimeout to recover from
+ *                  a slave holding SCL low.
+ *                  With u32UseDMA, the application PDMA_IRQHandler has to call PDMA_ChannelIRQHandler with the
+ *                  NVIC PDMA IRQ enabled.
+ */
+int32_t I2C_OpenAsync(I2C_T *i2c, S_I2C_ASYNC_T *psAsync)
+{
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+    psAsync->i32DmaCh = -1;
+    if(psAsync->u32UseDMA)
+    {
+        psAsync->i32DmaCh = PDMA_RequestChannel(PDMA_CH_ANY, I2C_AsyncDMADone);
+        if(psAsync->i32DmaCh < 0)
+            return -1;
+    }
+    i2c->CTL1 &= ~(I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk);
+    s_apsI2cAsync[I2C_GetIndex(i2c)] = psAsync;
+
+    I2C_EnableInt(i2c);
+    return 0;
+}
+
+
+/**
+ *    @brief        Stop interrupt driven transfers on I2C
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *
+ *    @return       None
+ *
+ *    @details      Disables the I2C interrupt and sends STOP if a transfer is on the bus. Queued transfers are
+ *                  completed with \ref I2C_ERR_FAIL without calling their callback. The PDMA channel is released.
+ */
+void I2C_CloseAsync(I2C_T *i2c)
+{
+    S_I2C_ASYNC_T *psAsync = s_apsI2cAsync[I2C_GetIndex(i2c)];
+    S_I2C_XFER_T *psXfer;
+
+    I2C_DisableInt(i2c);
+    if((psAsync != NULL) && (psAsync->i32DmaCh >= 0))
+    {
+        if(psAsync->psHead != NULL)
+            I2C_AsyncStopDMA(i2c, psAsync);
+        PDMA_ReleaseChannel((uint32_t)psAsync->i32DmaCh);
+        psAsync->i32DmaCh = -1;
+    }
+    s_apsI2cAsync[I2C_GetIndex(i2c)] = NULL;
+    if((psAsync == NULL) || (psAsync->psHead == NULL))
+        return;
+
+    I2C_SET_CONTROL_REG(i2c, I2C_CTL_STO_SI);
+    for(psXfer = psAsync->psHead; psXfer != NULL; psXfer = psXfer->psNext)
+        psXfer->i32Status = I2C_ERR_FAIL;
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+}
+
+
+/**
+ *    @brief        Queue an interrupt driven I2C transfer
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *    @param[in]    psXfer      Transfer descriptor. u8SlaveAddr, u8Dir, u8RegLen, u32RegAddr, pu8Buf, u32Len,
+ *                              pfnCallback and pvArg must be set. It must stay valid until the transfer is done.
+ *
+ *    @retval       I2C_OK          Transfer is queued
+ *    @retval       I2C_ERR_FAIL    I2C_OpenAsync was not called or the descriptor is invalid
+ *
+ *    @details      This function never waits. The transfer starts at once if the bus is idle, otherwise after the
+ *                  transfers queued before it. Its i32Status stays \ref I2C_XFER_PENDING until it is done and the
+ *                  callback is called from the I2C interrupt once STOP is requested. A register read is a
+ *                  \ref I2C_XFER_READ with u8RegLen set, it writes the register address and reads after a repeated
+ *                  START. Can be called from a transfer callback.
+ */
+int32_t I2C_SubmitAsync(I2C_T *i2c, S_I2C_XFER_T *psXfer)
+{
+    S_I2C_ASYNC_T *psAsync = s_apsI2cAsync[I2C_GetIndex(i2c)];
+    uint32_t u32Primask;
+
+    if((psAsync == NULL) || (psXfer->u8RegLen > 4) || ((psXfer->u8Dir == I2C_XFER_READ) && (psXfer->u32Len == 0)))
+        return I2C_ERR_FAIL;
+
+    psXfer->psNext = NULL;
+    psXfer->u8RegIdx = 0;
+    psXfer->u32Count = 0;
+    psXfer->i32Status = I2C_XFER_PENDING;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    if(psAsync->psHead == NULL)
+    {
+        psAsync->psHead = psXfer;
+        psAsync->psTail = psXfer;
+        I2C_START(i2c);
+    }
+    else
+    {
+        psAsync->psTail->psNext = psXfer;
+        psAsync->psTail = psXfer;
+    }
+    __set_PRIMASK(u32Primask);
+
+    return I2C_OK;
+}
+
+
+/**
+ *    @brief        Check if interrupt driven I2C transfers are pending
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *
+ *    @retval       0   No transfer is queued
+ *    @retval       1   A transfer is on the bus or queued
+ */
+uint32_t I2C_IsAsyncBusy(I2C_T *i2c)
+{
+    S_I2C_ASYNC_T *psAsync = s_apsI2cAsync[I2C_GetIndex(i2c)];
+
+    return ((psAsync != NULL) && (psAsync->psHead != NULL)) ? 1 : 0;
+}
+
+
+/**
+ *    @brief        I2C interrupt handler for interrupt driven transfers
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *
+ *    @return       None
+ *
+ *    @details      Runs the master START, address, register address, data and STOP sequence of the transfer on the
+ *                  bus, one step per I2C status. NACK, arbitration lost and bus error complete the transfer with
+ *                  \ref I2C_ERR_FAIL, a bus time-out with \ref I2C_ERR_TIMEOUT, and the next queued transfer starts.
+ *                  With PDMA, the data bytes of a write and all but the last byte of a read do not interrupt.
+ */
+void I2C_AsyncIRQHandler(I2C_T *i2c)
+{
+    S_I2C_ASYNC_T *psAsync = s_apsI2cAsync[I2C_GetIndex(i2c)];
+    S_I2C_XFER_T *psXfer;
+
+    if(I2C_GET_TIMEOUT_FLAG(i2c))
+    {
+        I2C_ClearTimeoutFlag(i2c);
+        if((psAsync != NULL) && (psAsync->psHead != NULL))
+            I2C_AsyncFinish(i2c, psAsync, I2C_ERR_TIMEOUT);
+        return;
+    }
+
+    if((psAsync == NULL) || ((psXfer = psAsync->psHead) == NULL))
+    {
+        I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+        return;
+    }
+
+    switch(I2C_GET_STATUS(i2c))
+    {
+        case 0x08:                                                      /* START has been transmitted */
+            psXfer->u8RegIdx = 0;
+            psXfer->u32Count = 0;
+            if((psXfer->u8Dir == I2C_XFER_READ) && (psXfer->u8RegLen == 0))
+                I2C_SET_DATA(i2c, (uint8_t)((psXfer->u8SlaveAddr << 1) | 0x01));   /* Write SLA+R to Register I2CDAT */
+            else
+                I2C_SET_DATA(i2c, (uint8_t)(psXfer->u8SlaveAddr << 1));            /* Write SLA+W to Register I2CDAT */
+            I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+            break;
+        case 0x10:                                                      /* Repeated START of a register read */
+            I2C_SET_DATA(i2c, (uint8_t)((psXfer->u8SlaveAddr << 1) | 0x01));       /* Write SLA+R to Register I2CDAT */
+            I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+            break;
+        case 0x18:                                                      /* Slave Address ACK */
+        case 0x28:                                                      /* Data byte ACK */
+            if(psXfer->u8RegIdx < psXfer->u8RegLen)
+            {
+                I2C_SET_DATA(i2c, (uint8_t)(psXfer->u32RegAddr >> (8 * (psXfer->u8RegLen - 1 - psXfer->u8RegIdx))));
+                psXfer->u8RegIdx++;
+                I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+            }
+            else if(psXfer->u8Dir == I2C_XFER_READ)
+                I2C_SET_CONTROL_REG(i2c, I2C_CTL_STA_SI);                /* Send repeated START */
+            else if((psXfer->u32Count < psXfer->u32Len) && (psAsync->i32DmaCh >= 0))
+            {
+                I2C_AsyncStartDMA(i2c, psAsync, 0);                     /* PDMA writes the data bytes */
+                I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+            }
+            else if(psXfer->u32Count < psXfer->u32Len)
+            {
+                I2C_SET_DATA(i2c, psXfer->pu8Buf[psXfer->u32Count++]);
+                I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+            }
+            else
+                I2C_AsyncFinish(i2c, psAsync, I2C_OK);
+            break;
+        case 0x40:                                                      /* Slave Address ACK */
+            if((psXfer->u32Len > 1) && (psAsync->i32DmaCh >= 0))
+                I2C_AsyncStartDMA(i2c, psAsync, 1);                     /* PDMA reads all but the last byte */
+            I2C_SET_CONTROL_REG(i2c, (psXfer->u32Len > 1) ? I2C_CTL_SI_AA : I2C_CTL_SI);
+            break;
+        case 0x50:                                                      /* Data byte received, ACK returned */
+            psXfer->pu8Buf[psXfer->u32Count++] = (uint8_t)I2C_GET_DATA(i2c);
+            /* PDMA callback ran after the last byte was acknowledged */
+            if(psXfer->u32Count == psXfer->u32Len)
+            {
+                I2C_AsyncFinish(i2c, psAsync, I2C_OK);
+                break;
+            }
+            I2C_SET_CONTROL_REG(i2c, ((psXfer->u32Count + 1) < psXfer->u32Len) ? I2C_CTL_SI_AA : I2C_CTL_SI);
+            break;
+        case 0x58:                                                      /* Last data byte received, NACK returned */
+            psXfer->pu8Buf[psXfer->u32Count++] = (uint8_t)I2C_GET_DATA(i2c);
+            I2C_AsyncFinish(i2c, psAsync, I2C_OK);
+            break;
+        case 0x20:                                                      /* Slave Address NACK */
+        case 0x30:                                                      /* Master transmit data NACK */
+        case 0x48:                                                      /* Slave Address NACK */
+        case 0x38:                                                      /* Arbitration Lost */
+        default:                                                        /* Bus error or unknown status */
+            I2C_AsyncFinish(i2c, psAsync, I2C_ERR_FAIL);
+            break;
+    }
+}
+
+
+/* Advance the register pointer over the bytes moved by PDMA */
+static void I2C_SlaveDMAMoved(S_I2C_SLAVE_T *psSlave, uint32_t u32Rx, uint32_t u32Len)
+{
+    psSlave->u32Ptr = (psSlave->u32Ptr + u32Len < psSlave->u32Size) ? (psSlave->u32Ptr + u32Len) : 0;
+    if(u32Rx)
+        psSlave->u32WrLen += u32Len;
+}
+
+
+/* Move the next data bytes by PDMA, up to the end of the register map or the table limit */
+static void I2C_SlaveStartDMA(I2C_T *i2c, S_I2C_SLAVE_T *psSlave, uint32_t u32Rx)
+{
+    uint32_t u32Ch = (uint32_t)psSlave->i32DmaCh;
+    uint32_t u32Len = psSlave->u32Size - psSlave->u32Ptr;
+
+    if(u32Len > I2C_DMA_MAX_LEN)
+        u32Len = I2C_DMA_MAX_LEN;
+    psSlave->u32DmaLen = u32Len;
+
+    PDMA_SetTransferCnt(u32Ch, PDMA_WIDTH_8, u32Len);
+    if(u32Rx)
+    {
+        PDMA_SetTransferAddr(u32Ch, (uint32_t)&i2c->DAT, PDMA_SAR_FIX, (uint32_t)&psSlave->pu8Regs[psSlave->u32Ptr], PDMA_DAR_INC);
+        PDMA_SetTransferMode(u32Ch, PDMA_I2C0_RX + I2C_GetIndex(i2c) * 2, FALSE, 0);
+    }
+    else
+    {
+        PDMA_SetTransferAddr(u32Ch, (uint32_t)&psSlave->pu8Regs[psSlave->u32Ptr], PDMA_SAR_INC, (uint32_t)&i2c->DAT, PDMA_DAR_FIX);
+        PDMA_SetTransferMode(u32Ch, PDMA_I2C0_TX + I2C_GetIndex(i2c) * 2, FALSE, 0);
+    }
+    PDMA_SetBurstType(u32Ch, PDMA_REQ_SINGLE, 0);
+    i2c->CTL1 |= u32Rx ? I2C_CTL1_RXPDMAEN_Msk : I2C_CTL1_TXPDMAEN_Msk;
+}
+
+
+/* Stop PDMA at the end of a transfer and count the bytes of the block in progress */
+static void I2C_SlaveStopDMA(I2C_T *i2c, S_I2C_SLAVE_T *psSlave)
+{
+    uint32_t u32Ch = (uint32_t)psSlave->i32DmaCh;
+    uint32_t u32Rx, u32Ctl, u32Primask;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    u32Rx = i2c->CTL1 & I2C_CTL1_RXPDMAEN_Msk;
+    if(i2c->CTL1 & (I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk))
+    {
+        i2c->CTL1 &= ~(I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk);
+
+        /* Finished table goes back to OPMODE idle, otherwise TXCNT holds the remaining count - 1 */
+        u32Ctl = PDMA->DSCT[u32Ch].CTL;
+        if((u32Ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_STOP)
+            I2C_SlaveDMAMoved(psSlave, u32Rx, psSlave->u32DmaLen);
+        else
+        {
+            I2C_SlaveDMAMoved(psSlave, u32Rx, psSlave->u32DmaLen - (((u32Ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1));
+
+            /* Channel reset drops the rest of the table and clears the channel enable */
+            PDMA->RESET = 1 << u32Ch;
+            while(PDMA->RESET & (1 << u32Ch));
+            PDMA_Open(1 << u32Ch);
+        }
+        /* The block is counted here, the done callback must not count it again */
+        PDMA_CLR_TD_FLAG(1 << u32Ch);
+    }
+    __set_PRIMASK(u32Primask);
+}
+
+
+/* PDMA callback, a block reached the end of the register map or the table limit: go on from there */
+static void I2C_SlaveDMADone(uint32_t u32Ch, uint32_t u32Event)
+{
+    S_I2C_SLAVE_T *psSlave;
+    I2C_T *i2c;
+    uint32_t i, u32Rx, u32Primask;
+
+    for(i = 0; i < I2C_ASYNC_NUM; i++)
+        if((s_apsI2cSlave[i] != NULL) && (s_apsI2cSlave[i]->i32DmaCh == (int32_t)u32Ch))
+            break;
+    if(i == I2C_ASYNC_NUM)
+        return;
+    psSlave = s_apsI2cSlave[i];
+    i2c = (i == 0) ? I2C0 : I2C1;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    u32Rx = i2c->CTL1 & I2C_CTL1_RXPDMAEN_Msk;
+    /* Transfer ended by STOP or NACK before the callback ran: I2C_SlaveStopDMA counted the block */
+    if(i2c->CTL1 & (I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk))
+    {
+        i2c->CTL1 &= ~(I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk);
+        I2C_SlaveDMAMoved(psSlave, u32Rx, psSlave->u32DmaLen);
+        /* On a target abort the remaining bytes of the transfer fall back to the interrupt */
+        if(!(u32Event & PDMA_EVENT_ABORT))
+            I2C_SlaveStartDMA(i2c, psSlave, u32Rx);
+    }
+    __set_PRIMASK(u32Primask);
+}
+
+
+/* Report the registers written since the last SLA+W */
+static void I2C_SlaveWriteDone(S_I2C_SLAVE_T *psSlave)
+{
+    uint32_t u32Len = psSlave->u32WrLen;
+
+    psSlave->u32WrLen = 0;
+    if((u32Len != 0) && (psSlave->pfnWrite != NULL))
+        psSlave->pfnWrite(psSlave, psSlave->u8Addr, psSlave->u32WrReg, (u32Len > psSlave->u32Size) ? psSlave->u32Size : u32Len);
+}
+
+
+/**
+ *    @brief        Start the I2C slave register map
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *    @param[in]    psSlave     Register map. pu8Regs, u32Size, u32PtrLen and the callbacks must be set. It must stay
+ *                              valid until I2C_CloseSlave is called.
+ *
+ *    @retval       0           Slave is addressable
+ *    @retval       -1          The port is used by I2C_OpenAsync, pu8Regs is NULL, u32Size is 0, u32PtrLen is
+ *                              not 1 or 2, or u32UseDMA is set and no PDMA channel is free
+ *
+ *    @details      I2C must be configured by I2C_Open, and the slave addresses by I2C_SetSlaveAddr and
+ *                  I2C_SetSlaveAddrMask before. All addresses matched by the four address registers and their masks
+ *                  share the register map; callbacks get the address of the transfer. This function enables the I2C
+ *                  interrupt and the address acknowledge. The application interrupt handler (I2C0_IRQHandler or
+ *                  I2C1_IRQHandler) has to call I2C_SlaveIRQHandler and the NVIC I2C IRQ must be enabled.
+ *                  SCL is held low from every byte until the handler returns, so the handler runs at the I2C
+ *                  interrupt priority and the callbacks should be short. Bulk processing of written registers
+ *                  belongs in the main loop, started from pfnWrite.
+ *                  With u32UseDMA, PDMA moves the data bytes after the register pointer and the application
+ *                  PDMA_IRQHandler has to call PDMA_ChannelIRQHandler with the NVIC PDMA IRQ at a priority
+ *                  not above the I2C IRQ.
+ */
+int32_t I2C_OpenSlave(I2C_T *i2c, S_I2C_SLAVE_T *psSlave)
+{
+    if(s_apsI2cAsync[I2C_GetIndex(i2c)] != NULL)
+        return -1;
+    if((psSlave->pu8Regs == NULL) || (psSlave->u32Size == 0) || (psSlave->u32PtrLen < 1) || (psSlave->u32PtrLen > 2))
+        return -1;
+
+    psSlave->u32Ptr = 0;
+    psSlave->u32PtrIdx = 0;
+    psSlave->u32WrLen = 0;
+    psSlave->i32DmaCh = -1;
+    if(psSlave->u32UseDMA)
+    {
+        psSlave->i32DmaCh = PDMA_RequestChannel(PDMA_CH_ANY, I2C_SlaveDMADone);
+        if(psSlave->i32DmaCh < 0)
+            return -1;
+    }
+    i2c->CTL1 &= ~(I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk);
+    s_apsI2cSlave[I2C_GetIndex(i2c)] = psSlave;
+
+    I2C_EnableInt(i2c);
+    I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI_AA);
+    return 0;
+}
+
+
+/**
+ *    @brief        Stop the I2C slave register map
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *
+ *    @return       None
+ *
+ *    @details      Stops acknowledging the slave addresses, disables the I2C interrupt and releases the PDMA
+ *                  channel.
+ */
+void I2C_CloseSlave(I2C_T *i2c)
+{
+    S_I2C_SLAVE_T *psSlave = s_apsI2cSlave[I2C_GetIndex(i2c)];
+
+    I2C_DisableInt(i2c);
+    I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+    s_apsI2cSlave[I2C_GetIndex(i2c)] = NULL;
+
+    i2c->CTL1 &= ~(I2C_CTL1_RXPDMAEN_Msk | I2C_CTL1_TXPDMAEN_Msk);
+    if((psSlave != NULL) && (psSlave->i32DmaCh >= 0))
+    {
+        PDMA_ReleaseChannel((uint32_t)psSlave->i32DmaCh);
+        psSlave->i32DmaCh = -1;
+    }
+}
+
+
+/**
+ *    @brief        Serve the I2C slave register map
+ *
+ *    @param[in]    i2c         Specify I2C port
+ *
+ *    @return       None
+ *
+ *    @details      Runs one step of the slave receiver or transmitter per I2C status. Register reads and writes
+ *                  go straight to the register file; pfnRead is called once per SLA+R and pfnWrite once per write
+ *                  transfer. A write beyond the pointer bytes wraps at the end of the map. With PDMA, the data
+ *                  bytes after the register pointer and after the first byte of a read do not interrupt.
+ */
+void I2C_SlaveIRQHandler(I2C_T *i2c)
+{
+    S_I2C_SLAVE_T *psSlave = s_apsI2cSlave[I2C_GetIndex(i2c)];
+    uint32_t u32Data;
+
+    if(I2C_GET_TIMEOUT_FLAG(i2c))
+    {
+        I2C_ClearTimeoutFlag(i2c);
+        return;
+    }
+
+    if(psSlave == NULL)
+    {
+        I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI);
+        return;
+    }
+
+    switch(I2C_GET_STATUS(i2c))
+    {
+        case 0x60:                                                      /* Own SLA+W has been received, ACK returned */
+        case 0x68:                                                      /* Arbitration lost, own SLA+W received */
+            psSlave->u8Addr = (uint8_t)(I2C_GET_DATA(i2c) >> 1);
+            psSlave->u32PtrIdx = 0;
+            psSlave->u32WrLen = 0;
+            break;
+        case 0x80:                                                      /* Data byte received, ACK returned */
+            u32Data = I2C_GET_DATA(i2c) & 0xFF;
+            if(psSlave->u32PtrIdx < psSlave->u32PtrLen)
+            {
+                psSlave->u32Ptr = (psSlave->u32PtrIdx == 0) ? u32Data : ((psSlave->u32Ptr << 8) | u32Data);
+                if(++psSlave->u32PtrIdx == psSlave->u32PtrLen)
+                {
+                    psSlave->u32Ptr %= psSlave->u32Size;
+                    psSlave->u32WrReg = psSlave->u32Ptr;
+                    if(psSlave->i32DmaCh >= 0)
+                        I2C_SlaveStartDMA(i2c, psSlave, 1);
+                }
+            }
+            else
+            {
+                psSlave->pu8Regs[psSlave->u32Ptr] = (uint8_t)u32Data;
+                psSlave->u32Ptr = (psSlave->u32Ptr + 1 < psSlave->u32Size) ? (psSlave->u32Ptr + 1) : 0;
+                psSlave->u32WrLen++;
+            }
+            break;
+        case 0x88:                                                      /* Data byte received, NACK returned */
+        case 0xA0:                                                      /* STOP or repeated START received */
+            if(psSlave->i32DmaCh >= 0)
+                I2C_SlaveStopDMA(i2c, psSlave);
+            I2C_SlaveWriteDone(psSlave);
+            break;
+        case 0xA8:                                                      /* Own SLA+R has been received, ACK returned */
+        case 0xB0:                                                      /* Arbitration lost, own SLA+R received */
+            psSlave->u8Addr = (uint8_t)(I2C_GET_DATA(i2c) >> 1);
+            psSlave->u32Ptr %= psSlave->u32Size;                        /* Pointer may be cut short by a repeated START */
+            if(psSlave->pfnRead != NULL)
+                psSlave->pfnRead(psSlave, psSlave->u8Addr, psSlave->u32Ptr);
+            I2C_SET_DATA(i2c, psSlave->pu8Regs[psSlave->u32Ptr]);
+            psSlave->u32Ptr = (psSlave->u32Ptr + 1 < psSlave->u32Size) ? (psSlave->u32Ptr + 1) : 0;
+            if(psSlave->i32DmaCh >= 0)
+                I2C_SlaveStartDMA(i2c, psSlave, 0);
+            break;
+        case 0xB8:                                                      /* Data byte transmitted, ACK received */
+            I2C_SET_DATA(i2c, psSlave->pu8Regs[psSlave->u32Ptr]);
+            psSlave->u32Ptr = (psSlave->u32Ptr + 1 < psSlave->u32Size) ? (psSlave->u32Ptr + 1) : 0;
+            break;
+        case 0xC0:                                                      /* Data byte transmitted, NACK received */
+        case 0xC8:                                                      /* Last data byte transmitted, ACK received */
+            if(psSlave->i32DmaCh >= 0)
+                I2C_SlaveStopDMA(i2c, psSlave);
+            break;
+        default:                                                        /* Bus error, release the bus */
+            if(psSlave->i32DmaCh >= 0)
+                I2C_SlaveStopDMA(i2c, psSlave);
+            I2C_SET_CONTROL_REG(i2c, I2C_CTL_STO_SI_AA);
+            return;
+    }
+    I2C_SET_CONTROL_REG(i2c, I2C_CTL_SI_AA);
+}
+
+
 /*@}*/ /* end of group I2C_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group I2C_Driver */
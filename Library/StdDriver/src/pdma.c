@@ -13,6 +13,10 @@
 
 
 static uint8_t u32ChSelect[PDMA_CH_MAX];
+static uint32_t s_u32ChUsed;
+static PDMA_CB s_apfnChCallback[PDMA_CH_MAX];
+static DSCT_T s_asDescPool[PDMA_DESC_NUM];
+static uint32_t s_u32DescUsed;
 
 /** @addtogroup Standard_Driver Standard Driver
   @{
@@ -354,6 +358,224 @@ void PDMA_DisableInt(uint32_t u32Ch, uint32_t u32Mask)
     }
 }
 
+/**
+ * @brief       Allocate a free channel
+ *
+ * @param[in]   u32ChMask       Channels the caller can work with, \ref PDMA_CH_ANY or \ref PDMA_CH_TIMEOUT
+ *                              if the request time-out function is needed.
+ * @param[in]   pfnCallback     Event callback called by PDMA_ChannelIRQHandler with \ref PDMA_EVENT_DONE,
+ *                              \ref PDMA_EVENT_ABORT, \ref PDMA_EVENT_EMPTY or \ref PDMA_EVENT_TIMEOUT. Can be NULL.
+ *
+ * @return      Channel number, or -1 if no channel in u32ChMask is free
+ *
+ * @details     The highest free channel in u32ChMask is taken so that channel 0 and 1 stay available for drivers
+ *              needing the time-out function. The channel is opened, and with a callback its transfer done and
+ *              abort interrupt and the NVIC PDMA IRQ are enabled. The application PDMA_IRQHandler has to call
+ *              PDMA_ChannelIRQHandler. It can be called from interrupt context.
+ */
+int32_t PDMA_RequestChannel(uint32_t u32ChMask, PDMA_CB pfnCallback)
+{
+    uint32_t u32PriMask;
+    int32_t i32Ch;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    for(i32Ch = PDMA_CH_MAX - 1; i32Ch >= 0; i32Ch--)
+    {
+        if((u32ChMask & ~s_u32ChUsed) & (1 << i32Ch))
+        {
+            s_u32ChUsed |= (1 << i32Ch);
+            break;
+        }
+    }
+    __set_PRIMASK(u32PriMask);
+
+    if(i32Ch < 0)
+        return -1;
+
+    s_apfnChCallback[i32Ch] = pfnCallback;
+    PDMA_Open(1 << i32Ch);
+    if(pfnCallback != NULL)
+    {
+        PDMA_EnableInt(i32Ch, PDMA_INT_TRANS_DONE);
+        NVIC_EnableIRQ(PDMA_IRQn);
+    }
+
+    return i32Ch;
+}
+
+/**
+ * @brief       Free a channel
+ *
+ * @param[in]   u32Ch           Channel returned by PDMA_RequestChannel
+ *
+ * @return      None
+ *
+ * @details     The channel is disabled, which drops a transfer in progress, and its interrupts and pending flags are
+ *              cleared. Descriptors used by the channel are not freed.
+ */
+void PDMA_ReleaseChannel(uint32_t u32Ch)
+{
+    uint32_t u32PriMask;
+
+    PDMA->CHCTL &= ~(1 << u32Ch);
+    PDMA->INTEN &= ~(1 << u32Ch);
+    if(u32Ch < 2)
+    {
+        PDMA->TOUTEN &= ~(1 << u32Ch);
+        PDMA->TOUTIEN &= ~(1 << u32Ch);
+        PDMA_CLR_TMOUT_FLAG(u32Ch);
+    }
+    PDMA_CLR_TD_FLAG(1 << u32Ch);
+    PDMA_CLR_ABORT_FLAG(1 << u32Ch);
+    PDMA_CLR_EMPTY_FLAG(1 << u32Ch);
+    s_apfnChCallback[u32Ch] = NULL;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    s_u32ChUsed &= ~(1 << u32Ch);
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+ * @brief       Allocate a scatter-gather descriptor
+ *
+ * @param       None
+ *
+ * @return      Descriptor, or NULL if the pool is used up
+ *
+ * @details     Descriptors come from a pool of \ref PDMA_DESC_NUM entries in SRAM. The first allocation points
+ *              PDMA_SCATBA at the pool, so descriptors of the application must not be mixed in the same chain.
+ */
+DSCT_T *PDMA_DescAlloc(void)
+{
+    uint32_t u32PriMask, u32Base, i;
+    DSCT_T *psDesc = NULL;
+
+    u32Base = (uint32_t)&s_asDescPool[0] & PDMA_SCATBA_SCATBA_Msk;
+    PDMA->SCATBA = u32Base;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    for(i = 0; i < PDMA_DESC_NUM; i++)
+    {
+        /* Link offsets are 16-bit, stop at a 64 KB boundary */
+        if(((uint32_t)&s_asDescPool[i] & PDMA_SCATBA_SCATBA_Msk) != u32Base)
+            break;
+        if((s_u32DescUsed & (1 << i)) == 0)
+        {
+            s_u32DescUsed |= (1 << i);
+            psDesc = &s_asDescPool[i];
+            break;
+        }
+    }
+    __set_PRIMASK(u32PriMask);
+
+    return psDesc;
+}
+
+/**
+ * @brief       Free a scatter-gather descriptor
+ *
+ * @param[in]   psDesc          Descriptor returned by PDMA_DescAlloc
+ *
+ * @return      None
+ *
+ * @details     The descriptor must not be part of a chain a channel is still running.
+ */
+void PDMA_DescFree(DSCT_T *psDesc)
+{
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    s_u32DescUsed &= ~(1 << (psDesc - s_asDescPool));
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+ * @brief       Fill a scatter-gather descriptor
+ *
+ * @param[in]   psDesc          Descriptor returned by PDMA_DescAlloc
+ * @param[in]   u32Config       Data width, address control and transfer type of the table. Combination of
+ *                - \ref PDMA_WIDTH_8, \ref PDMA_WIDTH_16 or \ref PDMA_WIDTH_32
+ *                - \ref PDMA_SAR_INC or \ref PDMA_SAR_FIX
+ *                - \ref PDMA_DAR_INC or \ref PDMA_DAR_FIX
+ *                - \ref PDMA_REQ_SINGLE, or \ref PDMA_REQ_BURST with PDMA_BURST_1 ~ PDMA_BURST_128
+ *                - \ref PDMA_TBINTDIS_ENABLE or \ref PDMA_TBINTDIS_DISABLE
+ * @param[in]   u32TransCount   Transfer count, 1 ~ 16384
+ * @param[in]   u32SrcAddr      Source address
+ * @param[in]   u32DstAddr      Destination address
+ * @param[in]   psNext          Next descriptor in the chain, or NULL if this is the last one. Linking the last
+ *                              descriptor back to the first gives a circular chain.
+ *
+ * @return      None
+ *
+ * @details     A descriptor with a next one is in scatter-gather mode, the last one is in basic mode so the channel
+ *              stops after it. The chain is started by PDMA_SetTransferMode with u32ScatterEn set and the first
+ *              descriptor, plus PDMA_Trigger for memory to memory transfer. Once a table is done, the PDMA writes
+ *              its OPMODE back to idle; a circular chain refills it by calling this function again in the callback.
+ */
+void PDMA_DescSet(DSCT_T *psDesc, uint32_t u32Config, uint32_t u32TransCount, uint32_t u32SrcAddr, uint32_t u32DstAddr, DSCT_T *psNext)
+{
+    psDesc->SA = u32SrcAddr;
+    psDesc->DA = u32DstAddr;
+    if(psNext != NULL)
+    {
+        psDesc->NEXT = (uint32_t)psNext - PDMA->SCATBA;
+        psDesc->CTL = u32Config | ((u32TransCount - 1) << PDMA_DSCT_CTL_TXCNT_Pos) | PDMA_OP_SCATTER;
+    }
+    else
+    {
+        psDesc->NEXT = 0;
+        psDesc->CTL = u32Config | ((u32TransCount - 1) << PDMA_DSCT_CTL_TXCNT_Pos) | PDMA_OP_BASIC;
+    }
+}
+
+/**
+ * @brief       Dispatch PDMA interrupt to channel callbacks
+ *
+ * @param       None
+ *
+ * @return      None
+ *
+ * @details     Called by the application PDMA_IRQHandler. Flags of channels allocated by PDMA_RequestChannel are
+ *              cleared before their callback is called, so a callback can start the next transfer right away.
+ *              Flags of other channels are left for the application.
+ *              Define PDMA_ENABLE_RAMFUNC to execute it from SRAM, the application PDMA_IRQHandler can be
+ *              tagged RAMFUNC too. Channel callbacks execute where they are linked.
+ */
+PDMA_RAMFUNC void PDMA_ChannelIRQHandler(void)
+{
+    uint32_t u32Td, u32Abt, u32Empty, u32Tout, u32Event, u32Ch;
+
+    u32Td = PDMA->TDSTS & s_u32ChUsed;
+    u32Abt = PDMA->ABTSTS & s_u32ChUsed;
+    u32Empty = PDMA->SCATSTS & s_u32ChUsed;
+    u32Tout = ((PDMA->INTSTS & (PDMA_INTSTS_REQTOF0_Msk | PDMA_INTSTS_REQTOF1_Msk)) >> PDMA_INTSTS_REQTOF0_Pos) & s_u32ChUsed;
+
+    PDMA_CLR_TD_FLAG(u32Td);
+    PDMA_CLR_ABORT_FLAG(u32Abt);
+    PDMA_CLR_EMPTY_FLAG(u32Empty);
+    PDMA->INTSTS = u32Tout << PDMA_INTSTS_REQTOF0_Pos;
+
+    for(u32Ch = 0; u32Ch < PDMA_CH_MAX; u32Ch++)
+    {
+        u32Event = 0;
+        if(u32Td & (1 << u32Ch))
+            u32Event |= PDMA_EVENT_DONE;
+        if(u32Abt & (1 << u32Ch))
+            u32Event |= PDMA_EVENT_ABORT;
+        if(u32Empty & (1 << u32Ch))
+            u32Event |= PDMA_EVENT_EMPTY;
+        if(u32Tout & (1 << u32Ch))
+            u32Event |= PDMA_EVENT_TIMEOUT;
+
+        if(u32Event && (s_apfnChCallback[u32Ch] != NULL))
+            s_apfnChCallback[u32Ch](u32Ch, u32Event);
+    }
+}
+
 /*@}*/ /* end of group PDMA_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group PDMA_Driver */
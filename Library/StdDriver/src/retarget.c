@@ -9,6 +9,8 @@
 
 
 #include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
 #include "NUC029xGE.h"
 
 #if defined (__ICCARM__)
@@ -495,6 +497,316 @@ void SendChar(int ch)
 #endif
 }
 
+#if defined(DEBUG_ENABLE_SEMIHOST) && (defined(__ARMCC_VERSION) || defined(__ICCARM__))
+#define SH_SYS_OPEN             0x01
+#define SH_SYS_WRITE            0x05
+#define SH_OPEN_MODE_WB         5       /* fopen() mode "wb" */
+#define TRACE_SH_RECORDS        16      /* Records per block written by TRACE_SemihostFlush() */
+
+static int32_t s_i32TraceFile = -1;
+
+/**
+ * @brief      Write recorded trace events to a file on the debugger host
+ *
+ * @param[in]  pcFile  File name on the host. It is created on the first call, later calls append to it.
+ *
+ * @retval     0   The trace buffer is empty and everything is written.
+ * @retval     -1  No debugger is connected, or the file cannot be opened or written.
+ *
+ * @details    Blocks made by TRACE_Read() go to the host with the semihost SYS_WRITE call, so the trace
+ *             leaves the target without a UART. The file is the same stream as the TRACE_Flush() output
+ *             and is decoded by the TraceDecode host tool. The core halts for every block, so call this
+ *             from the main loop, not from time critical code.
+ */
+int32_t TRACE_SemihostFlush(const char *pcFile)
+{
+    uint8_t au8Block[TRACE_HEADER_SIZE + TRACE_SH_RECORDS * TRACE_RECORD_SIZE];
+    int32_t ai32Param[3], i32Ret;
+    uint32_t u32Len;
+
+    if(!g_ICE_Conneced)
+        return -1;
+
+    if(s_i32TraceFile < 0)
+    {
+        ai32Param[0] = (int32_t)pcFile;
+        ai32Param[1] = SH_OPEN_MODE_WB;
+        ai32Param[2] = (int32_t)strlen(pcFile);
+        if((SH_DoCommand(SH_SYS_OPEN, (int32_t)ai32Param, &i32Ret) == 0) || (i32Ret < 0))
+            return -1;
+        s_i32TraceFile = i32Ret;
+    }
+
+    while((u32Len = TRACE_Read(au8Block, sizeof(au8Block))) != 0)
+    {
+        /* SYS_WRITE returns the number of bytes not written */
+        ai32Param[0] = s_i32TraceFile;
+        ai32Param[1] = (int32_t)au8Block;
+        ai32Param[2] = (int32_t)u32Len;
+        if((SH_DoCommand(SH_SYS_WRITE, (int32_t)ai32Param, &i32Ret) == 0) || (i32Ret != 0))
+            return -1;
+    }
+
+    return 0;
+}
+#endif /* defined(DEBUG_ENABLE_SEMIHOST) && (defined(__ARMCC_VERSION) || defined(__ICCARM__)) */
+
+#if defined(DEBUG_ENABLE_LOG)
+/*---------------------------------------------------------------------------------------------------------*/
+/* Deferred log                                                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+#ifndef DEBUG_LOG_ENTRIES
+# define DEBUG_LOG_ENTRIES      32      /* Number of queued records, must be a power of 2 */
+#endif
+#ifndef DEBUG_LOG_LINE_SIZE
+# define DEBUG_LOG_LINE_SIZE    96      /* Longest formatted record, longer output is truncated */
+#endif
+
+#define DEBUG_LOG_READY         0x80000000UL
+
+typedef struct
+{
+    const char *pcFmt;
+    volatile uint32_t u32Argc;          /* Argument count, DEBUG_LOG_READY is set when the record is complete */
+    uint32_t au32Arg[DEBUG_LOG_MAX_ARGS];
+} S_DEBUG_LOG_T;
+
+static S_DEBUG_LOG_T s_asDebugLog[DEBUG_LOG_ENTRIES];
+static volatile uint32_t s_u32DebugLogHead = 0;     /* Next record to reserve */
+static volatile uint32_t s_u32DebugLogTail = 0;     /* Next record to format */
+static volatile uint32_t s_u32DebugLogDrop = 0;
+static uint32_t s_u32DebugLogDropShown = 0;
+static char s_acDebugLogLine[DEBUG_LOG_LINE_SIZE];
+static uint32_t s_u32DebugLogPos = 0;
+static uint32_t s_u32DebugLogLen = 0;
+static uint32_t s_u32DebugLogCr = 0;
+
+/**
+ * @brief      Queue a log record
+ *
+ * @param[in]  u32Argc  Number of 32-bit arguments following pcFmt, up to DEBUG_LOG_MAX_ARGS.
+ * @param[in]  pcFmt    printf format string. It must stay valid until the record is sent.
+ *
+ * @retval     0   The record is queued.
+ * @retval     -1  The queue is full. The record is counted as dropped.
+ *
+ * @details    Only the format string pointer and the raw arguments are stored, so this can be called
+ *             from any interrupt handler. Interrupts are masked just while a record is reserved.
+ *             Use DEBUG_LOG() instead of calling this function directly.
+ */
+int32_t DEBUG_LogWrite(uint32_t u32Argc, const char *pcFmt, ...)
+{
+    S_DEBUG_LOG_T *psLog;
+    va_list args;
+    uint32_t u32Primask, u32Head, i;
+
+    if(u32Argc > DEBUG_LOG_MAX_ARGS)
+        u32Argc = DEBUG_LOG_MAX_ARGS;
+
+    u32Primask = __get_PRIMASK();
+    __disable_irq();
+    u32Head = s_u32DebugLogHead;
+    if(u32Head - s_u32DebugLogTail >= DEBUG_LOG_ENTRIES)
+    {
+        s_u32DebugLogDrop++;
+        __set_PRIMASK(u32Primask);
+        return -1;
+    }
+    s_u32DebugLogHead = u32Head + 1;
+    __set_PRIMASK(u32Primask);
+
+    psLog = &s_asDebugLog[u32Head & (DEBUG_LOG_ENTRIES - 1)];
+    psLog->pcFmt = pcFmt;
+    va_start(args, pcFmt);
+    for(i = 0; i < u32Argc; i++)
+        psLog->au32Arg[i] = va_arg(args, uint32_t);
+    va_end(args);
+    psLog->u32Argc = u32Argc | DEBUG_LOG_READY;
+
+    /* Kick the drain */
+    u32Primask = __get_PRIMASK();
+    __disable_irq();
+    DEBUG_PORT->INTEN |= UART_INTEN_THREIEN_Msk;
+    __set_PRIMASK(u32Primask);
+
+    return 0;
+}
+
+/**
+ * @brief      Check if there is anything left to format
+ *
+ * @param      None
+ *
+ * @retval     1  The next record is complete, or a drop notice is waiting.
+ * @retval     0  Nothing to format.
+ */
+static int32_t DEBUG_LogPending(void)
+{
+    uint32_t u32Tail = s_u32DebugLogTail;
+
+    if(u32Tail != s_u32DebugLogHead)
+        return ((s_asDebugLog[u32Tail & (DEBUG_LOG_ENTRIES - 1)].u32Argc & DEBUG_LOG_READY) != 0U);
+
+    return (s_u32DebugLogDrop != s_u32DebugLogDropShown);
+}
+
+/**
+ * @brief      Format the next record into the line buffer
+ *
+ * @param      None
+ *
+ * @retval     1  The line buffer is refilled.
+ * @retval     0  Nothing to format.
+ *
+ * @details    Records are formatted in order. A record which is reserved but not yet complete stops
+ *             the drain until its writer finishes it. Dropped records are reported once the queue
+ *             is empty.
+ */
+static int32_t DEBUG_LogFormat(void)
+{
+    S_DEBUG_LOG_T *psLog;
+    uint32_t u32Tail = s_u32DebugLogTail;
+    uint32_t u32Drop;
+    int32_t i32Len;
+
+    psLog = &s_asDebugLog[u32Tail & (DEBUG_LOG_ENTRIES - 1)];
+    if(u32Tail != s_u32DebugLogHead)
+    {
+        if((psLog->u32Argc & DEBUG_LOG_READY) == 0)
+            return 0;
+
+        i32Len = snprintf(s_acDebugLogLine, sizeof(s_acDebugLogLine), psLog->pcFmt,
+                          psLog->au32Arg[0], psLog->au32Arg[1], psLog->au32Arg[2],
+                          psLog->au32Arg[3], psLog->au32Arg[4], psLog->au32Arg[5]);
+        psLog->u32Argc = 0;
+        s_u32DebugLogTail = u32Tail + 1;
+    }
+    else
+    {
+        u32Drop = s_u32DebugLogDrop;
+        if(u32Drop == s_u32DebugLogDropShown)
+            return 0;
+
+        i32Len = snprintf(s_acDebugLogLine, sizeof(s_acDebugLogLine), "[log] %u dropped\n",
+                          (unsigned int)(u32Drop - s_u32DebugLogDropShown));
+        s_u32DebugLogDropShown = u32Drop;
+    }
+
+    if(i32Len < 0)
+        i32Len = 0;
+    else if(i32Len >= (int32_t)sizeof(s_acDebugLogLine))
+        i32Len = sizeof(s_acDebugLogLine) - 1;
+
+    s_u32DebugLogPos = 0;
+    s_u32DebugLogLen = (uint32_t)i32Len;
+
+    return 1;
+}
+
+/**
+ * @brief      Move formatted log output to the TX FIFO of debug port
+ *
+ * @param      None
+ *
+ * @return     None
+ *
+ * @details    Stops when the TX FIFO is full or there is nothing more to send. '\n' is sent as "\r\n".
+ */
+static void DEBUG_LogFeed(void)
+{
+    char c;
+
+    while((DEBUG_PORT->FIFOSTS & UART_FIFOSTS_TXFULL_Msk) == 0U)
+    {
+        if(s_u32DebugLogPos == s_u32DebugLogLen)
+        {
+            if(DEBUG_LogFormat() == 0)
+                break;
+            continue;
+        }
+
+        c = s_acDebugLogLine[s_u32DebugLogPos];
+        if((c == '\n') && (s_u32DebugLogCr == 0U))
+        {
+            DEBUG_PORT->DAT = '\r';
+            s_u32DebugLogCr = 1;
+            continue;
+        }
+
+        DEBUG_PORT->DAT = (uint32_t)c;
+        s_u32DebugLogCr = 0;
+        s_u32DebugLogPos++;
+    }
+}
+
+/**
+ * @brief      Drain queued log records
+ *
+ * @param      None
+ *
+ * @return     None
+ *
+ * @details    Call this from the interrupt handler of DEBUG_PORT, e.g. UART02_IRQHandler for UART0.
+ *             The handler should have the lowest priority since the records are formatted here.
+ *             The THRE interrupt is disabled when everything is sent and re-enabled by DEBUG_LogWrite().
+ */
+void DEBUG_LogIRQHandler(void)
+{
+    uint32_t u32Primask;
+
+    if((DEBUG_PORT->INTSTS & UART_INTSTS_THREINT_Msk) == 0U)
+        return;
+
+    DEBUG_LogFeed();
+
+    if(s_u32DebugLogPos == s_u32DebugLogLen)
+    {
+        u32Primask = __get_PRIMASK();
+        __disable_irq();
+        if(DEBUG_LogPending() == 0)
+            DEBUG_PORT->INTEN &= ~UART_INTEN_THREIEN_Msk;
+        __set_PRIMASK(u32Primask);
+    }
+}
+
+/**
+ * @brief      Send all queued log records
+ *
+ * @param      None
+ *
+ * @return     None
+ *
+ * @details    Formats and sends the whole queue with interrupts masked, then waits for the TX FIFO to
+ *             become empty. It is meant for use before entering power-down or reset, or in fault handlers.
+ */
+void DEBUG_LogFlush(void)
+{
+    uint32_t u32Primask;
+
+    u32Primask = __get_PRIMASK();
+    __disable_irq();
+    while((s_u32DebugLogPos != s_u32DebugLogLen) || DEBUG_LogPending())
+        DEBUG_LogFeed();
+    DEBUG_PORT->INTEN &= ~UART_INTEN_THREIEN_Msk;
+    __set_PRIMASK(u32Primask);
+
+    while((DEBUG_PORT->FIFOSTS & UART_FIFOSTS_TXEMPTYF_Msk) == 0U) {}
+}
+
+/**
+ * @brief      Get the number of dropped log records
+ *
+ * @param      None
+ *
+ * @return     Number of records DEBUG_LogWrite() dropped because the queue was full.
+ */
+uint32_t DEBUG_LogGetDropCount(void)
+{
+    return s_u32DebugLogDrop;
+}
+
+#endif /* defined(DEBUG_ENABLE_LOG) */
+
 /**
  * @brief    Routine to get a char
  *
@@ -780,6 +780,355 @@ static uint32_t SPII2S_GetSourceClockFreq(SPI_T *i2s)
     return u32Freq;
 }
 
+#define SPI_FIFO_DEPTH      4       /* TX and RX FIFO levels */
+
+static S_SPI_ASYNC_T *s_apsSpiAsync[SPI_ASYNC_NUM];
+
+static void SPI_AsyncStart(SPI_T *spi, S_SPI_ASYNC_T *psAsync);
+
+static uint32_t SPI_GetIndex(SPI_T *spi)
+{
+    return (spi == SPI0) ? 0 : 1;
+}
+
+/* Complete the transfer on the bus and start the next queued one */
+static void SPI_AsyncFinish(SPI_T *spi, S_SPI_ASYNC_T *psAsync, int32_t i32Status)
+{
+    S_SPI_XFER_T *psXfer = psAsync->psHead;
+    S_SPI_XFER_T *psNext = psXfer->psNext;
+
+    if(!(psXfer->u32Flags & (SPI_XFER_KEEP_SS | SPI_XFER_NO_SS)))
+        spi->SSCTL &= ~SPI_SSCTL_SS_Msk;
+
+    psAsync->psHead = psNext;
+    if(psNext == NULL)
+        psAsync->psTail = NULL;
+    psXfer->i32Status = i32Status;
+    if(psXfer->pfnCallback != NULL)
+        psXfer->pfnCallback(psXfer);
+
+    /* A transfer queued by the callback on an empty queue has been started by SPI_TransferIRQ/SPI_TransferDMA */
+    if(psNext != NULL)
+        SPI_AsyncStart(spi, psAsync);
+}
+
+/* Move received units out of RX FIFO and refill TX FIFO, returns 1 when the transfer is complete */
+static uint32_t SPI_AsyncPump(SPI_T *spi, S_SPI_ASYNC_T *psAsync)
+{
+    S_SPI_XFER_T *psXfer = psAsync->psHead;
+    uint32_t u32Rx = psXfer->u32RxCount, u32Tx = psXfer->u32TxCount, u32Len = psXfer->u32Len;
+    uint32_t u32Unit = psAsync->u32Unit, u32Cnt, u32Data, u32Out;
+
+    for(u32Cnt = SPI_GET_RX_FIFO_COUNT(spi); u32Cnt && (u32Rx < u32Tx); u32Cnt--, u32Rx++)
+    {
+        u32Data = SPI_READ_RX(spi);
+        if(psXfer->pvRxBuf == NULL)
+            continue;
+        if(u32Unit == 1)
+            ((uint8_t *)psXfer->pvRxBuf)[u32Rx] = (uint8_t)u32Data;
+        else if(u32Unit == 2)
+            ((uint16_t *)psXfer->pvRxBuf)[u32Rx] = (uint16_t)u32Data;
+        else
+            ((uint32_t *)psXfer->pvRxBuf)[u32Rx] = u32Data;
+    }
+
+    /* At most SPI_FIFO_DEPTH units in flight, so RX FIFO cannot overrun while the interrupt is pending */
+    for(; (u32Tx < u32Len) && ((u32Tx - u32Rx) < SPI_FIFO_DEPTH); u32Tx++)
+    {
+        if(psXfer->pvTxBuf == NULL)
+            u32Data = 0xFFFFFFFF;
+        else if(u32Unit == 1)
+            u32Data = ((const uint8_t *)psXfer->pvTxBuf)[u32Tx];
+        else if(u32Unit == 2)
+            u32Data = ((const uint16_t *)psXfer->pvTxBuf)[u32Tx];
+        else
+            u32Data = ((const uint32_t *)psXfer->pvTxBuf)[u32Tx];
+        SPI_WRITE_TX(spi, u32Data);
+    }
+
+    psXfer->u32RxCount = u32Rx;
+    psXfer->u32TxCount = u32Tx;
+
+    u32Out = u32Tx - u32Rx;
+    if(u32Out == 0)
+    {
+        spi->FIFOCTL &= ~SPI_FIFOCTL_RXTHIEN_Msk;
+        return 1;
+    }
+
+    /* Interrupt once all but the last unit in flight are received, the bus keeps shifting meanwhile */
+    spi->FIFOCTL = (spi->FIFOCTL & ~SPI_FIFOCTL_RXTH_Msk) | (((u32Out >= 2) ? (u32Out - 2) : 0) << SPI_FIFOCTL_RXTH_Pos) |
+                   SPI_FIFOCTL_RXTHIEN_Msk;
+    return 0;
+}
+
+/* Hand the next block of up to SPI_DMA_MAX_LEN units to the PDMA channels */
+static void SPI_AsyncStartDMA(SPI_T *spi, S_SPI_ASYNC_T *psAsync)
+{
+    S_SPI_XFER_T *psXfer = psAsync->psHead;
+    uint32_t u32TxCh = (uint32_t)psAsync->i32TxCh, u32RxCh = (uint32_t)psAsync->i32RxCh;
+    uint32_t u32Idx = SPI_GetIndex(spi), u32Unit = psAsync->u32Unit;
+    uint32_t u32Len = psXfer->u32Len - psXfer->u32RxCount, u32Width;
+
+    if(u32Len > SPI_DMA_MAX_LEN)
+        u32Len = SPI_DMA_MAX_LEN;
+    u32Width = (u32Unit == 1) ? PDMA_WIDTH_8 : ((u32Unit == 2) ? PDMA_WIDTH_16 : PDMA_WIDTH_32);
+
+    SPI_DISABLE_TX_RX_PDMA(spi);
+
+    PDMA_SetTransferCnt(u32RxCh, u32Width, u32Len);
+    if(psXfer->pvRxBuf != NULL)
+        PDMA_SetTransferAddr(u32RxCh, (uint32_t)&spi->RX, PDMA_SAR_FIX, (uint32_t)psXfer->pvRxBuf + psXfer->u32RxCount * u32Unit, PDMA_DAR_INC);
+    else
+        PDMA_SetTransferAddr(u32RxCh, (uint32_t)&spi->RX, PDMA_SAR_FIX, (uint32_t)&psAsync->u32RxSink, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(u32RxCh, PDMA_SPI0_RX + u32Idx * 2, FALSE, 0);
+    PDMA_SetBurstType(u32RxCh, PDMA_REQ_SINGLE, 0);
+
+    PDMA_SetTransferCnt(u32TxCh, u32Width, u32Len);
+    if(psXfer->pvTxBuf != NULL)
+        PDMA_SetTransferAddr(u32TxCh, (uint32_t)psXfer->pvTxBuf + psXfer->u32TxCount * u32Unit, PDMA_SAR_INC, (uint32_t)&spi->TX, PDMA_DAR_FIX);
+    else
+        PDMA_SetTransferAddr(u32TxCh, (uint32_t)&psAsync->u32TxFill, PDMA_SAR_FIX, (uint32_t)&spi->TX, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(u32TxCh, PDMA_SPI0_TX + u32Idx * 2, FALSE, 0);
+    PDMA_SetBurstType(u32TxCh, PDMA_REQ_SINGLE, 0);
+
+    psXfer->u32TxCount += u32Len;
+
+    /* RX request first, so no received unit is missed */
+    SPI_TRIGGER_RX_PDMA(spi);
+    SPI_TRIGGER_TX_PDMA(spi);
+}
+
+/* PDMA RX channel callback, the block is complete when its last unit is received */
+static void SPI_AsyncDMADone(uint32_t u32Ch, uint32_t u32Event)
+{
+    S_SPI_ASYNC_T *psAsync;
+    S_SPI_XFER_T *psXfer;
+    SPI_T *spi;
+    uint32_t i;
+
+    for(i = 0; i < SPI_ASYNC_NUM; i++)
+    {
+        psAsync = s_apsSpiAsync[i];
+        if((psAsync != NULL) && (psAsync->i32RxCh == (int32_t)u32Ch))
+            break;
+    }
+    if(i == SPI_ASYNC_NUM)
+        return;
+
+    spi = (i == 0) ? SPI0 : SPI1;
+    psXfer = psAsync->psHead;
+    if((psXfer == NULL) || !(psXfer->u32Flags & SPI_XFER_DMA))
+        return;
+
+    SPI_DISABLE_TX_RX_PDMA(spi);
+    if(u32Event & PDMA_EVENT_ABORT)
+    {
+        SPI_ClearTxFIFO(spi);
+        SPI_AsyncFinish(spi, psAsync, -1);
+        return;
+    }
+
+    psXfer->u32RxCount = psXfer->u32TxCount;
+    if(psXfer->u32RxCount < psXfer->u32Len)
+        SPI_AsyncStartDMA(spi, psAsync);
+    else
+        SPI_AsyncFinish(spi, psAsync, 0);
+}
+
+/* Select the slave and start the transfer at the queue head */
+static void SPI_AsyncStart(SPI_T *spi, S_SPI_ASYNC_T *psAsync)
+{
+    S_SPI_XFER_T *psXfer = psAsync->psHead;
+    uint32_t u32Width = (spi->CTL & SPI_CTL_DWIDTH_Msk) >> SPI_CTL_DWIDTH_Pos;
+
+    psAsync->u32Unit = ((u32Width == 0) || (u32Width > 16)) ? 4 : ((u32Width > 8) ? 2 : 1);
+
+    if(!(psXfer->u32Flags & SPI_XFER_NO_SS))
+        spi->SSCTL = (spi->SSCTL & ~(SPI_SSCTL_AUTOSS_Msk | SPI_SSCTL_SSACTPOL_Msk)) | psAsync->u32SSLevel | SPI_SSCTL_SS_Msk;
+
+    if(psXfer->u32Flags & SPI_XFER_DMA)
+        SPI_AsyncStartDMA(spi, psAsync);
+    else
+        SPI_AsyncPump(spi, psAsync);
+}
+
+static int32_t SPI_AsyncSubmit(SPI_T *spi, S_SPI_XFER_T *psXfer, uint32_t u32Dma)
+{
+    S_SPI_ASYNC_T *psAsync = s_apsSpiAsync[SPI_GetIndex(spi)];
+    uint32_t u32Primask;
+
+    if((psAsync == NULL) || (psXfer->u32Len == 0) || (u32Dma && (psAsync->i32RxCh < 0)))
+        return -1;
+
+    psXfer->psNext = NULL;
+    psXfer->u32Flags = (psXfer->u32Flags & ~SPI_XFER_DMA) | u32Dma;
+    psXfer->u32TxCount = 0;
+    psXfer->u32RxCount = 0;
+    psXfer->i32Status = SPI_XFER_PENDING;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    if(psAsync->psHead == NULL)
+    {
+        psAsync->psHead = psXfer;
+        psAsync->psTail = psXfer;
+        SPI_AsyncStart(spi, psAsync);
+    }
+    else
+    {
+        psAsync->psTail->psNext = psXfer;
+        psAsync->psTail = psXfer;
+    }
+    __set_PRIMASK(u32Primask);
+
+    return 0;
+}
+
+/**
+  * @brief  Start queued transfers on SPI.
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @param[in]  psAsync Control block. It must stay valid until SPI_CloseAsync is called.
+  * @param[in]  u32ActiveLevel Slave select active level. Valid values are \ref SPI_SS_ACTIVE_LOW and \ref SPI_SS_ACTIVE_HIGH.
+  * @param[in]  u32UseDMA 1 to take two PDMA channels for \ref SPI_TransferDMA, 0 for \ref SPI_TransferIRQ only.
+  * @retval 0 Success.
+  * @retval -1 No free PDMA channel.
+  * @details SPI must be opened in master mode by SPI_Open before. Automatic slave select is disabled, the driver
+  *          drives SPIx_SS for each transfer instead, so it stays active while the FIFO waits for the interrupt.
+  *          The application SPI0_IRQHandler or SPI1_IRQHandler has to call SPI_AsyncIRQHandler and the NVIC SPI IRQ
+  *          must be enabled for \ref SPI_TransferIRQ. PDMA clock must be enabled and PDMA_IRQHandler has to call
+  *          PDMA_ChannelIRQHandler for \ref SPI_TransferDMA.
+  */
+int32_t SPI_OpenAsync(SPI_T *spi, S_SPI_ASYNC_T *psAsync, uint32_t u32ActiveLevel, uint32_t u32UseDMA)
+{
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+    psAsync->i32TxCh = -1;
+    psAsync->i32RxCh = -1;
+    psAsync->u32SSLevel = u32ActiveLevel;
+    psAsync->u32TxFill = 0xFFFFFFFF;
+
+    if(u32UseDMA)
+    {
+        psAsync->i32RxCh = PDMA_RequestChannel(PDMA_CH_ANY, SPI_AsyncDMADone);
+        psAsync->i32TxCh = PDMA_RequestChannel(PDMA_CH_ANY, NULL);
+        if((psAsync->i32RxCh < 0) || (psAsync->i32TxCh < 0))
+        {
+            if(psAsync->i32RxCh >= 0)
+                PDMA_ReleaseChannel((uint32_t)psAsync->i32RxCh);
+            if(psAsync->i32TxCh >= 0)
+                PDMA_ReleaseChannel((uint32_t)psAsync->i32TxCh);
+            return -1;
+        }
+    }
+
+    SPI_DisableAutoSS(spi);
+    spi->SSCTL = (spi->SSCTL & ~SPI_SSCTL_SSACTPOL_Msk) | u32ActiveLevel;
+    SPI_ClearRxFIFO(spi);
+    s_apsSpiAsync[SPI_GetIndex(spi)] = psAsync;
+
+    return 0;
+}
+
+/**
+  * @brief  Stop queued transfers on SPI.
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @return None
+  * @details The transfer on the bus is dropped and slave select is released. Queued transfers are completed with
+  *          status -1 without calling their callback. PDMA channels taken by SPI_OpenAsync are freed.
+  */
+void SPI_CloseAsync(SPI_T *spi)
+{
+    S_SPI_ASYNC_T *psAsync = s_apsSpiAsync[SPI_GetIndex(spi)];
+    S_SPI_XFER_T *psXfer;
+
+    if(psAsync == NULL)
+        return;
+
+    s_apsSpiAsync[SPI_GetIndex(spi)] = NULL;
+    spi->FIFOCTL &= ~SPI_FIFOCTL_RXTHIEN_Msk;
+    SPI_DISABLE_TX_RX_PDMA(spi);
+    if(psAsync->i32RxCh >= 0)
+        PDMA_ReleaseChannel((uint32_t)psAsync->i32RxCh);
+    if(psAsync->i32TxCh >= 0)
+        PDMA_ReleaseChannel((uint32_t)psAsync->i32TxCh);
+    SPI_ClearTxFIFO(spi);
+    SPI_ClearRxFIFO(spi);
+    spi->SSCTL &= ~SPI_SSCTL_SS_Msk;
+
+    for(psXfer = psAsync->psHead; psXfer != NULL; psXfer = psXfer->psNext)
+        psXfer->i32Status = -1;
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+}
+
+/**
+  * @brief  Queue a full-duplex transfer moved by the SPI FIFO threshold interrupt.
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @param[in]  psXfer Transfer descriptor. pvTxBuf, pvRxBuf, u32Len, u32Flags, pfnCallback and pvArg must be set.
+  *                    It must stay valid until the transfer is done.
+  * @retval 0 Transfer is queued.
+  * @retval -1 SPI_OpenAsync was not called or u32Len is 0.
+  * @details This function never waits. The transfer starts at once if no other is queued. Up to 4 data units are kept
+  *          in flight and the RX threshold is moved so that the interrupt comes one unit before the FIFO runs dry.
+  *          i32Status stays \ref SPI_XFER_PENDING until the last unit is received, then the callback is called from
+  *          the interrupt. Suits short transfers; \ref SPI_TransferDMA keeps the bus busy at high bus clock.
+  *          Can be called from a transfer callback.
+  */
+int32_t SPI_TransferIRQ(SPI_T *spi, S_SPI_XFER_T *psXfer)
+{
+    return SPI_AsyncSubmit(spi, psXfer, 0);
+}
+
+/**
+  * @brief  Queue a full-duplex transfer moved by PDMA.
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @param[in]  psXfer Transfer descriptor. pvTxBuf, pvRxBuf, u32Len, u32Flags, pfnCallback and pvArg must be set.
+  *                    It must stay valid until the transfer is done.
+  * @retval 0 Transfer is queued.
+  * @retval -1 SPI_OpenAsync was not called with PDMA or u32Len is 0.
+  * @details This function never waits. TX and RX PDMA channels move the data in blocks of up to
+  *          \ref SPI_DMA_MAX_LEN units, the CPU only runs at the end of each block. A missing TX buffer sends all ones
+  *          and a missing RX buffer drops the data. Can be called from a transfer callback.
+  */
+int32_t SPI_TransferDMA(SPI_T *spi, S_SPI_XFER_T *psXfer)
+{
+    return SPI_AsyncSubmit(spi, psXfer, SPI_XFER_DMA);
+}
+
+/**
+  * @brief  Check if queued SPI transfers are pending.
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @retval 0 No transfer is queued.
+  * @retval 1 A transfer is on the bus or queued.
+  */
+uint32_t SPI_IsAsyncBusy(SPI_T *spi)
+{
+    S_SPI_ASYNC_T *psAsync = s_apsSpiAsync[SPI_GetIndex(spi)];
+
+    return ((psAsync != NULL) && (psAsync->psHead != NULL)) ? 1 : 0;
+}
+
+/**
+  * @brief  SPI interrupt handler for transfers queued by SPI_TransferIRQ.
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @return None
+  * @details Reads the received units, refills TX FIFO and completes the transfer once all units are received.
+  */
+void SPI_AsyncIRQHandler(SPI_T *spi)
+{
+    S_SPI_ASYNC_T *psAsync = s_apsSpiAsync[SPI_GetIndex(spi)];
+
+    if((psAsync == NULL) || (psAsync->psHead == NULL) || (psAsync->psHead->u32Flags & SPI_XFER_DMA))
+    {
+        spi->FIFOCTL &= ~SPI_FIFOCTL_RXTHIEN_Msk;
+        return;
+    }
+
+    if(SPI_AsyncPump(spi, psAsync))
+        SPI_AsyncFinish(spi, psAsync, 0);
+}
+
 /**
   * @brief  This function configures some parameters of SPII2S interface for general purpose use.
   * @param[in] i2s The pointer of the specified SPII2S module.
@@ -420,6 +420,378 @@ int32_t TIMER_ResetCounter(TIMER_T *timer)
     return TIMER_OK;
 }
 
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Software timer wheel                                                                                   */
+/*---------------------------------------------------------------------------------------------------------*/
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_SPAN        (1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))    /* Ticks covered by the wheel */
+#define TIMER_WHEEL_EXPIRED     (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)           /* Slot number of the expired list */
+#define TIMER_WHEEL_HW_MASK     0xFFFFFFUL                                          /* 24-bit hardware counter */
+#define TIMER_WHEEL_MAX_SLEEP   0x7FFFFFUL                                          /* Longest compare distance, keeps the counter wrap visible */
+
+static S_TIMER_WHEEL_T *s_apsTimerWheel[4];
+
+static uint32_t TIMER_GetIndex(TIMER_T *timer)
+{
+    if(timer == TIMER0)
+        return 0;
+    else if(timer == TIMER1)
+        return 1;
+    else if(timer == TIMER2)
+        return 2;
+    else
+        return 3;
+}
+
+/* Index of the lowest set bit of a non-zero word, Cortex-M0 has no CLZ or RBIT */
+static uint32_t TIMER_WheelCtz(uint32_t u32Val)
+{
+    static const uint8_t au8Pos[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+
+    return au8Pos[(uint32_t)((u32Val & (0 - u32Val)) * 0x077CB531UL) >> 27];
+}
+
+/* Hardware counter extended to 32 bits, must be called at least once per counter wrap */
+static uint32_t TIMER_WheelHwTick(S_TIMER_WHEEL_T *psWheel)
+{
+    uint32_t u32Cnt = psWheel->psTimer->CNT & TIMER_WHEEL_HW_MASK;
+
+    if(u32Cnt < (psWheel->u32HwTick & TIMER_WHEEL_HW_MASK))
+        psWheel->u32HwTick += TIMER_WHEEL_HW_MASK + 1;
+    psWheel->u32HwTick = (psWheel->u32HwTick & ~TIMER_WHEEL_HW_MASK) | u32Cnt;
+
+    return psWheel->u32HwTick;
+}
+
+static void TIMER_WheelLink(S_TIMER_WHEEL_T *psWheel, S_TIMER_SW_T *psTimer)
+{
+    uint32_t u32Expire = psTimer->u32Expire, u32Delta, u32Level, u32Idx, u32Slot;
+
+    u32Delta = u32Expire - psWheel->u32Now;
+    if((int32_t)u32Delta < 0)
+    {
+        /* Overdue, run at the next tick processed */
+        u32Expire = psWheel->u32Now;
+        u32Delta = 0;
+    }
+    else if(u32Delta >= TIMER_WHEEL_SPAN)
+    {
+        /* Beyond the wheel, park in the top level and cascade again when the slot comes around */
+        u32Expire = psWheel->u32Now + TIMER_WHEEL_SPAN - 1;
+        u32Delta = TIMER_WHEEL_SPAN - 1;
+    }
+
+    for(u32Level = 0; u32Level < (TIMER_WHEEL_LEVELS - 1); u32Level++)
+    {
+        if(u32Delta < (1UL << (TIMER_WHEEL_BITS * (u32Level + 1))))
+            break;
+    }
+    u32Idx = (u32Expire >> (TIMER_WHEEL_BITS * u32Level)) & TIMER_WHEEL_MASK;
+    u32Slot = u32Level * TIMER_WHEEL_SLOTS + u32Idx;
+
+    psTimer->u32Slot = u32Slot;
+    psTimer->psNext = psWheel->apsSlot[u32Slot];
+    if(psTimer->psNext)
+        psTimer->psNext->ppsPrev = &psTimer->psNext;
+    psTimer->ppsPrev = &psWheel->apsSlot[u32Slot];
+    psWheel->apsSlot[u32Slot] = psTimer;
+    psWheel->au32Map[u32Level] |= (1UL << u32Idx);
+}
+
+static void TIMER_WheelUnlink(S_TIMER_WHEEL_T *psWheel, S_TIMER_SW_T *psTimer)
+{
+    uint32_t u32Slot = psTimer->u32Slot;
+
+    *psTimer->ppsPrev = psTimer->psNext;
+    if(psTimer->psNext)
+        psTimer->psNext->ppsPrev = psTimer->ppsPrev;
+    psTimer->ppsPrev = NULL;
+
+    if((u32Slot != TIMER_WHEEL_EXPIRED) && (psWheel->apsSlot[u32Slot] == NULL))
+        psWheel->au32Map[u32Slot / TIMER_WHEEL_SLOTS] &= ~(1UL << (u32Slot & TIMER_WHEEL_MASK));
+}
+
+/* First tick from u32Now on at which a level 0 slot expires or a higher level slot cascades */
+static uint32_t TIMER_WheelNextEvent(S_TIMER_WHEEL_T *psWheel)
+{
+    uint32_t u32Next = psWheel->u32Now + TIMER_WHEEL_MAX_SLEEP;
+    uint32_t u32Level, u32Shift, u32Base, u32Idx, u32Map, u32Tick;
+
+    for(u32Level = 0; u32Level < TIMER_WHEEL_LEVELS; u32Level++)
+    {
+        u32Map = psWheel->au32Map[u32Level];
+        if(u32Map == 0)
+            continue;
+
+        /* First boundary of this level not processed yet, in units of the level slot size */
+        u32Shift = TIMER_WHEEL_BITS * u32Level;
+        u32Base = (psWheel->u32Now + (1UL << u32Shift) - 1) >> u32Shift;
+        u32Idx = u32Base & TIMER_WHEEL_MASK;
+
+        /* Rotate the bitmap so that bit 0 is the slot of that boundary */
+        if(u32Idx)
+            u32Map = (u32Map >> u32Idx) | (u32Map << (TIMER_WHEEL_SLOTS - u32Idx));
+        u32Tick = (u32Base + TIMER_WheelCtz(u32Map)) << u32Shift;
+
+        if((int32_t)(u32Tick - u32Next) < 0)
+            u32Next = u32Tick;
+    }
+
+    return u32Next;
+}
+
+/* Process tick u32Now: cascade the levels that wrap at it, then run the timers due. Called with
+   interrupts masked, u32Primask is restored only while a callback runs. */
+static void TIMER_WheelRunTick(S_TIMER_WHEEL_T *psWheel, uint32_t u32Primask)
+{
+    uint32_t u32Tick = psWheel->u32Now, u32Level, u32Slot;
+    S_TIMER_SW_T *psList, *psTimer;
+
+    for(u32Level = 1; u32Level < TIMER_WHEEL_LEVELS; u32Level++)
+    {
+        if(u32Tick & ((1UL << (TIMER_WHEEL_BITS * u32Level)) - 1))
+            break;
+
+        u32Slot = u32Level * TIMER_WHEEL_SLOTS + ((u32Tick >> (TIMER_WHEEL_BITS * u32Level)) & TIMER_WHEEL_MASK);
+        psList = psWheel->apsSlot[u32Slot];
+        psWheel->apsSlot[u32Slot] = NULL;
+        psWheel->au32Map[u32Level] &= ~(1UL << (u32Slot & TIMER_WHEEL_MASK));
+        while(psList)
+        {
+            psTimer = psList;
+            psList = psList->psNext;
+            TIMER_WheelLink(psWheel, psTimer);
+        }
+    }
+
+    /* Move the due timers to the expired list, a callback may stop or restart any of them */
+    u32Slot = u32Tick & TIMER_WHEEL_MASK;
+    psWheel->psExpired = psWheel->apsSlot[u32Slot];
+    psWheel->apsSlot[u32Slot] = NULL;
+    psWheel->au32Map[0] &= ~(1UL << u32Slot);
+    for(psTimer = psWheel->psExpired; psTimer != NULL; psTimer = psTimer->psNext)
+        psTimer->u32Slot = TIMER_WHEEL_EXPIRED;
+    if(psWheel->psExpired)
+        psWheel->psExpired->ppsPrev = &psWheel->psExpired;
+    psWheel->u32Now = u32Tick + 1;
+
+    while((psTimer = psWheel->psExpired) != NULL)
+    {
+        TIMER_WheelUnlink(psWheel, psTimer);
+        if(psTimer->u32Period)
+        {
+            psTimer->u32Expire += psTimer->u32Period;
+            TIMER_WheelLink(psWheel, psTimer);
+        }
+        __set_PRIMASK(u32Primask);
+        psTimer->pfnCallback(psTimer->pvArg);
+        __set_PRIMASK(1);
+    }
+}
+
+/* Set the compare register to the deadline, returns 0 if the counter has already passed it */
+static uint32_t TIMER_WheelSetDeadline(S_TIMER_WHEEL_T *psWheel, uint32_t u32Deadline)
+{
+    uint32_t u32Cmp = u32Deadline & TIMER_WHEEL_HW_MASK;
+
+    psWheel->u32Deadline = u32Deadline;
+    psWheel->psTimer->CMP = (u32Cmp < 2) ? 2 : u32Cmp;
+
+    return ((int32_t)(u32Deadline - TIMER_WheelHwTick(psWheel)) > 0) ? 1 : 0;
+}
+
+/**
+  * @brief      Start software timer service on a hardware timer
+  *
+  * @param[in]  timer       The pointer of the specified Timer module. It could be TIMER0, TIMER1, TIMER2, TIMER3.
+  * @param[in]  psWheel     The pointer of the wheel control block. Must stay valid until \ref TIMER_CloseWheel.
+  * @param[in]  u32TickFreq Target software timer tick frequency in Hz.
+  *
+  * @return     Real tick frequency, 0 if the timer clock cannot be divided down to u32TickFreq
+  *
+  * @details    The timer counts ticks in continuous counting mode and the compare interrupt is only set up
+  *             for the next tick at which a software timer is due, so an idle wheel costs one interrupt
+  *             every 2^23 ticks. User must enable the timer NVIC interrupt and call
+  *             \ref TIMER_WheelIRQHandler from the timer IRQ handler.
+  */
+uint32_t TIMER_OpenWheel(TIMER_T *timer, S_TIMER_WHEEL_T *psWheel, uint32_t u32TickFreq)
+{
+    uint32_t u32Clk = TIMER_GetModuleClock(timer);
+    uint32_t u32Prescale, i;
+
+    if((u32TickFreq == 0) || (u32TickFreq > u32Clk))
+        return 0;
+    u32Prescale = (u32Clk + u32TickFreq / 2) / u32TickFreq;
+    if(u32Prescale > 256)
+        return 0;
+
+    for(i = 0; i < TIMER_WHEEL_LEVELS; i++)
+        psWheel->au32Map[i] = 0;
+    for(i = 0; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++)
+        psWheel->apsSlot[i] = NULL;
+    psWheel->psExpired = NULL;
+    psWheel->psTimer = timer;
+
+    timer->CTL = 0;
+    timer->CMP = TIMER_WHEEL_MAX_SLEEP;
+    timer->INTSTS = TIMER_INTSTS_TIF_Msk | TIMER_INTSTS_TWKF_Msk;
+    timer->CTL = TIMER_CONTINUOUS_MODE | (u32Prescale - 1) | TIMER_CTL_INTEN_Msk | TIMER_CTL_CNTEN_Msk;
+
+    psWheel->u32HwTick = timer->CNT & TIMER_WHEEL_HW_MASK;
+    psWheel->u32Now = psWheel->u32HwTick;
+    TIMER_WheelSetDeadline(psWheel, psWheel->u32Now + TIMER_WHEEL_MAX_SLEEP);
+
+    s_apsTimerWheel[TIMER_GetIndex(timer)] = psWheel;
+
+    return u32Clk / u32Prescale;
+}
+
+/**
+  * @brief      Stop software timer service
+  *
+  * @param[in]  timer       The pointer of the specified Timer module. It could be TIMER0, TIMER1, TIMER2, TIMER3.
+  *
+  * @return     None
+  *
+  * @details    Stops the hardware timer. Software timers still armed are not called anymore.
+  */
+void TIMER_CloseWheel(TIMER_T *timer)
+{
+    timer->CTL = 0;
+    timer->INTSTS = TIMER_INTSTS_TIF_Msk | TIMER_INTSTS_TWKF_Msk;
+    s_apsTimerWheel[TIMER_GetIndex(timer)] = NULL;
+}
+
+/**
+  * @brief      Get current software timer tick
+  *
+  * @param[in]  psWheel     The pointer of the wheel control block.
+  *
+  * @return     Ticks counted since \ref TIMER_OpenWheel, wraps at 2^32
+  */
+uint32_t TIMER_GetWheelTick(S_TIMER_WHEEL_T *psWheel)
+{
+    uint32_t u32Primask = __get_PRIMASK(), u32Tick;
+
+    __set_PRIMASK(1);
+    u32Tick = TIMER_WheelHwTick(psWheel);
+    __set_PRIMASK(u32Primask);
+
+    return u32Tick;
+}
+
+/**
+  * @brief      Arm a software timer
+  *
+  * @param[in]  psWheel     The pointer of the wheel control block.
+  * @param[in]  psTimer     The pointer of the software timer. Must be cleared before the first use and stay valid while armed.
+  * @param[in]  u32Ticks    Ticks from now until the first expiry, 1 ~ TIMER_WHEEL_MAX_TICKS.
+  * @param[in]  u32Period   Reload period in ticks for a periodic timer, 0 for a one-shot timer.
+  * @param[in]  pfnCallback Expiry callback, called in the timer interrupt.
+  * @param[in]  pvArg       Callback argument.
+  *
+  * @retval     TIMER_OK        Software timer is armed
+  * @retval     TIMER_ERR_FAIL  Invalid argument
+  *
+  * @details    An armed timer is restarted. Periodic timers are reloaded from their expiry tick, so the period
+  *             does not drift with interrupt latency. Insertion is O(1) and the compare register is only
+  *             written when the timer is due before the current deadline. Can be called from a callback
+  *             and from any interrupt, including ones preempting the timer interrupt.
+  */
+int32_t TIMER_StartSW(S_TIMER_WHEEL_T *psWheel, S_TIMER_SW_T *psTimer, uint32_t u32Ticks, uint32_t u32Period, TIMER_SW_CB pfnCallback, void *pvArg)
+{
+    uint32_t u32Primask, u32Next;
+
+    if((u32Ticks == 0) || (u32Ticks > TIMER_WHEEL_MAX_TICKS) || (u32Period > TIMER_WHEEL_MAX_TICKS) || (pfnCallback == NULL))
+        return TIMER_ERR_FAIL;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+
+    if(psTimer->ppsPrev)
+        TIMER_WheelUnlink(psWheel, psTimer);
+    psTimer->u32Expire = TIMER_WheelHwTick(psWheel) + u32Ticks;
+    psTimer->u32Period = u32Period;
+    psTimer->pfnCallback = pfnCallback;
+    psTimer->pvArg = pvArg;
+    TIMER_WheelLink(psWheel, psTimer);
+
+    /* Bring the deadline forward, the interrupt handler runs the ticks already passed */
+    u32Next = TIMER_WheelNextEvent(psWheel);
+    if((int32_t)(u32Next - psWheel->u32Deadline) < 0)
+    {
+        if(TIMER_WheelSetDeadline(psWheel, u32Next) == 0)
+            NVIC_SetPendingIRQ((IRQn_Type)(TMR0_IRQn + TIMER_GetIndex(psWheel->psTimer)));
+    }
+
+    __set_PRIMASK(u32Primask);
+
+    return TIMER_OK;
+}
+
+/**
+  * @brief      Disarm a software timer
+  *
+  * @param[in]  psWheel     The pointer of the wheel control block.
+  * @param[in]  psTimer     The pointer of the software timer.
+  *
+  * @return     None
+  *
+  * @details    O(1), the compare register is left alone and a deadline without work left only
+  *             costs one interrupt. Can be called from a callback and from any interrupt, including
+  *             ones preempting the timer interrupt.
+  */
+void TIMER_StopSW(S_TIMER_WHEEL_T *psWheel, S_TIMER_SW_T *psTimer)
+{
+    uint32_t u32Primask = __get_PRIMASK();
+
+    __set_PRIMASK(1);
+    if(psTimer->ppsPrev)
+        TIMER_WheelUnlink(psWheel, psTimer);
+    __set_PRIMASK(u32Primask);
+}
+
+/**
+  * @brief      Software timer service interrupt handler
+  *
+  * @param[in]  timer       The pointer of the specified Timer module. It could be TIMER0, TIMER1, TIMER2, TIMER3.
+  *
+  * @return     None
+  *
+  * @details    Runs every tick with work up to the current counter value, then sets the compare register
+  *             to the next one. Ticks without work are skipped in a single step. The wheel is walked with
+  *             interrupts masked and they are enabled only while a callback runs, so a higher priority
+  *             interrupt starting or stopping a timer never sees a slot half processed.
+  */
+void TIMER_WheelIRQHandler(TIMER_T *timer)
+{
+    S_TIMER_WHEEL_T *psWheel = s_apsTimerWheel[TIMER_GetIndex(timer)];
+    uint32_t u32Hw, u32Next, u32Primask;
+
+    TIMER_ClearIntFlag(timer);
+    if(psWheel == NULL)
+        return;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    do
+    {
+        u32Hw = TIMER_WheelHwTick(psWheel);
+        while((int32_t)((u32Next = TIMER_WheelNextEvent(psWheel)) - u32Hw) <= 0)
+        {
+            psWheel->u32Now = u32Next;
+            TIMER_WheelRunTick(psWheel, u32Primask);
+        }
+        psWheel->u32Now = u32Hw + 1;
+    }
+    while(TIMER_WheelSetDeadline(psWheel, u32Next) == 0);
+    __set_PRIMASK(u32Primask);
+}
+
 /*@}*/ /* end of group TIMER_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group TIMER_Driver */
@@ -0,0 +1,268 @@
+/**************************************************************************//**
+ * @file     trace.c
+ * @version  V3.00
+ * @brief    NUC029xGE series driver event trace source file
+ *
+ * @note
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC029xGE.h"
+
+
+/** @addtogroup Standard_Driver Standard Driver
+  @{
+*/
+
+/** @addtogroup TRACE_Driver TRACE Driver
+  @{
+*/
+
+#define TRACE_STAMP_MASK        0x00FFFFFFUL
+#define TRACE_FLUSH_RECORDS     16          /* Records per block sent by TRACE_Flush() */
+
+static S_TRACE_REC_T *s_psTraceBuf = NULL;
+static uint32_t s_u32TraceSize;
+static volatile uint32_t s_u32TraceHead;
+static volatile uint32_t s_u32TraceTail;
+static volatile uint32_t s_u32TraceDrop;
+static uint32_t s_u32TraceClock;            /* Timestamp clock in Hz */
+static uint32_t s_u32TraceModulus;          /* Timestamps count 0 ~ s_u32TraceModulus - 1 and wrap */
+static TIMER_T *s_psTraceTimer;
+
+/**
+  * @brief      Read the timestamp counter
+  * @param      None
+  * @return     Ticks, counting up and wrapping at s_u32TraceModulus
+  */
+static uint32_t TRACE_GetStamp(void)
+{
+    if(s_psTraceTimer != NULL)
+        return s_psTraceTimer->CNT & TRACE_STAMP_MASK;
+
+    return (SysTick->LOAD - SysTick->VAL) & TRACE_STAMP_MASK;
+}
+
+/**
+  * @brief      Get the SysTick counting clock
+  * @param      None
+  * @return     SysTick clock in Hz
+  */
+static uint32_t TRACE_GetSysTickClock(void)
+{
+    if(SysTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk)
+        return SystemCoreClock;
+
+    switch(CLK->CLKSEL0 & CLK_CLKSEL0_STCLKSEL_Msk)
+    {
+        case CLK_CLKSEL0_STCLKSEL_HXT:
+            return __HXT;
+        case CLK_CLKSEL0_STCLKSEL_LXT:
+            return __LXT;
+        case CLK_CLKSEL0_STCLKSEL_HXT_DIV2:
+            return __HXT / 2;
+        case CLK_CLKSEL0_STCLKSEL_HIRC_DIV2:
+            return __HIRC / 2;
+        default:
+            return SystemCoreClock / 2;
+    }
+}
+
+/** @addtogroup TRACE_EXPORTED_FUNCTIONS TRACE Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Start recording trace events
+  *
+  * @param[in]  psBuf       Record buffer. Must stay valid until \ref TRACE_Close.
+  * @param[in]  u32Size     Number of records in psBuf, must be a power of 2.
+  * @param[in]  timer       Timer used as timestamp counter, it could be TIMER0 ~ TIMER3. NULL to use SysTick.
+  *
+  * @retval     0   Success
+  * @retval     -1  u32Size is not a power of 2
+  *
+  * @details    A timer is set to continuous counting mode at its module clock with no prescaler, so the
+  *             timer clock must be enabled and selected before. With SysTick, a stopped SysTick is started
+  *             with the core clock and the maximum reload value, and a running one is used as it is, in
+  *             which case the timestamps wrap at its reload value.
+  */
+int32_t TRACE_Open(S_TRACE_REC_T *psBuf, uint32_t u32Size, TIMER_T *timer)
+{
+    if((u32Size == 0) || (u32Size & (u32Size - 1)))
+        return -1;
+
+    s_psTraceBuf = NULL;
+    s_u32TraceSize = u32Size;
+    s_u32TraceHead = 0;
+    s_u32TraceTail = 0;
+    s_u32TraceDrop = 0;
+    s_psTraceTimer = timer;
+
+    if(timer != NULL)
+    {
+        timer->CTL = 0;
+        timer->CMP = TRACE_STAMP_MASK;
+        timer->CTL = TIMER_CONTINUOUS_MODE | TIMER_CTL_CNTEN_Msk;
+        s_u32TraceClock = TIMER_GetModuleClock(timer);
+        s_u32TraceModulus = TRACE_STAMP_MASK + 1;
+    }
+    else
+    {
+        if((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+        {
+            SysTick->LOAD = TRACE_STAMP_MASK;
+            SysTick->VAL = 0;
+            SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+        }
+        s_u32TraceClock = TRACE_GetSysTickClock();
+        s_u32TraceModulus = (SysTick->LOAD & TRACE_STAMP_MASK) + 1;
+    }
+
+    s_psTraceBuf = psBuf;
+
+    return 0;
+}
+
+/**
+  * @brief      Stop recording trace events
+  *
+  * @param      None
+  *
+  * @return     None
+  *
+  * @details    Records still in the buffer are discarded. The timer or SysTick is left running.
+  */
+void TRACE_Close(void)
+{
+    s_psTraceBuf = NULL;
+}
+
+/**
+  * @brief      Record an event
+  *
+  * @param[in]  u32Id       Event ID, 0x01 ~ 0x7F, with \ref TRACE_ID_END set for the end of a span.
+  * @param[in]  u32Arg      32-bit event argument.
+  *
+  * @return     None
+  *
+  * @details    Use \ref TRACE_BEGIN, \ref TRACE_END and \ref TRACE_EVENT instead of calling this function
+  *             directly. Interrupts are masked while the timestamp is taken and the record is written, so
+  *             records are in time order. The record is counted as dropped when the buffer is full.
+  */
+void TRACE_Record(uint32_t u32Id, uint32_t u32Arg)
+{
+    S_TRACE_REC_T *psRec;
+    uint32_t u32Primask, u32Head;
+
+    if(s_psTraceBuf == NULL)
+        return;
+
+    u32Primask = __get_PRIMASK();
+    __disable_irq();
+    u32Head = s_u32TraceHead;
+    if(u32Head - s_u32TraceTail >= s_u32TraceSize)
+    {
+        s_u32TraceDrop++;
+    }
+    else
+    {
+        psRec = &s_psTraceBuf[u32Head & (s_u32TraceSize - 1)];
+        psRec->u32Stamp = (u32Id << 24) | TRACE_GetStamp();
+        psRec->u32Arg = u32Arg;
+        s_u32TraceHead = u32Head + 1;
+    }
+    __set_PRIMASK(u32Primask);
+}
+
+/**
+  * @brief      Move recorded events to a byte stream
+  *
+  * @param[out] pu8Buf      Stream buffer.
+  * @param[in]  u32Len      Size of pu8Buf in bytes, at least \ref TRACE_HEADER_SIZE + \ref TRACE_RECORD_SIZE.
+  *
+  * @return     Number of bytes written to pu8Buf, 0 if there is no record or pu8Buf is too small.
+  *
+  * @details    Writes one block of little-endian 32-bit words: \ref TRACE_MAGIC, timestamp clock in Hz,
+  *             timestamp modulus, total dropped records and record count, followed by the records.
+  *             The block can be sent by UART, semihosting or read out by a debugger.
+  *             Must not be called from more than one context at a time.
+  */
+uint32_t TRACE_Read(uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t au32Hdr[TRACE_HEADER_SIZE / 4];
+    uint32_t u32Tail = s_u32TraceTail;
+    uint32_t u32Cnt, i, j, u32Word;
+
+    if((s_psTraceBuf == NULL) || (u32Len < TRACE_HEADER_SIZE + TRACE_RECORD_SIZE))
+        return 0;
+
+    u32Cnt = s_u32TraceHead - u32Tail;
+    if(u32Cnt > (u32Len - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE)
+        u32Cnt = (u32Len - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE;
+    if(u32Cnt == 0)
+        return 0;
+
+    au32Hdr[0] = TRACE_MAGIC;
+    au32Hdr[1] = s_u32TraceClock;
+    au32Hdr[2] = s_u32TraceModulus;
+    au32Hdr[3] = s_u32TraceDrop;
+    au32Hdr[4] = u32Cnt;
+    for(i = 0; i < TRACE_HEADER_SIZE / 4; i++)
+    {
+        for(j = 0; j < 4; j++)
+            *pu8Buf++ = (uint8_t)(au32Hdr[i] >> (j * 8));
+    }
+
+    for(i = 0; i < u32Cnt * 2; i++)
+    {
+        if(i & 1)
+            u32Word = s_psTraceBuf[(u32Tail + i / 2) & (s_u32TraceSize - 1)].u32Arg;
+        else
+            u32Word = s_psTraceBuf[(u32Tail + i / 2) & (s_u32TraceSize - 1)].u32Stamp;
+        for(j = 0; j < 4; j++)
+            *pu8Buf++ = (uint8_t)(u32Word >> (j * 8));
+    }
+    s_u32TraceTail = u32Tail + u32Cnt;
+
+    return TRACE_HEADER_SIZE + u32Cnt * TRACE_RECORD_SIZE;
+}
+
+/**
+  * @brief      Send all recorded events to UART
+  *
+  * @param[in]  uart        The pointer of the specified UART module.
+  *
+  * @return     None
+  *
+  * @details    Sends blocks made by \ref TRACE_Read with polling until the buffer is empty.
+  *             The UART must be opened before.
+  */
+void TRACE_Flush(UART_T *uart)
+{
+    uint8_t au8Block[TRACE_HEADER_SIZE + TRACE_FLUSH_RECORDS * TRACE_RECORD_SIZE];
+    uint32_t u32Len;
+
+    while((u32Len = TRACE_Read(au8Block, sizeof(au8Block))) != 0)
+        UART_Write(uart, au8Block, u32Len);
+}
+
+/**
+  * @brief      Get the number of dropped records
+  *
+  * @param      None
+  *
+  * @return     Records \ref TRACE_Record dropped since \ref TRACE_Open because the buffer was full.
+  */
+uint32_t TRACE_GetDropCount(void)
+{
+    return s_u32TraceDrop;
+}
+
+/*@}*/ /* end of group TRACE_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group TRACE_Driver */
+
+/*@}*/ /* end of group Standard_Driver */
+
+/*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
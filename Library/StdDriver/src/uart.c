@@ -486,6 +486,476 @@ uint32_t UART_Write(UART_T* uart, uint8_t *pu8TxBuf, uint32_t u32WriteBytes)
 }
 
 
+static S_UART_ASYNC_T *s_apsUartAsync[UART_ASYNC_NUM];
+
+static uint32_t UART_GetIndex(UART_T* uart)
+{
+    if(uart == UART0)
+        return 0;
+    else if(uart == UART1)
+        return 1;
+    else
+        return 2;
+}
+
+
+/**
+ *    @brief        Start interrupt driven transfer on UART
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    psAsync         Control block. It must stay valid until UART_CloseAsync is called.
+ *    @param[in]    pu8TxBuf        TX ring buffer.
+ *    @param[in]    u32TxSize       TX ring buffer size in bytes. It must be power of 2.
+ *    @param[in]    pu8RxBuf        RX ring buffer.
+ *    @param[in]    u32RxSize       RX ring buffer size in bytes. It must be power of 2.
+ *    @param[in]    pfnCallback     Event callback called in interrupt context with \ref UART_ASYNC_EVENT_RX,
+ *                                  \ref UART_ASYNC_EVENT_RX_OVERRUN or \ref UART_ASYNC_EVENT_TX_DONE. Can be NULL.
+ *
+ *    @retval       0   Success
+ *    @retval       -1  Invalid ring buffer size
+ *
+ *    @details      UART must be configured by UART_Open before. This function enables the receive data available,
+ *                  RX time-out and buffer error interrupts and the NVIC UART IRQ. The application interrupt handler
+ *                  (UART02_IRQHandler or UART1_IRQHandler) has to call UART_AsyncIRQHandler for the UART.
+ *                  UART0 and UART2 share one IRQ, so UART02_IRQHandler calls it for both if both are used.
+ */
+int32_t UART_OpenAsync(UART_T* uart, S_UART_ASYNC_T *psAsync, uint8_t *pu8TxBuf, uint32_t u32TxSize, uint8_t *pu8RxBuf, uint32_t u32RxSize, UART_ASYNC_CB pfnCallback)
+{
+    if((u32TxSize == 0) || (u32TxSize & (u32TxSize - 1)) || (u32RxSize == 0) || (u32RxSize & (u32RxSize - 1)))
+        return -1;
+
+    psAsync->pu8TxBuf = pu8TxBuf;
+    psAsync->u32TxMask = u32TxSize - 1;
+    psAsync->u32TxHead = 0;
+    psAsync->u32TxTail = 0;
+    psAsync->pu8RxBuf = pu8RxBuf;
+    psAsync->u32RxMask = u32RxSize - 1;
+    psAsync->u32RxHead = 0;
+    psAsync->u32RxTail = 0;
+    psAsync->u32RxDrop = 0;
+    psAsync->pfnCallback = pfnCallback;
+    s_apsUartAsync[UART_GetIndex(uart)] = psAsync;
+
+    /* RX interrupt at 8 bytes, time-out after 40 bit times of idle line catches the tail of a burst */
+    uart->FIFO = (uart->FIFO & ~UART_FIFO_RFITL_Msk) | UART_FIFO_RFITL_8BYTES;
+    UART_SetTimeoutCnt(uart, 40);
+
+    UART_EnableInt(uart, UART_INTEN_RDAIEN_Msk | UART_INTEN_RXTOIEN_Msk | UART_INTEN_BUFERRIEN_Msk);
+
+    return 0;
+}
+
+
+/**
+ *    @brief        Stop interrupt driven transfer on UART
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *
+ *    @return       None
+ *
+ *    @details      Disables the UART interrupts used by the asynchronous transfer. Bytes still queued in the TX ring
+ *                  are discarded. NVIC UART IRQ is left enabled because UART0 and UART2 share it.
+ */
+void UART_CloseAsync(UART_T* uart)
+{
+    UART_DISABLE_INT(uart, UART_INTEN_RDAIEN_Msk | UART_INTEN_RXTOIEN_Msk | UART_INTEN_BUFERRIEN_Msk | UART_INTEN_THREIEN_Msk);
+    s_apsUartAsync[UART_GetIndex(uart)] = NULL;
+}
+
+
+/**
+ *    @brief        Queue data for interrupt driven transmission
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    pu8TxBuf        The data to send.
+ *    @param[in]    u32WriteBytes   The byte number of data.
+ *
+ *    @return       Number of bytes queued. It is less than u32WriteBytes if the TX ring is full.
+ *
+ *    @details      This function never waits. It copies data into the TX ring and enables the transmit holding
+ *                  register empty interrupt, which moves the data to the TX FIFO up to 16 bytes at a time.
+ *                  It must be called from one context only.
+ */
+uint32_t UART_WriteAsync(UART_T* uart, const uint8_t *pu8TxBuf, uint32_t u32WriteBytes)
+{
+    S_UART_ASYNC_T *psAsync = s_apsUartAsync[UART_GetIndex(uart)];
+    uint32_t u32Head, u32Free, u32Count;
+
+    if(psAsync == NULL)
+        return 0;
+
+    u32Head = psAsync->u32TxHead;
+    u32Free = psAsync->u32TxMask + 1 - (u32Head - psAsync->u32TxTail);
+    if(u32WriteBytes > u32Free)
+        u32WriteBytes = u32Free;
+
+    for(u32Count = 0; u32Count < u32WriteBytes; u32Count++)
+        psAsync->pu8TxBuf[(u32Head + u32Count) & psAsync->u32TxMask] = pu8TxBuf[u32Count];
+
+    /* Data must be in the ring before the interrupt handler can see the new head */
+    __DMB();
+    psAsync->u32TxHead = u32Head + u32WriteBytes;
+
+    if(u32WriteBytes)
+        UART_ENABLE_INT(uart, UART_INTEN_THREIEN_Msk);
+
+    return u32WriteBytes;
+}
+
+
+/**
+ *    @brief        Take received data from the RX ring
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[out]   pu8RxBuf        The buffer to receive the data.
+ *    @param[in]    u32ReadBytes    The maximum byte number to read.
+ *
+ *    @return       Number of bytes read. It is 0 if nothing has been received.
+ *
+ *    @details      This function never waits. It must be called from one context only.
+ */
+uint32_t UART_ReadAsync(UART_T* uart, uint8_t *pu8RxBuf, uint32_t u32ReadBytes)
+{
+    S_UART_ASYNC_T *psAsync = s_apsUartAsync[UART_GetIndex(uart)];
+    uint32_t u32Tail, u32Avail, u32Count;
+
+    if(psAsync == NULL)
+        return 0;
+
+    u32Tail = psAsync->u32RxTail;
+    u32Avail = psAsync->u32RxHead - u32Tail;
+    if(u32ReadBytes > u32Avail)
+        u32ReadBytes = u32Avail;
+
+    for(u32Count = 0; u32Count < u32ReadBytes; u32Count++)
+        pu8RxBuf[u32Count] = psAsync->pu8RxBuf[(u32Tail + u32Count) & psAsync->u32RxMask];
+
+    /* Bytes must be copied out before the interrupt handler may overwrite them */
+    __DMB();
+    psAsync->u32RxTail = u32Tail + u32ReadBytes;
+
+    return u32ReadBytes;
+}
+
+
+/**
+ *    @brief        Get number of received bytes waiting in the RX ring
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *
+ *    @return       Number of bytes UART_ReadAsync can return without waiting
+ */
+uint32_t UART_GetAsyncRxCount(UART_T* uart)
+{
+    S_UART_ASYNC_T *psAsync = s_apsUartAsync[UART_GetIndex(uart)];
+
+    if(psAsync == NULL)
+        return 0;
+
+    return psAsync->u32RxHead - psAsync->u32RxTail;
+}
+
+
+/**
+ *    @brief        Get number of bytes not yet moved to the TX FIFO
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *
+ *    @return       Number of bytes waiting in the TX ring
+ *
+ *    @details      Bytes already in the TX FIFO are not counted. Use UART_IS_TX_EMPTY to know if they are sent.
+ */
+uint32_t UART_GetAsyncTxCount(UART_T* uart)
+{
+    S_UART_ASYNC_T *psAsync = s_apsUartAsync[UART_GetIndex(uart)];
+
+    if(psAsync == NULL)
+        return 0;
+
+    return psAsync->u32TxHead - psAsync->u32TxTail;
+}
+
+
+/**
+ *    @brief        UART interrupt service for asynchronous transfer
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *
+ *    @return       None
+ *
+ *    @details      Call it from UART02_IRQHandler or UART1_IRQHandler. It empties the RX FIFO into the RX ring on
+ *                  RX threshold or time-out, refills the TX FIFO from the TX ring on transmit holding register empty
+ *                  and reports events through the callback given to UART_OpenAsync.
+ */
+void UART_AsyncIRQHandler(UART_T* uart)
+{
+    S_UART_ASYNC_T *psAsync = s_apsUartAsync[UART_GetIndex(uart)];
+    uint32_t u32IntSts, u32Head, u32Tail, u32Event = 0, u32Count;
+    uint8_t u8Data;
+
+    if(psAsync == NULL)
+        return;
+
+    u32IntSts = uart->INTSTS;
+
+    if(u32IntSts & (UART_INTSTS_RDAIF_Msk | UART_INTSTS_RXTOIF_Msk))
+    {
+        /* Get all the input characters */
+        u32Head = psAsync->u32RxHead;
+        u32Tail = psAsync->u32RxTail;
+        while((uart->FIFOSTS & UART_FIFOSTS_RXEMPTY_Msk) == 0)
+        {
+            u8Data = (uint8_t)uart->DAT;
+            if((u32Head - u32Tail) <= psAsync->u32RxMask)
+            {
+                psAsync->pu8RxBuf[u32Head & psAsync->u32RxMask] = u8Data;
+                u32Head++;
+            }
+            else
+            {
+                psAsync->u32RxDrop++;
+                u32Event |= UART_ASYNC_EVENT_RX_OVERRUN;
+            }
+        }
+        if(u32Head != psAsync->u32RxHead)
+        {
+            __DMB();
+            psAsync->u32RxHead = u32Head;
+            u32Event |= UART_ASYNC_EVENT_RX;
+        }
+    }
+
+    if(u32IntSts & UART_INTSTS_BUFERRINT_Msk)
+    {
+        /* RX FIFO overflow */
+        UART_ClearIntFlag(uart, UART_INTSTS_BUFERRINT_Msk);
+        u32Event |= UART_ASYNC_EVENT_RX_OVERRUN;
+    }
+
+    if((u32IntSts & UART_INTSTS_THREIF_Msk) && (uart->INTEN & UART_INTEN_THREIEN_Msk))
+    {
+        /* TX FIFO is empty, fill it from the ring */
+        u32Head = psAsync->u32TxHead;
+        u32Tail = psAsync->u32TxTail;
+        u32Count = u32Head - u32Tail;
+        if(u32Count > UART0_FIFO_SIZE)
+            u32Count = UART0_FIFO_SIZE;
+
+        while(u32Count--)
+        {
+            uart->DAT = psAsync->pu8TxBuf[u32Tail & psAsync->u32TxMask];
+            u32Tail++;
+        }
+        psAsync->u32TxTail = u32Tail;
+
+        if(u32Tail == psAsync->u32TxHead)
+        {
+            /* No more data, stop TX interrupt until UART_WriteAsync queues more */
+            UART_DISABLE_INT(uart, UART_INTEN_THREIEN_Msk);
+            u32Event |= UART_ASYNC_EVENT_TX_DONE;
+        }
+    }
+
+    if(u32Event && psAsync->pfnCallback)
+        psAsync->pfnCallback(uart, u32Event);
+}
+
+
+static uint32_t s_au32UartRxDmaCh[UART_ASYNC_NUM];
+static uint32_t s_au32UartRxDmaLen[UART_ASYNC_NUM];
+
+static uint32_t UART_GetBaudRate(UART_T* uart)
+{
+    uint8_t u8UartClkSrcSel, u8UartClkDivNum;
+    uint32_t au32ClkTbl[4] = {__HXT, 0, __LXT, __HIRC};
+    uint32_t u32Clk, u32Baud = uart->BAUD;
+
+    u8UartClkSrcSel = (CLK->CLKSEL1 & CLK_CLKSEL1_UARTSEL_Msk) >> CLK_CLKSEL1_UARTSEL_Pos;
+    u8UartClkDivNum = (CLK->CLKDIV0 & CLK_CLKDIV0_UARTDIV_Msk) >> CLK_CLKDIV0_UARTDIV_Pos;
+
+    if(u8UartClkSrcSel == 1)
+        au32ClkTbl[u8UartClkSrcSel] = CLK_GetPLLClockFreq();
+
+    u32Clk = au32ClkTbl[u8UartClkSrcSel] / (u8UartClkDivNum + 1);
+
+    if((u32Baud & UART_BAUD_MODE2) == UART_BAUD_MODE2)
+        return u32Clk / ((u32Baud & UART_BAUD_BRD_Msk) + 2);
+    else if(u32Baud & UART_BAUD_BAUDM1_Msk)
+        return u32Clk / ((((u32Baud & UART_BAUD_EDIVM1_Msk) >> UART_BAUD_EDIVM1_Pos) + 1) * ((u32Baud & UART_BAUD_BRD_Msk) + 2));
+    else
+        return u32Clk / (16 * ((u32Baud & UART_BAUD_BRD_Msk) + 2));
+}
+
+
+/**
+ *    @brief        Start PDMA transmit on UART
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    u32Ch           PDMA channel, 0 ~ 4.
+ *    @param[in]    pu8TxBuf        The buffer to send. It must stay valid until the transfer is done.
+ *    @param[in]    u32WriteBytes   Number of bytes to send, 1 ~ \ref UART_DMA_MAX_LEN.
+ *
+ *    @retval       0   Transfer started
+ *    @retval       -1  Invalid channel or length
+ *
+ *    @details      PDMA clock and UART_Open must be done before. The channel is opened and moves one byte each time
+ *                  the TX FIFO has room, so the CPU does not touch the data. PDMA transfer done flag of the channel
+ *                  is set when the last byte is written to the TX FIFO, its interrupt and the NVIC PDMA IRQ are enabled.
+ *                  The application PDMA_IRQHandler clears the flag by PDMA_CLR_TD_FLAG, or PDMA_ChannelIRQHandler
+ *                  does it if the channel was taken by PDMA_RequestChannel.
+ */
+int32_t UART_TransmitDMA(UART_T* uart, uint32_t u32Ch, const uint8_t *pu8TxBuf, uint32_t u32WriteBytes)
+{
+    uint32_t u32Idx = UART_GetIndex(uart);
+
+    if((u32Ch >= PDMA_CH_MAX) || (u32WriteBytes == 0) || (u32WriteBytes > UART_DMA_MAX_LEN))
+        return -1;
+
+    uart->INTEN &= ~UART_INTEN_TXPDMAEN_Msk;
+
+    PDMA_Open(1 << u32Ch);
+    PDMA_SetTransferCnt(u32Ch, PDMA_WIDTH_8, u32WriteBytes);
+    PDMA_SetTransferAddr(u32Ch, (uint32_t)pu8TxBuf, PDMA_SAR_INC, (uint32_t)&uart->DAT, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(u32Ch, PDMA_UART0_TX + u32Idx * 2, FALSE, 0);
+    PDMA_SetBurstType(u32Ch, PDMA_REQ_SINGLE, 0);
+    PDMA_EnableInt(u32Ch, PDMA_INT_TRANS_DONE);
+    NVIC_EnableIRQ(PDMA_IRQn);
+
+    uart->INTEN |= UART_INTEN_TXPDMAEN_Msk;
+
+    return 0;
+}
+
+
+/**
+ *    @brief        Start PDMA receive on UART
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *    @param[in]    u32Ch           PDMA channel, 0 ~ 4. Channel 0 or 1 if u32IdleBits is not 0.
+ *    @param[in]    pu8RxBuf        The buffer to receive data. It must stay valid until the transfer is stopped.
+ *    @param[in]    u32ReadBytes    Buffer size in bytes, 1 ~ \ref UART_DMA_MAX_LEN.
+ *    @param[in]    u32IdleBits     Idle line time in bit times that ends the receive early. 0 disables it.
+ *
+ *    @retval       0   Transfer started
+ *    @retval       -1  Invalid channel or length
+ *
+ *    @details      PDMA clock and UART_Open must be done before. PDMA transfer done flag of the channel is set when
+ *                  the buffer is full. With u32IdleBits, the PDMA request time-out of the channel is programmed to
+ *                  the idle time and restarts on every received byte, so the time-out flag (PDMA_INTSTS_REQTOFn)
+ *                  closes a variable-length message. It also fires when nothing arrives within the idle time.
+ *                  The UART RX time-out cannot be used for this because it needs data left in the RX FIFO while
+ *                  the PDMA keeps the FIFO empty.
+ *                  Both interrupts and the NVIC PDMA IRQ are enabled. The application PDMA_IRQHandler, or the
+ *                  callback of a channel taken by PDMA_RequestChannel(\ref PDMA_CH_TIMEOUT, ...), calls
+ *                  UART_StopReceiveDMA on either flag to get the received byte count.
+ */
+int32_t UART_ReceiveDMA(UART_T* uart, uint32_t u32Ch, uint8_t *pu8RxBuf, uint32_t u32ReadBytes, uint32_t u32IdleBits)
+{
+    uint32_t u32Idx = UART_GetIndex(uart);
+    uint32_t u32Cycles, u32Toc, u32Psc = 0;
+
+    if((u32Ch >= PDMA_CH_MAX) || (u32ReadBytes == 0) || (u32ReadBytes > UART_DMA_MAX_LEN) || (u32IdleBits && (u32Ch > 1)))
+        return -1;
+
+    uart->INTEN &= ~UART_INTEN_RXPDMAEN_Msk;
+    s_au32UartRxDmaCh[u32Idx] = u32Ch;
+    s_au32UartRxDmaLen[u32Idx] = u32ReadBytes;
+
+    PDMA_Open(1 << u32Ch);
+    PDMA_SetTransferCnt(u32Ch, PDMA_WIDTH_8, u32ReadBytes);
+    PDMA_SetTransferAddr(u32Ch, (uint32_t)&uart->DAT, PDMA_SAR_FIX, (uint32_t)pu8RxBuf, PDMA_DAR_INC);
+    PDMA_SetTransferMode(u32Ch, PDMA_UART0_RX + u32Idx * 2, FALSE, 0);
+    PDMA_SetBurstType(u32Ch, PDMA_REQ_SINGLE, 0);
+    PDMA_EnableInt(u32Ch, PDMA_INT_TRANS_DONE);
+
+    if(u32Ch < 2)
+    {
+        if(u32IdleBits)
+        {
+            /* Time-out clock is HCLK / 2^(8 + TOUTPSC), use the finest prescaler the 16-bit counter allows */
+            u32Cycles = (SystemCoreClock / UART_GetBaudRate(uart)) * u32IdleBits;
+            while((u32Psc < 7) && ((u32Cycles >> (8 + u32Psc)) >= 0xFFFF))
+                u32Psc++;
+            u32Toc = (u32Cycles >> (8 + u32Psc)) + 1;
+            if(u32Toc > 0xFFFF)
+                u32Toc = 0xFFFF;
+
+            PDMA->TOUTPSC = (PDMA->TOUTPSC & ~(PDMA_TOUTPSC_TOUTPSC0_Msk << (u32Ch * 4))) | (u32Psc << (u32Ch * 4));
+            PDMA->INTSTS = PDMA_INTSTS_REQTOF0_Msk << u32Ch;
+            PDMA_SetTimeOut(u32Ch, TRUE, u32Toc);
+            PDMA_EnableInt(u32Ch, PDMA_INT_TIMEOUT);
+        }
+        else
+        {
+            PDMA_SetTimeOut(u32Ch, FALSE, 0);
+            PDMA_DisableInt(u32Ch, PDMA_INT_TIMEOUT);
+        }
+    }
+    NVIC_EnableIRQ(PDMA_IRQn);
+
+    uart->INTEN |= UART_INTEN_RXPDMAEN_Msk;
+
+    return 0;
+}
+
+
+/**
+ *    @brief        Get PDMA receive byte count
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *
+ *    @return       Number of bytes the PDMA has written to the buffer of the last UART_ReceiveDMA
+ *
+ *    @details      It can be called while the transfer is running to peek at the progress.
+ */
+uint32_t UART_GetReceiveDMACount(UART_T* uart)
+{
+    uint32_t u32Idx = UART_GetIndex(uart);
+    uint32_t u32Ctl = PDMA->DSCT[s_au32UartRxDmaCh[u32Idx]].CTL;
+
+    if(s_au32UartRxDmaLen[u32Idx] == 0)
+        return 0;
+
+    /* Finished table goes back to OPMODE idle, otherwise TXCNT holds the remaining count - 1 */
+    if((u32Ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_STOP)
+        return s_au32UartRxDmaLen[u32Idx];
+
+    return s_au32UartRxDmaLen[u32Idx] - (((u32Ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1);
+}
+
+
+/**
+ *    @brief        Stop PDMA receive on UART
+ *
+ *    @param[in]    uart            The pointer of the specified UART module.
+ *
+ *    @return       Number of bytes received into the buffer
+ *
+ *    @details      Stops the UART RX PDMA request, resets the channel and clears its transfer done and time-out
+ *                  flags. Bytes arriving afterwards stay in the RX FIFO for the next UART_ReceiveDMA or UART_Read.
+ */
+uint32_t UART_StopReceiveDMA(UART_T* uart)
+{
+    uint32_t u32Ch = s_au32UartRxDmaCh[UART_GetIndex(uart)];
+
+    uart->INTEN &= ~UART_INTEN_RXPDMAEN_Msk;
+
+    if(u32Ch < 2)
+    {
+        PDMA->TOUTEN &= ~(1 << u32Ch);
+        PDMA->TOUTIEN &= ~(1 << u32Ch);
+        PDMA->INTSTS = PDMA_INTSTS_REQTOF0_Msk << u32Ch;
+    }
+
+    /* Channel reset lets the byte in flight complete, then drops the rest of the table */
+    PDMA->RESET = 1 << u32Ch;
+    while(PDMA->RESET & (1 << u32Ch));
+    PDMA_CLR_TD_FLAG(1 << u32Ch);
+
+    return UART_GetReceiveDMACount(uart);
+}
+
+
 /*@}*/ /* end of group UART_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group UART_Driver */
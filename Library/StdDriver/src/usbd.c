@@ -56,6 +56,43 @@ static volatile uint32_t g_usbd_CtrlMaxPktSize = 8;
 static volatile uint32_t g_usbd_UsbAltInterface = 0;
 static volatile uint32_t g_usbd_CtrlOutToggle = 0;
 static volatile uint8_t  g_usbd_CtrlInZeroFlag = 0;
+static S_USBD_FUNC_T *g_usbd_FuncList = NULL;           /* Registered class functions in registration order */
+static S_USBD_FUNC_T *g_usbd_EpFunc[USBD_MAX_EP];       /* Class function owning each hardware endpoint */
+static S_USBD_FUNC_EP_T *g_usbd_EpEntry[USBD_MAX_EP];   /* Endpoint table entry of each hardware endpoint */
+static uint32_t g_usbd_NextHwEp = EP2;                  /* Next free hardware endpoint */
+static uint32_t g_usbd_NextBufSeg = 0;                  /* Next free offset in the endpoint buffer SRAM */
+static USBD_EP_HANDLER g_usbd_EpHandler[USBD_MAX_EP];   /* Endpoint event handlers of USBD_EventIRQHandler */
+static USBD_BUS_HANDLER g_usbd_pfnBusHandler = NULL;    /* Bus event handler of USBD_EventIRQHandler */
+
+/* Bit position of the lowest set bit of a non-zero value. Cortex-M0 has no CLZ or RBIT, so the bit is isolated
+   and its product with a de Bruijn sequence looked up, which takes the same few cycles for any bit. */
+static const uint8_t g_usbd_BitPos[32] =
+{
+    0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+#define USBD_LOWEST_BIT(x)  g_usbd_BitPos[(((x) & (0UL - (x))) * 0x077CB531UL) >> 27]
+
+static void USBD_CtrlInHandler(uint32_t u32HwEp);
+static void USBD_CtrlOutHandler(uint32_t u32HwEp);
+
+#define USBD_DESC_STR_NUM   4       /* String descriptor indexes served */
+#define USBD_DESC_IF_NUM    8       /* Interface numbers with HID descriptors served */
+
+/* Answer to a GET_DESCRIPTOR request, worked out by USBD_Open() */
+typedef struct
+{
+    const uint8_t *pu8Desc;         /* Descriptor, NULL to stall the request */
+    uint16_t u16Len;                /* Full length */
+    uint8_t u8Zlp;                  /* Full length is a multiple of the EP0 packet size */
+} S_USBD_DESC_T;
+
+static S_USBD_DESC_T g_usbd_DescDev;
+static S_USBD_DESC_T g_usbd_DescConfig;
+static S_USBD_DESC_T g_usbd_DescBos;
+static S_USBD_DESC_T g_usbd_DescStr[USBD_DESC_STR_NUM];
+static S_USBD_DESC_T g_usbd_DescHid[USBD_DESC_IF_NUM];
+static S_USBD_DESC_T g_usbd_DescHidRpt[USBD_DESC_IF_NUM];
 /**
  * @endcond
  */
@@ -68,6 +105,56 @@ SET_INTERFACE_REQ g_usbd_pfnSetInterface = NULL;    /*!< USB Set Interface Funct
 SET_CONFIG_CB g_usbd_pfnSetConfigCallback = NULL;   /*!< USB Set configuration callback function pointer */
 uint32_t g_u32EpStallLock                = 0;       /*!< Bit map flag to lock specified EP when SET_FEATURE */
 
+/**
+ * @cond HIDDEN_SYMBOLS
+ */
+static void USBD_SetDesc(S_USBD_DESC_T *psDesc, const uint8_t *pu8Desc, uint32_t u32Len)
+{
+    psDesc->pu8Desc = pu8Desc;
+    psDesc->u16Len = (uint16_t)u32Len;
+    psDesc->u8Zlp = (uint8_t)((u32Len % g_usbd_CtrlMaxPktSize) == 0);
+}
+
+/* Fill the descriptor cache, so that GET_DESCRIPTOR neither parses nor divides */
+static void USBD_BuildDescCache(void)
+{
+    const S_USBD_INFO_T *psInfo = g_usbd_sInfo;
+    const uint8_t *pu8Desc = psInfo->gu8ConfigDesc;
+    uint32_t i, u32Total, u32If = 0xFF;
+
+    memset(g_usbd_DescStr, 0, sizeof(g_usbd_DescStr));
+    memset(g_usbd_DescHid, 0, sizeof(g_usbd_DescHid));
+    memset(g_usbd_DescHidRpt, 0, sizeof(g_usbd_DescHidRpt));
+    memset(&g_usbd_DescBos, 0, sizeof(g_usbd_DescBos));
+
+    USBD_SetDesc(&g_usbd_DescDev, psInfo->gu8DevDesc, LEN_DEVICE);
+    u32Total = pu8Desc[2] | ((uint32_t)pu8Desc[3] << 8);
+    USBD_SetDesc(&g_usbd_DescConfig, pu8Desc, u32Total);
+    if(psInfo->gu8BosDesc != NULL)
+        USBD_SetDesc(&g_usbd_DescBos, psInfo->gu8BosDesc, psInfo->gu8BosDesc[2] | ((uint32_t)psInfo->gu8BosDesc[3] << 8));
+    for(i = 0; (psInfo->gu8StringDesc != NULL) && (i < USBD_DESC_STR_NUM); i++)
+    {
+        if(psInfo->gu8StringDesc[i] != NULL)
+            USBD_SetDesc(&g_usbd_DescStr[i], psInfo->gu8StringDesc[i], psInfo->gu8StringDesc[i][0]);
+    }
+
+    /* HID descriptor follows its interface descriptor in the configuration descriptor */
+    for(i = 0; (i + 2 <= u32Total) && (pu8Desc[i] != 0); i += pu8Desc[i])
+    {
+        if(pu8Desc[i + 1] == DESC_INTERFACE)
+            u32If = pu8Desc[i + 2];
+        else if((pu8Desc[i + 1] == DESC_HID) && (u32If < USBD_DESC_IF_NUM) && (g_usbd_DescHid[u32If].pu8Desc == NULL))
+        {
+            USBD_SetDesc(&g_usbd_DescHid[u32If], &pu8Desc[i], LEN_HID);
+            if((psInfo->gu8HidReportDesc != NULL) && (psInfo->gu8HidReportDesc[u32If] != NULL))
+                USBD_SetDesc(&g_usbd_DescHidRpt[u32If], psInfo->gu8HidReportDesc[u32If], psInfo->gu32HidReportSize[u32If]);
+        }
+    }
+}
+/**
+ * @endcond
+ */
+
 /**
   * @brief      This function makes USBD module to be ready to use
   *
@@ -78,6 +165,9 @@ uint32_t g_u32EpStallLock                = 0;       /*!< Bit map flag to lock sp
   * @return     None
   *
   * @details    This function will enable USB controller, USB PHY transceiver and pull-up resistor of USB_D+ pin. USB PHY will drive SE0 to bus.
+  *             The control pipe gets the start of the endpoint buffer SRAM: the SETUP packet at offset 0 and one
+  *             shared buffer for EP0 (control IN) and EP1 (control OUT). Class functions registered afterwards by
+  *             USBD_RegisterFunction() get the rest.
   */
 void USBD_Open(const S_USBD_INFO_T *param, CLASS_REQ pfnClassReq, SET_INTERFACE_REQ pfnSetInterface)
 {
@@ -87,10 +177,29 @@ void USBD_Open(const S_USBD_INFO_T *param, CLASS_REQ pfnClassReq, SET_INTERFACE_
 
     /* get EP0 maximum packet size */
     g_usbd_CtrlMaxPktSize = g_usbd_sInfo->gu8DevDesc[7];
+    USBD_BuildDescCache();
 
     /* Initial USB engine */
     USBD->ATTR = 0x7D0;
 
+    /* Control pipe */
+    USBD->STBUFSEG = 0;
+    USBD_CONFIG_EP(EP0, USBD_CFG_CSTALL | USBD_CFG_EPMODE_IN | 0);
+    USBD_SET_EP_BUF_ADDR(EP0, USBD_SETUP_BUF_LEN);
+    USBD_CONFIG_EP(EP1, USBD_CFG_CSTALL | USBD_CFG_EPMODE_OUT | 0);
+    USBD_SET_EP_BUF_ADDR(EP1, USBD_SETUP_BUF_LEN);
+
+    /* No class function registered yet */
+    g_usbd_FuncList = NULL;
+    memset(g_usbd_EpFunc, 0, sizeof(g_usbd_EpFunc));
+    memset(g_usbd_EpEntry, 0, sizeof(g_usbd_EpEntry));
+    memset(g_usbd_EpHandler, 0, sizeof(g_usbd_EpHandler));
+    g_usbd_EpHandler[EP0] = USBD_CtrlInHandler;
+    g_usbd_EpHandler[EP1] = USBD_CtrlOutHandler;
+    g_usbd_pfnBusHandler = NULL;
+    g_usbd_NextHwEp = EP2;
+    g_usbd_NextBufSeg = USBD_SETUP_BUF_LEN + ((g_usbd_CtrlMaxPktSize + 7) & ~7UL);
+
     /* Force SE0 */
     USBD_SET_SE0();
 }
@@ -132,6 +241,104 @@ void USBD_GetSetupPacket(uint8_t *buf)
     USBD_MemCopy(buf, g_usbd_SetupPacket, 8);
 }
 
+/**
+ * @cond HIDDEN_SYMBOLS
+ */
+/* Class function owning the interface or endpoint the SETUP packet is addressed to, NULL if none */
+static S_USBD_FUNC_T *USBD_FindFunction(void)
+{
+    S_USBD_FUNC_T *psFunc;
+    uint32_t i, u32Index = g_usbd_SetupPacket[4];
+
+    for(psFunc = g_usbd_FuncList; psFunc != NULL; psFunc = psFunc->psNext)
+    {
+        if((g_usbd_SetupPacket[0] & 0x1F) == 0x01)          /* Recipient interface */
+        {
+            if(u32Index - psFunc->u8IfFirst < psFunc->u8IfCount)
+                return psFunc;
+        }
+        else if((g_usbd_SetupPacket[0] & 0x1F) == 0x02)     /* Recipient endpoint */
+        {
+            for(i = 0; i < psFunc->u8EpCount; i++)
+            {
+                if(psFunc->psEp[i].u32Addr == u32Index)
+                    return psFunc;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Largest wMaxPacketSize of endpoint address u32Addr in the interfaces of psFunc, 0 if it is not there */
+static uint32_t USBD_FindEpDesc(S_USBD_FUNC_T *psFunc, uint32_t u32Addr, uint32_t *pu32Type)
+{
+    const uint8_t *pu8Desc = g_usbd_sInfo->gu8ConfigDesc;
+    uint32_t u32Total, u32Pos, u32If = 0xFF, u32Pkt, u32Max = 0;
+
+    u32Total = pu8Desc[2] | ((uint32_t)pu8Desc[3] << 8);
+    for(u32Pos = 0; (u32Pos + 6 <= u32Total) && (pu8Desc[u32Pos] != 0); u32Pos += pu8Desc[u32Pos])
+    {
+        if(pu8Desc[u32Pos + 1] == DESC_INTERFACE)
+            u32If = pu8Desc[u32Pos + 2];
+        else if((pu8Desc[u32Pos + 1] == DESC_ENDPOINT) && (pu8Desc[u32Pos + 2] == u32Addr) &&
+                (u32If - psFunc->u8IfFirst < psFunc->u8IfCount))
+        {
+            u32Pkt = (pu8Desc[u32Pos + 4] | ((uint32_t)pu8Desc[u32Pos + 5] << 8)) & 0x7FF;
+            if(u32Pkt > u32Max)
+                u32Max = u32Pkt;
+            *pu32Type = pu8Desc[u32Pos + 3] & 0x3;
+        }
+    }
+    return u32Max;
+}
+
+/* Clear STALL, ready state and data toggle of a function endpoint, restore its buffer and arm it if it is OUT */
+static void USBD_ResetFunctionEp(S_USBD_FUNC_EP_T *psEp)
+{
+    uint32_t u32HwEp = psEp->u32HwEp;
+
+    USBD->EP[u32HwEp].CFGP = USBD_CFGP_CLRRDY_Msk;
+    USBD->EP[u32HwEp].CFG &= ~USBD_CFG_DSQSYNC_Msk;
+    USBD_SET_EP_BUF_ADDR(u32HwEp, psEp->u32BufSeg);
+    if(!(psEp->u32Addr & EP_INPUT))
+        USBD_SET_PAYLOAD_LEN(u32HwEp, psEp->u32MaxPkt);
+}
+
+/* Endpoint handlers of the control pipe and of registered class functions */
+static void USBD_CtrlInHandler(uint32_t u32HwEp)
+{
+    USBD_CtrlIn();
+}
+
+static void USBD_CtrlOutHandler(uint32_t u32HwEp)
+{
+    USBD_CtrlOut();
+}
+
+static void USBD_FuncEpHandler(uint32_t u32HwEp)
+{
+    if(g_usbd_EpEntry[u32HwEp]->pfnEvent != NULL)
+        g_usbd_EpEntry[u32HwEp]->pfnEvent(g_usbd_EpFunc[u32HwEp], u32HwEp);
+}
+
+/* SET_CONFIGURATION: reset the endpoints of every class function and let it restart */
+static void USBD_ConfigFunctions(void)
+{
+    S_USBD_FUNC_T *psFunc;
+    uint32_t i;
+
+    for(psFunc = g_usbd_FuncList; psFunc != NULL; psFunc = psFunc->psNext)
+    {
+        for(i = 0; i < psFunc->u8EpCount; i++)
+            USBD_ResetFunctionEp(&psFunc->psEp[i]);
+        if(psFunc->pfnSetConfig != NULL)
+            psFunc->pfnSetConfig(psFunc);
+    }
+}
+/**
+ * @endcond
+ */
+
 /**
   * @brief    Process SETUP packet
   *
@@ -139,15 +346,19 @@ void USBD_GetSetupPacket(uint8_t *buf)
   *
   * @return   None
   *
-  * @details  Parse SETUP packet and perform the corresponding action.
+  * @details  Parse SETUP packet and perform the corresponding action. Without a class request callback given to
+  *           USBD_Open(), class requests go to the registered class function owning the interface or endpoint.
   *
   */
 void USBD_ProcessSetupPacket(void)
 {
+    S_USBD_FUNC_T *psFunc;
+
     g_usbd_CtrlOutToggle = 0;
 
     /* Get SETUP packet from USB buffer */
     USBD_MemCopy(g_usbd_SetupPacket, (uint8_t *)USBD_BUF_BASE, 8);
+    TRACE_BEGIN(TRACE_ID_USBD_SETUP, g_usbd_SetupPacket[0] | ((uint32_t)g_usbd_SetupPacket[1] << 8));
     /* Check the request type */
     switch(g_usbd_SetupPacket[0] & 0x60)
     {
@@ -162,6 +373,16 @@ void USBD_ProcessSetupPacket(void)
             {
                 g_usbd_pfnClassRequest();
             }
+            else if(((psFunc = USBD_FindFunction()) != NULL) && (psFunc->pfnClassReq != NULL))
+            {
+                psFunc->pfnClassReq(psFunc);
+            }
+            else
+            {
+                /* No owner, stall the device */
+                USBD_SET_EP_STALL(EP0);
+                USBD_SET_EP_STALL(EP1);
+            }
             break;
         }
         case REQ_VENDOR:   // Vendor
@@ -180,6 +401,7 @@ void USBD_ProcessSetupPacket(void)
             break;
         }
     }
+    TRACE_END(TRACE_ID_USBD_SETUP, 0);
 }
 
 /**
@@ -189,119 +411,66 @@ void USBD_ProcessSetupPacket(void)
   *
   * @return   None
   *
-  * @details  Parse GetDescriptor request and perform the corresponding action.
+  * @details  Parse GetDescriptor request and perform the corresponding action. Addresses, lengths and zero length
+  *           packet decisions come from the descriptor cache filled in by USBD_Open().
   *
   */
 void USBD_GetDescriptor(void)
 {
-    uint32_t u32Len;
+    const S_USBD_DESC_T *psDesc = NULL;
+    uint32_t u32Len, u32Index;
 
     g_usbd_CtrlInZeroFlag = (uint8_t)0;
-    u32Len = 0;
-    u32Len = g_usbd_SetupPacket[7];
-    u32Len <<= 8;
-    u32Len += g_usbd_SetupPacket[6];
+    u32Len = g_usbd_SetupPacket[6] | ((uint32_t)g_usbd_SetupPacket[7] << 8);
+    u32Index = g_usbd_SetupPacket[2];
 
     switch(g_usbd_SetupPacket[3])
     {
-        // Get Device Descriptor
         case DESC_DEVICE:
-        {
-            u32Len = Minimum(u32Len, LEN_DEVICE);
-            DBG_PRINTF("Get device desc, %d\n", u32Len);
-
-            USBD_PrepareCtrlIn((uint8_t *)g_usbd_sInfo->gu8DevDesc, u32Len);
-
+            psDesc = &g_usbd_DescDev;
             break;
-        }
-        // Get Configuration Descriptor
         case DESC_CONFIG:
-        {
-            uint32_t u32TotalLen;
-
-            u32TotalLen = g_usbd_sInfo->gu8ConfigDesc[3];
-            u32TotalLen = g_usbd_sInfo->gu8ConfigDesc[2] + (u32TotalLen << 8);
-
-            if(u32Len > u32TotalLen)
-            {
-                u32Len = u32TotalLen;
-                if((u32Len % g_usbd_CtrlMaxPktSize) == 0)
-                {
-                    g_usbd_CtrlInZeroFlag = (uint8_t)1;
-                }
-            }
-            USBD_PrepareCtrlIn((uint8_t *)g_usbd_sInfo->gu8ConfigDesc, u32Len);
-
+            psDesc = &g_usbd_DescConfig;
             break;
-        }
-        // Get HID Descriptor
+        case DESC_BOS:
+            psDesc = &g_usbd_DescBos;
+            break;
+        case DESC_STRING:
+            if(u32Index < USBD_DESC_STR_NUM)
+                psDesc = &g_usbd_DescStr[u32Index];
+            break;
+        /* HID class descriptors of the interface in wIndex. CV3.0 HID Class Descriptor Test needs the right one of a composite device. */
         case DESC_HID:
-        {
-            /* CV3.0 HID Class Descriptor Test,
-               Need to indicate index of the HID Descriptor within gu8ConfigDescriptor, specifically HID Composite device. */
-            uint32_t u32ConfigDescOffset;   // u32ConfigDescOffset is configuration descriptor offset (HID descriptor start index)
-            u32Len = Minimum(u32Len, LEN_HID);
-            DBG_PRINTF("Get HID desc, %d\n", u32Len);
-
-            u32ConfigDescOffset = g_usbd_sInfo->gu32ConfigHidDescIdx[g_usbd_SetupPacket[4]];
-            USBD_PrepareCtrlIn((uint8_t *)&g_usbd_sInfo->gu8ConfigDesc[u32ConfigDescOffset], u32Len);
-
+            if(g_usbd_SetupPacket[4] < USBD_DESC_IF_NUM)
+                psDesc = &g_usbd_DescHid[g_usbd_SetupPacket[4]];
             break;
-        }
-        // Get Report Descriptor
         case DESC_HID_RPT:
-        {
-            if(u32Len > g_usbd_sInfo->gu32HidReportSize[g_usbd_SetupPacket[4]])
-            {
-                u32Len = g_usbd_sInfo->gu32HidReportSize[g_usbd_SetupPacket[4]];
-                if((u32Len % g_usbd_CtrlMaxPktSize) == 0)
-                {
-                    g_usbd_CtrlInZeroFlag = (uint8_t)1;
-                }
-            }
-            USBD_PrepareCtrlIn((uint8_t *)g_usbd_sInfo->gu8HidReportDesc[g_usbd_SetupPacket[4]], u32Len);
-
+            if(g_usbd_SetupPacket[4] < USBD_DESC_IF_NUM)
+                psDesc = &g_usbd_DescHidRpt[g_usbd_SetupPacket[4]];
             break;
-        }
-        // Get String Descriptor
-        case DESC_STRING:
-        {
-            // Get String Descriptor
-            if(g_usbd_SetupPacket[2] < 4)
-            {
-                if(u32Len > g_usbd_sInfo->gu8StringDesc[g_usbd_SetupPacket[2]][0])
-                {
-                    u32Len = g_usbd_sInfo->gu8StringDesc[g_usbd_SetupPacket[2]][0];
-                    if((u32Len % g_usbd_CtrlMaxPktSize) == 0)
-                    {
-                        g_usbd_CtrlInZeroFlag = (uint8_t)1;
-                    }
-                }
-                USBD_PrepareCtrlIn((uint8_t *)g_usbd_sInfo->gu8StringDesc[g_usbd_SetupPacket[2]], u32Len);
-
-                break;
-            }
-            else
-            {
-                // Not support. Reply STALL.
-                USBD_SET_EP_STALL(EP0);
-                USBD_SET_EP_STALL(EP1);
-
-                DBG_PRINTF("Unsupported string desc (%d). Stall ctrl pipe.\n", g_usbd_SetupPacket[2]);
-
-                break;
-            }
-        }
-
         default:
-            // Not support. Reply STALL.
-            USBD_SET_EP_STALL(EP0);
-            USBD_SET_EP_STALL(EP1);
+            break;
+    }
 
-            DBG_PRINTF("Unsupported get desc type. stall ctrl pipe\n");
+    if((psDesc == NULL) || (psDesc->pu8Desc == NULL))
+    {
+        // Not support. Reply STALL.
+        USBD_SET_EP_STALL(EP0);
+        USBD_SET_EP_STALL(EP1);
 
-            break;
+        DBG_PRINTF("Unsupported get desc type 0x%x. stall ctrl pipe\n", g_usbd_SetupPacket[3]);
+        return;
+    }
+
+    /* A descriptor shorter than asked for ends with a short packet, or a zero length packet on a packet boundary */
+    if(u32Len > psDesc->u16Len)
+    {
+        u32Len = psDesc->u16Len;
+        g_usbd_CtrlInZeroFlag = psDesc->u8Zlp;
     }
+    DBG_PRINTF("Get desc 0x%x, %d\n", g_usbd_SetupPacket[3], u32Len);
+
+    USBD_PrepareCtrlIn((uint8_t *)psDesc->pu8Desc, u32Len);
 }
 
 /**
@@ -316,6 +485,7 @@ void USBD_GetDescriptor(void)
   */
 void USBD_StandardRequest(void)
 {
+    S_USBD_FUNC_T *psFunc;
 
     /* clear global variables for new request */
     g_usbd_CtrlInPointer = 0;
@@ -458,6 +628,9 @@ void USBD_StandardRequest(void)
             {
                 g_usbd_UsbConfig = g_usbd_SetupPacket[2];
 
+                if(g_usbd_UsbConfig != 0)
+                    USBD_ConfigFunctions();
+
                 if(g_usbd_pfnSetConfigCallback)
                     g_usbd_pfnSetConfigCallback();
 
@@ -496,6 +669,8 @@ void USBD_StandardRequest(void)
                 g_usbd_UsbAltInterface = g_usbd_SetupPacket[2];
                 if(g_usbd_pfnSetInterface != NULL)
                     g_usbd_pfnSetInterface();
+                else if(((psFunc = USBD_FindFunction()) != NULL) && (psFunc->pfnSetInterface != NULL))
+                    psFunc->pfnSetInterface(psFunc, g_usbd_SetupPacket[4], g_usbd_SetupPacket[2]);
                 /* Status stage */
                 USBD_SET_DATA1(EP0);
                 USBD_SET_PAYLOAD_LEN(EP0, 0);
@@ -531,25 +706,14 @@ void USBD_StandardRequest(void)
   */
 void USBD_PrepareCtrlIn(uint8_t *pu8Buf, uint32_t u32Size)
 {
+    uint32_t u32Len = Minimum(u32Size, g_usbd_CtrlMaxPktSize);
+
     DBG_PRINTF("Prepare Ctrl In %d\n", u32Size);
-    if(u32Size > g_usbd_CtrlMaxPktSize)
-    {
-        // Data size > MXPLD
-        g_usbd_CtrlInPointer = pu8Buf + g_usbd_CtrlMaxPktSize;
-        g_usbd_CtrlInSize = u32Size - g_usbd_CtrlMaxPktSize;
-        USBD_SET_DATA1(EP0);
-        USBD_MemCopy((uint8_t *)USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0), pu8Buf, g_usbd_CtrlMaxPktSize);
-        USBD_SET_PAYLOAD_LEN(EP0, g_usbd_CtrlMaxPktSize);
-    }
-    else
-    {
-        // Data size <= MXPLD
-        g_usbd_CtrlInPointer = 0;
-        g_usbd_CtrlInSize = 0;
-        USBD_SET_DATA1(EP0);
-        USBD_MemCopy((uint8_t *)USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0), pu8Buf, u32Size);
-        USBD_SET_PAYLOAD_LEN(EP0, u32Size);
-    }
+    /* First packet now, USBD_CtrlIn() sends the rest */
+    g_usbd_CtrlInPointer = pu8Buf + u32Len;
+    g_usbd_CtrlInSize = u32Size - u32Len;
+    USBD_SET_DATA1(EP0);
+    USBD_WriteEP(EP0, pu8Buf, u32Len);
 }
 
 /**
@@ -564,26 +728,16 @@ void USBD_PrepareCtrlIn(uint8_t *pu8Buf, uint32_t u32Size)
   */
 void USBD_CtrlIn(void)
 {
+    uint32_t u32Len;
+
     DBG_PRINTF("Ctrl In Ack. residue %d\n", g_usbd_CtrlInSize);
     if(g_usbd_CtrlInSize)
     {
-        // Process remained data
-        if(g_usbd_CtrlInSize > g_usbd_CtrlMaxPktSize)
-        {
-            // Data size > MXPLD
-            USBD_MemCopy((uint8_t *)USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0), (uint8_t *)g_usbd_CtrlInPointer, g_usbd_CtrlMaxPktSize);
-            USBD_SET_PAYLOAD_LEN(EP0, g_usbd_CtrlMaxPktSize);
-            g_usbd_CtrlInPointer += g_usbd_CtrlMaxPktSize;
-            g_usbd_CtrlInSize -= g_usbd_CtrlMaxPktSize;
-        }
-        else
-        {
-            // Data size <= MXPLD
-            USBD_MemCopy((uint8_t *)USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0), (uint8_t *)g_usbd_CtrlInPointer, g_usbd_CtrlInSize);
-            USBD_SET_PAYLOAD_LEN(EP0, g_usbd_CtrlInSize);
-            g_usbd_CtrlInPointer = 0;
-            g_usbd_CtrlInSize = 0;
-        }
+        // Process remained data, a full packet or the short last one
+        u32Len = Minimum(g_usbd_CtrlInSize, g_usbd_CtrlMaxPktSize);
+        USBD_WriteEP(EP0, (uint8_t *)g_usbd_CtrlInPointer, u32Len);
+        g_usbd_CtrlInPointer += u32Len;
+        g_usbd_CtrlInSize -= u32Len;
     }
     else // No more data for IN token
     {
@@ -648,8 +802,7 @@ void USBD_CtrlOut(void)
         g_usbd_CtrlOutToggle = USBD->EPSTS & USBD_EPSTS_EPSTS1_Msk;
         if(g_usbd_CtrlOutSize < g_usbd_CtrlOutSizeLimit)
         {
-            u32Size = USBD_GET_PAYLOAD_LEN(EP1);
-            USBD_MemCopy((uint8_t *)g_usbd_CtrlOutPointer, (uint8_t *)USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP1), u32Size);
+            u32Size = USBD_ReadEP(EP1, (uint8_t *)g_usbd_CtrlOutPointer);
             g_usbd_CtrlOutPointer += u32Size;
             g_usbd_CtrlOutSize += u32Size;
 
@@ -738,9 +891,200 @@ void USBD_LockEpStall(uint32_t u32EpBitmap)
     g_u32EpStallLock = u32EpBitmap;
 }
 
+/**
+ * @brief       Register a class function of a (composite) device
+ *
+ * @param[in]   psFunc  Class function with its interfaces, endpoint table and callbacks filled in. It is kept by the
+ *                      driver and must stay valid while USBD is used.
+ *
+ * @retval      0       Endpoints assigned and configured
+ * @retval      -1      An endpoint is not in the configuration descriptor within the interfaces of the function,
+ *                      or there are not enough hardware endpoints or endpoint buffer SRAM left
+ *
+ * @details     Call after USBD_Open() and before USBD_Start(). Each endpoint of the function gets the next free
+ *              hardware endpoint, starting at EP2, and a buffer of its largest wMaxPacketSize in all alternate
+ *              settings, rounded up to 8 bytes. Buffers are packed back to back after the control pipe, so the
+ *              512-byte endpoint buffer SRAM holds the sum of the packet sizes and nothing else. OUT endpoints are
+ *              armed for a full packet.
+ *              Class requests and SET_INTERFACE addressed to the interfaces or endpoints of the function go to its
+ *              callbacks, when USBD_Open() was called without the legacy callbacks. On SET_CONFIGURATION the
+ *              endpoints are reset as at registration before pfnSetConfig is called. USBD_EventIRQHandler() and
+ *              USBD_DispatchEpEvents() call pfnEvent of the endpoint table.
+ */
+int32_t USBD_RegisterFunction(S_USBD_FUNC_T *psFunc)
+{
+    S_USBD_FUNC_EP_T *psEp;
+    S_USBD_FUNC_T **ppsTail;
+    uint32_t i, u32Type = 0, u32HwEp = g_usbd_NextHwEp, u32BufSeg = g_usbd_NextBufSeg;
+
+    /* Assign everything first, so that a failing call leaves the hardware alone */
+    for(i = 0; i < psFunc->u8EpCount; i++)
+    {
+        psEp = &psFunc->psEp[i];
+        psEp->u32MaxPkt = USBD_FindEpDesc(psFunc, psEp->u32Addr, &u32Type);
+        if((psEp->u32MaxPkt == 0) || (u32HwEp >= USBD_MAX_EP) || (u32BufSeg + psEp->u32MaxPkt > USBD_BUF_SIZE))
+            return -1;
+
+        psEp->u32HwEp = u32HwEp++;
+        psEp->u32BufSeg = u32BufSeg;
+        u32BufSeg += (psEp->u32MaxPkt + 7) & ~7UL;
+    }
+
+    for(i = 0; i < psFunc->u8EpCount; i++)
+    {
+        psEp = &psFunc->psEp[i];
+        USBD_FindEpDesc(psFunc, psEp->u32Addr, &u32Type);
+        USBD_CONFIG_EP(psEp->u32HwEp, ((psEp->u32Addr & EP_INPUT) ? USBD_CFG_EPMODE_IN : USBD_CFG_EPMODE_OUT) |
+                       ((u32Type == EP_ISO) ? USBD_CFG_TYPE_ISO : 0) | (psEp->u32Addr & 0xF));
+        USBD_ResetFunctionEp(psEp);
+        g_usbd_EpFunc[psEp->u32HwEp] = psFunc;
+        g_usbd_EpEntry[psEp->u32HwEp] = psEp;
+        g_usbd_EpHandler[psEp->u32HwEp] = USBD_FuncEpHandler;
+    }
+    g_usbd_NextHwEp = u32HwEp;
+    g_usbd_NextBufSeg = u32BufSeg;
+
+    psFunc->psNext = NULL;
+    for(ppsTail = &g_usbd_FuncList; *ppsTail != NULL; ppsTail = &(*ppsTail)->psNext);
+    *ppsTail = psFunc;
+
+    return 0;
+}
+
+/**
+ * @brief       Route endpoint events to the registered class functions
+ *
+ * @param[in]   u32IntSts   USBD_INTSTS value read by USBD_IRQHandler
+ *
+ * @return      None
+ *
+ * @details     For an application USBD_IRQHandler that keeps its own control pipe handling. Clears the EP2 ~ EP7
+ *              event flags set in u32IntSts with one write, then calls the endpoint handler of each of these
+ *              hardware endpoints, see USBD_EventIRQHandler().
+ */
+void USBD_DispatchEpEvents(uint32_t u32IntSts)
+{
+    uint32_t u32Ep, u32HwEp;
+
+    u32IntSts &= (USBD_INTSTS_EP2 | USBD_INTSTS_EP3 | USBD_INTSTS_EP4 | USBD_INTSTS_EP5 | USBD_INTSTS_EP6 | USBD_INTSTS_EP7);
+    if(u32IntSts == 0)
+        return;
+    USBD_CLR_INT_FLAG(u32IntSts);
+
+    for(u32Ep = u32IntSts >> USBD_INTSTS_EPEVT0_Pos; u32Ep != 0; u32Ep &= u32Ep - 1)
+    {
+        u32HwEp = USBD_LOWEST_BIT(u32Ep);
+        if(g_usbd_EpHandler[u32HwEp] != NULL)
+            g_usbd_EpHandler[u32HwEp](u32HwEp);
+    }
+}
+
+/**
+ * @brief       Set the handler of a hardware endpoint event
+ *
+ * @param[in]   u32HwEp     Hardware endpoint EP0 ~ EP7
+ * @param[in]   pfnHandler  Handler called with u32HwEp after the event flag is cleared, NULL to only clear it
+ *
+ * @return      None
+ *
+ * @details     USBD_Open() installs USBD_CtrlIn() on EP0 and USBD_CtrlOut() on EP1, USBD_RegisterFunction() the
+ *              pfnEvent callbacks of the function endpoints. This replaces the handler of one hardware endpoint,
+ *              for samples that configure their endpoints by hand.
+ */
+void USBD_SetEpHandler(uint32_t u32HwEp, USBD_EP_HANDLER pfnHandler)
+{
+    g_usbd_EpHandler[u32HwEp] = pfnHandler;
+}
+
+/**
+ * @brief       Set the bus event handler
+ *
+ * @param[in]   pfnHandler  Handler called with USBD_GET_BUS_STATE() after a bus event has been handled, can be NULL
+ *
+ * @return      None
+ *
+ * @details     USBD_EventIRQHandler() enables the controller and calls USBD_SwReset() on bus reset, turns the PHY
+ *              off on suspend and back on on resume. The handler adds what the class needs on top, like dropping
+ *              a transfer in progress. Call after USBD_Open().
+ */
+void USBD_SetBusHandler(USBD_BUS_HANDLER pfnHandler)
+{
+    g_usbd_pfnBusHandler = pfnHandler;
+}
+
+/**
+ * @brief       USBD interrupt handler
+ *
+ * @param       None
+ *
+ * @return      None
+ *
+ * @details     Called by the application USBD_IRQHandler, in place of the per endpoint if-chain of the samples.
+ *              Handles VBUS detect, wake-up and bus events, then the SETUP packet, then the endpoint events.
+ *              All pending endpoint flags are cleared with one write and only the set bits are visited, each
+ *              found with a constant time lowest-bit lookup, so the handler cost grows with the number of
+ *              completed endpoints instead of the number of hardware endpoints.
+ */
+void USBD_EventIRQHandler(void)
+{
+    uint32_t u32IntSts = USBD_GET_INT_FLAG();
+    uint32_t u32State, u32Ep, u32HwEp;
+
+    if(u32IntSts & (USBD_INTSTS_FLDET | USBD_INTSTS_WAKEUP | USBD_INTSTS_BUS))
+    {
+        USBD_CLR_INT_FLAG(u32IntSts & (USBD_INTSTS_FLDET | USBD_INTSTS_WAKEUP | USBD_INTSTS_BUS));
+
+        if(u32IntSts & USBD_INTSTS_FLDET)
+        {
+            if(USBD_IS_ATTACHED())
+                USBD_ENABLE_USB();      /* USB plug in */
+            else
+                USBD_DISABLE_USB();     /* USB un-plug */
+        }
+
+        if(u32IntSts & USBD_INTSTS_BUS)
+        {
+            u32State = USBD_GET_BUS_STATE();
+            if(u32State & USBD_STATE_USBRST)
+            {
+                USBD_ENABLE_USB();
+                USBD_SwReset();
+            }
+            if(u32State & USBD_STATE_SUSPEND)
+                USBD_DISABLE_PHY();     /* Enable USB but disable PHY */
+            if(u32State & USBD_STATE_RESUME)
+                USBD_ENABLE_USB();
+            if(g_usbd_pfnBusHandler != NULL)
+                g_usbd_pfnBusHandler(u32State);
+        }
+    }
+
+    if(u32IntSts & USBD_INTSTS_USB)
+    {
+        if(u32IntSts & USBD_INTSTS_SETUP)
+        {
+            USBD_CLR_INT_FLAG(USBD_INTSTS_SETUP);
 
+            /* Clear the data IN/OUT ready flag of control end-points */
+            USBD_STOP_TRANSACTION(EP0);
+            USBD_STOP_TRANSACTION(EP1);
 
+            USBD_ProcessSetupPacket();
+        }
 
+        u32Ep = (u32IntSts >> USBD_INTSTS_EPEVT0_Pos) & ((1UL << USBD_MAX_EP) - 1);
+        if(u32Ep != 0)
+        {
+            USBD_CLR_INT_FLAG(u32Ep << USBD_INTSTS_EPEVT0_Pos);
+            for(; u32Ep != 0; u32Ep &= u32Ep - 1)
+            {
+                u32HwEp = USBD_LOWEST_BIT(u32Ep);
+                if(g_usbd_EpHandler[u32HwEp] != NULL)
+                    g_usbd_EpHandler[u32HwEp](u32HwEp);
+            }
+        }
+    }
+}
 
 /*@}*/ /* end of group USBD_EXPORTED_FUNCTIONS */
 
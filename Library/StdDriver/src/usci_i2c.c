@@ -1728,6 +1728,442 @@ uint32_t UI2C_ReadMultiBytesTwoRegs(UI2C_T *ui2c, uint8_t u8SlaveAddr, uint16_t
     return u32rxLen;                                                                  /* Return bytes length that have been received */
 }
 
+
+static S_UI2C_SLAVE_T *s_apsUi2cSlave[UI2C_SLAVE_NUM];
+static S_UI2C_ASYNC_T *s_apsUi2cAsync[UI2C_ASYNC_NUM];
+
+static uint32_t UI2C_GetIndex(UI2C_T *ui2c)
+{
+    return (ui2c == UI2C0) ? 0 : ((ui2c == UI2C1) ? 1 : 2);
+}
+
+/* Report the registers written since the last SLA+W */
+static void UI2C_SlaveWriteDone(S_UI2C_SLAVE_T *psSlave)
+{
+    uint32_t u32Len = psSlave->u32WrLen;
+
+    psSlave->u32WrLen = 0;
+    if((u32Len != 0) && (psSlave->pfnWrite != NULL))
+        psSlave->pfnWrite(psSlave, psSlave->u8Addr, psSlave->u32WrReg, (u32Len > psSlave->u32Size) ? psSlave->u32Size : u32Len);
+}
+
+
+/**
+ *    @brief        Start the USCI_I2C slave register map
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *    @param[in]    psSlave     Register map. pu8Regs, u32Size, u32PtrLen and the callbacks must be set. It must stay
+ *                              valid until UI2C_CloseSlave is called.
+ *
+ *    @retval       0           Slave is addressable
+ *    @retval       -1          The module is used by UI2C_OpenAsync, pu8Regs is NULL, u32Size is 0 or u32PtrLen
+ *                              is not 1 or 2
+ *
+ *    @details      USCI_I2C must be configured by UI2C_Open, and the slave addresses by UI2C_SetSlaveAddr and
+ *                  UI2C_SetSlaveAddrMask before. Both address registers and their masks share the register map;
+ *                  callbacks get the address of the transfer. This function enables the START, STOP, ACK and NACK
+ *                  protocol interrupts and the address acknowledge. The application USCI_IRQHandler has to call
+ *                  UI2C_SlaveIRQHandler and the NVIC USCI IRQ must be enabled. SCL is held low from every
+ *                  protocol event until the handler returns, so the callbacks should be short. USCI_I2C has no
+ *                  PDMA request, every data byte interrupts.
+ */
+int32_t UI2C_OpenSlave(UI2C_T *ui2c, S_UI2C_SLAVE_T *psSlave)
+{
+    if(s_apsUi2cAsync[UI2C_GetIndex(ui2c)] != NULL)
+        return -1;
+    if((psSlave->pu8Regs == NULL) || (psSlave->u32Size == 0) || (psSlave->u32PtrLen < 1) || (psSlave->u32PtrLen > 2))
+        return -1;
+
+    psSlave->u32Ptr = 0;
+    psSlave->u32PtrIdx = 0;
+    psSlave->u32WrLen = 0;
+    psSlave->u32Event = SLAVE_ADDRESS_ACK;
+    s_apsUi2cSlave[UI2C_GetIndex(ui2c)] = psSlave;
+
+    UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_STARIF_Msk | UI2C_PROTSTS_ACKIF_Msk | UI2C_PROTSTS_NACKIF_Msk | UI2C_PROTSTS_STORIF_Msk);
+    UI2C_ENABLE_PROT_INT(ui2c, UI2C_PROTIEN_ACKIEN_Msk | UI2C_PROTIEN_NACKIEN_Msk | UI2C_PROTIEN_STORIEN_Msk | UI2C_PROTIEN_STARIEN_Msk);
+    UI2C_SET_CONTROL_REG(ui2c, UI2C_CTL_PTRG | UI2C_CTL_AA);
+    return 0;
+}
+
+
+/**
+ *    @brief        Stop the USCI_I2C slave register map
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *
+ *    @return       None
+ *
+ *    @details      Stops acknowledging the slave addresses and disables the protocol interrupts enabled by
+ *                  UI2C_OpenSlave.
+ */
+void UI2C_CloseSlave(UI2C_T *ui2c)
+{
+    UI2C_DISABLE_PROT_INT(ui2c, UI2C_PROTIEN_ACKIEN_Msk | UI2C_PROTIEN_NACKIEN_Msk | UI2C_PROTIEN_STORIEN_Msk | UI2C_PROTIEN_STARIEN_Msk);
+    UI2C_SET_CONTROL_REG(ui2c, UI2C_CTL_PTRG);
+    s_apsUi2cSlave[UI2C_GetIndex(ui2c)] = NULL;
+}
+
+
+/**
+ *    @brief        Serve the USCI_I2C slave register map
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *
+ *    @return       None
+ *
+ *    @details      Runs one step of the slave receiver or transmitter per protocol event. Register reads and
+ *                  writes go straight to the register file; pfnRead is called once per SLA+R and pfnWrite once
+ *                  per write transfer. A write beyond the pointer bytes wraps at the end of the map. Returns at
+ *                  once without a slave event, so it can share USCI_IRQHandler with the other USCI modules.
+ */
+void UI2C_SlaveIRQHandler(UI2C_T *ui2c)
+{
+    S_UI2C_SLAVE_T *psSlave = s_apsUi2cSlave[UI2C_GetIndex(ui2c)];
+    uint32_t u32Status, u32Data;
+
+    if(psSlave == NULL)
+        return;
+
+    u32Status = UI2C_GET_PROT_STATUS(ui2c);
+    if(u32Status & UI2C_PROTSTS_TOIF_Msk)
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_TOIF_Msk);
+        return;
+    }
+
+    if(u32Status & UI2C_PROTSTS_STARIF_Msk)                             /* START or repeated START received */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_STARIF_Msk);
+        UI2C_SlaveWriteDone(psSlave);
+        psSlave->u32Event = SLAVE_ADDRESS_ACK;
+    }
+    else if(u32Status & UI2C_PROTSTS_ACKIF_Msk)                         /* Address or data byte, ACK */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_ACKIF_Msk);
+        if(psSlave->u32Event == SLAVE_ADDRESS_ACK)
+        {
+            psSlave->u8Addr = (uint8_t)((UI2C_GET_DATA(ui2c) & 0xFF) >> 1);
+            if(u32Status & UI2C_PROTSTS_SLAREAD_Msk)                    /* Own SLA+R has been received, ACK returned */
+            {
+                psSlave->u32Event = SLAVE_SEND_DATA;
+                psSlave->u32Ptr %= psSlave->u32Size;                    /* Pointer may be cut short by a repeated START */
+                if(psSlave->pfnRead != NULL)
+                    psSlave->pfnRead(psSlave, psSlave->u8Addr, psSlave->u32Ptr);
+                UI2C_SET_DATA(ui2c, psSlave->pu8Regs[psSlave->u32Ptr]);
+                psSlave->u32Ptr = (psSlave->u32Ptr + 1 < psSlave->u32Size) ? (psSlave->u32Ptr + 1) : 0;
+            }
+            else                                                        /* Own SLA+W has been received, ACK returned */
+            {
+                psSlave->u32Event = SLAVE_GET_DATA;
+                psSlave->u32PtrIdx = 0;
+                psSlave->u32WrLen = 0;
+            }
+        }
+        else if(psSlave->u32Event == SLAVE_GET_DATA)                    /* Data byte received, ACK returned */
+        {
+            u32Data = UI2C_GET_DATA(ui2c) & 0xFF;
+            if(psSlave->u32PtrIdx < psSlave->u32PtrLen)
+            {
+                psSlave->u32Ptr = (psSlave->u32PtrIdx == 0) ? u32Data : ((psSlave->u32Ptr << 8) | u32Data);
+                if(++psSlave->u32PtrIdx == psSlave->u32PtrLen)
+                {
+                    psSlave->u32Ptr %= psSlave->u32Size;
+                    psSlave->u32WrReg = psSlave->u32Ptr;
+                }
+            }
+            else
+            {
+                psSlave->pu8Regs[psSlave->u32Ptr] = (uint8_t)u32Data;
+                psSlave->u32Ptr = (psSlave->u32Ptr + 1 < psSlave->u32Size) ? (psSlave->u32Ptr + 1) : 0;
+                psSlave->u32WrLen++;
+            }
+        }
+        else if(psSlave->u32Event == SLAVE_SEND_DATA)                   /* Data byte transmitted, ACK received */
+        {
+            UI2C_SET_DATA(ui2c, psSlave->pu8Regs[psSlave->u32Ptr]);
+            psSlave->u32Ptr = (psSlave->u32Ptr + 1 < psSlave->u32Size) ? (psSlave->u32Ptr + 1) : 0;
+        }
+    }
+    else if(u32Status & (UI2C_PROTSTS_NACKIF_Msk | UI2C_PROTSTS_STORIF_Msk))  /* Last byte NACK, or STOP received */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, u32Status & (UI2C_PROTSTS_NACKIF_Msk | UI2C_PROTSTS_STORIF_Msk));
+        UI2C_SlaveWriteDone(psSlave);
+        psSlave->u32Event = SLAVE_ADDRESS_ACK;
+    }
+    else
+        return;
+
+    UI2C_SET_CONTROL_REG(ui2c, UI2C_CTL_PTRG | UI2C_CTL_AA);
+}
+
+/* Complete the transfer on the bus and send STOP, the next queued transfer starts once the bus is free */
+static void UI2C_AsyncFinish(UI2C_T *ui2c, S_UI2C_ASYNC_T *psAsync, int32_t i32Status)
+{
+    S_UI2C_XFER_T *psXfer = psAsync->psHead;
+
+    psAsync->psHead = psXfer->psNext;
+    if(psAsync->psHead == NULL)
+        psAsync->psTail = NULL;
+    psXfer->i32Status = i32Status;
+
+    psAsync->u32Event = MASTER_STOP;
+    UI2C_SET_CONTROL_REG(ui2c, UI2C_CTL_PTRG | UI2C_CTL_STO);
+    if(psXfer->pfnCallback != NULL)
+        psXfer->pfnCallback(psXfer);
+}
+
+
+/**
+ *    @brief        Start interrupt driven master transfers on USCI_I2C
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *    @param[in]    psAsync     Control block. It must stay valid until UI2C_CloseAsync is called.
+ *
+ *    @return       None
+ *
+ *    @details      USCI_I2C must be configured by UI2C_Open before. This function enables the protocol interrupts.
+ *                  The application USCI_IRQHandler has to call UI2C_AsyncIRQHandler and the NVIC USCI IRQ must be
+ *                  enabled. Enable the bus time-out with UI2C_EnableTimeout to recover from a slave holding SCL
+ *                  low. USCI_I2C has no PDMA request, every byte interrupts.
+ */
+void UI2C_OpenAsync(UI2C_T *ui2c, S_UI2C_ASYNC_T *psAsync)
+{
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+    psAsync->u32Event = MASTER_SEND_START;
+    s_apsUi2cAsync[UI2C_GetIndex(ui2c)] = psAsync;
+
+    UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_TOIF_Msk | UI2C_PROTSTS_STARIF_Msk | UI2C_PROTSTS_STORIF_Msk |
+                           UI2C_PROTSTS_NACKIF_Msk | UI2C_PROTSTS_ARBLOIF_Msk | UI2C_PROTSTS_ERRIF_Msk | UI2C_PROTSTS_ACKIF_Msk);
+    UI2C_ENABLE_PROT_INT(ui2c, UI2C_PROTIEN_TOIEN_Msk | UI2C_PROTIEN_STARIEN_Msk | UI2C_PROTIEN_STORIEN_Msk |
+                         UI2C_PROTIEN_NACKIEN_Msk | UI2C_PROTIEN_ARBLOIEN_Msk | UI2C_PROTIEN_ERRIEN_Msk | UI2C_PROTIEN_ACKIEN_Msk);
+}
+
+
+/**
+ *    @brief        Stop interrupt driven master transfers on USCI_I2C
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *
+ *    @return       None
+ *
+ *    @details      Disables the protocol interrupts and sends STOP if a transfer is on the bus. Queued transfers are
+ *                  completed with \ref UI2C_ERR_FAIL without calling their callback.
+ */
+void UI2C_CloseAsync(UI2C_T *ui2c)
+{
+    S_UI2C_ASYNC_T *psAsync = s_apsUi2cAsync[UI2C_GetIndex(ui2c)];
+    S_UI2C_XFER_T *psXfer;
+
+    UI2C_DISABLE_PROT_INT(ui2c, UI2C_PROTIEN_TOIEN_Msk | UI2C_PROTIEN_STARIEN_Msk | UI2C_PROTIEN_STORIEN_Msk |
+                          UI2C_PROTIEN_NACKIEN_Msk | UI2C_PROTIEN_ARBLOIEN_Msk | UI2C_PROTIEN_ERRIEN_Msk | UI2C_PROTIEN_ACKIEN_Msk);
+    s_apsUi2cAsync[UI2C_GetIndex(ui2c)] = NULL;
+    if((psAsync == NULL) || (psAsync->psHead == NULL))
+        return;
+
+    if(psAsync->u32Event != MASTER_STOP)
+        UI2C_SET_CONTROL_REG(ui2c, UI2C_CTL_PTRG | UI2C_CTL_STO);
+    for(psXfer = psAsync->psHead; psXfer != NULL; psXfer = psXfer->psNext)
+        psXfer->i32Status = UI2C_ERR_FAIL;
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+}
+
+
+/**
+ *    @brief        Queue an interrupt driven USCI_I2C master transfer
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *    @param[in]    psXfer      Transfer descriptor. u8SlaveAddr, u8Dir, u8RegLen, u32RegAddr, pu8Buf, u32Len,
+ *                              pfnCallback and pvArg must be set. It must stay valid until the transfer is done.
+ *
+ *    @retval       UI2C_OK         Transfer is queued
+ *    @retval       UI2C_ERR_FAIL   UI2C_OpenAsync was not called or the descriptor is invalid
+ *
+ *    @details      This function never waits. The transfer starts at once if the bus is idle, otherwise after the
+ *                  transfers queued before it. Its i32Status stays \ref UI2C_XFER_PENDING until it is done and the
+ *                  callback is called from the USCI interrupt once STOP is requested. A register read is a
+ *                  \ref UI2C_XFER_READ with u8RegLen set, it writes the register address and reads after a repeated
+ *                  START. Can be called from a transfer callback.
+ */
+int32_t UI2C_SubmitAsync(UI2C_T *ui2c, S_UI2C_XFER_T *psXfer)
+{
+    S_UI2C_ASYNC_T *psAsync = s_apsUi2cAsync[UI2C_GetIndex(ui2c)];
+    uint32_t u32Primask;
+
+    if((psAsync == NULL) || (psXfer->u8RegLen > 4) || ((psXfer->u8Dir == UI2C_XFER_READ) && (psXfer->u32Len == 0)))
+        return UI2C_ERR_FAIL;
+
+    psXfer->psNext = NULL;
+    psXfer->u8RegIdx = 0;
+    psXfer->u32Count = 0;
+    psXfer->i32Status = UI2C_XFER_PENDING;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    if(psAsync->psHead == NULL)
+    {
+        psAsync->psHead = psXfer;
+        psAsync->psTail = psXfer;
+        /* With the STOP of the previous transfer still on the bus, STORIF starts this one */
+        if(psAsync->u32Event != MASTER_STOP)
+            UI2C_SET_CONTROL_REG(ui2c, UI2C_CTL_STA);
+    }
+    else
+    {
+        psAsync->psTail->psNext = psXfer;
+        psAsync->psTail = psXfer;
+    }
+    __set_PRIMASK(u32Primask);
+
+    return UI2C_OK;
+}
+
+
+/**
+ *    @brief        Check if interrupt driven USCI_I2C master transfers are pending
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *
+ *    @retval       0   No transfer is queued
+ *    @retval       1   A transfer is on the bus or queued
+ */
+uint32_t UI2C_IsAsyncBusy(UI2C_T *ui2c)
+{
+    S_UI2C_ASYNC_T *psAsync = s_apsUi2cAsync[UI2C_GetIndex(ui2c)];
+
+    return ((psAsync != NULL) && (psAsync->psHead != NULL)) ? 1 : 0;
+}
+
+
+/**
+ *    @brief        USCI_I2C interrupt handler for interrupt driven master transfers
+ *
+ *    @param[in]    ui2c        The pointer of the specified USCI_I2C module.
+ *
+ *    @return       None
+ *
+ *    @details      Runs the START, address, register address, data and STOP sequence of the transfer on the bus,
+ *                  one step per protocol event. NACK, arbitration lost and bus error complete the transfer with
+ *                  \ref UI2C_ERR_FAIL, a bus time-out with \ref UI2C_ERR_TIMEOUT, and the next queued transfer
+ *                  starts after the STOP. Returns at once if UI2C_OpenAsync was not called, so it can share
+ *                  USCI_IRQHandler with the other USCI modules.
+ */
+void UI2C_AsyncIRQHandler(UI2C_T *ui2c)
+{
+    S_UI2C_ASYNC_T *psAsync = s_apsUi2cAsync[UI2C_GetIndex(ui2c)];
+    S_UI2C_XFER_T *psXfer;
+    uint32_t u32Status, u32Ctrl;
+
+    if(psAsync == NULL)
+        return;
+
+    u32Status = UI2C_GET_PROT_STATUS(ui2c);
+    if(u32Status & UI2C_PROTSTS_TOIF_Msk)
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_TOIF_Msk);
+        if((psAsync->psHead != NULL) && (psAsync->u32Event != MASTER_STOP))
+            UI2C_AsyncFinish(ui2c, psAsync, UI2C_ERR_TIMEOUT);
+        return;
+    }
+
+    if(u32Status & UI2C_PROTSTS_STORIF_Msk)                             /* STOP has been transmitted, the bus is free */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_STORIF_Msk);
+        if(psAsync->u32Event == MASTER_STOP)
+        {
+            psAsync->u32Event = MASTER_SEND_START;
+            if(psAsync->psHead != NULL)
+                UI2C_SET_CONTROL_REG(ui2c, UI2C_CTL_STA);
+        }
+        return;
+    }
+
+    u32Status &= UI2C_PROTSTS_STARIF_Msk | UI2C_PROTSTS_ACKIF_Msk | UI2C_PROTSTS_NACKIF_Msk | UI2C_PROTSTS_ARBLOIF_Msk | UI2C_PROTSTS_ERRIF_Msk;
+    psXfer = psAsync->psHead;
+    if((psXfer == NULL) || (psAsync->u32Event == MASTER_STOP))
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, u32Status);
+        return;
+    }
+
+    if(u32Status & UI2C_PROTSTS_STARIF_Msk)                             /* START or repeated START has been transmitted */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_STARIF_Msk);
+        if((psAsync->u32Event == MASTER_SEND_REPEAT_START) || ((psXfer->u8Dir == UI2C_XFER_READ) && (psXfer->u8RegLen == 0)))
+        {
+            UI2C_SET_DATA(ui2c, (uint8_t)((psXfer->u8SlaveAddr << 1) | 0x01));     /* Write SLA+R to Register TXDAT */
+            psAsync->u32Event = MASTER_SEND_H_RD_ADDRESS;
+        }
+        else
+        {
+            UI2C_SET_DATA(ui2c, (uint8_t)(psXfer->u8SlaveAddr << 1));              /* Write SLA+W to Register TXDAT */
+            psAsync->u32Event = MASTER_SEND_ADDRESS;
+        }
+        u32Ctrl = UI2C_CTL_PTRG;
+    }
+    else if(u32Status & UI2C_PROTSTS_ACKIF_Msk)                         /* Address or data byte, ACK */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_ACKIF_Msk);
+        if(psAsync->u32Event == MASTER_READ_DATA)                       /* Data byte received, ACK returned */
+        {
+            psXfer->pu8Buf[psXfer->u32Count++] = (uint8_t)UI2C_GET_DATA(ui2c);
+            u32Ctrl = ((psXfer->u32Count + 1) < psXfer->u32Len) ? (UI2C_CTL_PTRG | UI2C_CTL_AA) : UI2C_CTL_PTRG;
+        }
+        else if(psAsync->u32Event == MASTER_SEND_H_RD_ADDRESS)          /* SLA+R has been transmitted, ACK received */
+        {
+            psAsync->u32Event = MASTER_READ_DATA;
+            u32Ctrl = (psXfer->u32Len > 1) ? (UI2C_CTL_PTRG | UI2C_CTL_AA) : UI2C_CTL_PTRG;
+        }
+        else if(psXfer->u8RegIdx < psXfer->u8RegLen)                    /* SLA+W or data byte transmitted, ACK received */
+        {
+            UI2C_SET_DATA(ui2c, (uint8_t)(psXfer->u32RegAddr >> (8 * (psXfer->u8RegLen - 1 - psXfer->u8RegIdx))));
+            psXfer->u8RegIdx++;
+            psAsync->u32Event = MASTER_SEND_DATA;
+            u32Ctrl = UI2C_CTL_PTRG;
+        }
+        else if(psXfer->u8Dir == UI2C_XFER_READ)
+        {
+            psAsync->u32Event = MASTER_SEND_REPEAT_START;
+            u32Ctrl = UI2C_CTL_PTRG | UI2C_CTL_STA;                     /* Send repeated START */
+        }
+        else if(psXfer->u32Count < psXfer->u32Len)
+        {
+            UI2C_SET_DATA(ui2c, psXfer->pu8Buf[psXfer->u32Count++]);
+            psAsync->u32Event = MASTER_SEND_DATA;
+            u32Ctrl = UI2C_CTL_PTRG;
+        }
+        else
+        {
+            UI2C_AsyncFinish(ui2c, psAsync, UI2C_OK);
+            return;
+        }
+    }
+    else if(u32Status & UI2C_PROTSTS_NACKIF_Msk)                        /* Last data byte received, or address or data NACK */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, UI2C_PROTSTS_NACKIF_Msk);
+        if(psAsync->u32Event == MASTER_READ_DATA)
+        {
+            psXfer->pu8Buf[psXfer->u32Count++] = (uint8_t)UI2C_GET_DATA(ui2c);
+            UI2C_AsyncFinish(ui2c, psAsync, UI2C_OK);
+        }
+        else
+            UI2C_AsyncFinish(ui2c, psAsync, UI2C_ERR_FAIL);
+        return;
+    }
+    else if(u32Status)                                                  /* Arbitration lost or bus error */
+    {
+        UI2C_CLR_PROT_INT_FLAG(ui2c, u32Status);
+        UI2C_AsyncFinish(ui2c, psAsync, UI2C_ERR_FAIL);
+        return;
+    }
+    else
+        return;
+
+    UI2C_SET_CONTROL_REG(ui2c, u32Ctrl);
+}
+
 /*@}*/ /* end of group USCI_I2C_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group USCI_I2C_Driver */
@@ -513,6 +513,359 @@ void USPI_DisableWakeup(USPI_T *uspi)
     uspi->WKCTL &= ~USPI_WKCTL_WKEN_Msk;
 }
 
+#define USPI_BUF_DEPTH      2       /* TXDAT plus shift register, RX buffer levels */
+
+static S_USPI_ASYNC_T *s_apsUspiAsync[USPI_ASYNC_NUM];
+
+static void USPI_AsyncStart(USPI_T *uspi, S_USPI_ASYNC_T *psAsync);
+
+static uint32_t USPI_GetIndex(USPI_T *uspi)
+{
+    return (uspi == USPI0) ? 0 : ((uspi == USPI1) ? 1 : 2);
+}
+
+static USPI_T *USPI_GetModule(uint32_t u32Idx)
+{
+    return (u32Idx == 0) ? USPI0 : ((u32Idx == 1) ? USPI1 : USPI2);
+}
+
+/* Complete the transfer on the bus and start the next queued one */
+static void USPI_AsyncFinish(USPI_T *uspi, S_USPI_ASYNC_T *psAsync, int32_t i32Status)
+{
+    S_USPI_XFER_T *psXfer = psAsync->psHead;
+    S_USPI_XFER_T *psNext = psXfer->psNext;
+
+    if(!(psXfer->u32Flags & (USPI_XFER_KEEP_SS | USPI_XFER_NO_SS)))
+        uspi->PROTCTL &= ~USPI_PROTCTL_SS_Msk;
+
+    psAsync->psHead = psNext;
+    if(psNext == NULL)
+        psAsync->psTail = NULL;
+    psXfer->i32Status = i32Status;
+    if(psXfer->pfnCallback != NULL)
+        psXfer->pfnCallback(psXfer);
+
+    /* A transfer queued by the callback on an empty queue has been started by USPI_TransferIRQ/USPI_TransferDMA */
+    if(psNext != NULL)
+        USPI_AsyncStart(uspi, psAsync);
+}
+
+/* Move received units out of RX buffer and refill TXDAT, returns 1 when the transfer is complete */
+static uint32_t USPI_AsyncPump(USPI_T *uspi, S_USPI_ASYNC_T *psAsync)
+{
+    S_USPI_XFER_T *psXfer = psAsync->psHead;
+    uint32_t u32Rx = psXfer->u32RxCount, u32Tx = psXfer->u32TxCount, u32Len = psXfer->u32Len;
+    uint32_t u32Data;
+
+    for(; !USPI_GET_RX_EMPTY_FLAG(uspi) && (u32Rx < u32Tx); u32Rx++)
+    {
+        u32Data = USPI_READ_RX(uspi);
+        if(psXfer->pvRxBuf == NULL)
+            continue;
+        if(psAsync->u32Unit == 1)
+            ((uint8_t *)psXfer->pvRxBuf)[u32Rx] = (uint8_t)u32Data;
+        else
+            ((uint16_t *)psXfer->pvRxBuf)[u32Rx] = (uint16_t)u32Data;
+    }
+
+    /* At most USPI_BUF_DEPTH units in flight, so RX buffer cannot overrun while the interrupt is pending */
+    for(; (u32Tx < u32Len) && ((u32Tx - u32Rx) < USPI_BUF_DEPTH) && !USPI_GET_TX_FULL_FLAG(uspi); u32Tx++)
+    {
+        if(psXfer->pvTxBuf == NULL)
+            u32Data = 0xFFFF;
+        else if(psAsync->u32Unit == 1)
+            u32Data = ((const uint8_t *)psXfer->pvTxBuf)[u32Tx];
+        else
+            u32Data = ((const uint16_t *)psXfer->pvTxBuf)[u32Tx];
+        USPI_WRITE_TX(uspi, u32Data);
+    }
+
+    psXfer->u32RxCount = u32Rx;
+    psXfer->u32TxCount = u32Tx;
+
+    if(u32Tx == u32Rx)
+    {
+        uspi->INTEN &= ~USPI_INTEN_RXENDIEN_Msk;
+        return 1;
+    }
+
+    /* Interrupt at the end of each received unit, the next one is already shifting */
+    uspi->INTEN |= USPI_INTEN_RXENDIEN_Msk;
+    return 0;
+}
+
+/* Hand the next block of up to USPI_DMA_MAX_LEN units to the PDMA channels */
+static void USPI_AsyncStartDMA(USPI_T *uspi, S_USPI_ASYNC_T *psAsync)
+{
+    S_USPI_XFER_T *psXfer = psAsync->psHead;
+    uint32_t u32TxCh = (uint32_t)psAsync->i32TxCh, u32RxCh = (uint32_t)psAsync->i32RxCh;
+    uint32_t u32Idx = USPI_GetIndex(uspi), u32Unit = psAsync->u32Unit;
+    uint32_t u32Len = psXfer->u32Len - psXfer->u32RxCount, u32Width;
+
+    if(u32Len > USPI_DMA_MAX_LEN)
+        u32Len = USPI_DMA_MAX_LEN;
+    u32Width = (u32Unit == 1) ? PDMA_WIDTH_8 : PDMA_WIDTH_16;
+
+    USPI_DISABLE_TX_RX_PDMA(uspi);
+
+    PDMA_SetTransferCnt(u32RxCh, u32Width, u32Len);
+    if(psXfer->pvRxBuf != NULL)
+        PDMA_SetTransferAddr(u32RxCh, (uint32_t)&uspi->RXDAT, PDMA_SAR_FIX, (uint32_t)psXfer->pvRxBuf + psXfer->u32RxCount * u32Unit, PDMA_DAR_INC);
+    else
+        PDMA_SetTransferAddr(u32RxCh, (uint32_t)&uspi->RXDAT, PDMA_SAR_FIX, (uint32_t)&psAsync->u32RxSink, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(u32RxCh, PDMA_USCI0_RX + u32Idx * 2, FALSE, 0);
+    PDMA_SetBurstType(u32RxCh, PDMA_REQ_SINGLE, 0);
+
+    PDMA_SetTransferCnt(u32TxCh, u32Width, u32Len);
+    if(psXfer->pvTxBuf != NULL)
+        PDMA_SetTransferAddr(u32TxCh, (uint32_t)psXfer->pvTxBuf + psXfer->u32TxCount * u32Unit, PDMA_SAR_INC, (uint32_t)&uspi->TXDAT, PDMA_DAR_FIX);
+    else
+        PDMA_SetTransferAddr(u32TxCh, (uint32_t)&psAsync->u32TxFill, PDMA_SAR_FIX, (uint32_t)&uspi->TXDAT, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(u32TxCh, PDMA_USCI0_TX + u32Idx * 2, FALSE, 0);
+    PDMA_SetBurstType(u32TxCh, PDMA_REQ_SINGLE, 0);
+
+    psXfer->u32TxCount += u32Len;
+
+    /* RX request first, so no received unit is missed */
+    USPI_TRIGGER_RX_PDMA(uspi);
+    USPI_TRIGGER_TX_PDMA(uspi);
+}
+
+/* PDMA RX channel callback, the block is complete when its last unit is received */
+static void USPI_AsyncDMADone(uint32_t u32Ch, uint32_t u32Event)
+{
+    S_USPI_ASYNC_T *psAsync;
+    S_USPI_XFER_T *psXfer;
+    USPI_T *uspi;
+    uint32_t i;
+
+    for(i = 0; i < USPI_ASYNC_NUM; i++)
+    {
+        psAsync = s_apsUspiAsync[i];
+        if((psAsync != NULL) && (psAsync->i32RxCh == (int32_t)u32Ch))
+            break;
+    }
+    if(i == USPI_ASYNC_NUM)
+        return;
+
+    uspi = USPI_GetModule(i);
+    psXfer = psAsync->psHead;
+    if((psXfer == NULL) || !(psXfer->u32Flags & USPI_XFER_DMA))
+        return;
+
+    USPI_DISABLE_TX_RX_PDMA(uspi);
+    if(u32Event & PDMA_EVENT_ABORT)
+    {
+        USPI_ClearTxBuf(uspi);
+        USPI_AsyncFinish(uspi, psAsync, -1);
+        return;
+    }
+
+    psXfer->u32RxCount = psXfer->u32TxCount;
+    if(psXfer->u32RxCount < psXfer->u32Len)
+        USPI_AsyncStartDMA(uspi, psAsync);
+    else
+        USPI_AsyncFinish(uspi, psAsync, 0);
+}
+
+/* Select the slave and start the transfer at the queue head */
+static void USPI_AsyncStart(USPI_T *uspi, S_USPI_ASYNC_T *psAsync)
+{
+    S_USPI_XFER_T *psXfer = psAsync->psHead;
+    uint32_t u32Width = (uspi->LINECTL & USPI_LINECTL_DWIDTH_Msk) >> USPI_LINECTL_DWIDTH_Pos;
+
+    psAsync->u32Unit = ((u32Width == 0) || (u32Width > 8)) ? 2 : 1;
+
+    if(!(psXfer->u32Flags & USPI_XFER_NO_SS))
+        uspi->PROTCTL = (uspi->PROTCTL & ~USPI_PROTCTL_AUTOSS_Msk) | USPI_PROTCTL_SS_Msk;
+
+    USPI_CLR_PROT_INT_FLAG(uspi, USPI_PROTSTS_RXENDIF_Msk);
+    if(psXfer->u32Flags & USPI_XFER_DMA)
+        USPI_AsyncStartDMA(uspi, psAsync);
+    else
+        USPI_AsyncPump(uspi, psAsync);
+}
+
+static int32_t USPI_AsyncSubmit(USPI_T *uspi, S_USPI_XFER_T *psXfer, uint32_t u32Dma)
+{
+    S_USPI_ASYNC_T *psAsync = s_apsUspiAsync[USPI_GetIndex(uspi)];
+    uint32_t u32Primask;
+
+    if((psAsync == NULL) || (psXfer->u32Len == 0) || (u32Dma && (psAsync->i32RxCh < 0)))
+        return -1;
+
+    psXfer->psNext = NULL;
+    psXfer->u32Flags = (psXfer->u32Flags & ~USPI_XFER_DMA) | u32Dma;
+    psXfer->u32TxCount = 0;
+    psXfer->u32RxCount = 0;
+    psXfer->i32Status = USPI_XFER_PENDING;
+
+    u32Primask = __get_PRIMASK();
+    __set_PRIMASK(1);
+    if(psAsync->psHead == NULL)
+    {
+        psAsync->psHead = psXfer;
+        psAsync->psTail = psXfer;
+        USPI_AsyncStart(uspi, psAsync);
+    }
+    else
+    {
+        psAsync->psTail->psNext = psXfer;
+        psAsync->psTail = psXfer;
+    }
+    __set_PRIMASK(u32Primask);
+
+    return 0;
+}
+
+/**
+  * @brief  Start queued transfers on USCI_SPI.
+  * @param[in]  uspi The pointer of the specified USCI_SPI module.
+  * @param[in]  psAsync Control block. It must stay valid until USPI_CloseAsync is called.
+  * @param[in]  u32ActiveLevel Slave select active level. Valid values are \ref USPI_SS_ACTIVE_LOW and \ref USPI_SS_ACTIVE_HIGH.
+  * @param[in]  u32UseDMA 1 to take two PDMA channels for \ref USPI_TransferDMA, 0 for \ref USPI_TransferIRQ only.
+  * @retval 0 Success.
+  * @retval -1 No free PDMA channel.
+  * @details USCI_SPI must be opened in master mode by USPI_Open before. Automatic slave select is disabled, the driver
+  *          drives USCI_SPI_SS for each transfer instead. USCI0, USCI1 and USCI2 share one interrupt, so the
+  *          application USCI_IRQHandler has to call USPI_AsyncIRQHandler for each module in use and the NVIC USCI IRQ
+  *          must be enabled for \ref USPI_TransferIRQ. PDMA clock must be enabled and PDMA_IRQHandler has to call
+  *          PDMA_ChannelIRQHandler for \ref USPI_TransferDMA.
+  */
+int32_t USPI_OpenAsync(USPI_T *uspi, S_USPI_ASYNC_T *psAsync, uint32_t u32ActiveLevel, uint32_t u32UseDMA)
+{
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+    psAsync->i32TxCh = -1;
+    psAsync->i32RxCh = -1;
+    psAsync->u32TxFill = 0xFFFFFFFF;
+
+    if(u32UseDMA)
+    {
+        psAsync->i32RxCh = PDMA_RequestChannel(PDMA_CH_ANY, USPI_AsyncDMADone);
+        psAsync->i32TxCh = PDMA_RequestChannel(PDMA_CH_ANY, NULL);
+        if((psAsync->i32RxCh < 0) || (psAsync->i32TxCh < 0))
+        {
+            if(psAsync->i32RxCh >= 0)
+                PDMA_ReleaseChannel((uint32_t)psAsync->i32RxCh);
+            if(psAsync->i32TxCh >= 0)
+                PDMA_ReleaseChannel((uint32_t)psAsync->i32TxCh);
+            return -1;
+        }
+    }
+
+    USPI_DisableAutoSS(uspi);
+    uspi->LINECTL = (uspi->LINECTL & ~USPI_LINECTL_CTLOINV_Msk) | u32ActiveLevel;
+    USPI_ClearRxBuf(uspi);
+    s_apsUspiAsync[USPI_GetIndex(uspi)] = psAsync;
+
+    return 0;
+}
+
+/**
+  * @brief  Stop queued transfers on USCI_SPI.
+  * @param[in]  uspi The pointer of the specified USCI_SPI module.
+  * @return None
+  * @details The transfer on the bus is dropped and slave select is released. Queued transfers are completed with
+  *          status -1 without calling their callback. PDMA channels taken by USPI_OpenAsync are freed.
+  */
+void USPI_CloseAsync(USPI_T *uspi)
+{
+    S_USPI_ASYNC_T *psAsync = s_apsUspiAsync[USPI_GetIndex(uspi)];
+    S_USPI_XFER_T *psXfer;
+
+    if(psAsync == NULL)
+        return;
+
+    s_apsUspiAsync[USPI_GetIndex(uspi)] = NULL;
+    uspi->INTEN &= ~USPI_INTEN_RXENDIEN_Msk;
+    USPI_DISABLE_TX_RX_PDMA(uspi);
+    if(psAsync->i32RxCh >= 0)
+        PDMA_ReleaseChannel((uint32_t)psAsync->i32RxCh);
+    if(psAsync->i32TxCh >= 0)
+        PDMA_ReleaseChannel((uint32_t)psAsync->i32TxCh);
+    USPI_ClearTxBuf(uspi);
+    USPI_ClearRxBuf(uspi);
+    uspi->PROTCTL &= ~USPI_PROTCTL_SS_Msk;
+
+    for(psXfer = psAsync->psHead; psXfer != NULL; psXfer = psXfer->psNext)
+        psXfer->i32Status = -1;
+    psAsync->psHead = NULL;
+    psAsync->psTail = NULL;
+}
+
+/**
+  * @brief  Queue a full-duplex transfer moved by the USCI_SPI receive end interrupt.
+  * @param[in]  uspi The pointer of the specified USCI_SPI module.
+  * @param[in]  psXfer Transfer descriptor. pvTxBuf, pvRxBuf, u32Len, u32Flags, pfnCallback and pvArg must be set.
+  *                    It must stay valid until the transfer is done.
+  * @retval 0 Transfer is queued.
+  * @retval -1 USPI_OpenAsync was not called or u32Len is 0.
+  * @details This function never waits. The transfer starts at once if no other is queued. With one TX buffer level,
+  *          two data units are kept in flight and every received unit interrupts, so this suits short transfers;
+  *          \ref USPI_TransferDMA keeps the bus busy. i32Status stays \ref USPI_XFER_PENDING until the last unit is
+  *          received, then the callback is called from the interrupt. Can be called from a transfer callback.
+  */
+int32_t USPI_TransferIRQ(USPI_T *uspi, S_USPI_XFER_T *psXfer)
+{
+    return USPI_AsyncSubmit(uspi, psXfer, 0);
+}
+
+/**
+  * @brief  Queue a full-duplex transfer moved by PDMA.
+  * @param[in]  uspi The pointer of the specified USCI_SPI module.
+  * @param[in]  psXfer Transfer descriptor. pvTxBuf, pvRxBuf, u32Len, u32Flags, pfnCallback and pvArg must be set.
+  *                    It must stay valid until the transfer is done.
+  * @retval 0 Transfer is queued.
+  * @retval -1 USPI_OpenAsync was not called with PDMA or u32Len is 0.
+  * @details This function never waits. TX and RX PDMA channels move the data in blocks of up to
+  *          \ref USPI_DMA_MAX_LEN units, the CPU only runs at the end of each block. A missing TX buffer sends all
+  *          ones and a missing RX buffer drops the data. Can be called from a transfer callback.
+  */
+int32_t USPI_TransferDMA(USPI_T *uspi, S_USPI_XFER_T *psXfer)
+{
+    return USPI_AsyncSubmit(uspi, psXfer, USPI_XFER_DMA);
+}
+
+/**
+  * @brief  Check if queued USCI_SPI transfers are pending.
+  * @param[in]  uspi The pointer of the specified USCI_SPI module.
+  * @retval 0 No transfer is queued.
+  * @retval 1 A transfer is on the bus or queued.
+  */
+uint32_t USPI_IsAsyncBusy(USPI_T *uspi)
+{
+    S_USPI_ASYNC_T *psAsync = s_apsUspiAsync[USPI_GetIndex(uspi)];
+
+    return ((psAsync != NULL) && (psAsync->psHead != NULL)) ? 1 : 0;
+}
+
+/**
+  * @brief  USCI_SPI interrupt handler for transfers queued by USPI_TransferIRQ.
+  * @param[in]  uspi The pointer of the specified USCI_SPI module.
+  * @return None
+  * @details Reads the received units, refills TXDAT and completes the transfer once all units are received.
+  *          Returns at once when the receive end flag of this module is not set, so it can be called for every
+  *          module sharing the USCI interrupt.
+  */
+void USPI_AsyncIRQHandler(USPI_T *uspi)
+{
+    S_USPI_ASYNC_T *psAsync = s_apsUspiAsync[USPI_GetIndex(uspi)];
+
+    if(!(uspi->PROTSTS & USPI_PROTSTS_RXENDIF_Msk) || !(uspi->INTEN & USPI_INTEN_RXENDIEN_Msk))
+        return;
+    USPI_CLR_PROT_INT_FLAG(uspi, USPI_PROTSTS_RXENDIF_Msk);
+
+    if((psAsync == NULL) || (psAsync->psHead == NULL) || (psAsync->psHead->u32Flags & USPI_XFER_DMA))
+    {
+        uspi->INTEN &= ~USPI_INTEN_RXENDIEN_Msk;
+        return;
+    }
+
+    if(USPI_AsyncPump(uspi, psAsync))
+        USPI_AsyncFinish(uspi, psAsync, 0);
+}
+
 /*@}*/ /* end of group USCI_SPI_EXPORTED_FUNCTIONS */
 
 /*@}*/ /* end of group USCI_SPI_Driver */
@@ -92,7 +92,7 @@
 
 /*-------------------------------------------------------------*/
 /* Define EP maximum packet size */
-#define EP0_MAX_PKT_SIZE    16
+#define EP0_MAX_PKT_SIZE    64
 #define EP1_MAX_PKT_SIZE    EP0_MAX_PKT_SIZE
 #define EP2_MAX_PKT_SIZE    64
 #define EP3_MAX_PKT_SIZE    64
@@ -0,0 +1,2049 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Run StdDriver transfer paths on the host simulator and report cycles per byte,
+ *           register access counts and interrupt latency.
+ * @note     Build and run on Linux x86-64 with "make run". Exit code is non-zero when a
+ *           transfer returns wrong data, so the program can gate CI.
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "NUC029xGE.h"
+#include "hostsim.h"
+#include "massstorage.h"
+
+
+#define PLL_CLOCK           72000000
+#define BENCH_LEN           256
+#define EEPROM_ADDR         0x50
+#define ADC_STREAM_CH       4
+#define ADC_STREAM_LEN      256
+#define TRACE_LEN           64
+#define FMEM_BENCH_MAX      4096
+#define BIG_LEN             (80 * 1024)     /* More than one PDMA table moves, 16384 units */
+#define MSC_LOOP_CYCLES     32              /* One pass of the MSC main loop */
+#define MSC_MEDIA_US        300             /* Busy time of the slow media per 512-byte sector */
+#define HDIV_SW_CALL_CYCLES 24              /* Cortex-M23 call, sign fix-up and return of a software division */
+#define HDIV_SW_STEP_CYCLES 8               /* One shift or shift-subtract step of HDIV_SwDivMod on Cortex-M23 */
+
+static uint8_t s_au8Tx[BENCH_LEN];
+static uint8_t s_au8Rx[BENCH_LEN];
+static uint32_t s_au32Src[BENCH_LEN / 4];
+static uint32_t s_au32Dst[BENCH_LEN / 4];
+static uint32_t s_au32Page[FMC_FLASH_PAGE_SIZE / 4];
+static uint8_t s_au8BigTx[BIG_LEN];
+static uint8_t s_au8BigRx[BIG_LEN];
+static uint8_t s_au8Eeprom[1024];
+static SIM_I2C_MEM_T s_sEeprom;
+static volatile uint32_t s_u32TmrTicks;
+static uint32_t s_u32Div0Calls;
+static uint32_t s_u32LogOnUart0;
+static char s_acLogExpect[2048];
+static uint8_t s_au8LogOut[2048];
+static S_UART_ASYNC_T s_sUartAsync;
+static uint8_t s_au8UartTxRing[128];
+static uint8_t s_au8UartRxRing[128];
+static volatile uint32_t s_u32UartEvents;
+static volatile uint32_t s_u32UartDmaTxDone;
+static volatile uint32_t s_u32UartDmaRxLen;
+static volatile uint32_t s_u32UartDmaRxDone;
+static volatile uint32_t s_u32PdmaEvents;
+static volatile uint32_t s_u32PdmaDone;
+static uint16_t s_au16AdcBuf[ADC_STREAM_LEN];
+static uint32_t s_au32AdcInput[ADC_STREAM_CH];
+static uint32_t s_au32AdcExpect[ADC_STREAM_CH];
+static volatile uint32_t s_u32AdcHalves;
+static volatile uint32_t s_u32AdcEvents;
+static uint32_t s_u32AdcBad;
+static S_I2C_ASYNC_T s_sI2cAsync;
+static S_I2C_XFER_T s_asI2cXfer[4];
+static volatile uint32_t s_u32I2cDone;
+static S_I2C_SLAVE_T s_sI2cSlave;
+static uint8_t s_au8SlaveRegs[64];
+static uint32_t s_u32SlaveReads;
+static uint32_t s_au32SlaveWrite[3];
+static S_UI2C_SLAVE_T s_sUi2cSlave;
+static uint8_t s_au8Ui2cRegs[256];
+static SIM_I2C_MEM_T s_sUi2cEeprom;
+static S_UI2C_ASYNC_T s_sUi2cAsync;
+static S_UI2C_XFER_T s_asUi2cXfer[3];
+static volatile uint32_t s_u32Ui2cDone;
+static S_SPI_ASYNC_T s_sSpiAsync;
+static S_SPI_XFER_T s_asSpiXfer[3];
+static volatile uint32_t s_u32SpiSelects;
+static S_USPI_ASYNC_T s_sUspiAsync;
+static S_USPI_XFER_T s_asUspiXfer[2];
+static S_TIMER_WHEEL_T s_sWheel;
+static S_TIMER_SW_T s_asSwTimer[16];
+static uint32_t s_au32SwExpect[16];
+static uint32_t s_au32SwFired[16];
+static uint32_t s_u32SwLateMax;
+static volatile uint32_t s_u32SwDone;
+static S_TRACE_REC_T s_asTrace[TRACE_LEN];
+static uint8_t s_au8TraceStream[TRACE_HEADER_SIZE + TRACE_LEN * TRACE_RECORD_SIZE];
+static const char *s_pcTraceFile;
+static volatile uint32_t s_u32UsbdClassReq;
+static volatile uint32_t s_u32UsbdSetAlt;
+static volatile uint32_t s_u32UsbdConfigured;
+static volatile uint32_t s_u32UsbdEpEvents;
+static volatile uint32_t s_u32UsbdOutLen;
+static uint8_t s_u8UsbdReply;
+static void (*s_pfnUsbdIrq)(void) = USBD_EventIRQHandler;
+static uint8_t s_au8MscDisk[DATA_FLASH_STORAGE_SIZE];
+static uint8_t s_au8MscHost[DATA_FLASH_STORAGE_SIZE];
+static uint32_t s_u32MscMediaCycles;
+static int32_t s_i32Fail;
+
+/* Composite device: HID (IF0), MSC (IF1), isochronous streaming with two alternate settings (IF2) and a
+   vendor bulk interface (IF3) that no longer fits into the endpoint buffer SRAM */
+static const uint8_t s_au8UsbdDevDesc[LEN_DEVICE] =
+{
+    LEN_DEVICE, DESC_DEVICE, 0x10, 0x01, 0x00, 0x00, 0x00, 8, 0x16, 0x04, 0x21, 0x50, 0x00, 0x01, 1, 2, 0, 1
+};
+static const uint8_t s_au8UsbdDevDesc64[LEN_DEVICE] =
+{
+    LEN_DEVICE, DESC_DEVICE, 0x10, 0x01, 0x00, 0x00, 0x00, 64, 0x16, 0x04, 0x21, 0x50, 0x00, 0x01, 1, 2, 0, 1
+};
+static const uint8_t s_au8UsbdConfigDesc[] =
+{
+    LEN_CONFIG, DESC_CONFIG, 121, 0, 4, 1, 0, 0x80, 50,
+    LEN_INTERFACE, DESC_INTERFACE, 0, 0, 2, 0x03, 0x00, 0x00, 0,
+    LEN_HID, DESC_HID, 0x10, 0x01, 0x00, 1, DESC_HID_RPT, 128, 0,
+    LEN_ENDPOINT, DESC_ENDPOINT, 0x81, EP_INT, 64, 0, 1,
+    LEN_ENDPOINT, DESC_ENDPOINT, 0x02, EP_INT, 64, 0, 1,
+    LEN_INTERFACE, DESC_INTERFACE, 1, 0, 2, 0x08, 0x06, 0x50, 0,
+    LEN_ENDPOINT, DESC_ENDPOINT, 0x83, EP_BULK, 64, 0, 0,
+    LEN_ENDPOINT, DESC_ENDPOINT, 0x04, EP_BULK, 64, 0, 0,
+    LEN_INTERFACE, DESC_INTERFACE, 2, 0, 0, 0x01, 0x02, 0x00, 0,
+    LEN_INTERFACE, DESC_INTERFACE, 2, 1, 1, 0x01, 0x02, 0x00, 0,
+    LEN_ENDPOINT, DESC_ENDPOINT, 0x85, EP_ISO, 96, 0, 1,
+    LEN_INTERFACE, DESC_INTERFACE, 2, 2, 1, 0x01, 0x02, 0x00, 0,
+    LEN_ENDPOINT, DESC_ENDPOINT, 0x85, EP_ISO, 192, 0, 1,
+    LEN_INTERFACE, DESC_INTERFACE, 3, 0, 1, 0xFF, 0x00, 0x00, 0,
+    LEN_ENDPOINT, DESC_ENDPOINT, 0x86, EP_BULK, 64, 0, 0
+};
+static const uint8_t s_au8UsbdLangDesc[4] = { 4, DESC_STRING, 0x09, 0x04 };
+static const uint8_t s_au8UsbdVendorDesc[16] = { 16, DESC_STRING, 'N', 0, 'u', 0, 'v', 0, 'o', 0, 't', 0, 'o', 0, 'n', 0 };
+static const uint8_t s_au8UsbdProductDesc[32] =
+{
+    32, DESC_STRING, 'H', 0, 'o', 0, 's', 0, 't', 0, 'S', 0, 'i', 0, 'm', 0, ' ', 0, 'C', 0, 'o', 0, 'm', 0, 'p', 0,
+    'o', 0, 's', 0
+};
+static const uint8_t *s_apu8UsbdString[4] = { s_au8UsbdLangDesc, s_au8UsbdVendorDesc, s_au8UsbdProductDesc, NULL };
+static uint8_t s_au8UsbdReportDesc[128];
+static const uint8_t *s_apu8UsbdReport[4] = { s_au8UsbdReportDesc, NULL, NULL, NULL };
+static const uint32_t s_au32UsbdReportLen[4] = { sizeof(s_au8UsbdReportDesc), 0, 0, 0 };
+static const S_USBD_INFO_T s_sUsbdInfo =
+{
+    s_au8UsbdDevDesc, s_au8UsbdConfigDesc, s_apu8UsbdString, s_apu8UsbdReport, s_au32UsbdReportLen, NULL, NULL
+};
+static const S_USBD_INFO_T s_sUsbdInfo64 =
+{
+    s_au8UsbdDevDesc64, s_au8UsbdConfigDesc, s_apu8UsbdString, s_apu8UsbdReport, s_au32UsbdReportLen, NULL, NULL
+};
+static void UsbdClassReq(S_USBD_FUNC_T *psFunc);
+static void UsbdSetInterface(S_USBD_FUNC_T *psFunc, uint32_t u32If, uint32_t u32Alt);
+static void UsbdSetConfig(S_USBD_FUNC_T *psFunc);
+static void UsbdEpEvent(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+static S_USBD_FUNC_EP_T s_asUsbdHidEp[2] = { {0x81, UsbdEpEvent}, {0x02, UsbdEpEvent} };
+static S_USBD_FUNC_EP_T s_asUsbdMscEp[2] = { {0x83, UsbdEpEvent}, {0x04, UsbdEpEvent} };
+static S_USBD_FUNC_EP_T s_asUsbdIsoEp[1] = { {0x85, UsbdEpEvent} };
+static S_USBD_FUNC_EP_T s_asUsbdVendorEp[1] = { {0x86, UsbdEpEvent} };
+static S_USBD_FUNC_T s_asUsbdFunc[4] =
+{
+    {0, 1, 2, s_asUsbdHidEp, UsbdClassReq, NULL, UsbdSetConfig},
+    {1, 1, 2, s_asUsbdMscEp, UsbdClassReq, NULL, UsbdSetConfig},
+    {2, 1, 1, s_asUsbdIsoEp, NULL, UsbdSetInterface, UsbdSetConfig},
+    {3, 1, 1, s_asUsbdVendorEp, NULL, NULL, NULL}
+};
+
+void TMR0_IRQHandler(void)
+{
+    TIMER_ClearIntFlag(TIMER0);
+    s_u32TmrTicks++;
+}
+
+void SPI0_IRQHandler(void)
+{
+    SPI_AsyncIRQHandler(SPI0);
+}
+
+void USCI_IRQHandler(void)
+{
+    USPI_AsyncIRQHandler(USPI0);
+    UI2C_SlaveIRQHandler(UI2C1);
+    UI2C_AsyncIRQHandler(UI2C2);
+}
+
+void I2C1_IRQHandler(void)
+{
+    I2C_SlaveIRQHandler(I2C1);
+}
+
+void I2C0_IRQHandler(void)
+{
+    I2C_AsyncIRQHandler(I2C0);
+}
+
+void I2CXferCallback(S_I2C_XFER_T *psXfer)
+{
+    s_u32I2cDone++;
+    /* The last queued transfer queues one more from interrupt context */
+    if(psXfer == &s_asI2cXfer[2])
+        I2C_SubmitAsync(I2C0, &s_asI2cXfer[3]);
+}
+
+void UI2CXferCallback(S_UI2C_XFER_T *psXfer)
+{
+    (void)psXfer;
+    s_u32Ui2cDone++;
+}
+
+void TMR1_IRQHandler(void)
+{
+    TIMER_WheelIRQHandler(TIMER1);
+}
+
+void SwTimerCallback(void *pvArg)
+{
+    uint32_t u32Idx = (uint32_t)(uintptr_t)pvArg;
+    uint32_t u32Late = TIMER_GetWheelTick(&s_sWheel) - s_au32SwExpect[u32Idx];
+
+    if(u32Late > s_u32SwLateMax)
+        s_u32SwLateMax = u32Late;
+    s_au32SwExpect[u32Idx] += s_asSwTimer[u32Idx].u32Period;
+    s_au32SwFired[u32Idx]++;
+    if(u32Idx == 0)
+        s_u32SwDone = 1;
+}
+
+void UART02_IRQHandler(void)
+{
+    /* The log drain and the async driver both own THRE, so only one of them serves UART0 at a time */
+    if(s_u32LogOnUart0)
+        DEBUG_LogIRQHandler();
+    else
+        UART_AsyncIRQHandler(UART0);
+}
+
+void PDMA_IRQHandler(void)
+{
+    PDMA_ChannelIRQHandler();
+}
+
+void MSC_IRQHandler(void);
+
+void USBD_IRQHandler(void)
+{
+    s_pfnUsbdIrq();
+}
+
+static void UsbdClassReq(S_USBD_FUNC_T *psFunc)
+{
+    uint8_t au8Setup[8];
+
+    USBD_GetSetupPacket(au8Setup);
+    s_u32UsbdClassReq = ((uint32_t)(psFunc - s_asUsbdFunc) << 8) | au8Setup[1];
+    if(au8Setup[0] & EP_INPUT)
+    {
+        /* One byte answer: index of the function that got the request */
+        s_u8UsbdReply = (uint8_t)(psFunc - s_asUsbdFunc);
+        USBD_PrepareCtrlIn(&s_u8UsbdReply, 1);
+        USBD_PrepareCtrlOut(0, 0);
+    }
+    else
+    {
+        USBD_SET_DATA1(EP0);
+        USBD_SET_PAYLOAD_LEN(EP0, 0);
+    }
+}
+
+static void UsbdSetInterface(S_USBD_FUNC_T *psFunc, uint32_t u32If, uint32_t u32Alt)
+{
+    s_u32UsbdSetAlt = (u32If << 8) | u32Alt;
+}
+
+static void UsbdSetConfig(S_USBD_FUNC_T *psFunc)
+{
+    s_u32UsbdConfigured |= 1UL << (psFunc - s_asUsbdFunc);
+}
+
+static void UsbdEpEvent(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
+{
+    s_u32UsbdEpEvents |= 1UL << u32HwEp;
+    if((USBD->EP[u32HwEp].CFG & USBD_CFG_STATE_Msk) == USBD_CFG_EPMODE_OUT)
+    {
+        s_u32UsbdOutLen = USBD_ReadEP(u32HwEp, s_au8Rx);
+    }
+}
+
+static void UartDmaTxEvent(uint32_t u32Ch, uint32_t u32Event)
+{
+    (void)u32Ch;
+    if(u32Event & PDMA_EVENT_DONE)
+        s_u32UartDmaTxDone = 1;
+}
+
+static void UartDmaRxEvent(uint32_t u32Ch, uint32_t u32Event)
+{
+    (void)u32Ch;
+    if(u32Event & (PDMA_EVENT_DONE | PDMA_EVENT_TIMEOUT))
+    {
+        s_u32UartDmaRxLen = UART_StopReceiveDMA(UART0);
+        s_u32UartDmaRxDone = 1;
+    }
+}
+
+static void PdmaChainEvent(uint32_t u32Ch, uint32_t u32Event)
+{
+    (void)u32Ch;
+    s_u32PdmaEvents |= u32Event;
+    if(u32Event & PDMA_EVENT_DONE)
+        s_u32PdmaDone++;
+}
+
+/* Channel number in the high byte, per-channel sample sequence in the low byte */
+static uint32_t AdcInput(uint32_t u32Ch)
+{
+    return (u32Ch << 8) | (s_au32AdcInput[u32Ch]++ & 0xFF);
+}
+
+static void AdcStreamEvent(uint32_t u32Event, uint16_t *pu16Data, uint32_t u32Count)
+{
+    uint32_t i, u32Ch;
+
+    s_u32AdcEvents |= u32Event;
+    if(!(u32Event & (ADC_STREAM_EVENT_HALF | ADC_STREAM_EVENT_FULL)))
+        return;
+    if((u32Event == ADC_STREAM_EVENT_HALF) != ((s_u32AdcHalves & 1) == 0))
+        s_u32AdcBad++;
+    for(i = 0; i < u32Count; i++)
+    {
+        u32Ch = i % ADC_STREAM_CH;
+        if(pu16Data[i] != ((u32Ch << 8) | (s_au32AdcExpect[u32Ch]++ & 0xFF)))
+            s_u32AdcBad++;
+    }
+    s_u32AdcHalves++;
+}
+
+static void UartAsyncEvent(UART_T *uart, uint32_t u32Event)
+{
+    (void)uart;
+    s_u32UartEvents |= u32Event;
+}
+
+static uint32_t SpiLoopback(void *pvCtx, uint32_t u32Tx, uint32_t u32Bits)
+{
+    (void)pvCtx;
+    (void)u32Bits;
+    return u32Tx;
+}
+
+static void SpiSelect(void *pvCtx, uint32_t u32Active)
+{
+    (void)pvCtx;
+    s_u32SpiSelects += u32Active;
+}
+
+static const SIM_SPI_DEV_T s_sSpiLoopback = { SpiLoopback, SpiSelect, NULL };
+
+static void ReportIsr(const char *pcName, IRQn_Type IRQn, uint64_t u64Start, uint32_t u32Bytes, int32_t i32Ok)
+{
+    uint64_t u64Cycles = SIM_GetCycles() - u64Start;
+    SIM_IRQ_STAT_T sStat;
+
+    SIM_GetIrqStat(IRQn, &sStat);
+    printf("  %-22s %8llu cycles %8.1f CPU cyc/B in %u ISRs (avg latency %llu)  %s\n", pcName,
+           (unsigned long long)u64Cycles, (double)sStat.u64CyclesInIsr / u32Bytes, sStat.u32Count,
+           (unsigned long long)(sStat.u64LatencySum / (sStat.u32Count ? sStat.u32Count : 1)), i32Ok ? "PASS" : "FAIL");
+    if(!i32Ok)
+        s_i32Fail = 1;
+}
+
+static void Report(const char *pcName, const void *pvPeriph, uint64_t u64Start, uint32_t u32Bytes, int32_t i32Ok)
+{
+    uint64_t u64Cycles = SIM_GetCycles() - u64Start;
+    SIM_ACCESS_T sAccess;
+
+    SIM_GetAccess(pvPeriph, &sAccess);
+    printf("  %-22s %8llu cycles %8.1f cyc/B %8llu rd %8llu wr %8llu dma  %s\n", pcName,
+           (unsigned long long)u64Cycles, (double)u64Cycles / u32Bytes,
+           (unsigned long long)sAccess.u64Reads, (unsigned long long)sAccess.u64Writes,
+           (unsigned long long)sAccess.u64DmaAccesses, i32Ok ? "PASS" : "FAIL");
+    if(!i32Ok)
+        s_i32Fail = 1;
+}
+
+void SYS_Init(void)
+{
+    /* Enable HIRC and HXT, run the core from PLL */
+    CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+    CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+    CLK_EnableXtalRC(CLK_PWRCTL_HXTEN_Msk);
+    CLK_WaitClockReady(CLK_STATUS_HXTSTB_Msk);
+    CLK_SetCoreClock(PLL_CLOCK);
+
+    /* Enable peripheral clock */
+    CLK_EnableModuleClock(UART0_MODULE);
+    CLK_EnableModuleClock(SPI0_MODULE);
+    CLK_EnableModuleClock(I2C0_MODULE);
+    CLK_EnableModuleClock(I2C1_MODULE);
+    CLK_EnableModuleClock(TMR0_MODULE);
+    CLK_EnableModuleClock(TMR1_MODULE);
+    CLK_EnableModuleClock(TMR2_MODULE);
+    CLK_EnableModuleClock(PDMA_MODULE);
+    CLK_EnableModuleClock(CRC_MODULE);
+    CLK_EnableModuleClock(HDIV_MODULE);
+    CLK_EnableModuleClock(ISP_MODULE);
+    CLK_EnableModuleClock(ADC_MODULE);
+    CLK_EnableModuleClock(USBD_MODULE);
+    CLK_EnableModuleClock(USCI0_MODULE);
+    CLK_EnableModuleClock(USCI1_MODULE);
+
+    /* Peripheral clock source */
+    CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UARTSEL_HXT, CLK_CLKDIV0_UART(1));
+    CLK_SetModuleClock(SPI0_MODULE, CLK_CLKSEL2_SPI0SEL_PCLK0, MODULE_NoMsk);
+    CLK_SetModuleClock(TMR0_MODULE, CLK_CLKSEL1_TMR0SEL_HXT, MODULE_NoMsk);
+    CLK_SetModuleClock(TMR1_MODULE, CLK_CLKSEL1_TMR1SEL_HXT, MODULE_NoMsk);
+    CLK_SetModuleClock(TMR2_MODULE, CLK_CLKSEL1_TMR2SEL_PCLK1, MODULE_NoMsk);
+    CLK_SetModuleClock(ADC_MODULE, CLK_CLKSEL1_ADCSEL_HIRC, CLK_CLKDIV0_ADC(2));
+}
+
+void Bench_UART(void)
+{
+    uint64_t u64Start;
+    uint32_t u32Len;
+
+    UART_Open(UART0, 115200);
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    UART_Write(UART0, s_au8Tx, BENCH_LEN);
+    while(!UART_IS_TX_EMPTY(UART0));
+    u32Len = SIM_UART_Capture(UART0, s_au8Rx, BENCH_LEN);
+    Report("UART_Write 115200", UART0, u64Start, BENCH_LEN, (u32Len == BENCH_LEN) && !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN));
+
+    memset(s_au8Rx, 0, BENCH_LEN);
+    SIM_UART_Inject(UART0, s_au8Tx, BENCH_LEN);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    u32Len = UART_Read(UART0, s_au8Rx, BENCH_LEN);
+    Report("UART_Read 115200", UART0, u64Start, BENCH_LEN, (u32Len == BENCH_LEN) && !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN));
+}
+
+void Bench_UARTAsync(void)
+{
+    uint64_t u64Start;
+    uint32_t u32Len, u32Sent;
+
+    UART_Open(UART0, 115200);
+    UART_OpenAsync(UART0, &s_sUartAsync, s_au8UartTxRing, sizeof(s_au8UartTxRing),
+                   s_au8UartRxRing, sizeof(s_au8UartRxRing), UartAsyncEvent);
+
+    /* TX: queue more than the ring holds, top it up whenever the ISR drains it */
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    u32Sent = 0;
+    while(u32Sent < BENCH_LEN)
+    {
+        u32Sent += UART_WriteAsync(UART0, &s_au8Tx[u32Sent], BENCH_LEN - u32Sent);
+        if(u32Sent < BENCH_LEN)
+            __WFI();
+    }
+    while(UART_GetAsyncTxCount(UART0))
+        __WFI();
+    while(!UART_IS_TX_EMPTY(UART0));
+    u32Len = SIM_UART_Capture(UART0, s_au8Rx, BENCH_LEN);
+    ReportIsr("UART_WriteAsync", UART02_IRQn, u64Start, BENCH_LEN,
+              (u32Len == BENCH_LEN) && !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN) && (s_u32UartEvents & UART_ASYNC_EVENT_TX_DONE));
+
+    /* RX: the ring is drained from thread level while bytes keep arriving */
+    memset(s_au8Rx, 0, BENCH_LEN);
+    SIM_UART_Inject(UART0, s_au8Tx, BENCH_LEN);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    u32Len = 0;
+    while(u32Len < BENCH_LEN)
+    {
+        __WFI();
+        u32Len += UART_ReadAsync(UART0, &s_au8Rx[u32Len], BENCH_LEN - u32Len);
+    }
+    ReportIsr("UART_ReadAsync", UART02_IRQn, u64Start, BENCH_LEN,
+              !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN) && (s_sUartAsync.u32RxDrop == 0));
+
+    UART_CloseAsync(UART0);
+    NVIC_DisableIRQ(UART02_IRQn);
+}
+
+void Bench_UARTDMA(void)
+{
+    uint64_t u64Start;
+    uint32_t u32Len;
+    int32_t i32TxCh, i32RxCh;
+
+    UART_Open(UART0, 115200);
+    i32TxCh = PDMA_RequestChannel(PDMA_CH_ANY, UartDmaTxEvent);
+    i32RxCh = PDMA_RequestChannel(PDMA_CH_TIMEOUT, UartDmaRxEvent);
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    s_u32UartDmaTxDone = 0;
+    UART_TransmitDMA(UART0, i32TxCh, s_au8Tx, BENCH_LEN);
+    while(!s_u32UartDmaTxDone)
+        __WFI();
+    while(!UART_IS_TX_EMPTY(UART0));
+    u32Len = SIM_UART_Capture(UART0, s_au8Rx, BENCH_LEN);
+    ReportIsr("UART_TransmitDMA", PDMA_IRQn, u64Start, BENCH_LEN, (u32Len == BENCH_LEN) && !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN));
+
+    /* Variable-length message shorter than the buffer, closed by 20 bit times of idle line */
+    memset(s_au8Rx, 0, BENCH_LEN);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    s_u32UartDmaRxDone = 0;
+    UART_ReceiveDMA(UART0, i32RxCh, s_au8Rx, BENCH_LEN, 20);
+    SIM_UART_Inject(UART0, s_au8Tx, 100);
+    while(!s_u32UartDmaRxDone)
+        __WFI();
+    ReportIsr("UART_ReceiveDMA idle", PDMA_IRQn, u64Start, 100,
+              (s_u32UartDmaRxLen == 100) && !memcmp(s_au8Rx, s_au8Tx, 100) && (s_au8Rx[100] == 0));
+
+    PDMA_ReleaseChannel(i32TxCh);
+    PDMA_ReleaseChannel(i32RxCh);
+}
+
+void Bench_SPI(void)
+{
+    uint64_t u64Start;
+    uint32_t i;
+
+    SIM_SPI_AttachDevice(SPI0, &s_sSpiLoopback);
+    SPI_Open(SPI0, SPI_MASTER, SPI_MODE_0, 8, 12000000);
+    SPI_EnableAutoSS(SPI0, SPI_SS, SPI_SS_ACTIVE_LOW);
+
+    memset(s_au8Rx, 0, BENCH_LEN);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    for(i = 0; i < BENCH_LEN; i++)
+    {
+        SPI_WRITE_TX(SPI0, s_au8Tx[i]);
+        while(SPI_IS_BUSY(SPI0));
+        s_au8Rx[i] = (uint8_t)SPI_READ_RX(SPI0);
+    }
+    Report("SPI polled 12 MHz", SPI0, u64Start, BENCH_LEN, !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN));
+}
+
+void Bench_SPIAsync(void)
+{
+    static const uint8_t au8Cmd[4] = {0x0B, 0x00, 0x01, 0x00};
+    uint64_t u64Start;
+    uint8_t au8CmdRx[4];
+    uint32_t i;
+
+    SPI_Open(SPI0, SPI_MASTER, SPI_MODE_0, 8, 12000000);
+    SPI_OpenAsync(SPI0, &s_sSpiAsync, SPI_SS_ACTIVE_LOW, 1);
+    NVIC_EnableIRQ(SPI0_IRQn);
+
+    memset(s_au8Rx, 0, BENCH_LEN);
+    memset(&s_asSpiXfer[0], 0, sizeof(S_SPI_XFER_T));
+    s_asSpiXfer[0].pvTxBuf = s_au8Tx;
+    s_asSpiXfer[0].pvRxBuf = s_au8Rx;
+    s_asSpiXfer[0].u32Len = BENCH_LEN;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    SPI_TransferIRQ(SPI0, &s_asSpiXfer[0]);
+    while(SPI_IsAsyncBusy(SPI0))
+        __WFI();
+    ReportIsr("SPI IRQ 12 MHz", SPI0_IRQn, u64Start, BENCH_LEN,
+              (s_asSpiXfer[0].i32Status == 0) && !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN));
+
+    /* Command phase by interrupt holding slave select, data phase by PDMA, one select for both */
+    memset(s_au8Rx, 0, BENCH_LEN);
+    memset(s_asSpiXfer, 0, sizeof(s_asSpiXfer));
+    s_asSpiXfer[0].pvTxBuf = au8Cmd;
+    s_asSpiXfer[0].pvRxBuf = au8CmdRx;
+    s_asSpiXfer[0].u32Len = sizeof(au8Cmd);
+    s_asSpiXfer[0].u32Flags = SPI_XFER_KEEP_SS;
+    s_asSpiXfer[1].pvTxBuf = s_au8Tx;
+    s_asSpiXfer[1].pvRxBuf = s_au8Rx;
+    s_asSpiXfer[1].u32Len = BENCH_LEN;
+    s_asSpiXfer[2].pvTxBuf = NULL;
+    s_asSpiXfer[2].pvRxBuf = NULL;
+    s_asSpiXfer[2].u32Len = 16;
+    s_u32SpiSelects = 0;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    SPI_TransferIRQ(SPI0, &s_asSpiXfer[0]);
+    SPI_TransferDMA(SPI0, &s_asSpiXfer[1]);
+    SPI_TransferDMA(SPI0, &s_asSpiXfer[2]);
+    while(SPI_IsAsyncBusy(SPI0))
+        __WFI();
+    ReportIsr("SPI cmd+PDMA 12 MHz", PDMA_IRQn, u64Start, sizeof(au8Cmd) + BENCH_LEN + 16,
+              (s_asSpiXfer[1].i32Status == 0) && (s_asSpiXfer[2].i32Status == 0) && (s_u32SpiSelects == 2) &&
+              !memcmp(au8CmdRx, au8Cmd, sizeof(au8Cmd)) && !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN));
+
+    /* Longer than one PDMA block, split by the driver */
+    for(i = 0; i < 20000; i++)
+        s_au8BigTx[i] = (uint8_t)(i * 7 + (i >> 8));
+    memset(s_au8BigRx, 0, 20000);
+    memset(&s_asSpiXfer[0], 0, sizeof(S_SPI_XFER_T));
+    s_asSpiXfer[0].pvTxBuf = s_au8BigTx;
+    s_asSpiXfer[0].pvRxBuf = s_au8BigRx;
+    s_asSpiXfer[0].u32Len = 20000;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    SPI_TransferDMA(SPI0, &s_asSpiXfer[0]);
+    while(SPI_IsAsyncBusy(SPI0))
+        __WFI();
+    ReportIsr("SPI PDMA 20000 B", PDMA_IRQn, u64Start, 20000,
+              (s_asSpiXfer[0].i32Status == 0) && !memcmp(s_au8BigRx, s_au8BigTx, 20000));
+
+    NVIC_DisableIRQ(SPI0_IRQn);
+    SPI_CloseAsync(SPI0);
+}
+
+void Bench_USPIAsync(void)
+{
+    uint64_t u64Start;
+    uint32_t i;
+
+    USPI_Open(USPI0, USPI_MASTER, USPI_MODE_0, 8, 6000000);
+    USPI_OpenAsync(USPI0, &s_sUspiAsync, USPI_SS_ACTIVE_LOW, 1);
+    NVIC_EnableIRQ(USCI_IRQn);
+
+    memset(s_au8Rx, 0, BENCH_LEN);
+    memset(s_asUspiXfer, 0, sizeof(s_asUspiXfer));
+    s_asUspiXfer[0].pvTxBuf = s_au8Tx;
+    s_asUspiXfer[0].pvRxBuf = s_au8Rx;
+    s_asUspiXfer[0].u32Len = BENCH_LEN;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    USPI_TransferIRQ(USPI0, &s_asUspiXfer[0]);
+    while(USPI_IsAsyncBusy(USPI0))
+        __WFI();
+    ReportIsr("USCI_SPI IRQ 6 MHz", USCI_IRQn, u64Start, BENCH_LEN,
+              (s_asUspiXfer[0].i32Status == 0) && !memcmp(s_au8Rx, s_au8Tx, BENCH_LEN));
+
+    /* Longer than one PDMA block, split by the driver, then a dummy read queued behind it */
+    for(i = 0; i < 20000; i++)
+        s_au8BigTx[i] = (uint8_t)(i * 5 + (i >> 8));
+    memset(s_au8BigRx, 0, 20000);
+    memset(s_asUspiXfer, 0, sizeof(s_asUspiXfer));
+    s_asUspiXfer[0].pvTxBuf = s_au8BigTx;
+    s_asUspiXfer[0].pvRxBuf = s_au8BigRx;
+    s_asUspiXfer[0].u32Len = 20000;
+    s_asUspiXfer[1].u32Len = 16;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    USPI_TransferDMA(USPI0, &s_asUspiXfer[0]);
+    USPI_TransferDMA(USPI0, &s_asUspiXfer[1]);
+    while(USPI_IsAsyncBusy(USPI0))
+        __WFI();
+    ReportIsr("USCI_SPI PDMA 20000 B", PDMA_IRQn, u64Start, 20000 + 16,
+              (s_asUspiXfer[0].i32Status == 0) && (s_asUspiXfer[1].i32Status == 0) &&
+              !memcmp(s_au8BigRx, s_au8BigTx, 20000));
+
+    NVIC_DisableIRQ(USCI_IRQn);
+    USPI_CloseAsync(USPI0);
+}
+
+void Bench_I2C(void)
+{
+    uint64_t u64Start;
+    uint32_t u32Len;
+
+    SIM_I2C_AttachMemory(I2C0, &s_sEeprom, EEPROM_ADDR, s_au8Eeprom, sizeof(s_au8Eeprom), 2);
+    I2C_Open(I2C0, 400000);
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    u32Len = I2C_WriteMultiBytesTwoRegs(I2C0, EEPROM_ADDR, 0x0010, s_au8Tx, 64);
+    Report("I2C write 400 kHz", I2C0, u64Start, 64, (u32Len == 64) && !memcmp(&s_au8Eeprom[0x10], s_au8Tx, 64));
+
+    memset(s_au8Rx, 0, BENCH_LEN);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    u32Len = I2C_ReadMultiBytesTwoRegs(I2C0, EEPROM_ADDR, 0x0010, s_au8Rx, 64);
+    Report("I2C read 400 kHz", I2C0, u64Start, 64, (u32Len == 64) && !memcmp(s_au8Rx, s_au8Tx, 64));
+}
+
+static void I2CSetXfer(S_I2C_XFER_T *psXfer, uint8_t u8Addr, uint8_t u8Dir, uint32_t u32Reg, uint8_t *pu8Buf, uint32_t u32Len)
+{
+    psXfer->u8SlaveAddr = u8Addr;
+    psXfer->u8Dir = u8Dir;
+    psXfer->u8RegLen = 2;
+    psXfer->u32RegAddr = u32Reg;
+    psXfer->pu8Buf = pu8Buf;
+    psXfer->u32Len = u32Len;
+    psXfer->pfnCallback = I2CXferCallback;
+    psXfer->pvArg = NULL;
+}
+
+void Bench_I2CAsync(void)
+{
+    uint64_t u64Start;
+    int32_t i32Ok;
+
+    /* Register write, register read, a read from an absent slave and a read queued by a callback */
+    memset(s_au8Rx, 0, BENCH_LEN);
+    I2CSetXfer(&s_asI2cXfer[0], EEPROM_ADDR, I2C_XFER_WRITE, 0x0100, s_au8Tx, 64);
+    I2CSetXfer(&s_asI2cXfer[1], EEPROM_ADDR, I2C_XFER_READ, 0x0100, s_au8Rx, 64);
+    I2CSetXfer(&s_asI2cXfer[2], EEPROM_ADDR + 1, I2C_XFER_READ, 0x0000, &s_au8Rx[128], 1);
+    I2CSetXfer(&s_asI2cXfer[3], EEPROM_ADDR, I2C_XFER_READ, 0x0010, &s_au8Rx[64], 16);
+
+    I2C_OpenAsync(I2C0, &s_sI2cAsync);
+    NVIC_EnableIRQ(I2C0_IRQn);
+    s_u32I2cDone = 0;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    I2C_SubmitAsync(I2C0, &s_asI2cXfer[0]);
+    I2C_SubmitAsync(I2C0, &s_asI2cXfer[1]);
+    I2C_SubmitAsync(I2C0, &s_asI2cXfer[2]);
+    while(I2C_IsAsyncBusy(I2C0))
+        __WFI();
+    NVIC_DisableIRQ(I2C0_IRQn);
+    I2C_CloseAsync(I2C0);
+
+    i32Ok = (s_u32I2cDone == 4) && (s_asI2cXfer[0].i32Status == I2C_OK) && (s_asI2cXfer[1].i32Status == I2C_OK) &&
+            (s_asI2cXfer[2].i32Status == I2C_ERR_FAIL) && (s_asI2cXfer[3].i32Status == I2C_OK) &&
+            !memcmp(&s_au8Eeprom[0x100], s_au8Tx, 64) && !memcmp(s_au8Rx, s_au8Tx, 64) && !memcmp(&s_au8Rx[64], s_au8Tx, 16);
+    ReportIsr("I2C async queue", I2C0_IRQn, u64Start, 64 + 64 + 16, i32Ok);
+}
+
+/* 512 B register write and read back, returns the I2C interrupts taken */
+static uint32_t I2CAsyncBlock(const char *pcName, uint32_t u32UseDMA, uint32_t u32Fill)
+{
+    SIM_IRQ_STAT_T sStat;
+    uint64_t u64Start;
+    uint32_t i;
+    int32_t i32Ok;
+
+    for(i = 0; i < 512; i++)
+        s_au8BigTx[i] = (uint8_t)(i * 7 + u32Fill);
+    memset(s_au8BigRx, 0, 512);
+    I2CSetXfer(&s_asI2cXfer[0], EEPROM_ADDR, I2C_XFER_WRITE, 0x0000, s_au8BigTx, 512);
+    I2CSetXfer(&s_asI2cXfer[1], EEPROM_ADDR, I2C_XFER_READ, 0x0000, s_au8BigRx, 512);
+
+    s_sI2cAsync.u32UseDMA = u32UseDMA;
+    i32Ok = (I2C_OpenAsync(I2C0, &s_sI2cAsync) == 0) && ((s_sI2cAsync.i32DmaCh >= 0) == (u32UseDMA != 0));
+    NVIC_EnableIRQ(I2C0_IRQn);
+    s_u32I2cDone = 0;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    I2C_SubmitAsync(I2C0, &s_asI2cXfer[0]);
+    I2C_SubmitAsync(I2C0, &s_asI2cXfer[1]);
+    while(I2C_IsAsyncBusy(I2C0))
+        __WFI();
+    NVIC_DisableIRQ(I2C0_IRQn);
+    I2C_CloseAsync(I2C0);
+    s_sI2cAsync.u32UseDMA = 0;
+
+    i32Ok = i32Ok && (s_u32I2cDone == 2) && (s_asI2cXfer[0].i32Status == I2C_OK) && (s_asI2cXfer[1].i32Status == I2C_OK) &&
+            (s_asI2cXfer[0].u32Count == 512) && (s_asI2cXfer[1].u32Count == 512) &&
+            !memcmp(s_au8Eeprom, s_au8BigTx, 512) && !memcmp(s_au8BigRx, s_au8BigTx, 512);
+    ReportIsr(pcName, I2C0_IRQn, u64Start, 512 + 512, i32Ok);
+    SIM_GetIrqStat(I2C0_IRQn, &sStat);
+    return sStat.u32Count;
+}
+
+void Bench_I2CAsyncDMA(void)
+{
+    uint32_t u32IrqIsr, u32DmaIsr;
+
+    u32IrqIsr = I2CAsyncBlock("I2C async 2x512 B", 0, 1);
+    u32DmaIsr = I2CAsyncBlock("I2C async PDMA 2x512 B", 1, 2);
+
+    /* START, address and register bytes, the last read byte and the final ACK interrupt, the data bytes do not */
+    if(u32DmaIsr > 16)
+    {
+        printf("  I2C async PDMA took %u ISRs, %u without PDMA  FAIL\n", u32DmaIsr, u32IrqIsr);
+        s_i32Fail = 1;
+    }
+}
+
+static void I2CSlaveRead(S_I2C_SLAVE_T *psSlave, uint8_t u8Addr, uint32_t u32Reg)
+{
+    (void)u8Addr;
+    (void)u32Reg;
+    /* Latch a sample counter so the master reads it as one coherent value */
+    psSlave->pu8Regs[0x30] = (uint8_t)++s_u32SlaveReads;
+}
+
+static void I2CSlaveWrite(S_I2C_SLAVE_T *psSlave, uint8_t u8Addr, uint32_t u32Reg, uint32_t u32Len)
+{
+    (void)psSlave;
+    s_au32SlaveWrite[0] = u8Addr;
+    s_au32SlaveWrite[1] = u32Reg;
+    s_au32SlaveWrite[2] = u32Len;
+}
+
+static int32_t I2CSlaveHostXfer(uint8_t u8Addr, const uint8_t *pu8Wr, uint32_t u32WrLen, uint8_t *pu8Rd, uint32_t u32RdLen)
+{
+    SIM_I2C_HOST_XFER_T sXfer;
+
+    memset(&sXfer, 0, sizeof(sXfer));
+    sXfer.u8Addr = u8Addr;
+    sXfer.pu8Wr = pu8Wr;
+    sXfer.u32WrLen = u32WrLen;
+    sXfer.pu8Rd = pu8Rd;
+    sXfer.u32RdLen = u32RdLen;
+    sXfer.u32BusHz = 1000000;
+    if((SIM_I2C_HostXfer(I2C1, &sXfer) != 0) || !SIM_RunUntil(&sXfer.u32Done, 10000000))
+        return -1;
+    return sXfer.i32Status;
+}
+
+void Bench_I2CSlave(void)
+{
+    uint8_t au8Wr[1 + 16], au8Rd[16];
+    uint8_t *pu8Map = &s_au8BigTx[40000];
+    SIM_IRQ_STAT_T sStat;
+    uint64_t u64Start;
+    uint32_t i;
+    int32_t i32Ok = 1;
+
+    /* 0x3A, and 0x4A/0x4B through the address mask, serve one register map at 1 MHz Fast-mode Plus */
+    I2C_Open(I2C1, 1000000);
+    I2C_SetSlaveAddr(I2C1, 0, 0x3A, 0);
+    I2C_SetSlaveAddr(I2C1, 1, 0x4A, 0);
+    I2C_SetSlaveAddrMask(I2C1, 1, 0x01);
+    memset(&s_sI2cSlave, 0, sizeof(s_sI2cSlave));
+    memset(s_au8SlaveRegs, 0, sizeof(s_au8SlaveRegs));
+    s_sI2cSlave.pu8Regs = s_au8SlaveRegs;
+    s_sI2cSlave.u32Size = sizeof(s_au8SlaveRegs);
+    s_sI2cSlave.u32PtrLen = 1;
+    s_sI2cSlave.pfnRead = I2CSlaveRead;
+    s_sI2cSlave.pfnWrite = I2CSlaveWrite;
+
+    /* A map the handler cannot index is refused */
+    s_sI2cSlave.u32PtrLen = 0;
+    if(I2C_OpenSlave(I2C1, &s_sI2cSlave) != -1)
+        i32Ok = 0;
+    s_sI2cSlave.u32PtrLen = 1;
+    s_sI2cSlave.u32Size = 0;
+    if(I2C_OpenSlave(I2C1, &s_sI2cSlave) != -1)
+        i32Ok = 0;
+    s_sI2cSlave.u32Size = sizeof(s_au8SlaveRegs);
+    if(I2C_OpenSlave(I2C1, &s_sI2cSlave) != 0)
+        i32Ok = 0;
+    NVIC_EnableIRQ(I2C1_IRQn);
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+
+    /* Block write, then pointer write and repeated START block read through the other address */
+    au8Wr[0] = 0x10;
+    memcpy(&au8Wr[1], s_au8Tx, 16);
+    if((I2CSlaveHostXfer(0x3A, au8Wr, 17, NULL, 0) != 0) || memcmp(&s_au8SlaveRegs[0x10], s_au8Tx, 16) ||
+            (s_au32SlaveWrite[0] != 0x3A) || (s_au32SlaveWrite[1] != 0x10) || (s_au32SlaveWrite[2] != 16))
+        i32Ok = 0;
+    if((I2CSlaveHostXfer(0x4B, au8Wr, 1, au8Rd, 16) != 0) || memcmp(au8Rd, s_au8Tx, 16) || (s_u32SlaveReads != 1))
+        i32Ok = 0;
+
+    /* Read callback refreshes the register before it goes out */
+    au8Wr[0] = 0x30;
+    if((I2CSlaveHostXfer(0x3A, au8Wr, 1, au8Rd, 1) != 0) || (au8Rd[0] != 2))
+        i32Ok = 0;
+
+    /* Write wraps at the end of the map, unknown address is not acknowledged */
+    au8Wr[0] = 0x3E;
+    if((I2CSlaveHostXfer(0x3A, au8Wr, 5, NULL, 0) != 0) || memcmp(&s_au8SlaveRegs[0x3E], s_au8Tx, 2) ||
+            memcmp(&s_au8SlaveRegs[0], &s_au8Tx[2], 2) || (s_au32SlaveWrite[1] != 0x3E) || (s_au32SlaveWrite[2] != 4))
+        i32Ok = 0;
+    if(I2CSlaveHostXfer(0x3C, au8Wr, 1, NULL, 0) != -1)
+        i32Ok = 0;
+
+    ReportIsr("I2C slave 1 MHz regmap", I2C1_IRQn, u64Start, 17 + 17 + 2 + 5, i32Ok);
+    I2C_CloseSlave(I2C1);
+
+    /* 20000 B map behind a 2-byte pointer, 1 KB blocks by PDMA wrap at the end of the map */
+    memset(pu8Map, 0, 20000);
+    s_sI2cSlave.pu8Regs = pu8Map;
+    s_sI2cSlave.u32Size = 20000;
+    s_sI2cSlave.u32PtrLen = 2;
+    s_sI2cSlave.pfnRead = NULL;
+    s_sI2cSlave.u32UseDMA = 1;
+    i32Ok = (I2C_OpenSlave(I2C1, &s_sI2cSlave) == 0) && (s_sI2cSlave.i32DmaCh >= 0);
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+
+    s_au8BigTx[0] = 19800 >> 8;
+    s_au8BigTx[1] = 19800 & 0xFF;
+    for(i = 2; i < 2 + 1024; i++)
+        s_au8BigTx[i] = (uint8_t)(i * 3 + (i >> 8));
+    memset(s_au8BigRx, 0, 1024);
+    if((I2CSlaveHostXfer(0x3A, s_au8BigTx, 2 + 1024, NULL, 0) != 0) || memcmp(&pu8Map[19800], &s_au8BigTx[2], 200) ||
+            memcmp(pu8Map, &s_au8BigTx[202], 824) || (s_au32SlaveWrite[1] != 19800) || (s_au32SlaveWrite[2] != 1024))
+        i32Ok = 0;
+    if((I2CSlaveHostXfer(0x3A, s_au8BigTx, 2, s_au8BigRx, 1024) != 0) || memcmp(s_au8BigRx, &s_au8BigTx[2], 1024))
+        i32Ok = 0;
+
+    /* Interrupts per transfer, not per byte */
+    SIM_GetIrqStat(I2C1_IRQn, &sStat);
+    if(sStat.u32Count > 10)
+        i32Ok = 0;
+
+    ReportIsr("I2C slave PDMA 2x1 KB", I2C1_IRQn, u64Start, 2 * (2 + 1024), i32Ok);
+
+    NVIC_DisableIRQ(I2C1_IRQn);
+    I2C_CloseSlave(I2C1);
+    I2C_Close(I2C1);
+}
+
+static void UI2CSlaveRead(S_UI2C_SLAVE_T *psSlave, uint8_t u8Addr, uint32_t u32Reg)
+{
+    (void)psSlave;
+    (void)u8Addr;
+    (void)u32Reg;
+    s_u32SlaveReads++;
+}
+
+static void UI2CSlaveWrite(S_UI2C_SLAVE_T *psSlave, uint8_t u8Addr, uint32_t u32Reg, uint32_t u32Len)
+{
+    (void)psSlave;
+    s_au32SlaveWrite[0] = u8Addr;
+    s_au32SlaveWrite[1] = u32Reg;
+    s_au32SlaveWrite[2] = u32Len;
+}
+
+static int32_t UI2CSlaveHostXfer(uint8_t u8Addr, const uint8_t *pu8Wr, uint32_t u32WrLen, uint8_t *pu8Rd, uint32_t u32RdLen)
+{
+    SIM_I2C_HOST_XFER_T sXfer;
+
+    memset(&sXfer, 0, sizeof(sXfer));
+    sXfer.u8Addr = u8Addr;
+    sXfer.pu8Wr = pu8Wr;
+    sXfer.u32WrLen = u32WrLen;
+    sXfer.pu8Rd = pu8Rd;
+    sXfer.u32RdLen = u32RdLen;
+    sXfer.u32BusHz = 1000000;
+    if((SIM_UI2C_HostXfer(UI2C1, &sXfer) != 0) || !SIM_RunUntil(&sXfer.u32Done, 10000000))
+        return -1;
+    return sXfer.i32Status;
+}
+
+void Bench_UI2CSlave(void)
+{
+    uint8_t au8Wr[2 + 16], au8Rd[16];
+    uint64_t u64Start;
+    int32_t i32Ok = 1;
+
+    /* 0x15, and 0x16/0x17 through the address mask, serve a 256 B map behind a 2-byte pointer */
+    UI2C_Open(UI2C1, 1000000);
+    UI2C_SetSlaveAddr(UI2C1, 0, 0x15, UI2C_GCMODE_DISABLE);
+    UI2C_SetSlaveAddr(UI2C1, 1, 0x16, UI2C_GCMODE_DISABLE);
+    UI2C_SetSlaveAddrMask(UI2C1, 1, 0x01);
+    memset(&s_sUi2cSlave, 0, sizeof(s_sUi2cSlave));
+    memset(s_au8Ui2cRegs, 0, sizeof(s_au8Ui2cRegs));
+    s_sUi2cSlave.pu8Regs = s_au8Ui2cRegs;
+    s_sUi2cSlave.u32Size = sizeof(s_au8Ui2cRegs);
+    s_sUi2cSlave.u32PtrLen = 3;
+    s_sUi2cSlave.pfnRead = UI2CSlaveRead;
+    s_sUi2cSlave.pfnWrite = UI2CSlaveWrite;
+
+    /* A map the handler cannot index is refused */
+    if(UI2C_OpenSlave(UI2C1, &s_sUi2cSlave) != -1)
+        i32Ok = 0;
+    s_sUi2cSlave.u32PtrLen = 2;
+    if(UI2C_OpenSlave(UI2C1, &s_sUi2cSlave) != 0)
+        i32Ok = 0;
+    NVIC_EnableIRQ(USCI_IRQn);
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    s_u32SlaveReads = 0;
+
+    /* Block write wraps at the end of the map, read back through the other address after a repeated START */
+    au8Wr[0] = 0x00;
+    au8Wr[1] = 0xF8;
+    memcpy(&au8Wr[2], s_au8Tx, 16);
+    if((UI2CSlaveHostXfer(0x15, au8Wr, 18, NULL, 0) != 0) || memcmp(&s_au8Ui2cRegs[0xF8], s_au8Tx, 8) ||
+            memcmp(s_au8Ui2cRegs, &s_au8Tx[8], 8) || (s_au32SlaveWrite[0] != 0x15) || (s_au32SlaveWrite[1] != 0xF8) ||
+            (s_au32SlaveWrite[2] != 16))
+        i32Ok = 0;
+    memset(au8Rd, 0, sizeof(au8Rd));
+    if((UI2CSlaveHostXfer(0x17, au8Wr, 2, au8Rd, 16) != 0) || memcmp(au8Rd, s_au8Tx, 16) || (s_u32SlaveReads != 1))
+        i32Ok = 0;
+
+    /* Unknown address is not acknowledged */
+    if(UI2CSlaveHostXfer(0x20, au8Wr, 2, NULL, 0) != -1)
+        i32Ok = 0;
+
+    ReportIsr("USCI_I2C slave 1 MHz", USCI_IRQn, u64Start, 18 + 18, i32Ok);
+
+    NVIC_DisableIRQ(USCI_IRQn);
+    UI2C_CloseSlave(UI2C1);
+    UI2C_Close(UI2C1);
+}
+
+static void UI2CSetXfer(S_UI2C_XFER_T *psXfer, uint8_t u8Addr, uint8_t u8Dir, uint32_t u32Reg, uint8_t *pu8Buf, uint32_t u32Len)
+{
+    psXfer->u8SlaveAddr = u8Addr;
+    psXfer->u8Dir = u8Dir;
+    psXfer->u8RegLen = 2;
+    psXfer->u32RegAddr = u32Reg;
+    psXfer->pu8Buf = pu8Buf;
+    psXfer->u32Len = u32Len;
+    psXfer->pfnCallback = UI2CXferCallback;
+    psXfer->pvArg = NULL;
+}
+
+void Bench_UI2CAsync(void)
+{
+    uint64_t u64Start;
+    int32_t i32Ok;
+
+    /* Same queue as the I2C one on USCI2, the EEPROM image is shared with I2C0 */
+    SIM_UI2C_AttachMemory(UI2C2, &s_sUi2cEeprom, EEPROM_ADDR, s_au8Eeprom, sizeof(s_au8Eeprom), 2);
+    UI2C_Open(UI2C2, 400000);
+    memset(s_au8Rx, 0, BENCH_LEN);
+    UI2CSetXfer(&s_asUi2cXfer[0], EEPROM_ADDR, UI2C_XFER_WRITE, 0x0200, s_au8Tx, 64);
+    UI2CSetXfer(&s_asUi2cXfer[1], EEPROM_ADDR, UI2C_XFER_READ, 0x0200, s_au8Rx, 64);
+    UI2CSetXfer(&s_asUi2cXfer[2], EEPROM_ADDR + 1, UI2C_XFER_READ, 0x0000, &s_au8Rx[128], 1);
+
+    /* Slave mode is refused while the master queue owns the module */
+    UI2C_OpenAsync(UI2C2, &s_sUi2cAsync);
+    i32Ok = (UI2C_OpenSlave(UI2C2, &s_sUi2cSlave) == -1);
+    NVIC_EnableIRQ(USCI_IRQn);
+    s_u32Ui2cDone = 0;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    UI2C_SubmitAsync(UI2C2, &s_asUi2cXfer[0]);
+    UI2C_SubmitAsync(UI2C2, &s_asUi2cXfer[1]);
+    UI2C_SubmitAsync(UI2C2, &s_asUi2cXfer[2]);
+    while(UI2C_IsAsyncBusy(UI2C2))
+        __WFI();
+    NVIC_DisableIRQ(USCI_IRQn);
+    UI2C_CloseAsync(UI2C2);
+    UI2C_Close(UI2C2);
+
+    i32Ok = i32Ok && (s_u32Ui2cDone == 3) && (s_asUi2cXfer[0].i32Status == UI2C_OK) &&
+            (s_asUi2cXfer[1].i32Status == UI2C_OK) && (s_asUi2cXfer[2].i32Status == UI2C_ERR_FAIL) &&
+            !memcmp(&s_au8Eeprom[0x200], s_au8Tx, 64) && !memcmp(s_au8Rx, s_au8Tx, 64);
+    ReportIsr("USCI_I2C async queue", USCI_IRQn, u64Start, 64 + 64, i32Ok);
+}
+
+void Bench_PDMA(void)
+{
+    uint64_t u64Start;
+
+    memset(s_au32Dst, 0, sizeof(s_au32Dst));
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    PDMA_Open(1 << 0);
+    PDMA_SetTransferCnt(0, PDMA_WIDTH_32, BENCH_LEN / 4);
+    PDMA_SetTransferAddr(0, (uint32_t)(uintptr_t)s_au32Src, PDMA_SAR_INC, (uint32_t)(uintptr_t)s_au32Dst, PDMA_DAR_INC);
+    PDMA_SetTransferMode(0, PDMA_MEM, FALSE, 0);
+    PDMA_SetBurstType(0, PDMA_REQ_BURST, PDMA_BURST_4);
+    PDMA_Trigger(0);
+    while((PDMA_GET_TD_STS() & (1 << 0)) == 0);
+    PDMA_CLR_TD_FLAG(1 << 0);
+    Report("PDMA mem-to-mem", PDMA, u64Start, BENCH_LEN, !memcmp(s_au32Dst, s_au32Src, BENCH_LEN));
+    PDMA_Close();
+}
+
+void Bench_PDMAChain(void)
+{
+    DSCT_T *apsDesc[4];
+    uint64_t u64Start;
+    uint32_t i, u32Cfg;
+    int32_t i32Ch;
+
+    /* Gather four quarter blocks in reverse order, only the last table interrupts */
+    memset(s_au32Dst, 0, sizeof(s_au32Dst));
+    i32Ch = PDMA_RequestChannel(PDMA_CH_ANY, PdmaChainEvent);
+    for(i = 0; i < 4; i++)
+        apsDesc[i] = PDMA_DescAlloc();
+    u32Cfg = PDMA_WIDTH_32 | PDMA_SAR_INC | PDMA_DAR_INC | PDMA_REQ_BURST | PDMA_BURST_4;
+    for(i = 0; i < 4; i++)
+        PDMA_DescSet(apsDesc[i], u32Cfg | ((i < 3) ? PDMA_TBINTDIS_DISABLE : PDMA_TBINTDIS_ENABLE), BENCH_LEN / 16,
+                     (uint32_t)(uintptr_t)&s_au32Src[(3 - i) * BENCH_LEN / 16], (uint32_t)(uintptr_t)&s_au32Dst[i * BENCH_LEN / 16],
+                     (i < 3) ? apsDesc[i + 1] : NULL);
+
+    s_u32PdmaEvents = 0;
+    s_u32PdmaDone = 0;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    PDMA_SetTransferMode(i32Ch, PDMA_MEM, TRUE, (uint32_t)(uintptr_t)apsDesc[0]);
+    PDMA_Trigger(i32Ch);
+    while(!s_u32PdmaDone)
+        __WFI();
+    for(i = 0; i < 4; i++)
+        if(memcmp(&s_au32Dst[i * BENCH_LEN / 16], &s_au32Src[(3 - i) * BENCH_LEN / 16], BENCH_LEN / 4))
+            break;
+    Report("PDMA 4-table chain", PDMA, u64Start, BENCH_LEN, (i == 4) && (s_u32PdmaDone == 1) && (s_u32PdmaEvents == PDMA_EVENT_DONE));
+
+    for(i = 0; i < 4; i++)
+        PDMA_DescFree(apsDesc[i]);
+    PDMA_ReleaseChannel(i32Ch);
+}
+
+void Bench_ADCStream(void)
+{
+    uint64_t u64Start;
+    int32_t i32Ret;
+
+    SIM_ADC_SetInput(AdcInput);
+
+    /* TIMER0 time-out starts one scan of channel 0~3 at 50 kHz */
+    memset(s_au32AdcInput, 0, sizeof(s_au32AdcInput));
+    memset(s_au32AdcExpect, 0, sizeof(s_au32AdcExpect));
+    s_u32AdcHalves = 0;
+    s_u32AdcEvents = 0;
+    s_u32AdcBad = 0;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    TIMER_Open(TIMER0, TIMER_PERIODIC_MODE, 50000);
+    TIMER_SetTriggerSource(TIMER0, TIMER_TRGSEL_TIMEOUT_EVENT);
+    TIMER_SetTriggerTarget(TIMER0, TIMER_TRG_TO_ADC);
+    i32Ret = ADC_StartStream(ADC, 0xF, ADC_ADCR_TRGS_TIMER, 0, s_au16AdcBuf, ADC_STREAM_LEN, AdcStreamEvent);
+    TIMER_Start(TIMER0);
+    while((i32Ret == 0) && (s_u32AdcHalves < 4))
+        __WFI();
+    TIMER_Close(TIMER0);
+    ADC_StopStream(ADC);
+    ReportIsr("ADC stream TIMER 50k", PDMA_IRQn, u64Start, ADC_STREAM_LEN * 2 * 2,
+              (i32Ret == 0) && (s_u32AdcBad == 0) && (s_u32AdcEvents == (ADC_STREAM_EVENT_HALF | ADC_STREAM_EVENT_FULL)));
+
+    /* Free running continuous scan */
+    memset(s_au32AdcInput, 0, sizeof(s_au32AdcInput));
+    memset(s_au32AdcExpect, 0, sizeof(s_au32AdcExpect));
+    s_u32AdcHalves = 0;
+    s_u32AdcEvents = 0;
+    s_u32AdcBad = 0;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    i32Ret = ADC_StartStream(ADC, 0xF, ADC_STREAM_CONTINUOUS, 0, s_au16AdcBuf, ADC_STREAM_LEN, AdcStreamEvent);
+    while((i32Ret == 0) && (s_u32AdcHalves < 8))
+        __WFI();
+    ADC_StopStream(ADC);
+    ReportIsr("ADC stream continuous", PDMA_IRQn, u64Start, ADC_STREAM_LEN * 4 * 2,
+              (i32Ret == 0) && (s_u32AdcBad == 0) && (s_u32AdcEvents == (ADC_STREAM_EVENT_HALF | ADC_STREAM_EVENT_FULL)));
+    ADC_POWER_DOWN(ADC);
+}
+
+void Bench_FMC(void)
+{
+    uint32_t u32Addr, u32Base, i;
+    uint64_t u64Start;
+    int32_t i32Ok = 1;
+
+    SYS_UnlockReg();
+    FMC_Open();
+    FMC_ENABLE_AP_UPDATE();
+    u32Base = FMC_ReadDataFlashBaseAddr();
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    FMC_Erase(u32Base);
+    for(i = 0, u32Addr = u32Base; i < BENCH_LEN / 4; i++, u32Addr += 4)
+        FMC_Write(u32Addr, s_au32Src[i]);
+    for(i = 0, u32Addr = u32Base; i < BENCH_LEN / 4; i++, u32Addr += 4)
+        if(FMC_Read(u32Addr) != s_au32Src[i])
+            i32Ok = 0;
+    Report("FMC erase+program", FMC, u64Start, BENCH_LEN, i32Ok);
+
+    /* One full page, word by word with read-back, then through the page API */
+    for(i = 0; i < FMC_FLASH_PAGE_SIZE / 4; i++)
+        s_au32Page[i] = 0x5A000000 | (i * 0x01010101);
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    i32Ok = (FMC_Erase(u32Base) == 0);
+    for(i = 0, u32Addr = u32Base; i < FMC_FLASH_PAGE_SIZE / 4; i++, u32Addr += 4)
+        FMC_Write(u32Addr, s_au32Page[i]);
+    for(i = 0, u32Addr = u32Base; i < FMC_FLASH_PAGE_SIZE / 4; i++, u32Addr += 4)
+        if(FMC_Read(u32Addr) != s_au32Page[i])
+            i32Ok = 0;
+    Report("FMC page by word", FMC, u64Start, FMC_FLASH_PAGE_SIZE, i32Ok);
+
+    s_au32Page[0] ^= 0xFFFF;
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    i32Ok = (FMC_ProgramPage(u32Base, s_au32Page) == 0) &&
+            (memcmp(SIM_FMC_GetFlash(u32Base), s_au32Page, FMC_FLASH_PAGE_SIZE) == 0);
+    Report("FMC_ProgramPage", FMC, u64Start, FMC_FLASH_PAGE_SIZE, i32Ok);
+
+    FMC_DISABLE_AP_UPDATE();
+    FMC_Close();
+    SYS_LockReg();
+}
+
+void Bench_CRC(void)
+{
+    static const uint8_t au8Cmd0[5] = {0x40, 0x00, 0x00, 0x00, 0x00};
+    struct timespec sT0, sT1;
+    uint64_t u64Start;
+    uint32_t i, u32Sum, u32Ref;
+    int32_t i32Ok;
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    CRC_Open(CRC_32, (CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM), 0xFFFFFFFF, CRC_CPU_WDATA_8);
+    for(i = 0; i < 9; i++)
+        CRC_WRITE_DATA("123456789"[i]);
+    u32Sum = CRC_GetChecksum();
+    Report("CRC-32 CPU 8-bit", CRC, u64Start, 9, u32Sum == 0xCBF43926);
+
+    /* Unaligned head and tail around a word body, CPU below the PDMA threshold and PDMA above it */
+    u32Ref = CRC_Crc32(0, &s_au8Tx[1], 40);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    CRC_Open(CRC_32, (CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM), 0xFFFFFFFF, CRC_CPU_WDATA_8);
+    u32Sum = CRC_Calculate(&s_au8Tx[1], 40);
+    Report("CRC_Calculate CPU 40 B", CRC, u64Start, 40, u32Sum == u32Ref);
+
+    u32Ref = CRC_Crc32(0, &s_au8Tx[1], BENCH_LEN - 2);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    CRC_Open(CRC_32, (CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM), 0xFFFFFFFF, CRC_CPU_WDATA_8);
+    u32Sum = CRC_Calculate(&s_au8Tx[1], BENCH_LEN - 2);
+    Report("CRC_Calculate PDMA", CRC, u64Start, BENCH_LEN - 2, u32Sum == u32Ref);
+
+    /* Over 64 KB, several PDMA tables */
+    for(i = 0; i < BIG_LEN; i++)
+        s_au8BigTx[i] = (uint8_t)(i * 13 + (i >> 9));
+    u32Ref = CRC_Crc32(0, s_au8BigTx, BIG_LEN);
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    CRC_Open(CRC_32, (CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM), 0xFFFFFFFF, CRC_CPU_WDATA_8);
+    u32Sum = CRC_Calculate(s_au8BigTx, BIG_LEN);
+    Report("CRC_Calculate 80 KB", CRC, u64Start, BIG_LEN, u32Sum == u32Ref);
+
+    /* Software CRC-16/CCITT against the controller, then split across two calls */
+    CRC_Open(CRC_CCITT, 0, 0, CRC_CPU_WDATA_8);
+    u32Sum = CRC_Calculate(s_au8Tx, BENCH_LEN);
+    i32Ok = (u32Sum == CRC_Crc16(0, s_au8Tx, BENCH_LEN)) &&
+            (u32Sum == CRC_Crc16(CRC_Crc16(0, s_au8Tx, 37), &s_au8Tx[37], BENCH_LEN - 37)) &&
+            (CRC_Crc16(0xFFFF, "123456789", 9) == 0x29B1) && (CRC_Crc32(0, "123456789", 9) == 0xCBF43926) &&
+            (CRC_Crc7(0, au8Cmd0, sizeof(au8Cmd0)) == 0x4A);
+
+    /* Software path costs no simulated cycles, time it on the host instead */
+    clock_gettime(CLOCK_MONOTONIC, &sT0);
+    for(i = 0; i < 4096; i++)
+        u32Ref = CRC_Crc32(u32Ref, s_au8Tx, BENCH_LEN);
+    clock_gettime(CLOCK_MONOTONIC, &sT1);
+    printf("  %-22s %8.2f host ns/B  %s\n", "CRC-32 slicing-by-4",
+           ((sT1.tv_sec - sT0.tv_sec) * 1e9 + (sT1.tv_nsec - sT0.tv_nsec)) / (4096.0 * BENCH_LEN), i32Ok ? "PASS" : "FAIL");
+    if(!i32Ok)
+        s_i32Fail = 1;
+}
+
+/* Application division by zero handler, the compiler library default returns its argument the same way */
+int32_t __aeabi_idiv0(int32_t i32Result)
+{
+    s_u32Div0Calls++;
+    return i32Result;
+}
+
+/* Steps HDIV_SwDivMod takes: divisor shifts up to the dividend, then one shift-subtract per quotient bit */
+static uint32_t HdivSwSteps(uint32_t u32Dividend, uint32_t u32Divisor)
+{
+    uint32_t u32Steps = 1;
+
+    while((u32Divisor < u32Dividend) && !(u32Divisor & 0x80000000UL))
+    {
+        u32Divisor <<= 1;
+        u32Steps += 2;
+    }
+    return u32Steps;
+}
+
+void Bench_HDIV(void)
+{
+    struct timespec sT0, sT1;
+    uint64_t u64Start, u64Res, u64Steps;
+    uint32_t u32Seed = 1, u32Sum;
+    int32_t i, i32Ok = 1, i32A, i32B;
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    for(i = 1; i <= 64; i++)
+        if(HDIV_Div(1000003 * i, i) != 1000003)
+            i32Ok = 0;
+    Report("HDIV_Div x64", HDIV, u64Start, 64, i32Ok);
+
+    /* Division helpers against the host operators, in and out of the divider range */
+    HDIV_Open();
+    for(i = 0, i32Ok = 1; i < 1024; i++)
+    {
+        u32Seed = u32Seed * 1103515245 + 12345;
+        i32A = (int32_t)u32Seed;
+        i32B = (int32_t)(u32Seed * 69069) >> ((i & 3) * 8 + 1);
+        if(i32B == 0)
+            continue;
+        u64Res = __aeabi_idivmod(i32A, i32B);
+        if((__aeabi_idiv(i32A, i32B) != i32A / i32B) || ((int32_t)u64Res != i32A / i32B) ||
+                ((int32_t)(u64Res >> 32) != i32A % i32B))
+            i32Ok = 0;
+        u64Res = __aeabi_uidivmod((uint32_t)i32A, (uint32_t)i32B);
+        if((__aeabi_uidiv((uint32_t)i32A, (uint32_t)i32B) != (uint32_t)i32A / (uint32_t)i32B) ||
+                ((uint32_t)u64Res != (uint32_t)i32A / (uint32_t)i32B) || ((uint32_t)(u64Res >> 32) != (uint32_t)i32A % (uint32_t)i32B))
+            i32Ok = 0;
+    }
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    for(i = 1; i <= 64; i++)
+        if(__aeabi_idiv(1000003 * i, -i) != -1000003)
+            i32Ok = 0;
+    Report("__aeabi_idiv HDIV x64", HDIV, u64Start, 64, i32Ok);
+
+    /* Division by zero goes through __aeabi_idiv0 on both paths, with the run-time ABI saturated quotient */
+    s_u32Div0Calls = 0;
+    i32Ok = (__aeabi_idiv(7, 0) == 0x7FFFFFFF) && (__aeabi_idiv(-7, 0) == (int32_t)0x80000000) && (__aeabi_idiv(0, 0) == 0) &&
+            (__aeabi_uidiv(7, 0) == 0xFFFFFFFFUL) && ((uint32_t)__aeabi_uidivmod(7, 0) == 0xFFFFFFFFUL) &&
+            ((uint32_t)(__aeabi_uidivmod(7, 0) >> 32) == 7);
+    HDIV_Close();
+    i32Ok = i32Ok && (__aeabi_idiv(7, 0) == 0x7FFFFFFF) && ((int32_t)(__aeabi_idivmod(-7, 0) >> 32) == -7);
+    printf("  %-22s %8u calls  %s\n", "__aeabi_idiv0", s_u32Div0Calls, (i32Ok && (s_u32Div0Calls == 8)) ? "PASS" : "FAIL");
+    if(!i32Ok || (s_u32Div0Calls != 8))
+        s_i32Fail = 1;
+
+    /* Software path costs no simulated cycles: estimate it from its loop steps, and time it on the host */
+    clock_gettime(CLOCK_MONOTONIC, &sT0);
+    for(i = 1, u32Sum = 0; i <= 65536; i++)
+        u32Sum += (uint32_t)__aeabi_idiv(1000 * i, -i);
+    clock_gettime(CLOCK_MONOTONIC, &sT1);
+    for(i = 1, u64Steps = 0; i <= 65536; i++)
+        u64Steps += HdivSwSteps(1000 * i, i);
+    i32Ok = (u32Sum == (uint32_t)(-1000 * 65536));
+    printf("  %-22s %8.1f est. cycles/div (%.1f steps), %.2f host ns/div  %s\n", "__aeabi_idiv software",
+           HDIV_SW_CALL_CYCLES + (double)u64Steps * HDIV_SW_STEP_CYCLES / 65536, (double)u64Steps / 65536,
+           ((sT1.tv_sec - sT0.tv_sec) * 1e9 + (sT1.tv_nsec - sT0.tv_nsec)) / 65536.0, i32Ok ? "PASS" : "FAIL");
+    if(!i32Ok)
+        s_i32Fail = 1;
+}
+
+void Bench_Timer(void)
+{
+    SIM_IRQ_STAT_T sStat;
+
+    SIM_ResetStats();
+    s_u32TmrTicks = 0;
+    TIMER_Open(TIMER0, TIMER_PERIODIC_MODE, 1000);
+    TIMER_EnableInt(TIMER0);
+    NVIC_EnableIRQ(TMR0_IRQn);
+    TIMER_Start(TIMER0);
+    while(s_u32TmrTicks < 10)
+        __WFI();
+    TIMER_Stop(TIMER0);
+    NVIC_DisableIRQ(TMR0_IRQn);
+
+    SIM_GetIrqStat(TMR0_IRQn, &sStat);
+    printf("  %-22s %8u irqs   latency avg %llu max %u cycles, %llu cycles/ISR\n", "TIMER0 1 kHz", sStat.u32Count,
+           (unsigned long long)(sStat.u64LatencySum / (sStat.u32Count ? sStat.u32Count : 1)), sStat.u32LatencyMax,
+           (unsigned long long)(sStat.u64CyclesInIsr / (sStat.u32Count ? sStat.u32Count : 1)));
+    if(sStat.u32Count < 10)
+        s_i32Fail = 1;
+}
+
+void Bench_TimerWheel(void)
+{
+    /* One-shot delays across all wheel levels, index 0 is the last to expire and ends the run */
+    const uint32_t au32Delay[12] = {150000, 1, 7, 31, 32, 33, 100, 1023, 1024, 5000, 40000, 100000};
+    const uint32_t au32Period[4] = {250, 1000, 3000, 7000};
+    SIM_IRQ_STAT_T sStat;
+    uint32_t i, u32Now, u32Fires = 0, u32Ok = 1;
+
+    if(TIMER_OpenWheel(TIMER1, &s_sWheel, 1000000) != 1000000)
+        u32Ok = 0;
+    NVIC_EnableIRQ(TMR1_IRQn);
+    SIM_ResetStats();
+    s_u32SwDone = 0;
+
+    u32Now = TIMER_GetWheelTick(&s_sWheel);
+    for(i = 0; i < 16; i++)
+    {
+        if(i < 12)
+        {
+            s_au32SwExpect[i] = u32Now + au32Delay[i];
+            TIMER_StartSW(&s_sWheel, &s_asSwTimer[i], au32Delay[i], 0, SwTimerCallback, (void *)(uintptr_t)i);
+        }
+        else
+        {
+            s_au32SwExpect[i] = u32Now + au32Period[i - 12];
+            TIMER_StartSW(&s_sWheel, &s_asSwTimer[i], au32Period[i - 12], au32Period[i - 12], SwTimerCallback, (void *)(uintptr_t)i);
+        }
+        /* Each start reads the counter, expiries are checked against the tick it was armed at */
+        u32Now = TIMER_GetWheelTick(&s_sWheel);
+        s_au32SwExpect[i] = s_asSwTimer[i].u32Expire;
+    }
+    /* A cancelled timer must not fire */
+    TIMER_StopSW(&s_sWheel, &s_asSwTimer[11]);
+
+    SIM_RunUntil(&s_u32SwDone, 20000000);
+    for(i = 12; i < 16; i++)
+        TIMER_StopSW(&s_sWheel, &s_asSwTimer[i]);
+    NVIC_DisableIRQ(TMR1_IRQn);
+    TIMER_CloseWheel(TIMER1);
+
+    for(i = 0; i < 16; i++)
+    {
+        u32Fires += s_au32SwFired[i];
+        if((i < 11) && (s_au32SwFired[i] != 1))
+            u32Ok = 0;
+        if(TIMER_IS_SW_ACTIVE(&s_asSwTimer[i]))
+            u32Ok = 0;
+    }
+    if((s_au32SwFired[11] != 0) || (s_au32SwFired[12] < 150000 / 250 - 1) || (s_u32SwLateMax > 2))
+        u32Ok = 0;
+
+    SIM_GetIrqStat(TMR1_IRQn, &sStat);
+    printf("  %-22s %8u irqs   %u expiries, max late %u ticks, %llu cycles/ISR  %s\n", "TIMER wheel 16 timers", sStat.u32Count,
+           u32Fires, s_u32SwLateMax, (unsigned long long)(sStat.u64CyclesInIsr / (sStat.u32Count ? sStat.u32Count : 1)), u32Ok ? "PASS" : "FAIL");
+    if(!u32Ok)
+        s_i32Fail = 1;
+}
+
+/* Byte-at-a-time reference, the way the newlib-nano memcpy/memset for Cortex-M0 work */
+__attribute__((noinline, optimize("no-tree-loop-distribute-patterns", "no-tree-vectorize")))
+static void ByteCopy(uint8_t *pu8Dst, const uint8_t *pu8Src, uint32_t u32Len)
+{
+    while(u32Len--)
+        *pu8Dst++ = *pu8Src++;
+}
+
+__attribute__((noinline, optimize("no-tree-loop-distribute-patterns", "no-tree-vectorize")))
+static void ByteSet(uint8_t *pu8Dst, uint8_t u8Val, uint32_t u32Len)
+{
+    while(u32Len--)
+        *pu8Dst++ = u8Val;
+}
+
+static double HostNs(const struct timespec *psT0, const struct timespec *psT1)
+{
+    return (psT1->tv_sec - psT0->tv_sec) * 1e9 + (psT1->tv_nsec - psT0->tv_nsec);
+}
+
+void Bench_FMEM(void)
+{
+    static uint8_t au8Src[FMEM_BENCH_MAX + 8], au8Dst[FMEM_BENCH_MAX + 8], au8Ref[FMEM_BENCH_MAX + 8];
+    const uint32_t au32Size[3] = {64, 512, FMEM_BENCH_MAX};
+    struct timespec sT0, sT1;
+    double dByte, dFast;
+    uint32_t i, j, k, u32Len, u32Reps;
+    int32_t i32Ok = 1, i32Diff;
+
+    /* Plain CPU work costs no simulated cycles, it is timed on the host instead */
+    SIM_HoldIdle(1);
+    for(i = 0; i < sizeof(au8Src); i++)
+        au8Src[i] = (uint8_t)(i * 13 + 7);
+
+    /* Every source / destination alignment, lengths around the word threshold */
+    for(i = 0; (i < 4) && i32Ok; i++)
+    {
+        for(j = 0; j < 4; j++)
+        {
+            for(u32Len = 0; u32Len < 72; u32Len++)
+            {
+                memset(au8Dst, 0xEE, 96);
+                memcpy(au8Ref, au8Dst, 96);
+                ByteCopy(&au8Ref[j], &au8Src[i], u32Len);
+                if((FMEM_Copy(&au8Dst[j], &au8Src[i], u32Len) != &au8Dst[j]) || memcmp(au8Dst, au8Ref, 96))
+                    i32Ok = 0;
+
+                ByteSet(&au8Ref[j], (uint8_t)(u32Len + i), u32Len);
+                FMEM_Set(&au8Dst[j], 0x100 + u32Len + i, u32Len);
+                if(memcmp(au8Dst, au8Ref, 96))
+                    i32Ok = 0;
+
+                /* Overlapping moves in both directions */
+                memcpy(au8Dst, au8Src, 96);
+                memcpy(au8Ref, au8Src, 96);
+                memmove(&au8Ref[j + 8], &au8Ref[i + 8 + (u32Len & 4)], u32Len);
+                FMEM_Move(&au8Dst[j + 8], &au8Dst[i + 8 + (u32Len & 4)], u32Len);
+                if(memcmp(au8Dst, au8Ref, 96))
+                    i32Ok = 0;
+
+                /* Equal buffers, then one byte changed at every position */
+                memcpy(&au8Dst[j], &au8Src[i], u32Len);
+                if(FMEM_Compare(&au8Dst[j], &au8Src[i], u32Len) != 0)
+                    i32Ok = 0;
+                for(k = 0; k < u32Len; k++)
+                {
+                    au8Dst[j + k] ^= 0x80;
+                    i32Diff = FMEM_Compare(&au8Dst[j], &au8Src[i], u32Len);
+                    if((i32Diff == 0) || ((i32Diff > 0) != (memcmp(&au8Dst[j], &au8Src[i], u32Len) > 0)) ||
+                            (i32Diff != (int32_t)au8Dst[j + k] - (int32_t)au8Src[i + k]))
+                        i32Ok = 0;
+                    au8Dst[j + k] ^= 0x80;
+                }
+            }
+        }
+    }
+
+    for(i = 0; i < 3; i++)
+    {
+        u32Len = au32Size[i];
+        u32Reps = (1 << 22) / u32Len;
+        for(j = 0; j < 2; j++)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &sT0);
+            for(k = 0; k < u32Reps; k++)
+                ByteCopy(au8Dst, &au8Src[j], u32Len);
+            clock_gettime(CLOCK_MONOTONIC, &sT1);
+            dByte = HostNs(&sT0, &sT1) / u32Reps;
+            clock_gettime(CLOCK_MONOTONIC, &sT0);
+            for(k = 0; k < u32Reps; k++)
+                FMEM_Copy(au8Dst, &au8Src[j], u32Len);
+            clock_gettime(CLOCK_MONOTONIC, &sT1);
+            dFast = HostNs(&sT0, &sT1) / u32Reps;
+            printf("  FMEM_Copy %4u B %-9s %8.1f host ns  byte loop %8.1f ns  %4.1fx\n", u32Len,
+                   j ? "src+1" : "aligned", dFast, dByte, dByte / dFast);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &sT0);
+        for(k = 0; k < u32Reps; k++)
+            ByteSet(au8Dst, (uint8_t)k, u32Len);
+        clock_gettime(CLOCK_MONOTONIC, &sT1);
+        dByte = HostNs(&sT0, &sT1) / u32Reps;
+        clock_gettime(CLOCK_MONOTONIC, &sT0);
+        for(k = 0; k < u32Reps; k++)
+            FMEM_Set(au8Dst, k, u32Len);
+        clock_gettime(CLOCK_MONOTONIC, &sT1);
+        dFast = HostNs(&sT0, &sT1) / u32Reps;
+        printf("  FMEM_Set  %4u B %-9s %8.1f host ns  byte loop %8.1f ns  %4.1fx\n", u32Len, "aligned",
+               dFast, dByte, dByte / dFast);
+
+        memcpy(au8Dst, au8Src, u32Len);
+        clock_gettime(CLOCK_MONOTONIC, &sT0);
+        for(k = 0; k < u32Reps; k++)
+            i32Diff = FMEM_Compare(au8Dst, au8Src, u32Len);
+        clock_gettime(CLOCK_MONOTONIC, &sT1);
+        printf("  FMEM_Compare %4u B %-6s %8.1f host ns\n", u32Len, "equal", HostNs(&sT0, &sT1) / u32Reps);
+        if(i32Diff != 0)
+            i32Ok = 0;
+    }
+    SIM_HoldIdle(0);
+
+    printf("  %-22s all alignments, 0 ~ 71 B  %s\n", "FMEM copy/move/set/cmp", i32Ok ? "PASS" : "FAIL");
+    if(!i32Ok)
+        s_i32Fail = 1;
+}
+
+static uint32_t TraceWord(const uint8_t *pu8Buf)
+{
+    return pu8Buf[0] | ((uint32_t)pu8Buf[1] << 8) | ((uint32_t)pu8Buf[2] << 16) | ((uint32_t)pu8Buf[3] << 24);
+}
+
+void Bench_Trace(void)
+{
+    const uint32_t au32Id[4] = {TRACE_ID_I2C_WRITE, TRACE_ID_I2C_WRITE | TRACE_ID_END, TRACE_ID_I2C_READ, TRACE_ID_I2C_READ | TRACE_ID_END};
+    const uint8_t *pu8Rec;
+    uint64_t u64Start, u64Cycles;
+    uint32_t i, u32Len, u32Cnt, u32Modulus, u32Stamp, u32Prev = 0, u32Begin = 0, u32ReadTicks = 0, u32Ok = 1;
+    FILE *pFile;
+
+    if(TRACE_Open(s_asTrace, TRACE_LEN - 1, TIMER2) != -1)
+        u32Ok = 0;
+    TRACE_Open(s_asTrace, TRACE_LEN, TIMER2);
+
+    /* The EEPROM model is still attached from Bench_I2C */
+    I2C_Open(I2C0, 400000);
+    for(i = 0; i < 8; i++)
+    {
+        I2C_WriteMultiBytesTwoRegs(I2C0, EEPROM_ADDR, 0x0100 + i * 16, s_au8Tx, 16);
+        I2C_ReadMultiBytesTwoRegs(I2C0, EEPROM_ADDR, 0x0100 + i * 16, s_au8Rx, 16);
+    }
+
+    u32Len = TRACE_Read(s_au8TraceStream, sizeof(s_au8TraceStream));
+    u32Cnt = TraceWord(&s_au8TraceStream[16]);
+    u32Modulus = TraceWord(&s_au8TraceStream[8]);
+    if((TraceWord(s_au8TraceStream) != TRACE_MAGIC) || (TraceWord(&s_au8TraceStream[4]) != TIMER_GetModuleClock(TIMER2)) ||
+            (u32Modulus != 0x1000000) || (u32Cnt != 32) || (u32Len != TRACE_HEADER_SIZE + 32 * TRACE_RECORD_SIZE))
+        u32Ok = 0;
+    for(i = 0; (i < u32Cnt) && u32Ok; i++)
+    {
+        pu8Rec = &s_au8TraceStream[TRACE_HEADER_SIZE + i * TRACE_RECORD_SIZE];
+        u32Stamp = TraceWord(pu8Rec) & 0xFFFFFF;
+        /* Spans alternate write / read, each end carries the transferred length */
+        if(((TraceWord(pu8Rec) >> 24) != au32Id[i % 4]) || (TraceWord(pu8Rec + 4) != 16))
+            u32Ok = 0;
+        if((i > 0) && (((u32Stamp - u32Prev) & (u32Modulus - 1)) == 0))
+            u32Ok = 0;
+        if(i % 4 == 2)
+            u32Begin = u32Stamp;
+        else if(i % 4 == 3)
+            u32ReadTicks += (u32Stamp - u32Begin) & (u32Modulus - 1);
+        u32Prev = u32Stamp;
+    }
+    if(s_pcTraceFile && ((pFile = fopen(s_pcTraceFile, "wb")) != NULL))
+    {
+        fwrite(s_au8TraceStream, 1, u32Len, pFile);
+        fclose(pFile);
+    }
+
+    /* Overflow the buffer: 6 of 70 events are dropped */
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    for(i = 0; i < TRACE_LEN + 6; i++)
+        TRACE_EVENT(TRACE_ID_USER, i);
+    u64Cycles = SIM_GetCycles() - u64Start;
+    if((TRACE_GetDropCount() != 6) || (TRACE_Read(s_au8TraceStream, sizeof(s_au8TraceStream)) != sizeof(s_au8TraceStream)))
+        u32Ok = 0;
+    TRACE_Close();
+    TIMER2->CTL = 0;
+
+    printf("  %-22s %8.1f us/read  %u records, %llu cycles/event, %u dropped  %s\n", "TRACE I2C 16B spans",
+           (double)u32ReadTicks * 1000000 / TIMER_GetModuleClock(TIMER2) / 8, u32Cnt,
+           (unsigned long long)(u64Cycles / (TRACE_LEN + 6)), TRACE_GetDropCount(), u32Ok ? "PASS" : "FAIL");
+    if(!u32Ok)
+        s_i32Fail = 1;
+}
+
+/* Expected debug port output of one record, '\n' goes out as "\r\n" */
+static uint32_t LogExpect(uint32_t u32Pos, const char *pcLine)
+{
+    for(; *pcLine; pcLine++)
+    {
+        if(*pcLine == '\n')
+            s_acLogExpect[u32Pos++] = '\r';
+        s_acLogExpect[u32Pos++] = *pcLine;
+    }
+    return u32Pos;
+}
+
+void Bench_DebugLog(void)
+{
+    char acLine[64];
+    uint64_t u64Start, u64Cycles;
+    uint32_t i, u32Pos = 0, u32Len;
+    SIM_IRQ_STAT_T sStat;
+    int32_t i32Ok;
+
+    UART_Open(UART0, 115200);
+    SIM_UART_Capture(UART0, NULL, sizeof(s_au8LogOut));
+    s_u32LogOnUart0 = 1;
+    NVIC_EnableIRQ(UART02_IRQn);
+
+    /* Six arguments from thread level, the THRE interrupt formats and sends them */
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+    for(i = 0; i < 16; i++)
+        DEBUG_LOG("rec %d %x %u %d %c %03x\n", i, i * 0x111, 1000 + i, -1, 'a' + i, i);
+    u64Cycles = SIM_GetCycles() - u64Start;
+    for(i = 0; i < 16; i++)
+    {
+        snprintf(acLine, sizeof(acLine), "rec %d %x %u %d %c %03x\n", i, i * 0x111, 1000 + i, -1, 'a' + i, i);
+        u32Pos = LogExpect(u32Pos, acLine);
+    }
+    while(UART0->INTEN & UART_INTEN_THREIEN_Msk)
+        __WFI();
+    while(!UART_IS_TX_EMPTY(UART0));
+    SIM_GetIrqStat(UART02_IRQn, &sStat);
+
+    /* A full queue drops records and reports them once it drains */
+    __disable_irq();
+    for(i = 0; i < 40; i++)
+        DEBUG_LOG("drop %d\n", i);
+    __enable_irq();
+    for(i = 0; i < 32; i++)
+    {
+        snprintf(acLine, sizeof(acLine), "drop %d\n", i);
+        u32Pos = LogExpect(u32Pos, acLine);
+    }
+    u32Pos = LogExpect(u32Pos, "[log] 8 dropped\n");
+    while(UART0->INTEN & UART_INTEN_THREIEN_Msk)
+        __WFI();
+
+    /* Flush sends with polling, as before power-down or from a fault handler */
+    __disable_irq();
+    DEBUG_LOG("flush %d %d\n", 1, 2);
+    DEBUG_LOG("flush done\n");
+    DEBUG_LogFlush();
+    __enable_irq();
+    u32Pos = LogExpect(u32Pos, "flush 1 2\nflush done\n");
+
+    NVIC_DisableIRQ(UART02_IRQn);
+    s_u32LogOnUart0 = 0;
+    u32Len = SIM_UART_Capture(UART0, s_au8LogOut, sizeof(s_au8LogOut));
+    i32Ok = (u32Len == u32Pos) && !memcmp(s_au8LogOut, s_acLogExpect, u32Pos) && (DEBUG_LogGetDropCount() == 8) &&
+            !(UART0->INTEN & UART_INTEN_THREIEN_Msk);
+
+    /* Formatting runs on the host and costs no simulated cycles, the ISR count is the drain overhead */
+    printf("  %-22s %8llu cycles/rec queued, %u ISRs for 16 records, 8 dropped  %s\n", "DEBUG_LOG 6 args",
+           (unsigned long long)(u64Cycles / 16), sStat.u32Count, i32Ok ? "PASS" : "FAIL");
+    if(!i32Ok)
+        s_i32Fail = 1;
+}
+
+void Bench_USBDComposite(void)
+{
+    const uint8_t au8SetConfig[8] = {0x00, SET_CONFIGURATION, 1, 0, 0, 0, 0, 0};
+    const uint8_t au8GetMaxLun[8] = {0xA1, 0xFE, 0, 0, 1, 0, 1, 0};
+    const uint8_t au8SetIdle[8] = {0x21, 0x0A, 0, 0, 0, 0, 0, 0};
+    const uint8_t au8NoOwner[8] = {0x21, 0x0A, 0, 0, 5, 0, 0, 0};
+    const uint8_t au8SetAlt[8] = {0x01, SET_INTERFACE, 2, 0, 2, 0, 0, 0};
+    uint8_t au8Buf[64];
+    uint64_t u64Start;
+    uint32_t u32Isr;
+    SIM_IRQ_STAT_T sStat;
+    int32_t i32Ok = 1;
+
+    /* Registration packs the buffers after the control pipe, the vendor function no longer fits */
+    USBD_Open(&s_sUsbdInfo, NULL, NULL);
+    if((USBD_RegisterFunction(&s_asUsbdFunc[0]) != 0) || (USBD_RegisterFunction(&s_asUsbdFunc[1]) != 0) ||
+            (USBD_RegisterFunction(&s_asUsbdFunc[2]) != 0) || (USBD_RegisterFunction(&s_asUsbdFunc[3]) != -1))
+        i32Ok = 0;
+    if((s_asUsbdHidEp[0].u32HwEp != EP2) || (s_asUsbdHidEp[0].u32BufSeg != 16) || (s_asUsbdMscEp[1].u32HwEp != EP5) ||
+            (USBD_GET_EP_BUF_ADDR(EP5) != 208) || (s_asUsbdIsoEp[0].u32MaxPkt != 192) || (s_asUsbdIsoEp[0].u32BufSeg != 272) ||
+            !(USBD->EP[EP6].CFG & USBD_CFG_TYPE_ISO) || ((USBD->EP[EP6].CFG & USBD_CFG_EPNUM_Msk) != 5))
+        i32Ok = 0;
+
+    USBD_Start();
+    NVIC_EnableIRQ(USBD_IRQn);
+    SIM_USBD_Attach();
+    SIM_USBD_BusReset();
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+
+    /* SET_CONFIGURATION restarts every function */
+    SIM_USBD_Setup(au8SetConfig);
+    if((SIM_USBD_In(0, au8Buf, sizeof(au8Buf)) != 0) || (s_u32UsbdConfigured != 0x7))
+        i32Ok = 0;
+
+    /* Class requests go to the function owning the interface, others stall */
+    SIM_USBD_Setup(au8GetMaxLun);
+    if((SIM_USBD_In(0, au8Buf, sizeof(au8Buf)) != 1) || (au8Buf[0] != 1) || (s_u32UsbdClassReq != 0x1FE) ||
+            (SIM_USBD_Out(0, au8Buf, 0) != 0))
+        i32Ok = 0;
+    SIM_USBD_Setup(au8SetIdle);
+    if((SIM_USBD_In(0, au8Buf, sizeof(au8Buf)) != 0) || (s_u32UsbdClassReq != 0x00A))
+        i32Ok = 0;
+    SIM_USBD_Setup(au8NoOwner);
+    if(SIM_USBD_In(0, au8Buf, sizeof(au8Buf)) != SIM_USBD_STALL)
+        i32Ok = 0;
+    SIM_USBD_Setup(au8SetAlt);
+    if((SIM_USBD_In(0, au8Buf, sizeof(au8Buf)) != 0) || (s_u32UsbdSetAlt != 0x202))
+        i32Ok = 0;
+
+    /* Bulk OUT of MSC and interrupt IN of HID reach their endpoint callbacks */
+    if((SIM_USBD_Out(4, s_au8Tx, 64) != 64) || (s_u32UsbdOutLen != 64) || memcmp(s_au8Rx, s_au8Tx, 64) ||
+            (s_u32UsbdEpEvents != (1UL << EP5)))
+        i32Ok = 0;
+    USBD_WriteEP(EP2, &s_au8Tx[64], 64);
+    if((SIM_USBD_In(1, au8Buf, sizeof(au8Buf)) != 64) || memcmp(au8Buf, &s_au8Tx[64], 64) ||
+            (s_u32UsbdEpEvents != ((1UL << EP5) | (1UL << EP2))))
+        i32Ok = 0;
+
+    /* HID IN, MSC IN and HID OUT complete while the interrupt is held off: one ISR serves all three */
+    SIM_GetIrqStat(USBD_IRQn, &sStat);
+    u32Isr = sStat.u32Count;
+    s_u32UsbdEpEvents = 0;
+    NVIC_DisableIRQ(USBD_IRQn);
+    USBD_WriteEP(EP2, s_au8Tx, 64);
+    USBD_WriteEP(EP4, &s_au8Tx[64], 64);
+    if((SIM_USBD_In(1, au8Buf, sizeof(au8Buf)) != 64) || (SIM_USBD_In(3, au8Buf, sizeof(au8Buf)) != 64) ||
+            memcmp(au8Buf, &s_au8Tx[64], 64) || (SIM_USBD_Out(2, &s_au8Tx[128], 64) != 64))
+        i32Ok = 0;
+    NVIC_EnableIRQ(USBD_IRQn);
+    SIM_AdvanceCycles(1);
+    SIM_GetIrqStat(USBD_IRQn, &sStat);
+    if((s_u32UsbdEpEvents != ((1UL << EP2) | (1UL << EP3) | (1UL << EP4))) || (sStat.u32Count != u32Isr + 1) ||
+            memcmp(s_au8Rx, &s_au8Tx[128], 64))
+        i32Ok = 0;
+
+    ReportIsr("USBD composite routing", USBD_IRQn, u64Start, 128 + 192, i32Ok);
+
+    NVIC_DisableIRQ(USBD_IRQn);
+    SIM_USBD_Detach();
+    USBD_SET_SE0();
+}
+
+/* Control read the way the host runs it: SETUP, IN until a short packet, OUT status stage. Returns the length,
+   or -1 on STALL or NAK. pu32Pkts counts the IN data packets. */
+static int32_t UsbdCtrlRead(const uint8_t *pu8Setup, uint8_t *pu8Buf, uint32_t u32MaxPkt, uint32_t *pu32Pkts)
+{
+    uint32_t u32Len = 0, u32Want = pu8Setup[6] | ((uint32_t)pu8Setup[7] << 8);
+    int32_t i32Ret;
+
+    SIM_USBD_Setup(pu8Setup);
+    do
+    {
+        i32Ret = SIM_USBD_In(0, &pu8Buf[u32Len], u32MaxPkt);
+        if(i32Ret < 0)
+            return -1;
+        u32Len += (uint32_t)i32Ret;
+        (*pu32Pkts)++;
+    }
+    while((i32Ret == (int32_t)u32MaxPkt) && (u32Len < u32Want));
+
+    return (SIM_USBD_Out(0, pu8Buf, 0) == 0) ? (int32_t)u32Len : -1;
+}
+
+/* Descriptor reads of a Windows style enumeration, with an 8-byte and a 64-byte control endpoint */
+static void UsbdEnum(const char *pcName, const S_USBD_INFO_T *psInfo)
+{
+    const uint8_t au8GetDev[8] = {0x80, GET_DESCRIPTOR, 0, DESC_DEVICE, 0, 0, 64, 0};
+    const uint8_t au8GetConfig[8] = {0x80, GET_DESCRIPTOR, 0, DESC_CONFIG, 0, 0, 0xFF, 0};
+    const uint8_t au8GetStr2[8] = {0x80, GET_DESCRIPTOR, 2, DESC_STRING, 0x09, 0x04, 0xFF, 0};
+    const uint8_t au8GetStr3[8] = {0x80, GET_DESCRIPTOR, 3, DESC_STRING, 0x09, 0x04, 0xFF, 0};
+    const uint8_t au8GetHid[8] = {0x81, GET_DESCRIPTOR, 0, DESC_HID, 0, 0, 0xFF, 0};
+    const uint8_t au8GetReport[8] = {0x81, GET_DESCRIPTOR, 0, DESC_HID_RPT, 0, 0, 0xFF, 0};
+    uint32_t u32MaxPkt = psInfo->gu8DevDesc[7], u32Pkts = 0, u32Isr;
+    uint64_t u64Start;
+    SIM_IRQ_STAT_T sStat;
+    int32_t i32Ok = 1;
+
+    USBD_Open(psInfo, NULL, NULL);
+    USBD_Start();
+    NVIC_EnableIRQ(USBD_IRQn);
+    SIM_USBD_Attach();
+    SIM_USBD_BusReset();
+
+    SIM_ResetStats();
+    u64Start = SIM_GetCycles();
+
+    if((UsbdCtrlRead(au8GetDev, s_au8Rx, u32MaxPkt, &u32Pkts) != LEN_DEVICE) || memcmp(s_au8Rx, psInfo->gu8DevDesc, LEN_DEVICE))
+        i32Ok = 0;
+    if((UsbdCtrlRead(au8GetConfig, s_au8Rx, u32MaxPkt, &u32Pkts) != sizeof(s_au8UsbdConfigDesc)) ||
+            memcmp(s_au8Rx, s_au8UsbdConfigDesc, sizeof(s_au8UsbdConfigDesc)))
+        i32Ok = 0;
+    /* Descriptors shorter than wLength ending on a packet boundary are closed by a zero length packet */
+    if((UsbdCtrlRead(au8GetStr2, s_au8Rx, u32MaxPkt, &u32Pkts) != sizeof(s_au8UsbdProductDesc)) ||
+            memcmp(s_au8Rx, s_au8UsbdProductDesc, sizeof(s_au8UsbdProductDesc)))
+        i32Ok = 0;
+    if(UsbdCtrlRead(au8GetStr3, s_au8Rx, u32MaxPkt, &u32Pkts) != -1)
+        i32Ok = 0;
+    if((UsbdCtrlRead(au8GetHid, s_au8Rx, u32MaxPkt, &u32Pkts) != LEN_HID) || memcmp(s_au8Rx, &s_au8UsbdConfigDesc[LEN_CONFIG + LEN_INTERFACE], LEN_HID))
+        i32Ok = 0;
+    if((UsbdCtrlRead(au8GetReport, s_au8Rx, u32MaxPkt, &u32Pkts) != sizeof(s_au8UsbdReportDesc)) ||
+            memcmp(s_au8Rx, s_au8UsbdReportDesc, sizeof(s_au8UsbdReportDesc)))
+        i32Ok = 0;
+
+    /* Data packets: device 18, config 121, string 32, HID 9, report 128 (+ ZLP on a packet boundary) */
+    if(u32Pkts != ((u32MaxPkt == 8) ? 3 + 16 + 5 + 2 + 17 : 1 + 2 + 1 + 1 + 3))
+        i32Ok = 0;
+    SIM_GetIrqStat(USBD_IRQn, &sStat);
+    u32Isr = sStat.u32Count;
+    ReportIsr(pcName, USBD_IRQn, u64Start, LEN_DEVICE + sizeof(s_au8UsbdConfigDesc) + 32 + LEN_HID + 128, i32Ok);
+    printf("  %-22s %8u IN packets %8u ISRs\n", "", u32Pkts, u32Isr);
+
+    NVIC_DisableIRQ(USBD_IRQn);
+    SIM_USBD_Detach();
+    USBD_SET_SE0();
+}
+
+void Bench_USBDEnum(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < sizeof(s_au8UsbdReportDesc); i++)
+        s_au8UsbdReportDesc[i] = (uint8_t)(i * 13 + 5);
+
+    UsbdEnum("USBD enum EP0 8B", &s_sUsbdInfo);
+    UsbdEnum("USBD enum EP0 64B", &s_sUsbdInfo64);
+}
+
+/* Media interface of the mass storage class: a RAM disk that keeps the CPU busy s_u32MscMediaCycles per
+   sector, like a driver polling an SPI flash. Interrupts are taken meanwhile. */
+static void MscMediaWait(uint32_t u32Size)
+{
+    uint64_t u64End = SIM_GetCycles() + (uint64_t)s_u32MscMediaCycles * ((u32Size + 511) / 512);
+
+    while(SIM_GetCycles() < u64End)
+        SIM_AdvanceCycles(MSC_LOOP_CYCLES);
+}
+
+void MSC_ReadMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
+{
+    memcpy(buffer, &s_au8MscDisk[addr], size);
+    MscMediaWait(size);
+}
+
+void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
+{
+    memcpy(&s_au8MscDisk[addr], buffer, size);
+    MscMediaWait(size);
+}
+
+void MSC_FlushMedia(void)
+{
+}
+
+void MSC_IdleMedia(void)
+{
+}
+
+uint32_t MSC_TakeMediaError(void)
+{
+    return 0;
+}
+
+/* Run one bulk transfer of the host while the class main loop spins. Returns the bytes moved, -1 on STALL. */
+static int32_t MscXfer(uint8_t u8EpAddr, uint8_t *pu8Buf, uint32_t u32Len)
+{
+    SIM_USBD_XFER_T sXfer;
+
+    sXfer.u8EpAddr = u8EpAddr;
+    sXfer.pu8Buf = pu8Buf;
+    sXfer.u32Len = u32Len;
+    sXfer.u32MaxPkt = EP2_MAX_PKT_SIZE;
+    if(SIM_USBD_Submit(&sXfer) != 0)
+        return -1;
+
+    while(sXfer.i32Status == SIM_USBD_BUSY)
+    {
+        MSC_ProcessCmd();
+        SIM_AdvanceCycles(MSC_LOOP_CYCLES);
+    }
+
+    return (sXfer.i32Status == 0) ? (int32_t)sXfer.u32Actual : -1;
+}
+
+/* CBW, data phase of the whole disk and CSW. Returns the cycles from CBW to CSW, 0 on a protocol error. */
+static uint64_t MscCommand(uint8_t u8OpCode, uint32_t u32Tag)
+{
+    uint32_t u32Sectors = DATA_FLASH_STORAGE_SIZE / UDC_SECTOR_SIZE;
+    uint8_t au8Cbw[31] = {0}, au8Csw[13];
+    uint32_t u32In = (u8OpCode == UFI_READ_10);
+    uint64_t u64Start = SIM_GetCycles();
+
+    memcpy(&au8Cbw[0], "USBC", 4);
+    memcpy(&au8Cbw[4], &u32Tag, 4);
+    au8Cbw[8] = (uint8_t)DATA_FLASH_STORAGE_SIZE;
+    au8Cbw[9] = (uint8_t)(DATA_FLASH_STORAGE_SIZE >> 8);
+    au8Cbw[10] = (uint8_t)(DATA_FLASH_STORAGE_SIZE >> 16);
+    au8Cbw[12] = u32In ? 0x80 : 0x00;
+    au8Cbw[14] = 10;
+    au8Cbw[15] = u8OpCode;
+    au8Cbw[22] = (uint8_t)(u32Sectors >> 8);
+    au8Cbw[23] = (uint8_t)u32Sectors;
+
+    if(MscXfer(BULK_OUT_EP_NUM, au8Cbw, sizeof(au8Cbw)) != sizeof(au8Cbw))
+        return 0;
+    if(MscXfer(u32In ? (0x80 | BULK_IN_EP_NUM) : BULK_OUT_EP_NUM, s_au8MscHost, DATA_FLASH_STORAGE_SIZE) != DATA_FLASH_STORAGE_SIZE)
+        return 0;
+    if((MscXfer(0x80 | BULK_IN_EP_NUM, au8Csw, sizeof(au8Csw)) != sizeof(au8Csw)) || memcmp(au8Csw, "USBS", 4) ||
+            memcmp(&au8Csw[4], &u32Tag, 4) || (au8Csw[12] != 0))
+        return 0;
+
+    return SIM_GetCycles() - u64Start;
+}
+
+static void MscReport(const char *pcName, uint64_t u64Fast, uint64_t u64Slow, int32_t i32Ok)
+{
+    uint64_t u64Media = (uint64_t)s_u32MscMediaCycles * (DATA_FLASH_STORAGE_SIZE / UDC_SECTOR_SIZE);
+    double dMBs = (double)DATA_FLASH_STORAGE_SIZE * SystemCoreClock / 1000000;
+
+    /* Staging hides the media time behind the bulk pipe, at least half of it is expected to overlap */
+    if(!u64Fast || !u64Slow || (u64Slow > u64Fast + u64Media / 2))
+        i32Ok = 0;
+    printf("  %-22s %8.3f MB/s, %u us/sector media %.3f MB/s (serial %.3f)  %s\n", pcName, dMBs / u64Fast,
+           MSC_MEDIA_US, dMBs / u64Slow, dMBs / (u64Fast + u64Media), i32Ok ? "PASS" : "FAIL");
+    if(!i32Ok)
+        s_i32Fail = 1;
+}
+
+/* Bulk-only transport of the DataFlash sample class (MassStorage.c) on a RAM disk, once with an instant media
+   and once with a slow one, 64 KB per READ_10/WRITE_10 */
+void Bench_USBDMassStorage(void)
+{
+    const uint8_t au8SetConfig[8] = {0x00, SET_CONFIGURATION, 1, 0, 0, 0, 0, 0};
+    uint64_t au64Read[2], au64Write[2];
+    uint32_t i, u32Pass;
+    int32_t i32ReadOk = 1, i32WriteOk = 1;
+
+    s_pfnUsbdIrq = MSC_IRQHandler;
+    USBD_Open(&gsInfo, MSC_ClassRequest, NULL);
+    USBD_SetConfigCallback(MSC_SetConfig);
+    MSC_Init();
+    USBD_Start();
+    NVIC_EnableIRQ(USBD_IRQn);
+    SIM_USBD_Attach();
+    SIM_USBD_BusReset();
+    SIM_USBD_Setup(au8SetConfig);
+    if(SIM_USBD_In(0, s_au8Rx, sizeof(s_au8Rx)) != 0)
+        i32ReadOk = i32WriteOk = 0;
+
+    for(u32Pass = 0; u32Pass < 2; u32Pass++)
+    {
+        s_u32MscMediaCycles = u32Pass ? (SystemCoreClock / 1000000) * MSC_MEDIA_US : 0;
+
+        for(i = 0; i < DATA_FLASH_STORAGE_SIZE; i++)
+            s_au8MscDisk[i] = (uint8_t)(i * 7 + u32Pass);
+        memset(s_au8MscHost, 0, sizeof(s_au8MscHost));
+        au64Read[u32Pass] = MscCommand(UFI_READ_10, 2 * u32Pass + 1);
+        if(memcmp(s_au8MscHost, s_au8MscDisk, DATA_FLASH_STORAGE_SIZE))
+            i32ReadOk = 0;
+
+        for(i = 0; i < DATA_FLASH_STORAGE_SIZE; i++)
+            s_au8MscHost[i] = (uint8_t)(i * 13 + u32Pass);
+        au64Write[u32Pass] = MscCommand(UFI_WRITE_10, 2 * u32Pass + 2);
+        if(memcmp(s_au8MscHost, s_au8MscDisk, DATA_FLASH_STORAGE_SIZE))
+            i32WriteOk = 0;
+    }
+
+    s_u32MscMediaCycles = (SystemCoreClock / 1000000) * MSC_MEDIA_US;
+    MscReport("MSC READ_10 64 KB", au64Read[0], au64Read[1], i32ReadOk);
+    MscReport("MSC WRITE_10 64 KB", au64Write[0], au64Write[1], i32WriteOk);
+
+    NVIC_DisableIRQ(USBD_IRQn);
+    SIM_USBD_Detach();
+    USBD_SET_SE0();
+    s_pfnUsbdIrq = USBD_EventIRQHandler;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  MAIN function                                                                                          */
+/*---------------------------------------------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+    uint32_t i;
+
+    /* Optional argument: file to store the I2C trace stream in, for TraceDecode */
+    if(argc > 1)
+        s_pcTraceFile = argv[1];
+
+    SIM_Init();
+
+    SYS_UnlockReg();
+    SYS_Init();
+    SYS_LockReg();
+
+    for(i = 0; i < BENCH_LEN; i++)
+        s_au8Tx[i] = (uint8_t)(i * 7 + 1);
+    for(i = 0; i < BENCH_LEN / 4; i++)
+        s_au32Src[i] = 0x01020304 * (i + 1);
+
+    printf("\nCPU @ %u Hz (simulated)\n", SystemCoreClock);
+    printf("+-----------------------------------------------------+\n");
+    printf("|    StdDriver Host Simulator Benchmark               |\n");
+    printf("+-----------------------------------------------------+\n\n");
+
+    Bench_UART();
+    Bench_UARTAsync();
+    Bench_UARTDMA();
+    Bench_SPI();
+    Bench_SPIAsync();
+    Bench_USPIAsync();
+    Bench_I2C();
+    Bench_I2CAsync();
+    Bench_I2CAsyncDMA();
+    Bench_I2CSlave();
+    Bench_UI2CSlave();
+    Bench_UI2CAsync();
+    Bench_PDMA();
+    Bench_PDMAChain();
+    Bench_ADCStream();
+    Bench_FMC();
+    Bench_CRC();
+    Bench_HDIV();
+    Bench_FMEM();
+    Bench_Timer();
+    Bench_TimerWheel();
+    Bench_Trace();
+    Bench_DebugLog();
+    Bench_USBDComposite();
+    Bench_USBDEnum();
+    Bench_USBDMassStorage();
+
+    printf("\n[Driver benchmark ... %s]\n", s_i32Fail ? "FAIL" : "PASS");
+    return s_i32Fail;
+}
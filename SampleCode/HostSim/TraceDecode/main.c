@@ -0,0 +1,245 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @version  V1.00
+ * @brief    Decode the binary stream of the StdDriver trace (trace.c) and print
+ *           per-event counts and latency histograms.
+ * @note     Reads the file given as argument, or stdin, e.g. a UART capture of TRACE_Flush()
+ *           or "DriverBench trace.bin". Bytes outside the trace blocks are skipped, so the
+ *           stream may share the UART with text output.
+ *           Spans are the time from TRACE_BEGIN to the matching TRACE_END. Events that never
+ *           end are point events, measured as the time between two occurrences.
+ *           Timestamps are unwrapped assuming consecutive records are less than one counter
+ *           wrap apart.
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/* The stream constants of trace.h, without pulling the device header into a host tool */
+#define TRACE_ID_END            0x80
+#define TRACE_MAGIC             0x4352544EUL
+#define TRACE_HEADER_SIZE       20
+#define TRACE_RECORD_SIZE       8
+
+#define HIST_BUCKETS            32      /* Bucket k holds durations of 2^k ~ 2^(k+1)-1 ticks */
+
+typedef struct
+{
+    uint32_t u32Count;          /* Completed spans, or intervals between point events */
+    uint32_t u32Seen;           /* Records with this ID, begin or end */
+    uint32_t u32HasEnd;         /* An end record was seen, so this is a span */
+    uint32_t u32Open;           /* A begin is waiting for its end */
+    uint64_t u64Begin;          /* Time of the open begin, or of the last point event */
+    uint64_t u64Sum;
+    uint64_t u64Min;
+    uint64_t u64Max;
+    uint32_t au32Hist[HIST_BUCKETS];
+} EVENT_STAT_T;
+
+static EVENT_STAT_T s_asStat[128];
+static uint64_t s_u64Now;
+static uint32_t s_u32LastStamp;
+static uint32_t s_u32Started;
+static uint32_t s_u32Clock;
+static uint32_t s_u32Drop;
+static uint32_t s_u32Records;
+static uint32_t s_u32Blocks;
+
+static const char *EventName(uint32_t u32Id)
+{
+    static char acName[16];
+
+    switch(u32Id)
+    {
+        case 0x01:
+            return "I2C_READ";
+        case 0x02:
+            return "I2C_WRITE";
+        case 0x10:
+            return "USBD_IRQ";
+        case 0x11:
+            return "USBD_SETUP";
+        default:
+            if(u32Id >= 0x40)
+                snprintf(acName, sizeof(acName), "USER+0x%02X", u32Id - 0x40);
+            else
+                snprintf(acName, sizeof(acName), "ID 0x%02X", u32Id);
+            return acName;
+    }
+}
+
+static uint32_t Word(const uint8_t *pu8Buf)
+{
+    return pu8Buf[0] | ((uint32_t)pu8Buf[1] << 8) | ((uint32_t)pu8Buf[2] << 16) | ((uint32_t)pu8Buf[3] << 24);
+}
+
+static void AddSample(EVENT_STAT_T *psStat, uint64_t u64Ticks)
+{
+    uint32_t u32Bucket = 0;
+
+    while((u32Bucket < HIST_BUCKETS - 1) && (u64Ticks >> (u32Bucket + 1)))
+        u32Bucket++;
+    psStat->au32Hist[u32Bucket]++;
+    if((psStat->u32Count == 0) || (u64Ticks < psStat->u64Min))
+        psStat->u64Min = u64Ticks;
+    if(u64Ticks > psStat->u64Max)
+        psStat->u64Max = u64Ticks;
+    psStat->u64Sum += u64Ticks;
+    psStat->u32Count++;
+}
+
+static void Record(uint32_t u32Stamp, uint32_t u32Modulus)
+{
+    uint32_t u32Id = u32Stamp >> 24;
+    EVENT_STAT_T *psStat = &s_asStat[u32Id & ~TRACE_ID_END];
+
+    u32Stamp &= 0xFFFFFF;
+    if(s_u32Started && u32Modulus)
+        s_u64Now += (u32Stamp + u32Modulus - s_u32LastStamp) % u32Modulus;
+    s_u32LastStamp = u32Stamp;
+    s_u32Started = 1;
+    s_u32Records++;
+
+    psStat->u32Seen++;
+    if(u32Id & TRACE_ID_END)
+    {
+        psStat->u32HasEnd = 1;
+        if(psStat->u32Open)
+            AddSample(psStat, s_u64Now - psStat->u64Begin);
+        psStat->u32Open = 0;
+    }
+    else
+    {
+        /* A begin without an end so far is treated as a point event until an end shows up */
+        if(!psStat->u32HasEnd && (psStat->u32Seen > 1))
+            AddSample(psStat, s_u64Now - psStat->u64Begin);
+        psStat->u32Open = 1;
+        psStat->u64Begin = s_u64Now;
+    }
+}
+
+static void ResetOpenSpans(void)
+{
+    uint32_t i;
+
+    /* Records were dropped, a pending begin may have lost its end */
+    for(i = 0; i < 128; i++)
+        s_asStat[i].u32Open = 0;
+    s_u32Started = 0;
+}
+
+static void PrintTime(uint64_t u64Ticks)
+{
+    double dUs = s_u32Clock ? (double)u64Ticks * 1000000.0 / s_u32Clock : 0;
+
+    if(!s_u32Clock)
+        printf("%10llu tk", (unsigned long long)u64Ticks);
+    else if(dUs < 1000.0)
+        printf("%10.2f us", dUs);
+    else
+        printf("%10.3f ms", dUs / 1000.0);
+}
+
+static void Report(void)
+{
+    EVENT_STAT_T *psStat;
+    uint32_t i, k, u32Peak, u32Bar;
+
+    printf("%u blocks, %u records, %u dropped, timestamp clock %u Hz\n\n", s_u32Blocks, s_u32Records, s_u32Drop, s_u32Clock);
+    for(i = 1; i < 128; i++)
+    {
+        psStat = &s_asStat[i];
+        if(psStat->u32Seen == 0)
+            continue;
+
+        printf("%-12s %-5s %6u samples  min", EventName(i), psStat->u32HasEnd ? "span" : "point", psStat->u32Count);
+        PrintTime(psStat->u64Min);
+        printf("  avg");
+        PrintTime(psStat->u32Count ? psStat->u64Sum / psStat->u32Count : 0);
+        printf("  max");
+        PrintTime(psStat->u64Max);
+        printf("\n");
+
+        u32Peak = 0;
+        for(k = 0; k < HIST_BUCKETS; k++)
+        {
+            if(psStat->au32Hist[k] > u32Peak)
+                u32Peak = psStat->au32Hist[k];
+        }
+        for(k = 0; k < HIST_BUCKETS; k++)
+        {
+            if(psStat->au32Hist[k] == 0)
+                continue;
+            printf("    >=");
+            PrintTime(k ? (1ULL << k) : 0);
+            printf(" %6u ", psStat->au32Hist[k]);
+            for(u32Bar = (psStat->au32Hist[k] * 40 + u32Peak - 1) / u32Peak; u32Bar; u32Bar--)
+                putchar('#');
+            printf("\n");
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static uint8_t au8Buf[1 << 16];
+    FILE *pFile = stdin;
+    uint32_t u32Len = 0, u32Pos, u32Cnt, u32Modulus, u32Drop, i;
+    size_t n;
+
+    if((argc > 1) && ((pFile = fopen(argv[1], "rb")) == NULL))
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    for(;;)
+    {
+        n = fread(&au8Buf[u32Len], 1, sizeof(au8Buf) - u32Len, pFile);
+        u32Len += (uint32_t)n;
+
+        /* Consume every complete block, skip bytes until the next magic word */
+        u32Pos = 0;
+        while(u32Pos + TRACE_HEADER_SIZE <= u32Len)
+        {
+            if(Word(&au8Buf[u32Pos]) != TRACE_MAGIC)
+            {
+                u32Pos++;
+                continue;
+            }
+            u32Cnt = Word(&au8Buf[u32Pos + 16]);
+            if(u32Cnt > (sizeof(au8Buf) - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE)
+            {
+                u32Pos++;
+                continue;
+            }
+            if(u32Pos + TRACE_HEADER_SIZE + u32Cnt * TRACE_RECORD_SIZE > u32Len)
+                break;
+
+            s_u32Clock = Word(&au8Buf[u32Pos + 4]);
+            u32Modulus = Word(&au8Buf[u32Pos + 8]);
+            u32Drop = Word(&au8Buf[u32Pos + 12]);
+            if(u32Drop != s_u32Drop)
+                ResetOpenSpans();
+            s_u32Drop = u32Drop;
+            for(i = 0; i < u32Cnt; i++)
+                Record(Word(&au8Buf[u32Pos + TRACE_HEADER_SIZE + i * TRACE_RECORD_SIZE]), u32Modulus);
+            s_u32Blocks++;
+            u32Pos += TRACE_HEADER_SIZE + u32Cnt * TRACE_RECORD_SIZE;
+        }
+        memmove(au8Buf, &au8Buf[u32Pos], u32Len - u32Pos);
+        u32Len -= u32Pos;
+
+        if(n == 0)
+            break;
+    }
+
+    if(pFile != stdin)
+        fclose(pFile);
+
+    Report();
+    return 0;
+}
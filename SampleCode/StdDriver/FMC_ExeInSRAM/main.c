@@ -4,8 +4,10 @@
  * $Revision: 2 $
  * $Date: 16/10/25 4:29p $
  * @brief
- *           Implement a code and execute in SRAM to program embedded Flash.
- *           (Support KEIL MDK Only)
+ *           Execute functions tagged RAMFUNC in SRAM. Program the embedded Flash by the
+ *           FMC functions placed in SRAM, then compare the execution time of a FIR kernel
+ *           and the interrupt latency of a timer handler in Flash and in SRAM.
+ *           (KEIL links with Library/Device/Nuvoton/NUC029xGE/Source/ARM/NUC029xGE_ramfunc.sct)
  * @note
  * @copyright SPDX-License-Identifier: Apache-2.0
  * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
@@ -20,6 +22,99 @@
 #define DATA_FLASH_TEST_END         0x20000
 #define TEST_PATTERN                0x5A5A5A5A
 
+#define FIR_TAPS            8       /* Taps of the FIR kernel */
+#define FIR_LEN             256     /* Output samples per kernel call */
+#define IRQ_TEST_DELAY      1000    /* Timer ticks from arming the compare to the interrupt */
+#define IRQ_TEST_ROUNDS     16      /* Interrupts averaged per handler */
+
+typedef void (*PFN_FIR_T)(const int16_t *pi16In, int32_t *pi32Out, uint32_t u32Len);
+
+/* Coefficients and samples are in SRAM, so only the code fetch differs between the two kernels */
+static int16_t s_ai16Coef[FIR_TAPS] = { 3, -12, 37, 100, 100, 37, -12, 3 };
+static int16_t s_ai16In[FIR_LEN + FIR_TAPS];
+static int32_t s_ai32Out[FIR_LEN];
+
+static volatile uint32_t s_u32IrqCnt;   /* Timer counter read on handler entry */
+
+/* Same FIR kernel placed in Flash and in SRAM */
+#define FIR_KERNEL(name, placement)                                             \
+placement void name(const int16_t *pi16In, int32_t *pi32Out, uint32_t u32Len)  \
+{                                                                               \
+    uint32_t i, j;                                                              \
+    int32_t i32Acc;                                                             \
+                                                                                \
+    for(i = 0; i < u32Len; i++)                                                 \
+    {                                                                           \
+        i32Acc = 0;                                                             \
+        for(j = 0; j < FIR_TAPS; j++)                                           \
+            i32Acc += pi16In[i + j] * s_ai16Coef[j];                            \
+        pi32Out[i] = i32Acc;                                                    \
+    }                                                                           \
+}
+
+FIR_KERNEL(FIR_Flash, )
+FIR_KERNEL(FIR_SRAM, RAMFUNC)
+
+/* Timer 0 handler executes in Flash */
+void TMR0_IRQHandler(void)
+{
+    s_u32IrqCnt = TIMER0->CNT;
+    TIMER_ClearIntFlag(TIMER0);
+}
+
+/* Timer 1 handler executes in SRAM */
+RAMFUNC void TMR1_IRQHandler(void)
+{
+    s_u32IrqCnt = TIMER1->CNT;
+    TIMER_ClearIntFlag(TIMER1);
+}
+
+/* HCLK cycles of one kernel call, measured by SysTick */
+uint32_t MeasureFir(PFN_FIR_T pfnFir)
+{
+    uint32_t u32Start, u32End;
+
+    SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+
+    u32Start = SysTick->VAL;
+    pfnFir(s_ai16In, s_ai32Out, FIR_LEN);
+    u32End = SysTick->VAL;
+
+    SysTick->CTRL = 0;
+
+    return (u32Start - u32End) & SysTick_LOAD_RELOAD_Msk;
+}
+
+/* Average HCLK cycles from the compare match to the counter read in the handler */
+uint32_t MeasureIrqLatency(TIMER_T *timer, IRQn_Type IRQn)
+{
+    uint32_t i, u32Cmp, u32Sum = 0;
+
+    /* Continuous mode at HCLK, the counter keeps running after a match */
+    timer->CTL = TIMER_CONTINUOUS_MODE;
+    TIMER_EnableInt(timer);
+    NVIC_EnableIRQ(IRQn);
+    TIMER_Start(timer);
+
+    for(i = 0; i < IRQ_TEST_ROUNDS; i++)
+    {
+        s_u32IrqCnt = 0xFFFFFFFF;
+        u32Cmp = (timer->CNT + IRQ_TEST_DELAY) & TIMER_CNT_CNT_Msk;
+        TIMER_SET_CMP_VALUE(timer, u32Cmp);
+
+        while(s_u32IrqCnt == 0xFFFFFFFF);
+
+        u32Sum += (s_u32IrqCnt - u32Cmp) & TIMER_CNT_CNT_Msk;
+    }
+
+    NVIC_DisableIRQ(IRQn);
+    TIMER_Stop(timer);
+    TIMER_DisableInt(timer);
+
+    return u32Sum / IRQ_TEST_ROUNDS;
+}
 
 
 void SYS_Init(void)
@@ -55,6 +150,12 @@ void SYS_Init(void)
     /* Select UART module clock source as HXT and UART module clock divider as 1 */
     CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UARTSEL_HXT, CLK_CLKDIV0_UART(1));
 
+    /* Enable Timer 0 and Timer 1 clock, counting at PCLK0 (HCLK) */
+    CLK_EnableModuleClock(TMR0_MODULE);
+    CLK_EnableModuleClock(TMR1_MODULE);
+    CLK_SetModuleClock(TMR0_MODULE, CLK_CLKSEL1_TMR0SEL_PCLK0, 0);
+    CLK_SetModuleClock(TMR1_MODULE, CLK_CLKSEL1_TMR1SEL_PCLK0, 0);
+
     /*---------------------------------------------------------------------------------------------------------*/
     /* Init I/O Multi-function                                                                                 */
     /*---------------------------------------------------------------------------------------------------------*/
@@ -75,8 +176,9 @@ void UART0_Init()
 
 int main()
 {
-    uint32_t u32Data, u32RData;
+    uint32_t au32Data[FMC_MULTI_WORD_PROG_LEN / 4];
     uint32_t u32Addr;
+    uint32_t u32Flash, u32SRAM;
     uint32_t i;
 
     /* Disable register write-protection function */
@@ -95,36 +197,48 @@ int main()
 
     /*
        This sample code is used to demonstrate how to implement a code to execute in SRAM.
-       By setting scatter loading file (scatter.scf),
-       RO code is placed to 0x20000000 ~ 0x20001fff with RW is placed to 0x20002000 ~ 0x20003fff.
+       Functions tagged RAMFUNC are linked to SRAM and copied there by the startup code,
+       the rest of the program executes in Flash.
     */
 
     /* Enable FMC ISP functions */
     FMC_Open();
     FMC_ENABLE_AP_UPDATE();
 
-    /* The ROM address for erase/write/read demo */
+    /* The ROM address for erase/write/read demo. FMC_ErasePages and FMC_WriteMultiple execute in SRAM. */
     u32Addr = 0x4000;
-    FMC_Erase(u32Addr); /* Erase page */
-    for(i = 0; i < 0x100; i += 4)
-    {
-
-        /* Write Demo */
-        u32Data = i + 0x12345678;
-        FMC_Write(u32Addr + i, u32Data);
-
-        if((i & 0xf) == 0)
-            printf(".");
+    for(i = 0; i < sizeof(au32Data) / 4; i++)
+        au32Data[i] = i * 4 + 0x12345678;
 
-        /* Read Demo */
-        u32RData = FMC_Read(u32Addr + i);
+    if((FMC_ErasePages(u32Addr, 1) != 0) ||
+            (FMC_WriteMultiple(u32Addr, au32Data, sizeof(au32Data)) != 0))
+    {
+        printf("[Erase/Write FAIL]\n");
+        goto lexit;
+    }
 
-        if(u32Data != u32RData)
+    for(i = 0; i < sizeof(au32Data) / 4; i++)
+    {
+        if(FMC_Read(u32Addr + i * 4) != au32Data[i])
         {
             printf("[Read/Write FAIL]\n");
             goto lexit;
         }
     }
+    printf("FMC erase/write/read from SRAM ... [OK]\n\n");
+
+    /* Execution time of the same kernel in Flash and SRAM */
+    for(i = 0; i < FIR_LEN + FIR_TAPS; i++)
+        s_ai16In[i] = (int16_t)(i * 97);
+
+    u32Flash = MeasureFir(FIR_Flash);
+    u32SRAM = MeasureFir(FIR_SRAM);
+    printf("FIR %d taps x %d samples : Flash %d cycles, SRAM %d cycles\n", FIR_TAPS, FIR_LEN, u32Flash, u32SRAM);
+
+    /* Interrupt latency of the same handler in Flash and SRAM */
+    u32Flash = MeasureIrqLatency(TIMER0, TMR0_IRQn);
+    u32SRAM = MeasureIrqLatency(TIMER1, TMR1_IRQn);
+    printf("Timer interrupt latency   : Flash %d cycles, SRAM %d cycles\n", u32Flash, u32SRAM);
 
 lexit:
 
@@ -144,7 +144,20 @@ void UART0_Init(void)
     /* Configure UART0 and set UART0 Baudrate */
     UART0->BAUD = UART_BAUD_MODE2 | UART_BAUD_MODE2_DIVIDER(__HIRC, 115200);
     UART0->LINE = UART_WORD_LEN_8 | UART_PARITY_NONE | UART_STOP_BIT_1;
+
+#if defined(DEBUG_ENABLE_LOG)
+    /* Status messages are queued by DEBUG_LOG() and sent by the lowest priority UART interrupt */
+    NVIC_SetPriority(UART02_IRQn, 3);
+    NVIC_EnableIRQ(UART02_IRQn);
+#endif
+}
+
+#if defined(DEBUG_ENABLE_LOG)
+void UART02_IRQHandler(void)
+{
+    DEBUG_LogIRQHandler();
 }
+#endif
 
 void I2C0_Init(void)
 {
@@ -152,7 +165,7 @@ void I2C0_Init(void)
     I2C_Open(I2C0, 100000);
 
     /* Get I2C0 Bus Clock */
-    printf("I2C clock %d Hz\n", I2C_GetBusClockFreq(I2C0));
+    DEBUG_LOG("I2C clock %d Hz\n", I2C_GetBusClockFreq(I2C0));
 }
 
 
@@ -344,13 +357,13 @@ int32_t main(void)
             {
 
 
-                printf("\nEnter codec setting:\n");
+                DEBUG_LOG("\nEnter codec setting:\n");
                 // Get Register number
                 ch = getchar();
                 u32Reg = ch - '0';
                 ch = getchar();
                 u32Reg = u32Reg * 10 + (ch - '0');
-                printf("%d\n", u32Reg);
+                DEBUG_LOG("%d\n", u32Reg);
 
                 // Get data
                 ch = getchar();
@@ -359,7 +372,7 @@ int32_t main(void)
                 u32Data = u32Data * 16 + ((ch >= '0' && ch <= '9') ? ch - '0' : ch - 'a' + 10);
                 ch = getchar();
                 u32Data = u32Data * 16 + ((ch >= '0' && ch <= '9') ? ch - '0' : ch - 'a' + 10);
-                printf("%03x\n", u32Data);
+                DEBUG_LOG("%03x\n", u32Data);
                 I2C_WriteNAU8822(u32Reg,  u32Data);
             }
         }
@@ -684,7 +684,7 @@ int32_t I2C_WaitReady(I2C_T *i2c)
     {
         if(u32Cnt++ > u32Timeout)
         {
-            printf("ctl=%x sts=%x flow=%d\n", i2c->CTL, i2c->STATUS, g_u32I2cFlow);
+            DEBUG_LOG("ctl=%x sts=%x flow=%d\n", i2c->CTL, i2c->STATUS, g_u32I2cFlow);
 
             return -1;
         }
@@ -817,7 +817,7 @@ void NAU8822_Setup(void)
 
     GPIO_SetMode(PE, (1 << 13), GPIO_MODE_OUTPUT);
     PE13 = 0;
-    printf("NAU8822 setup ready!\n");
+    DEBUG_LOG("NAU8822 setup ready!\n");
 }
 
 
@@ -1078,7 +1078,7 @@ void AdjFreq(void)
     if((i32PreFlag != g_i32AdjFlag) || (i32Cnt++ > 40000))
     {
         i32PreFlag = g_i32AdjFlag;
-        printf("%d %d %d %d %x\n", g_i32AdjFlag, u32Size, g_usbd_PlayVolumeL, g_usbd_RecVolumeL, (uint32_t)FAUDIOCFG);
+        DEBUG_LOG("%d %d %d %d %x\n", g_i32AdjFlag, u32Size, g_usbd_PlayVolumeL, g_usbd_RecVolumeL, (uint32_t)FAUDIOCFG);
         i32Cnt = 0;
     }
 
@@ -88,7 +88,7 @@
 
 /*-------------------------------------------------------------*/
 /* Define EP maximum packet size */
-#define EP0_MAX_PKT_SIZE    8
+#define EP0_MAX_PKT_SIZE    32    /* 64 does not fit: 8 + 64 + 256 + 192 > 512 bytes of USB SRAM */
 #define EP1_MAX_PKT_SIZE    EP0_MAX_PKT_SIZE
 #define EP2_MAX_PKT_SIZE    256
 #define EP3_MAX_PKT_SIZE    PLAY_RATE*PLAY_CHANNELS*2/1000
@@ -0,0 +1,246 @@
+/**************************************************************************//**
+ * @file     HIDTransferTest.cpp
+ * @brief    Linux HID transfer test and throughput benchmark for the USBD_HID_Transfer sample
+ *
+ * @note     Runs the erase/blank/write/verify test of the Windows HIDTransferTest tool with the
+ *           legacy commands and a write/verify test with the stream commands, then prints the
+ *           throughput, request latency percentiles and errors of every transfer kind.
+ *           "-d sim" runs against the sample firmware on the host simulator, so it needs no board.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <memory>
+#include <vector>
+#include "HidTransfer.hpp"
+
+#define TEST_PAGES      4                       /* Test pages of the sample firmware */
+#define TEST_BASE       0x10000                 /* 64kbytes */
+
+#define MODE_LEGACY     0x1
+#define MODE_STREAM     0x2
+
+static void Usage(const char *pcName)
+{
+    printf("Usage: %s [options]\n"
+           "  -d DEV   hidraw (default), hidraw:/dev/hidrawN, libusb, or sim for the simulated device\n"
+           "  -m MODE  legacy, stream or both (default both)\n"
+           "  -n N     iterations (default 10)\n"
+           "  -s PAGE  start page (default %u)\n"
+           "  -p N     pages per iteration (default %u)\n"
+           "  -r N     pages per stream request (default 1)\n"
+           "  -q N     requests and reports in flight (default %u)\n"
+           "  -v       print the console of the simulated device\n",
+           pcName, TEST_BASE / PAGE_SIZE, TEST_PAGES, STREAM_QUEUE_LEN);
+}
+
+static CHidTransport *CreateTransport(const char *pcDev, bool bVerbose)
+{
+    if(strcmp(pcDev, "sim") == 0)
+        return CreateSimTransport(bVerbose);
+    if(strcmp(pcDev, "hidraw") == 0)
+        return CreateHidrawTransport(NULL);
+    if(strncmp(pcDev, "hidraw:", 7) == 0)
+        return CreateHidrawTransport(pcDev + 7);
+#ifdef HID_WITH_LIBUSB
+    if(strcmp(pcDev, "libusb") == 0)
+        return CreateLibusbTransport();
+#endif
+
+    return NULL;
+}
+
+/* Index of the first byte of pu8Buf that is not the expected one, or -1 */
+static int Compare(const uint8_t *pu8Buf, const uint8_t *pu8Expect, uint32_t u32Size)
+{
+    uint32_t i;
+
+    for(i = 0; i < u32Size; i++)
+    {
+        if(pu8Buf[i] != pu8Expect[i])
+            return (int)i;
+    }
+
+    return -1;
+}
+
+/* Different data every iteration, so a stale page does not pass */
+static void FillPattern(uint8_t *pu8Buf, uint32_t u32Size, uint32_t u32Seed)
+{
+    uint32_t i;
+
+    for(i = 0; i < u32Size; i++)
+        pu8Buf[i] = (uint8_t)(i + (i / PAGE_SIZE) * 17 + u32Seed * 29);
+}
+
+/* Erase, blank check, write and verify with the commands of the Windows tool */
+static bool LegacyTest(CHidTransfer &sHid, uint32_t u32StartPage, uint32_t u32Pages, uint32_t u32Iter,
+                       std::vector<uint8_t> &au8Wr, std::vector<uint8_t> &au8Rd)
+{
+    uint32_t u32Size = u32Pages * PAGE_SIZE;
+    int iErr;
+
+    if(sHid.EraseSectors(u32StartPage * PAGE_SIZE / SECTOR_SIZE, (u32Size + SECTOR_SIZE - 1) / SECTOR_SIZE) < 0)
+        return false;
+
+    memset(&au8Rd[0], 0xCC, u32Size);
+    if(sHid.ReadPages(&au8Rd[0], u32StartPage, u32Pages) < 0)
+        return false;
+    memset(&au8Wr[0], 0xFF, u32Size);
+    if((iErr = Compare(&au8Rd[0], &au8Wr[0], u32Size)) >= 0)
+    {
+        printf("ERROR: Blank test fail at byte %d!\n", iErr);
+        sHid.Stats(XFER_READ).m_u32Errors++;
+        return false;
+    }
+
+    FillPattern(&au8Wr[0], u32Size, u32Iter);
+    if(sHid.WritePages(&au8Wr[0], u32StartPage, u32Pages) < 0)
+        return false;
+
+    memset(&au8Rd[0], 0xCC, u32Size);
+    if(sHid.ReadPages(&au8Rd[0], u32StartPage, u32Pages) < 0)
+        return false;
+    if((iErr = Compare(&au8Rd[0], &au8Wr[0], u32Size)) >= 0)
+    {
+        printf("ERROR: Programming test fail at byte %d!\n", iErr);
+        sHid.Stats(XFER_READ).m_u32Errors++;
+        return false;
+    }
+
+    return true;
+}
+
+/* Write and verify with the stream commands */
+static bool StreamTest(CHidTransfer &sHid, uint32_t u32StartPage, uint32_t u32Pages, uint32_t u32ReqPages,
+                       uint32_t u32Depth, uint32_t u32Iter, std::vector<uint8_t> &au8Wr, std::vector<uint8_t> &au8Rd)
+{
+    uint32_t u32Size = u32Pages * PAGE_SIZE;
+    int iErr;
+
+    FillPattern(&au8Wr[0], u32Size, ~u32Iter);
+    if(sHid.StreamWritePages(&au8Wr[0], u32StartPage, u32Pages, u32ReqPages) < 0)
+        return false;
+
+    memset(&au8Rd[0], 0xCC, u32Size);
+    if(sHid.StreamReadPages(&au8Rd[0], u32StartPage, u32Pages, u32ReqPages, u32Depth) < 0)
+        return false;
+    if((iErr = Compare(&au8Rd[0], &au8Wr[0], u32Size)) >= 0)
+    {
+        printf("ERROR: Stream test fail at byte %d!\n", iErr);
+        sHid.Stats(XFER_STREAM_READ).m_u32Errors++;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pcDev = "hidraw";
+    uint32_t u32Mode = MODE_LEGACY | MODE_STREAM;
+    uint32_t u32Iters = 10, u32StartPage = TEST_BASE / PAGE_SIZE, u32Pages = TEST_PAGES;
+    uint32_t u32ReqPages = 1, u32Depth = STREAM_QUEUE_LEN, u32Errors = 0, i;
+    bool bVerbose = false;
+    int iOpt;
+
+    while((iOpt = getopt(argc, argv, "d:m:n:s:p:r:q:vh")) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'd':
+                pcDev = optarg;
+                break;
+            case 'm':
+                if(strcmp(optarg, "legacy") == 0)
+                    u32Mode = MODE_LEGACY;
+                else if(strcmp(optarg, "stream") == 0)
+                    u32Mode = MODE_STREAM;
+                else if(strcmp(optarg, "both") == 0)
+                    u32Mode = MODE_LEGACY | MODE_STREAM;
+                else
+                {
+                    Usage(argv[0]);
+                    return 2;
+                }
+                break;
+            case 'n':
+                u32Iters = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                u32StartPage = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                u32Pages = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                u32ReqPages = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'q':
+                u32Depth = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'v':
+                bVerbose = true;
+                break;
+            default:
+                Usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if((u32Pages == 0) || (u32ReqPages == 0) || (u32Depth == 0))
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    std::unique_ptr<CHidTransport> pTransport(CreateTransport(pcDev, bVerbose));
+    if(!pTransport)
+    {
+        printf("Unknown device \"%s\"\n", pcDev);
+        Usage(argv[0]);
+        return 2;
+    }
+
+    if(!pTransport->OpenDevice(USB_VID, USB_PID, u32Depth))
+    {
+        printf("Can't Open HID Device\n");
+        return 1;
+    }
+    printf("USB HID Device VID[%04x] PID[%04x] Open Success (%s).\n", USB_VID, USB_PID, pTransport->Name());
+    printf(">>> %u iterations of pages %u - %u, %u pages per stream request, %u in flight\n",
+           u32Iters, u32StartPage, u32StartPage + u32Pages - 1, u32ReqPages, u32Depth);
+
+    CHidTransfer sHid(pTransport.get());
+    std::vector<uint8_t> au8Wr(u32Pages * PAGE_SIZE), au8Rd(u32Pages * PAGE_SIZE);
+
+    sHid.SendTestCmd();
+    for(i = 0; i < u32Iters; i++)
+    {
+        if((u32Mode & MODE_LEGACY) && !LegacyTest(sHid, u32StartPage, u32Pages, i, au8Wr, au8Rd))
+            u32Errors++;
+        if((u32Mode & MODE_STREAM) && !StreamTest(sHid, u32StartPage, u32Pages, u32ReqPages, u32Depth, i, au8Wr, au8Rd))
+            u32Errors++;
+    }
+    pTransport->CloseDevice();
+
+    printf("\n  %-13s %13s %9s   %8s %8s %8s %8s      %s\n", "transfer", "throughput", "requests",
+           "p50", "p90", "p99", "max", "errors");
+    if(u32Mode & MODE_LEGACY)
+    {
+        sHid.Stats(XFER_READ).Print("ReadPages");
+        sHid.Stats(XFER_WRITE).Print("WritePages");
+    }
+    if(u32Mode & MODE_STREAM)
+    {
+        sHid.Stats(XFER_STREAM_READ).Print("StreamRead");
+        sHid.Stats(XFER_STREAM_WRITE).Print("StreamWrite");
+    }
+
+    printf("\n[HID transfer %s %s]\n", pTransport->Name(), (u32Errors == 0) ? "PASS" : "FAIL");
+    return (u32Errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,403 @@
+/**************************************************************************//**
+ * @file     HidTransfer.cpp
+ * @brief    Host side of the USBD_HID_Transfer command protocol
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include "HidTransfer.hpp"
+
+void CXferStats::Reset()
+{
+    m_u64Bytes = 0;
+    m_u64BusyUs = 0;
+    m_u32Errors = 0;
+    m_au32LatencyUs.clear();
+}
+
+double CXferStats::KBps() const
+{
+    if(m_u64BusyUs == 0)
+        return 0.0;
+
+    return ((double)m_u64Bytes / 1024.0) / ((double)m_u64BusyUs / 1000000.0);
+}
+
+uint32_t CXferStats::Percentile(uint32_t u32Percent) const
+{
+    std::vector<uint32_t> au32Sorted(m_au32LatencyUs);
+    size_t szIdx;
+
+    if(au32Sorted.empty())
+        return 0;
+
+    /* Nearest rank */
+    szIdx = (au32Sorted.size() * u32Percent + 99) / 100;
+    szIdx = (szIdx > 0) ? szIdx - 1 : 0;
+    std::nth_element(au32Sorted.begin(), au32Sorted.begin() + szIdx, au32Sorted.end());
+    return au32Sorted[szIdx];
+}
+
+void CXferStats::Print(const char *pcName) const
+{
+    printf("  %-13s %8.1f KB/s %5u req   %8.2f %8.2f %8.2f %8.2f ms   %u\n", pcName, KBps(),
+           (uint32_t)m_au32LatencyUs.size(), Percentile(50) / 1000.0, Percentile(90) / 1000.0,
+           Percentile(99) / 1000.0, Percentile(100) / 1000.0, m_u32Errors);
+}
+
+uint32_t CHidTransfer::CalCheckSum(const uint8_t *pu8Buf, uint32_t u32Size)
+{
+    uint32_t u32Sum = 0;
+
+    while(u32Size--)
+        u32Sum += *pu8Buf++;
+
+    return u32Sum;
+}
+
+/* IEEE 802.3 CRC-32, the same as the CRC controller of the device with reversed data and checksum */
+uint32_t CHidTransfer::Crc32(uint32_t u32Crc, const uint8_t *pu8Buf, uint32_t u32Size)
+{
+    static uint32_t au32Table[256];
+    uint32_t i, j, u32Reg;
+
+    if(au32Table[1] == 0)
+    {
+        for(i = 0; i < 256; i++)
+        {
+            for(u32Reg = i, j = 0; j < 8; j++)
+                u32Reg = (u32Reg >> 1) ^ ((u32Reg & 1) ? 0xEDB88320 : 0);
+            au32Table[i] = u32Reg;
+        }
+    }
+
+    u32Reg = ~u32Crc;
+    while(u32Size--)
+        u32Reg = (u32Reg >> 8) ^ au32Table[(u32Reg ^ *pu8Buf++) & 0xFF];
+
+    return ~u32Reg;
+}
+
+bool CHidTransfer::SendCmd(uint8_t u8Cmd, uint32_t u32Arg1, uint32_t u32Arg2)
+{
+    uint8_t au8Report[HID_REPORT_SIZE];
+    CMD_T cmd;
+
+    cmd.cmd = u8Cmd;
+    cmd.len = sizeof(cmd) - 4; /* Not include checksum */
+    cmd.arg1 = u32Arg1;
+    cmd.arg2 = u32Arg2;
+    cmd.signature = HID_CMD_SIGNATURE;
+    if((u8Cmd == HID_CMD_STREAM_READ) || (u8Cmd == HID_CMD_STREAM_WRITE))
+        cmd.checksum = Crc32(0, (uint8_t *)&cmd, cmd.len);
+    else
+        cmd.checksum = CalCheckSum((uint8_t *)&cmd, cmd.len);
+
+    memset(au8Report, 0, sizeof(au8Report));
+    memcpy(au8Report, &cmd, sizeof(cmd));
+
+    /* Stream commands go on the control pipe, so interrupt OUT carries page data only */
+    if((u8Cmd == HID_CMD_STREAM_READ) || (u8Cmd == HID_CMD_STREAM_WRITE))
+        return m_pTransport->SetFeature(au8Report, USB_PROG_TIME_OUT);
+
+    return m_pTransport->WriteReport(au8Report, USB_PROG_TIME_OUT);
+}
+
+/* GET_REPORT of the feature report until the oldest stream request has finished */
+bool CHidTransfer::GetStatus(STREAM_STATUS_T *psStatus, uint32_t u32Ms)
+{
+    uint8_t au8Report[HID_REPORT_SIZE];
+    uint64_t u64End = m_pTransport->NowUs() + (uint64_t)u32Ms * 1000;
+
+    do
+    {
+        if(!m_pTransport->GetFeature(au8Report, USB_TIME_OUT))
+            return false;
+
+        memcpy(psStatus, au8Report, sizeof(*psStatus));
+        if(psStatus->cmd != HID_CMD_NONE)
+            return psStatus->signature == HID_CMD_SIGNATURE;
+    }
+    while(m_pTransport->NowUs() < u64End);
+
+    return false;
+}
+
+/* Take the status of a stream request and check it against what was moved */
+bool CHidTransfer::ReadStatus(uint8_t u8Cmd, uint32_t u32Arg1, uint32_t u32Pages, uint32_t u32Crc, uint32_t u32Ms)
+{
+    STREAM_STATUS_T sStatus;
+
+    if(!GetStatus(&sStatus, u32Ms))
+    {
+        printf("ERROR: No status of request at page %u\n", u32Arg1);
+        return false;
+    }
+
+    if((sStatus.signature != HID_CMD_SIGNATURE) || (sStatus.cmd != u8Cmd) || (sStatus.arg1 != u32Arg1) ||
+            (sStatus.status != STREAM_STATUS_OK) || (sStatus.arg2 != u32Pages))
+    {
+        printf("ERROR: Request at page %u failed, status %u\n", u32Arg1, sStatus.status);
+        return false;
+    }
+    if(sStatus.crc != u32Crc)
+    {
+        printf("ERROR: CRC of request at page %u is 0x%08X, expect 0x%08X\n", u32Arg1, sStatus.crc, u32Crc);
+        return false;
+    }
+
+    return true;
+}
+
+/* After an error: let the writes go out, drop IN reports until the device is quiet and take the stream statuses */
+void CHidTransfer::Resync()
+{
+    uint8_t au8Report[HID_REPORT_SIZE];
+    STREAM_STATUS_T sStatus;
+    uint32_t i;
+
+    m_pTransport->Flush(USB_PROG_TIME_OUT);
+    while(m_pTransport->ReadReport(au8Report, USB_TIME_OUT));
+    for(i = 0; (i < STREAM_QUEUE_LEN) && GetStatus(&sStatus, 0); i++);
+}
+
+/*
+    Erase sectors of the target device. Returns the number of sectors erased, or -1.
+*/
+int CHidTransfer::EraseSectors(uint32_t u32StartSector, uint32_t u32Sectors)
+{
+    if(!SendCmd(HID_CMD_ERASE, u32StartSector, u32Sectors) || !m_pTransport->Flush(USB_PROG_TIME_OUT))
+    {
+        printf("ERROR: Send erase command error!\n");
+        return -1;
+    }
+
+    return (int)u32Sectors;
+}
+
+/*
+    Read pages with HID_CMD_READ, one command for all of them. Returns the bytes read, or -1.
+*/
+int CHidTransfer::ReadPages(uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages)
+{
+    CXferStats &sStats = m_asStats[XFER_READ];
+    uint64_t u64Start = m_pTransport->NowUs();
+    uint32_t i, u32Reports = u32Pages * (PAGE_SIZE / HID_REPORT_SIZE);
+
+    if(!SendCmd(HID_CMD_READ, u32StartPage, u32Pages))
+    {
+        printf("ERROR: Send read command error!\n");
+        sStats.m_u32Errors++;
+        return -1;
+    }
+
+    for(i = 0; i < u32Reports; i++)
+    {
+        if(!m_pTransport->ReadReport(pu8Buf + i * HID_REPORT_SIZE, USB_PROG_TIME_OUT))
+        {
+            printf("ERROR: Read fail!\n");
+            sStats.m_u32Errors++;
+            Resync();
+            return -1;
+        }
+    }
+
+    sStats.m_u64BusyUs += m_pTransport->NowUs() - u64Start;
+    sStats.m_u64Bytes += u32Pages * PAGE_SIZE;
+    sStats.m_au32LatencyUs.push_back((uint32_t)(m_pTransport->NowUs() - u64Start));
+    return (int)(u32Pages * PAGE_SIZE);
+}
+
+/*
+    Write pages with HID_CMD_WRITE, one command for all of them. Returns the bytes written, or -1.
+*/
+int CHidTransfer::WritePages(const uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages)
+{
+    CXferStats &sStats = m_asStats[XFER_WRITE];
+    uint64_t u64Start = m_pTransport->NowUs();
+    uint32_t i, u32Reports = u32Pages * (PAGE_SIZE / HID_REPORT_SIZE);
+
+    if(!SendCmd(HID_CMD_WRITE, u32StartPage, u32Pages))
+    {
+        printf("ERROR: Send write command error!\n");
+        sStats.m_u32Errors++;
+        return -1;
+    }
+
+    for(i = 0; i < u32Reports; i++)
+    {
+        if(!m_pTransport->WriteReport(pu8Buf + i * HID_REPORT_SIZE, USB_PROG_TIME_OUT))
+        {
+            printf("ERROR: Write fail!\n");
+            sStats.m_u32Errors++;
+            Resync();
+            return -1;
+        }
+    }
+    if(!m_pTransport->Flush(USB_PROG_TIME_OUT))
+    {
+        printf("ERROR: Write fail!\n");
+        sStats.m_u32Errors++;
+        return -1;
+    }
+
+    sStats.m_u64BusyUs += m_pTransport->NowUs() - u64Start;
+    sStats.m_u64Bytes += u32Pages * PAGE_SIZE;
+    sStats.m_au32LatencyUs.push_back((uint32_t)(m_pTransport->NowUs() - u64Start));
+    return (int)(u32Pages * PAGE_SIZE);
+}
+
+/*
+    Simple demo of sending a command. The device prints it on its console.
+*/
+int CHidTransfer::SendTestCmd()
+{
+    if(!SendCmd(HID_CMD_TEST, 0x12345678, 0xabcdef01) || !m_pTransport->Flush(USB_PROG_TIME_OUT))
+    {
+        printf("ERROR: Send test command error!\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+    Read pages with HID_CMD_STREAM_READ, u32ReqPages per command. Up to u32Depth commands, no more than the
+    device queues, are outstanding, so the device moves the next request without waiting for the host.
+    Commands and statuses go on the control pipe while interrupt IN carries the pages.
+    Returns the bytes read, or -1.
+*/
+int CHidTransfer::StreamReadPages(uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages, uint32_t u32ReqPages, uint32_t u32Depth)
+{
+    CXferStats &sStats = m_asStats[XFER_STREAM_READ];
+    std::deque<uint64_t> sSent;
+    uint64_t u64Start = m_pTransport->NowUs();
+    uint32_t u32Reqs, u32Next = 0, u32Done = 0, u32Page, u32Cnt, i;
+    uint8_t *pu8Req;
+
+    if(u32ReqPages == 0)
+        u32ReqPages = 1;
+    u32Depth = std::max(1u, std::min(u32Depth, (uint32_t)STREAM_QUEUE_LEN));
+    u32Reqs = (u32Pages + u32ReqPages - 1) / u32ReqPages;
+
+    while(u32Done < u32Reqs)
+    {
+        while((u32Next < u32Reqs) && (u32Next - u32Done < u32Depth))
+        {
+            u32Page = u32Next * u32ReqPages;
+            if(!SendCmd(HID_CMD_STREAM_READ, u32StartPage + u32Page, std::min(u32ReqPages, u32Pages - u32Page)))
+            {
+                printf("ERROR: Send read command error!\n");
+                goto lerr;
+            }
+            sSent.push_back(m_pTransport->NowUs());
+            u32Next++;
+        }
+
+        /* Page data of the oldest request, then its status */
+        u32Page = u32Done * u32ReqPages;
+        u32Cnt = std::min(u32ReqPages, u32Pages - u32Page);
+        pu8Req = pu8Buf + u32Page * PAGE_SIZE;
+        for(i = 0; i < u32Cnt * (PAGE_SIZE / HID_REPORT_SIZE); i++)
+        {
+            if(!m_pTransport->ReadReport(pu8Req + i * HID_REPORT_SIZE, USB_PROG_TIME_OUT))
+            {
+                /* A rejected request has no data, its status tells why */
+                if(i == 0)
+                    ReadStatus(HID_CMD_STREAM_READ, u32StartPage + u32Page, u32Cnt, 0, USB_TIME_OUT);
+                printf("ERROR: Read fail!\n");
+                goto lerr;
+            }
+        }
+
+        if(!ReadStatus(HID_CMD_STREAM_READ, u32StartPage + u32Page, u32Cnt, Crc32(0, pu8Req, u32Cnt * PAGE_SIZE), USB_PROG_TIME_OUT))
+            goto lerr;
+
+        sStats.m_au32LatencyUs.push_back((uint32_t)(m_pTransport->NowUs() - sSent.front()));
+        sSent.pop_front();
+        u32Done++;
+    }
+
+    sStats.m_u64BusyUs += m_pTransport->NowUs() - u64Start;
+    sStats.m_u64Bytes += u32Pages * PAGE_SIZE;
+    return (int)(u32Pages * PAGE_SIZE);
+
+lerr:
+    sStats.m_u32Errors++;
+    Resync();
+    return -1;
+}
+
+/*
+    Write pages with HID_CMD_STREAM_WRITE, u32ReqPages per command. The command of a request goes on the control
+    pipe right before its data, so the data of the requests follows on interrupt OUT without a gap. The status
+    of a request is taken STREAM_WRITE_LAG requests later, once the device has programmed it.
+    Returns the bytes written, or -1.
+*/
+int CHidTransfer::StreamWritePages(const uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages, uint32_t u32ReqPages)
+{
+    CXferStats &sStats = m_asStats[XFER_STREAM_WRITE];
+    std::deque<uint64_t> sSent;
+    uint64_t u64Start = m_pTransport->NowUs();
+    uint32_t u32Reqs, u32Req, u32Page, u32Cnt, i;
+    const uint8_t *pu8Req;
+
+    if(u32ReqPages == 0)
+        u32ReqPages = 1;
+    u32Reqs = (u32Pages + u32ReqPages - 1) / u32ReqPages;
+
+    for(u32Req = 0; u32Req < u32Reqs + STREAM_WRITE_LAG; u32Req++)
+    {
+        /* Status of the request sent STREAM_WRITE_LAG before, the last one once all data is out */
+        if((u32Req == u32Reqs + STREAM_WRITE_LAG - 1) && !m_pTransport->Flush(USB_PROG_TIME_OUT))
+        {
+            printf("ERROR: Write fail!\n");
+            goto lerr;
+        }
+        if(u32Req >= STREAM_WRITE_LAG)
+        {
+            u32Page = (u32Req - STREAM_WRITE_LAG) * u32ReqPages;
+            u32Cnt = std::min(u32ReqPages, u32Pages - u32Page);
+            if(!ReadStatus(HID_CMD_STREAM_WRITE, u32StartPage + u32Page, u32Cnt,
+                           Crc32(0, pu8Buf + u32Page * PAGE_SIZE, u32Cnt * PAGE_SIZE), USB_PROG_TIME_OUT))
+                goto lerr;
+            sStats.m_au32LatencyUs.push_back((uint32_t)(m_pTransport->NowUs() - sSent.front()));
+            sSent.pop_front();
+        }
+
+        if(u32Req >= u32Reqs)
+            continue;
+
+        u32Page = u32Req * u32ReqPages;
+        u32Cnt = std::min(u32ReqPages, u32Pages - u32Page);
+        pu8Req = pu8Buf + u32Page * PAGE_SIZE;
+        if(!SendCmd(HID_CMD_STREAM_WRITE, u32StartPage + u32Page, u32Cnt))
+        {
+            printf("ERROR: Send write command error!\n");
+            goto lerr;
+        }
+        sSent.push_back(m_pTransport->NowUs());
+
+        for(i = 0; i < u32Cnt * (PAGE_SIZE / HID_REPORT_SIZE); i++)
+        {
+            if(!m_pTransport->WriteReport(pu8Req + i * HID_REPORT_SIZE, USB_PROG_TIME_OUT))
+            {
+                printf("ERROR: Write fail!\n");
+                goto lerr;
+            }
+        }
+    }
+
+    sStats.m_u64BusyUs += m_pTransport->NowUs() - u64Start;
+    sStats.m_u64Bytes += u32Pages * PAGE_SIZE;
+    return (int)(u32Pages * PAGE_SIZE);
+
+lerr:
+    sStats.m_u32Errors++;
+    Resync();
+    return -1;
+}
@@ -0,0 +1,134 @@
+/**************************************************************************//**
+ * @file     HidTransfer.hpp
+ * @brief    Host side of the USBD_HID_Transfer command protocol
+ *
+ * @note     ReadPages/WritePages/EraseSectors/SendTestCmd are the commands of the Windows
+ *           HIDTransferTest tool. StreamReadPages/StreamWritePages use the queued stream commands,
+ *           sent with their status on the control pipe, with a CRC-32 check of every request. Every call is timed into the CXferStats of its
+ *           kind: bytes, busy time, one latency sample per request and errors.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef INC__HID_TRANSFER_HPP__
+#define INC__HID_TRANSFER_HPP__
+
+#include <stdint.h>
+#include <vector>
+#include "HidTransport.hpp"
+
+#define USB_VID             0x0416  /* Vendor ID */
+#define USB_PID             0x5020  /* Product ID */
+
+#define HID_CMD_SIGNATURE   0x43444948
+
+/* HID Transfer Commands */
+#define HID_CMD_NONE            0x00
+#define HID_CMD_ERASE           0x71
+#define HID_CMD_READ            0xD2
+#define HID_CMD_WRITE           0xC3
+#define HID_CMD_TEST            0xB4
+#define HID_CMD_STREAM_READ     0xD5
+#define HID_CMD_STREAM_WRITE    0xC5
+
+#define PAGE_SIZE           2048
+#define SECTOR_SIZE         4096
+#define STREAM_QUEUE_LEN    4       /* Stream commands the device queues */
+#define STREAM_WRITE_LAG    2       /* Stream writes sent before the status of the first is taken */
+
+#define STREAM_STATUS_OK    0
+#define STREAM_STATUS_RANGE 1
+
+#define USB_TIME_OUT        100     /* ms for a report */
+#define USB_PROG_TIME_OUT   1000    /* ms for the status of a request, which waits for storage */
+
+#pragma pack(push, 1)
+
+typedef struct
+{
+    uint8_t  cmd;
+    uint8_t  len;
+    uint32_t arg1;
+    uint32_t arg2;
+    uint32_t signature;
+    uint32_t checksum;
+} CMD_T;
+
+typedef struct
+{
+    uint32_t signature;
+    uint8_t  cmd;
+    uint8_t  status;
+    uint16_t reserved;
+    uint32_t arg1;
+    uint32_t arg2;
+    uint32_t crc;
+} STREAM_STATUS_T;
+
+#pragma pack(pop)
+
+class CXferStats
+{
+public:
+    uint64_t m_u64Bytes;
+    uint64_t m_u64BusyUs;
+    uint32_t m_u32Errors;
+    std::vector<uint32_t> m_au32LatencyUs;
+
+    CXferStats()
+    {
+        Reset();
+    }
+
+    void Reset();
+    double KBps() const;
+    /* Latency in microseconds that u32Percent of the requests did not exceed */
+    uint32_t Percentile(uint32_t u32Percent) const;
+    void Print(const char *pcName) const;
+};
+
+enum
+{
+    XFER_READ,
+    XFER_WRITE,
+    XFER_STREAM_READ,
+    XFER_STREAM_WRITE,
+    XFER_KINDS
+};
+
+class CHidTransfer
+{
+protected:
+    CHidTransport *m_pTransport;
+    CXferStats m_asStats[XFER_KINDS];
+
+    bool SendCmd(uint8_t u8Cmd, uint32_t u32Arg1, uint32_t u32Arg2);
+    bool GetStatus(STREAM_STATUS_T *psStatus, uint32_t u32Ms);
+    bool ReadStatus(uint8_t u8Cmd, uint32_t u32Arg1, uint32_t u32Pages, uint32_t u32Crc, uint32_t u32Ms);
+    void Resync();
+
+public:
+    explicit CHidTransfer(CHidTransport *pTransport)
+        : m_pTransport(pTransport)
+    {
+    }
+
+    static uint32_t CalCheckSum(const uint8_t *pu8Buf, uint32_t u32Size);
+    static uint32_t Crc32(uint32_t u32Crc, const uint8_t *pu8Buf, uint32_t u32Size);
+
+    int EraseSectors(uint32_t u32StartSector, uint32_t u32Sectors);
+    int ReadPages(uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages);
+    int WritePages(const uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages);
+    int SendTestCmd();
+
+    /* u32ReqPages pages per stream command. Reads keep up to u32Depth commands outstanding. */
+    int StreamReadPages(uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages, uint32_t u32ReqPages, uint32_t u32Depth);
+    int StreamWritePages(const uint8_t *pu8Buf, uint32_t u32StartPage, uint32_t u32Pages, uint32_t u32ReqPages);
+
+    CXferStats &Stats(uint32_t u32Kind)
+    {
+        return m_asStats[u32Kind];
+    }
+};
+
+#endif
@@ -0,0 +1,63 @@
+/**************************************************************************//**
+ * @file     HidTransport.hpp
+ * @brief    Report transports of the HID transfer host tool
+ *
+ * @note     A transport moves 64-byte reports to interrupt OUT and from interrupt IN of the
+ *           USBD_HID_Transfer sample. Interrupt IN is kept polled, so IN reports are buffered
+ *           while the caller is busy. WriteReport() returns once the report is queued, with up to
+ *           the depth given to OpenDevice() in flight. The 64-byte feature report goes on the control
+ *           pipe with SET_REPORT and GET_REPORT, while the interrupt reports keep moving.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef INC__HID_TRANSPORT_HPP__
+#define INC__HID_TRANSPORT_HPP__
+
+#include <stdint.h>
+
+#define HID_REPORT_SIZE     64      /* Interrupt IN and OUT report size of the device */
+#define HID_INT_IN_EP       0x81
+#define HID_INT_OUT_EP      0x02
+
+class CHidTransport
+{
+public:
+    virtual ~CHidTransport()
+    {
+    }
+
+    /* Open the first device with the VID and PID, keeping up to u32Depth writes in flight */
+    virtual bool OpenDevice(uint16_t u16Vid, uint16_t u16Pid, uint32_t u32Depth) = 0;
+    virtual void CloseDevice() = 0;
+
+    /* Queue one report for interrupt OUT, waiting up to u32Ms while the depth is reached */
+    virtual bool WriteReport(const uint8_t *pu8Report, uint32_t u32Ms) = 0;
+
+    /* Wait up to u32Ms for the queued reports to be sent */
+    virtual bool Flush(uint32_t u32Ms) = 0;
+
+    /* Take the next interrupt IN report, waiting up to u32Ms */
+    virtual bool ReadReport(uint8_t *pu8Report, uint32_t u32Ms) = 0;
+
+    /* SET_REPORT of the feature report, false if the device stalls it */
+    virtual bool SetFeature(const uint8_t *pu8Report, uint32_t u32Ms) = 0;
+
+    /* GET_REPORT of the feature report */
+    virtual bool GetFeature(uint8_t *pu8Report, uint32_t u32Ms) = 0;
+
+    /* Time in microseconds on the clock of the transfers */
+    virtual uint64_t NowUs() = 0;
+
+    virtual const char *Name() const = 0;
+};
+
+/* pcPath is a /dev/hidrawN node, or NULL to search all of them for the VID and PID */
+CHidTransport *CreateHidrawTransport(const char *pcPath);
+#ifdef HID_WITH_LIBUSB
+CHidTransport *CreateLibusbTransport(void);
+#endif
+/* The USBD_HID_Transfer firmware running on the host simulator, timed in 1 ms USB frames */
+CHidTransport *CreateSimTransport(bool bVerbose);
+
+#endif
@@ -0,0 +1,181 @@
+/**************************************************************************//**
+ * @file     HidrawTransport.cpp
+ * @brief    Linux hidraw transport of the HID transfer host tool
+ *
+ * @note     The usbhid driver keeps interrupt IN polled and queues the reports for read(), so
+ *           IN needs no requests of its own. A write() returns once its report is sent, so
+ *           one OUT report is in flight whatever the depth. Use the libusb transport for more.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/hidraw.h>
+#include <chrono>
+#include <string>
+#include "HidTransport.hpp"
+
+#define HIDRAW_MAX_NODES    64
+
+class CHidrawTransport : public CHidTransport
+{
+protected:
+    int m_iFd;
+    std::string m_sPath;
+
+    /* Open pcPath if it is the device, -1 otherwise */
+    static int OpenNode(const char *pcPath, uint16_t u16Vid, uint16_t u16Pid)
+    {
+        struct hidraw_devinfo sInfo;
+        int iFd;
+
+        iFd = open(pcPath, O_RDWR | O_CLOEXEC);
+        if(iFd < 0)
+            return -1;
+
+        if((ioctl(iFd, HIDIOCGRAWINFO, &sInfo) < 0) ||
+                ((uint16_t)sInfo.vendor != u16Vid) || ((uint16_t)sInfo.product != u16Pid))
+        {
+            close(iFd);
+            return -1;
+        }
+
+        return iFd;
+    }
+
+    /* Wait up to u32Ms for the node to be ready for events */
+    bool Wait(short sEvents, uint32_t u32Ms)
+    {
+        struct pollfd sPoll;
+        int iRet;
+
+        sPoll.fd = m_iFd;
+        sPoll.events = sEvents;
+        do
+        {
+            iRet = poll(&sPoll, 1, (int)u32Ms);
+        }
+        while((iRet < 0) && (errno == EINTR));
+
+        return (iRet > 0) && (sPoll.revents & sEvents);
+    }
+
+public:
+    explicit CHidrawTransport(const char *pcPath)
+        : m_iFd(-1)
+        , m_sPath(pcPath ? pcPath : "")
+    {
+    }
+
+    virtual ~CHidrawTransport()
+    {
+        CloseDevice();
+    }
+
+    virtual bool OpenDevice(uint16_t u16Vid, uint16_t u16Pid, uint32_t u32Depth)
+    {
+        char acPath[32];
+        int i;
+
+        (void)u32Depth;
+        CloseDevice();
+
+        if(!m_sPath.empty())
+        {
+            m_iFd = OpenNode(m_sPath.c_str(), u16Vid, u16Pid);
+            return m_iFd >= 0;
+        }
+
+        for(i = 0; (i < HIDRAW_MAX_NODES) && (m_iFd < 0); i++)
+        {
+            snprintf(acPath, sizeof(acPath), "/dev/hidraw%d", i);
+            m_iFd = OpenNode(acPath, u16Vid, u16Pid);
+        }
+
+        return m_iFd >= 0;
+    }
+
+    virtual void CloseDevice()
+    {
+        if(m_iFd >= 0)
+        {
+            close(m_iFd);
+            m_iFd = -1;
+        }
+    }
+
+    virtual bool WriteReport(const uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        uint8_t au8Buf[HID_REPORT_SIZE + 1];
+
+        /* The device has no report IDs: report number 0, then the report */
+        au8Buf[0] = 0x00;
+        memcpy(&au8Buf[1], pu8Report, HID_REPORT_SIZE);
+
+        if(!Wait(POLLOUT, u32Ms))
+            return false;
+
+        return write(m_iFd, au8Buf, sizeof(au8Buf)) == (ssize_t)sizeof(au8Buf);
+    }
+
+    virtual bool Flush(uint32_t u32Ms)
+    {
+        (void)u32Ms;
+        return m_iFd >= 0;
+    }
+
+    virtual bool ReadReport(uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        if(!Wait(POLLIN, u32Ms))
+            return false;
+
+        return read(m_iFd, pu8Report, HID_REPORT_SIZE) == HID_REPORT_SIZE;
+    }
+
+    virtual bool SetFeature(const uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        uint8_t au8Buf[HID_REPORT_SIZE + 1];
+
+        (void)u32Ms;
+        au8Buf[0] = 0x00;
+        memcpy(&au8Buf[1], pu8Report, HID_REPORT_SIZE);
+
+        return ioctl(m_iFd, HIDIOCSFEATURE(sizeof(au8Buf)), au8Buf) == (int)sizeof(au8Buf);
+    }
+
+    virtual bool GetFeature(uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        uint8_t au8Buf[HID_REPORT_SIZE + 1];
+
+        (void)u32Ms;
+        au8Buf[0] = 0x00;
+        if(ioctl(m_iFd, HIDIOCGFEATURE(sizeof(au8Buf)), au8Buf) != (int)sizeof(au8Buf))
+            return false;
+
+        /* Report number 0 comes first */
+        memcpy(pu8Report, &au8Buf[1], HID_REPORT_SIZE);
+        return true;
+    }
+
+    virtual uint64_t NowUs()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    virtual const char *Name() const
+    {
+        return "hidraw";
+    }
+};
+
+CHidTransport *CreateHidrawTransport(const char *pcPath)
+{
+    return new CHidrawTransport(pcPath);
+}
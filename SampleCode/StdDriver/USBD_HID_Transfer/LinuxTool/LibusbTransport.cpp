@@ -0,0 +1,292 @@
+/**************************************************************************//**
+ * @file     LibusbTransport.cpp
+ * @brief    libusb transport of the HID transfer host tool
+ *
+ * @note     Built with LIBUSB=1. The interface is detached from usbhid and driven with
+ *           asynchronous interrupt transfers. Depth IN transfers stay submitted and are resubmitted
+ *           as they complete. Up to depth OUT transfers are in flight, so the host controller has a
+ *           report for every frame on both endpoints.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <libusb.h>
+#include "HidTransport.hpp"
+
+#define HID_REQ_SET         0x21    /* Class request to the interface, host to device */
+#define HID_REQ_GET         0xA1    /* Class request to the interface, device to host */
+#define HID_GET_REPORT      0x01
+#define HID_SET_REPORT      0x09
+#define HID_FEATURE_REPORT  0x0300  /* wValue: feature report, no report ID */
+
+typedef std::array<uint8_t, HID_REPORT_SIZE> REPORT_T;
+
+class CLibusbTransport : public CHidTransport
+{
+protected:
+    libusb_context *m_psCtx;
+    libusb_device_handle *m_psDev;
+    std::vector<libusb_transfer *> m_apsIn;
+    std::vector<libusb_transfer *> m_apsOut;
+    std::vector<libusb_transfer *> m_apsOutFree;
+    std::vector<uint8_t> m_au8Buf;
+    std::deque<REPORT_T> m_sIn;
+    uint32_t m_u32InBusy;
+    bool m_bClosing;
+    bool m_bOutError;               /* An OUT transfer failed since the last WriteReport() or Flush() */
+
+    static void LIBUSB_CALL InDone(libusb_transfer *psXfer)
+    {
+        CLibusbTransport *pThis = (CLibusbTransport *)psXfer->user_data;
+        REPORT_T sIn;
+
+        /* A failed report is dropped, the protocol notices the gap */
+        if((psXfer->status == LIBUSB_TRANSFER_COMPLETED) && (psXfer->actual_length == HID_REPORT_SIZE))
+        {
+            memcpy(sIn.data(), psXfer->buffer, HID_REPORT_SIZE);
+            pThis->m_sIn.push_back(sIn);
+        }
+
+        /* Keep interrupt IN polled */
+        if(pThis->m_bClosing || (psXfer->status == LIBUSB_TRANSFER_NO_DEVICE) || (libusb_submit_transfer(psXfer) != 0))
+            pThis->m_u32InBusy--;
+    }
+
+    static void LIBUSB_CALL OutDone(libusb_transfer *psXfer)
+    {
+        CLibusbTransport *pThis = (CLibusbTransport *)psXfer->user_data;
+
+        if((psXfer->status != LIBUSB_TRANSFER_COMPLETED) && (psXfer->status != LIBUSB_TRANSFER_CANCELLED))
+            pThis->m_bOutError = true;
+        pThis->m_apsOutFree.push_back(psXfer);
+    }
+
+    /* Run completions until sEnd, false once it has passed */
+    bool HandleEvents(const std::chrono::steady_clock::time_point &sEnd)
+    {
+        std::chrono::steady_clock::time_point sNow = std::chrono::steady_clock::now();
+        struct timeval sTv;
+        int64_t i64Us;
+
+        if(sNow >= sEnd)
+            return false;
+
+        i64Us = std::chrono::duration_cast<std::chrono::microseconds>(sEnd - sNow).count();
+        sTv.tv_sec = (time_t)(i64Us / 1000000);
+        sTv.tv_usec = (suseconds_t)(i64Us % 1000000);
+        return libusb_handle_events_timeout_completed(m_psCtx, &sTv, NULL) == 0;
+    }
+
+    /* True if no OUT transfer failed since the last call */
+    bool TakeOutError()
+    {
+        bool bOk = !m_bOutError;
+
+        m_bOutError = false;
+        return bOk;
+    }
+
+    static std::chrono::steady_clock::time_point Deadline(uint32_t u32Ms)
+    {
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(u32Ms);
+    }
+
+public:
+    CLibusbTransport()
+        : m_psCtx(NULL)
+        , m_psDev(NULL)
+        , m_u32InBusy(0)
+        , m_bClosing(false)
+        , m_bOutError(false)
+    {
+    }
+
+    virtual ~CLibusbTransport()
+    {
+        CloseDevice();
+    }
+
+    virtual bool OpenDevice(uint16_t u16Vid, uint16_t u16Pid, uint32_t u32Depth)
+    {
+        libusb_transfer *psXfer;
+        uint32_t i;
+
+        CloseDevice();
+        if(u32Depth == 0)
+            u32Depth = 1;
+
+        if(libusb_init(&m_psCtx) != 0)
+        {
+            m_psCtx = NULL;
+            return false;
+        }
+
+        m_psDev = libusb_open_device_with_vid_pid(m_psCtx, u16Vid, u16Pid);
+        if(m_psDev == NULL)
+        {
+            CloseDevice();
+            return false;
+        }
+
+        libusb_set_auto_detach_kernel_driver(m_psDev, 1);
+        if(libusb_claim_interface(m_psDev, 0) != 0)
+        {
+            libusb_close(m_psDev);
+            m_psDev = NULL;
+            CloseDevice();
+            return false;
+        }
+
+        m_bClosing = false;
+        m_bOutError = false;
+        m_sIn.clear();
+        m_au8Buf.assign(2 * u32Depth * HID_REPORT_SIZE, 0);
+        for(i = 0; i < u32Depth; i++)
+        {
+            psXfer = libusb_alloc_transfer(0);
+            libusb_fill_interrupt_transfer(psXfer, m_psDev, HID_INT_IN_EP, &m_au8Buf[i * HID_REPORT_SIZE],
+                                           HID_REPORT_SIZE, InDone, this, 0);
+            m_apsIn.push_back(psXfer);
+            if(libusb_submit_transfer(psXfer) == 0)
+                m_u32InBusy++;
+
+            psXfer = libusb_alloc_transfer(0);
+            libusb_fill_interrupt_transfer(psXfer, m_psDev, HID_INT_OUT_EP, &m_au8Buf[(u32Depth + i) * HID_REPORT_SIZE],
+                                           HID_REPORT_SIZE, OutDone, this, 0);
+            m_apsOut.push_back(psXfer);
+            m_apsOutFree.push_back(psXfer);
+        }
+
+        if(m_u32InBusy != u32Depth)
+        {
+            CloseDevice();
+            return false;
+        }
+
+        return true;
+    }
+
+    virtual void CloseDevice()
+    {
+        std::chrono::steady_clock::time_point sEnd = Deadline(1000);
+        size_t i;
+
+        if(m_psDev != NULL)
+        {
+            /* Cancel whatever is in flight and wait for the callbacks */
+            m_bClosing = true;
+            for(i = 0; i < m_apsIn.size(); i++)
+                libusb_cancel_transfer(m_apsIn[i]);
+            for(i = 0; i < m_apsOut.size(); i++)
+                libusb_cancel_transfer(m_apsOut[i]);
+            while(((m_u32InBusy > 0) || (m_apsOutFree.size() < m_apsOut.size())) && HandleEvents(sEnd));
+
+            libusb_release_interface(m_psDev, 0);
+            libusb_close(m_psDev);
+            m_psDev = NULL;
+        }
+
+        for(i = 0; i < m_apsIn.size(); i++)
+            libusb_free_transfer(m_apsIn[i]);
+        for(i = 0; i < m_apsOut.size(); i++)
+            libusb_free_transfer(m_apsOut[i]);
+        m_apsIn.clear();
+        m_apsOut.clear();
+        m_apsOutFree.clear();
+        m_u32InBusy = 0;
+
+        if(m_psCtx != NULL)
+        {
+            libusb_exit(m_psCtx);
+            m_psCtx = NULL;
+        }
+    }
+
+    virtual bool WriteReport(const uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        std::chrono::steady_clock::time_point sEnd = Deadline(u32Ms);
+        libusb_transfer *psXfer;
+
+        while(m_apsOutFree.empty())
+        {
+            if(!HandleEvents(sEnd))
+                return false;
+        }
+
+        psXfer = m_apsOutFree.back();
+        m_apsOutFree.pop_back();
+        memcpy(psXfer->buffer, pu8Report, HID_REPORT_SIZE);
+        if(libusb_submit_transfer(psXfer) != 0)
+        {
+            m_apsOutFree.push_back(psXfer);
+            return false;
+        }
+
+        return TakeOutError();
+    }
+
+    virtual bool Flush(uint32_t u32Ms)
+    {
+        std::chrono::steady_clock::time_point sEnd = Deadline(u32Ms);
+
+        while(m_apsOutFree.size() < m_apsOut.size())
+        {
+            if(!HandleEvents(sEnd))
+                return false;
+        }
+
+        return TakeOutError();
+    }
+
+    virtual bool ReadReport(uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        std::chrono::steady_clock::time_point sEnd = Deadline(u32Ms);
+
+        while(m_sIn.empty())
+        {
+            if((m_u32InBusy == 0) || !HandleEvents(sEnd))
+                return false;
+        }
+
+        memcpy(pu8Report, m_sIn.front().data(), HID_REPORT_SIZE);
+        m_sIn.pop_front();
+        return true;
+    }
+
+    /* The synchronous control transfer runs the event loop, so the interrupt transfers keep going */
+    virtual bool SetFeature(const uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        uint8_t au8Buf[HID_REPORT_SIZE];
+
+        memcpy(au8Buf, pu8Report, HID_REPORT_SIZE);
+        return libusb_control_transfer(m_psDev, HID_REQ_SET, HID_SET_REPORT, HID_FEATURE_REPORT, 0, au8Buf,
+                                       HID_REPORT_SIZE, u32Ms) == HID_REPORT_SIZE;
+    }
+
+    virtual bool GetFeature(uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        return libusb_control_transfer(m_psDev, HID_REQ_GET, HID_GET_REPORT, HID_FEATURE_REPORT, 0, pu8Report,
+                                       HID_REPORT_SIZE, u32Ms) == HID_REPORT_SIZE;
+    }
+
+    virtual uint64_t NowUs()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    virtual const char *Name() const
+    {
+        return "libusb";
+    }
+};
+
+CHidTransport *CreateLibusbTransport(void)
+{
+    return new CLibusbTransport();
+}
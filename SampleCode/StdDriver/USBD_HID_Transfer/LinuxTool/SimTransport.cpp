@@ -0,0 +1,168 @@
+/**************************************************************************//**
+ * @file     SimTransport.cpp
+ * @brief    Loopback transport to the USBD_HID_Transfer firmware on the host simulator
+ *
+ * @note     Time is counted in 1 ms USB frames, so throughput and latency are those of a full
+ *           speed bus with bInterval 1, independent of the speed of the machine running it.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <string.h>
+#include <array>
+#include <deque>
+#include "HidTransport.hpp"
+#include "sim_device.h"
+
+typedef std::array<uint8_t, HID_REPORT_SIZE> REPORT_T;
+
+class CSimTransport : public CHidTransport
+{
+protected:
+    std::deque<REPORT_T> m_sOut;
+    std::deque<REPORT_T> m_sIn;
+    uint64_t m_u64Frame;
+    uint32_t m_u32Ctrl;
+    uint32_t m_u32Depth;
+    bool m_bVerbose;
+    bool m_bOpen;
+
+    void Frame()
+    {
+        REPORT_T sIn;
+        uint32_t u32Ret;
+
+        u32Ret = SimDev_Frame(m_sOut.empty() ? NULL : m_sOut.front().data(), sIn.data());
+        if(u32Ret & SIMDEV_OUT_DONE)
+            m_sOut.pop_front();
+        if(u32Ret & SIMDEV_IN_DONE)
+            m_sIn.push_back(sIn);
+        m_u64Frame++;
+        m_u32Ctrl = 0;
+    }
+
+    /* Control transfers share the frame with the interrupt reports. Only a frame whose control
+       bandwidth is used up moves the next one to the following frame. */
+    void CtrlSlot()
+    {
+        if(m_u32Ctrl >= SIMDEV_CTRL_PER_FRAME)
+            Frame();
+        m_u32Ctrl++;
+    }
+
+public:
+    explicit CSimTransport(bool bVerbose)
+        : m_u64Frame(0)
+        , m_u32Ctrl(0)
+        , m_u32Depth(1)
+        , m_bVerbose(bVerbose)
+        , m_bOpen(false)
+    {
+    }
+
+    virtual ~CSimTransport()
+    {
+        CloseDevice();
+    }
+
+    virtual bool OpenDevice(uint16_t u16Vid, uint16_t u16Pid, uint32_t u32Depth)
+    {
+        uint16_t u16DevVid, u16DevPid;
+
+        if(SimDev_Open(&u16DevVid, &u16DevPid, m_bVerbose) != 0)
+            return false;
+        if((u16DevVid != u16Vid) || (u16DevPid != u16Pid))
+        {
+            SimDev_Close();
+            return false;
+        }
+
+        m_u32Depth = u32Depth ? u32Depth : 1;
+        m_u32Ctrl = 0;
+        m_sOut.clear();
+        m_sIn.clear();
+        m_bOpen = true;
+        return true;
+    }
+
+    virtual void CloseDevice()
+    {
+        if(m_bOpen)
+        {
+            SimDev_Close();
+            m_bOpen = false;
+        }
+    }
+
+    virtual bool WriteReport(const uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        REPORT_T sOut;
+
+        while(m_sOut.size() >= m_u32Depth)
+        {
+            if(u32Ms-- == 0)
+                return false;
+            Frame();
+        }
+        memcpy(sOut.data(), pu8Report, HID_REPORT_SIZE);
+        m_sOut.push_back(sOut);
+        return true;
+    }
+
+    virtual bool Flush(uint32_t u32Ms)
+    {
+        while(!m_sOut.empty())
+        {
+            if(u32Ms-- == 0)
+                return false;
+            Frame();
+        }
+        return true;
+    }
+
+    virtual bool ReadReport(uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        while(m_sIn.empty())
+        {
+            if(u32Ms-- == 0)
+                return false;
+            Frame();
+        }
+        memcpy(pu8Report, m_sIn.front().data(), HID_REPORT_SIZE);
+        m_sIn.pop_front();
+        return true;
+    }
+
+    /* The control transfer takes part of a frame that also carries the interrupt reports */
+    virtual bool SetFeature(const uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        REPORT_T sOut;
+
+        (void)u32Ms;
+        memcpy(sOut.data(), pu8Report, HID_REPORT_SIZE);
+        CtrlSlot();
+        return SimDev_Feature(1, sOut.data()) == 0;
+    }
+
+    virtual bool GetFeature(uint8_t *pu8Report, uint32_t u32Ms)
+    {
+        (void)u32Ms;
+        CtrlSlot();
+        return SimDev_Feature(0, pu8Report) == 0;
+    }
+
+    virtual uint64_t NowUs()
+    {
+        return m_u64Frame * 1000;
+    }
+
+    virtual const char *Name() const
+    {
+        return "sim";
+    }
+};
+
+CHidTransport *CreateSimTransport(bool bVerbose)
+{
+    return new CSimTransport(bVerbose);
+}
@@ -0,0 +1,167 @@
+/**************************************************************************//**
+ * @file     sim_device.c
+ * @brief    USBD_HID_Transfer firmware on the host simulator
+ *
+ * @note     Runs hid_transfer.c and descriptors.c of the sample on HostSim for the loopback
+ *           transport. The firmware is built with printf mapped to SimDev_Printf(), which drops
+ *           its console output unless verbose.
+ *           SimDev_Frame() is one 1 ms USB frame: the firmware main loop runs once, then the host
+ *           controller does at most one interrupt OUT and one interrupt IN transaction, which is
+ *           what bInterval 1 gives a full speed device. SimDev_Feature() is a control transfer the
+ *           host controller fits in the rest of the frame, up to SIMDEV_CTRL_PER_FRAME of them.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include "NUC029xGE.h"
+#include "hid_transfer.h"
+#include "hostsim.h"
+#include "sim_device.h"
+
+static uint32_t s_u32Verbose = 0;
+static uint32_t s_u32Inited = 0;
+
+/* Console of the firmware */
+int SimDev_Printf(const char *pcFmt, ...)
+{
+    va_list args;
+    int i32Ret = 0;
+
+    if(s_u32Verbose)
+    {
+        va_start(args, pcFmt);
+        i32Ret = vprintf(pcFmt, args);
+        va_end(args);
+    }
+
+    return i32Ret;
+}
+
+/* Control read on EP0, the way the host enumerates. Returns the length or -1. */
+static int32_t SimDev_CtrlRead(const uint8_t *pu8Setup, uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t u32Done = 0;
+    int32_t i32Ret;
+
+    SIM_USBD_Setup(pu8Setup);
+    while(u32Done < u32Len)
+    {
+        i32Ret = SIM_USBD_In(0, &pu8Buf[u32Done], EP0_MAX_PKT_SIZE);
+        if(i32Ret < 0)
+            return -1;
+        u32Done += (uint32_t)i32Ret;
+        if(i32Ret < EP0_MAX_PKT_SIZE)
+            break;
+    }
+
+    return (SIM_USBD_Out(0, pu8Buf, 0) == 0) ? (int32_t)u32Done : -1;
+}
+
+/**
+  * @brief      Attach the simulated device and enumerate it
+  * @param[out] pu16Vid     Vendor ID from the device descriptor
+  * @param[out] pu16Pid     Product ID from the device descriptor
+  * @param[in]  u32Verbose  1 to print the firmware console
+  * @retval     0 Success
+  * @retval     -1 The device did not enumerate
+  */
+int32_t SimDev_Open(uint16_t *pu16Vid, uint16_t *pu16Pid, uint32_t u32Verbose)
+{
+    const uint8_t au8GetDev[8] = {0x80, GET_DESCRIPTOR, 0, DESC_DEVICE, 0, 0, LEN_DEVICE, 0};
+    const uint8_t au8SetConfig[8] = {0x00, SET_CONFIGURATION, 1, 0, 0, 0, 0, 0};
+    uint8_t au8Desc[LEN_DEVICE];
+
+    s_u32Verbose = u32Verbose;
+    if(!s_u32Inited)
+    {
+        SIM_Init();
+        s_u32Inited = 1;
+    }
+
+    SYS_UnlockReg();
+    CLK_EnableModuleClock(USBD_MODULE);
+    CLK_EnableModuleClock(CRC_MODULE);
+    CLK_EnableModuleClock(PDMA_MODULE);
+    SYS_LockReg();
+
+    USBD_Open(&gsInfo, HID_ClassRequest, NULL);
+    HID_Init();
+    USBD_Start();
+    NVIC_EnableIRQ(USBD_IRQn);
+
+    SIM_USBD_Attach();
+    SIM_USBD_BusReset();
+
+    if(SimDev_CtrlRead(au8GetDev, au8Desc, LEN_DEVICE) != LEN_DEVICE)
+        return -1;
+    *pu16Vid = (uint16_t)(au8Desc[8] | (au8Desc[9] << 8));
+    *pu16Pid = (uint16_t)(au8Desc[10] | (au8Desc[11] << 8));
+
+    /* No data stage, IN status stage */
+    SIM_USBD_Setup(au8SetConfig);
+    if(SIM_USBD_In(0, au8Desc, EP0_MAX_PKT_SIZE) != 0)
+        return -1;
+
+    return 0;
+}
+
+/**
+  * @brief      Detach the simulated device
+  * @param      None
+  * @return     None
+  */
+void SimDev_Close(void)
+{
+    NVIC_DisableIRQ(USBD_IRQn);
+    SIM_USBD_Detach();
+    USBD_SET_SE0();
+}
+
+/**
+  * @brief      Run one 1 ms frame
+  * @param[in]  pu8Out      Report to send on interrupt OUT, NULL for none
+  * @param[out] pu8In       Report received on interrupt IN
+  * @return     SIMDEV_OUT_DONE and SIMDEV_IN_DONE bits
+  */
+uint32_t SimDev_Frame(const uint8_t *pu8Out, uint8_t *pu8In)
+{
+    uint32_t u32Ret = 0;
+
+    /* Main loop of the firmware */
+    HID_StreamProcess();
+
+    if((pu8Out != NULL) && (SIM_USBD_Out(INT_OUT_EP_NUM, pu8Out, EP3_MAX_PKT_SIZE) == EP3_MAX_PKT_SIZE))
+        u32Ret |= SIMDEV_OUT_DONE;
+    if(SIM_USBD_In(INT_IN_EP_NUM, pu8In, EP2_MAX_PKT_SIZE) == EP2_MAX_PKT_SIZE)
+        u32Ret |= SIMDEV_IN_DONE;
+
+    SIM_AdvanceCycles(SystemCoreClock / 1000);
+
+    return u32Ret;
+}
+
+/**
+  * @brief      Run SET_REPORT or GET_REPORT of the 64-byte feature report on the control pipe
+  * @param[in]  u32Set      1 for SET_REPORT, 0 for GET_REPORT
+  * @param[in,out] pu8Report Report to send, or the report received
+  * @retval     0 Success
+  * @retval     -1 The device stalled the request
+  */
+int32_t SimDev_Feature(uint32_t u32Set, uint8_t *pu8Report)
+{
+    const uint8_t au8SetReport[8] = {0x21, SET_REPORT, 0, 3, 0, 0, EP0_MAX_PKT_SIZE, 0};
+    const uint8_t au8GetReport[8] = {0xA1, GET_REPORT, 0, 3, 0, 0, EP0_MAX_PKT_SIZE, 0};
+    uint8_t au8Zlp[EP0_MAX_PKT_SIZE];
+
+    if(!u32Set)
+        return (SimDev_CtrlRead(au8GetReport, pu8Report, EP0_MAX_PKT_SIZE) == EP0_MAX_PKT_SIZE) ? 0 : -1;
+
+    /* OUT data stage, IN status stage */
+    SIM_USBD_Setup(au8SetReport);
+    if(SIM_USBD_Out(0, pu8Report, EP0_MAX_PKT_SIZE) != EP0_MAX_PKT_SIZE)
+        return -1;
+
+    return (SIM_USBD_In(0, au8Zlp, EP0_MAX_PKT_SIZE) == 0) ? 0 : -1;
+}
@@ -0,0 +1,32 @@
+/**************************************************************************//**
+ * @file     sim_device.h
+ * @brief    USBD_HID_Transfer firmware on the host simulator
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
+ *****************************************************************************/
+#ifndef __SIM_DEVICE_H__
+#define __SIM_DEVICE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SIMDEV_OUT_DONE     0x1     /*!< The OUT report was accepted */
+#define SIMDEV_IN_DONE      0x2     /*!< An IN report was received */
+
+#define SIMDEV_CTRL_PER_FRAME   8   /*!< Control transfers of a 64-byte report fitting in one frame next to the interrupt transactions */
+
+int32_t SimDev_Open(uint16_t *pu16Vid, uint16_t *pu16Pid, uint32_t u32Verbose);
+void SimDev_Close(void);
+uint32_t SimDev_Frame(const uint8_t *pu8Out, uint8_t *pu8In);
+int32_t SimDev_Feature(uint32_t u32Set, uint8_t *pu8Report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __SIM_DEVICE_H__ */
@@ -30,6 +30,10 @@ const uint8_t HID_DeviceReportDescriptor[] =
     0x91, 0x00,         // Output (Data, Array, Abs): Instantiates output packet fields. Uses same
     // report size and count as "Input" fields, since nothing new/different was
     // specified to the parser since the "Input" item.
+    0x19, 0x01,         // Usage Minimum
+    0x29, 0x40,         // Usage Maximum //64 feature usages total (0x01 to 0x40)
+    0xB1, 0x00,         // Feature (Data, Array, Abs): Instantiates the feature report that carries the
+    // stream commands (SET_REPORT) and their status (GET_REPORT) on the control pipe.
     0xC0                // End Collection
 };
 
@@ -16,155 +16,68 @@
 uint8_t volatile g_u8EP2Ready = 0;
 uint8_t volatile g_u8Suspend = 0;
 uint8_t g_u8Idle = 0, g_u8Protocol = 0;
+static uint8_t volatile s_u8OutArmed = 0;   /* Interrupt OUT is waiting for a report */
+static uint8_t s_au8Feature[EP0_MAX_PKT_SIZE];  /* Feature report of SET_REPORT and GET_REPORT */
+static uint8_t volatile s_u8FeatureOut = 0;     /* Control OUT is the data stage of SET_REPORT */
 
-void USBD_IRQHandler(void)
-{
-    uint32_t u32IntSts = USBD_GET_INT_FLAG();
-    uint32_t u32State = USBD_GET_BUS_STATE();
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_FLDET)
-    {
-        // Floating detect
-        USBD_CLR_INT_FLAG(USBD_INTSTS_FLDET);
+static void HID_StreamArmOut(void);
+static int32_t HID_SetFeatureReport(uint8_t *pu8Report);
+static void HID_GetFeatureReport(uint8_t *pu8Report);
 
-        if(USBD_IS_ATTACHED())
-        {
-            /* USB Plug In */
-            USBD_ENABLE_USB();
-        }
-        else
-        {
-            /* USB Un-plug */
-            USBD_DISABLE_USB();
-        }
-    }
+static void HID_BusEvent(uint32_t u32State)
+{
+    /* Bus reset and resume wake the main loop, suspend sends it to power down */
+    if(u32State & (USBD_STATE_USBRST | USBD_STATE_RESUME))
+        g_u8Suspend = 0;
+    if(u32State & USBD_STATE_SUSPEND)
+        g_u8Suspend = 1;
+}
 
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_WAKEUP)
-    {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_WAKEUP);
-    }
+/* Executes in SRAM, see RAMFUNC in system_NUC029xGE.h */
+RAMFUNC void USBD_IRQHandler(void)
+{
+    TRACE_BEGIN(TRACE_ID_USBD_IRQ, USBD_GET_INT_FLAG());
 
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_BUS)
-    {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_BUS);
+    USBD_EventIRQHandler();
 
-        if(u32State & USBD_STATE_USBRST)
-        {
-            /* Bus reset */
-            USBD_ENABLE_USB();
-            USBD_SwReset();
-            g_u8Suspend = 0;
-        }
-        if(u32State & USBD_STATE_SUSPEND)
-        {
-            /* Enter power down to wait USB attached */
-            g_u8Suspend = 1;
+    TRACE_END(TRACE_ID_USBD_IRQ, 0);
+}
 
-            /* Enable USB but disable PHY */
-            USBD_DISABLE_PHY();
-        }
-        if(u32State & USBD_STATE_RESUME)
-        {
-            /* Enable USB and enable PHY */
-            USBD_ENABLE_USB();
-            g_u8Suspend = 0;
-        }
-    }
+void EP1_Handler(uint32_t u32HwEp)  /* Control OUT handler */
+{
+    USBD_CtrlOut();
 
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_USB)
+    /* SET_REPORT of the feature report: the status stage answers the command */
+    if(s_u8FeatureOut)
     {
-        // USB event
-        if(u32IntSts & USBD_INTSTS_SETUP)
-        {
-            // Setup packet
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_SETUP);
-
-            /* Clear the data IN/OUT ready flag of control end-points */
-            USBD_STOP_TRANSACTION(EP0);
-            USBD_STOP_TRANSACTION(EP1);
-
-            USBD_ProcessSetupPacket();
-        }
-
-        // EP events
-        if(u32IntSts & USBD_INTSTS_EP0)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP0);
-            // control IN
-            USBD_CtrlIn();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP1)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP1);
-
-            // control OUT
-            USBD_CtrlOut();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP2)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP2);
-            // Interrupt IN
-            EP2_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP3)
+        s_u8FeatureOut = 0;
+        if(HID_SetFeatureReport(s_au8Feature) == 0)
         {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP3);
-            // Interrupt OUT
-            EP3_Handler();
+            USBD_SET_DATA1(EP0);
+            USBD_SET_PAYLOAD_LEN(EP0, 0);
         }
-
-        if(u32IntSts & USBD_INTSTS_EP4)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP4);
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP5)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP5);
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP6)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP6);
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP7)
+        else
         {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP7);
+            USBD_SetStall(EP0);
+            USBD_SetStall(EP1);
         }
     }
 }
 
-void EP2_Handler(void)  /* Interrupt IN handler */
+void EP2_Handler(uint32_t u32HwEp)  /* Interrupt IN handler */
 {
     HID_SetInReport();
 }
 
-void EP3_Handler(void)  /* Interrupt OUT handler */
+void EP3_Handler(uint32_t u32HwEp)  /* Interrupt OUT handler */
 {
     uint8_t *ptr;
     /* Interrupt OUT */
     ptr = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP3));
+    s_u8OutArmed = 0;
     HID_GetOutReport(ptr, USBD_GET_PAYLOAD_LEN(EP3));
-    USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    /* Receive the next report, unless a stream has nowhere to put it yet */
+    HID_StreamArmOut();
 }
 
 
@@ -203,7 +116,13 @@ void HID_Init(void)
     USBD_SET_EP_BUF_ADDR(EP3, EP3_BUF_BASE);
     /* trigger to receive OUT data */
     USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    s_u8OutArmed = 1;
 
+    /* Event handlers of USBD_EventIRQHandler */
+    USBD_SetEpHandler(EP1, EP1_Handler);
+    USBD_SetEpHandler(EP2, EP2_Handler);
+    USBD_SetEpHandler(EP3, EP3_Handler);
+    USBD_SetBusHandler(HID_BusEvent);
 }
 
 void HID_ClassRequest(void)
@@ -218,9 +137,19 @@ void HID_ClassRequest(void)
         switch(buf[1])
         {
             case GET_REPORT:
-//            {
-//                break;
-//            }
+            {
+                if(buf[3] == 3)
+                {
+                    /* Request Type = Feature: status of a stream job */
+                    HID_GetFeatureReport(s_au8Feature);
+                    /* Data stage */
+                    USBD_PrepareCtrlIn(s_au8Feature, (buf[6] < EP0_MAX_PKT_SIZE) ? buf[6] : EP0_MAX_PKT_SIZE);
+                    /* Status stage */
+                    USBD_PrepareCtrlOut(0, 0);
+                    break;
+                }
+                /* Other reports fall through */
+            }
             case GET_IDLE:
             {
                 USBD_SET_PAYLOAD_LEN(EP1, buf[6]);
@@ -257,9 +186,9 @@ void HID_ClassRequest(void)
             {
                 if(buf[3] == 3)
                 {
-                    /* Request Type = Feature */
-                    USBD_SET_DATA1(EP1);
-                    USBD_SET_PAYLOAD_LEN(EP1, 0);
+                    /* Request Type = Feature: a stream command, EP1_Handler() takes the data stage */
+                    s_u8FeatureOut = 1;
+                    USBD_PrepareCtrlOut(s_au8Feature, EP0_MAX_PKT_SIZE);
                 }
                 break;
             }
@@ -300,11 +229,14 @@ void HID_ClassRequest(void)
 #define HID_CMD_READ     0xD2
 #define HID_CMD_WRITE    0xC3
 #define HID_CMD_TEST     0xB4
+#define HID_CMD_STREAM_READ     0xD5
+#define HID_CMD_STREAM_WRITE    0xC5
 
 #define PAGE_SIZE        2048
 #define TEST_PAGES       4
 #define SECTOR_SIZE      4096
 #define START_SECTOR     0x10
+#define START_PAGE       (START_SECTOR * SECTOR_SIZE / PAGE_SIZE)   /* Page number of g_u8TestPages[0] */
 
 typedef struct
 {
@@ -417,6 +349,293 @@ int32_t HID_CmdTest(CMD_T *pCmd)
 }
 
 
+/***************************************************************/
+/*
+    Streaming transfer
+
+    HID_CMD_STREAM_READ and HID_CMD_STREAM_WRITE carry the CRC-32 of the command in u32Checksum instead of the
+    byte sum. They are sent as the 64-byte feature report with SET_REPORT, or as an interrupt OUT report while
+    no write is taking page data. Up to STREAM_QUEUE_LEN of them are queued and run in order, so the host sends
+    the next request without waiting for the previous one. While the queue is full SET_REPORT is stalled and
+    interrupt OUT is NAKed.
+
+    The interrupt endpoints carry page data only: the pages of the reads as 64-byte IN reports, and the pages
+    of the writes as 64-byte OUT reports after their command. Once a job has moved all its pages, GET_REPORT of
+    the feature report returns its STREAM_STATUS_T with the CRC-32 of the page data, calculated by the CRC
+    controller, and frees its queue entry. Until then it returns a status with u8Cmd HID_CMD_NONE.
+
+    Two page buffers let HID_StreamProcess() in the main loop load the next page of a read, or program the
+    previous page of a write, while the interrupt handler moves the other one 64 bytes per report. Both walk
+    the pages of the queued jobs in order, so the next job of the same direction is loaded or received while
+    the previous one finishes. A report is ready for every interrupt frame and the handler never waits for
+    storage.
+*/
+#define STREAM_QUEUE_LEN        4
+
+#define STREAM_STATUS_OK        0
+#define STREAM_STATUS_RANGE     1   /* Pages outside the test area, nothing moved */
+
+typedef struct
+{
+    uint32_t u32Signature;          /* HID_CMD_SIGNATURE */
+    uint8_t  u8Cmd;                 /* Command of the job, HID_CMD_NONE if no job has finished */
+    uint8_t  u8Status;              /* STREAM_STATUS_OK or STREAM_STATUS_RANGE */
+    uint16_t u16Reserved;
+    uint32_t u32Arg1;               /* Start page */
+    uint32_t u32Arg2;               /* Pages */
+    uint32_t u32Crc;                /* CRC-32 of the page data */
+} __attribute__((packed)) STREAM_STATUS_T;
+
+typedef struct
+{
+    uint8_t  u8Cmd;
+    uint8_t  u8Status;
+    uint32_t u32Arg1;
+    uint32_t u32Pages;              /* Pages to move, 0 after a range error */
+    uint32_t u32CpuPages;           /* Pages loaded or programmed by HID_StreamProcess() */
+    uint32_t u32UsbPages;           /* Pages sent or received by the interrupt handler */
+    uint32_t u32Crc;
+} STREAM_JOB_T;
+
+static STREAM_JOB_T s_asJob[STREAM_QUEUE_LEN];
+/* Sequence numbers of the oldest job and of the next one, the entry is the number % STREAM_QUEUE_LEN.
+   Changed by the interrupt handler only. */
+static volatile uint32_t s_u32JobHead = 0, s_u32JobTail = 0;
+
+static uint8_t  s_au8StreamBuf[2][PAGE_SIZE];
+static volatile uint8_t s_au8BufFull[2] = {0};      /* Page to send (read) or to program (write) */
+static uint32_t s_u32UsbBuf = 0, s_u32UsbOfs = 0;   /* Buffer and offset of the next report */
+static uint32_t s_u32CpuBuf = 0;                    /* Buffer of the next page for HID_StreamProcess() */
+static uint8_t volatile s_u8InArmed = 0;            /* A stream IN report is waiting for the host */
+
+/*
+    Oldest job with pages left for the interrupt handler (u8Usb 1) or for HID_StreamProcess() (u8Usb 0).
+    NULL if there is none, or while the page buffers hold pages of an older job in the other direction.
+*/
+static STREAM_JOB_T *HID_StreamJob(uint8_t u8Usb)
+{
+    STREAM_JOB_T *psJob;
+    uint32_t u32Seq, u32Done;
+    uint8_t u8Cmd = HID_CMD_NONE;   /* Direction of the pages in the buffers */
+
+    for(u32Seq = s_u32JobHead; u32Seq != s_u32JobTail; u32Seq++)
+    {
+        psJob = &s_asJob[u32Seq % STREAM_QUEUE_LEN];
+        u32Done = u8Usb ? psJob->u32UsbPages : psJob->u32CpuPages;
+        if(u32Done < psJob->u32Pages)
+            return ((u8Cmd == HID_CMD_NONE) || (u8Cmd == psJob->u8Cmd)) ? psJob : NULL;
+
+        /* Done on this side, the other one may still have pages of it */
+        if((psJob->u32UsbPages < psJob->u32Pages) || (psJob->u32CpuPages < psJob->u32Pages))
+        {
+            if((u8Cmd != HID_CMD_NONE) && (u8Cmd != psJob->u8Cmd))
+                return NULL;
+            u8Cmd = psJob->u8Cmd;
+        }
+    }
+
+    return NULL;
+}
+
+/* Write taking page data from interrupt OUT, so that OUT reports are not commands */
+static STREAM_JOB_T *HID_StreamWriteJob(void)
+{
+    STREAM_JOB_T *psJob = HID_StreamJob(1);
+
+    if((psJob != NULL) && (psJob->u8Cmd == HID_CMD_STREAM_WRITE))
+        return psJob;
+
+    return NULL;
+}
+
+/* Arm the next stream IN report with page data of the oldest read */
+static void HID_StreamIn(void)
+{
+    STREAM_JOB_T *psJob = HID_StreamJob(1);
+    uint8_t *pu8EpBuf = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP2));
+
+    s_u8InArmed = 0;
+
+    /* HID_StreamProcess() starts IN again once the page is loaded */
+    if((psJob == NULL) || (psJob->u8Cmd != HID_CMD_STREAM_READ) || !s_au8BufFull[s_u32UsbBuf])
+        return;
+
+    USBD_MemCopy(pu8EpBuf, &s_au8StreamBuf[s_u32UsbBuf][s_u32UsbOfs], EP2_MAX_PKT_SIZE);
+    s_u32UsbOfs += EP2_MAX_PKT_SIZE;
+    if(s_u32UsbOfs == PAGE_SIZE)
+    {
+        /* Page sent, the buffer takes the next prefetch */
+        s_au8BufFull[s_u32UsbBuf] = 0;
+        s_u32UsbBuf ^= 1;
+        s_u32UsbOfs = 0;
+        psJob->u32UsbPages++;
+
+        /* The last page of a read: interrupt OUT may take the data of a write next */
+        if(psJob->u32UsbPages == psJob->u32Pages)
+            HID_StreamArmOut();
+    }
+
+    USBD_SET_PAYLOAD_LEN(EP2, EP2_MAX_PKT_SIZE);
+    s_u8InArmed = 1;
+}
+
+/* Arm interrupt OUT for the next report unless there is nowhere to put it */
+static void HID_StreamArmOut(void)
+{
+    if(s_u8OutArmed)
+        return;
+
+    if(HID_StreamWriteJob() != NULL)
+    {
+        /* Page data: HID_StreamProcess() has to program the buffer first */
+        if(s_au8BufFull[s_u32UsbBuf])
+            return;
+    }
+    else if(s_u32JobTail - s_u32JobHead == STREAM_QUEUE_LEN)
+    {
+        /* Command: a job has to finish first */
+        return;
+    }
+
+    USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    s_u8OutArmed = 1;
+}
+
+/* Page data of a stream write */
+static void HID_StreamOut(STREAM_JOB_T *psJob, uint8_t *pu8EpBuf)
+{
+    USBD_MemCopy(&s_au8StreamBuf[s_u32UsbBuf][s_u32UsbOfs], pu8EpBuf, EP3_MAX_PKT_SIZE);
+    s_u32UsbOfs += EP3_MAX_PKT_SIZE;
+    if(s_u32UsbOfs == PAGE_SIZE)
+    {
+        /* Page received, HID_StreamProcess() programs it while the other buffer fills */
+        s_au8BufFull[s_u32UsbBuf] = 1;
+        s_u32UsbBuf ^= 1;
+        s_u32UsbOfs = 0;
+        psJob->u32UsbPages++;
+    }
+}
+
+int32_t HID_CmdStream(CMD_T *pCmd)
+{
+    STREAM_JOB_T *psJob = &s_asJob[s_u32JobTail % STREAM_QUEUE_LEN];
+
+    if(s_u32JobTail - s_u32JobHead == STREAM_QUEUE_LEN)
+        return -1;
+
+    psJob->u8Cmd       = pCmd->u8Cmd;
+    psJob->u8Status    = STREAM_STATUS_OK;
+    psJob->u32Arg1     = pCmd->u32Arg1;
+    psJob->u32Pages    = pCmd->u32Arg2;
+    psJob->u32CpuPages = 0;
+    psJob->u32UsbPages = 0;
+    psJob->u32Crc      = 0;
+    if((pCmd->u32Arg1 < START_PAGE) || (pCmd->u32Arg2 > TEST_PAGES) ||
+            (pCmd->u32Arg1 - START_PAGE > TEST_PAGES - pCmd->u32Arg2))
+    {
+        psJob->u8Status = STREAM_STATUS_RANGE;
+        psJob->u32Pages = 0;
+    }
+    s_u32JobTail++;
+
+    /* To note the command has been queued */
+    pCmd->u8Cmd = HID_CMD_NONE;
+
+    return 0;
+}
+
+/* SET_REPORT data of the feature report: a stream command. Returns -1 to stall the request. */
+static int32_t HID_SetFeatureReport(uint8_t *pu8Report)
+{
+    CMD_T sCmd;
+
+    USBD_MemCopy((uint8_t *)&sCmd, pu8Report, sizeof(sCmd));
+    if((sCmd.u8Size > sizeof(sCmd)) || (sCmd.u32Signature != HID_CMD_SIGNATURE))
+        return -1;
+    if((sCmd.u8Cmd != HID_CMD_STREAM_READ) && (sCmd.u8Cmd != HID_CMD_STREAM_WRITE))
+        return -1;
+    if(CRC_Crc32(0, &sCmd, sCmd.u8Size) != sCmd.u32Checksum)
+        return -1;
+
+    return HID_CmdStream(&sCmd);
+}
+
+/* GET_REPORT data of the feature report: status of the oldest job once it has moved all its pages */
+static void HID_GetFeatureReport(uint8_t *pu8Report)
+{
+    STREAM_JOB_T *psJob = &s_asJob[s_u32JobHead % STREAM_QUEUE_LEN];
+    STREAM_STATUS_T *psStatus = (STREAM_STATUS_T *)pu8Report;
+
+    memset(pu8Report, 0, EP0_MAX_PKT_SIZE);
+    psStatus->u32Signature = HID_CMD_SIGNATURE;
+    psStatus->u8Cmd = HID_CMD_NONE;
+
+    if((s_u32JobHead == s_u32JobTail) || (psJob->u32UsbPages < psJob->u32Pages) || (psJob->u32CpuPages < psJob->u32Pages))
+        return;
+
+    psStatus->u8Cmd = psJob->u8Cmd;
+    psStatus->u8Status = psJob->u8Status;
+    psStatus->u32Arg1 = psJob->u32Arg1;
+    psStatus->u32Arg2 = psJob->u32Pages;
+    psStatus->u32Crc = psJob->u32Crc;
+    s_u32JobHead++;
+
+    /* Interrupt OUT may be held for a full queue */
+    HID_StreamArmOut();
+}
+
+/**
+  * @brief  Main loop part of the streams: load the next page of a read or program the next page of a write.
+  * @param  None.
+  * @retval None.
+  */
+void HID_StreamProcess(void)
+{
+    STREAM_JOB_T *psJob;
+    uint8_t *pu8Buf = s_au8StreamBuf[s_u32CpuBuf];
+    uint8_t *pu8Page;
+    uint8_t u8Read;
+
+    /* The queue is changed by the interrupt handler */
+    NVIC_DisableIRQ(USBD_IRQn);
+    psJob = HID_StreamJob(0);
+    NVIC_EnableIRQ(USBD_IRQn);
+    if(psJob == NULL)
+        return;
+
+    /* A read needs a free buffer, a write a received page */
+    u8Read = (psJob->u8Cmd == HID_CMD_STREAM_READ);
+    if(s_au8BufFull[s_u32CpuBuf] == u8Read)
+        return;
+
+    if(psJob->u32CpuPages == 0)
+        CRC_Open(CRC_32, (CRC_WDATA_RVS | CRC_CHECKSUM_RVS | CRC_CHECKSUM_COM), 0xFFFFFFFF, CRC_CPU_WDATA_32);
+
+    pu8Page = g_u8TestPages + (psJob->u32Arg1 - START_PAGE + psJob->u32CpuPages) * PAGE_SIZE;
+    if(u8Read)
+    {
+        /* TODO: We should read the page from storage here */
+        memcpy(pu8Buf, pu8Page, PAGE_SIZE);
+    }
+    else
+    {
+        /* TODO: We should program the page to storage here */
+        memcpy(pu8Page, pu8Buf, PAGE_SIZE);
+    }
+    psJob->u32Crc = CRC_Calculate(pu8Buf, PAGE_SIZE);
+
+    /* Hand the buffer over and restart the pipe waiting for it */
+    NVIC_DisableIRQ(USBD_IRQn);
+    s_au8BufFull[s_u32CpuBuf] = u8Read;
+    s_u32CpuBuf ^= 1;
+    psJob->u32CpuPages++;
+    if(!s_u8InArmed)
+        HID_StreamIn();
+    HID_StreamArmOut();
+    NVIC_EnableIRQ(USBD_IRQn);
+}
+
+
 uint32_t CalCheckSum(uint8_t *buf, uint32_t size)
 {
     uint32_t sum;
@@ -449,8 +668,12 @@ int32_t ProcessCommand(uint8_t *pu8Buffer, uint32_t u32BufferLen)
     if(gCmd.u32Signature != HID_CMD_SIGNATURE)
         return -1;
 
-    /* Calculate checksum & check it */
-    u32sum = CalCheckSum((uint8_t *)&gCmd, gCmd.u8Size);
+    /* Calculate checksum & check it. Stream commands carry a CRC-32. It is calculated in software because
+       the CRC controller may be in the middle of a page for HID_StreamProcess(). */
+    if((gCmd.u8Cmd == HID_CMD_STREAM_READ) || (gCmd.u8Cmd == HID_CMD_STREAM_WRITE))
+        u32sum = CRC_Crc32(0, &gCmd, gCmd.u8Size);
+    else
+        u32sum = CalCheckSum((uint8_t *)&gCmd, gCmd.u8Size);
     if(u32sum != gCmd.u32Checksum)
         return -1;
 
@@ -476,6 +699,13 @@ int32_t ProcessCommand(uint8_t *pu8Buffer, uint32_t u32BufferLen)
             HID_CmdTest(&gCmd);
             break;
         }
+        case HID_CMD_STREAM_READ:
+        case HID_CMD_STREAM_WRITE:
+        {
+            if(HID_CmdStream(&gCmd))
+                return -1;
+            break;
+        }
         default:
             return -1;
     }
@@ -490,6 +720,7 @@ void HID_GetOutReport(uint8_t *pu8EpBuf, uint32_t u32Size)
     uint32_t u32StartPage;
     uint32_t u32Pages;
     uint32_t u32PageCnt;
+    STREAM_JOB_T *psJob;
 
     /* Get command information */
     u8Cmd        = gCmd.u8Cmd;
@@ -532,6 +763,11 @@ void HID_GetOutReport(uint8_t *pu8EpBuf, uint32_t u32Size)
         gCmd.u8Cmd        = u8Cmd;
         gCmd.u32Signature = u32PageCnt;
     }
+    else if((psJob = HID_StreamWriteJob()) != NULL)
+    {
+        /* Data phase of a stream write */
+        HID_StreamOut(psJob, pu8EpBuf);
+    }
     else
     {
         /* Check and process the command packet */
@@ -587,6 +823,11 @@ void HID_SetInReport(void)
             g_u32BytesInPageBuf -= EP2_MAX_PKT_SIZE;
         }
     }
+    else
+    {
+        /* Otherwise interrupt IN belongs to the streams */
+        HID_StreamIn();
+    }
 
     gCmd.u8Cmd        = u8Cmd;
     gCmd.u32Signature = u32PageCnt;
@@ -33,7 +33,7 @@
 
 /*-------------------------------------------------------------*/
 /* Define EP maximum packet size */
-#define EP0_MAX_PKT_SIZE    8
+#define EP0_MAX_PKT_SIZE    64
 #define EP1_MAX_PKT_SIZE    EP0_MAX_PKT_SIZE
 #define EP2_MAX_PKT_SIZE    64
 #define EP3_MAX_PKT_SIZE    64
@@ -68,10 +68,12 @@
 void HID_Init(void);
 void HID_ClassRequest(void);
 
-void EP2_Handler(void);
-void EP3_Handler(void);
+void EP1_Handler(uint32_t u32HwEp);
+void EP2_Handler(uint32_t u32HwEp);
+void EP3_Handler(uint32_t u32HwEp);
 void HID_SetInReport(void);
 void HID_GetOutReport(uint8_t *pu8EpBuf, uint32_t u32Size);
+void HID_StreamProcess(void);
 
 extern uint8_t volatile g_u8Suspend;
 
@@ -77,6 +77,8 @@ void SYS_Init(void)
     /* Enable module clock */
     CLK_EnableModuleClock(UART0_MODULE);
     CLK_EnableModuleClock(USBD_MODULE);
+    CLK_EnableModuleClock(CRC_MODULE);
+    CLK_EnableModuleClock(PDMA_MODULE);
 
 
     /*---------------------------------------------------------------------------------------------------------*/
@@ -214,6 +216,9 @@ int32_t main(void)
         }
 #endif
 
+        /* Load or program stream pages while the interrupt handler moves reports */
+        HID_StreamProcess();
+
         /* Enter power down when USB suspend */
         if(g_u8Suspend)
             PowerDown();
@@ -102,177 +102,59 @@ static uint8_t g_au8ModePage_1C[8] =
 };
 
 
-void USBD_IRQHandler(void)
+static void HID_MSC_BusEvent(uint32_t u32State)
 {
-    uint32_t u32IntSts = USBD_GET_INT_FLAG();
-    uint32_t u32State = USBD_GET_BUS_STATE();
-
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_FLDET)
-    {
-        // Floating detect
-        USBD_CLR_INT_FLAG(USBD_INTSTS_FLDET);
-
-        if(USBD_IS_ATTACHED())
-        {
-            /* USB Plug In */
-            USBD_ENABLE_USB();
-        }
-        else
-        {
-            /* USB Un-plug */
-            USBD_DISABLE_USB();
-        }
-    }
+    extern void FlashCacheFlush(void);
 
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_WAKEUP)
+    if(u32State & USBD_STATE_USBRST)
     {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_WAKEUP);
+        /* Bus reset */
+        g_u8Remove = 0;
+        g_u32OutToggle = g_u32OutSkip = 0;
+        DBG_PRINTF("Bus reset\n");
     }
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_BUS)
+    if(u32State & USBD_STATE_SUSPEND)
     {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_BUS);
-
-        if(u32State & USBD_STATE_USBRST)
-        {
-            /* Bus reset */
-            USBD_ENABLE_USB();
-            USBD_SwReset();
-            g_u8Remove = 0;
-            g_u32OutToggle = g_u32OutSkip = 0;
-            DBG_PRINTF("Bus reset\n");
-        }
-        if(u32State & USBD_STATE_SUSPEND)
-        {
-            extern void FlashCacheFlush(void);
+        /* The USBD driver has disabled the PHY */
+        FlashCacheFlush();
 
-            /* Enable USB but disable PHY */
-            USBD_DISABLE_PHY();
-
-            FlashCacheFlush();
-
-            DBG_PRINTF("Suspend\n");
-        }
-        if(u32State & USBD_STATE_RESUME)
-        {
-            /* Enable USB and enable PHY */
-            USBD_ENABLE_USB();
-            DBG_PRINTF("Resume\n");
-        }
+        DBG_PRINTF("Suspend\n");
     }
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_USB)
+    if(u32State & USBD_STATE_RESUME)
     {
-        // EP events
-        if(u32IntSts & USBD_INTSTS_EP0)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP0);
-            // control IN
-            USBD_CtrlIn();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP1)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP1);
-
-            // control OUT
-            USBD_CtrlOut();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP2)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP2);
-            // Interrupt IN
-            EP2_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP3)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP3);
-            // Interrupt OUT
-            EP3_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP4)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP4);
-            // Bulk IN
-            EP4_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP5)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP5);
-            // Bulk OUT
-            EP5_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP6)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP6);
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP7)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP7);
-        }
-
-        // USB event
-        if(u32IntSts & USBD_INTSTS_SETUP)
-        {
-            // Setup packet
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_SETUP);
-
-            /* Clear the data IN/OUT ready flag of control end-points */
-            USBD_STOP_TRANSACTION(EP0);
-            USBD_STOP_TRANSACTION(EP1);
-
-            USBD_ProcessSetupPacket();
-        }
-
+        DBG_PRINTF("Resume\n");
     }
+}
 
+void USBD_IRQHandler(void)
+{
+    /* Bus events, control pipe and the endpoint handlers of the registered functions */
+    USBD_EventIRQHandler();
 }
 
 
-void EP2_Handler(void)  /* Interrupt IN handler */
+void HID_IntInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)  /* Interrupt IN handler */
 {
     HID_SetInReport();
 }
 
-void EP3_Handler(void)  /* Interrupt OUT handler */
+void HID_IntOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)  /* Interrupt OUT handler */
 {
     uint8_t *ptr;
     /* Interrupt OUT */
-    ptr = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP3));
-    HID_GetOutReport(ptr, USBD_GET_PAYLOAD_LEN(EP3));
-    USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    ptr = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(u32HwEp));
+    HID_GetOutReport(ptr, USBD_GET_PAYLOAD_LEN(u32HwEp));
+    USBD_SET_PAYLOAD_LEN(u32HwEp, EP3_MAX_PKT_SIZE);
 }
 
-void EP4_Handler(void)
+void MSC_BulkInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
 {
     g_u8EP4Ready = 1;
     MSC_AckCmd();
 }
 
 
-void EP5_Handler(void)
+void MSC_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
 {
     /* Bulk OUT */
     if((g_u32OutToggle == (USBD->EPSTS & USBD_EPSTS_EPSTS5_Msk)) && !g_u32CbwStall)
@@ -291,58 +173,46 @@ void EP5_Handler(void)
 }
 
 
-void HID_MSC_Init(void)
+static void HID_ClassRequest(S_USBD_FUNC_T *psFunc);
+static void MSC_ClassRequest(S_USBD_FUNC_T *psFunc);
+
+/* HID transfer function: interface 0, interrupt IN and OUT */
+static S_USBD_FUNC_EP_T s_asHidEp[] =
 {
-    /* Init setup packet buffer */
-    /* Buffer range for SETUP packet -> [0 ~ 0x7] */
-    USBD->STBUFSEG = SETUP_BUF_BASE;
-
-    /*****************************************************/
-    /* EP0 ==> control IN endpoint, address 0 */
-    USBD_CONFIG_EP(EP0, USBD_CFG_CSTALL | USBD_CFG_EPMODE_IN | 0);
-    /* Buffer range for EP0 */
-    USBD_SET_EP_BUF_ADDR(EP0, EP0_BUF_BASE);
-
-    /* EP1 ==> control OUT endpoint, address 0 */
-    USBD_CONFIG_EP(EP1, USBD_CFG_CSTALL | USBD_CFG_EPMODE_OUT | 0);
-    /* Buffer range for EP1 */
-    USBD_SET_EP_BUF_ADDR(EP1, EP1_BUF_BASE);
-
-    /*****************************************************/
-    /* EP2 ==> Interrupt IN endpoint, address 1 */
-    USBD_CONFIG_EP(EP2, USBD_CFG_EPMODE_IN | INT_IN_EP_NUM);
-    /* Buffer range for EP2 */
-    USBD_SET_EP_BUF_ADDR(EP2, EP2_BUF_BASE);
-
-    /* EP3 ==> Interrupt OUT endpoint, address 2 */
-    USBD_CONFIG_EP(EP3, USBD_CFG_EPMODE_OUT | INT_OUT_EP_NUM);
-    /* Buffer range for EP3 */
-    USBD_SET_EP_BUF_ADDR(EP3, EP3_BUF_BASE);
-    /* trigger to receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
-
-    /*****************************************************/
-    /* EP4 ==> Bulk IN endpoint, address 3 */
-    USBD_CONFIG_EP(EP4, USBD_CFG_EPMODE_IN | BULK_IN_EP_NUM);
-    /* Buffer range for EP4 */
-    USBD_SET_EP_BUF_ADDR(EP4, EP4_BUF_BASE);
-
-    /* EP5 ==> Bulk Out endpoint, address 4 */
-    USBD_CONFIG_EP(EP5, USBD_CFG_EPMODE_OUT | BULK_OUT_EP_NUM);
-    /* Buffer range for EP5 */
-    USBD_SET_EP_BUF_ADDR(EP5, EP5_BUF_BASE);
-    /* trigger to receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP5, EP5_MAX_PKT_SIZE);
-
-    /*****************************************************/
-    g_u32BulkBuf0 = EP5_BUF_BASE;
-    g_u32BulkBuf1 = EP4_BUF_BASE;
+    {INT_IN_EP_NUM | EP_INPUT, HID_IntInHandler},
+    {INT_OUT_EP_NUM | EP_OUTPUT, HID_IntOutHandler}
+};
+static S_USBD_FUNC_T s_sHidFunc = {0, 1, 2, s_asHidEp, HID_ClassRequest, NULL, NULL};
+
+/* Mass storage function: interface 1, bulk IN and OUT */
+static S_USBD_FUNC_EP_T s_asMscEp[] =
+{
+    {BULK_IN_EP_NUM | EP_INPUT, MSC_BulkInHandler},
+    {BULK_OUT_EP_NUM | EP_OUTPUT, MSC_BulkOutHandler}
+};
+static S_USBD_FUNC_T s_sMscFunc = {1, 1, 2, s_asMscEp, MSC_ClassRequest, NULL, MSC_SetConfig};
+
+int32_t HID_MSC_Init(void)
+{
+    /* The USBD driver assigns hardware endpoints in registration order: HID gets EP2/EP3 and MSC gets EP4/EP5,
+       which the bulk transfer code below uses directly. Buffers are packed after the control pipe. */
+    if(USBD_RegisterFunction(&s_sHidFunc) < 0)
+        return -1;
+    if(USBD_RegisterFunction(&s_sMscFunc) < 0)
+        return -1;
+    USBD_SetBusHandler(HID_MSC_BusEvent);
+
+    /* MSC swaps the two bulk buffers between EP4 and EP5 */
+    g_u32BulkBuf0 = s_asMscEp[1].u32BufSeg;
+    g_u32BulkBuf1 = s_asMscEp[0].u32BufSeg;
 
     g_sCSW.dCSWSignature = CSW_SIGNATURE;
     g_TotalSectors = DATA_FLASH_STORAGE_SIZE / UDC_SECTOR_SIZE;
+
+    return 0;
 }
 
-void HID_MSC_ClassRequest(void)
+static void HID_ClassRequest(S_USBD_FUNC_T *psFunc)
 {
     uint8_t buf[8];
 
@@ -353,28 +223,6 @@ void HID_MSC_ClassRequest(void)
         // Device to host
         switch(buf[1])
         {
-            case GET_MAX_LUN:
-            {
-                /* Check interface number with cfg descriptor and check wValue = 0, wLength = 1 */
-                if((buf[4] == gsInfo.gu8ConfigDesc[LEN_CONFIG + 2]) && (buf[2] + buf[3] + buf[6] + buf[7] == 1))
-                {
-                    M8(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0)) = 0;
-                    /* Data stage */
-                    USBD_SET_DATA1(EP0);
-                    USBD_SET_PAYLOAD_LEN(EP0, 1);
-                    /* Status stage */
-                    USBD_PrepareCtrlOut(0, 0);
-                }
-                else
-                {
-                    /* Invalid Get MaxLun command */
-                    USBD_SET_EP_STALL(EP1); // Stall when wrong parameter
-                }
-
-                g_u32OutToggle = 0;
-                USBD_SET_DATA0(EP4);
-                break;
-            }
             case GET_IDLE:
             {
                 USBD_SET_PAYLOAD_LEN(EP1, buf[6]);
@@ -402,7 +250,7 @@ void HID_MSC_ClassRequest(void)
                 /* Setup error, stall the device */
                 USBD_SetStall(EP0);
                 USBD_SetStall(EP1);
-                DBG_PRINTF("Unknown MSC req(0x%x). stall ctrl pipe\n", buf[1]);
+                DBG_PRINTF("Unknown HID req(0x%x). stall ctrl pipe\n", buf[1]);
                 break;
             }
         }
@@ -430,45 +278,6 @@ void HID_MSC_ClassRequest(void)
                 USBD_SET_PAYLOAD_LEN(EP0, 0);
                 break;
             }
-            case BULK_ONLY_MASS_STORAGE_RESET:
-            {
-                /* Check interface number with cfg descriptor and check wValue = 0, wLength = 0 */
-                //if((buf[4] == gsInfo.gu8ConfigDesc[LEN_CONFIG + 2]) && (buf[2] + buf[3] + buf[6] + buf[7] == 0))
-                if(buf[4] == 0x01)
-                {
-                    USBD_SET_DATA1(EP0);
-                    USBD_SET_PAYLOAD_LEN(EP0, 0);
-
-                    g_u32Length = 0; // Reset all read/write data transfer
-                    USBD_LockEpStall(0);
-
-                    /* Clear ready */
-                    USBD->EP[EP4].CFGP |= USBD_CFGP_CLRRDY_Msk;
-                    USBD->EP[EP5].CFGP |= USBD_CFGP_CLRRDY_Msk;
-                    USBD_SET_DATA0(EP4);
-
-                    /* Prepare to receive the CBW */
-
-                    g_u8EP5Ready = 0;
-                    g_u8BulkState = BULK_CBW;
-
-                    USBD_SET_DATA1(EP5);
-                    USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf0);
-                    USBD_SET_PAYLOAD_LEN(EP5, 31);
-
-                    /* Status stage */
-                    USBD_SET_DATA1(EP0);
-                    USBD_SET_PAYLOAD_LEN(EP0, 0);
-                }
-                else
-                {
-                    /* Setup error, stall the device */
-                    USBD_SetStall(EP0);
-                    USBD_SetStall(EP1);
-                }
-
-                break;
-            }
             case SET_PROTOCOL:
             {
                 g_u8Protocol = buf[2];
@@ -483,13 +292,76 @@ void HID_MSC_ClassRequest(void)
                 /* Setup error, stall the device */
                 USBD_SetStall(EP0);
                 USBD_SetStall(EP1);
-                DBG_PRINTF("Unknown MSC req (0x%x). stall ctrl pipe\n", buf[1]);
+                DBG_PRINTF("Unknown HID req (0x%x). stall ctrl pipe\n", buf[1]);
                 break;
             }
         }
     }
 }
 
+static void MSC_ClassRequest(S_USBD_FUNC_T *psFunc)
+{
+    uint8_t buf[8];
+
+    USBD_GetSetupPacket(buf);
+
+    /* The USBD driver only routes requests for the MSC interface here */
+    if((buf[0] & EP_INPUT) && (buf[1] == GET_MAX_LUN))
+    {
+        /* Check wValue = 0, wLength = 1 */
+        if(buf[2] + buf[3] + buf[6] + buf[7] == 1)
+        {
+            M8(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0)) = 0;
+            /* Data stage */
+            USBD_SET_DATA1(EP0);
+            USBD_SET_PAYLOAD_LEN(EP0, 1);
+            /* Status stage */
+            USBD_PrepareCtrlOut(0, 0);
+        }
+        else
+        {
+            /* Invalid Get MaxLun command */
+            USBD_SET_EP_STALL(EP1); // Stall when wrong parameter
+        }
+
+        g_u32OutToggle = 0;
+        USBD_SET_DATA0(EP4);
+    }
+    else if(!(buf[0] & EP_INPUT) && (buf[1] == BULK_ONLY_MASS_STORAGE_RESET) && (buf[2] + buf[3] + buf[6] + buf[7] == 0))
+    {
+        USBD_SET_DATA1(EP0);
+        USBD_SET_PAYLOAD_LEN(EP0, 0);
+
+        g_u32Length = 0; // Reset all read/write data transfer
+        USBD_LockEpStall(0);
+
+        /* Clear ready */
+        USBD->EP[EP4].CFGP |= USBD_CFGP_CLRRDY_Msk;
+        USBD->EP[EP5].CFGP |= USBD_CFGP_CLRRDY_Msk;
+        USBD_SET_DATA0(EP4);
+
+        /* Prepare to receive the CBW */
+
+        g_u8EP5Ready = 0;
+        g_u8BulkState = BULK_CBW;
+
+        USBD_SET_DATA1(EP5);
+        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf0);
+        USBD_SET_PAYLOAD_LEN(EP5, 31);
+
+        /* Status stage */
+        USBD_SET_DATA1(EP0);
+        USBD_SET_PAYLOAD_LEN(EP0, 0);
+    }
+    else
+    {
+        /* Setup error, stall the device */
+        USBD_SetStall(EP0);
+        USBD_SetStall(EP1);
+        DBG_PRINTF("Unknown MSC req (0x%x). stall ctrl pipe\n", buf[1]);
+    }
+}
+
 
 /***************************************************************/
 #define HID_CMD_SIGNATURE   0x43444948
@@ -1692,26 +1564,10 @@ void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
 {
 }
 
-void MSC_SetConfig(void)
+void MSC_SetConfig(S_USBD_FUNC_T *psFunc)
 {
-    // Clear stall status and ready
-    USBD->EP[4].CFGP = 1;
-    USBD->EP[5].CFGP = 1;
-    /*****************************************************/
-    /* EP4 ==> Bulk IN endpoint, address 3 */
-    USBD_CONFIG_EP(EP4, USBD_CFG_EPMODE_IN | BULK_IN_EP_NUM);
-    /* Buffer range for EP4 */
-    USBD_SET_EP_BUF_ADDR(EP4, EP4_BUF_BASE);
-
-    /* EP5 ==> Bulk Out endpoint, address 4 */
-    USBD_CONFIG_EP(EP5, USBD_CFG_EPMODE_OUT | BULK_OUT_EP_NUM);
-    /* Buffer range for EP5 */
-    USBD_SET_EP_BUF_ADDR(EP5, EP5_BUF_BASE);
-
-    /* trigger to receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP5, EP5_MAX_PKT_SIZE);
-
-
+    /* The USBD driver has cleared stall and ready, put EP4/EP5 back on their own buffers with DATA0 and
+       armed EP5 for a full packet */
     USBD_LockEpStall(0);
 
     g_u8BulkState = BULK_CBW;
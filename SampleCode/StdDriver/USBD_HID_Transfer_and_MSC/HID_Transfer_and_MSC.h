@@ -33,27 +33,14 @@
 
 /*-------------------------------------------------------------*/
 /* Define EP maximum packet size */
-#define EP0_MAX_PKT_SIZE    8
+#define EP0_MAX_PKT_SIZE    64
 #define EP1_MAX_PKT_SIZE    EP0_MAX_PKT_SIZE
 #define EP2_MAX_PKT_SIZE    64
 #define EP3_MAX_PKT_SIZE    64
 #define EP4_MAX_PKT_SIZE    64
 #define EP5_MAX_PKT_SIZE    64
 
-#define SETUP_BUF_BASE      0
-#define SETUP_BUF_LEN       8
-#define EP0_BUF_BASE        (SETUP_BUF_BASE + SETUP_BUF_LEN)
-#define EP0_BUF_LEN         EP0_MAX_PKT_SIZE
-#define EP1_BUF_BASE        (SETUP_BUF_BASE + SETUP_BUF_LEN)
-#define EP1_BUF_LEN         EP1_MAX_PKT_SIZE
-#define EP2_BUF_BASE        (EP1_BUF_BASE + EP1_BUF_LEN)
-#define EP2_BUF_LEN         EP2_MAX_PKT_SIZE
-#define EP3_BUF_BASE        (EP2_BUF_BASE + EP2_BUF_LEN)
-#define EP3_BUF_LEN         EP3_MAX_PKT_SIZE
-#define EP4_BUF_BASE        (EP3_BUF_BASE + EP3_BUF_LEN)
-#define EP4_BUF_LEN         EP4_MAX_PKT_SIZE
-#define EP5_BUF_BASE        (EP4_BUF_BASE + EP4_BUF_LEN)
-#define EP5_BUF_LEN         EP5_MAX_PKT_SIZE
+/* Endpoint buffers are assigned by USBD_RegisterFunction() */
 
 /* Define the EP numbers */
 #define INT_IN_EP_NUM       0x01
@@ -70,13 +57,12 @@
 
 
 /*-------------------------------------------------------------*/
-void HID_MSC_Init(void);
-void HID_MSC_ClassRequest(void);
+int32_t HID_MSC_Init(void);
 
-void EP2_Handler(void);
-void EP3_Handler(void);
-void EP4_Handler(void);
-void EP5_Handler(void);
+void HID_IntInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void HID_IntOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void MSC_BulkInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void MSC_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
 void HID_SetInReport(void);
 void HID_GetOutReport(uint8_t *pu8EpBuf, uint32_t u32Size);
 
@@ -108,7 +108,7 @@ void MSC_Write(void);
 void MSC_ModeSense10(void);
 void MSC_ReadTrig(void);
 //void MSC_ClassRequest(void);
-void MSC_SetConfig(void);
+void MSC_SetConfig(S_USBD_FUNC_T *psFunc);
 
 void MSC_ReadMedia(uint32_t addr, uint32_t size, uint8_t *buffer);
 void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer);
@@ -2,7 +2,9 @@
  * @file     DataFlashProg.c
  * @brief    NUC029xGE Series Data Flash Access API
  *
- * @note
+ * @note     Writes go through a FLASH_CACHE_WAYS-way write-back page cache. A page is erased and
+ *           programmed only when it is evicted (least recently used first), when the host has been
+ *           idle for FLASH_CACHE_IDLE_MS, or on suspend and eject.
  * @copyright SPDX-License-Identifier: Apache-2.0
  *
  * @copyright Copyright (C) 2016 Nuvoton Technology Corp. All rights reserved.
@@ -16,6 +18,7 @@
 #include <string.h>
 #include "NUC029xGE.h"
 #include "DataFlashProg.h"
+#include "massstorage.h"
 
 #if 0
 # define dbg     printf
@@ -27,54 +30,145 @@
 /* Macro, type and constant definitions                                                                    */
 /*---------------------------------------------------------------------------------------------------------*/
 
-uint32_t g_u32Tag = (uint32_t) - 1;
-uint32_t g_sectorBuf[FLASH_PAGE_SIZE / 4];
-
 #define WRITE_THROUGH       0   //0: write through off. Better performance. 1: write through on. Slower.
 
+#define FLASH_PAGE_NUM      (DATA_FLASH_STORAGE_SIZE / FLASH_PAGE_SIZE)
 
-/* This is low level read function of USB Mass Storage */
-void DataFlashRead(uint32_t addr, uint32_t size, uint32_t buffer)
+#if (FLASH_PAGE_NUM > 32)
+# error "g_u32CacheMap holds one bit per storage page"
+#endif
+
+#define CACHE_VALID         0x1     /* The way holds a copy of page u32Page */
+#define CACHE_DIRTY         0x2     /* The copy differs from flash and must be programmed back */
+
+typedef struct
+{
+    uint32_t u32State;              /* CACHE_VALID | CACHE_DIRTY */
+    uint32_t u32Page;               /* Storage page number */
+    uint32_t u32Stamp;              /* Time of last use, the smallest one is evicted first */
+    uint32_t au32Buf[FLASH_PAGE_SIZE / 4];
+} S_FLASH_CACHE_T;
+
+S_FLASH_CACHE_T g_asFlashCache[FLASH_CACHE_WAYS];
+uint32_t g_u32CacheMap = 0;         /* Bit n set: storage page n is in the cache */
+static uint32_t s_u32CacheClock = 0;
+static uint32_t s_u32LastFrame = 0; /* USB frame number of the last media access */
+static uint32_t volatile s_u32MediaError = 0;   /* A page failed to program, reported on the next command */
+
+#define PAGE_ADDR(page)     (MASS_STORAGE_OFFSET + (page) * FLASH_PAGE_SIZE)
+
+
+/* Look up a storage page, return NULL if it is not cached */
+static S_FLASH_CACHE_T *FlashCacheFind(uint32_t u32Page)
 {
-    uint32_t alignAddr, offset, *pu32;
     int32_t i;
 
+    if((g_u32CacheMap & (1ul << u32Page)) == 0)
+        return NULL;
+
+    for(i = 0; i < FLASH_CACHE_WAYS; i++)
+    {
+        if((g_asFlashCache[i].u32State & CACHE_VALID) && (g_asFlashCache[i].u32Page == u32Page))
+            return &g_asFlashCache[i];
+    }
 
-    /* Modify the address to MASS_STORAGE_OFFSET */
-    addr += MASS_STORAGE_OFFSET;
+    return NULL;
+}
 
-    /* Get address base on page size alignment */
-    alignAddr = addr & (~(FLASH_PAGE_SIZE - 1));
+/* Erase the page of a dirty way and program the cached copy back */
+static void FlashCacheWriteBack(S_FLASH_CACHE_T *psWay)
+{
+    dbg("Flush %08x\n", PAGE_ADDR(psWay->u32Page));
 
-    /* Get the sector offset*/
-    offset = (addr & (FLASH_PAGE_SIZE - 1));
+    if(FMC_ProgramPage(PAGE_ADDR(psWay->u32Page), psWay->au32Buf) != 0)
+    {
+        dbg("Flash program failed at 0x%08x\n", PAGE_ADDR(psWay->u32Page));
+        s_u32MediaError = 1;
+    }
 
-    dbg("R[%08x] %x ALIGN[%08x] O %x\n", addr, size, alignAddr, offset);
+    psWay->u32State &= ~CACHE_DIRTY;
+}
 
-    pu32 = (uint32_t *)buffer;
+/* Get a way for a storage page that is not cached. A free way is used first, otherwise the least
+   recently used one is written back if needed and reused. The page is read in unless the caller
+   is going to overwrite all of it. */
+static S_FLASH_CACHE_T *FlashCacheAlloc(uint32_t u32Page, uint32_t u32Load)
+{
+    S_FLASH_CACHE_T *psWay = &g_asFlashCache[0];
+    uint32_t i, u32Addr;
 
-#if WRITE_THROUGH
-    for(i = 0; i < size / 4; i++)
+    for(i = 0; i < FLASH_CACHE_WAYS; i++)
     {
-        /* Read from flash */
-        pu32[i] = M32(addr + i * 4);
+        if((g_asFlashCache[i].u32State & CACHE_VALID) == 0)
+        {
+            psWay = &g_asFlashCache[i];
+            break;
+        }
+
+        if((int32_t)(g_asFlashCache[i].u32Stamp - psWay->u32Stamp) < 0)
+            psWay = &g_asFlashCache[i];
     }
-#else
-    for(i = 0; i < size / 4; i++)
+
+    if(psWay->u32State & CACHE_DIRTY)
+        FlashCacheWriteBack(psWay);
+
+    if(psWay->u32State & CACHE_VALID)
+        g_u32CacheMap &= ~(1ul << psWay->u32Page);
+
+    if(u32Load)
     {
-        /* Read from cache */
-        if(((alignAddr + i * 4) >= g_u32Tag) && ((alignAddr + i * 4) < g_u32Tag + FLASH_PAGE_SIZE))
+        u32Addr = PAGE_ADDR(u32Page);
+        for(i = 0; i < FLASH_PAGE_SIZE / 4; i++)
+            psWay->au32Buf[i] = M32(u32Addr + i * 4);
+    }
+
+    psWay->u32State = CACHE_VALID;
+    psWay->u32Page = u32Page;
+    g_u32CacheMap |= (1ul << u32Page);
+
+    return psWay;
+}
+
+
+/* This is low level read function of USB Mass Storage */
+void DataFlashRead(uint32_t addr, uint32_t size, uint32_t buffer)
+{
+    S_FLASH_CACHE_T *psWay;
+    uint32_t page, offset, len, i, *pu32;
+
+    dbg("R[%08x] %x\n", addr + MASS_STORAGE_OFFSET, size);
+
+    s_u32LastFrame = USBD->FN;
+    pu32 = (uint32_t *)buffer;
+
+    while(size > 0)
+    {
+        page = addr / FLASH_PAGE_SIZE;
+        offset = addr & (FLASH_PAGE_SIZE - 1);
+
+        len = FLASH_PAGE_SIZE - offset;
+        if(size < len)
+            len = size;
+
+        psWay = FlashCacheFind(page);
+        if(psWay)
         {
-            offset = (addr + i * 4 - g_u32Tag) / 4;
-            pu32[i] = g_sectorBuf[offset];
+            /* Read from cache */
+            psWay->u32Stamp = ++s_u32CacheClock;
+            for(i = 0; i < len / 4; i++)
+                pu32[i] = psWay->au32Buf[offset / 4 + i];
         }
         else
         {
-            /* Read from flash */
-            pu32[i] = M32(addr + i * 4);
+            /* Read from flash, no per word tag check */
+            for(i = 0; i < len / 4; i++)
+                pu32[i] = M32(MASS_STORAGE_OFFSET + addr + i * 4);
         }
+
+        pu32 += len / 4;
+        addr += len;
+        size -= len;
     }
-#endif
 }
 
 
@@ -82,119 +176,105 @@ void FlashCacheFlush(void)
 {
     int32_t i;
 
-    if(g_u32Tag == (uint32_t) - 1)
+    for(i = 0; i < FLASH_CACHE_WAYS; i++)
+    {
+        if(g_asFlashCache[i].u32State & CACHE_DIRTY)
+            FlashCacheWriteBack(&g_asFlashCache[i]);
+    }
+}
+
+/* Program back the least recently used dirty page once the host has left the media alone for
+   FLASH_CACHE_IDLE_MS. One page per call, so a command arriving meanwhile waits for one page at most. */
+void FlashCacheIdle(void)
+{
+    S_FLASH_CACHE_T *psWay = NULL;
+    int32_t i;
+
+    if(((USBD->FN - s_u32LastFrame) & USBD_FN_FN_Msk) < FLASH_CACHE_IDLE_MS)
         return;
 
-    dbg("Flush %08x\n", g_u32Tag);
-
-    /* We need to flush out cache before update it */
-    FMC->ISPADDR = g_u32Tag;
-    FMC->ISPCMD = 0x22;
-    FMC->ISPTRG = 1;
-    while(FMC->ISPTRG);
-    i = 0;
-    FMC->ISPCMD = 0x21;
-    FMC->ISPDAT = g_sectorBuf[i++];
-    do
+    for(i = 0; i < FLASH_CACHE_WAYS; i++)
     {
-        FMC->ISPTRG = 1;
-        while(FMC->ISPTRG);
-        FMC->ISPADDR += 4;
-        FMC->ISPDAT = g_sectorBuf[i++];
+        if((g_asFlashCache[i].u32State & CACHE_DIRTY) &&
+                ((psWay == NULL) || ((int32_t)(g_asFlashCache[i].u32Stamp - psWay->u32Stamp) < 0)))
+            psWay = &g_asFlashCache[i];
     }
-    while(i <= FLASH_PAGE_SIZE / 4);
 
-    g_u32Tag = (uint32_t) - 1;
+    if(psWay)
+        FlashCacheWriteBack(psWay);
 }
 
 void DataFlashWrite(uint32_t addr, uint32_t size, uint32_t buffer)
 {
     /* This is low level write function of USB Mass Storage */
-    int32_t len, i, offset;
-    uint32_t *pu32;
-    uint32_t alignAddr;
+    S_FLASH_CACHE_T *psWay;
+    uint32_t page, offset, len, i, *pu32;
 
-    /* Modify the address to MASS_STORAGE_OFFSET */
-    addr += MASS_STORAGE_OFFSET;
+    dbg("W[%08x] %x\n", addr + MASS_STORAGE_OFFSET, size);
 
-    len = (int32_t)size;
+    s_u32LastFrame = USBD->FN;
+    pu32 = (uint32_t *)buffer;
 
-    do
+    while(size > 0)
     {
+        page = addr / FLASH_PAGE_SIZE;
+        offset = addr & (FLASH_PAGE_SIZE - 1);
 
-        /* Get address base on page size alignment */
-        alignAddr = addr & (~(FLASH_PAGE_SIZE - 1));
-
-        /* Get the sector offset*/
-        offset = (addr & (FLASH_PAGE_SIZE - 1));
-
-        dbg("W[%08x] %x ALIGN[%08x] O %x\n", addr, size, alignAddr, offset);
-
-        /* check cache buffer */
-        if(g_u32Tag != alignAddr)
-        {
-            if(g_u32Tag != (uint32_t) - 1)
-            {
-                dbg("Flush: TAG %08x\n", g_u32Tag);
-
-                /* We need to flush out cache before update it */
-                FMC->ISPADDR = g_u32Tag;
-                FMC->ISPCMD = 0x22;
-                FMC->ISPTRG = 1;
-                while(FMC->ISPTRG);
-                i = 0;
-                FMC->ISPCMD = 0x21;
-                FMC->ISPDAT = g_sectorBuf[i++];
-                do
-                {
-                    FMC->ISPTRG = 1;
-                    while(FMC->ISPTRG);
-                    FMC->ISPADDR += 4;
-                    FMC->ISPDAT = g_sectorBuf[i++];
-                }
-                while(i <= FLASH_PAGE_SIZE / 4);
-
-            }
-
-
-            /* load data to cache buffer */
-            i = 0;
-            FMC->ISPADDR = alignAddr;
-            FMC->ISPCMD = 0;
-            do
-            {
-                FMC->ISPTRG = 1;
-                while(FMC->ISPTRG);
-                g_sectorBuf[i++] = FMC->ISPDAT;
-                FMC->ISPADDR += 4;
-            }
-            while(i <= FLASH_PAGE_SIZE / 4);
-            g_u32Tag = alignAddr;
-        }
-
-        /* Update the data */
-        pu32 = (uint32_t *)buffer;
         len = FLASH_PAGE_SIZE - offset;
         if(size < len)
             len = size;
 
+        /* check cache buffer */
+        psWay = FlashCacheFind(page);
+        if(psWay == NULL)
+            psWay = FlashCacheAlloc(page, (len != FLASH_PAGE_SIZE));
+
+        /* Update the data */
         for(i = 0; i < len / 4; i++)
-        {
-            g_sectorBuf[offset / 4 + i] = pu32[i];
-        }
+            psWay->au32Buf[offset / 4 + i] = pu32[i];
 
-        size -= len;
-        addr += len;
-        buffer += len;
+        psWay->u32State |= CACHE_DIRTY;
+        psWay->u32Stamp = ++s_u32CacheClock;
 
+        pu32 += len / 4;
+        addr += len;
+        size -= len;
     }
-    while(size > 0);
 
 #if WRITE_THROUGH
     FlashCacheFlush();
 #endif
 }
 
+/* Media interface of the mass storage class */
+void MSC_ReadMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
+{
+    DataFlashRead(addr, size, (uint32_t)buffer);
+}
+
+void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
+{
+    DataFlashWrite(addr, size, (uint32_t)buffer);
+}
+
+void MSC_FlushMedia(void)
+{
+    FlashCacheFlush();
+}
+
+void MSC_IdleMedia(void)
+{
+    FlashCacheIdle();
+}
+
+uint32_t MSC_TakeMediaError(void)
+{
+    uint32_t u32Error = s_u32MediaError;
+
+    s_u32MediaError = 0;
+    return u32Error;
+}
+
 
 /*** (C) COPYRIGHT 2016 Nuvoton Technology Corp. ***/
 
@@ -13,6 +13,8 @@
 #define DATA_FLASH_STORAGE_SIZE   (64*1024)  /* Configure the DATA FLASH storage size. To pass USB-IF MSC Test, it needs > 64KB */
 #define FLASH_PAGE_SIZE           2048
 #define BUFFER_PAGE_SIZE          2048
+#define FLASH_CACHE_WAYS          4           /* Pages held by the write-back cache, FLASH_PAGE_SIZE of SRAM each */
+#define FLASH_CACHE_IDLE_MS       200         /* Host idle time before dirty pages are programmed back */
 
 
 #endif  /* __DATA_FLASH_PROG_H__ */
@@ -25,6 +25,7 @@ int32_t g_TotalSectors = 0;
 uint8_t volatile g_u8EP2Ready = 0;
 uint8_t volatile g_u8EP3Ready = 0;
 uint8_t volatile g_u8Remove = 0;
+uint8_t volatile g_u8FlushReq = 0;                      /* Suspend asks the main loop to flush the media */
 
 /* USB flow control variables */
 uint8_t g_u8BulkState;
@@ -33,11 +34,17 @@ uint8_t g_u8Size;
 
 uint8_t g_au8SenseKey[4];
 
-uint32_t g_u32DataFlashStartAddr;
 uint32_t g_u32Address;
 uint32_t g_u32Length;
 uint32_t g_u32LbaAddress;
-uint32_t g_u32BytesInStorageBuf;
+
+/* Staging buffers. The USB side (USBD interrupt) and the media side (main loop) take turns on them,
+   so the media is read or programmed while packets of the other buffer are on the wire. */
+uint32_t volatile g_au32StageLen[STORAGE_BUFFER_NUM];   /* Bytes handed to the other side, 0 if free */
+uint32_t g_u32StageUsb, g_u32StageMedia;                /* Buffer each side works on */
+uint32_t g_u32StagePos;                                 /* Bytes the USB side has moved in its buffer */
+uint32_t g_u32MediaLength;                              /* Bytes still to read from the media */
+uint8_t volatile g_u8OutHeld = 0;                       /* OUT packet kept in EP3 for lack of room */
 
 uint32_t g_u32BulkBuf0, g_u32BulkBuf1;
 uint32_t volatile g_u32OutToggle = 0, g_u32OutSkip = 0;
@@ -49,7 +56,7 @@ struct CBW g_sCBW;
 struct CSW g_sCSW;
 
 uint32_t MassBlock[MASS_BUFFER_SIZE / 4];
-uint32_t Storage_Block[STORAGE_BUFFER_SIZE / 4];
+uint32_t Storage_Block[STORAGE_BUFFER_NUM * STORAGE_BUFFER_SIZE / 4];
 
 /*--------------------------------------------------------------------------*/
 uint8_t g_au8InquiryID[36] =
@@ -96,6 +103,20 @@ static uint8_t g_au8ModePage_1C[8] =
     0x1C, 0x06, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00
 };
 
+/* Empty the staging buffers for a new data phase. EP2 and EP3 are idle at this point. */
+static void MSC_StageReset(void)
+{
+    g_au32StageLen[0] = 0;
+    g_au32StageLen[1] = 0;
+    g_u32StageUsb = 0;
+    g_u32StageMedia = 0;
+    g_u32StagePos = 0;
+    g_u32MediaLength = 0;
+    g_u8Size = 0;
+    g_u8OutHeld = 0;
+    g_u8EP2Ready = 1;
+}
+
 
 void USBD_IRQHandler(void)
 {
@@ -145,12 +166,11 @@ void USBD_IRQHandler(void)
 
         if(u32State & USBD_STATE_SUSPEND)
         {
-            extern void FlashCacheFlush();
-
             /* Enable USB but disable PHY */
             USBD_DISABLE_PHY();
 
-            FlashCacheFlush();
+            /* The main loop may be programming the media, flush there and not in the middle of it */
+            g_u8FlushReq = 1;
 
             DBG_PRINTF("Suspend\n");
         }
@@ -258,11 +278,16 @@ void EP3_Handler(void)
     }
     else
     {
-        g_u8EP3Ready    = 1;
         g_u32OutToggle  = USBD->EPSTS & USBD_EPSTS_EPSTS3_Msk;
         g_u32OutSkip    = 0;
 
         g_u32CbwStall   = 0;
+
+        /* Data-out packets are staged right away, the CBW goes to the main loop */
+        if(g_u8BulkState == BULK_OUT)
+            MSC_Write();
+        else
+            g_u8EP3Ready = 1;
     }
 }
 
@@ -363,6 +388,7 @@ void MSC_ClassRequest(void)
                     USBD_SET_PAYLOAD_LEN(EP0, 0);
 
                     g_u32Length = 0; /* Reset all read/write data transfer */
+                    MSC_StageReset();
                     USBD_LockEpStall(0);
 
                     /* Clear ready */
@@ -475,128 +501,83 @@ void MSC_ReadFormatCapacity(void)
 
 }
 
-void MSC_Read(void)
+/* Copy the next data-in packet to the EP2 buffer that is not in use. Returns 0 if the main loop has
+   not staged the data yet. */
+static uint32_t MSC_InPrepare(void)
 {
-    uint32_t u32Len;
+    uint32_t u32Src, u32Buf, u32Avail;
+    uint32_t u32Stage = g_u32StageUsb;
+    uint32_t u32Media = (g_sCBW.u8OPCode == UFI_READ_10) || (g_sCBW.u8OPCode == UFI_READ_12);
 
-    if(USBD_GET_EP_BUF_ADDR(EP2) == g_u32BulkBuf1)
-        USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf0);
-    else
-        USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf1);
+    g_u8Size = EP2_MAX_PKT_SIZE;
 
-    /* Trigger to send out the data packet */
-    USBD_SET_PAYLOAD_LEN(EP2, g_u8Size);
+    if(g_u8Size > g_u32Length)
+        g_u8Size = g_u32Length;
 
-    g_u32Length -= g_u8Size;
-    g_u32BytesInStorageBuf -= g_u8Size;
-
-    if(g_u32Length)
+    if(u32Media)
     {
-        if(g_u32BytesInStorageBuf)
-        {
-            /* Prepare next data packet */
-            g_u8Size = EP2_MAX_PKT_SIZE;
-
-            if(g_u8Size > g_u32Length)
-                g_u8Size = g_u32Length;
+        u32Avail = g_au32StageLen[u32Stage] - g_u32StagePos;
 
-            if(USBD_GET_EP_BUF_ADDR(EP2) == g_u32BulkBuf1)
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
-            else
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
-
-            g_u32Address += g_u8Size;
-        }
-        else
+        if(u32Avail == 0)
         {
-            u32Len = g_u32Length;
+            g_u8Size = 0;
+            return 0;
+        }
 
-            if(u32Len > STORAGE_BUFFER_SIZE)
-                u32Len = STORAGE_BUFFER_SIZE;
+        if(g_u8Size > u32Avail)
+            g_u8Size = u32Avail;
 
-            MSC_ReadMedia(g_u32LbaAddress, u32Len, (uint8_t *)STORAGE_DATA_BUF);
-            g_u32BytesInStorageBuf = u32Len;
-            g_u32LbaAddress += u32Len;
-            g_u32Address = STORAGE_DATA_BUF;
-
-            /* Prepare next data packet */
-            g_u8Size = EP2_MAX_PKT_SIZE;
+        u32Src = STORAGE_STAGE_BUF(u32Stage) + g_u32StagePos;
+        g_u32StagePos += g_u8Size;
+    }
+    else
+    {
+        u32Src = g_u32Address;
+        g_u32Address += g_u8Size;
+    }
 
-            if(g_u8Size > g_u32Length)
-                g_u8Size = g_u32Length;
+    if(USBD_GET_EP_BUF_ADDR(EP2) == g_u32BulkBuf1)
+        u32Buf = g_u32BulkBuf0;
+    else
+        u32Buf = g_u32BulkBuf1;
 
-            if(USBD_GET_EP_BUF_ADDR(EP2) == g_u32BulkBuf1)
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
-            else
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
+    USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + u32Buf), (uint8_t *)u32Src, g_u8Size);
 
-            g_u32Address += g_u8Size;
-        }
+    /* Buffer drained, give it back to the main loop for the next media read */
+    if(u32Media && (g_u32StagePos == g_au32StageLen[u32Stage]))
+    {
+        g_au32StageLen[u32Stage] = 0;
+        g_u32StageUsb ^= 1;
+        g_u32StagePos = 0;
     }
+
+    return 1;
 }
 
-void MSC_ReadTrig(void)
+void MSC_Read(void)
 {
-    uint32_t u32Len;
-
-    if(g_u32Length)
+    while(1)
     {
-        if(g_u32BytesInStorageBuf)
+        /* Send the prepared packet as soon as EP2 is idle */
+        if(g_u8EP2Ready && g_u8Size)
         {
-            /* Prepare next data packet */
-            g_u8Size = EP2_MAX_PKT_SIZE;
-
-            if(g_u8Size > g_u32Length)
-                g_u8Size = g_u32Length;
-
             if(USBD_GET_EP_BUF_ADDR(EP2) == g_u32BulkBuf1)
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
+                USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf0);
             else
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
-
-            g_u32Address += g_u8Size;
-        }
-        else
-        {
-            u32Len = g_u32Length;
+                USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf1);
 
-            if(u32Len > STORAGE_BUFFER_SIZE)
-                u32Len = STORAGE_BUFFER_SIZE;
+            /* Trigger to send out the data packet */
+            g_u8EP2Ready = 0;
+            USBD_SET_PAYLOAD_LEN(EP2, g_u8Size);
 
-            MSC_ReadMedia(g_u32LbaAddress, u32Len, (uint8_t *)STORAGE_DATA_BUF);
-            g_u32BytesInStorageBuf = u32Len;
-            g_u32LbaAddress += u32Len;
-            g_u32Address = STORAGE_DATA_BUF;
-
-            /* Prepare next data packet */
-            g_u8Size = EP2_MAX_PKT_SIZE;
-
-            if(g_u8Size > g_u32Length)
-                g_u8Size = g_u32Length;
-
-            if(USBD_GET_EP_BUF_ADDR(EP2) == g_u32BulkBuf1)
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
-            else
-                USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
-
-            g_u32Address += g_u8Size;
+            g_u32Length -= g_u8Size;
+            g_u8Size = 0;
         }
 
-        /* DATA0/DATA1 Toggle */
-        if(USBD_GET_EP_BUF_ADDR(EP2) == g_u32BulkBuf1)
-            USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf0);
-        else
-            USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf1);
-
-        /* Trigger to send out the data packet */
-        USBD_SET_PAYLOAD_LEN(EP2, g_u8Size);
-
-        g_u32Length -= g_u8Size;
-        g_u32BytesInStorageBuf -= g_u8Size;
-
+        /* Prepare the next one in the other buffer while this one is on the wire */
+        if(g_u8Size || (g_u32Length == 0) || !MSC_InPrepare())
+            break;
     }
-    else
-        USBD_SET_PAYLOAD_LEN(EP2, 0);
 }
 
 
@@ -724,63 +705,104 @@ void MSC_ModeSense10(void)
 
 void MSC_Write(void)
 {
-    uint32_t lba, len;
+    uint32_t u32Buf, u32Len;
 
-    if(g_u32OutSkip == 0)
+    /* Both staging buffers still wait for the media. Keep the packet in EP3, the host gets NAK
+       until the main loop frees a buffer and calls here again. */
+    if(g_au32StageLen[g_u32StageUsb])
     {
-        if(g_u32Length > EP3_MAX_PKT_SIZE)
-        {
-            if(USBD_GET_EP_BUF_ADDR(EP3) == g_u32BulkBuf0)
-            {
-                USBD_SET_EP_BUF_ADDR(EP3, g_u32BulkBuf1);
-                USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
-                USBD_MemCopy((uint8_t *)g_u32Address, (uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), EP3_MAX_PKT_SIZE);
-            }
-            else
-            {
-                USBD_SET_EP_BUF_ADDR(EP3, g_u32BulkBuf0);
-                USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
-                USBD_MemCopy((uint8_t *)g_u32Address, (uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), EP3_MAX_PKT_SIZE);
-            }
+        g_u8OutHeld = 1;
+        return;
+    }
 
-            g_u32Address += EP3_MAX_PKT_SIZE;
-            g_u32Length -= EP3_MAX_PKT_SIZE;
+    g_u8OutHeld = 0;
 
-            /* Buffer full. Writer it to storage first. */
-            if(g_u32Address >= (STORAGE_DATA_BUF + STORAGE_BUFFER_SIZE))
-            {
-                DataFlashWrite(g_u32DataFlashStartAddr, STORAGE_BUFFER_SIZE, (uint32_t)STORAGE_DATA_BUF);
+    u32Buf = USBD_GET_EP_BUF_ADDR(EP3);
+    u32Len = USBD_GET_PAYLOAD_LEN(EP3);
 
-                g_u32Address = STORAGE_DATA_BUF;
-                g_u32DataFlashStartAddr += STORAGE_BUFFER_SIZE;
-            }
-        }
+    if(u32Len > g_u32Length)
+        u32Len = g_u32Length;
+
+    g_u32Length -= u32Len;
+
+    /* Let the host send the next packet to the other buffer while this one is copied */
+    if(g_u32Length)
+    {
+        if(u32Buf == g_u32BulkBuf0)
+            USBD_SET_EP_BUF_ADDR(EP3, g_u32BulkBuf1);
         else
-        {
-            if(USBD_GET_EP_BUF_ADDR(EP3) == g_u32BulkBuf0)
-                USBD_MemCopy((uint8_t *)g_u32Address, (uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), g_u32Length);
-            else
-                USBD_MemCopy((uint8_t *)g_u32Address, (uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), g_u32Length);
+            USBD_SET_EP_BUF_ADDR(EP3, g_u32BulkBuf0);
+
+        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    }
+
+    USBD_MemCopy((uint8_t *)(STORAGE_STAGE_BUF(g_u32StageUsb) + g_u32StagePos), (uint8_t *)((uint32_t)USBD_BUF_BASE + u32Buf), u32Len);
+    g_u32StagePos += u32Len;
+
+    /* Hand a full buffer, or the tail of the transfer, to the main loop */
+    if((g_u32StagePos == STORAGE_BUFFER_SIZE) || (g_u32Length == 0))
+    {
+        g_au32StageLen[g_u32StageUsb] = g_u32StagePos;
+        g_u32StageUsb ^= 1;
+        g_u32StagePos = 0;
+    }
+}
 
-            g_u32Address += g_u32Length;
-            g_u32Length = 0;
+/* Main loop side of the data phase. Reads the media ahead into the free staging buffer, or programs
+   the buffer the USB side has filled, while the interrupt keeps the bulk pipe busy with the other. */
+static void MSC_ProcessMedia(void)
+{
+    uint32_t u32Stage = g_u32StageMedia;
+    uint32_t u32Len;
+
+    if((g_u8BulkState == BULK_IN) && g_u32MediaLength && (g_au32StageLen[u32Stage] == 0))
+    {
+        u32Len = g_u32MediaLength;
 
+        if(u32Len > STORAGE_BUFFER_SIZE)
+            u32Len = STORAGE_BUFFER_SIZE;
+
+        MSC_ReadMedia(g_u32LbaAddress, u32Len, (uint8_t *)STORAGE_STAGE_BUF(u32Stage));
+        g_u32LbaAddress += u32Len;
+        g_u32MediaLength -= u32Len;
+        g_u32StageMedia ^= 1;
+
+        NVIC_DisableIRQ(USBD_IRQn);
+        g_au32StageLen[u32Stage] = u32Len;
+        /* Restart EP2 if it ran dry waiting for this buffer */
+        MSC_Read();
+        NVIC_EnableIRQ(USBD_IRQn);
+    }
+    else if(g_u8BulkState == BULK_OUT)
+    {
+        u32Len = g_au32StageLen[u32Stage];
 
+        if(u32Len)
+        {
             if((g_sCBW.u8OPCode == UFI_WRITE_10) || (g_sCBW.u8OPCode == UFI_WRITE_12))
-            {
-                lba = get_be32(&g_sCBW.au8Data[0]);
-                len = g_sCBW.dCBWDataTransferLength;
+                MSC_WriteMedia(g_u32LbaAddress, u32Len, (uint8_t *)STORAGE_STAGE_BUF(u32Stage));
 
-                len = lba * UDC_SECTOR_SIZE + g_sCBW.dCBWDataTransferLength - g_u32DataFlashStartAddr;
+            g_u32LbaAddress += u32Len;
+            g_u32StageMedia ^= 1;
+
+            NVIC_DisableIRQ(USBD_IRQn);
+            g_au32StageLen[u32Stage] = 0;
+            /* Take the packet EP3 is holding for lack of room */
+            if(g_u8OutHeld)
+                MSC_Write();
+            NVIC_EnableIRQ(USBD_IRQn);
+        }
 
-                if(len)
-                {
-                    DataFlashWrite(g_u32DataFlashStartAddr, len, (uint32_t)STORAGE_DATA_BUF);
-                }
+        if(g_u32Length == 0)
+        {
+            /* All data reached the media, return the CSW */
+            NVIC_DisableIRQ(USBD_IRQn);
+            if((g_au32StageLen[0] == 0) && (g_au32StageLen[1] == 0))
+            {
+                g_u8BulkState = BULK_IN;
+                MSC_AckCmd();
             }
-
-            g_u8BulkState = BULK_IN;
-            MSC_AckCmd();
+            NVIC_EnableIRQ(USBD_IRQn);
         }
     }
 }
@@ -791,6 +813,18 @@ void MSC_ProcessCmd(void)
     int32_t i;
     uint32_t Hcount, Dcount;
 
+    MSC_ProcessMedia();
+
+    if(g_u8FlushReq)
+    {
+        g_u8FlushReq = 0;
+        MSC_FlushMedia();
+    }
+
+    /* Let the media do its housekeeping between commands */
+    if((g_u8BulkState == BULK_CBW) && !g_u8EP3Ready)
+        MSC_IdleMedia();
+
     if(g_u8EP3Ready)
     {
         g_u8EP3Ready = 0;
@@ -882,6 +916,8 @@ void MSC_ProcessCmd(void)
                 {
                     if((g_sCBW.au8Data[2] & 0x03) == 0x2)
                     {
+                        /* Eject, program back everything still cached */
+                        MSC_FlushMedia();
                         g_u8Remove = 1;
                     }
 
@@ -983,12 +1019,13 @@ void MSC_ProcessCmd(void)
                 case UFI_MODE_SELECT_10:
                 {
                     g_u32Length = g_sCBW.dCBWDataTransferLength;
-                    g_u32Address = MassCMD_BUF;
+                    MSC_StageReset();
 
                     if(g_u32Length > 0)
                     {
-                        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+                        /* Parameter list is staged and dropped like write data */
                         g_u8BulkState = BULK_OUT;
+                        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
                     }
                     else
                     {
@@ -1122,45 +1159,16 @@ void MSC_ProcessCmd(void)
                     }
 
                     /* Get LBA address */
-                    g_u32Address = get_be32(&g_sCBW.au8Data[0]);
-                    g_u32LbaAddress = g_u32Address * UDC_SECTOR_SIZE;
+                    g_u32LbaAddress = get_be32(&g_sCBW.au8Data[0]) * UDC_SECTOR_SIZE;
                     g_u32Length = g_sCBW.dCBWDataTransferLength;
-                    g_u32BytesInStorageBuf = g_u32Length;
-
-                    i = g_u32Length;
-
-                    if(i > STORAGE_BUFFER_SIZE)
-                        i = STORAGE_BUFFER_SIZE;
-
-                    MSC_ReadMedia(g_u32Address * UDC_SECTOR_SIZE, i, (uint8_t *)STORAGE_DATA_BUF);
-                    g_u32BytesInStorageBuf = i;
-                    g_u32LbaAddress += i;
-
-                    g_u32Address = STORAGE_DATA_BUF;
+                    MSC_StageReset();
+                    g_u32MediaLength = g_u32Length;
 
                     /* Indicate the next packet should be Bulk IN Data packet */
                     g_u8BulkState = BULK_IN;
 
-                    if(g_u32BytesInStorageBuf > 0)
-                    {
-                        /* Set the packet size */
-                        if(g_u32BytesInStorageBuf > EP2_MAX_PKT_SIZE)
-                            g_u8Size = EP2_MAX_PKT_SIZE;
-                        else
-                            g_u8Size = g_u32BytesInStorageBuf;
-
-                        /* Prepare the first data packet (DATA1) */
-                        /* Bulk IN buffer */
-                        USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
-                        g_u32Address += g_u8Size;
-
-                        /* kick - start */
-                        USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf1);
-                        /* Trigger to send out the data packet */
-                        USBD_SET_PAYLOAD_LEN(EP2, g_u8Size);
-                        g_u32Length -= g_u8Size;
-                        g_u32BytesInStorageBuf -= g_u8Size;
-                    }
+                    /* kick - start. Staging the first buffer starts EP2, the main loop reads ahead. */
+                    MSC_ProcessMedia();
 
                     return;
                 }
@@ -1200,8 +1208,8 @@ void MSC_ProcessCmd(void)
                             }
 
                             g_u32Length = g_sCBW.dCBWDataTransferLength;
-                            g_u32Address = STORAGE_DATA_BUF;
-                            g_u32DataFlashStartAddr = get_be32(&g_sCBW.au8Data[0]) * UDC_SECTOR_SIZE;
+                            g_u32LbaAddress = get_be32(&g_sCBW.au8Data[0]) * UDC_SECTOR_SIZE;
+                            MSC_StageReset();
                         }
                         else     /* Hi <> Do (Case 8) */
                         {
@@ -1217,8 +1225,9 @@ void MSC_ProcessCmd(void)
 
                     if((g_u32Length > 0))
                     {
-                        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+                        /* Data-out packets go through EP3_Handler from now on */
                         g_u8BulkState = BULK_OUT;
+                        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
                     }
 
                     return;
@@ -1264,20 +1273,6 @@ void MSC_ProcessCmd(void)
                 }
             }
         }
-        else if(g_u8BulkState == BULK_OUT)
-        {
-            switch(g_sCBW.u8OPCode)
-            {
-                case UFI_WRITE_12:
-                case UFI_WRITE_10:
-                case UFI_MODE_SELECT_6:
-                case UFI_MODE_SELECT_10:
-                {
-                    MSC_Write();
-                    return;
-                }
-            }
-        }
     }
 }
 
@@ -1301,7 +1296,7 @@ void MSC_AckCmd(void)
             {
                 if(g_u32Length > 0)
                 {
-                    MSC_ReadTrig();
+                    MSC_Read();
                     return;
                 }
 
@@ -1360,6 +1355,16 @@ void MSC_AckCmd(void)
             }
         }
 
+        /* Cached data that failed to program fails this command, with sense WRITE FAULT */
+        if((g_sCBW.u8OPCode != UFI_REQUEST_SENSE) && (g_sCBW.u8OPCode != UFI_INQUIRY) && MSC_TakeMediaError())
+        {
+            g_sCSW.bCSWStatus = 0x01;
+            g_au8SenseKey[0] = 0x03;    /* Medium error */
+            g_au8SenseKey[1] = 0x0C;    /* Write fault */
+            g_au8SenseKey[2] = 0x00;
+            g_u8Prevent = 1;
+        }
+
         /* Return the CSW */
         USBD_SET_EP_BUF_ADDR(EP2, g_u32BulkBuf1);
 
@@ -1371,15 +1376,6 @@ void MSC_AckCmd(void)
     }
 }
 
-void MSC_ReadMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
-{
-    DataFlashRead(addr, size, (uint32_t)buffer);
-}
-
-void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
-{
-}
-
 void MSC_SetConfig(void)
 {
     // Clear stall status and ready
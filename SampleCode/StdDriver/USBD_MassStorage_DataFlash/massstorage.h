@@ -117,6 +117,7 @@ struct CSW
 /*-------------------------------------------------------------*/
 #define MASS_BUFFER_SIZE    256               /* Mass Storage command buffer size */
 #define STORAGE_BUFFER_SIZE 512               /* Data transfer buffer size in 512 bytes alignment */
+#define STORAGE_BUFFER_NUM  2                 /* Staging buffers, one moves over USB while the other meets the media */
 #define UDC_SECTOR_SIZE   512                 /* logic sector size */
 
 extern uint32_t MassBlock[];
@@ -124,6 +125,7 @@ extern uint32_t Storage_Block[];
 
 #define MassCMD_BUF        ((uint32_t)&MassBlock[0])
 #define STORAGE_DATA_BUF   ((uint32_t)&Storage_Block[0])
+#define STORAGE_STAGE_BUF(n)   (STORAGE_DATA_BUF + (n) * STORAGE_BUFFER_SIZE)
 
 /*-------------------------------------------------------------*/
 
@@ -137,12 +139,18 @@ void MSC_Read(void);
 void MSC_ReadCapacity(void);
 void MSC_Write(void);
 void MSC_ModeSense10(void);
-void MSC_ReadTrig(void);
 void MSC_ClassRequest(void);
 void MSC_SetConfig(void);
 
+/* Media interface of the class, provided by the storage driver (DataFlashProg.c).
+   Called from the main loop through MSC_ProcessCmd() only, a suspend defers its flush there.
+   MSC_IdleMedia() is called while no command is in progress.
+   MSC_TakeMediaError() returns 1 once if data written earlier could not be programmed. */
 void MSC_ReadMedia(uint32_t addr, uint32_t size, uint8_t *buffer);
 void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer);
+void MSC_FlushMedia(void);
+void MSC_IdleMedia(void);
+uint32_t MSC_TakeMediaError(void);
 
 /*-------------------------------------------------------------*/
 void MSC_AckCmd(void);
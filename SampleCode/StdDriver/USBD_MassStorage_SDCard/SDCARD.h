@@ -49,6 +49,8 @@ extern "C"
 #define     WR    2     /*!< Command value definitions: WR */
 #define     RDB   3     /*!< Command value definitions: RDB */
 #define     WDB   4     /*!< Command value definitions: WDB */
+#define     RDC   5     /*!< Command value definitions: RDC, read data block(s) moved by the caller */
+#define     WRC   6     /*!< Command value definitions: WRC, write data block(s) moved by the caller */
 #define     R1    0     /*!< Command value definitions: R1 */
 #define     R1b   1     /*!< Command value definitions: R1b */
 #define     R2    2     /*!< Command value definitions: R2 */
@@ -69,6 +71,13 @@ extern "C"
 // Mask for busy Token in R1b response
 #define     BUSY_BIT       0x80     /*!< BUSY_BIT mask */
 
+// Data response token of an accepted write block
+#define     DATA_ACCEPTED  0x05     /*!< DATA_ACCEPTED token */
+
+// Polls of the card for a data token or the end of busy,
+// about 250 ms at the 16 MHz data clock
+#define     SD_POLL_RETRY  0x80000  /*!< Data token and busy wait retry count */
+
 //#define BACK_FROM_ERROR { SingleWrite(0xFF); SPI_SET_SS_HIGH(/*SPI0*/SPI1);  return FALSE;} /*!< macro for SPI write */
 #define BACK_FROM_ERROR { SingleWrite(0xFF); PC4 = 1;  return FALSE;} /*!< macro for SPI write */
 
@@ -153,6 +162,8 @@ uint32_t SDCARD_GetVersion(void);
 uint32_t MMC_Command_Exec(uint8_t cmd_loc, uint32_t argument, uint8_t *pchar, uint32_t* response);
 uint32_t GetLogicSector(void);
 uint32_t SDCARD_GetCardSize(uint32_t* pu32TotSecCnt);
+uint32_t SDCARD_ReadBlocks(uint32_t u32Lba, uint32_t u32Count, uint8_t *pu8Buf);
+uint32_t SDCARD_WriteBlocks(uint32_t u32Lba, uint32_t u32Count, const uint8_t *pu8Buf);
 void SpiRead(uint32_t addr, uint32_t size, uint8_t* buffer);
 void SpiWrite(uint32_t addr, uint32_t size, uint8_t* buffer);
 
@@ -24,6 +24,9 @@
 
 static SPI_T    *g_pSPI = SPI1;
 
+/* PDMA channels of the data phase, -1 moves the data by CPU polling */
+static int32_t  s_i32TxCh = -1, s_i32RxCh = -1;
+static uint8_t  s_u8DummyTx = 0xFF, s_u8DummyRx;
 
 
 
@@ -44,11 +47,11 @@ COMMAND __I command_list[] =
     {12, NO , 0xFF, CMD, R1b, NO }, // CMD12; STOP_TRANSMISSION: end read;
     {13, NO , 0xFF, CMD, R2 , NO }, // CMD13; SEND_STATUS: read card status;
     {16, YES, 0xFF, CMD, R1 , NO }, // CMD16; SET_BLOCKLEN: set block size;
-    {17, YES, 0xFF, RDB , R1 , NO }, // CMD17; READ_SINGLE_BLOCK: read 1 block;
-    {18, YES, 0xFF, RD , R1 , YES}, // CMD18; READ_MULTIPLE_BLOCK: read > 1;
+    {17, YES, 0xFF, RDC, R1 , NO }, // CMD17; READ_SINGLE_BLOCK: read 1 block;
+    {18, YES, 0xFF, RDC, R1 , YES}, // CMD18; READ_MULTIPLE_BLOCK: read > 1;
     {23, NO , 0xFF, CMD, R1 , NO }, // CMD23; SET_BLOCK_COUNT
-    {24, YES, 0xFF, WR , R1 , NO }, // CMD24; WRITE_BLOCK: write 1 block;
-    {25, YES, 0xFF, WR , R1 , YES}, // CMD25; WRITE_MULTIPLE_BLOCK: write > 1;
+    {24, YES, 0xFF, WRC, R1 , NO }, // CMD24; WRITE_BLOCK: write 1 block;
+    {25, YES, 0xFF, WRC, R1 , YES}, // CMD25; WRITE_MULTIPLE_BLOCK: write > 1;
     {27, NO , 0xFF, CMD, R1 , NO }, // CMD27; PROGRAM_CSD: program CSD;
     {28, YES, 0xFF, CMD, R1b, NO }, // CMD28; SET_WRITE_PROT: set wp for group;
     {29, YES, 0xFF, CMD, R1b, NO }, // CMD29; CLR_WRITE_PROT: clear group wp;
@@ -99,39 +102,140 @@ void SD_Delay(uint32_t count)
 */
 
 /**
-  * @brief This function is used to generate CRC value
-  * @param[in] u32Data Input Data
-  * @param[in] u32GenPoly CRC7:0x1200, CRC16:0x1021
-  * @param[in] u32Accum CRC value
-  * @return CRC value
+  * @brief This function is used to send data though SPI to general clock for SDCARD operation
+  * @param[in] u32Data Data to send
+  * @return none
+  */
+static uint32_t SingleWrite(uint32_t u32Data)
+{
+    while(SPI_IS_BUSY(g_pSPI));
+    SPI_WRITE_TX(g_pSPI, u32Data);
+    while(SPI_IS_BUSY(g_pSPI));
+    return SPI_READ_RX(g_pSPI);
+}
+
+/**
+  * @brief This function is used to start a data phase of SDCARD
+  * @param[in] pu8Tx Data to send, NULL sends 0xFF
+  * @param[out] pu8Rx Buffer for received data, NULL drops it
+  * @param[in] u32Len Data length in bytes
+  * @return none
+  * @details With PDMA channels, RX and TX channels move the data and the function returns at once,
+  *          SD_XferWait waits for the end. Otherwise the data is moved by CPU before return.
   */
-static uint32_t GenerateCRC(uint32_t u32Data, uint32_t u32GenPoly, uint32_t u32Accum)
+static void SD_XferStart(const uint8_t *pu8Tx, uint8_t *pu8Rx, uint32_t u32Len)
 {
-    volatile uint8_t i;
+    uint32_t u32Req = (g_pSPI == SPI0) ? PDMA_SPI0_TX : PDMA_SPI1_TX;
+    uint32_t i, u32Data;
 
-    u32Data <<= 8;
-    for(i = 8; i > 0; i--)
+    if((s_i32TxCh < 0) || (s_i32RxCh < 0))
     {
-        if((u32Data ^ u32Accum) & 0x8000)
-            u32Accum = (u32Accum << 1) ^ u32GenPoly;
-        else
-            u32Accum <<= 1;
-        u32Data <<= 1;
+        for(i = 0; i < u32Len; i++)
+        {
+            SPI_WRITE_TX(g_pSPI, (pu8Tx != NULL) ? pu8Tx[i] : 0xFF);
+            while(SPI_IS_BUSY(g_pSPI));
+            u32Data = SPI_READ_RX(g_pSPI);
+            if(pu8Rx != NULL)
+                pu8Rx[i] = (uint8_t)u32Data;
+        }
+        return;
     }
-    return u32Accum;
+
+    /* RX channel first, so that no received byte is missed */
+    PDMA_SetTransferCnt(s_i32RxCh, PDMA_WIDTH_8, u32Len);
+    if(pu8Rx != NULL)
+        PDMA_SetTransferAddr(s_i32RxCh, (uint32_t)&g_pSPI->RX, PDMA_SAR_FIX, (uint32_t)pu8Rx, PDMA_DAR_INC);
+    else
+        PDMA_SetTransferAddr(s_i32RxCh, (uint32_t)&g_pSPI->RX, PDMA_SAR_FIX, (uint32_t)&s_u8DummyRx, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(s_i32RxCh, u32Req + 1, FALSE, 0);
+    PDMA_SetBurstType(s_i32RxCh, PDMA_REQ_SINGLE, 0);
+
+    PDMA_SetTransferCnt(s_i32TxCh, PDMA_WIDTH_8, u32Len);
+    if(pu8Tx != NULL)
+        PDMA_SetTransferAddr(s_i32TxCh, (uint32_t)pu8Tx, PDMA_SAR_INC, (uint32_t)&g_pSPI->TX, PDMA_DAR_FIX);
+    else
+        PDMA_SetTransferAddr(s_i32TxCh, (uint32_t)&s_u8DummyTx, PDMA_SAR_FIX, (uint32_t)&g_pSPI->TX, PDMA_DAR_FIX);
+    PDMA_SetTransferMode(s_i32TxCh, u32Req, FALSE, 0);
+    PDMA_SetBurstType(s_i32TxCh, PDMA_REQ_SINGLE, 0);
+
+    SPI_TRIGGER_TX_RX_PDMA(g_pSPI);
 }
 
 /**
-  * @brief This function is used to send data though SPI to general clock for SDCARD operation
-  * @param[in] u32Data Data to send
+  * @brief This function is used to wait for the data phase started by SD_XferStart
   * @return none
+  * @details The last received byte ends the data phase, the TX channel is done before it.
+  *          The channel is polled through its operation mode, which goes idle when the table is done,
+  *          so that a PDMA IRQ handler of other channels cannot hide the end.
   */
-static uint32_t SingleWrite(uint32_t u32Data)
+static void SD_XferWait(void)
 {
-    while(SPI_IS_BUSY(g_pSPI));
-    SPI_WRITE_TX(g_pSPI, u32Data);
-    while(SPI_IS_BUSY(g_pSPI));
-    return SPI_READ_RX(g_pSPI);
+    if((s_i32TxCh < 0) || (s_i32RxCh < 0))
+        return;
+
+    while(PDMA->DSCT[s_i32RxCh].CTL & PDMA_DSCT_CTL_OPMODE_Msk);
+    SPI_DISABLE_TX_RX_PDMA(g_pSPI);
+    PDMA_CLR_TD_FLAG((1 << s_i32TxCh) | (1 << s_i32RxCh));
+}
+
+/**
+  * @brief This function is used to calculate CRC16 of a data block by CRC controller
+  * @param[in] pu8Buf Data block
+  * @param[in] u32Len Data length in bytes, multiple of 4
+  * @return CRC16 (CCITT, seed 0) of the block
+  */
+static uint32_t SD_Crc16(const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    const uint32_t *pu32Buf = (const uint32_t *)pu8Buf;
+    uint32_t i;
+
+    if(((uint32_t)pu8Buf & 3) == 0)
+    {
+        /* Words are fed least significant byte first, the order of the bytes on the bus */
+        CRC_Open(CRC_CCITT, 0, 0, CRC_CPU_WDATA_32);
+        for(i = 0; i < u32Len / 4; i++)
+            CRC_WRITE_DATA(pu32Buf[i]);
+    }
+    else
+    {
+        CRC_Open(CRC_CCITT, 0, 0, CRC_CPU_WDATA_8);
+        for(i = 0; i < u32Len; i++)
+            CRC_WRITE_DATA(pu8Buf[i]);
+    }
+    return CRC_GetChecksum();
+}
+
+/**
+  * @brief This function is used to wait for the start token of a read data block
+  * @return Token received, 0xFF if time-out
+  */
+static uint32_t SD_WaitToken(void)
+{
+    uint32_t u32Token, u32Retry = SD_POLL_RETRY;
+
+    do
+    {
+        u32Token = SingleWrite(0xFF) & 0xFF;
+    }
+    while((u32Token == 0xFF) && --u32Retry);
+    return u32Token;
+}
+
+/**
+  * @brief This function is used to wait until SDCARD releases busy
+  * @retval TRUE Card is ready
+  * @retval FALSE Time-out
+  */
+static uint32_t SD_WaitReady(void)
+{
+    uint32_t u32Retry = SD_POLL_RETRY;
+
+    while((SingleWrite(0xFF) & 0xFF) != 0xFF)
+    {
+        if(!--u32Retry)
+            return FALSE;
+    }
+    return TRUE;
 }
 
 /**
@@ -152,8 +256,8 @@ uint32_t MMC_Command_Exec(uint8_t nCmd, uint32_t nArg, uint8_t *pchar, uint32_t
     uint32_t old_blklen = 512;
     int32_t counter = 0;                    // Byte counter for multi-byte fields;
     UINT16 card_response;                       // Variable for storing card response;
-    uint8_t data_resp;                      // Variable for storing data response;
     UINT16 dummy_CRC;                       // Dummy variable for storing CRC field;
+    uint8_t au8Token[5];                    // Command byte and argument covered by CRC7;
 
     card_response.i = 0;
 
@@ -201,15 +305,13 @@ uint32_t MMC_Command_Exec(uint8_t nCmd, uint32_t nArg, uint8_t *pchar, uint32_t
     // 0x00;
     if(current_command.arg_required == YES)
     {
-        dummy_CRC.i = GenerateCRC((current_command.command_byte | 0x40), 0x1200, 0);
+        au8Token[0] = (current_command.command_byte | 0x40) & 0x7f;
         for(counter = 3; counter >= 0; counter--)
         {
             SingleWrite(long_arg.b[counter]);
-            dummy_CRC.i = GenerateCRC(long_arg.b[counter], 0x1200, dummy_CRC.i);
-
+            au8Token[4 - counter] = long_arg.b[counter];
         }
-        dummy_CRC.i = (dummy_CRC.i >> 8) | 0x01;
-        SingleWrite(dummy_CRC.b[0]);
+        SingleWrite((uint8_t)((CRC_Crc7(0, au8Token, sizeof(au8Token)) << 1) | 0x01));
     }
     else
     {
@@ -329,41 +431,6 @@ uint32_t MMC_Command_Exec(uint8_t nCmd, uint32_t nArg, uint8_t *pchar, uint32_t
         // operations;  The command entry
         // determines what type, if any, data
         // operations need to occur;
-        case RDB:                         // Read data from the MMC;
-            loopguard = 0;
-
-            while((SingleWrite(0xFF) & 0xFF) != START_SBR)
-            {
-                if(!++loopguard)
-                {
-                    BACK_FROM_ERROR;
-                }
-                SD_Delay(119);
-            }
-            counter = 0;                    // Reset byte counter;
-            // Read <current_blklen> bytes;
-            if(pchar)
-            {
-                for(counter = 0; counter < current_blklen; counter++)
-                {
-                    SPI_WRITE_TX(g_pSPI, 0xFF);
-                    while(SPI_IS_BUSY(g_pSPI));
-                    *(pchar + counter) = SPI_READ_RX(g_pSPI);
-                }
-            }
-            else
-            {
-                for(; counter < current_blklen; counter++)
-                {
-                    SPI_WRITE_TX(g_pSPI, 0xFF);
-                    while(SPI_IS_BUSY(g_pSPI));
-                }
-            }
-            dummy_CRC.b[1] = SingleWrite(0xFF); // After all data is read, read the two
-            dummy_CRC.b[0] = SingleWrite(0xFF); // CRC bytes;  These bytes are not used
-            // in this mode, but the place holders
-            // must be read anyway;
-            break;
         case RD:                         // Read data from the MMC;
             loopguard = 0;
 
@@ -374,62 +441,19 @@ uint32_t MMC_Command_Exec(uint8_t nCmd, uint32_t nArg, uint8_t *pchar, uint32_t
                     BACK_FROM_ERROR;
                 }
             }
-            counter = 0;                    // Reset byte counter;
             // Read <current_blklen> bytes;
-            if(pchar)
-            {
-                for(counter = 0; counter < current_blklen; counter++)
-                {
-                    SPI_WRITE_TX(g_pSPI, 0xFF);
-                    while(SPI_IS_BUSY(g_pSPI));
-                    *(pchar + counter) = SPI_READ_RX(g_pSPI);
-                }
-            }
-            else
-            {
-                for(counter = 0; counter < current_blklen; counter++)
-                {
-                    SPI_WRITE_TX(g_pSPI, 0xFF);
-                    while(SPI_IS_BUSY(g_pSPI));
-                }
-            }
+            SD_XferStart(NULL, pchar, current_blklen);
+            SD_XferWait();
             dummy_CRC.b[1] = SingleWrite(0xFF); // After all data is read, read the two
             dummy_CRC.b[0] = SingleWrite(0xFF); // CRC bytes;  These bytes are not used
             // in this mode, but the place holders
             // must be read anyway;
             break;
 
-        case WR:
-            SingleWrite(0xFF);
-            SingleWrite(START_SBW);
-
-            for(counter = 0; counter < current_blklen; counter++)
-            {
-                SPI_WRITE_TX(g_pSPI, *(pchar + counter));
-                dummy_CRC.i = GenerateCRC(*(pchar + counter), 0x1021, dummy_CRC.i);
-                while(SPI_IS_BUSY(g_pSPI));
-            }
-            SingleWrite(dummy_CRC.b[1]);
-            SingleWrite(dummy_CRC.b[0]);
-
-            loopguard = 0;
-            do                            // Read Data Response from card;
-            {
-                data_resp = SingleWrite(0xFF);
-                if(!++loopguard) break;
-            }
-            while((data_resp & DATA_RESP_MASK) != 0x01);     // When bit 0 of the MMC response
-            // is clear, a valid data response
-            // has been received;
+        case RDC:                        // Data blocks are moved by the caller
+        case WRC:                        // with the card still selected;
+            return TRUE;
 
-            if(!loopguard)
-            {
-                BACK_FROM_ERROR;
-            }
-
-            while((SingleWrite(0xFF) & 0xFF) != 0xFF); //Wait for Busy
-            SingleWrite(0xFF);
-            break;
         default:
             break;
     }
@@ -443,6 +467,129 @@ uint32_t MMC_Command_Exec(uint8_t nCmd, uint32_t nArg, uint8_t *pchar, uint32_t
     return TRUE;
 }
 
+/**
+  * @brief This function is used to read data blocks from SDCARD
+  * @param[in] u32Addr Card address of the first block, block number for block addressed cards
+  * @param[in] u32Count Number of 512-byte blocks
+  * @param[out] pu8Buf Buffer for the data, NULL drops it
+  * @retval TRUE Success
+  * @retval FALSE Command failed, data token time-out or CRC error
+  * @details More than one block is read by READ_MULTIPLE_BLOCK. The CRC of a block is checked while
+  *          PDMA moves the next one.
+  */
+static uint32_t SD_ReadBlocks(uint32_t u32Addr, uint32_t u32Count, uint8_t *pu8Buf)
+{
+    uint32_t response, i, u32Crc = 0, u32Ret = TRUE;
+    uint8_t *pu8Prev = NULL;
+    UINT16 crc;
+
+    if(MMC_Command_Exec((u32Count > 1) ? READ_MULTIPLE_BLOCK : READ_SINGLE_BLOCK, u32Addr, EMPTY, &response) == FALSE)
+        return FALSE;
+    if(response != 0)
+    {
+        BACK_FROM_ERROR;
+    }
+
+    for(i = 0; i < u32Count; i++)
+    {
+        if(SD_WaitToken() != START_MBR)
+        {
+            u32Ret = FALSE;
+            break;
+        }
+        SD_XferStart(NULL, pu8Buf, PHYSICAL_BLOCK_SIZE);
+        if((pu8Prev != NULL) && (SD_Crc16(pu8Prev, PHYSICAL_BLOCK_SIZE) != u32Crc))
+            u32Ret = FALSE;
+        SD_XferWait();
+        crc.b[1] = SingleWrite(0xFF);
+        crc.b[0] = SingleWrite(0xFF);
+        if(u32Ret == FALSE)
+            break;
+
+        u32Crc = crc.i;
+        pu8Prev = pu8Buf;
+        if(pu8Buf != NULL)
+            pu8Buf += PHYSICAL_BLOCK_SIZE;
+    }
+    if((u32Ret == TRUE) && (pu8Prev != NULL) && (SD_Crc16(pu8Prev, PHYSICAL_BLOCK_SIZE) != u32Crc))
+        u32Ret = FALSE;
+
+    if(u32Count > 1)
+    {
+        if(MMC_Command_Exec(STOP_TRANSMISSION, EMPTY, EMPTY, &response) == FALSE)
+            return FALSE;
+    }
+    else
+    {
+        SingleWrite(0xFF);
+        PC4 = 1;//SPI_SET_SS_HIGH(g_pSPI);// CS = 1
+    }
+    return u32Ret;
+}
+
+/**
+  * @brief This function is used to write data blocks to SDCARD
+  * @param[in] u32Addr Card address of the first block, block number for block addressed cards
+  * @param[in] u32Count Number of 512-byte blocks
+  * @param[in] pu8Buf Data to write
+  * @retval TRUE Success
+  * @retval FALSE Command failed, data rejected or busy time-out
+  * @details More than one block is written by WRITE_MULTIPLE_BLOCK, SD cards are told the block count
+  *          first so that they can pre-erase. The CRC of a block is calculated while PDMA sends it.
+  */
+static uint32_t SD_WriteBlocks(uint32_t u32Addr, uint32_t u32Count, const uint8_t *pu8Buf)
+{
+    uint32_t response, i, u32Crc, u32Ret = TRUE;
+    uint8_t loopguard, data_resp;
+
+    if((u32Count > 1) && !(SDtype & MMCv3))
+        MMC_Command_Exec(SD_SET_WR_BLK_ERASE_COUNT, u32Count, EMPTY, &response);
+
+    if(MMC_Command_Exec((u32Count > 1) ? WRITE_MULTIPLE_BLOCK : WRITE_BLOCK, u32Addr, EMPTY, &response) == FALSE)
+        return FALSE;
+    if(response != 0)
+    {
+        BACK_FROM_ERROR;
+    }
+    SingleWrite(0xFF);
+
+    for(i = 0; i < u32Count; i++)
+    {
+        SingleWrite((u32Count > 1) ? START_MBW : START_SBW);
+        SD_XferStart(pu8Buf, NULL, PHYSICAL_BLOCK_SIZE);
+        u32Crc = SD_Crc16(pu8Buf, PHYSICAL_BLOCK_SIZE);
+        SD_XferWait();
+        SingleWrite(u32Crc >> 8);
+        SingleWrite(u32Crc & 0xFF);
+
+        loopguard = 0;
+        do                            // Read Data Response from card;
+        {
+            data_resp = SingleWrite(0xFF);
+            if(!++loopguard) break;
+        }
+        while((data_resp & DATA_RESP_MASK) != 0x01);
+
+        if(((data_resp & 0x1F) != DATA_ACCEPTED) || (SD_WaitReady() == FALSE))
+        {
+            u32Ret = FALSE;
+            break;
+        }
+        pu8Buf += PHYSICAL_BLOCK_SIZE;
+    }
+
+    if(u32Count > 1)
+    {
+        SingleWrite(STOP_MBW);
+        SingleWrite(0xFF);
+        if(SD_WaitReady() == FALSE)
+            u32Ret = FALSE;
+    }
+    SingleWrite(0xFF);
+    PC4 = 1;//SPI_SET_SS_HIGH(g_pSPI);// CS = 1
+    return u32Ret;
+}
+
 /**
   * @brief This function is used to initialize the flash card
   * @return none
@@ -574,7 +721,7 @@ void MMC_FLASH_Init(void)
     DBG_PRINTF("\nLogicSector:%d, PHYSICAL_SIZE:%dMB\n", LogicSector, (LogicSector / 2 / 1024));
 
     loopguard = 0;
-    while((MMC_Command_Exec(READ_SINGLE_BLOCK, 0, 0, &response) == FALSE))
+    while(SD_ReadBlocks(0, 1, NULL) == FALSE)
     {
         if(!++loopguard) break;
     }
@@ -614,6 +761,20 @@ uint32_t SDCARD_Open(void)
     Gfreq = SPI_SetBusClock(g_pSPI, 16000000);//16Mhz for SD operation speed
     DBG_PRINTF("Now, SPI is running at %d Hz\n", SPI_GetBusClock(g_pSPI));
 
+    /* Data blocks are moved by PDMA, or by CPU if two channels are not free */
+    if(s_i32RxCh < 0)
+    {
+        s_i32TxCh = PDMA_RequestChannel(PDMA_CH_ANY, NULL);
+        s_i32RxCh = PDMA_RequestChannel(PDMA_CH_ANY, NULL);
+        if((s_i32TxCh < 0) || (s_i32RxCh < 0))
+        {
+            if(s_i32TxCh >= 0)
+                PDMA_ReleaseChannel(s_i32TxCh);
+            s_i32TxCh = -1;
+            s_i32RxCh = -1;
+        }
+    }
+
     return SD_SUCCESS;
 }
 
@@ -623,6 +784,13 @@ uint32_t SDCARD_Open(void)
   */
 void SDCARD_Close(void)
 {
+    if(s_i32RxCh >= 0)
+    {
+        PDMA_ReleaseChannel(s_i32TxCh);
+        PDMA_ReleaseChannel(s_i32RxCh);
+        s_i32TxCh = -1;
+        s_i32RxCh = -1;
+    }
     SPI_Close(g_pSPI);
 }
 
@@ -651,6 +819,46 @@ uint32_t GetLogicSector(void)
     return LogicSector;
 }
 
+/**
+  * @brief This function is used to read data blocks from SD card
+  * @param[in] u32Lba Logical block address of the first block
+  * @param[in] u32Count Number of 512-byte blocks
+  * @param[out] pu8Buf Buffer for the data, word aligned for the fastest CRC check
+  * @retval SD_SUCCESS Success
+  * @retval SD_FAIL Card not initialized, command failed, time-out or CRC error
+  */
+uint32_t SDCARD_ReadBlocks(uint32_t u32Lba, uint32_t u32Count, uint8_t *pu8Buf)
+{
+    if(!Is_Initialized)
+        return SD_FAIL;
+    if(u32Count == 0)
+        return SD_SUCCESS;
+    if(!(SDtype & SDBlock))
+        u32Lba *= PHYSICAL_BLOCK_SIZE;
+
+    return (SD_ReadBlocks(u32Lba, u32Count, pu8Buf) == TRUE) ? SD_SUCCESS : SD_FAIL;
+}
+
+/**
+  * @brief This function is used to write data blocks to SD card
+  * @param[in] u32Lba Logical block address of the first block
+  * @param[in] u32Count Number of 512-byte blocks
+  * @param[in] pu8Buf Data to write, word aligned for the fastest CRC calculation
+  * @retval SD_SUCCESS Success
+  * @retval SD_FAIL Card not initialized, command failed, data rejected or time-out
+  */
+uint32_t SDCARD_WriteBlocks(uint32_t u32Lba, uint32_t u32Count, const uint8_t *pu8Buf)
+{
+    if(!Is_Initialized)
+        return SD_FAIL;
+    if(u32Count == 0)
+        return SD_SUCCESS;
+    if(!(SDtype & SDBlock))
+        u32Lba *= PHYSICAL_BLOCK_SIZE;
+
+    return (SD_WriteBlocks(u32Lba, u32Count, pu8Buf) == TRUE) ? SD_SUCCESS : SD_FAIL;
+}
+
 /**
   * @brief This function is used to Get data from SD card
   * @param[in] addr Set start address for LBA
@@ -661,29 +869,7 @@ uint32_t GetLogicSector(void)
 void SpiRead(uint32_t addr, uint32_t size, uint8_t* buffer)
 {
     /* This is low level read function of USB Mass Storage */
-    uint32_t response;
-    if(SDtype & SDBlock)
-    {
-        while(size >= PHYSICAL_BLOCK_SIZE)
-        {
-            MMC_Command_Exec(READ_SINGLE_BLOCK, addr, buffer, &response);
-            addr   ++;
-            buffer += PHYSICAL_BLOCK_SIZE;
-            size  -= PHYSICAL_BLOCK_SIZE;
-        }
-
-    }
-    else
-    {
-        addr *= PHYSICAL_BLOCK_SIZE;
-        while(size >= PHYSICAL_BLOCK_SIZE)
-        {
-            MMC_Command_Exec(READ_SINGLE_BLOCK, addr, buffer, &response);
-            addr   += PHYSICAL_BLOCK_SIZE;
-            buffer += PHYSICAL_BLOCK_SIZE;
-            size  -= PHYSICAL_BLOCK_SIZE;
-        }
-    }
+    SDCARD_ReadBlocks(addr, size / PHYSICAL_BLOCK_SIZE, buffer);
 }
 
 /**
@@ -695,28 +881,7 @@ void SpiRead(uint32_t addr, uint32_t size, uint8_t* buffer)
   */
 void SpiWrite(uint32_t addr, uint32_t size, uint8_t* buffer)
 {
-    uint32_t response;
-    if(SDtype & SDBlock)
-    {
-        while(size >= PHYSICAL_BLOCK_SIZE)
-        {
-            MMC_Command_Exec(WRITE_BLOCK, addr, buffer, &response);
-            addr   ++;
-            buffer += PHYSICAL_BLOCK_SIZE;
-            size  -= PHYSICAL_BLOCK_SIZE;
-        }
-    }
-    else
-    {
-        addr *= PHYSICAL_BLOCK_SIZE;
-        while(size >= PHYSICAL_BLOCK_SIZE)
-        {
-            MMC_Command_Exec(WRITE_BLOCK, addr, buffer, &response);
-            addr   += (PHYSICAL_BLOCK_SIZE);
-            buffer += PHYSICAL_BLOCK_SIZE;
-            size  -= PHYSICAL_BLOCK_SIZE;
-        }
-    }
+    SDCARD_WriteBlocks(addr, size / PHYSICAL_BLOCK_SIZE, buffer);
 }
 /*@}*/ /* end of group NUC029xGE_SDCARD_EXPORTED_FUNCTIONS */
 
@@ -115,7 +115,7 @@ struct CSW
 
 /*-------------------------------------------------------------*/
 #define MASS_BUFFER_SIZE    256               /* Mass Storage command buffer size */
-#define STORAGE_BUFFER_SIZE 512               /* Data transfer buffer size in 512 bytes alignment */
+#define STORAGE_BUFFER_SIZE 4096              /* Data transfer buffer size in 512 bytes alignment */
 #define UDC_SECTOR_SIZE   512                 /* logic sector size */
 
 extern uint32_t MassBlock[];
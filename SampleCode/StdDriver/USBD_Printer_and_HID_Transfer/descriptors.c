@@ -179,8 +179,8 @@ const uint8_t gu8ConfigDescriptor[] =
     (INT_IN_EP_NUM_1 | EP_INPUT),               /* bEndpointAddress */
     EP_INT,                                     /* bmAttributes */
     /* wMaxPacketSize */
-    EP7_MAX_PKT_SIZE & 0x00FF,
-    (EP7_MAX_PKT_SIZE & 0xFF00) >> 8,
+    EP5_MAX_PKT_SIZE & 0x00FF,
+    (EP5_MAX_PKT_SIZE & 0xFF00) >> 8,
     HID_DEFAULT_INT_IN_INTERVAL,                /* bInterval */
 
     /* EP Descriptor: interrupt out. */
@@ -145,10 +145,14 @@ int32_t main(void)
     printf("+-------------------------------------------------------+\n");
 
     /* Open USB controller */
-    USBD_Open(&gsInfo, PTR_ClassRequest, NULL);
+    USBD_Open(&gsInfo, NULL, NULL);
 
-    /* Endpoint configuration */
-    PTR_Init();
+    /* Register the printer and HID functions, endpoints and buffers are assigned by the USBD driver */
+    if(PTR_Init() < 0)
+    {
+        printf("Error! Fail to configure USB endpoints.\n");
+        return -1;
+    }
     /* Start USB device */
     USBD_Start();
 
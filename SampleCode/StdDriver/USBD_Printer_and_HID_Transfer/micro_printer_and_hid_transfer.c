@@ -16,227 +16,122 @@ uint8_t volatile g_u8Suspend = 0;
 uint8_t g_u8Idle = 0, g_u8Protocol = 0;
 
 /*--------------------------------------------------------------------------*/
-void USBD_IRQHandler(void)
+static void PTR_HID_BusEvent(uint32_t u32State)
 {
-    uint32_t u32IntSts = USBD_GET_INT_FLAG();
-    uint32_t u32State = USBD_GET_BUS_STATE();
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_FLDET)
+    if(u32State & USBD_STATE_USBRST)
     {
-        // Floating detect
-        USBD_CLR_INT_FLAG(USBD_INTSTS_FLDET);
-
-        if(USBD_IS_ATTACHED())
-        {
-            /* USB Plug In */
-            USBD_ENABLE_USB();
-        }
-        else
-        {
-            /* USB Un-plug */
-            USBD_DISABLE_USB();
-        }
+        /* Bus reset */
+        g_u32OutToggle = 0;
+        g_u8Suspend = 0;
     }
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_WAKEUP)
+    if(u32State & USBD_STATE_SUSPEND)
     {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_WAKEUP);
+        /* Enter power down to wait USB attached, the USBD driver has disabled the PHY */
+        g_u8Suspend = 1;
     }
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_BUS)
+    if(u32State & USBD_STATE_RESUME)
     {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_BUS);
+        g_u8Suspend = 0;
+    }
+}
 
-        if(u32State & USBD_STATE_USBRST)
-        {
-            /* Bus reset */
-            USBD_ENABLE_USB();
-            USBD_SwReset();
-            g_u32OutToggle = 0;
-            g_u8Suspend = 0;
-        }
-        if(u32State & USBD_STATE_SUSPEND)
-        {
-            /* Enter power down to wait USB attached */
-            g_u8Suspend = 1;
+void USBD_IRQHandler(void)
+{
+    /* Bus events, control pipe and the endpoint handlers of the registered functions */
+    USBD_EventIRQHandler();
+}
 
-            /* Enable USB but disable PHY */
-            USBD_DISABLE_PHY();
-        }
-        if(u32State & USBD_STATE_RESUME)
-        {
-            /* Enable USB and enable PHY */
-            USBD_ENABLE_USB();
-            g_u8Suspend = 0;
-        }
+void PTR_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
+{
+    if(g_u32OutToggle == (USBD->EPSTS & USBD_EPSTS_EPSTS3_Msk))
+    {
+        USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
     }
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_USB)
+    else
     {
-        // USB event
-        if(u32IntSts & USBD_INTSTS_SETUP)
-        {
-            // Setup packet
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_SETUP);
-
-            /* Clear the data IN/OUT ready flag of control end-points */
-            USBD_STOP_TRANSACTION(EP0);
-            USBD_STOP_TRANSACTION(EP1);
-
-            USBD_ProcessSetupPacket();
-        }
-
-        // EP events
-        if(u32IntSts & USBD_INTSTS_EP0)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP0);
-
-            // control IN
-            USBD_CtrlIn();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP1)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP1);
-
-            // control OUT
-            USBD_CtrlOut();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP2)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP2);
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP3)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP3);
-            if(g_u32OutToggle == (USBD->EPSTS & USBD_EPSTS_EPSTS3_Msk))
-            {
-                USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
-            }
-            else
-            {
-                // Bulk Out -> receive printer data
-                PTR_Data_Receive();
-                g_u32OutToggle = USBD->EPSTS & USBD_EPSTS_EPSTS3_Msk;
-            }
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP4)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP4);
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP5)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP5);
-            // Interrupt IN
-            //EP5_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP6)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP6);
-            // Interrupt OUT
-            EP6_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP7)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP7);
-            // Interrupt IN
-            EP7_Handler();
-        }
+        // Bulk Out -> receive printer data
+        PTR_Data_Receive();
+        g_u32OutToggle = USBD->EPSTS & USBD_EPSTS_EPSTS3_Msk;
     }
-
 }
 
-void EP7_Handler(void)  /* Interrupt IN handler */
+void HID_IntInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)  /* Interrupt IN handler */
 {
     HID_SetInReport();
 }
 
-void EP6_Handler(void)  /* Interrupt OUT handler */
+void HID_IntOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)  /* Interrupt OUT handler */
 {
     uint8_t *ptr;
     /* Interrupt OUT */
-    ptr = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP6));
-    HID_GetOutReport(ptr, USBD_GET_PAYLOAD_LEN(EP6));
-    USBD_SET_PAYLOAD_LEN(EP6, EP6_MAX_PKT_SIZE);
+    ptr = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(u32HwEp));
+    HID_GetOutReport(ptr, USBD_GET_PAYLOAD_LEN(u32HwEp));
+    USBD_SET_PAYLOAD_LEN(u32HwEp, EP6_MAX_PKT_SIZE);
 }
 
 /*--------------------------------------------------------------------------*/
+static void PTR_ClassRequest(S_USBD_FUNC_T *psFunc);
+static void HID_ClassRequest(S_USBD_FUNC_T *psFunc);
+
+/* Printer function: interface 0, bulk IN, bulk OUT and interrupt IN */
+static S_USBD_FUNC_EP_T s_asPtrEp[] =
+{
+    {BULK_IN_EP_NUM | EP_INPUT, NULL},
+    {BULK_OUT_EP_NUM | EP_OUTPUT, PTR_BulkOutHandler},
+    {INT_IN_EP_NUM | EP_INPUT, NULL}
+};
+static S_USBD_FUNC_T s_sPtrFunc = {0, 1, 3, s_asPtrEp, PTR_ClassRequest, NULL, NULL};
+
+/* HID transfer function: interface 1, interrupt IN and OUT */
+static S_USBD_FUNC_EP_T s_asHidEp[] =
+{
+    {INT_IN_EP_NUM_1 | EP_INPUT, HID_IntInHandler},
+    {INT_OUT_EP_NUM | EP_OUTPUT, HID_IntOutHandler}
+};
+static S_USBD_FUNC_T s_sHidFunc = {1, 1, 2, s_asHidEp, HID_ClassRequest, NULL, NULL};
+
 /**
-  * @brief  USBD Endpoint Config.
+  * @brief  Register the printer and HID transfer functions.
   * @param  None.
-  * @retval None.
+  * @retval 0 Success.
+  * @retval -1 Endpoints or endpoint buffers cannot be assigned.
   */
-void PTR_Init(void)
+int32_t PTR_Init(void)
 {
-    /* Init setup packet buffer */
-    /* Buffer for setup packet -> [0 ~ 0x7] */
-    USBD->STBUFSEG = SETUP_BUF_BASE;
-
-    /*****************************************************/
-    /* EP0 ==> control IN endpoint, address 0 */
-    USBD_CONFIG_EP(EP0, USBD_CFG_CSTALL | USBD_CFG_EPMODE_IN | 0);
-    /* Buffer range for EP0 */
-    USBD_SET_EP_BUF_ADDR(EP0, EP0_BUF_BASE);
-
-    /* EP1 ==> control OUT endpoint, address 0 */
-    USBD_CONFIG_EP(EP1, USBD_CFG_CSTALL | USBD_CFG_EPMODE_OUT | 0);
-    /* Buffer range for EP1 */
-    USBD_SET_EP_BUF_ADDR(EP1, EP1_BUF_BASE);
-
-    /*****************************************************/
-    /* EP2 ==> Bulk IN endpoint, address 1 */
-    USBD_CONFIG_EP(EP2, USBD_CFG_EPMODE_IN | BULK_IN_EP_NUM);
-    /* Buffer offset for EP2 */
-    USBD_SET_EP_BUF_ADDR(EP2, EP2_BUF_BASE);
-
-    /* EP3 ==> Bulk Out endpoint, address 2 */
-    USBD_CONFIG_EP(EP3, USBD_CFG_EPMODE_OUT | BULK_OUT_EP_NUM);
-    /* Buffer offset for EP3 */
-    USBD_SET_EP_BUF_ADDR(EP3, EP3_BUF_BASE);
-    /* trigger receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
+    /* The USBD driver assigns hardware endpoints in registration order: the printer gets EP2/EP3/EP4 and HID
+       gets EP5/EP6, which the transfer code below uses directly. Buffers are packed after the control pipe. */
+    if(USBD_RegisterFunction(&s_sPtrFunc) < 0)
+        return -1;
+    if(USBD_RegisterFunction(&s_sHidFunc) < 0)
+        return -1;
+    USBD_SetBusHandler(PTR_HID_BusEvent);
+
+    return 0;
+}
 
-    /* EP4 ==> Interrupt IN endpoint, address 3 */
-    USBD_CONFIG_EP(EP4, USBD_CFG_EPMODE_IN | INT_IN_EP_NUM);
-    /* Buffer offset for EP4 ->  */
-    USBD_SET_EP_BUF_ADDR(EP4, EP4_BUF_BASE);
-
-    /*****************************************************/
-    /* EP7 ==> Interrupt IN endpoint, address 6 */
-    USBD_CONFIG_EP(EP7, USBD_CFG_EPMODE_IN | INT_IN_EP_NUM_1);
-    /* Buffer range for EP7 */
-    USBD_SET_EP_BUF_ADDR(EP7, EP7_BUF_BASE);
-
-    /* EP6 ==> Interrupt OUT endpoint, address 5 */
-    USBD_CONFIG_EP(EP6, USBD_CFG_EPMODE_OUT | INT_OUT_EP_NUM);
-    /* Buffer range for EP6 */
-    USBD_SET_EP_BUF_ADDR(EP6, EP6_BUF_BASE);
-    /* trigger to receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP6, EP6_MAX_PKT_SIZE);
+static void PTR_ClassRequest(S_USBD_FUNC_T *psFunc)
+{
+    uint8_t buf[8];
+
+    USBD_GetSetupPacket(buf);
+
+    if((buf[0] & 0x80) && (buf[1] == GET_PORT_STATUS))
+    {
+        /* Data stage */
+        USBD_SET_DATA1(EP0);
+        USBD_SET_PAYLOAD_LEN(EP0, 0);
+        /* Status stage */
+        USBD_PrepareCtrlOut(0, 0);
+    }
+    else
+    {
+        /* Setup error, stall the device */
+        USBD_SetStall(EP0);
+        USBD_SetStall(EP1);
+    }
 }
 
-void PTR_ClassRequest(void)
+static void HID_ClassRequest(S_USBD_FUNC_T *psFunc)
 {
     uint8_t buf[8];
 
@@ -247,15 +142,6 @@ void PTR_ClassRequest(void)
         // Device to host
         switch(buf[1])
         {
-            case GET_PORT_STATUS:
-            {
-                /* Data stage */
-                USBD_SET_DATA1(EP0);
-                USBD_SET_PAYLOAD_LEN(EP0, 0);
-                /* Status stage */
-                USBD_PrepareCtrlOut(0, 0);
-                break;
-            }
             case GET_IDLE:
                 USBD_SET_PAYLOAD_LEN(EP1, buf[6]);
                 /* Data stage */
@@ -406,9 +292,9 @@ int32_t HID_CmdReadPages(CMD_T *pCmd)
         pCmd->u32Signature = 1;
 
         /* Trigger HID IN */
-        USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP7)), (void *)g_u8PageBuff, EP7_MAX_PKT_SIZE);
-        USBD_SET_PAYLOAD_LEN(EP7, EP7_MAX_PKT_SIZE);
-        g_u32BytesInPageBuf -= EP7_MAX_PKT_SIZE;
+        USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP5)), (void *)g_u8PageBuff, EP5_MAX_PKT_SIZE);
+        USBD_SET_PAYLOAD_LEN(EP5, EP5_MAX_PKT_SIZE);
+        g_u32BytesInPageBuf -= EP5_MAX_PKT_SIZE;
     }
 
     return 0;
@@ -622,10 +508,10 @@ void HID_SetInReport(void)
             }
 
             /* Prepare the data for next HID IN transfer */
-            ptr = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP7));
-            USBD_MemCopy(ptr, (void *)&g_u8PageBuff[PAGE_SIZE - g_u32BytesInPageBuf], EP7_MAX_PKT_SIZE);
-            USBD_SET_PAYLOAD_LEN(EP7, EP7_MAX_PKT_SIZE);
-            g_u32BytesInPageBuf -= EP7_MAX_PKT_SIZE;
+            ptr = (uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP5));
+            USBD_MemCopy(ptr, (void *)&g_u8PageBuff[PAGE_SIZE - g_u32BytesInPageBuf], EP5_MAX_PKT_SIZE);
+            USBD_SET_PAYLOAD_LEN(EP5, EP5_MAX_PKT_SIZE);
+            g_u32BytesInPageBuf -= EP5_MAX_PKT_SIZE;
         }
     }
 
@@ -44,25 +44,10 @@
 #define EP3_MAX_PKT_SIZE    64
 #define EP4_MAX_PKT_SIZE    8
 
+#define EP5_MAX_PKT_SIZE    64
 #define EP6_MAX_PKT_SIZE    64
-#define EP7_MAX_PKT_SIZE    64
-
-#define SETUP_BUF_BASE      0
-#define SETUP_BUF_LEN       8
-#define EP0_BUF_BASE        (SETUP_BUF_BASE + SETUP_BUF_LEN)
-#define EP0_BUF_LEN         EP0_MAX_PKT_SIZE
-#define EP1_BUF_BASE        (SETUP_BUF_BASE + SETUP_BUF_LEN)
-#define EP1_BUF_LEN         EP1_MAX_PKT_SIZE
-#define EP2_BUF_BASE        (EP1_BUF_BASE + EP1_BUF_LEN)
-#define EP2_BUF_LEN         EP2_MAX_PKT_SIZE
-#define EP3_BUF_BASE        (EP2_BUF_BASE + EP2_BUF_LEN)
-#define EP3_BUF_LEN         EP3_MAX_PKT_SIZE
-#define EP4_BUF_BASE        (EP3_BUF_BASE + EP3_BUF_LEN)
-#define EP4_BUF_LEN         EP4_MAX_PKT_SIZE
-#define EP7_BUF_BASE        (EP4_BUF_BASE + EP4_BUF_LEN)
-#define EP7_BUF_LEN         EP7_MAX_PKT_SIZE
-#define EP6_BUF_BASE        (EP7_BUF_BASE + EP7_BUF_LEN)
-#define EP6_BUF_LEN         EP6_MAX_PKT_SIZE
+
+/* Endpoint buffers are assigned by USBD_RegisterFunction() */
 
 /* Define the interrupt In EP number */
 #define BULK_IN_EP_NUM      0x01
@@ -82,12 +67,12 @@
 
 
 /*-------------------------------------------------------------*/
-void PTR_Init(void);
-void PTR_ClassRequest(void);
+int32_t PTR_Init(void);
 void PTR_Data_Receive(void);
 
-void EP7_Handler(void);
-void EP6_Handler(void);
+void PTR_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void HID_IntInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void HID_IntOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
 void HID_SetInReport(void);
 void HID_GetOutReport(uint8_t *pu8EpBuf, uint32_t u32Size);
 
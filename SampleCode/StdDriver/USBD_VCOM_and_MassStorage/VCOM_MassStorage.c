@@ -26,7 +26,7 @@ int32_t g_TotalSectors = 0;
 uint32_t volatile g_u32OutToggle0 = 0;
 uint32_t volatile g_u32OutToggle = 0, g_u32OutSkip = 0;
 
-uint8_t volatile g_u8EP7Ready = 0;
+uint8_t volatile g_u8EP5Ready = 0;
 uint8_t volatile g_u8EP6Ready = 0;
 uint8_t volatile g_u8Remove = 0;
 
@@ -100,164 +100,43 @@ static uint8_t g_au8ModePage_1C[8] =
 };
 
 
-void USBD_IRQHandler(void)
+static void VCOM_MSC_BusEvent(uint32_t u32State)
 {
-    uint32_t u32IntSts = USBD_GET_INT_FLAG();
-    uint32_t u32State = USBD_GET_BUS_STATE();
-
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_FLDET)
-    {
-        // Floating detect
-        USBD_CLR_INT_FLAG(USBD_INTSTS_FLDET);
-
-        if(USBD_IS_ATTACHED())
-        {
-            /* USB Plug In */
-            USBD_ENABLE_USB();
-        }
-        else
-        {
-            /* USB Un-plug */
-            USBD_DISABLE_USB();
-        }
-    }
+    extern void FlashCacheFlush(void);
 
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_WAKEUP)
+    if(u32State & USBD_STATE_USBRST)
     {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_WAKEUP);
+        /* Bus reset */
+        g_u32OutToggle0 = g_u32OutToggle = g_u32OutSkip = 0;
+        DBG_PRINTF("Bus reset\n");
     }
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_BUS)
+    if(u32State & USBD_STATE_SUSPEND)
     {
-        /* Clear event flag */
-        USBD_CLR_INT_FLAG(USBD_INTSTS_BUS);
-
-        if(u32State & USBD_STATE_USBRST)
-        {
-            /* Bus reset */
-            USBD_ENABLE_USB();
-            USBD_SwReset();
-            g_u32OutToggle0 = g_u32OutToggle = g_u32OutSkip = 0;
-            DBG_PRINTF("Bus reset\n");
-        }
-        if(u32State & USBD_STATE_SUSPEND)
-        {
-            extern void FlashCacheFlush(void);
+        /* The USBD driver has disabled the PHY */
+        FlashCacheFlush();
 
-            /* Enable USB but disable PHY */
-            USBD_DISABLE_PHY();
-
-            FlashCacheFlush();
-
-            DBG_PRINTF("Suspend\n");
-        }
-        if(u32State & USBD_STATE_RESUME)
-        {
-            /* Enable USB and enable PHY */
-            USBD_ENABLE_USB();
-            DBG_PRINTF("Resume\n");
-        }
+        DBG_PRINTF("Suspend\n");
     }
-
-//------------------------------------------------------------------
-    if(u32IntSts & USBD_INTSTS_USB)
+    if(u32State & USBD_STATE_RESUME)
     {
-
-        // EP events
-        if(u32IntSts & USBD_INTSTS_EP0)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP0);
-            // control IN
-            USBD_CtrlIn();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP1)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP1);
-
-            // control OUT
-            USBD_CtrlOut();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP2)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP2);
-            // Bulk IN
-            EP2_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP3)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP3);
-            // Bulk OUT
-            EP3_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP4)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP4);
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP5)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP5);
-            // Bulk IN
-            //EP5_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP6)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP6);
-            // Bulk OUT
-            EP6_Handler();
-        }
-
-        if(u32IntSts & USBD_INTSTS_EP7)
-        {
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_EP7);
-            // Bulk IN
-            EP7_Handler();
-        }
-
-        // USB event
-        if(u32IntSts & USBD_INTSTS_SETUP)
-        {
-            // Setup packet
-            /* Clear event flag */
-            USBD_CLR_INT_FLAG(USBD_INTSTS_SETUP);
-
-            /* Clear the data IN/OUT ready flag of control end-points */
-            USBD_STOP_TRANSACTION(EP0);
-            USBD_STOP_TRANSACTION(EP1);
-
-            USBD_ProcessSetupPacket();
-        }
-
+        DBG_PRINTF("Resume\n");
     }
+}
 
+void USBD_IRQHandler(void)
+{
+    /* Bus events, control pipe and the endpoint handlers of the registered functions */
+    USBD_EventIRQHandler();
 }
 
 
-void EP2_Handler(void)
+void VCOM_BulkInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
 {
     gu32TxSize = 0;
 }
 
 
-void EP3_Handler(void)
+void VCOM_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
 {
     /* Bulk OUT */
     if(g_u32OutToggle0 == (USBD->EPSTS & USBD_EPSTS_EPSTS3_Msk))
@@ -275,14 +154,14 @@ void EP3_Handler(void)
     }
 }
 
-void EP7_Handler(void)
+void MSC_BulkInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
 {
-    g_u8EP7Ready = 1;
+    g_u8EP5Ready = 1;
     MSC_AckCmd();
 }
 
 
-void EP6_Handler(void)
+void MSC_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp)
 {
     /* Bulk OUT */
     if((g_u32OutToggle == (USBD->EPSTS & USBD_EPSTS_EPSTS6_Msk)) && !g_u32CbwStall)
@@ -301,63 +180,47 @@ void EP6_Handler(void)
 }
 
 
-void VCOM_MSC_Init(void)
+static void VCOM_ClassRequest(S_USBD_FUNC_T *psFunc);
+static void MSC_ClassRequest(S_USBD_FUNC_T *psFunc);
+
+/* VCOM function: interfaces 0 and 1, bulk IN, bulk OUT and interrupt IN */
+static S_USBD_FUNC_EP_T s_asVcomEp[] =
+{
+    {BULK_IN_EP_NUM | EP_INPUT, VCOM_BulkInHandler},
+    {BULK_OUT_EP_NUM | EP_OUTPUT, VCOM_BulkOutHandler},
+    {INT_IN_EP_NUM | EP_INPUT, NULL}
+};
+static S_USBD_FUNC_T s_sVcomFunc = {0, 2, 3, s_asVcomEp, VCOM_ClassRequest, NULL, NULL};
+
+/* Mass storage function: interface 2, bulk IN and OUT */
+static S_USBD_FUNC_EP_T s_asMscEp[] =
+{
+    {BULK_IN_EP_NUM_1 | EP_INPUT, MSC_BulkInHandler},
+    {BULK_OUT_EP_NUM_1 | EP_OUTPUT, MSC_BulkOutHandler}
+};
+static S_USBD_FUNC_T s_sMscFunc = {2, 1, 2, s_asMscEp, MSC_ClassRequest, NULL, MSC_SetConfig};
+
+int32_t VCOM_MSC_Init(void)
 {
-    /* Init setup packet buffer */
-    /* Buffer range for SETUP packet -> [0 ~ 0x7] */
-    USBD->STBUFSEG = SETUP_BUF_BASE;
-
-    /*****************************************************/
-    /* EP0 ==> control IN endpoint, address 0 */
-    USBD_CONFIG_EP(EP0, USBD_CFG_CSTALL | USBD_CFG_EPMODE_IN | 0);
-    /* Buffer range for EP0 */
-    USBD_SET_EP_BUF_ADDR(EP0, EP0_BUF_BASE);
-
-    /* EP1 ==> control OUT endpoint, address 0 */
-    USBD_CONFIG_EP(EP1, USBD_CFG_CSTALL | USBD_CFG_EPMODE_OUT | 0);
-    /* Buffer range for EP1 */
-    USBD_SET_EP_BUF_ADDR(EP1, EP1_BUF_BASE);
-
-    /*****************************************************/
-    /* EP2 ==> Bulk IN endpoint, address 1 */
-    USBD_CONFIG_EP(EP2, USBD_CFG_EPMODE_IN | BULK_IN_EP_NUM);
-    /* Buffer range for EP2 */
-    USBD_SET_EP_BUF_ADDR(EP2, EP2_BUF_BASE);
-
-    /* EP3 ==> Bulk Out endpoint, address 2 */
-    USBD_CONFIG_EP(EP3, USBD_CFG_EPMODE_OUT | BULK_OUT_EP_NUM);
-    /* Buffer range for EP3 */
-    USBD_SET_EP_BUF_ADDR(EP3, EP3_BUF_BASE);
-    /* trigger to receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP3, EP3_MAX_PKT_SIZE);
-
-    /* EP4 ==> Interrupt IN endpoint, address 3 */
-    USBD_CONFIG_EP(EP4, USBD_CFG_EPMODE_IN | INT_IN_EP_NUM);
-    /* Buffer range for EP4 ->  */
-    USBD_SET_EP_BUF_ADDR(EP4, EP4_BUF_BASE);
-
-    /*****************************************************/
-    /* EP7 ==> Bulk IN endpoint, address 6 */
-    USBD_CONFIG_EP(EP7, USBD_CFG_EPMODE_IN | BULK_IN_EP_NUM_1);
-    /* Buffer range for EP7 */
-    USBD_SET_EP_BUF_ADDR(EP7, EP7_BUF_BASE);
-
-    /* EP6 ==> Bulk Out endpoint, address 5 */
-    USBD_CONFIG_EP(EP6, USBD_CFG_EPMODE_OUT | BULK_OUT_EP_NUM_1);
-    /* Buffer range for EP6 */
-    USBD_SET_EP_BUF_ADDR(EP6, EP6_BUF_BASE);
-    /* trigger to receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP6, EP6_MAX_PKT_SIZE);
-
-    /*****************************************************/
-    g_u32BulkBuf0 = EP6_BUF_BASE;
-    g_u32BulkBuf1 = EP7_BUF_BASE;
+    /* The USBD driver assigns hardware endpoints in registration order: VCOM gets EP2/EP3/EP4 and MSC gets
+       EP5/EP6, which the transfer code below uses directly. Buffers are packed after the control pipe. */
+    if(USBD_RegisterFunction(&s_sVcomFunc) < 0)
+        return -1;
+    if(USBD_RegisterFunction(&s_sMscFunc) < 0)
+        return -1;
+    USBD_SetBusHandler(VCOM_MSC_BusEvent);
+
+    /* MSC swaps the two bulk buffers between EP5 and EP6 */
+    g_u32BulkBuf0 = s_asMscEp[1].u32BufSeg;
+    g_u32BulkBuf1 = s_asMscEp[0].u32BufSeg;
 
     g_sCSW.dCSWSignature = CSW_SIGNATURE;
     g_TotalSectors = DATA_FLASH_STORAGE_SIZE / UDC_SECTOR_SIZE;
+
+    return 0;
 }
 
-void VCOM_MSC_ClassRequest(void)
+static void VCOM_ClassRequest(S_USBD_FUNC_T *psFunc)
 {
     uint8_t buf[8];
 
@@ -381,32 +244,11 @@ void VCOM_MSC_ClassRequest(void)
                 USBD_PrepareCtrlOut(0, 0);
                 break;
             }
-            case GET_MAX_LUN:
-            {
-                /* Check interface number with cfg descriptor and check wValue = 0, wLength = 1 */
-                if((buf[4] == gsInfo.gu8ConfigDesc[LEN_CONFIG + 2]) && (buf[2] + buf[3] + buf[6] + buf[7] == 1))
-                {
-                    M8(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0)) = 0;
-                    /* Data stage */
-                    USBD_SET_DATA1(EP0);
-                    USBD_SET_PAYLOAD_LEN(EP0, 1);
-                    /* Status stage */
-                    USBD_PrepareCtrlOut(0, 0);
-                }
-                else
-                {
-                    USBD_SET_EP_STALL(EP1); // Stall when wrong parameter
-                }
-
-                g_u32OutToggle = 0;
-                USBD_SET_DATA0(EP7);
-                break;
-            }
             default:
             {
                 /* Setup error, stall the device */
                 USBD_SetStall(0);
-                DBG_PRINTF("Unknown MSC req(0x%x). stall ctrl pipe\n", buf[1]);
+                DBG_PRINTF("Unknown VCOM req(0x%x). stall ctrl pipe\n", buf[1]);
                 break;
             }
         }
@@ -444,56 +286,79 @@ void VCOM_MSC_ClassRequest(void)
                     VCOM_LineCoding(0);
                 break;
             }
-            case BULK_ONLY_MASS_STORAGE_RESET:
-            {
-                /* Check interface number with cfg descriptor and check wValue = 0, wLength = 0 */
-                //if((buf[4] == gsInfo.gu8ConfigDesc[LEN_CONFIG + 2]) && (buf[2] + buf[3] + buf[6] + buf[7] == 0))
-                if(buf[4] == 0x02)
-                {
-                    USBD_SET_DATA1(EP0);
-                    USBD_SET_PAYLOAD_LEN(EP0, 0);
-
-                    g_u32Length = 0; // Reset all read/write data transfer
-                    USBD_LockEpStall(0);
-
-                    /* Clear ready */
-                    USBD->EP[EP7].CFGP |= USBD_CFGP_CLRRDY_Msk;
-                    USBD->EP[EP6].CFGP |= USBD_CFGP_CLRRDY_Msk;
-                    USBD_SET_DATA0(EP7);
-
-                    /* Prepare to receive the CBW */
-
-                    g_u8EP6Ready = 0;
-                    g_u8BulkState = BULK_CBW;
-
-                    USBD_SET_DATA1(EP6);
-                    USBD_SET_EP_BUF_ADDR(EP6, g_u32BulkBuf0);
-                    USBD_SET_PAYLOAD_LEN(EP6, 31);
-
-                    /* Status stage */
-                    USBD_SET_DATA1(EP0);
-                    USBD_SET_PAYLOAD_LEN(EP0, 0);
-                }
-                else
-                {
-                    /* Stall when wrong parameter */
-                    USBD_SET_EP_STALL(EP1);
-                }
-
-                break;
-            }
             default:
             {
                 // Stall
                 /* Setup error, stall the device */
                 USBD_SetStall(0);
-                DBG_PRINTF("Unknown MSC req (0x%x). stall ctrl pipe\n", buf[1]);
+                DBG_PRINTF("Unknown VCOM req (0x%x). stall ctrl pipe\n", buf[1]);
                 break;
             }
         }
     }
 }
 
+static void MSC_ClassRequest(S_USBD_FUNC_T *psFunc)
+{
+    uint8_t buf[8];
+
+    USBD_GetSetupPacket(buf);
+
+    /* The USBD driver only routes requests for the MSC interface here */
+    if((buf[0] & EP_INPUT) && (buf[1] == GET_MAX_LUN))
+    {
+        /* Check wValue = 0, wLength = 1 */
+        if(buf[2] + buf[3] + buf[6] + buf[7] == 1)
+        {
+            M8(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0)) = 0;
+            /* Data stage */
+            USBD_SET_DATA1(EP0);
+            USBD_SET_PAYLOAD_LEN(EP0, 1);
+            /* Status stage */
+            USBD_PrepareCtrlOut(0, 0);
+        }
+        else
+        {
+            USBD_SET_EP_STALL(EP1); // Stall when wrong parameter
+        }
+
+        g_u32OutToggle = 0;
+        USBD_SET_DATA0(EP5);
+    }
+    else if(!(buf[0] & EP_INPUT) && (buf[1] == BULK_ONLY_MASS_STORAGE_RESET) && (buf[2] + buf[3] + buf[6] + buf[7] == 0))
+    {
+        USBD_SET_DATA1(EP0);
+        USBD_SET_PAYLOAD_LEN(EP0, 0);
+
+        g_u32Length = 0; // Reset all read/write data transfer
+        USBD_LockEpStall(0);
+
+        /* Clear ready */
+        USBD->EP[EP5].CFGP |= USBD_CFGP_CLRRDY_Msk;
+        USBD->EP[EP6].CFGP |= USBD_CFGP_CLRRDY_Msk;
+        USBD_SET_DATA0(EP5);
+
+        /* Prepare to receive the CBW */
+
+        g_u8EP6Ready = 0;
+        g_u8BulkState = BULK_CBW;
+
+        USBD_SET_DATA1(EP6);
+        USBD_SET_EP_BUF_ADDR(EP6, g_u32BulkBuf0);
+        USBD_SET_PAYLOAD_LEN(EP6, 31);
+
+        /* Status stage */
+        USBD_SET_DATA1(EP0);
+        USBD_SET_PAYLOAD_LEN(EP0, 0);
+    }
+    else
+    {
+        /* Setup error, stall the device */
+        USBD_SetStall(0);
+        DBG_PRINTF("Unknown MSC req (0x%x). stall ctrl pipe\n", buf[1]);
+    }
+}
+
 void VCOM_LineCoding(uint8_t port)
 {
     uint32_t u32Reg, u32Tmp, u32Baudrate, u32SysTmp;
@@ -584,7 +449,7 @@ void MSC_RequestSense(void)
     tmp[7] = 0x0a;
     tmp[12] = g_au8SenseKey[1];
     tmp[13] = g_au8SenseKey[2];
-    USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP7)), tmp, 20);
+    USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP5)), tmp, 20);
 
     g_au8SenseKey[0] = 0;
     g_au8SenseKey[1] = 0;
@@ -639,13 +504,13 @@ void MSC_Read(void)
 {
     uint32_t u32Len;
 
-    if(USBD_GET_EP_BUF_ADDR(EP7) == g_u32BulkBuf1)
-        USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf0);
+    if(USBD_GET_EP_BUF_ADDR(EP5) == g_u32BulkBuf1)
+        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf0);
     else
-        USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf1);
+        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf1);
 
     /* Trigger to send out the data packet */
-    USBD_SET_PAYLOAD_LEN(EP7, g_u8Size);
+    USBD_SET_PAYLOAD_LEN(EP5, g_u8Size);
 
     g_u32Length -= g_u8Size;
     g_u32BytesInStorageBuf -= g_u8Size;
@@ -655,11 +520,11 @@ void MSC_Read(void)
         if(g_u32BytesInStorageBuf)
         {
             /* Prepare next data packet */
-            g_u8Size = EP7_MAX_PKT_SIZE;
+            g_u8Size = EP5_MAX_PKT_SIZE;
             if(g_u8Size > g_u32Length)
                 g_u8Size = g_u32Length;
 
-            if(USBD_GET_EP_BUF_ADDR(EP7) == g_u32BulkBuf1)
+            if(USBD_GET_EP_BUF_ADDR(EP5) == g_u32BulkBuf1)
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
             else
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
@@ -677,11 +542,11 @@ void MSC_Read(void)
             g_u32Address = STORAGE_DATA_BUF;
 
             /* Prepare next data packet */
-            g_u8Size = EP7_MAX_PKT_SIZE;
+            g_u8Size = EP5_MAX_PKT_SIZE;
             if(g_u8Size > g_u32Length)
                 g_u8Size = g_u32Length;
 
-            if(USBD_GET_EP_BUF_ADDR(EP7) == g_u32BulkBuf1)
+            if(USBD_GET_EP_BUF_ADDR(EP5) == g_u32BulkBuf1)
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
             else
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
@@ -699,11 +564,11 @@ void MSC_ReadTrig(void)
         if(g_u32BytesInStorageBuf)
         {
             /* Prepare next data packet */
-            g_u8Size = EP7_MAX_PKT_SIZE;
+            g_u8Size = EP5_MAX_PKT_SIZE;
             if(g_u8Size > g_u32Length)
                 g_u8Size = g_u32Length;
 
-            if(USBD_GET_EP_BUF_ADDR(EP7) == g_u32BulkBuf1)
+            if(USBD_GET_EP_BUF_ADDR(EP5) == g_u32BulkBuf1)
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
             else
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
@@ -721,11 +586,11 @@ void MSC_ReadTrig(void)
             g_u32Address = STORAGE_DATA_BUF;
 
             /* Prepare next data packet */
-            g_u8Size = EP7_MAX_PKT_SIZE;
+            g_u8Size = EP5_MAX_PKT_SIZE;
             if(g_u8Size > g_u32Length)
                 g_u8Size = g_u32Length;
 
-            if(USBD_GET_EP_BUF_ADDR(EP7) == g_u32BulkBuf1)
+            if(USBD_GET_EP_BUF_ADDR(EP5) == g_u32BulkBuf1)
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf0), (uint8_t *)g_u32Address, g_u8Size);
             else
                 USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
@@ -733,20 +598,20 @@ void MSC_ReadTrig(void)
         }
 
         /* DATA0/DATA1 Toggle */
-        if(USBD_GET_EP_BUF_ADDR(EP7) == g_u32BulkBuf1)
-            USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf0);
+        if(USBD_GET_EP_BUF_ADDR(EP5) == g_u32BulkBuf1)
+            USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf0);
         else
-            USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf1);
+            USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf1);
 
         /* Trigger to send out the data packet */
-        USBD_SET_PAYLOAD_LEN(EP7, g_u8Size);
+        USBD_SET_PAYLOAD_LEN(EP5, g_u8Size);
 
         g_u32Length -= g_u8Size;
         g_u32BytesInStorageBuf -= g_u8Size;
 
     }
     else
-        USBD_SET_PAYLOAD_LEN(EP7, 0);
+        USBD_SET_PAYLOAD_LEN(EP5, 0);
 }
 
 
@@ -941,10 +806,10 @@ void MSC_ProcessCmd(void)
             {
                 /* Invalid CBW */
                 g_u8Prevent = 1;
-                USBD_SET_EP_STALL(EP7);
+                USBD_SET_EP_STALL(EP5);
                 USBD_SET_EP_STALL(EP6);
                 g_u32CbwStall = 1;
-                USBD_LockEpStall((1 << EP7) | (1 << EP6));
+                USBD_LockEpStall((1 << EP5) | (1 << EP6));
                 return;
             }
 
@@ -1032,7 +897,7 @@ void MSC_ProcessCmd(void)
                         MSC_RequestSense();
                         /* CV Test must consider reserved bits.
                            Devices shall be capable of returning at least 18 bytes of data in response to a REQUEST SENSE command. */
-                        USBD_SET_PAYLOAD_LEN(EP7, Hcount);
+                        USBD_SET_PAYLOAD_LEN(EP5, Hcount);
                         g_u8BulkState = BULK_IN;
                         g_sCSW.bCSWStatus = 0;
                         g_sCSW.dCSWDataResidue = 0;
@@ -1040,12 +905,12 @@ void MSC_ProcessCmd(void)
                     }
                     else
                     {
-                        USBD_SET_EP_STALL(EP7);
+                        USBD_SET_EP_STALL(EP5);
                         g_u8Prevent = 1;
                         g_sCSW.bCSWStatus = 0x01;
                         g_sCSW.dCSWDataResidue = 0;
                         g_u8BulkState = BULK_IN;
-                        USBD_SET_DATA0(EP7);
+                        USBD_SET_DATA0(EP5);
                         MSC_AckCmd();
                         return;
                     }
@@ -1061,8 +926,8 @@ void MSC_ProcessCmd(void)
                     g_u8BulkState = BULK_IN;
                     if(g_u32Length > 0)
                     {
-                        if(g_u32Length > EP7_MAX_PKT_SIZE)
-                            g_u8Size = EP7_MAX_PKT_SIZE;
+                        if(g_u32Length > EP5_MAX_PKT_SIZE)
+                            g_u8Size = EP5_MAX_PKT_SIZE;
                         else
                             g_u8Size = g_u32Length;
 
@@ -1070,7 +935,7 @@ void MSC_ProcessCmd(void)
                         USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
 
                         g_u32Address += g_u8Size;
-                        USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf0);
+                        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf0);
                         MSC_Read();
                     }
                     return;
@@ -1087,8 +952,8 @@ void MSC_ProcessCmd(void)
                     g_u8BulkState = BULK_IN;
                     if(g_u32Length > 0)
                     {
-                        if(g_u32Length > EP7_MAX_PKT_SIZE)
-                            g_u8Size = EP7_MAX_PKT_SIZE;
+                        if(g_u32Length > EP5_MAX_PKT_SIZE)
+                            g_u8Size = EP5_MAX_PKT_SIZE;
                         else
                             g_u8Size = g_u32Length;
 
@@ -1096,7 +961,7 @@ void MSC_ProcessCmd(void)
                         USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_u32Address, g_u8Size);
 
                         g_u32Address += g_u8Size;
-                        USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf0);
+                        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf0);
                         MSC_Read();
                     }
                     return;
@@ -1127,7 +992,7 @@ void MSC_ProcessCmd(void)
                     *(uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1 + 2) = 0x0;
                     *(uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1 + 3) = 0x0;
 
-                    USBD_SET_PAYLOAD_LEN(EP7, 4);
+                    USBD_SET_PAYLOAD_LEN(EP5, 4);
                     g_u8BulkState = BULK_IN;
                     g_sCSW.bCSWStatus = 0;
                     g_sCSW.dCSWDataResidue = Hcount - 4;;
@@ -1145,8 +1010,8 @@ void MSC_ProcessCmd(void)
                     g_u8BulkState = BULK_IN;
                     if(g_u32Length > 0)
                     {
-                        if(g_u32Length > EP7_MAX_PKT_SIZE)
-                            g_u8Size = EP7_MAX_PKT_SIZE;
+                        if(g_u32Length > EP5_MAX_PKT_SIZE)
+                            g_u8Size = EP5_MAX_PKT_SIZE;
                         else
                             g_u8Size = g_u32Length;
                         /* Bulk IN buffer */
@@ -1154,7 +1019,7 @@ void MSC_ProcessCmd(void)
 
                         g_u32Address += g_u8Size;
 
-                        USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf0);
+                        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf0);
                         MSC_Read();
                     }
                     return;
@@ -1166,16 +1031,16 @@ void MSC_ProcessCmd(void)
                         g_u8Prevent = 1;
                         g_sCSW.dCSWDataResidue = Hcount;
                         g_sCSW.bCSWStatus = 0x1;
-                        USBD_SET_EP_STALL(EP7);
+                        USBD_SET_EP_STALL(EP5);
                         g_u8BulkState = BULK_IN;
-                        USBD_SET_DATA0(EP7);
+                        USBD_SET_DATA0(EP5);
                         MSC_AckCmd();
                     }
                     else
                     {
                         /* Bulk IN buffer */
                         USBD_MemCopy((uint8_t *)((uint32_t)USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)g_au8InquiryID, Hcount);
-                        USBD_SET_PAYLOAD_LEN(EP7, Hcount);
+                        USBD_SET_PAYLOAD_LEN(EP5, Hcount);
 
                         g_u8BulkState = BULK_IN;
                         g_sCSW.bCSWStatus = 0;
@@ -1254,8 +1119,8 @@ void MSC_ProcessCmd(void)
                     if(g_u32BytesInStorageBuf > 0)
                     {
                         /* Set the packet size */
-                        if(g_u32BytesInStorageBuf > EP7_MAX_PKT_SIZE)
-                            g_u8Size = EP7_MAX_PKT_SIZE;
+                        if(g_u32BytesInStorageBuf > EP5_MAX_PKT_SIZE)
+                            g_u8Size = EP5_MAX_PKT_SIZE;
                         else
                             g_u8Size = g_u32BytesInStorageBuf;
 
@@ -1265,9 +1130,9 @@ void MSC_ProcessCmd(void)
                         g_u32Address += g_u8Size;
 
                         /* kick - start */
-                        USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf1);
+                        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf1);
                         /* Trigger to send out the data packet */
-                        USBD_SET_PAYLOAD_LEN(EP7, g_u8Size);
+                        USBD_SET_PAYLOAD_LEN(EP5, g_u8Size);
                         g_u32Length -= g_u8Size;
                         g_u32BytesInStorageBuf -= g_u8Size;
                     }
@@ -1313,9 +1178,9 @@ void MSC_ProcessCmd(void)
                             g_u8Prevent = 1;
                             g_sCSW.dCSWDataResidue = Hcount;
                             g_sCSW.bCSWStatus = 0x1;
-                            USBD_SET_EP_STALL(EP7);
+                            USBD_SET_EP_STALL(EP5);
                             g_u8BulkState = BULK_IN;
-                            USBD_SET_DATA0(EP7);
+                            USBD_SET_DATA0(EP5);
                             MSC_AckCmd();
                             return;
                         }
@@ -1330,13 +1195,13 @@ void MSC_ProcessCmd(void)
                 }
                 case UFI_READ_16:
                 {
-                    USBD_SET_EP_STALL(EP7);
+                    USBD_SET_EP_STALL(EP5);
                     g_u8Prevent = 1;
                     g_sCSW.bCSWStatus = 0x01;
                     g_sCSW.dCSWDataResidue = 0;
                     g_u8BulkState = BULK_IN;
                     MSC_AckCmd();
-                    USBD_SET_DATA0(EP7);
+                    USBD_SET_DATA0(EP5);
                     return;
                 }
                 default:
@@ -1354,7 +1219,7 @@ void MSC_ProcessCmd(void)
                         {
                             /* Data-In */
                             g_u8BulkState = BULK_IN;
-                            USBD_SET_PAYLOAD_LEN(EP7, 0);
+                            USBD_SET_PAYLOAD_LEN(EP5, 0);
                         }
                     }
                     else
@@ -1457,13 +1322,13 @@ void MSC_AckCmd(void)
         }
 
         /* Return the CSW */
-        USBD_SET_EP_BUF_ADDR(EP7, g_u32BulkBuf1);
+        USBD_SET_EP_BUF_ADDR(EP5, g_u32BulkBuf1);
 
         /* Bulk IN buffer */
         USBD_MemCopy((uint8_t *)(USBD_BUF_BASE + g_u32BulkBuf1), (uint8_t *)&g_sCSW.dCSWSignature, 16);
 
         g_u8BulkState = BULK_CSW;
-        USBD_SET_PAYLOAD_LEN(EP7, 13);
+        USBD_SET_PAYLOAD_LEN(EP5, 13);
     }
 }
 
@@ -1476,33 +1341,16 @@ void MSC_WriteMedia(uint32_t addr, uint32_t size, uint8_t *buffer)
 {
 }
 
-void MSC_SetConfig(void)
+void MSC_SetConfig(S_USBD_FUNC_T *psFunc)
 {
-    // Clear stall status and ready
-    USBD->EP[5].CFGP = 1;
-    USBD->EP[6].CFGP = 1;
-    /*****************************************************/
-    /* EP7 ==> Bulk IN endpoint, address 6 */
-    USBD_CONFIG_EP(EP7, USBD_CFG_EPMODE_IN | BULK_IN_EP_NUM_1);
-    /* Buffer range for EP7 */
-    USBD_SET_EP_BUF_ADDR(EP7, EP7_BUF_BASE);
-
-    /* EP6 ==> Bulk Out endpoint, address 5 */
-    USBD_CONFIG_EP(EP6, USBD_CFG_EPMODE_OUT | BULK_OUT_EP_NUM_1);
-    /* Buffer range for EP6 */
-    USBD_SET_EP_BUF_ADDR(EP6, EP6_BUF_BASE);
-
-    /* trigger to receive OUT data */
-    USBD_SET_PAYLOAD_LEN(EP6, EP6_MAX_PKT_SIZE);
-
-
+    /* The USBD driver has cleared stall and ready, put EP5/EP6 back on their own buffers with DATA0 and
+       armed EP6 for a full packet */
     USBD_LockEpStall(0);
 
     g_u8BulkState = BULK_CBW;
 
 
     DBG_PRINTF("Set config\n");
-
 }
 
 
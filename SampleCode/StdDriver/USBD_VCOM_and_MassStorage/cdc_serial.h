@@ -26,25 +26,10 @@
 #define EP3_MAX_PKT_SIZE    64
 #define EP4_MAX_PKT_SIZE    8
 
+#define EP5_MAX_PKT_SIZE    64
 #define EP6_MAX_PKT_SIZE    64
-#define EP7_MAX_PKT_SIZE    64
 
-#define SETUP_BUF_BASE      0
-#define SETUP_BUF_LEN       8
-#define EP0_BUF_BASE        (SETUP_BUF_BASE + SETUP_BUF_LEN)
-#define EP0_BUF_LEN         EP0_MAX_PKT_SIZE
-#define EP1_BUF_BASE        (SETUP_BUF_BASE + SETUP_BUF_LEN)
-#define EP1_BUF_LEN         EP1_MAX_PKT_SIZE
-#define EP2_BUF_BASE        (EP1_BUF_BASE + EP1_BUF_LEN)
-#define EP2_BUF_LEN         EP2_MAX_PKT_SIZE
-#define EP3_BUF_BASE        (EP2_BUF_BASE + EP2_BUF_LEN)
-#define EP3_BUF_LEN         EP3_MAX_PKT_SIZE
-#define EP4_BUF_BASE        (EP3_BUF_BASE + EP3_BUF_LEN)
-#define EP4_BUF_LEN         EP4_MAX_PKT_SIZE
-#define EP7_BUF_BASE        (EP4_BUF_BASE + EP4_BUF_LEN)
-#define EP7_BUF_LEN         EP7_MAX_PKT_SIZE
-#define EP6_BUF_BASE        (EP7_BUF_BASE + EP7_BUF_LEN)
-#define EP6_BUF_LEN         EP6_MAX_PKT_SIZE
+/* Endpoint buffers are assigned by USBD_RegisterFunction() */
 
 /* Define the interrupt In EP number */
 #define BULK_IN_EP_NUM      0x01
@@ -90,13 +75,12 @@ extern volatile uint32_t gu32RxSize;
 extern volatile uint32_t gu32TxSize;
 
 /*-------------------------------------------------------------*/
-void VCOM_MSC_Init(void);
-void VCOM_MSC_ClassRequest(void);
+int32_t VCOM_MSC_Init(void);
 
-void EP2_Handler(void);
-void EP3_Handler(void);
-void EP7_Handler(void);
-void EP6_Handler(void);
+void VCOM_BulkInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void VCOM_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void MSC_BulkInHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
+void MSC_BulkOutHandler(S_USBD_FUNC_T *psFunc, uint32_t u32HwEp);
 void VCOM_LineCoding(uint8_t port);
 void VCOM_TransferData(void);
 
@@ -149,7 +149,7 @@ const uint8_t gu8ConfigDescriptor[] =
     DESC_ENDPOINT,                   // bDescriptorType
     (EP_INPUT | BULK_IN_EP_NUM_1),   // bEndpointAddress
     EP_BULK,                         // bmAttributes
-    EP7_MAX_PKT_SIZE, 0x00,          // wMaxPacketSize
+    EP5_MAX_PKT_SIZE, 0x00,          // wMaxPacketSize
     0x00,                            // bInterval
 
     /* ENDPOINT descriptor */
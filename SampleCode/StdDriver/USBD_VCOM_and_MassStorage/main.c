@@ -349,12 +349,14 @@ int32_t main(void)
     printf("NuMicro USB MassStorage Start!\n");
 
     /* Open USB controller */
-    USBD_Open(&gsInfo, VCOM_MSC_ClassRequest, NULL);
+    USBD_Open(&gsInfo, NULL, NULL);
 
-    USBD_SetConfigCallback(MSC_SetConfig);
-
-    /* Endpoint configuration */
-    VCOM_MSC_Init();
+    /* Register the VCOM and MSC functions, endpoints and buffers are assigned by the USBD driver */
+    if(VCOM_MSC_Init() < 0)
+    {
+        printf("Error! Fail to configure USB endpoints.\n");
+        return -1;
+    }
     /* Start USB device */
     USBD_Start();
 